@@ -544,6 +544,9 @@ struct VideoCodecVP8
     bool                 automaticResizeOn;
     bool                 frameDroppingOn;
     int                  keyFrameInterval;
+    // Threads used by the encoder and decoder. 0 lets the codec derive the
+    // number from the number of cores and the resolution.
+    unsigned char        numberOfThreads;
 };
 
 // Unknown specific
@@ -53,7 +53,9 @@
         }],
       ],
       'sources': [
+        'interface/i420_buffer_pool.h',
         'interface/i420_video_frame.h',
+        'i420_buffer_pool.cc',
         'i420_video_frame.cc',
         'jpeg/include/jpeg.h',
         'jpeg/data_manager.cc',
@@ -83,6 +85,7 @@
              '<(webrtc_root)/test/test.gyp:test_support_main',
           ],
           'sources': [
+            'i420_buffer_pool_unittest.cc',
             'i420_video_frame_unittest.cc',
             'jpeg/jpeg_unittest.cc',
             'libyuv/libyuv_unittest.cc',
@@ -0,0 +1,174 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_video/interface/i420_buffer_pool.h"
+
+#include <assert.h>
+#include <cstring>  // memcpy
+
+#include "system_wrappers/interface/critical_section_wrapper.h"
+
+namespace webrtc {
+
+// Aligning pointer to 64 bytes for improved performance, e.g. use SIMD.
+static const int kBufferAlignment = 64;
+
+namespace {
+
+// Copies a |width| x |height| plane with stride |src_stride| to a packed
+// plane. Returns the number of bytes copied.
+int CopyPlane(const uint8_t* src, int src_stride, int width, int height,
+              uint8_t* dst) {
+  if (src_stride == width) {
+    memcpy(dst, src, width * height);
+  } else {
+    for (int i = 0; i < height; ++i) {
+      memcpy(dst, src, width);
+      src += src_stride;
+      dst += width;
+    }
+  }
+  return width * height;
+}
+
+}  // namespace
+
+I420Buffer::I420Buffer(int width, int height)
+    : pool_(NULL),
+      ref_count_(0),
+      buffer_(NULL),
+      width_(width),
+      height_(height),
+      timestamp_(0),
+      render_time_ms_(0) {
+  buffer_.reset(AlignedMalloc<uint8_t>(size(), kBufferAlignment));
+}
+
+I420Buffer::~I420Buffer() {}
+
+int32_t I420Buffer::AddRef() {
+  return ++ref_count_;
+}
+
+int32_t I420Buffer::Release() {
+  int32_t ref_count = --ref_count_;
+  if (ref_count == 0) {
+    I420BufferPool* pool = pool_;
+    pool_ = NULL;
+    pool->Put(this);
+    // May delete the pool, and with it this buffer.
+    pool->Release();
+  }
+  return ref_count;
+}
+
+int I420Buffer::CopyFrame(const I420VideoFrame& frame) {
+  if (frame.width() != width_ || frame.height() != height_)
+    return -1;
+  const int half_width = (width_ + 1) / 2;
+  const int half_height = (height_ + 1) / 2;
+  int copied = CopyPlane(frame.buffer(kYPlane), frame.stride(kYPlane),
+                         width_, height_, buffer(kYPlane));
+  copied += CopyPlane(frame.buffer(kUPlane), frame.stride(kUPlane),
+                      half_width, half_height, buffer(kUPlane));
+  copied += CopyPlane(frame.buffer(kVPlane), frame.stride(kVPlane),
+                      half_width, half_height, buffer(kVPlane));
+  timestamp_ = frame.timestamp();
+  render_time_ms_ = frame.render_time_ms();
+  return copied;
+}
+
+uint8_t* I420Buffer::buffer(PlaneType type) {
+  const I420Buffer* const_this = this;
+  return const_cast<uint8_t*>(const_this->buffer(type));
+}
+
+const uint8_t* I420Buffer::buffer(PlaneType type) const {
+  const int size_y = width_ * height_;
+  const int size_uv = ((width_ + 1) / 2) * ((height_ + 1) / 2);
+  switch (type) {
+    case kYPlane:
+      return buffer_.get();
+    case kUPlane:
+      return buffer_.get() + size_y;
+    case kVPlane:
+      return buffer_.get() + size_y + size_uv;
+    default:
+      assert(false);
+  }
+  return NULL;
+}
+
+int I420Buffer::size() const {
+  return width_ * height_ + 2 * ((width_ + 1) / 2) * ((height_ + 1) / 2);
+}
+
+I420BufferPool::I420BufferPool()
+    : ref_count_(0),
+      crit_sect_(CriticalSectionWrapper::CreateCriticalSection()),
+      allocated_buffers_(0) {}
+
+I420BufferPool::~I420BufferPool() {
+  for (size_t i = 0; i < free_buffers_.size(); ++i) {
+    delete free_buffers_[i];
+  }
+}
+
+int32_t I420BufferPool::AddRef() {
+  return ++ref_count_;
+}
+
+int32_t I420BufferPool::Release() {
+  int32_t ref_count = --ref_count_;
+  if (ref_count == 0)
+    delete this;
+  return ref_count;
+}
+
+I420Buffer* I420BufferPool::GetBuffer(int width, int height) {
+  if (width < 1 || height < 1)
+    return NULL;
+  I420Buffer* buffer = NULL;
+  {
+    CriticalSectionScoped cs(crit_sect_.get());
+    while (!free_buffers_.empty()) {
+      I420Buffer* free_buffer = free_buffers_.back();
+      free_buffers_.pop_back();
+      if (free_buffer->width() == width && free_buffer->height() == height) {
+        buffer = free_buffer;
+        break;
+      }
+      delete free_buffer;
+      --allocated_buffers_;
+    }
+    if (buffer == NULL) {
+      buffer = new I420Buffer(width, height);
+      ++allocated_buffers_;
+    }
+  }
+  buffer->timestamp_ = 0;
+  buffer->render_time_ms_ = 0;
+  // The buffer holds a reference to the pool until it's put back.
+  buffer->pool_ = this;
+  AddRef();
+  return buffer;
+}
+
+int I420BufferPool::allocated_buffers() const {
+  CriticalSectionScoped cs(crit_sect_.get());
+  return allocated_buffers_;
+}
+
+void I420BufferPool::Put(I420Buffer* buffer) {
+  CriticalSectionScoped cs(crit_sect_.get());
+  free_buffers_.push_back(buffer);
+}
+
+}  // namespace webrtc
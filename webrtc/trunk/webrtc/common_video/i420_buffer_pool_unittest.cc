@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+#include "webrtc/common_video/interface/i420_buffer_pool.h"
+#include "webrtc/common_video/interface/i420_video_frame.h"
+#include "webrtc/system_wrappers/interface/scoped_refptr.h"
+
+namespace webrtc {
+
+// Fills each plane with a pattern that depends on the plane, row and column,
+// and marks the padding at the end of the rows.
+void FillFrame(I420VideoFrame* frame) {
+  for (int plane = 0; plane < kNumOfPlanes; ++plane) {
+    PlaneType type = static_cast<PlaneType>(plane);
+    const int width = plane == kYPlane ? frame->width() :
+        (frame->width() + 1) / 2;
+    const int height = plane == kYPlane ? frame->height() :
+        (frame->height() + 1) / 2;
+    uint8_t* row = frame->buffer(type);
+    for (int i = 0; i < height; ++i) {
+      memset(row, 0xff, frame->stride(type));
+      for (int j = 0; j < width; ++j) {
+        row[j] = static_cast<uint8_t>(plane * 80 + i * 7 + j);
+      }
+      row += frame->stride(type);
+    }
+  }
+}
+
+TEST(TestI420BufferPool, ReusesReleasedBuffers) {
+  scoped_refptr<I420BufferPool> pool(new I420BufferPool);
+  I420Buffer* first_buffer;
+  {
+    scoped_refptr<I420Buffer> buffer(pool->GetBuffer(16, 8));
+    ASSERT_TRUE(buffer.get() != NULL);
+    first_buffer = buffer.get();
+    EXPECT_EQ(16 * 8 * 3 / 2, buffer->size());
+    EXPECT_EQ(1, pool->allocated_buffers());
+  }
+  scoped_refptr<I420Buffer> buffer1(pool->GetBuffer(16, 8));
+  EXPECT_EQ(first_buffer, buffer1.get());
+  // A second buffer is allocated while the first one is in use.
+  scoped_refptr<I420Buffer> buffer2(pool->GetBuffer(16, 8));
+  EXPECT_NE(buffer1.get(), buffer2.get());
+  EXPECT_EQ(2, pool->allocated_buffers());
+}
+
+TEST(TestI420BufferPool, DropsBuffersOfOtherSizes) {
+  scoped_refptr<I420BufferPool> pool(new I420BufferPool);
+  EXPECT_TRUE(pool->GetBuffer(0, 8) == NULL);
+  EXPECT_TRUE(pool->GetBuffer(16, -1) == NULL);
+  scoped_refptr<I420Buffer> buffer(pool->GetBuffer(16, 8));
+  buffer = NULL;
+  EXPECT_EQ(1, pool->allocated_buffers());
+  buffer = pool->GetBuffer(32, 16);
+  EXPECT_EQ(32, buffer->width());
+  EXPECT_EQ(16, buffer->height());
+  EXPECT_EQ(1, pool->allocated_buffers());
+}
+
+TEST(TestI420BufferPool, BufferOutlivesPool) {
+  scoped_refptr<I420BufferPool> pool(new I420BufferPool);
+  scoped_refptr<I420Buffer> buffer(pool->GetBuffer(16, 8));
+  pool = NULL;
+  memset(buffer->buffer(kYPlane), 0, buffer->size());
+  // Deletes the pool.
+  buffer = NULL;
+}
+
+TEST(TestI420BufferPool, CopyFramePacksPlanes) {
+  const int kWidth = 15;
+  const int kHeight = 9;
+  const int kHalfWidth = (kWidth + 1) / 2;
+  const int kHalfHeight = (kHeight + 1) / 2;
+  I420VideoFrame frame;
+  ASSERT_EQ(0, frame.CreateEmptyFrame(kWidth, kHeight, kWidth + 5,
+                                      kHalfWidth + 3, kHalfWidth));
+  FillFrame(&frame);
+  frame.set_timestamp(1234u);
+  frame.set_render_time_ms(5678);
+
+  scoped_refptr<I420BufferPool> pool(new I420BufferPool);
+  scoped_refptr<I420Buffer> buffer(pool->GetBuffer(kWidth, kHeight));
+  const int kSize = kWidth * kHeight + 2 * kHalfWidth * kHalfHeight;
+  ASSERT_EQ(kSize, buffer->size());
+  EXPECT_EQ(kSize, buffer->CopyFrame(frame));
+  EXPECT_EQ(1234u, buffer->timestamp());
+  EXPECT_EQ(5678, buffer->render_time_ms());
+
+  EXPECT_EQ(buffer->buffer(kYPlane) + kWidth * kHeight,
+            buffer->buffer(kUPlane));
+  EXPECT_EQ(buffer->buffer(kUPlane) + kHalfWidth * kHalfHeight,
+            buffer->buffer(kVPlane));
+  for (int i = 0; i < kHeight; ++i) {
+    EXPECT_EQ(0, memcmp(frame.buffer(kYPlane) + i * frame.stride(kYPlane),
+                        buffer->buffer(kYPlane) + i * kWidth, kWidth));
+  }
+  for (int i = 0; i < kHalfHeight; ++i) {
+    EXPECT_EQ(0, memcmp(frame.buffer(kUPlane) + i * frame.stride(kUPlane),
+                        buffer->buffer(kUPlane) + i * kHalfWidth,
+                        kHalfWidth));
+    EXPECT_EQ(0, memcmp(frame.buffer(kVPlane) + i * frame.stride(kVPlane),
+                        buffer->buffer(kVPlane) + i * kHalfWidth,
+                        kHalfWidth));
+  }
+}
+
+TEST(TestI420BufferPool, CopyFrameRejectsOtherSizes) {
+  I420VideoFrame frame;
+  ASSERT_EQ(0, frame.CreateEmptyFrame(16, 8, 16, 8, 8));
+  scoped_refptr<I420BufferPool> pool(new I420BufferPool);
+  scoped_refptr<I420Buffer> buffer(pool->GetBuffer(16, 10));
+  EXPECT_EQ(-1, buffer->CopyFrame(frame));
+}
+
+}  // namespace webrtc
@@ -0,0 +1,112 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef COMMON_VIDEO_INTERFACE_I420_BUFFER_POOL_H
+#define COMMON_VIDEO_INTERFACE_I420_BUFFER_POOL_H
+
+#include <vector>
+
+#include "webrtc/common_video/interface/i420_video_frame.h"
+#include "webrtc/system_wrappers/interface/aligned_malloc.h"
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class CriticalSectionWrapper;
+class I420BufferPool;
+
+// An I420 frame stored in one packed buffer: the Y plane is followed by the
+// U and V planes, with no padding between rows. Buffers are reference
+// counted and go back to the pool that allocated them when the last
+// reference is released. They can be used with scoped_refptr and handed
+// between threads.
+class I420Buffer {
+ public:
+  int32_t AddRef();
+  int32_t Release();
+
+  // Packs |frame| into the buffer, honoring the strides of its planes. The
+  // frame must have the same size as the buffer.
+  // Return value: The number of bytes copied, or -1 on error.
+  int CopyFrame(const I420VideoFrame& frame);
+
+  // Start of the given plane. The planes are contiguous, so the start of the
+  // Y plane is the start of the whole frame.
+  uint8_t* buffer(PlaneType type);
+  const uint8_t* buffer(PlaneType type) const;
+
+  // Size of the packed frame in bytes.
+  int size() const;
+
+  int width() const {return width_;}
+
+  int height() const {return height_;}
+
+  void set_timestamp(uint32_t timestamp) {timestamp_ = timestamp;}
+
+  uint32_t timestamp() const {return timestamp_;}
+
+  void set_render_time_ms(int64_t render_time_ms) {render_time_ms_ =
+                                                   render_time_ms;}
+
+  int64_t render_time_ms() const {return render_time_ms_;}
+
+ private:
+  friend class I420BufferPool;
+
+  I420Buffer(int width, int height);
+  ~I420Buffer();
+
+  I420BufferPool* pool_;
+  Atomic32 ref_count_;
+  Allocator<uint8_t>::scoped_ptr_aligned buffer_;
+  int width_;
+  int height_;
+  uint32_t timestamp_;
+  int64_t render_time_ms_;
+};
+
+// Recycles I420Buffers, so that frames of a steady size are handed over
+// without allocating. The pool is reference counted too, and stays alive
+// until the last buffer taken from it is released. It's thread safe.
+class I420BufferPool {
+ public:
+  I420BufferPool();
+
+  int32_t AddRef();
+  int32_t Release();
+
+  // Returns a buffer for a |width| x |height| frame, with a reference count
+  // of zero, or NULL if the size is invalid. Free buffers of another size are
+  // deleted.
+  I420Buffer* GetBuffer(int width, int height);
+
+  // Number of buffers allocated by the pool and not yet deleted.
+  int allocated_buffers() const;
+
+ private:
+  friend class I420Buffer;
+
+  ~I420BufferPool();
+
+  // Called by I420Buffer when its last reference is released.
+  void Put(I420Buffer* buffer);
+
+  Atomic32 ref_count_;
+  scoped_ptr<CriticalSectionWrapper> crit_sect_;
+  std::vector<I420Buffer*> free_buffers_;
+  int allocated_buffers_;
+};
+
+}  // namespace webrtc
+
+#endif  // COMMON_VIDEO_INTERFACE_I420_BUFFER_POOL_H
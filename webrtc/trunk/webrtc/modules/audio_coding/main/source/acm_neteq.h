@@ -21,7 +21,9 @@
 
 namespace webrtc {
 
+class AudioDecoder;
 class CriticalSectionWrapper;
+class NetEq;
 class RWLockWrapper;
 struct CodecInst;
 
@@ -339,6 +341,16 @@ class ACMNetEQ {
   WebRtc_Word32 extra_delay_;
 
   CriticalSectionWrapper* callback_crit_sect_;
+
+  // Only used with NetEq 4, but declared in all builds, so that the class
+  // is the same whether or not WEBRTC_ACM_USE_NETEQ4 is defined where it is
+  // included. A single NetEq 4 instance decodes all channels; the slave only
+  // exists as bookkeeping for the module.
+  NetEq* neteq_;
+  // The RTP payload type registered for each decoder, or -1.
+  WebRtc_Word16 payload_type_[kDecoderReservedEnd];
+  // Adapters of the ACM decoder instances registered with NetEq 4, or NULL.
+  AudioDecoder* acm_decoder_[kDecoderReservedEnd];
 };
 
 }  // namespace webrtc
@@ -0,0 +1,748 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// ACMNetEQ implemented on top of NetEq 4. This file replaces acm_neteq.cc
+// when the module is built with acm_use_neteq4=1. The legacy decoder
+// enumerators are global, while the NetEq 4 ones live in namespace webrtc;
+// the former are therefore always written with a leading "::".
+
+#include "webrtc/modules/audio_coding/main/source/acm_neteq.h"
+
+#include <assert.h>
+
+#include <algorithm>  // sort
+#include <vector>
+
+#include "webrtc/common_types.h"
+#include "webrtc/modules/audio_coding/neteq4/interface/audio_decoder.h"
+#include "webrtc/modules/audio_coding/neteq4/interface/neteq.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/rw_lock_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/system_wrappers/interface/trace.h"
+
+namespace webrtc {
+
+#define NETEQ_INIT_FREQ 8000
+#define NETEQ_INIT_FREQ_KHZ (NETEQ_INIT_FREQ/1000)
+
+namespace {
+
+// Finds the NetEq 4 decoder for the legacy decoder |codec|, running at
+// |fs_hz|. Returns false if NetEq 4 has no such decoder.
+bool NetEq4Decoder(WebRtcNetEQDecoder codec, int fs_hz,
+                   NetEqDecoder* decoder) {
+  switch (codec) {
+    case ::kDecoderPCMu: *decoder = kDecoderPCMu; return true;
+    case ::kDecoderPCMa: *decoder = kDecoderPCMa; return true;
+    case ::kDecoderPCMu_2ch: *decoder = kDecoderPCMu_2ch; return true;
+    case ::kDecoderPCMa_2ch: *decoder = kDecoderPCMa_2ch; return true;
+    case ::kDecoderILBC: *decoder = kDecoderILBC; return true;
+    case ::kDecoderISAC: *decoder = kDecoderISAC; return true;
+    case ::kDecoderISACswb: *decoder = kDecoderISACswb; return true;
+    case ::kDecoderISACfb: *decoder = kDecoderISACfb; return true;
+    case ::kDecoderPCM16B: *decoder = kDecoderPCM16B; return true;
+    case ::kDecoderPCM16Bwb: *decoder = kDecoderPCM16Bwb; return true;
+    case ::kDecoderPCM16Bswb32kHz:
+      *decoder = kDecoderPCM16Bswb32kHz;
+      return true;
+    case ::kDecoderPCM16Bswb48kHz:
+      *decoder = kDecoderPCM16Bswb48kHz;
+      return true;
+    case ::kDecoderPCM16B_2ch: *decoder = kDecoderPCM16B_2ch; return true;
+    case ::kDecoderPCM16Bwb_2ch: *decoder = kDecoderPCM16Bwb_2ch; return true;
+    case ::kDecoderPCM16Bswb32kHz_2ch:
+      *decoder = kDecoderPCM16Bswb32kHz_2ch;
+      return true;
+    case ::kDecoderG722: *decoder = kDecoderG722; return true;
+    case ::kDecoderG722_2ch: *decoder = kDecoderG722_2ch; return true;
+    case ::kDecoderRED: *decoder = kDecoderRED; return true;
+    case ::kDecoderAVT: *decoder = kDecoderAVT; return true;
+    case ::kDecoderCNG:
+      // The legacy NetEQ has one comfort noise decoder for all rates.
+      switch (fs_hz) {
+        case 8000: *decoder = kDecoderCNGnb; return true;
+        case 16000: *decoder = kDecoderCNGwb; return true;
+        case 32000: *decoder = kDecoderCNGswb32kHz; return true;
+        case 48000: *decoder = kDecoderCNGswb48kHz; return true;
+        default: return false;
+      }
+    case ::kDecoderOpus: *decoder = kDecoderOpus; return true;
+    case ::kDecoderCELT_32: *decoder = kDecoderCELT_32; return true;
+    case ::kDecoderCELT_32_2ch: *decoder = kDecoderCELT_32_2ch; return true;
+    default:
+      return false;
+  }
+}
+
+// The legacy NetEQ decodes the second channel of Opus and CELT in the slave
+// instance with the mono decoder; NetEq 4 needs the stereo decoder instead.
+NetEqDecoder StereoDecoder(NetEqDecoder decoder) {
+  switch (decoder) {
+    case kDecoderOpus: return kDecoderOpus_2ch;
+    case kDecoderCELT_32: return kDecoderCELT_32_2ch;
+    default: return decoder;
+  }
+}
+
+// Decodes with the decoder instance of an ACM codec. Used for codecs whose
+// decoder feeds the ACM encoder, such as the iSAC bandwidth estimate, which
+// a decoder created by NetEq 4 would not.
+class AcmAudioDecoder : public AudioDecoder {
+ public:
+  AcmAudioDecoder(NetEqDecoder type, const WebRtcNetEQ_CodecDef& codec_def)
+      : AudioDecoder(type),
+        codec_def_(codec_def) {
+    state_ = codec_def.codec_state;
+  }
+
+  virtual int Decode(const uint8_t* encoded, size_t encoded_len,
+                     int16_t* decoded, SpeechType* speech_type) {
+    return DecodeWith(codec_def_.funcDecode, encoded, encoded_len, decoded,
+                      speech_type);
+  }
+
+  virtual int DecodeRedundant(const uint8_t* encoded, size_t encoded_len,
+                              int16_t* decoded, SpeechType* speech_type) {
+    if (codec_def_.funcDecodeRCU == NULL) {
+      return Decode(encoded, encoded_len, decoded, speech_type);
+    }
+    return DecodeWith(codec_def_.funcDecodeRCU, encoded, encoded_len, decoded,
+                      speech_type);
+  }
+
+  virtual bool HasDecodePlc() const {
+    return codec_def_.funcDecodePLC != NULL;
+  }
+
+  virtual int DecodePlc(int num_frames, int16_t* decoded) {
+    if (codec_def_.funcDecodePLC == NULL) {
+      return -1;
+    }
+    return codec_def_.funcDecodePLC(state_, decoded,
+                                    static_cast<int16_t>(num_frames));
+  }
+
+  virtual int Init() {
+    if (codec_def_.funcDecodeInit == NULL) {
+      return 0;
+    }
+    return codec_def_.funcDecodeInit(state_);
+  }
+
+  virtual int IncomingPacket(const uint8_t* payload,
+                             size_t payload_len,
+                             uint16_t rtp_sequence_number,
+                             uint32_t rtp_timestamp,
+                             uint32_t arrival_timestamp) {
+    if (codec_def_.funcUpdBWEst == NULL) {
+      return 0;
+    }
+    return codec_def_.funcUpdBWEst(
+        state_, reinterpret_cast<const uint16_t*>(payload),
+        static_cast<int32_t>(payload_len), rtp_sequence_number, rtp_timestamp,
+        arrival_timestamp);
+  }
+
+  virtual int ErrorCode() {
+    if (codec_def_.funcGetErrorCode == NULL) {
+      return 0;
+    }
+    return codec_def_.funcGetErrorCode(state_);
+  }
+
+  virtual int PacketDuration(const uint8_t* encoded, size_t encoded_len) {
+    if (codec_def_.funcDurationEst == NULL) {
+      return kNotImplemented;
+    }
+    return codec_def_.funcDurationEst(state_, encoded,
+                                      static_cast<int>(encoded_len));
+  }
+
+ private:
+  int DecodeWith(WebRtcNetEQ_FuncDecode decode, const uint8_t* encoded,
+                 size_t encoded_len, int16_t* decoded,
+                 SpeechType* speech_type) {
+    int16_t temp_type = 1;  // Default is speech.
+    int16_t ret = decode(
+        state_, reinterpret_cast<int16_t*>(const_cast<uint8_t*>(encoded)),
+        static_cast<int16_t>(encoded_len), decoded, &temp_type);
+    *speech_type = ConvertSpeechType(temp_type);
+    return ret;
+  }
+
+  const WebRtcNetEQ_CodecDef codec_def_;
+};
+
+}  // namespace
+
+ACMNetEQ::ACMNetEQ()
+    : id_(0),
+      current_samp_freq_khz_(NETEQ_INIT_FREQ_KHZ),
+      avt_playout_(true),  // NetEq 4 always plays out DTMF.
+      playout_mode_(voice),
+      neteq_crit_sect_(CriticalSectionWrapper::CreateCriticalSection()),
+      vad_status_(false),
+      vad_mode_(VADNormal),
+      decode_lock_(RWLockWrapper::CreateRWLock()),
+      num_slaves_(0),
+      received_stereo_(false),
+      master_slave_info_(NULL),
+      previous_audio_activity_(AudioFrame::kVadUnknown),
+      extra_delay_(0),
+      callback_crit_sect_(CriticalSectionWrapper::CreateCriticalSection()),
+      neteq_(NULL) {
+  for (int n = 0; n < MAX_NUM_SLAVE_NETEQ + 1; n++) {
+    is_initialized_[n] = false;
+    ptr_vadinst_[n] = NULL;
+    inst_[n] = NULL;
+    inst_mem_[n] = NULL;
+    neteq_packet_buffer_[n] = NULL;
+  }
+  for (int n = 0; n < kDecoderReservedEnd; n++) {
+    payload_type_[n] = -1;
+    acm_decoder_[n] = NULL;
+  }
+}
+
+ACMNetEQ::~ACMNetEQ() {
+  delete neteq_;
+  for (int n = 0; n < kDecoderReservedEnd; n++) {
+    delete acm_decoder_[n];
+  }
+  if (neteq_crit_sect_ != NULL) {
+    delete neteq_crit_sect_;
+  }
+
+  if (decode_lock_ != NULL) {
+    delete decode_lock_;
+  }
+
+  if (callback_crit_sect_ != NULL) {
+    delete callback_crit_sect_;
+  }
+}
+
+WebRtc_Word32 ACMNetEQ::Init() {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  delete neteq_;
+  for (int n = 0; n < kDecoderReservedEnd; n++) {
+    payload_type_[n] = -1;
+    delete acm_decoder_[n];
+    acm_decoder_[n] = NULL;
+  }
+  neteq_ = NetEq::Create(NETEQ_INIT_FREQ);
+  if (neteq_ == NULL) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "Init: NetEq Initialization error: could not create NetEq");
+    is_initialized_[0] = false;
+    return -1;
+  }
+  current_samp_freq_khz_ = NETEQ_INIT_FREQ_KHZ;
+  for (WebRtc_Word16 idx = 0; idx < num_slaves_ + 1; idx++) {
+    is_initialized_[idx] = true;
+  }
+  // Keep the settings made before the re-initialization.
+  neteq_->SetExtraDelay(extra_delay_);
+  AudioPlayoutMode mode = playout_mode_;
+  playout_mode_ = voice;
+  if (SetPlayoutMode(mode) < 0) {
+    return -1;
+  }
+  vad_status_ = false;
+  if (EnableVAD() == -1) {
+    return -1;
+  }
+  return 0;
+}
+
+WebRtc_Word32 ACMNetEQ::AllocatePacketBuffer(
+    const WebRtcNetEQDecoder* /* used_codecs */,
+    WebRtc_Word16 /* num_codecs */) {
+  // NetEq 4 allocates its packet buffer itself.
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  if (!is_initialized_[0]) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "AllocatePacketBuffer: NetEq is not initialized.");
+    return -1;
+  }
+  return 0;
+}
+
+WebRtc_Word32 ACMNetEQ::SetExtraDelay(const WebRtc_Word32 delay_in_ms) {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  if (!is_initialized_[0]) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "SetExtraDelay: NetEq is not initialized.");
+    return -1;
+  }
+  if (!neteq_->SetExtraDelay(delay_in_ms)) {
+    LogError("SetExtraDelay", 0);
+    return -1;
+  }
+  extra_delay_ = delay_in_ms;
+  return 0;
+}
+
+WebRtc_Word32 ACMNetEQ::SetAVTPlayout(const bool enable) {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  if (!enable) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "SetAVTPlayout: NetEq 4 cannot disable DTMF playout.");
+    return -1;
+  }
+  if (!is_initialized_[0]) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "SetAVTPlayout: NetEq is not initialized.");
+    return -1;
+  }
+  if (neteq_->EnableDtmf() < 0) {
+    LogError("EnableDtmf", 0);
+    return -1;
+  }
+  avt_playout_ = true;
+  return 0;
+}
+
+bool ACMNetEQ::avt_playout() const {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  return avt_playout_;
+}
+
+WebRtc_Word32 ACMNetEQ::CurrentSampFreqHz() const {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  if (!is_initialized_[0]) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "CurrentSampFreqHz: NetEq is not initialized.");
+    return -1;
+  }
+  return (WebRtc_Word32)(1000 * current_samp_freq_khz_);
+}
+
+WebRtc_Word32 ACMNetEQ::SetPlayoutMode(const AudioPlayoutMode mode) {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  if (playout_mode_ != mode) {
+    if (!is_initialized_[0]) {
+      WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                   "SetPlayoutMode: NetEq is not initialized.");
+      return -1;
+    }
+    NetEqPlayoutMode playout_mode = kPlayoutOff;
+    switch (mode) {
+      case voice:
+        playout_mode = kPlayoutOn;
+        break;
+      case fax:
+        playout_mode = kPlayoutFax;
+        break;
+      case streaming:
+        playout_mode = kPlayoutStreaming;
+        break;
+      case off:
+        playout_mode = kPlayoutOff;
+        break;
+    }
+    neteq_->SetPlayoutMode(playout_mode);
+    playout_mode_ = mode;
+  }
+  return 0;
+}
+
+AudioPlayoutMode ACMNetEQ::playout_mode() const {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  return playout_mode_;
+}
+
+WebRtc_Word32 ACMNetEQ::NetworkStatistics(
+    ACMNetworkStatistics* statistics) const {
+  NetEqNetworkStatistics stats;
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  if (!is_initialized_[0]) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "NetworkStatistics: NetEq is not initialized.");
+    return -1;
+  }
+  if (neteq_->NetworkStatistics(&stats) != NetEq::kOK) {
+    LogError("NetworkStatistics", 0);
+    return -1;
+  }
+  statistics->currentAccelerateRate = stats.accelerate_rate;
+  statistics->currentBufferSize = stats.current_buffer_size_ms;
+  statistics->jitterPeaksFound = (stats.jitter_peaks_found > 0);
+  statistics->currentDiscardRate = stats.packet_discard_rate;
+  statistics->currentExpandRate = stats.expand_rate;
+  statistics->currentPacketLossRate = stats.packet_loss_rate;
+  statistics->currentPreemptiveRate = stats.preemptive_rate;
+  statistics->preferredBufferSize = stats.preferred_buffer_size_ms;
+  statistics->clockDriftPPM = stats.clockdrift_ppm;
+  statistics->addedSamples = stats.added_zero_samples;
+
+  std::vector<int> waiting_times_vec;
+  neteq_->WaitingTimes(&waiting_times_vec);
+  if (!waiting_times_vec.empty()) {
+    std::sort(waiting_times_vec.begin(), waiting_times_vec.end());
+    size_t size = waiting_times_vec.size();
+    if (size % 2 == 0) {
+      statistics->medianWaitingTimeMs = (waiting_times_vec[size / 2 - 1] +
+          waiting_times_vec[size / 2]) / 2;
+    } else {
+      statistics->medianWaitingTimeMs = waiting_times_vec[size / 2];
+    }
+    statistics->minWaitingTimeMs = waiting_times_vec.front();
+    statistics->maxWaitingTimeMs = waiting_times_vec.back();
+    double sum = 0;
+    for (size_t i = 0; i < size; ++i) {
+      sum += waiting_times_vec[i];
+    }
+    statistics->meanWaitingTimeMs = static_cast<int>(sum / size);
+  } else {
+    statistics->meanWaitingTimeMs = -1;
+    statistics->medianWaitingTimeMs = -1;
+    statistics->minWaitingTimeMs = -1;
+    statistics->maxWaitingTimeMs = -1;
+  }
+  return 0;
+}
+
+// NetEq 4 decodes stereo payloads itself, so unlike the legacy NetEQ the
+// payload is not split between master and slave.
+WebRtc_Word32 ACMNetEQ::RecIn(const WebRtc_UWord8* incoming_payload,
+                              const WebRtc_Word32 length_payload,
+                              const WebRtcRTPHeader& rtp_info) {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  // Down-cast the time to (32-6)-bit since we only care about
+  // the least significant bits. (32-6) bits cover 2^(32-6) = 67108864 ms.
+  // we masked 6 most significant bits of 32-bit so we don't loose resolution
+  // when do the following multiplication.
+  const WebRtc_UWord32 now_in_ms =
+      static_cast<WebRtc_UWord32>(
+          TickTime::MillisecondTimestamp() & 0x03ffffff);
+  WebRtc_UWord32 recv_timestamp = static_cast<WebRtc_UWord32>(
+      current_samp_freq_khz_ * now_in_ms);
+
+  if (!is_initialized_[0]) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "RecIn: NetEq is not initialized.");
+    return -1;
+  }
+  if (neteq_->InsertPacket(rtp_info, incoming_payload, length_payload,
+                           recv_timestamp) != NetEq::kOK) {
+    LogError("InsertPacket", 0);
+    return -1;
+  }
+  return 0;
+}
+
+WebRtc_Word32 ACMNetEQ::RecOut(AudioFrame& audio_frame) {
+  NetEqOutputType type = kOutputNormal;
+  int samples_per_channel = 0;
+  int num_channels = 0;
+
+  CriticalSectionScoped lockNetEq(neteq_crit_sect_);
+  if (!is_initialized_[0]) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "RecOut: NetEq is not initialized.");
+    return -1;
+  }
+  {
+    WriteLockScoped lockCodec(*decode_lock_);
+    if (neteq_->GetAudio(AudioFrame::kMaxDataSizeSamples, audio_frame.data_,
+                         &samples_per_channel, &num_channels,
+                         &type) != NetEq::kOK) {
+      LogError("GetAudio", 0);
+      // Sample underrun can be recovered from.
+      if (neteq_->LastError() != NetEq::kSampleUnderrun) {
+        return -1;
+      }
+    }
+  }
+  audio_frame.num_channels_ = num_channels;
+  audio_frame.samples_per_channel_ =
+      static_cast<WebRtc_UWord16>(samples_per_channel);
+  // NetEq always returns 10 ms of audio.
+  current_samp_freq_khz_ =
+      static_cast<float>(audio_frame.samples_per_channel_) / 10.0f;
+  audio_frame.sample_rate_hz_ = audio_frame.samples_per_channel_ * 100;
+  if (vad_status_) {
+    if (type == kOutputVADPassive) {
+      audio_frame.vad_activity_ = AudioFrame::kVadPassive;
+      audio_frame.speech_type_ = AudioFrame::kNormalSpeech;
+    } else if (type == kOutputNormal) {
+      audio_frame.vad_activity_ = AudioFrame::kVadActive;
+      audio_frame.speech_type_ = AudioFrame::kNormalSpeech;
+    } else if (type == kOutputPLC) {
+      audio_frame.vad_activity_ = previous_audio_activity_;
+      audio_frame.speech_type_ = AudioFrame::kPLC;
+    } else if (type == kOutputCNG) {
+      audio_frame.vad_activity_ = AudioFrame::kVadPassive;
+      audio_frame.speech_type_ = AudioFrame::kCNG;
+    } else {
+      audio_frame.vad_activity_ = AudioFrame::kVadPassive;
+      audio_frame.speech_type_ = AudioFrame::kPLCCNG;
+    }
+  } else {
+    // Always return kVadUnknown when receive VAD is inactive
+    audio_frame.vad_activity_ = AudioFrame::kVadUnknown;
+    if (type == kOutputNormal) {
+      audio_frame.speech_type_ = AudioFrame::kNormalSpeech;
+    } else if (type == kOutputPLC) {
+      audio_frame.speech_type_ = AudioFrame::kPLC;
+    } else if (type == kOutputPLCtoCNG) {
+      audio_frame.speech_type_ = AudioFrame::kPLCCNG;
+    } else if (type == kOutputCNG) {
+      audio_frame.speech_type_ = AudioFrame::kCNG;
+    } else {
+      // type is kOutputVADPassive which
+      // we don't expect to get if vad_status_ is false
+      WEBRTC_TRACE(webrtc::kTraceWarning, webrtc::kTraceAudioCoding, id_,
+                   "RecOut: NetEq returned kVadPassive while vad_status_ is "
+                   "false.");
+      audio_frame.vad_activity_ = AudioFrame::kVadUnknown;
+      audio_frame.speech_type_ = AudioFrame::kNormalSpeech;
+    }
+  }
+  previous_audio_activity_ = audio_frame.vad_activity_;
+
+  return 0;
+}
+
+// NetEq 4 creates its own decoder instances, so only the codec type, the
+// sample rate and the payload type are taken from |codec_def|. The slave is
+// given the same codecs as the master; for those the stereo decoder replaces
+// the mono one.
+WebRtc_Word32 ACMNetEQ::AddCodec(WebRtcNetEQ_CodecDef* codec_def,
+                                 bool to_master) {
+  if (codec_def == NULL) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "ACMNetEQ::AddCodec: error, codec_def is NULL");
+    return -1;
+  }
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  if (!is_initialized_[to_master ? 0 : 1]) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "ACMNetEQ::AddCodec: NetEq is not initialized.");
+    return -1;
+  }
+  NetEqDecoder decoder;
+  if ((codec_def->codec <= ::kDecoderReservedStart) ||
+      (codec_def->codec >= ::kDecoderReservedEnd) ||
+      !NetEq4Decoder(codec_def->codec, codec_def->codec_fs, &decoder)) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "ACMNetEQ::AddCodec: codec %d is not supported by NetEq 4",
+                 codec_def->codec);
+    return -1;
+  }
+  const WebRtc_Word16 registered = payload_type_[codec_def->codec];
+  if (!to_master) {
+    if (StereoDecoder(decoder) == decoder &&
+        registered == codec_def->payloadType) {
+      // Already registered by the master.
+      return 0;
+    }
+    decoder = StereoDecoder(decoder);
+  }
+  if (registered >= 0) {
+    neteq_->RemovePayloadType(static_cast<uint8_t>(registered));
+    payload_type_[codec_def->codec] = -1;
+  }
+  delete acm_decoder_[codec_def->codec];
+  acm_decoder_[codec_def->codec] = NULL;
+
+  // Codecs with a bandwidth estimator decode with the ACM instance, so that
+  // its encoder gets the estimate. The others are decoded by NetEq 4 itself,
+  // as the ACM decodes stereo as two mono instances, which NetEq 4 can't.
+  AudioDecoder* acm_decoder = NULL;
+  int ret;
+  if (to_master && codec_def->funcUpdBWEst != NULL) {
+    acm_decoder = new AcmAudioDecoder(decoder, *codec_def);
+    ret = neteq_->RegisterExternalDecoder(
+        acm_decoder, decoder, codec_def->codec_fs,
+        static_cast<uint8_t>(codec_def->payloadType));
+  } else {
+    ret = neteq_->RegisterPayloadType(
+        decoder, static_cast<uint8_t>(codec_def->payloadType));
+  }
+  if (ret != NetEq::kOK) {
+    delete acm_decoder;
+    LogError("RegisterPayloadType", 0);
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "ACMNetEQ::AddCodec: NetEq, error in adding codec");
+    return -1;
+  }
+  payload_type_[codec_def->codec] = codec_def->payloadType;
+  acm_decoder_[codec_def->codec] = acm_decoder;
+  return 0;
+}
+
+WebRtc_Word16 ACMNetEQ::EnableVAD() {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  if (vad_status_) {
+    return 0;
+  }
+  if (!is_initialized_[0]) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "SetVADStatus: NetEq is not initialized.");
+    return -1;
+  }
+  neteq_->EnableVad();
+  // Set previous VAD status to PASSIVE
+  previous_audio_activity_ = AudioFrame::kVadPassive;
+  vad_status_ = true;
+  return 0;
+}
+
+ACMVADMode ACMNetEQ::vad_mode() const {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  return vad_mode_;
+}
+
+// The post-decode VAD of NetEq 4 has no aggressiveness setting; the mode is
+// only validated and kept.
+WebRtc_Word16 ACMNetEQ::SetVADMode(const ACMVADMode mode) {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  if ((mode < VADNormal) || (mode > VADVeryAggr)) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "SetVADMode: NetEq error: could not set VAD mode, mode is not "
+                 "supported");
+    return -1;
+  }
+  if (!is_initialized_[0]) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "SetVADMode: NetEq is not initialized.");
+    return -1;
+  }
+  vad_mode_ = mode;
+  return 0;
+}
+
+WebRtc_Word32 ACMNetEQ::FlushBuffers() {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  if (!is_initialized_[0]) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "FlushBuffers: NetEq is not initialized.");
+    return -1;
+  }
+  neteq_->FlushBuffers();
+  return 0;
+}
+
+WebRtc_Word16 ACMNetEQ::RemoveCodec(WebRtcNetEQDecoder codec_idx,
+                                    bool /* is_stereo */) {
+  // sanity check
+  if ((codec_idx <= ::kDecoderReservedStart) ||
+      (codec_idx >= ::kDecoderReservedEnd)) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "RemoveCodec: NetEq error: could not Remove Codec, codec "
+                 "index out of range");
+    return -1;
+  }
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  if (!is_initialized_[0]) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "RemoveCodec: NetEq is not initialized.");
+    return -1;
+  }
+  if (payload_type_[codec_idx] < 0 ||
+      neteq_->RemovePayloadType(
+          static_cast<uint8_t>(payload_type_[codec_idx])) != NetEq::kOK) {
+    LogError("RemovePayloadType", 0);
+    return -1;
+  }
+  payload_type_[codec_idx] = -1;
+  delete acm_decoder_[codec_idx];
+  acm_decoder_[codec_idx] = NULL;
+  return 0;
+}
+
+// NetEq 4 always generates background noise in the "on" mode.
+WebRtc_Word16 ACMNetEQ::SetBackgroundNoiseMode(
+    const ACMBackgroundNoiseMode mode) {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  if (mode != On) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "SetBackgroundNoiseMode: mode %d is not supported by "
+                 "NetEq 4.", mode);
+    return -1;
+  }
+  return 0;
+}
+
+WebRtc_Word16 ACMNetEQ::BackgroundNoiseMode(ACMBackgroundNoiseMode& mode) {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  if (!is_initialized_[0]) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "BackgroundNoiseMode: NetEq is not initialized.");
+    return -1;
+  }
+  mode = On;
+  return 0;
+}
+
+void ACMNetEQ::set_id(WebRtc_Word32 id) {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  id_ = id;
+}
+
+void ACMNetEQ::LogError(const char* neteq_func_name,
+                        const WebRtc_Word16 idx) const {
+  WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+               "NetEq-%d Error in function %s, error-code: %d, decoder "
+               "error-code: %d", idx, neteq_func_name, neteq_->LastError(),
+               neteq_->LastDecoderError());
+}
+
+WebRtc_Word32 ACMNetEQ::PlayoutTimestamp(WebRtc_UWord32& timestamp) {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  if (!is_initialized_[0]) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "PlayoutTimestamp: NetEq is not initialized.");
+    return -1;
+  }
+  timestamp = neteq_->PlayoutTimestamp();
+  return 0;
+}
+
+void ACMNetEQ::RemoveSlaves() {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  RemoveSlavesSafe();
+}
+
+void ACMNetEQ::RemoveSlavesSafe() {
+  for (int i = 1; i < num_slaves_ + 1; i++) {
+    is_initialized_[i] = false;
+  }
+  num_slaves_ = 0;
+}
+
+WebRtc_Word16 ACMNetEQ::AddSlave(const WebRtcNetEQDecoder* /* used_codecs */,
+                                 WebRtc_Word16 /* num_codecs */) {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  if (!is_initialized_[0]) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceAudioCoding, id_,
+                 "AddSlave: AddSlave Failed, NetEq is not initialized.");
+    return -1;
+  }
+  const WebRtc_Word16 slave_idx = 1;
+  num_slaves_ = 1;
+  is_initialized_[slave_idx] = true;
+  return 0;
+}
+
+void ACMNetEQ::set_received_stereo(bool received_stereo) {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  received_stereo_ = received_stereo;
+}
+
+WebRtc_UWord8 ACMNetEQ::num_slaves() {
+  CriticalSectionScoped lock(neteq_crit_sect_);
+  return num_slaves_;
+}
+
+}  // namespace webrtc
@@ -1993,6 +1993,11 @@ WebRtc_Word32 AudioCodingModuleImpl::IncomingPacket(
   // vector holds left channel, and second half holds right channel.
   if (expected_channels_ == 2) {
     if (!rtp_info.type.Audio.isCNG) {
+#ifdef WEBRTC_ACM_USE_NETEQ4
+      // NetEq 4 decodes the stereo payload as it is.
+      rtp_header.type.Audio.channel = 2;
+      return neteq_.RecIn(incoming_payload, payload_length, rtp_header);
+#else
       // Create a new vector for the payload, maximum payload size.
       WebRtc_Word32 length = payload_length;
       WebRtc_UWord8 payload[kMaxPacketSize];
@@ -2002,6 +2007,7 @@ WebRtc_Word32 AudioCodingModuleImpl::IncomingPacket(
       rtp_header.type.Audio.channel = 2;
       // Insert packet into NetEQ.
       return neteq_.RecIn(payload, length, rtp_header);
+#endif
     } else {
       // If we receive a CNG packet while expecting stereo, we ignore the packet
       // and continue. CNG is not supported for stereo.
@@ -11,6 +11,7 @@
 #include "webrtc/modules/audio_coding/neteq4/audio_vector.h"
 
 #include <assert.h>
+#include <string.h>  // memcpy, memmove, memset
 
 #include <algorithm>
 
@@ -18,101 +19,93 @@
 
 namespace webrtc {
 
+template<typename T>
+AudioVector<T>::AudioVector(size_t initial_size)
+    : array_(new T[initial_size]),
+      capacity_(initial_size),
+      begin_(0),
+      end_(initial_size) {
+  memset(array_.get(), 0, initial_size * sizeof(T));
+}
+
 template<typename T>
 void AudioVector<T>::Clear() {
-  vector_.clear();
+  begin_ = end_ = capacity_ / 2;
 }
 
 template<typename T>
 void AudioVector<T>::CopyFrom(AudioVector<T>* copy_to) const {
-  if (copy_to) {
-    copy_to->vector_.assign(vector_.begin(), vector_.end());
+  if (copy_to && copy_to != this) {
+    copy_to->Clear();
+    copy_to->PushBack(*this);
   }
 }
 
 template<typename T>
 void AudioVector<T>::PushFront(const AudioVector<T>& prepend_this) {
-  vector_.insert(vector_.begin(), prepend_this.vector_.begin(),
-                 prepend_this.vector_.end());
+  PushFront(prepend_this.array_.get() + prepend_this.begin_,
+            prepend_this.Size());
 }
 
 template<typename T>
 void AudioVector<T>::PushFront(const T* prepend_this, size_t length) {
-  // Same operation as InsertAt beginning.
-  InsertAt(prepend_this, length, 0);
+  if (length == 0)
+    return;
+  Reserve(length, 0);
+  begin_ -= length;
+  memcpy(array_.get() + begin_, prepend_this, length * sizeof(T));
 }
 
 template<typename T>
 void AudioVector<T>::PushBack(const AudioVector<T>& append_this) {
-  vector_.reserve(vector_.size() + append_this.Size());
-  for (size_t i = 0; i < append_this.Size(); ++i) {
-    vector_.push_back(append_this[i]);
-  }
+  PushBack(append_this.array_.get() + append_this.begin_, append_this.Size());
 }
 
 template<typename T>
 void AudioVector<T>::PushBack(const T* append_this, size_t length) {
-  vector_.reserve(vector_.size() + length);
-  for (size_t i = 0; i < length; ++i) {
-    vector_.push_back(append_this[i]);
-  }
+  if (length == 0)
+    return;
+  Reserve(0, length);
+  memcpy(array_.get() + end_, append_this, length * sizeof(T));
+  end_ += length;
 }
 
 template<typename T>
 void AudioVector<T>::PopFront(size_t length) {
-  if (length >= vector_.size()) {
-    // Remove all elements.
-    vector_.clear();
-  } else {
-    typename std::vector<T>::iterator end_range = vector_.begin();
-    end_range += length;
-    // Erase all elements in range vector_.begin() and |end_range| (not
-    // including |end_range|).
-    vector_.erase(vector_.begin(), end_range);
-  }
+  // Remove all elements if |length| is larger than the size.
+  begin_ += std::min(length, Size());
 }
 
 template<typename T>
 void AudioVector<T>::PopBack(size_t length) {
-  // Make sure that new_size is never negative (which causes wrap-around).
-  size_t new_size = vector_.size() - std::min(length, vector_.size());
-  vector_.resize(new_size);
+  // Make sure that the new size is never negative (which causes wrap-around).
+  end_ -= std::min(length, Size());
 }
 
 template<typename T>
 void AudioVector<T>::Extend(size_t extra_length) {
-  vector_.insert(vector_.end(), extra_length, 0);
+  if (extra_length == 0)
+    return;
+  Reserve(0, extra_length);
+  memset(array_.get() + end_, 0, extra_length * sizeof(T));
+  end_ += extra_length;
 }
 
 template<typename T>
 void AudioVector<T>::InsertAt(const T* insert_this,
                               size_t length,
                               size_t position) {
-  typename std::vector<T>::iterator insert_position = vector_.begin();
-  // Cap the position at the current vector length, to be sure the iterator
-  // does not extend beyond the end of the vector.
-  position = std::min(vector_.size(), position);
-  insert_position += position;
-  // First, insert zeros at the position. This makes the vector longer (and
-  // invalidates the iterator |insert_position|.
-  vector_.insert(insert_position, length, 0);
-  // Write the new values into the vector.
-  for (size_t i = 0; i < length; ++i) {
-    vector_[position + i] = insert_this[i];
-  }
+  if (length == 0)
+    return;
+  memcpy(InsertGap(length, position), insert_this, length * sizeof(T));
 }
 
 template<typename T>
 void AudioVector<T>::InsertZerosAt(size_t length,
                                    size_t position) {
-  typename std::vector<T>::iterator insert_position = vector_.begin();
-  // Cap the position at the current vector length, to be sure the iterator
-  // does not extend beyond the end of the vector.
-  position = std::min(vector_.size(), position);
-  insert_position += position;
-  // Insert zeros at the position. This makes the vector longer (and
-  // invalidates the iterator |insert_position|.
-  vector_.insert(insert_position, length, 0);
+  if (length == 0)
+    return;
+  memset(InsertGap(length, position), 0, length * sizeof(T));
 }
 
 template<typename T>
@@ -120,15 +113,14 @@ void AudioVector<T>::OverwriteAt(const T* insert_this,
                                  size_t length,
                                  size_t position) {
   // Cap the insert position at the current vector length.
-  position = std::min(vector_.size(), position);
+  position = std::min(Size(), position);
   // Extend the vector if needed. (It is valid to overwrite beyond the current
   // end of the vector.)
-  if (position + length > vector_.size()) {
-    Extend(position + length - vector_.size());
-  }
-  for (size_t i = 0; i < length; ++i) {
-    vector_[position + i] = insert_this[i];
+  if (position + length > Size()) {
+    Extend(position + length - Size());
   }
+  if (length > 0)
+    memcpy(array_.get() + begin_ + position, insert_this, length * sizeof(T));
 }
 
 template<typename T>
@@ -148,7 +140,7 @@ void AudioVector<T>::CrossFade(const AudioVector<T>& append_this,
   int alpha = 16384;
   for (size_t i = 0; i < fade_length; ++i) {
     alpha -= alpha_step;
-    vector_[position + i] = (alpha * vector_[position + i] +
+    (*this)[position + i] = (alpha * (*this)[position + i] +
         (16384 - alpha) * append_this[i] + 8192) >> 14;
   }
   assert(alpha >= 0);  // Verify that the slope was correct.
@@ -178,7 +170,7 @@ void AudioVector<double>::CrossFade(const AudioVector<double>& append_this,
   int alpha = 16384;
   for (size_t i = 0; i < fade_length; ++i) {
     alpha -= alpha_step;
-    vector_[position + i] = (alpha * vector_[position + i] +
+    (*this)[position + i] = (alpha * (*this)[position + i] +
         (16384 - alpha) * append_this[i]) / 16384;
   }
   assert(alpha >= 0);  // Verify that the slope was correct.
@@ -190,12 +182,58 @@ void AudioVector<double>::CrossFade(const AudioVector<double>& append_this,
 
 template<typename T>
 const T& AudioVector<T>::operator[](size_t index) const {
-  return vector_[index];
+  return array_.get()[begin_ + index];
 }
 
 template<typename T>
 T& AudioVector<T>::operator[](size_t index) {
-  return vector_[index];
+  return array_.get()[begin_ + index];
+}
+
+template<typename T>
+void AudioVector<T>::Reserve(size_t front_length, size_t back_length) {
+  if (begin_ >= front_length && capacity_ - end_ >= back_length)
+    return;
+  const size_t size = Size();
+  const size_t needed = size + front_length + back_length;
+  if (2 * needed <= capacity_) {
+    // Enough room overall; center the elements in the current array.
+    const size_t new_begin = front_length + (capacity_ - needed) / 2;
+    memmove(array_.get() + new_begin, array_.get() + begin_,
+            size * sizeof(T));
+    begin_ = new_begin;
+  } else {
+    const size_t new_capacity = 2 * needed;
+    const size_t new_begin = front_length + (new_capacity - needed) / 2;
+    T* new_array = new T[new_capacity];
+    if (size > 0)
+      memcpy(new_array + new_begin, array_.get() + begin_, size * sizeof(T));
+    array_.reset(new_array);
+    capacity_ = new_capacity;
+    begin_ = new_begin;
+  }
+  end_ = begin_ + size;
+}
+
+template<typename T>
+T* AudioVector<T>::InsertGap(size_t length, size_t position) {
+  // Cap the position at the current vector length.
+  position = std::min(Size(), position);
+  if (position < Size() - position) {
+    // Move the elements before |position| towards the front.
+    Reserve(length, 0);
+    memmove(array_.get() + begin_ - length, array_.get() + begin_,
+            position * sizeof(T));
+    begin_ -= length;
+  } else {
+    // Move the elements after |position| towards the back.
+    Reserve(0, length);
+    memmove(array_.get() + begin_ + position + length,
+            array_.get() + begin_ + position,
+            (Size() - position) * sizeof(T));
+    end_ += length;
+  }
+  return array_.get() + begin_ + position;
 }
 
 // Instantiate the template for a few types.
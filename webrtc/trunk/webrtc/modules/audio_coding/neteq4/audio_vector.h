@@ -12,21 +12,29 @@
 #define WEBRTC_MODULES_AUDIO_CODING_NETEQ4_AUDIO_VECTOR_H_
 
 #include <cstring>  // Access to size_t.
-#include <vector>
 
 #include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
 
 namespace webrtc {
 
+// The samples are stored contiguously, with free space kept both before and
+// after them. Removing samples from either end is therefore O(1), and adding
+// samples at either end only moves the existing samples when the free space
+// on that side runs out, which makes a steady push-back/pop-front pattern (as
+// in SyncBuffer) amortized O(1) per sample, without reallocating.
 template <typename T>
 class AudioVector {
  public:
   // Creates an empty AudioVector.
-  AudioVector() {}
+  AudioVector()
+      : array_(NULL),
+        capacity_(0),
+        begin_(0),
+        end_(0) {}
 
   // Creates an AudioVector with an initial size.
-  explicit AudioVector(size_t initial_size)
-      : vector_(initial_size, 0) {}
+  explicit AudioVector(size_t initial_size);
 
   virtual ~AudioVector() {}
 
@@ -86,17 +94,31 @@ class AudioVector {
   virtual void CrossFade(const AudioVector<T>& append_this, size_t fade_length);
 
   // Returns the number of elements in this AudioVector.
-  virtual size_t Size() const { return vector_.size(); }
+  virtual size_t Size() const { return end_ - begin_; }
 
   // Returns true if this AudioVector is empty.
-  virtual bool Empty() const { return vector_.empty(); }
+  virtual bool Empty() const { return begin_ == end_; }
 
-  // Accesses and modifies an element of AudioVector.
+  // Accesses and modifies an element of AudioVector. The elements are
+  // contiguous in memory.
   const T& operator[](size_t index) const;
   T& operator[](size_t index);
 
  private:
-  std::vector<T> vector_;
+  // Makes sure that there is room for at least |front_length| elements before
+  // and |back_length| elements after the current ones. The elements are moved
+  // to the middle of the array if the array is at least twice the size needed,
+  // otherwise a new array of twice the size needed is allocated.
+  void Reserve(size_t front_length, size_t back_length);
+
+  // Opens a gap of |length| uninitialized elements at |position|, moving the
+  // elements on the shorter side of |position|. Returns the start of the gap.
+  T* InsertGap(size_t length, size_t position);
+
+  scoped_array<T> array_;
+  size_t capacity_;  // Number of elements allocated in |array_|.
+  size_t begin_;  // Index of the first element in |array_|.
+  size_t end_;  // Index after the last element in |array_|.
 
   DISALLOW_COPY_AND_ASSIGN(AudioVector);
 };
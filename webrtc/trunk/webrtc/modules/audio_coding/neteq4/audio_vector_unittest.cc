@@ -405,4 +405,42 @@ TYPED_TEST(AudioVectorTest, CrossFade) {
   }
 }
 
+// Push back and pop front many times, as SyncBuffer does, and make sure that
+// the contents stay contiguous and in order while the storage is reused.
+TYPED_TEST(AudioVectorTest, PushBackPopFrontCycles) {
+  AudioVector<TypeParam> vec;
+  vec.PushBack(this->array_, TestFixture::kLength);
+  size_t next_value = TestFixture::kLength;
+  for (int cycle = 0; cycle < 1000; ++cycle) {
+    TypeParam chunk[3];
+    for (size_t i = 0; i < 3; ++i) {
+      chunk[i] = static_cast<TypeParam>(next_value++);
+    }
+    vec.PushBack(chunk, 3);
+    vec.PopFront(3);
+    ASSERT_EQ(static_cast<size_t>(TestFixture::kLength), vec.Size());
+    const TypeParam* data = &vec[0];
+    for (size_t i = 0; i < TestFixture::kLength; ++i) {
+      ASSERT_EQ(static_cast<TypeParam>(next_value - TestFixture::kLength + i),
+                data[i]);
+    }
+  }
+}
+
+// Pop from the front and push new values back in front, so that the space
+// freed at the front is reused.
+TYPED_TEST(AudioVectorTest, PopFrontThenPushFront) {
+  AudioVector<TypeParam> vec;
+  vec.PushBack(this->array_, TestFixture::kLength);
+  vec.PopFront(4);
+  vec.PushFront(this->array_, 6);
+  ASSERT_EQ(static_cast<size_t>(TestFixture::kLength) + 2, vec.Size());
+  for (size_t i = 0; i < 6; ++i) {
+    EXPECT_EQ(this->array_[i], vec[i]);
+  }
+  for (size_t i = 4; i < TestFixture::kLength; ++i) {
+    EXPECT_EQ(this->array_[i], vec[i + 2]);
+  }
+}
+
 }  // namespace webrtc
@@ -33,6 +33,7 @@
 #include "webrtc/modules/audio_coding/neteq4/normal.h"
 #include "webrtc/modules/audio_coding/neteq4/packet_buffer.h"
 #include "webrtc/modules/audio_coding/neteq4/packet.h"
+#include "webrtc/modules/audio_coding/neteq4/packet_pool.h"
 #include "webrtc/modules/audio_coding/neteq4/payload_splitter.h"
 #include "webrtc/modules/audio_coding/neteq4/post_decode_vad.h"
 #include "webrtc/modules/audio_coding/neteq4/preemptive_expand.h"
@@ -88,7 +89,8 @@ NetEqImpl::NetEqImpl(int fs,
       dtmf_enabled_(true),
       error_code_(0),
       decoder_error_code_(0),
-      crit_sect_(CriticalSectionWrapper::CreateCriticalSection()) {
+      crit_sect_(CriticalSectionWrapper::CreateCriticalSection()),
+      packet_pool_(kMaxNumPacketsInBuffer) {
   if (fs != 8000 && fs != 16000 && fs != 32000 && fs != 48000) {
     LOG(LS_ERROR) << "Sample rate " << fs << " Hz not supported. " <<
         "Changing to 8000 Hz.";
@@ -363,20 +365,15 @@ int NetEqImpl::InsertPacketInternal(const WebRtcRTPHeader& rtp_header,
     // Create |packet| within this separate scope, since it should not be used
     // directly once it's been inserted in the packet list. This way, |packet|
     // is not defined outside of this block.
-    Packet* packet = new Packet;
+    // The packet and its payload array are reused from an earlier packet
+    // whenever possible.
+    Packet* packet = packet_pool_.GetPacket(length_bytes);
     packet->header.markerBit = false;
     packet->header.payloadType = rtp_header.header.payloadType;
     packet->header.sequenceNumber = rtp_header.header.sequenceNumber;
     packet->header.timestamp = rtp_header.header.timestamp;
     packet->header.ssrc = rtp_header.header.ssrc;
     packet->header.numCSRCs = 0;
-    packet->payload_length = length_bytes;
-    packet->primary = true;
-    packet->waiting_time = 0;
-    packet->payload = new uint8_t[packet->payload_length];
-    if (!packet->payload) {
-      LOG_F(LS_ERROR) << "Payload pointer is NULL.";
-    }
     assert(payload);  // Already checked above.
     memcpy(packet->payload, payload, packet->payload_length);
     // Insert packet in a packet list.
@@ -464,9 +461,7 @@ int NetEqImpl::InsertPacketInternal(const WebRtcRTPHeader& rtp_header,
           return kDtmfInsertError;
         }
       }
-      // TODO(hlundin): Let the destructor of Packet handle the payload.
-      delete [] current_packet->payload;
-      delete current_packet;
+      packet_pool_.ReturnPacket(current_packet);
       it = packet_list.erase(it);
     } else {
       ++it;
@@ -1135,8 +1130,7 @@ int NetEqImpl::DecodeLoop(PacketList* packet_list, Operations* operation,
                                       speech_type);
     }
 
-    delete[] packet->payload;
-    delete packet;
+    packet_pool_.ReturnPacket(packet);
     if (decode_length > 0) {
       *decoded_length += decode_length;
       // Update |decoder_frame_length_| with number of samples per channel.
@@ -17,6 +17,7 @@
 #include "webrtc/modules/audio_coding/neteq4/defines.h"
 #include "webrtc/modules/audio_coding/neteq4/interface/neteq.h"
 #include "webrtc/modules/audio_coding/neteq4/packet.h"  // Declare PacketList.
+#include "webrtc/modules/audio_coding/neteq4/packet_pool.h"
 #include "webrtc/modules/audio_coding/neteq4/random_vector.h"
 #include "webrtc/modules/audio_coding/neteq4/rtcp.h"
 #include "webrtc/modules/audio_coding/neteq4/statistics_calculator.h"
@@ -315,6 +316,7 @@ class NetEqImpl : public webrtc::NetEq {
   int error_code_;  // Store last error code.
   int decoder_error_code_;
   CriticalSectionWrapper* crit_sect_;
+  PacketPool packet_pool_;
 
   DISALLOW_COPY_AND_ASSIGN(NetEqImpl);
 };
@@ -25,13 +25,16 @@ struct Packet {
   int payload_length;
   bool primary;  // Primary, i.e., not redundant payload.
   int waiting_time;
+  int payload_capacity;  // Allocated size of |payload| if it was taken from a
+                         // PacketPool, otherwise 0.
 
   // Constructor.
   Packet()
       : payload(NULL),
         payload_length(0),
         primary(true),
-        waiting_time(0) {
+        waiting_time(0),
+        payload_capacity(0) {
   }
 
   // Comparison operators. Establish a packet ordering based on (1) timestamp,
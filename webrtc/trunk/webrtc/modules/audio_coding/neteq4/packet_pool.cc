@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_coding/neteq4/packet_pool.h"
+
+#include <assert.h>
+
+#include <algorithm>  // max
+
+namespace webrtc {
+
+PacketPool::PacketPool(size_t max_free_packets)
+    : max_free_packets_(max_free_packets) {
+  free_packets_.reserve(max_free_packets_);
+}
+
+PacketPool::~PacketPool() {
+  for (size_t i = 0; i < free_packets_.size(); ++i) {
+    delete [] free_packets_[i]->payload;
+    delete free_packets_[i];
+  }
+}
+
+Packet* PacketPool::GetPacket(int payload_length) {
+  assert(payload_length >= 0);
+  Packet* packet;
+  if (free_packets_.empty()) {
+    packet = new Packet;
+  } else {
+    packet = free_packets_.back();
+    free_packets_.pop_back();
+    packet->primary = true;
+    packet->waiting_time = 0;
+  }
+  if (!packet->payload || packet->payload_capacity < payload_length) {
+    delete [] packet->payload;
+    // Round up to the granularity; an empty payload still gets an array.
+    packet->payload_capacity =
+        (std::max(payload_length, 1) + kPayloadGranularityBytes - 1) /
+        kPayloadGranularityBytes * kPayloadGranularityBytes;
+    packet->payload = new uint8_t[packet->payload_capacity];
+  }
+  packet->payload_length = payload_length;
+  return packet;
+}
+
+void PacketPool::ReturnPacket(Packet* packet) {
+  if (!packet) {
+    return;
+  }
+  if (free_packets_.size() >= max_free_packets_) {
+    delete [] packet->payload;
+    delete packet;
+    return;
+  }
+  if (packet->payload_capacity == 0) {
+    // The payload was not allocated by the pool, and its size is unknown.
+    delete [] packet->payload;
+    packet->payload = NULL;
+  }
+  packet->payload_length = 0;
+  free_packets_.push_back(packet);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,58 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_CODING_NETEQ4_PACKET_POOL_H_
+#define WEBRTC_MODULES_AUDIO_CODING_NETEQ4_PACKET_POOL_H_
+
+#include <vector>
+
+#include "webrtc/modules/audio_coding/neteq4/packet.h"
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// Keeps Packet objects and their payload arrays after they have been decoded,
+// so that new packets can be created without allocating memory. Packets taken
+// from the pool are ordinary Packets; they may also be deleted with delete
+// and delete [] as usual, in which case they are simply not reused. The class
+// is not thread safe.
+class PacketPool {
+ public:
+  // Creates a pool keeping at most |max_free_packets| unused packets.
+  explicit PacketPool(size_t max_free_packets);
+
+  virtual ~PacketPool();
+
+  // Returns a packet with room for a payload of |payload_length| bytes, and
+  // with |payload_length| set. The other members have their default values.
+  // The caller takes ownership of the packet.
+  virtual Packet* GetPacket(int payload_length);
+
+  // Gives |packet| and its payload back to the pool. Packets that did not come
+  // from the pool are accepted too; their payload is deleted.
+  virtual void ReturnPacket(Packet* packet);
+
+  // Returns the number of unused packets held by the pool.
+  virtual size_t NumFreePackets() const { return free_packets_.size(); }
+
+ private:
+  // Payload arrays are allocated in multiples of this size, so that a slightly
+  // larger payload can reuse the array of a previous packet.
+  static const int kPayloadGranularityBytes = 128;
+
+  std::vector<Packet*> free_packets_;
+  size_t max_free_packets_;
+
+  DISALLOW_COPY_AND_ASSIGN(PacketPool);
+};
+
+}  // namespace webrtc
+#endif  // WEBRTC_MODULES_AUDIO_CODING_NETEQ4_PACKET_POOL_H_
@@ -0,0 +1,95 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Unit tests for PacketPool class.
+
+#include "webrtc/modules/audio_coding/neteq4/packet_pool.h"
+
+#include "gtest/gtest.h"
+
+namespace webrtc {
+
+TEST(PacketPool, CreateAndDestroy) {
+  PacketPool* pool = new PacketPool(10);
+  EXPECT_EQ(0u, pool->NumFreePackets());
+  delete pool;
+}
+
+TEST(PacketPool, ReusesPacketAndPayload) {
+  PacketPool pool(10);
+  Packet* packet = pool.GetPacket(100);
+  ASSERT_TRUE(packet != NULL);
+  ASSERT_TRUE(packet->payload != NULL);
+  EXPECT_EQ(100, packet->payload_length);
+  EXPECT_LE(100, packet->payload_capacity);
+  packet->primary = false;
+  packet->waiting_time = 17;
+  uint8_t* payload = packet->payload;
+  pool.ReturnPacket(packet);
+  EXPECT_EQ(1u, pool.NumFreePackets());
+
+  // A slightly larger payload still fits in the same array.
+  Packet* packet2 = pool.GetPacket(110);
+  EXPECT_EQ(packet, packet2);
+  EXPECT_EQ(payload, packet2->payload);
+  EXPECT_EQ(110, packet2->payload_length);
+  EXPECT_TRUE(packet2->primary);
+  EXPECT_EQ(0, packet2->waiting_time);
+  EXPECT_EQ(0u, pool.NumFreePackets());
+
+  // A much larger payload needs a new array.
+  pool.ReturnPacket(packet2);
+  Packet* packet3 = pool.GetPacket(1000);
+  EXPECT_EQ(1000, packet3->payload_length);
+  EXPECT_LE(1000, packet3->payload_capacity);
+  pool.ReturnPacket(packet3);
+}
+
+TEST(PacketPool, EmptyPayload) {
+  PacketPool pool(10);
+  Packet* packet = pool.GetPacket(0);
+  EXPECT_TRUE(packet->payload != NULL);
+  EXPECT_EQ(0, packet->payload_length);
+  pool.ReturnPacket(packet);
+}
+
+// Packets that were not taken from the pool are accepted, but their payload
+// is deleted since its size is unknown.
+TEST(PacketPool, ReturnForeignPacket) {
+  PacketPool pool(10);
+  Packet* packet = new Packet;
+  packet->payload = new uint8_t[50];
+  packet->payload_length = 50;
+  pool.ReturnPacket(packet);
+  EXPECT_EQ(1u, pool.NumFreePackets());
+  Packet* packet2 = pool.GetPacket(20);
+  EXPECT_EQ(packet, packet2);
+  EXPECT_TRUE(packet2->payload != NULL);
+  EXPECT_LE(20, packet2->payload_capacity);
+  delete [] packet2->payload;
+  delete packet2;
+}
+
+TEST(PacketPool, KeepsAtMostMaxFreePackets) {
+  const size_t kMaxFreePackets = 3;
+  PacketPool pool(kMaxFreePackets);
+  Packet* packets[2 * kMaxFreePackets];
+  for (size_t i = 0; i < 2 * kMaxFreePackets; ++i) {
+    packets[i] = pool.GetPacket(10);
+  }
+  for (size_t i = 0; i < 2 * kMaxFreePackets; ++i) {
+    pool.ReturnPacket(packets[i]);
+  }
+  EXPECT_EQ(kMaxFreePackets, pool.NumFreePackets());
+  pool.ReturnPacket(NULL);
+  EXPECT_EQ(kMaxFreePackets, pool.NumFreePackets());
+}
+
+}  // namespace webrtc
@@ -19,6 +19,7 @@
 #include "webrtc/modules/audio_coding/neteq4/test/NETEQTEST_RTPpacket.h"
 #include "webrtc/modules/audio_coding/neteq4/test/NETEQTEST_DummyRTPpacket.h"
 #include "webrtc/modules/interface/module_common_types.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/system_wrappers/interface/trace.h"
 #include "webrtc/test/testsupport/fileutils.h"
 #include "webrtc/typedefs.h"
@@ -164,6 +165,11 @@ int main(int argc, char* argv[]) {
     std::cout  << "Warning: RTP file is empty" << std::endl;
   }
 
+  // Time spent inside NetEq, for the complexity estimate printed at the end.
+  int64_t insert_time_us = 0;
+  int64_t get_audio_time_us = 0;
+  int64_t decoded_ms = 0;
+
   // This is the main simulation loop.
   int time_now_ms = rtp->time();  // Start immediately with the first packet.
   int next_input_time_ms = rtp->time();
@@ -181,9 +187,11 @@ int main(int argc, char* argv[]) {
         // Parse RTP header.
         WebRtcRTPHeader rtp_header;
         rtp->parseHeader(&rtp_header);
+        int64_t start_us = webrtc::TickTime::MicrosecondTimestamp();
         int error = neteq->InsertPacket(rtp_header, rtp->payload(),
                                          rtp->payloadLen(),
                                          rtp->time() * sample_rate_hz / 1000);
+        insert_time_us += webrtc::TickTime::MicrosecondTimestamp() - start_us;
         if (error != NetEq::kOK) {
           std::cerr << "InsertPacket returned error code " <<
               neteq->LastError() << std::endl;
@@ -201,8 +209,11 @@ int main(int argc, char* argv[]) {
       int16_t out_data[kOutDataLen];
       int num_channels;
       int samples_per_channel;
+      int64_t start_us = webrtc::TickTime::MicrosecondTimestamp();
       int error = neteq->GetAudio(kOutDataLen, out_data, &samples_per_channel,
                                    &num_channels, NULL);
+      get_audio_time_us += webrtc::TickTime::MicrosecondTimestamp() - start_us;
+      decoded_ms += kOutputBlockSizeMs;
       if (error != NetEq::kOK) {
         std::cerr << "GetAudio returned error code " <<
             neteq->LastError() << std::endl;
@@ -227,6 +238,17 @@ int main(int argc, char* argv[]) {
 
   std::cout << "Simulation done" << std::endl;
 
+  // Report the time spent in NetEq per second of decoded audio, comparable to
+  // the RecIn/RecOut complexity estimates printed by NetEqRTPplay for the
+  // legacy NetEQ.
+  if (decoded_ms > 0) {
+    printf("Decoded audio: %.2f s\n", decoded_ms / 1000.0);
+    printf("InsertPacket: %.3f ms per decoded second\n",
+           insert_time_us / static_cast<double>(decoded_ms));
+    printf("GetAudio: %.3f ms per decoded second\n",
+           get_audio_time_us / static_cast<double>(decoded_ms));
+  }
+
   fclose(in_file);
   fclose(out_file);
   delete neteq;
@@ -79,6 +79,12 @@ public:
     // downsampling of audio contributing to the mixed audio.
     virtual WebRtc_Word32 SetMinimumMixingFrequency(Frequency freq) = 0;
 
+    // Set the maximum number of (non-anonymous) participants that are mixed
+    // in each iteration. When more participants are active the ones with the
+    // highest energy are mixed. The default is
+    // kMaximumAmountOfMixedParticipants.
+    virtual WebRtc_Word32 SetMaximumMixedParticipants(int maxParticipants) = 0;
+
 protected:
     AudioConferenceMixer() {}
 };
@@ -8,12 +8,14 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <algorithm>
+#include <string.h>
+
 #include "audio_conference_mixer_defines.h"
 #include "audio_conference_mixer_impl.h"
 #include "audio_frame_manipulator.h"
 #include "audio_processing.h"
 #include "critical_section_wrapper.h"
-#include "map_wrapper.h"
 #include "modules/utility/interface/audio_frame_operations.h"
 #include "trace.h"
 
@@ -21,37 +23,69 @@ namespace webrtc {
 namespace {
 
 // Mix |frame| into |mixed_frame|, with saturation protection and upmixing.
-// These effects are applied to |frame| itself prior to mixing. Assumes that
+// |frame| is halved as it is added, to avoid saturation in the mixing.
+// Upmixing is applied to |frame| itself prior to mixing. Assumes that
 // |mixed_frame| always has at least as many channels as |frame|. Supports
 // stereo at most.
 //
 // TODO(andrew): consider not modifying |frame| here.
-void MixFrames(AudioFrame* mixed_frame, AudioFrame* frame) {
+void MixFrames(AudioFrame* mixed_frame, AudioFrame* frame, MixFunction mix) {
   assert(mixed_frame->num_channels_ >= frame->num_channels_);
-  // Divide by two to avoid saturation in the mixing.
-  *frame >>= 1;
   if (mixed_frame->num_channels_ > frame->num_channels_) {
     // We only support mono-to-stereo.
     assert(mixed_frame->num_channels_ == 2 &&
            frame->num_channels_ == 1);
     AudioFrameOperations::MonoToStereo(frame);
   }
+  if (mixed_frame->num_channels_ != frame->num_channels_) {
+    return;
+  }
+
+  const int length = frame->samples_per_channel_ * frame->num_channels_;
+  if (mixed_frame->samples_per_channel_ != frame->samples_per_channel_) {
+    if (mixed_frame->samples_per_channel_ != 0) {
+      return;
+    }
+    // Nothing mixed yet; start from silence.
+    mixed_frame->samples_per_channel_ = frame->samples_per_channel_;
+    memset(mixed_frame->data_, 0, sizeof(mixed_frame->data_[0]) * length);
+  }
 
-  *mixed_frame += *frame;
+  // Same bookkeeping as AudioFrame::operator+=.
+  if (mixed_frame->vad_activity_ == AudioFrame::kVadActive ||
+      frame->vad_activity_ == AudioFrame::kVadActive) {
+    mixed_frame->vad_activity_ = AudioFrame::kVadActive;
+  } else if (mixed_frame->vad_activity_ == AudioFrame::kVadUnknown ||
+             frame->vad_activity_ == AudioFrame::kVadUnknown) {
+    mixed_frame->vad_activity_ = AudioFrame::kVadUnknown;
+  }
+  if (mixed_frame->speech_type_ != frame->speech_type_) {
+    mixed_frame->speech_type_ = AudioFrame::kUndefined;
+  }
+
+  mix(mixed_frame->data_, frame->data_, length, 1);
+  mixed_frame->energy_ = 0xffffffff;
 }
 
 // Return the max number of channels from a |list| composed of AudioFrames.
-int MaxNumChannels(const ListWrapper& list) {
-  ListItem* item = list.First();
+int MaxNumChannels(const AudioFrameList& list) {
   int max_num_channels = 1;
-  while (item) {
-    AudioFrame* frame = static_cast<AudioFrame*>(item->GetItem());
-    max_num_channels = std::max(max_num_channels, frame->num_channels_);
-    item = list.Next(item);
+  for (AudioFrameList::const_iterator it = list.begin(); it != list.end();
+       ++it) {
+    max_num_channels = std::max(max_num_channels, (*it)->num_channels_);
   }
   return max_num_channels;
 }
 
+// Orders candidates so that the one with the lowest energy is on top of a
+// heap.
+struct HigherEnergy {
+  template <typename T>
+  bool operator()(const T& lhs, const T& rhs) const {
+    return lhs.audioFrame->energy_ > rhs.audioFrame->energy_;
+  }
+};
+
 void SetParticipantStatistics(ParticipantStatistics* stats,
                               const AudioFrame& frame)
 {
@@ -125,6 +159,13 @@ AudioConferenceMixerImpl::AudioConferenceMixerImpl(int id)
       _scratchMixedParticipants(),
       _scratchVadPositiveParticipantsAmount(0),
       _scratchVadPositiveParticipants(),
+      _scratchMixList(),
+      _scratchRampOutList(),
+      _scratchAdditionalFramesList(),
+      _scratchMixedParticipantsList(),
+      _scratchActive(),
+      _scratchPassiveWasMixed(),
+      _scratchPassiveWasNotMixed(),
       _crit(NULL),
       _cbCrit(NULL),
       _id(id),
@@ -139,12 +180,14 @@ AudioConferenceMixerImpl::AudioConferenceMixerImpl(int id)
       _audioFramePool(NULL),
       _participantList(),
       _additionalParticipantList(),
+      _maxMixedParticipants(kMaximumAmountOfMixedParticipants),
       _numMixedParticipants(0),
       _timeStamp(0),
       _timeScheduler(kProcessPeriodicityInMs),
       _mixedAudioLevel(),
       _processCalls(0),
-      _limiter(NULL)
+      _limiter(NULL),
+      _mixFunction(GetMixFunction())
 {}
 
 bool AudioConferenceMixerImpl::Init()
@@ -226,8 +269,6 @@ WebRtc_Word32 AudioConferenceMixerImpl::TimeUntilNextProcess()
 
 WebRtc_Word32 AudioConferenceMixerImpl::Process()
 {
-    WebRtc_UWord32 remainingParticipantsAllowedToMix =
-        kMaximumAmountOfMixedParticipants;
     {
         CriticalSectionScoped cs(_crit.get());
         assert(_processCalls == 0);
@@ -237,13 +278,20 @@ WebRtc_Word32 AudioConferenceMixerImpl::Process()
         _timeScheduler.UpdateScheduler();
     }
 
-    ListWrapper mixList;
-    ListWrapper rampOutList;
-    ListWrapper additionalFramesList;
-    MapWrapper mixedParticipantsMap;
+    AudioFrameList& mixList = _scratchMixList;
+    AudioFrameList& rampOutList = _scratchRampOutList;
+    AudioFrameList& additionalFramesList = _scratchAdditionalFramesList;
+    MixerParticipantList& mixedParticipants = _scratchMixedParticipantsList;
     {
         CriticalSectionScoped cs(_cbCrit.get());
 
+        const WebRtc_UWord32 maxMixedParticipants = _maxMixedParticipants;
+        if(_scratchMixedParticipants.size() != maxMixedParticipants)
+        {
+            _scratchMixedParticipants.resize(maxMixedParticipants);
+            _scratchVadPositiveParticipants.resize(maxMixedParticipants);
+        }
+
         WebRtc_Word32 lowFreq = GetLowestMixingFrequency();
         // SILK can run in 12 kHz and 24 kHz. These frequencies are not
         // supported so use the closest higher frequency to not lose any
@@ -297,18 +345,15 @@ WebRtc_Word32 AudioConferenceMixerImpl::Process()
             }
         }
 
-        UpdateToMix(mixList, rampOutList, mixedParticipantsMap,
-                    remainingParticipantsAllowedToMix);
+        UpdateToMix(mixList, rampOutList, mixedParticipants,
+                    maxMixedParticipants);
 
         GetAdditionalAudio(additionalFramesList);
-        UpdateMixedStatus(mixedParticipantsMap);
-        _scratchParticipantsToMixAmount = mixedParticipantsMap.Size();
+        UpdateMixedStatus(mixedParticipants);
+        _scratchParticipantsToMixAmount = mixedParticipants.size();
     }
-
-    // Clear mixedParticipantsMap to avoid memory leak warning.
-    // Please note that the mixedParticipantsMap doesn't own any dynamically
-    // allocated memory.
-    while(mixedParticipantsMap.Erase(mixedParticipantsMap.First()) == 0) {}
+    // mixedParticipants doesn't own any memory.
+    mixedParticipants.clear();
 
     // Get an AudioFrame for mixing from the memory pool.
     AudioFrame* mixedAudio = NULL;
@@ -317,6 +362,9 @@ WebRtc_Word32 AudioConferenceMixerImpl::Process()
         WEBRTC_TRACE(kTraceMemory, kTraceAudioMixerServer, _id,
                      "failed PopMemory() call");
         assert(false);
+        ClearAudioFrameList(mixList);
+        ClearAudioFrameList(rampOutList);
+        ClearAudioFrameList(additionalFramesList);
         return -1;
     }
 
@@ -392,12 +440,12 @@ WebRtc_Word32 AudioConferenceMixerImpl::Process()
         {
             _mixerStatusCallback->MixedParticipants(
                 _id,
-                _scratchMixedParticipants,
+                &_scratchMixedParticipants[0],
                 _scratchParticipantsToMixAmount);
 
             _mixerStatusCallback->VADPositiveParticipants(
                 _id,
-                _scratchVadPositiveParticipants,
+                &_scratchVadPositiveParticipants[0],
                 _scratchVadPositiveParticipantsAmount);
             _mixerStatusCallback->MixedAudioLevel(_id,audioLevel);
         }
@@ -573,13 +621,7 @@ WebRtc_Word32 AudioConferenceMixerImpl::SetMixabilityStatus(
             return -1;
         }
 
-        int numMixedNonAnonymous = _participantList.GetSize();
-        if (numMixedNonAnonymous > kMaximumAmountOfMixedParticipants)
-        {
-            numMixedNonAnonymous = kMaximumAmountOfMixedParticipants;
-        }
-        numMixedParticipants = numMixedNonAnonymous +
-                               _additionalParticipantList.GetSize();
+        numMixedParticipants = NumMixedParticipants();
     }
     // A MixerParticipant was added or removed. Make sure the scratch
     // buffer is updated if necessary.
@@ -647,6 +689,35 @@ WebRtc_Word32 AudioConferenceMixerImpl::AnonymousMixabilityStatus(
     return 0;
 }
 
+WebRtc_Word32 AudioConferenceMixerImpl::SetMaximumMixedParticipants(
+    int maxParticipants)
+{
+    if(maxParticipants < 1)
+    {
+        WEBRTC_TRACE(kTraceError, kTraceAudioMixerServer, _id,
+                     "SetMaximumMixedParticipants incorrect value: %d",
+                     maxParticipants);
+        return -1;
+    }
+    WebRtc_UWord32 numMixedParticipants;
+    {
+        CriticalSectionScoped cs(_cbCrit.get());
+        _maxMixedParticipants = maxParticipants;
+        numMixedParticipants = NumMixedParticipants();
+    }
+    // Note: The scratch buffers are resized in Process().
+    CriticalSectionScoped cs(_crit.get());
+    _numMixedParticipants = numMixedParticipants;
+    return 0;
+}
+
+WebRtc_UWord32 AudioConferenceMixerImpl::NumMixedParticipants() const
+{
+    const WebRtc_UWord32 numMixedNonAnonymous =
+        std::min<size_t>(_participantList.size(), _maxMixedParticipants);
+    return numMixedNonAnonymous + _additionalParticipantList.size();
+}
+
 WebRtc_Word32 AudioConferenceMixerImpl::SetMinimumMixingFrequency(
     Frequency freq)
 {
@@ -697,74 +768,81 @@ WebRtc_Word32 AudioConferenceMixerImpl::GetLowestMixingFrequency()
 }
 
 WebRtc_Word32 AudioConferenceMixerImpl::GetLowestMixingFrequencyFromList(
-    ListWrapper& mixList)
+    const MixerParticipantList& mixList)
 {
     WebRtc_Word32 highestFreq = 8000;
-    ListItem* item = mixList.First();
-    while(item)
+    for(size_t i = 0; i < mixList.size(); i++)
     {
-        MixerParticipant* participant =
-            static_cast<MixerParticipant*>(item->GetItem());
-        const WebRtc_Word32 neededFrequency = participant->NeededFrequency(_id);
+        const WebRtc_Word32 neededFrequency =
+            mixList[i]->NeededFrequency(_id);
         if(neededFrequency > highestFreq)
         {
             highestFreq = neededFrequency;
         }
-        item = mixList.Next(item);
     }
     return highestFreq;
 }
 
 void AudioConferenceMixerImpl::UpdateToMix(
-    ListWrapper& mixList,
-    ListWrapper& rampOutList,
-    MapWrapper& mixParticipantList,
-    WebRtc_UWord32& maxAudioFrameCounter)
+    AudioFrameList& mixList,
+    AudioFrameList& rampOutList,
+    MixerParticipantList& mixedParticipants,
+    size_t maxAudioFrameCounter)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
-                 "UpdateToMix(mixList,rampOutList,mixParticipantList,%d)",
-                 maxAudioFrameCounter);
-    const WebRtc_UWord32 mixListStartSize = mixList.GetSize();
-    ListWrapper activeList; // Elements are AudioFrames
-    // Struct needed by the passive lists to keep track of which AudioFrame
-    // belongs to which MixerParticipant.
-    struct ParticipantFramePair
-    {
-        MixerParticipant* participant;
-        AudioFrame* audioFrame;
-    };
-    ListWrapper passiveWasNotMixedList; // Elements are MixerParticipant
-    ListWrapper passiveWasMixedList;    // Elements are MixerParticipant
-    ListItem* item = _participantList.First();
-    while(item)
+                 "UpdateToMix(mixList,rampOutList,mixedParticipants,%d)",
+                 static_cast<int>(maxAudioFrameCounter));
+    assert(mixList.empty() && rampOutList.empty() &&
+           mixedParticipants.empty());
+    assert(maxAudioFrameCounter > 0);
+    std::vector<MixCandidate>& activeList = _scratchActive;
+    std::vector<MixCandidate>& passiveWasMixedList = _scratchPassiveWasMixed;
+    std::vector<MixCandidate>& passiveWasNotMixedList =
+        _scratchPassiveWasNotMixed;
+    // True when activeList is full and has been turned into a min-heap on
+    // energy.
+    bool activeHeap = false;
+
+    size_t index = 0;
+    while(index < _participantList.size())
     {
+        MixerParticipant* participant = _participantList[index];
         // Stop keeping track of passive participants if there are already
         // enough participants available (they wont be mixed anyway).
-        bool mustAddToPassiveList = (maxAudioFrameCounter >
-                                    (activeList.GetSize() +
-                                     passiveWasMixedList.GetSize() +
-                                     passiveWasNotMixedList.GetSize()));
-
-        MixerParticipant* participant = static_cast<MixerParticipant*>(
-            item->GetItem());
-        bool wasMixed = false;
-        participant->_mixHistory->WasMixed(wasMixed);
-        AudioFrame* audioFrame = NULL;
-        if(_audioFramePool->PopMemory(audioFrame) == -1)
+        const bool mustAddToPassiveList = (maxAudioFrameCounter >
+                                           (activeList.size() +
+                                            passiveWasMixedList.size() +
+                                            passiveWasNotMixedList.size()));
+
+        MixCandidate candidate;
+        candidate.participant = participant;
+        candidate.audioFrame = NULL;
+        candidate.wasMixed = false;
+        participant->_mixHistory->WasMixed(candidate.wasMixed);
+        if(_audioFramePool->PopMemory(candidate.audioFrame) == -1)
         {
             WEBRTC_TRACE(kTraceMemory, kTraceAudioMixerServer, _id,
                          "failed PopMemory() call");
             assert(false);
             return;
         }
+        AudioFrame* audioFrame = candidate.audioFrame;
         audioFrame->sample_rate_hz_ = _outputFrequency;
 
-        if(participant->GetAudioFrame(_id,*audioFrame) != 0)
+        const int getAudioFrameResult =
+            participant->GetAudioFrame(_id, *audioFrame);
+        // The GetAudioFrame() callback may remove the participant from the
+        // list. Only step past it if it is still there.
+        if(index < _participantList.size() &&
+           _participantList[index] == participant)
+        {
+            index++;
+        }
+        if(getAudioFrameResult != 0)
         {
             WEBRTC_TRACE(kTraceWarning, kTraceAudioMixerServer, _id,
                          "failed to GetAudioFrame() from participant");
             _audioFramePool->PushMemory(audioFrame);
-            item = _participantList.Next(item);
             continue;
         }
         // TODO(henrike): this assert triggers in some test cases where SRTP is
@@ -779,180 +857,118 @@ void AudioConferenceMixerImpl::UpdateToMix(
 
         if(audioFrame->vad_activity_ == AudioFrame::kVadActive)
         {
-            if(!wasMixed)
+            if(!candidate.wasMixed)
             {
                 RampIn(*audioFrame);
             }
 
-            if(activeList.GetSize() >= maxAudioFrameCounter)
+            if(activeList.size() < maxAudioFrameCounter)
             {
-                // There are already more active participants than should be
-                // mixed. Only keep the ones with the highest energy.
-                ListItem* replaceItem = NULL;
-                CalculateEnergy(*audioFrame);
-                WebRtc_UWord32 lowestEnergy = audioFrame->energy_;
-
-                ListItem* activeItem = activeList.First();
-                while(activeItem)
-                {
-                    AudioFrame* replaceFrame = static_cast<AudioFrame*>(
-                        activeItem->GetItem());
-                    CalculateEnergy(*replaceFrame);
-                    if(replaceFrame->energy_ < lowestEnergy)
-                    {
-                        replaceItem = activeItem;
-                        lowestEnergy = replaceFrame->energy_;
-                    }
-                    activeItem = activeList.Next(activeItem);
-                }
-                if(replaceItem != NULL)
+                activeList.push_back(candidate);
+                continue;
+            }
+            // There are already more active participants than should be
+            // mixed. Only keep the ones with the highest energy. The lowest
+            // energy frame is kept on top of the heap.
+            if(!activeHeap)
+            {
+                for(size_t i = 0; i < activeList.size(); i++)
                 {
-                    AudioFrame* replaceFrame = static_cast<AudioFrame*>(
-                        replaceItem->GetItem());
-
-                    bool replaceWasMixed = false;
-                    MapItem* replaceParticipant = mixParticipantList.Find(
-                        replaceFrame->id_);
-                    // When a frame is pushed to |activeList| it is also pushed
-                    // to mixParticipantList with the frame's id. This means
-                    // that the Find call above should never fail.
-                    if(replaceParticipant == NULL)
-                    {
-                        assert(false);
-                    } else {
-                        static_cast<MixerParticipant*>(
-                            replaceParticipant->GetItem())->_mixHistory->
-                            WasMixed(replaceWasMixed);
-
-                        mixParticipantList.Erase(replaceFrame->id_);
-                        activeList.Erase(replaceItem);
-
-                        activeList.PushFront(static_cast<void*>(audioFrame));
-                        mixParticipantList.Insert(
-                            audioFrame->id_,
-                            static_cast<void*>(participant));
-                        assert(mixParticipantList.Size() <=
-                               kMaximumAmountOfMixedParticipants);
-
-                        if(replaceWasMixed)
-                        {
-                            RampOut(*replaceFrame);
-                            rampOutList.PushBack(
-                                static_cast<void*>(replaceFrame));
-                            assert(rampOutList.GetSize() <=
-                                   kMaximumAmountOfMixedParticipants);
-                        } else {
-                            _audioFramePool->PushMemory(replaceFrame);
-                        }
-                    }
-                } else {
-                    if(wasMixed)
-                    {
-                        RampOut(*audioFrame);
-                        rampOutList.PushBack(static_cast<void*>(audioFrame));
-                        assert(rampOutList.GetSize() <=
-                               kMaximumAmountOfMixedParticipants);
-                    } else {
-                        _audioFramePool->PushMemory(audioFrame);
-                    }
+                    CalculateEnergy(*activeList[i].audioFrame);
                 }
+                std::make_heap(activeList.begin(), activeList.end(),
+                               HigherEnergy());
+                activeHeap = true;
+            }
+            CalculateEnergy(*audioFrame);
+            if(audioFrame->energy_ > activeList.front().audioFrame->energy_)
+            {
+                std::pop_heap(activeList.begin(), activeList.end(),
+                              HigherEnergy());
+                DropCandidate(activeList.back(), rampOutList);
+                activeList.back() = candidate;
+                std::push_heap(activeList.begin(), activeList.end(),
+                               HigherEnergy());
             } else {
-                activeList.PushFront(static_cast<void*>(audioFrame));
-                mixParticipantList.Insert(audioFrame->id_,
-                                          static_cast<void*>(participant));
-                assert(mixParticipantList.Size() <=
-                       kMaximumAmountOfMixedParticipants);
+                DropCandidate(candidate, rampOutList);
             }
         } else {
-            if(wasMixed)
+            if(candidate.wasMixed)
             {
-                ParticipantFramePair* pair = new ParticipantFramePair;
-                pair->audioFrame  = audioFrame;
-                pair->participant = participant;
-                passiveWasMixedList.PushBack(static_cast<void*>(pair));
+                passiveWasMixedList.push_back(candidate);
             } else if(mustAddToPassiveList) {
                 RampIn(*audioFrame);
-                ParticipantFramePair* pair = new ParticipantFramePair;
-                pair->audioFrame  = audioFrame;
-                pair->participant = participant;
-                passiveWasNotMixedList.PushBack(static_cast<void*>(pair));
+                passiveWasNotMixedList.push_back(candidate);
             } else {
                 _audioFramePool->PushMemory(audioFrame);
             }
         }
-        item = _participantList.Next(item);
     }
-    assert(activeList.GetSize() <= maxAudioFrameCounter);
+    assert(activeList.size() <= maxAudioFrameCounter);
     // At this point it is known which participants should be mixed. Transfer
     // this information to this functions output parameters.
-    while(!activeList.Empty())
+    for(size_t i = 0; i < activeList.size(); i++)
     {
-        ListItem* mixItem = activeList.First();
-        mixList.PushBack(mixItem->GetItem());
-        activeList.Erase(mixItem);
+        mixList.push_back(activeList[i].audioFrame);
+        mixedParticipants.push_back(activeList[i].participant);
     }
+    activeList.clear();
     // Always mix a constant number of AudioFrames. If there aren't enough
     // active participants mix passive ones. Starting with those that was mixed
     // last iteration.
-    while(!passiveWasMixedList.Empty())
+    for(size_t i = 0; i < passiveWasMixedList.size(); i++)
     {
-        ListItem* mixItem = passiveWasMixedList.First();
-        ParticipantFramePair* pair = static_cast<ParticipantFramePair*>(
-            mixItem->GetItem());
-        if(mixList.GetSize() <  maxAudioFrameCounter + mixListStartSize)
+        if(mixList.size() < maxAudioFrameCounter)
         {
-            mixList.PushBack(pair->audioFrame);
-            mixParticipantList.Insert(pair->audioFrame->id_,
-                                      static_cast<void*>(pair->participant));
-            assert(mixParticipantList.Size() <=
-                   kMaximumAmountOfMixedParticipants);
+            mixList.push_back(passiveWasMixedList[i].audioFrame);
+            mixedParticipants.push_back(passiveWasMixedList[i].participant);
         }
         else
         {
-            _audioFramePool->PushMemory(pair->audioFrame);
+            _audioFramePool->PushMemory(passiveWasMixedList[i].audioFrame);
         }
-        delete pair;
-        passiveWasMixedList.Erase(mixItem);
     }
+    passiveWasMixedList.clear();
     // And finally the ones that have not been mixed for a while.
-    while(!passiveWasNotMixedList.Empty())
+    for(size_t i = 0; i < passiveWasNotMixedList.size(); i++)
     {
-        ListItem* mixItem = passiveWasNotMixedList.First();
-        ParticipantFramePair* pair = static_cast<ParticipantFramePair*>(
-            mixItem->GetItem());
-        if(mixList.GetSize() <  maxAudioFrameCounter + mixListStartSize)
+        if(mixList.size() < maxAudioFrameCounter)
         {
-            mixList.PushBack(pair->audioFrame);
-            mixParticipantList.Insert(pair->audioFrame->id_,
-                                      static_cast<void*>(pair->participant));
-            assert(mixParticipantList.Size() <=
-                   kMaximumAmountOfMixedParticipants);
+            mixList.push_back(passiveWasNotMixedList[i].audioFrame);
+            mixedParticipants.push_back(
+                passiveWasNotMixedList[i].participant);
         }
         else
         {
-            _audioFramePool->PushMemory(pair->audioFrame);
+            _audioFramePool->PushMemory(passiveWasNotMixedList[i].audioFrame);
         }
-        delete pair;
-        passiveWasNotMixedList.Erase(mixItem);
     }
-    assert(maxAudioFrameCounter + mixListStartSize >= mixList.GetSize());
-    maxAudioFrameCounter += mixListStartSize - mixList.GetSize();
+    passiveWasNotMixedList.clear();
+    assert(maxAudioFrameCounter >= mixList.size());
+}
+
+void AudioConferenceMixerImpl::DropCandidate(const MixCandidate& candidate,
+                                             AudioFrameList& rampOutList)
+{
+    AudioFrame* audioFrame = candidate.audioFrame;
+    if(candidate.wasMixed)
+    {
+        RampOut(*audioFrame);
+        rampOutList.push_back(audioFrame);
+    } else {
+        _audioFramePool->PushMemory(audioFrame);
+    }
 }
 
 void AudioConferenceMixerImpl::GetAdditionalAudio(
-    ListWrapper& additionalFramesList)
+    AudioFrameList& additionalFramesList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "GetAdditionalAudio(additionalFramesList)");
-    ListItem* item = _additionalParticipantList.First();
-    while(item)
+    size_t index = 0;
+    while(index < _additionalParticipantList.size())
     {
-        // The GetAudioFrame() callback may remove the current item. Store the
-        // next item just in case that happens.
-        ListItem* nextItem = _additionalParticipantList.Next(item);
-
-        MixerParticipant* participant = static_cast<MixerParticipant*>(
-            item->GetItem());
+        MixerParticipant* participant = _additionalParticipantList[index];
         AudioFrame* audioFrame = NULL;
         if(_audioFramePool->PopMemory(audioFrame) == -1)
         {
@@ -962,83 +978,76 @@ void AudioConferenceMixerImpl::GetAdditionalAudio(
             return;
         }
         audioFrame->sample_rate_hz_ = _outputFrequency;
-        if(participant->GetAudioFrame(_id, *audioFrame) != 0)
+        const int getAudioFrameResult =
+            participant->GetAudioFrame(_id, *audioFrame);
+        // The GetAudioFrame() callback may remove the participant from the
+        // list. Only step past it if it is still there.
+        if(index < _additionalParticipantList.size() &&
+           _additionalParticipantList[index] == participant)
+        {
+            index++;
+        }
+        if(getAudioFrameResult != 0)
         {
             WEBRTC_TRACE(kTraceWarning, kTraceAudioMixerServer, _id,
                          "failed to GetAudioFrame() from participant");
             _audioFramePool->PushMemory(audioFrame);
-            item = nextItem;
             continue;
         }
         if(audioFrame->samples_per_channel_ == 0)
         {
             // Empty frame. Don't use it.
             _audioFramePool->PushMemory(audioFrame);
-            item = nextItem;
             continue;
         }
-        additionalFramesList.PushBack(static_cast<void*>(audioFrame));
-        item = nextItem;
+        additionalFramesList.push_back(audioFrame);
     }
 }
 
 void AudioConferenceMixerImpl::UpdateMixedStatus(
-    MapWrapper& mixedParticipantsMap)
+    const MixerParticipantList& mixedParticipants)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
-                 "UpdateMixedStatus(mixedParticipantsMap)");
-    assert(mixedParticipantsMap.Size() <= kMaximumAmountOfMixedParticipants);
+                 "UpdateMixedStatus(mixedParticipants)");
+    assert(mixedParticipants.size() <= _maxMixedParticipants);
 
-    // Loop through all participants. If they are in the mix map they
-    // were mixed.
-    ListItem* participantItem = _participantList.First();
-    while(participantItem != NULL)
+    // Clear the status of all participants, then mark the ones that were
+    // mixed.
+    for(size_t i = 0; i < _participantList.size(); i++)
     {
-        bool isMixed = false;
-        MixerParticipant* participant =
-            static_cast<MixerParticipant*>(participantItem->GetItem());
-
-        MapItem* mixedItem = mixedParticipantsMap.First();
-        while(mixedItem)
-        {
-            if(participant == mixedItem->GetItem())
-            {
-                isMixed = true;
-                break;
-            }
-            mixedItem = mixedParticipantsMap.Next(mixedItem);
-        }
-        participant->_mixHistory->SetIsMixed(isMixed);
-        participantItem = _participantList.Next(participantItem);
+        _participantList[i]->_mixHistory->SetIsMixed(false);
+    }
+    for(size_t i = 0; i < mixedParticipants.size(); i++)
+    {
+        mixedParticipants[i]->_mixHistory->SetIsMixed(true);
     }
 }
 
-void AudioConferenceMixerImpl::ClearAudioFrameList(ListWrapper& audioFrameList)
+void AudioConferenceMixerImpl::ClearAudioFrameList(
+    AudioFrameList& audioFrameList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "ClearAudioFrameList(audioFrameList)");
-    ListItem* item = audioFrameList.First();
-    while(item)
+    for(size_t i = 0; i < audioFrameList.size(); i++)
     {
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
-        _audioFramePool->PushMemory(audioFrame);
-        audioFrameList.Erase(item);
-        item = audioFrameList.First();
+        _audioFramePool->PushMemory(audioFrameList[i]);
     }
+    audioFrameList.clear();
 }
 
 void AudioConferenceMixerImpl::UpdateVADPositiveParticipants(
-    ListWrapper& mixList)
+    const AudioFrameList& mixList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "UpdateVADPositiveParticipants(mixList)");
 
-    ListItem* item = mixList.First();
-    while(item != NULL)
+    for(size_t i = 0; i < mixList.size(); i++)
     {
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
+        AudioFrame* audioFrame = mixList[i];
         CalculateEnergy(*audioFrame);
-        if(audioFrame->vad_activity_ == AudioFrame::kVadActive)
+        if(audioFrame->vad_activity_ == AudioFrame::kVadActive &&
+           _scratchVadPositiveParticipantsAmount <
+               _scratchVadPositiveParticipants.size())
         {
             _scratchVadPositiveParticipants[
                 _scratchVadPositiveParticipantsAmount].participant =
@@ -1048,40 +1057,26 @@ void AudioConferenceMixerImpl::UpdateVADPositiveParticipants(
                 _scratchVadPositiveParticipantsAmount].level = 0;
             _scratchVadPositiveParticipantsAmount++;
         }
-        item = mixList.Next(item);
     }
 }
 
 bool AudioConferenceMixerImpl::IsParticipantInList(
     MixerParticipant& participant,
-    ListWrapper& participantList)
+    const MixerParticipantList& participantList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "IsParticipantInList(participant,participantList)");
-    ListItem* item = participantList.First();
-    while(item != NULL)
-    {
-        MixerParticipant* rhsParticipant =
-            static_cast<MixerParticipant*>(item->GetItem());
-        if(&participant == rhsParticipant)
-        {
-            return true;
-        }
-        item = participantList.Next(item);
-    }
-    return false;
+    return std::find(participantList.begin(), participantList.end(),
+                     &participant) != participantList.end();
 }
 
 bool AudioConferenceMixerImpl::AddParticipantToList(
     MixerParticipant& participant,
-    ListWrapper& participantList)
+    MixerParticipantList& participantList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "AddParticipantToList(participant, participantList)");
-    if(participantList.PushBack(static_cast<void*>(&participant)) == -1)
-    {
-        return false;
-    }
+    participantList.push_back(&participant);
     // Make sure that the mixed status is correct for new MixerParticipant.
     participant._mixHistory->ResetMixedStatus();
     return true;
@@ -1089,34 +1084,30 @@ bool AudioConferenceMixerImpl::AddParticipantToList(
 
 bool AudioConferenceMixerImpl::RemoveParticipantFromList(
     MixerParticipant& participant,
-    ListWrapper& participantList)
+    MixerParticipantList& participantList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "RemoveParticipantFromList(participant, participantList)");
-    ListItem* item = participantList.First();
-    while(item)
+    MixerParticipantList::iterator it = std::find(participantList.begin(),
+                                                  participantList.end(),
+                                                  &participant);
+    if(it == participantList.end())
     {
-        if(item->GetItem() == &participant)
-        {
-            participantList.Erase(item);
-            // Participant is no longer mixed, reset to default.
-            participant._mixHistory->ResetMixedStatus();
-            return true;
-        }
-        item = participantList.Next(item);
+        return false;
     }
-    return false;
+    participantList.erase(it);
+    // Participant is no longer mixed, reset to default.
+    participant._mixHistory->ResetMixedStatus();
+    return true;
 }
 
 WebRtc_Word32 AudioConferenceMixerImpl::MixFromList(
     AudioFrame& mixedAudio,
-    const ListWrapper& audioFrameList)
+    const AudioFrameList& audioFrameList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "MixFromList(mixedAudio, audioFrameList)");
-    WebRtc_UWord32 position = 0;
-    ListItem* item = audioFrameList.First();
-    if(item == NULL)
+    if(audioFrameList.empty())
     {
         return 0;
     }
@@ -1124,35 +1115,34 @@ WebRtc_Word32 AudioConferenceMixerImpl::MixFromList(
     if(_numMixedParticipants == 1)
     {
         // No mixing required here; skip the saturation protection.
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
+        AudioFrame* audioFrame = audioFrameList.front();
         mixedAudio.CopyFrom(*audioFrame);
-        SetParticipantStatistics(&_scratchMixedParticipants[position],
-                                 *audioFrame);
+        SetParticipantStatistics(&_scratchMixedParticipants[0], *audioFrame);
         return 0;
     }
 
-    while(item != NULL)
+    WebRtc_UWord32 position = 0;
+    for(size_t i = 0; i < audioFrameList.size(); i++)
     {
-        if(position >= kMaximumAmountOfMixedParticipants)
+        if(position >= _scratchMixedParticipants.size())
         {
             WEBRTC_TRACE(
                 kTraceMemory,
                 kTraceAudioMixerServer,
                 _id,
                 "Trying to mix more than max amount of mixed participants:%d!",
-                kMaximumAmountOfMixedParticipants);
+                static_cast<int>(_scratchMixedParticipants.size()));
             // Assert and avoid crash
             assert(false);
             position = 0;
         }
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
-        MixFrames(&mixedAudio, audioFrame);
+        AudioFrame* audioFrame = audioFrameList[i];
+        MixFrames(&mixedAudio, audioFrame, _mixFunction);
 
         SetParticipantStatistics(&_scratchMixedParticipants[position],
                                  *audioFrame);
 
         position++;
-        item = audioFrameList.Next(item);
     }
 
     return 0;
@@ -1161,27 +1151,23 @@ WebRtc_Word32 AudioConferenceMixerImpl::MixFromList(
 // TODO(andrew): consolidate this function with MixFromList.
 WebRtc_Word32 AudioConferenceMixerImpl::MixAnonomouslyFromList(
     AudioFrame& mixedAudio,
-    const ListWrapper& audioFrameList)
+    const AudioFrameList& audioFrameList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "MixAnonomouslyFromList(mixedAudio, audioFrameList)");
-    ListItem* item = audioFrameList.First();
-    if(item == NULL)
+    if(audioFrameList.empty())
         return 0;
 
     if(_numMixedParticipants == 1)
     {
         // No mixing required here; skip the saturation protection.
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
-        mixedAudio.CopyFrom(*audioFrame);
+        mixedAudio.CopyFrom(*audioFrameList.front());
         return 0;
     }
 
-    while(item != NULL)
+    for(size_t i = 0; i < audioFrameList.size(); i++)
     {
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
-        MixFrames(&mixedAudio, audioFrame);
-        item = audioFrameList.Next(item);
+        MixFrames(&mixedAudio, audioFrameList[i], _mixFunction);
     }
     return 0;
 }
@@ -1206,7 +1192,9 @@ bool AudioConferenceMixerImpl::LimitMixedAudio(AudioFrame& mixedAudio)
     //
     // Instead we double the frame (with addition since left-shifting a
     // negative value is undefined).
-    mixedAudio += mixedAudio;
+    _mixFunction(mixedAudio.data_, mixedAudio.data_,
+                 mixedAudio.samples_per_channel_ * mixedAudio.num_channels_,
+                 0);
 
     if(error != _limiter->kNoError)
     {
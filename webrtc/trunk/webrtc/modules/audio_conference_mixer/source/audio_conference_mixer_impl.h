@@ -11,11 +11,13 @@
 #ifndef WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_AUDIO_CONFERENCE_MIXER_IMPL_H_
 #define WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_AUDIO_CONFERENCE_MIXER_IMPL_H_
 
+#include <vector>
+
 #include "audio_conference_mixer.h"
 #include "engine_configurations.h"
 #include "level_indicator.h"
-#include "list_wrapper.h"
 #include "memory_pool.h"
+#include "mix_kernel.h"
 #include "module_common_types.h"
 #include "scoped_ptr.h"
 #include "time_scheduler.h"
@@ -24,6 +26,9 @@ namespace webrtc {
 class AudioProcessing;
 class CriticalSectionWrapper;
 
+typedef std::vector<AudioFrame*> AudioFrameList;
+typedef std::vector<MixerParticipant*> MixerParticipantList;
+
 // Cheshire cat implementation of MixerParticipant's non virtual functions.
 class MixHistory
 {
@@ -80,9 +85,18 @@ public:
         MixerParticipant& participant, const bool mixable);
     virtual WebRtc_Word32 AnonymousMixabilityStatus(
         MixerParticipant& participant, bool& mixable);
+    virtual WebRtc_Word32 SetMaximumMixedParticipants(int maxParticipants);
 private:
     enum{DEFAULT_AUDIO_FRAME_POOLSIZE = 50};
 
+    // A participant's frame that is a candidate for mixing.
+    struct MixCandidate
+    {
+        MixerParticipant* participant;
+        AudioFrame* audioFrame;
+        bool wasMixed;
+    };
+
     // Set/get mix frequency
     WebRtc_Word32 SetOutputFrequency(const Frequency frequency);
     Frequency OutputFrequency() const;
@@ -92,73 +106,94 @@ private:
     bool SetNumLimiterChannels(int numChannels);
 
     // Fills mixList with the AudioFrames pointers that should be used when
-    // mixing. Fills mixParticipantList with ParticipantStatistics for the
-    // participants who's AudioFrames are inside mixList.
-    // maxAudioFrameCounter both input and output specifies how many more
-    // AudioFrames that are allowed to be mixed.
+    // mixing, at most maxAudioFrameCounter of them. Fills mixedParticipants
+    // with the participants who's AudioFrames are inside mixList.
+    // If there are more active participants than can be mixed, the ones with
+    // the highest energy are chosen.
     // rampOutList contain AudioFrames corresponding to an audio stream that
     // used to be mixed but shouldn't be mixed any longer. These AudioFrames
     // should be ramped out over this AudioFrame to avoid audio discontinuities.
-    void UpdateToMix(ListWrapper& mixList, ListWrapper& rampOutList,
-                     MapWrapper& mixParticipantList,
-                     WebRtc_UWord32& maxAudioFrameCounter);
+    void UpdateToMix(AudioFrameList& mixList, AudioFrameList& rampOutList,
+                     MixerParticipantList& mixedParticipants,
+                     size_t maxAudioFrameCounter);
+
+    // Removes the frame of |candidate| from the mix. The frame is ramped out
+    // and added to rampOutList if it was mixed last iteration, otherwise it
+    // is returned to the memory pool.
+    void DropCandidate(const MixCandidate& candidate,
+                       AudioFrameList& rampOutList);
 
     // Return the lowest mixing frequency that can be used without having to
     // downsample any audio.
     WebRtc_Word32 GetLowestMixingFrequency();
-    WebRtc_Word32 GetLowestMixingFrequencyFromList(ListWrapper& mixList);
+    WebRtc_Word32 GetLowestMixingFrequencyFromList(
+        const MixerParticipantList& mixList);
 
     // Return the AudioFrames that should be mixed anonymously.
-    void GetAdditionalAudio(ListWrapper& additionalFramesList);
+    void GetAdditionalAudio(AudioFrameList& additionalFramesList);
 
-    // Update the MixHistory of all MixerParticipants. mixedParticipantsList
-    // should contain a map of MixerParticipants that have been mixed.
-    void UpdateMixedStatus(MapWrapper& mixedParticipantsList);
+    // Update the MixHistory of all MixerParticipants. mixedParticipants
+    // should contain the MixerParticipants that have been mixed.
+    void UpdateMixedStatus(const MixerParticipantList& mixedParticipants);
 
     // Clears audioFrameList and reclaims all memory associated with it.
-    void ClearAudioFrameList(ListWrapper& audioFrameList);
+    void ClearAudioFrameList(AudioFrameList& audioFrameList);
 
     // Update the list of MixerParticipants who have a positive VAD. mixList
     // should be a list of AudioFrames
     void UpdateVADPositiveParticipants(
-        ListWrapper& mixList);
+        const AudioFrameList& mixList);
 
     // This function returns true if it finds the MixerParticipant in the
     // specified list of MixerParticipants.
     bool IsParticipantInList(
         MixerParticipant& participant,
-        ListWrapper& participantList);
+        const MixerParticipantList& participantList);
 
     // Add/remove the MixerParticipant to the specified
     // MixerParticipant list.
     bool AddParticipantToList(
         MixerParticipant& participant,
-        ListWrapper& participantList);
+        MixerParticipantList& participantList);
     bool RemoveParticipantFromList(
         MixerParticipant& removeParticipant,
-        ListWrapper& participantList);
+        MixerParticipantList& participantList);
+
+    // Number of participants mixed each iteration, given the current lists
+    // and limit.
+    WebRtc_UWord32 NumMixedParticipants() const;
 
     // Mix the AudioFrames stored in audioFrameList into mixedAudio.
     WebRtc_Word32 MixFromList(
         AudioFrame& mixedAudio,
-        const ListWrapper& audioFrameList);
+        const AudioFrameList& audioFrameList);
     // Mix the AudioFrames stored in audioFrameList into mixedAudio. No
     // record will be kept of this mix (e.g. the corresponding MixerParticipants
     // will not be marked as IsMixed()
     WebRtc_Word32 MixAnonomouslyFromList(AudioFrame& mixedAudio,
-                                         const ListWrapper& audioFrameList);
+                                         const AudioFrameList& audioFrameList);
 
     bool LimitMixedAudio(AudioFrame& mixedAudio);
 
     // Scratch memory
     // Note that the scratch memory may only be touched in the scope of
-    // Process().
+    // Process(). The statistics arrays hold one entry per participant that
+    // may be mixed.
     WebRtc_UWord32         _scratchParticipantsToMixAmount;
-    ParticipantStatistics  _scratchMixedParticipants[
-        kMaximumAmountOfMixedParticipants];
+    std::vector<ParticipantStatistics> _scratchMixedParticipants;
     WebRtc_UWord32         _scratchVadPositiveParticipantsAmount;
-    ParticipantStatistics  _scratchVadPositiveParticipants[
-        kMaximumAmountOfMixedParticipants];
+    std::vector<ParticipantStatistics> _scratchVadPositiveParticipants;
+    // Lists reused by Process() and UpdateToMix() to avoid reallocating them
+    // every iteration.
+    AudioFrameList         _scratchMixList;
+    AudioFrameList         _scratchRampOutList;
+    AudioFrameList         _scratchAdditionalFramesList;
+    MixerParticipantList   _scratchMixedParticipantsList;
+    // Active candidates, kept as a min-heap on energy once there are more of
+    // them than can be mixed.
+    std::vector<MixCandidate> _scratchActive;
+    std::vector<MixCandidate> _scratchPassiveWasMixed;
+    std::vector<MixCandidate> _scratchPassiveWasNotMixed;
 
     scoped_ptr<CriticalSectionWrapper> _crit;
     scoped_ptr<CriticalSectionWrapper> _cbCrit;
@@ -183,8 +218,13 @@ private:
     MemoryPool<AudioFrame>* _audioFramePool;
 
     // List of all participants. Note all lists are disjunct
-    ListWrapper _participantList;              // May be mixed.
-    ListWrapper _additionalParticipantList;    // Always mixed, anonomously.
+    MixerParticipantList _participantList;            // May be mixed.
+    MixerParticipantList _additionalParticipantList;  // Always mixed,
+                                                      // anonomously.
+
+    // Maximum number of non-anonymous participants to mix. Protected by
+    // _cbCrit.
+    WebRtc_UWord32 _maxMixedParticipants;
 
     WebRtc_UWord32 _numMixedParticipants;
 
@@ -202,6 +242,9 @@ private:
 
     // Used for inhibiting saturation in mixing.
     scoped_ptr<AudioProcessing> _limiter;
+
+    // Saturating add, picked for the CPU at construction.
+    MixFunction _mixFunction;
 };
 } // namespace webrtc
 
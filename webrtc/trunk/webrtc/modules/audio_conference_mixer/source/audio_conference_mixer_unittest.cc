@@ -0,0 +1,248 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "modules/audio_conference_mixer/interface/audio_conference_mixer.h"
+#include "modules/audio_conference_mixer/interface/audio_conference_mixer_defines.h"
+#include "modules/audio_conference_mixer/source/mix_kernel.h"
+#include "system_wrappers/interface/scoped_ptr.h"
+#include "system_wrappers/interface/tick_util.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+const int kSampleRateHz = 16000;
+const int kSamplesPerChannel = kSampleRateHz / 100;
+
+// Produces a constant frame of |amplitude|, with the given VAD decision.
+class FakeParticipant : public MixerParticipant {
+ public:
+  FakeParticipant(int id, int16_t amplitude, bool active)
+      : id_(id), amplitude_(amplitude), active_(active) {}
+
+  virtual WebRtc_Word32 GetAudioFrame(const WebRtc_Word32 id,
+                                      AudioFrame& audio_frame) {
+    int16_t data[kSamplesPerChannel];
+    for (int i = 0; i < kSamplesPerChannel; ++i) {
+      // Alternate the sign, so that each frame sounds like something.
+      data[i] = (i & 1) ? -amplitude_ : amplitude_;
+    }
+    audio_frame.UpdateFrame(id_, 0, data, kSamplesPerChannel, kSampleRateHz,
+                            AudioFrame::kNormalSpeech,
+                            active_ ? AudioFrame::kVadActive :
+                                      AudioFrame::kVadPassive);
+    return 0;
+  }
+
+  virtual WebRtc_Word32 NeededFrequency(const WebRtc_Word32 id) {
+    return kSampleRateHz;
+  }
+
+  bool mixed() const {
+    bool mixed = false;
+    IsMixed(mixed);
+    return mixed;
+  }
+
+ private:
+  int id_;
+  int16_t amplitude_;
+  bool active_;
+};
+
+class NullOutputReceiver : public AudioMixerOutputReceiver {
+ public:
+  NullOutputReceiver() : frames_(0) {}
+
+  virtual void NewMixedAudio(const WebRtc_Word32 id,
+                             const AudioFrame& general_audio_frame,
+                             const AudioFrame** unique_audio_frames,
+                             const WebRtc_UWord32 size) {
+    ++frames_;
+  }
+
+  int frames() const { return frames_; }
+
+ private:
+  int frames_;
+};
+
+void RandomSamples(int16_t* data, int length) {
+  for (int i = 0; i < length; ++i) {
+    data[i] = static_cast<int16_t>(rand() - RAND_MAX / 2);
+  }
+}
+
+TEST(MixKernelTest, SaturatesAtLimits) {
+  int16_t dst[] = {32000, -32000, 100, -100, 32767, -32768, 0, 1, 2};
+  const int16_t src[] = {32000, -32000, 100, -100, 32767, -32768, 0, 1, 2};
+  const int16_t expected[] = {32767, -32768, 200, -200, 32767, -32768,
+                              0, 2, 4};
+  MixSaturated_C(dst, src, 9, 0);
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_EQ(expected[i], dst[i]) << "at " << i;
+  }
+
+  // Halving the source can't saturate a zero destination.
+  int16_t half[] = {0, 0, 0, 0};
+  const int16_t half_src[] = {32767, -32768, 3, -3};
+  MixSaturated_C(half, half_src, 4, 1);
+  EXPECT_EQ(16383, half[0]);
+  EXPECT_EQ(-16384, half[1]);
+  EXPECT_EQ(1, half[2]);
+  EXPECT_EQ(-2, half[3]);
+}
+
+TEST(MixKernelTest, FastestMatchesGeneric) {
+  const MixFunction mix = GetMixFunction();
+  const int kMaxLength = 2 * 480 + 7;
+  int16_t src[kMaxLength];
+  int16_t dst[kMaxLength];
+  int16_t reference[kMaxLength];
+  srand(42);
+  for (int shift = 0; shift <= 1; ++shift) {
+    for (int length = 0; length <= kMaxLength; length += 13) {
+      RandomSamples(src, kMaxLength);
+      RandomSamples(dst, kMaxLength);
+      memcpy(reference, dst, sizeof(dst));
+      // Start one sample in to exercise unaligned access.
+      const int offset = length > 0 ? 1 : 0;
+      mix(dst + offset, src + offset, length - offset, shift);
+      MixSaturated_C(reference + offset, src + offset, length - offset,
+                     shift);
+      ASSERT_EQ(0, memcmp(reference, dst, sizeof(dst)))
+          << "length " << length << ", shift " << shift;
+    }
+  }
+}
+
+TEST(MixKernelTest, InPlaceDoubling) {
+  const MixFunction mix = GetMixFunction();
+  int16_t data[37];
+  int16_t reference[37];
+  RandomSamples(data, 37);
+  memcpy(reference, data, sizeof(data));
+  mix(data, data, 37, 0);
+  MixSaturated_C(reference, reference, 37, 0);
+  EXPECT_EQ(0, memcmp(reference, data, sizeof(data)));
+}
+
+class AudioConferenceMixerTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    mixer_.reset(AudioConferenceMixer::Create(0));
+    ASSERT_TRUE(mixer_.get() != NULL);
+    ASSERT_EQ(0, mixer_->RegisterMixedStreamCallback(receiver_));
+  }
+
+  virtual void TearDown() {
+    for (size_t i = 0; i < participants_.size(); ++i) {
+      EXPECT_EQ(0, mixer_->SetMixabilityStatus(*participants_[i], false));
+      delete participants_[i];
+    }
+    EXPECT_EQ(0, mixer_->UnRegisterMixedStreamCallback());
+  }
+
+  FakeParticipant* AddParticipant(int16_t amplitude, bool active) {
+    FakeParticipant* participant = new FakeParticipant(
+        static_cast<int>(participants_.size()), amplitude, active);
+    participants_.push_back(participant);
+    EXPECT_EQ(0, mixer_->SetMixabilityStatus(*participant, true));
+    return participant;
+  }
+
+  scoped_ptr<AudioConferenceMixer> mixer_;
+  NullOutputReceiver receiver_;
+  std::vector<FakeParticipant*> participants_;
+};
+
+TEST_F(AudioConferenceMixerTest, MixesLoudestActiveParticipants) {
+  // Participant i has amplitude 500 * (i + 1); the loudest are last. The
+  // frame energy is a 32-bit sum, so keep the amplitudes moderate.
+  const int kNumParticipants = 8;
+  for (int i = 0; i < kNumParticipants; ++i) {
+    AddParticipant(static_cast<int16_t>(500 * (i + 1)), true);
+  }
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(0, mixer_->Process());
+  }
+  for (int i = 0; i < kNumParticipants; ++i) {
+    EXPECT_EQ(i >= kNumParticipants -
+                   AudioConferenceMixer::kMaximumAmountOfMixedParticipants,
+              participants_[i]->mixed()) << "participant " << i;
+  }
+
+  const int kMaxMixed = 5;
+  EXPECT_EQ(0, mixer_->SetMaximumMixedParticipants(kMaxMixed));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(0, mixer_->Process());
+  }
+  for (int i = 0; i < kNumParticipants; ++i) {
+    EXPECT_EQ(i >= kNumParticipants - kMaxMixed, participants_[i]->mixed())
+        << "participant " << i;
+  }
+  EXPECT_EQ(6, receiver_.frames());
+}
+
+TEST_F(AudioConferenceMixerTest, ActiveParticipantsBeforePassive) {
+  FakeParticipant* passive_loud = AddParticipant(20000, false);
+  FakeParticipant* active_quiet = AddParticipant(100, true);
+  EXPECT_EQ(0, mixer_->SetMaximumMixedParticipants(1));
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_TRUE(active_quiet->mixed());
+  EXPECT_FALSE(passive_loud->mixed());
+
+  // With room for both, the passive participant fills the remaining slot.
+  EXPECT_EQ(0, mixer_->SetMaximumMixedParticipants(2));
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_TRUE(active_quiet->mixed());
+  EXPECT_TRUE(passive_loud->mixed());
+}
+
+TEST_F(AudioConferenceMixerTest, RejectsInvalidMaximum) {
+  EXPECT_EQ(-1, mixer_->SetMaximumMixedParticipants(0));
+  EXPECT_EQ(-1, mixer_->SetMaximumMixedParticipants(-3));
+}
+
+TEST_F(AudioConferenceMixerTest, ProcessBenchmark) {
+  const int kParticipantCounts[] = {10, 50, 200};
+  const int kNumIterations = 200;
+  for (size_t n = 0; n < sizeof(kParticipantCounts) /
+                             sizeof(kParticipantCounts[0]); ++n) {
+    // Half of the participants are talking.
+    while (static_cast<int>(participants_.size()) < kParticipantCounts[n]) {
+      const int i = static_cast<int>(participants_.size());
+      AddParticipant(static_cast<int16_t>(100 + 37 * i), (i & 1) == 0);
+    }
+    // Warm up the frame pool.
+    EXPECT_EQ(0, mixer_->Process());
+    const WebRtc_Word64 start_us = TickTime::MicrosecondTimestamp();
+    for (int i = 0; i < kNumIterations; ++i) {
+      EXPECT_EQ(0, mixer_->Process());
+    }
+    const WebRtc_Word64 elapsed_us =
+        TickTime::MicrosecondTimestamp() - start_us;
+    char trace[32];
+    sprintf(trace, "%d_participants", kParticipantCounts[n]);
+    webrtc::test::PrintResult("audio_conference_mixer", "_process", trace,
+                              static_cast<size_t>(elapsed_us / kNumIterations),
+                              "us", false);
+  }
+}
+
+}  // namespace
+}  // namespace webrtc
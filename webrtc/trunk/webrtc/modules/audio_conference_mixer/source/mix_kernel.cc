@@ -0,0 +1,44 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_conference_mixer/source/mix_kernel.h"
+
+#include "system_wrappers/interface/cpu_features_wrapper.h"
+
+namespace webrtc {
+
+void MixSaturated_C(int16_t* dst, const int16_t* src, int length,
+                    int src_shift) {
+  for (int i = 0; i < length; ++i) {
+    int32_t sum = static_cast<int32_t>(dst[i]) + (src[i] >> src_shift);
+    // Clamp without branches, so that the compiler can vectorize the loop
+    // where no SIMD version is available.
+    sum = sum < -32768 ? -32768 : sum;
+    sum = sum > 32767 ? 32767 : sum;
+    dst[i] = static_cast<int16_t>(sum);
+  }
+}
+
+MixFunction GetMixFunction() {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    return MixSaturated_SSE2;
+  }
+#elif defined(WEBRTC_DETECT_ARM_NEON)
+  if ((WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) != 0) {
+    return MixSaturated_Neon;
+  }
+#elif defined(WEBRTC_ARCH_ARM_NEON)
+  return MixSaturated_Neon;
+#endif
+  return MixSaturated_C;
+}
+
+}  // namespace webrtc
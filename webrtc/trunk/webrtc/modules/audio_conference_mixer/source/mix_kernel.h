@@ -0,0 +1,44 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_MIX_KERNEL_H_
+#define WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_MIX_KERNEL_H_
+
+#include "typedefs.h"
+
+namespace webrtc {
+
+// Adds |src| arithmetically shifted right by |src_shift| bits to |dst|,
+// saturating each of the |length| sums to 16 bits. |src_shift| is in
+// [0, 15]. The buffers may have any alignment but must not overlap, unless
+// |dst| and |src| are the same buffer.
+typedef void (*MixFunction)(int16_t* dst, const int16_t* src, int length,
+                            int src_shift);
+
+// Generic implementation.
+void MixSaturated_C(int16_t* dst, const int16_t* src, int length,
+                    int src_shift);
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void MixSaturated_SSE2(int16_t* dst, const int16_t* src, int length,
+                       int src_shift);
+#endif
+
+#if (defined WEBRTC_DETECT_ARM_NEON || defined WEBRTC_ARCH_ARM_NEON)
+void MixSaturated_Neon(int16_t* dst, const int16_t* src, int length,
+                       int src_shift);
+#endif
+
+// Returns the fastest implementation supported by the CPU.
+MixFunction GetMixFunction();
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_MIX_KERNEL_H_
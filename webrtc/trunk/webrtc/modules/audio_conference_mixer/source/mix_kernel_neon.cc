@@ -0,0 +1,43 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_conference_mixer/source/mix_kernel.h"
+
+#include <arm_neon.h>
+
+namespace webrtc {
+
+void MixSaturated_Neon(int16_t* dst, const int16_t* src, int length,
+                       int src_shift) {
+  // A negative shift count makes vshl an arithmetic right shift.
+  const int16x8_t shift = vdupq_n_s16(static_cast<int16_t>(-src_shift));
+  int i = 0;
+  for (; i + 32 <= length; i += 32) {
+    int16x8_t d0 = vld1q_s16(dst + i);
+    int16x8_t d1 = vld1q_s16(dst + i + 8);
+    int16x8_t d2 = vld1q_s16(dst + i + 16);
+    int16x8_t d3 = vld1q_s16(dst + i + 24);
+    d0 = vqaddq_s16(d0, vshlq_s16(vld1q_s16(src + i), shift));
+    d1 = vqaddq_s16(d1, vshlq_s16(vld1q_s16(src + i + 8), shift));
+    d2 = vqaddq_s16(d2, vshlq_s16(vld1q_s16(src + i + 16), shift));
+    d3 = vqaddq_s16(d3, vshlq_s16(vld1q_s16(src + i + 24), shift));
+    vst1q_s16(dst + i, d0);
+    vst1q_s16(dst + i + 8, d1);
+    vst1q_s16(dst + i + 16, d2);
+    vst1q_s16(dst + i + 24, d3);
+  }
+  for (; i + 8 <= length; i += 8) {
+    int16x8_t s = vshlq_s16(vld1q_s16(src + i), shift);
+    vst1q_s16(dst + i, vqaddq_s16(vld1q_s16(dst + i), s));
+  }
+  MixSaturated_C(dst + i, src + i, length - i, src_shift);
+}
+
+}  // namespace webrtc
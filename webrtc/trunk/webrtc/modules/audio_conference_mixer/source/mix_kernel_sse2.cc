@@ -0,0 +1,51 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_conference_mixer/source/mix_kernel.h"
+
+#include <emmintrin.h>
+
+namespace webrtc {
+
+void MixSaturated_SSE2(int16_t* dst, const int16_t* src, int length,
+                       int src_shift) {
+  const __m128i shift = _mm_cvtsi32_si128(src_shift);
+  int i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i s1 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(src + i + 8));
+    __m128i s2 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(src + i + 16));
+    __m128i s3 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(src + i + 24));
+    __m128i d0 = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i));
+    __m128i d1 = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i + 8));
+    __m128i d2 = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i + 16));
+    __m128i d3 = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i + 24));
+    d0 = _mm_adds_epi16(d0, _mm_sra_epi16(s0, shift));
+    d1 = _mm_adds_epi16(d1, _mm_sra_epi16(s1, shift));
+    d2 = _mm_adds_epi16(d2, _mm_sra_epi16(s2, shift));
+    d3 = _mm_adds_epi16(d3, _mm_sra_epi16(s3, shift));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), d0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), d1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16), d2);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 24), d3);
+  }
+  for (; i + 8 <= length; i += 8) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i));
+    d = _mm_adds_epi16(d, _mm_sra_epi16(s, shift));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), d);
+  }
+  MixSaturated_C(dst + i, src + i, length - i, src_shift);
+}
+
+}  // namespace webrtc
@@ -524,22 +524,35 @@ int WebRtcAec_InitAec(aec_t *aec, int sampFreq)
     WebRtcAec_InitMetrics(aec);
 
     // Assembly optimization
-    WebRtcAec_FilterFar = FilterFar;
-    WebRtcAec_ScaleErrorSignal = ScaleErrorSignal;
-    WebRtcAec_FilterAdaptation = FilterAdaptation;
-    WebRtcAec_OverdriveAndSuppress = OverdriveAndSuppress;
-
-#if defined(WEBRTC_ARCH_X86_FAMILY)
-    if (WebRtc_GetCPUInfo(kSSE2)) {
-      WebRtcAec_InitAec_SSE2();
-    }
-#endif
-
     aec_rdft_init();
+    WebRtcAec_InitFunctions(1);
 
     return 0;
 }
 
+void WebRtcAec_InitFunctions(int optimize) {
+  WebRtcAec_FilterFar = FilterFar;
+  WebRtcAec_ScaleErrorSignal = ScaleErrorSignal;
+  WebRtcAec_FilterAdaptation = FilterAdaptation;
+  WebRtcAec_OverdriveAndSuppress = OverdriveAndSuppress;
+  aec_rdft_init_functions(optimize);
+
+  if (!optimize) {
+    return;
+  }
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    WebRtcAec_InitAec_SSE2();
+  }
+#elif defined(WEBRTC_DETECT_ARM_NEON)
+  if ((WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) != 0) {
+    WebRtcAec_InitAec_neon();
+  }
+#elif defined(WEBRTC_ARCH_ARM_NEON)
+  WebRtcAec_InitAec_neon();
+#endif
+}
+
 void WebRtcAec_InitMetrics(aec_t *aec)
 {
     aec->stateCounter = 0;
@@ -169,7 +169,14 @@ extern WebRtcAec_OverdriveAndSuppress_t WebRtcAec_OverdriveAndSuppress;
 int WebRtcAec_CreateAec(aec_t **aec);
 int WebRtcAec_FreeAec(aec_t *aec);
 int WebRtcAec_InitAec(aec_t *aec, int sampFreq);
+// Sets the function pointers above and those of the rdft to the generic C
+// versions, and then to the fastest versions supported by the CPU if
+// |optimize| is nonzero. Called by WebRtcAec_InitAec() with |optimize| set.
+void WebRtcAec_InitFunctions(int optimize);
 void WebRtcAec_InitAec_SSE2(void);
+#if (defined WEBRTC_DETECT_ARM_NEON || defined WEBRTC_ARCH_ARM_NEON)
+void WebRtcAec_InitAec_neon(void);
+#endif
 
 void WebRtcAec_InitMetrics(aec_t *aec);
 void WebRtcAec_BufferFarendPartition(aec_t *aec, const float* farend);
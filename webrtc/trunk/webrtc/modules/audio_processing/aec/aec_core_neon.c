@@ -0,0 +1,354 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The core AEC algorithm, NEON version of speed-critical functions. NEON has
+ * no division or square root, so these use refined reciprocal estimates, and
+ * the results differ from the generic C versions in the last bits.
+ */
+
+#include "aec_core.h"
+
+#include <arm_neon.h>
+#include <math.h>
+#include <string.h>  // memset
+
+#include "aec_rdft.h"
+
+__inline static float MulRe(float aRe, float aIm, float bRe, float bIm)
+{
+  return aRe * bRe - aIm * bIm;
+}
+
+__inline static float MulIm(float aRe, float aIm, float bRe, float bIm)
+{
+  return aRe * bIm + aIm * bRe;
+}
+
+// Returns 1 / |a|, from the reciprocal estimate of |a| refined with two
+// Newton-Raphson steps.
+static __inline float32x4_t ReciprocalNeon(float32x4_t a) {
+  float32x4_t reciprocal = vrecpeq_f32(a);
+  reciprocal = vmulq_f32(vrecpsq_f32(a, reciprocal), reciprocal);
+  reciprocal = vmulq_f32(vrecpsq_f32(a, reciprocal), reciprocal);
+  return reciprocal;
+}
+
+// Returns the square root of |a|, from the reciprocal square root estimate
+// refined with two Newton-Raphson steps.
+static __inline float32x4_t SqrtNeon(float32x4_t a) {
+  float32x4_t rsqrt = vrsqrteq_f32(a);
+  rsqrt = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, rsqrt), rsqrt), rsqrt);
+  rsqrt = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, rsqrt), rsqrt), rsqrt);
+  // The estimate is infinite for zero, where |a| itself is the result.
+  return vbslq_f32(vceqq_f32(a, vdupq_n_f32(0.0f)), a, vmulq_f32(a, rsqrt));
+}
+
+static void FilterFarNeon(aec_t *aec, float yf[2][PART_LEN1])
+{
+  int i;
+  for (i = 0; i < NR_PART; i++) {
+    int j;
+    int xPos = (i + aec->xfBufBlockPos) * PART_LEN1;
+    int pos = i * PART_LEN1;
+    // Check for wrap
+    if (i + aec->xfBufBlockPos >= NR_PART) {
+      xPos -= NR_PART*(PART_LEN1);
+    }
+
+    // vectorized code (four at once)
+    for (j = 0; j + 3 < PART_LEN1; j += 4) {
+      const float32x4_t xfBuf_re = vld1q_f32(&aec->xfBuf[0][xPos + j]);
+      const float32x4_t xfBuf_im = vld1q_f32(&aec->xfBuf[1][xPos + j]);
+      const float32x4_t wfBuf_re = vld1q_f32(&aec->wfBuf[0][pos + j]);
+      const float32x4_t wfBuf_im = vld1q_f32(&aec->wfBuf[1][pos + j]);
+      const float32x4_t a = vmulq_f32(xfBuf_re, wfBuf_re);
+      const float32x4_t c = vmulq_f32(xfBuf_re, wfBuf_im);
+      const float32x4_t e = vmlsq_f32(a, xfBuf_im, wfBuf_im);
+      const float32x4_t f = vmlaq_f32(c, xfBuf_im, wfBuf_re);
+      vst1q_f32(&yf[0][j], vaddq_f32(vld1q_f32(&yf[0][j]), e));
+      vst1q_f32(&yf[1][j], vaddq_f32(vld1q_f32(&yf[1][j]), f));
+    }
+    // scalar code for the remaining items.
+    for (; j < PART_LEN1; j++) {
+      yf[0][j] += MulRe(aec->xfBuf[0][xPos + j], aec->xfBuf[1][xPos + j],
+                        aec->wfBuf[0][ pos + j], aec->wfBuf[1][ pos + j]);
+      yf[1][j] += MulIm(aec->xfBuf[0][xPos + j], aec->xfBuf[1][xPos + j],
+                        aec->wfBuf[0][ pos + j], aec->wfBuf[1][ pos + j]);
+    }
+  }
+}
+
+static void ScaleErrorSignalNeon(aec_t *aec, float ef[2][PART_LEN1])
+{
+  const float32x4_t k1e_10f = vdupq_n_f32(1e-10f);
+  const float32x4_t kThresh = vdupq_n_f32(aec->errThresh);
+  const float32x4_t kMu = vdupq_n_f32(aec->mu);
+
+  int i;
+  // vectorized code (four at once)
+  for (i = 0; i + 3 < PART_LEN1; i += 4) {
+    const float32x4_t xPow = vld1q_f32(&aec->xPow[i]);
+    const float32x4_t xPowPlusInv = ReciprocalNeon(vaddq_f32(xPow, k1e_10f));
+    float32x4_t ef_re = vmulq_f32(vld1q_f32(&ef[0][i]), xPowPlusInv);
+    float32x4_t ef_im = vmulq_f32(vld1q_f32(&ef[1][i]), xPowPlusInv);
+    const float32x4_t ef_sum2 = vmlaq_f32(vmulq_f32(ef_re, ef_re),
+                                          ef_im, ef_im);
+    const float32x4_t absEf = SqrtNeon(ef_sum2);
+    const uint32x4_t bigger = vcgtq_f32(absEf, kThresh);
+    const float32x4_t absEfInv = vmulq_f32(
+        kThresh, ReciprocalNeon(vaddq_f32(absEf, k1e_10f)));
+    ef_re = vbslq_f32(bigger, vmulq_f32(ef_re, absEfInv), ef_re);
+    ef_im = vbslq_f32(bigger, vmulq_f32(ef_im, absEfInv), ef_im);
+    vst1q_f32(&ef[0][i], vmulq_f32(ef_re, kMu));
+    vst1q_f32(&ef[1][i], vmulq_f32(ef_im, kMu));
+  }
+  // scalar code for the remaining items.
+  for (; i < (PART_LEN1); i++) {
+    float absEf;
+    ef[0][i] /= (aec->xPow[i] + 1e-10f);
+    ef[1][i] /= (aec->xPow[i] + 1e-10f);
+    absEf = sqrtf(ef[0][i] * ef[0][i] + ef[1][i] * ef[1][i]);
+
+    if (absEf > aec->errThresh) {
+      absEf = aec->errThresh / (absEf + 1e-10f);
+      ef[0][i] *= absEf;
+      ef[1][i] *= absEf;
+    }
+
+    // Stepsize factor
+    ef[0][i] *= aec->mu;
+    ef[1][i] *= aec->mu;
+  }
+}
+
+static void FilterAdaptationNeon(aec_t *aec, float *fft,
+                                 float ef[2][PART_LEN1]) {
+  int i, j;
+  for (i = 0; i < NR_PART; i++) {
+    int xPos = (i + aec->xfBufBlockPos)*(PART_LEN1);
+    int pos = i * PART_LEN1;
+    // Check for wrap
+    if (i + aec->xfBufBlockPos >= NR_PART) {
+      xPos -= NR_PART * PART_LEN1;
+    }
+
+    // Process the whole array...
+    for (j = 0; j < PART_LEN; j += 4) {
+      // Load xfBuf and ef.
+      const float32x4_t xfBuf_re = vld1q_f32(&aec->xfBuf[0][xPos + j]);
+      const float32x4_t xfBuf_im = vld1q_f32(&aec->xfBuf[1][xPos + j]);
+      const float32x4_t ef_re = vld1q_f32(&ef[0][j]);
+      const float32x4_t ef_im = vld1q_f32(&ef[1][j]);
+      // Calculate the product of conjugate(xfBuf) by ef.
+      //   re(conjugate(a) * b) = aRe * bRe + aIm * bIm
+      //   im(conjugate(a) * b)=  aRe * bIm - aIm * bRe
+      float32x4x2_t g;
+      g.val[0] = vmlaq_f32(vmulq_f32(xfBuf_re, ef_re), xfBuf_im, ef_im);
+      g.val[1] = vmlsq_f32(vmulq_f32(xfBuf_re, ef_im), xfBuf_im, ef_re);
+      // Interleave real and imaginary parts, and store.
+      vst2q_f32(&fft[2 * j], g);
+    }
+    // ... and fixup the first imaginary entry.
+    fft[1] = MulRe(aec->xfBuf[0][xPos + PART_LEN],
+                   -aec->xfBuf[1][xPos + PART_LEN],
+                   ef[0][PART_LEN], ef[1][PART_LEN]);
+
+    aec_rdft_inverse_128(fft);
+    memset(fft + PART_LEN, 0, sizeof(float)*PART_LEN);
+
+    // fft scaling
+    {
+      const float scale = 2.0f / PART_LEN2;
+      for (j = 0; j < PART_LEN; j += 4) {
+        vst1q_f32(&fft[j], vmulq_n_f32(vld1q_f32(&fft[j]), scale));
+      }
+    }
+    aec_rdft_forward_128(fft);
+
+    {
+      float wt1 = aec->wfBuf[1][pos];
+      aec->wfBuf[0][pos + PART_LEN] += fft[1];
+      for (j = 0; j < PART_LEN; j += 4) {
+        const float32x4x2_t fft_ri = vld2q_f32(&fft[2 * j]);
+        const float32x4_t wtBuf_re = vld1q_f32(&aec->wfBuf[0][pos + j]);
+        const float32x4_t wtBuf_im = vld1q_f32(&aec->wfBuf[1][pos + j]);
+        vst1q_f32(&aec->wfBuf[0][pos + j], vaddq_f32(wtBuf_re, fft_ri.val[0]));
+        vst1q_f32(&aec->wfBuf[1][pos + j], vaddq_f32(wtBuf_im, fft_ri.val[1]));
+      }
+      aec->wfBuf[1][pos] = wt1;
+    }
+  }
+}
+
+static float32x4_t vpowq_f32(float32x4_t a, float32x4_t b)
+{
+  // a^b = exp2(b * log2(a))
+  //   exp2(x) and log2(x) are calculated using polynomial approximations,
+  //   the same as in the SSE2 version.
+  float32x4_t log2_a, b_log2_a, a_exp_b;
+
+  // Calculate log2(x), x = a.
+  {
+    // To calculate log2(x), we decompose x like this:
+    //   x = y * 2^n
+    //     n is an integer
+    //     y is in the [1.0, 2.0) range
+    //
+    //   log2(x) = log2(y) + n
+    //     n       can be evaluated by playing with float representation.
+    //     log2(y) in a small range can be approximated, this code uses an order
+    //             five polynomial approximation. The coefficients have been
+    //             estimated with the Remez algorithm and the resulting
+    //             polynomial has a maximum relative error of 0.00086%.
+
+    // Compute n.
+    //    This is done by masking the exponent, shifting it into the top bit of
+    //    the mantissa, putting eight into the biased exponent (to shift/
+    //    compensate the fact that the exponent has been shifted in the top/
+    //    fractional part and finally getting rid of the implicit leading one
+    //    from the mantissa by substracting it out.
+    const uint32x4_t a_bits = vreinterpretq_u32_f32(a);
+    const uint32x4_t two_n = vandq_u32(a_bits, vdupq_n_u32(0x7F800000));
+    const uint32x4_t n_1 = vshrq_n_u32(two_n, 8);
+    const uint32x4_t n_0 = vorrq_u32(n_1, vdupq_n_u32(0x43800000));
+    const float32x4_t n = vsubq_f32(
+        vreinterpretq_f32_u32(n_0),
+        vreinterpretq_f32_u32(vdupq_n_u32(0x43BF8000)));
+
+    // Compute y.
+    const uint32x4_t mantissa = vandq_u32(a_bits, vdupq_n_u32(0x007FFFFF));
+    const float32x4_t y = vreinterpretq_f32_u32(
+        vorrq_u32(mantissa, vdupq_n_u32(0x3F800000)));
+
+    // Approximate log2(y) ~= (y - 1) * pol5(y).
+    //    pol5(y) = C5 * y^5 + C4 * y^4 + C3 * y^3 + C2 * y^2 + C1 * y + C0
+    float32x4_t pol5_y = vdupq_n_f32(-3.4436006e-2f);
+    pol5_y = vmlaq_f32(vdupq_n_f32(3.1821337e-1f), pol5_y, y);
+    pol5_y = vmlaq_f32(vdupq_n_f32(-1.2315303f), pol5_y, y);
+    pol5_y = vmlaq_f32(vdupq_n_f32(2.5988452f), pol5_y, y);
+    pol5_y = vmlaq_f32(vdupq_n_f32(-3.3241990f), pol5_y, y);
+    pol5_y = vmlaq_f32(vdupq_n_f32(3.1157899f), pol5_y, y);
+    {
+      const float32x4_t y_minus_one = vsubq_f32(y, vdupq_n_f32(1.0f));
+      const float32x4_t log2_y = vmulq_f32(y_minus_one, pol5_y);
+
+      // Combine parts.
+      log2_a = vaddq_f32(n, log2_y);
+    }
+  }
+
+  // b * log2(a)
+  b_log2_a = vmulq_f32(b, log2_a);
+
+  // Calculate exp2(x), x = b * log2(a).
+  {
+    // To calculate 2^x, we decompose x like this:
+    //   x = n + y
+    //     n is an integer, the value of x rounded down, therefore
+    //     y is in the [0.0, 1.0) range
+    //
+    //   2^x = 2^n * 2^y
+    //     2^n can be evaluated by playing with float representation.
+    //     2^y in a small range can be approximated, this code uses an order two
+    //         polynomial approximation. The coefficients have been estimated
+    //         with the Remez algorithm and the resulting polynomial has a
+    //         maximum relative error of 0.17%.
+
+    // To avoid over/underflow, we reduce the range of input to ]-127, 129[.
+    const float32x4_t x_min = vminq_f32(b_log2_a, vdupq_n_f32(128.99999f));
+    const float32x4_t x_max = vmaxq_f32(x_min, vdupq_n_f32(-126.99999f));
+    // Compute n. The conversion truncates towards zero, so negative values
+    // with a fractional part are one too large.
+    const int32x4_t x_trunc = vcvtq_s32_f32(x_max);
+    const uint32x4_t too_large = vcgtq_f32(vcvtq_f32_s32(x_trunc), x_max);
+    const int32x4_t x_floor = vaddq_s32(x_trunc,
+                                        vreinterpretq_s32_u32(too_large));
+    // Compute 2^n.
+    const int32x4_t two_n_exponent = vaddq_s32(x_floor, vdupq_n_s32(127));
+    const float32x4_t two_n = vreinterpretq_f32_s32(
+        vshlq_n_s32(two_n_exponent, 23));
+    // Compute y.
+    const float32x4_t y = vsubq_f32(x_max, vcvtq_f32_s32(x_floor));
+    // Approximate 2^y ~= C2 * y^2 + C1 * y + C0.
+    float32x4_t exp2_y = vmlaq_f32(vdupq_n_f32(6.5763628e-1f),
+                                   vdupq_n_f32(3.3718944e-1f), y);
+    exp2_y = vmlaq_f32(vdupq_n_f32(1.0017247f), exp2_y, y);
+
+    // Combine parts.
+    a_exp_b = vmulq_f32(exp2_y, two_n);
+  }
+  return a_exp_b;
+}
+
+extern const float WebRtcAec_weightCurve[65];
+extern const float WebRtcAec_overDriveCurve[65];
+
+static void OverdriveAndSuppressNeon(aec_t *aec, float hNl[PART_LEN1],
+                                     const float hNlFb,
+                                     float efw[2][PART_LEN1]) {
+  int i;
+  const float32x4_t vec_hNlFb = vdupq_n_f32(hNlFb);
+  const float32x4_t vec_one = vdupq_n_f32(1.0f);
+  // vectorized code (four at once)
+  for (i = 0; i + 3 < PART_LEN1; i += 4) {
+    // Weight subbands
+    float32x4_t vec_hNl = vld1q_f32(&hNl[i]);
+    const float32x4_t vec_weightCurve = vld1q_f32(&WebRtcAec_weightCurve[i]);
+    const uint32x4_t bigger = vcgtq_f32(vec_hNl, vec_hNlFb);
+    const float32x4_t vec_weighted = vmlaq_f32(
+        vmulq_f32(vec_weightCurve, vec_hNlFb),
+        vsubq_f32(vec_one, vec_weightCurve), vec_hNl);
+    vec_hNl = vbslq_f32(bigger, vec_weighted, vec_hNl);
+
+    {
+      const float32x4_t vec_overDriveCurve =
+          vld1q_f32(&WebRtcAec_overDriveCurve[i]);
+      vec_hNl = vpowq_f32(vec_hNl,
+                          vmulq_n_f32(vec_overDriveCurve, aec->overDriveSm));
+      vst1q_f32(&hNl[i], vec_hNl);
+    }
+
+    // Suppress error signal
+    {
+      const float32x4_t vec_efw_re = vld1q_f32(&efw[0][i]);
+      const float32x4_t vec_efw_im = vld1q_f32(&efw[1][i]);
+      vst1q_f32(&efw[0][i], vmulq_f32(vec_efw_re, vec_hNl));
+
+      // Ooura fft returns incorrect sign on imaginary component. It matters
+      // here because we are making an additive change with comfort noise.
+      vst1q_f32(&efw[1][i], vnegq_f32(vmulq_f32(vec_efw_im, vec_hNl)));
+    }
+  }
+  // scalar code for the remaining items.
+  for (; i < PART_LEN1; i++) {
+    // Weight subbands
+    if (hNl[i] > hNlFb) {
+      hNl[i] = WebRtcAec_weightCurve[i] * hNlFb +
+          (1 - WebRtcAec_weightCurve[i]) * hNl[i];
+    }
+    hNl[i] = powf(hNl[i], aec->overDriveSm * WebRtcAec_overDriveCurve[i]);
+
+    // Suppress error signal
+    efw[0][i] *= hNl[i];
+    efw[1][i] *= hNl[i];
+
+    // Ooura fft returns incorrect sign on imaginary component. It matters
+    // here because we are making an additive change with comfort noise.
+    efw[1][i] *= -1;
+  }
+}
+
+void WebRtcAec_InitAec_neon(void) {
+  WebRtcAec_FilterFar = FilterFarNeon;
+  WebRtcAec_ScaleErrorSignal = ScaleErrorSignalNeon;
+  WebRtcAec_FilterAdaptation = FilterAdaptationNeon;
+  WebRtcAec_OverdriveAndSuppress = OverdriveAndSuppressNeon;
+}
@@ -0,0 +1,241 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "modules/audio_processing/aec/aec_core.h"
+#include "modules/audio_processing/aec/aec_rdft.h"
+}
+#include "modules/audio_processing/aec/include/echo_cancellation.h"
+#include "modules/audio_processing/test/test_utils.h"
+#include "system_wrappers/interface/scoped_ptr.h"
+#include "system_wrappers/interface/tick_util.h"
+#include "typedefs.h"
+
+using webrtc::ExpectNear;
+using webrtc::FillRandom;
+using webrtc::RandomFloat;
+
+namespace {
+
+// Relative to the largest magnitude in the compared data. The NEON versions
+// refine reciprocal estimates with two Newton-Raphson steps, and the rdft
+// butterflies round differently.
+const float kTolerance = 1e-5f;
+// Both the SSE2 and the NEON versions of OverdriveAndSuppress() approximate
+// powf() with polynomials.
+const float kPowTolerance = 1e-2f;
+
+struct Functions {
+  WebRtcAec_FilterFar_t filter_far;
+  WebRtcAec_ScaleErrorSignal_t scale_error_signal;
+  WebRtcAec_FilterAdaptation_t filter_adaptation;
+  WebRtcAec_OverdriveAndSuppress_t overdrive_and_suppress;
+  rft_sub_128_t cft1st;
+  rft_sub_128_t cftmdl;
+  rft_sub_128_t rftfsub;
+  rft_sub_128_t rftbsub;
+};
+
+Functions GetFunctions(int optimize) {
+  WebRtcAec_InitFunctions(optimize);
+  Functions functions = { WebRtcAec_FilterFar, WebRtcAec_ScaleErrorSignal,
+                          WebRtcAec_FilterAdaptation,
+                          WebRtcAec_OverdriveAndSuppress, cft1st_128,
+                          cftmdl_128, rftfsub_128, rftbsub_128 };
+  return functions;
+}
+
+void SetFunctions(const Functions& functions) {
+  WebRtcAec_FilterFar = functions.filter_far;
+  WebRtcAec_ScaleErrorSignal = functions.scale_error_signal;
+  WebRtcAec_FilterAdaptation = functions.filter_adaptation;
+  WebRtcAec_OverdriveAndSuppress = functions.overdrive_and_suppress;
+  cft1st_128 = functions.cft1st;
+  cftmdl_128 = functions.cftmdl;
+  rftfsub_128 = functions.rftfsub;
+  rftbsub_128 = functions.rftbsub;
+}
+
+// Fills the parts of |aec| used by the kernels.
+void FillAec(aec_t* aec) {
+  aec->xfBufBlockPos = 5;
+  FillRandom(aec->xPow, PART_LEN1, 1e3f, 1e7f);
+  FillRandom(aec->xfBuf[0], NR_PART * PART_LEN1, -1e4f, 1e4f);
+  FillRandom(aec->xfBuf[1], NR_PART * PART_LEN1, -1e4f, 1e4f);
+  FillRandom(aec->wfBuf[0], NR_PART * PART_LEN1, -1.0f, 1.0f);
+  FillRandom(aec->wfBuf[1], NR_PART * PART_LEN1, -1.0f, 1.0f);
+  aec->errThresh = 2e-6f;
+  aec->mu = 0.6f;
+  aec->overDriveSm = 2.0f;
+}
+
+// Speech-like far-end at 16 kHz. The near-end is a delayed and attenuated
+// echo of it plus noise.
+void GenerateSignals(int length, int16_t* far, int16_t* near) {
+  const int kDelaySamples = 320;
+  for (int i = 0; i < length; ++i) {
+    far[i] = webrtc::SpeechLikeSample(i, 16000);
+    float sample = RandomFloat(-100.0f, 100.0f);
+    if (i >= kDelaySamples) {
+      sample += far[i - kDelaySamples] / 2;
+    }
+    near[i] = static_cast<int16_t>(sample);
+  }
+}
+
+class AecCoreTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    srand(42);
+    aec_rdft_init();
+    optimized_ = GetFunctions(1);
+    generic_ = GetFunctions(0);
+    generic_aec_.reset(new aec_t);
+    optimized_aec_.reset(new aec_t);
+    memset(generic_aec_.get(), 0, sizeof(aec_t));
+    FillAec(generic_aec_.get());
+    memcpy(optimized_aec_.get(), generic_aec_.get(), sizeof(aec_t));
+  }
+
+  virtual void TearDown() {
+    WebRtcAec_InitFunctions(1);
+  }
+
+  // Runs the forward and inverse transforms with |functions|.
+  void Rdft(const Functions& functions, float* forward, float* inverse) {
+    SetFunctions(functions);
+    aec_rdft_forward_128(forward);
+    aec_rdft_inverse_128(inverse);
+  }
+
+  Functions generic_;
+  Functions optimized_;
+  webrtc::scoped_ptr<aec_t> generic_aec_;
+  webrtc::scoped_ptr<aec_t> optimized_aec_;
+};
+
+TEST_F(AecCoreTest, RdftMatchesGeneric) {
+  float forward[2][PART_LEN2];
+  float inverse[2][PART_LEN2];
+  FillRandom(forward[0], PART_LEN2, -30000.0f, 30000.0f);
+  FillRandom(inverse[0], PART_LEN2, -30000.0f, 30000.0f);
+  memcpy(forward[1], forward[0], sizeof(forward[0]));
+  memcpy(inverse[1], inverse[0], sizeof(inverse[0]));
+
+  Rdft(generic_, forward[0], inverse[0]);
+  Rdft(optimized_, forward[1], inverse[1]);
+
+  ExpectNear(forward[0], forward[1], PART_LEN2, kTolerance);
+  ExpectNear(inverse[0], inverse[1], PART_LEN2, kTolerance);
+}
+
+TEST_F(AecCoreTest, FilterFarMatchesGeneric) {
+  float yf[2][2][PART_LEN1];
+  FillRandom(yf[0][0], PART_LEN1, -1e4f, 1e4f);
+  FillRandom(yf[0][1], PART_LEN1, -1e4f, 1e4f);
+  memcpy(yf[1], yf[0], sizeof(yf[0]));
+
+  generic_.filter_far(generic_aec_.get(), yf[0]);
+  optimized_.filter_far(optimized_aec_.get(), yf[1]);
+
+  ExpectNear(yf[0][0], yf[1][0], PART_LEN1, kTolerance);
+  ExpectNear(yf[0][1], yf[1][1], PART_LEN1, kTolerance);
+}
+
+TEST_F(AecCoreTest, ScaleErrorSignalMatchesGeneric) {
+  float ef[2][2][PART_LEN1];
+  FillRandom(ef[0][0], PART_LEN1, -10.0f, 10.0f);
+  FillRandom(ef[0][1], PART_LEN1, -10.0f, 10.0f);
+  // Below the threshold, and zero.
+  ef[0][0][3] = ef[0][1][3] = 1e-9f;
+  ef[0][0][4] = ef[0][1][4] = 0.0f;
+  memcpy(ef[1], ef[0], sizeof(ef[0]));
+
+  generic_.scale_error_signal(generic_aec_.get(), ef[0]);
+  optimized_.scale_error_signal(optimized_aec_.get(), ef[1]);
+
+  ExpectNear(ef[0][0], ef[1][0], PART_LEN1, kTolerance);
+  ExpectNear(ef[0][1], ef[1][1], PART_LEN1, kTolerance);
+}
+
+TEST_F(AecCoreTest, FilterAdaptationMatchesGeneric) {
+  float ef[2][PART_LEN1];
+  FillRandom(ef[0], PART_LEN1, -1e-6f, 1e-6f);
+  FillRandom(ef[1], PART_LEN1, -1e-6f, 1e-6f);
+  float fft[2][PART_LEN2];
+
+  SetFunctions(generic_);
+  generic_.filter_adaptation(generic_aec_.get(), fft[0], ef);
+  SetFunctions(optimized_);
+  optimized_.filter_adaptation(optimized_aec_.get(), fft[1], ef);
+
+  ExpectNear(generic_aec_->wfBuf[0], optimized_aec_->wfBuf[0],
+             NR_PART * PART_LEN1, kTolerance);
+  ExpectNear(generic_aec_->wfBuf[1], optimized_aec_->wfBuf[1],
+             NR_PART * PART_LEN1, kTolerance);
+}
+
+TEST_F(AecCoreTest, OverdriveAndSuppressMatchesGeneric) {
+  float hNl[2][PART_LEN1];
+  float efw[2][2][PART_LEN1];
+  FillRandom(hNl[0], PART_LEN1, 0.0f, 1.0f);
+  FillRandom(efw[0][0], PART_LEN1, -1e4f, 1e4f);
+  FillRandom(efw[0][1], PART_LEN1, -1e4f, 1e4f);
+  memcpy(hNl[1], hNl[0], sizeof(hNl[0]));
+  memcpy(efw[1], efw[0], sizeof(efw[0]));
+  const float hNlFb = 0.5f;
+
+  generic_.overdrive_and_suppress(generic_aec_.get(), hNl[0], hNlFb, efw[0]);
+  optimized_.overdrive_and_suppress(optimized_aec_.get(), hNl[1], hNlFb,
+                                    efw[1]);
+
+  ExpectNear(hNl[0], hNl[1], PART_LEN1, kPowTolerance);
+  ExpectNear(efw[0][0], efw[1][0], PART_LEN1, kPowTolerance);
+  ExpectNear(efw[0][1], efw[1][1], PART_LEN1, kPowTolerance);
+}
+
+// Reports the mean time to cancel the echo in a 10 ms frame at 16 kHz with
+// the generic and the optimized functions.
+TEST_F(AecCoreTest, ProcessTime) {
+  const int kNumTimedFrames = 1000;
+  std::vector<int16_t> far(kNumTimedFrames * 160);
+  std::vector<int16_t> near(kNumTimedFrames * 160);
+  GenerateSignals(kNumTimedFrames * 160, &far[0], &near[0]);
+  int16_t out[160];
+
+  const Functions* functions[] = { &generic_, &optimized_ };
+  const char* modifiers[] = { "_generic", "_optimized" };
+  for (int n = 0; n < 2; ++n) {
+    void* handle = NULL;
+    ASSERT_EQ(0, WebRtcAec_Create(&handle));
+    ASSERT_EQ(0, WebRtcAec_Init(handle, 16000, 16000));
+    SetFunctions(*functions[n]);
+    const int64_t start_us = webrtc::TickTime::MicrosecondTimestamp();
+    for (int frame = 0; frame < kNumTimedFrames; ++frame) {
+      ASSERT_EQ(0, WebRtcAec_BufferFarend(handle, &far[frame * 160], 160));
+      ASSERT_EQ(0, WebRtcAec_Process(handle, &near[frame * 160], NULL, out,
+                                     NULL, 160, 40, 0));
+    }
+    const int64_t elapsed_us =
+        webrtc::TickTime::MicrosecondTimestamp() - start_us;
+    ASSERT_EQ(0, WebRtcAec_Free(handle));
+    webrtc::PrintFrameTime("aec_frame_time", modifiers[n], "16kHz",
+                           elapsed_us, kNumTimedFrames);
+  }
+}
+
+}  // namespace
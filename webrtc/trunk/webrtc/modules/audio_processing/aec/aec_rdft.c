@@ -26,12 +26,12 @@
 #include "system_wrappers/interface/cpu_features_wrapper.h"
 #include "typedefs.h"
 
-// constants shared by all paths (C, SSE2).
+// constants shared by all paths (C, SSE2, NEON).
 float rdft_w[64];
 // constants used by the C path.
 float rdft_wk3ri_first[32];
 float rdft_wk3ri_second[32];
-// constants used by SSE2 but initialized in C path.
+// constants used by SSE2 and NEON but initialized in C path.
 ALIGN16_BEG float ALIGN16_END rdft_wk1r[32];
 ALIGN16_BEG float ALIGN16_END rdft_wk2r[32];
 ALIGN16_BEG float ALIGN16_END rdft_wk3r[32];
@@ -641,16 +641,29 @@ rft_sub_128_t cftmdl_128;
 rft_sub_128_t rftfsub_128;
 rft_sub_128_t rftbsub_128;
 
-void aec_rdft_init(void) {
+void aec_rdft_init_functions(int optimize) {
   cft1st_128 = cft1st_128_C;
   cftmdl_128 = cftmdl_128_C;
   rftfsub_128 = rftfsub_128_C;
   rftbsub_128 = rftbsub_128_C;
+  if (!optimize) {
+    return;
+  }
 #if defined(WEBRTC_ARCH_X86_FAMILY)
   if (WebRtc_GetCPUInfo(kSSE2)) {
     aec_rdft_init_sse2();
   }
+#elif defined(WEBRTC_DETECT_ARM_NEON)
+  if ((WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) != 0) {
+    aec_rdft_init_neon();
+  }
+#elif defined(WEBRTC_ARCH_ARM_NEON)
+  aec_rdft_init_neon();
 #endif
+}
+
+void aec_rdft_init(void) {
+  aec_rdft_init_functions(1);
   // init library constants.
   makewt_32();
   makect_32();
@@ -27,12 +27,12 @@ static __inline __m128i _mm_castps_si128(__m128 a) { return *(__m128i*)&a; }
 # define ALIGN16_END __attribute__((aligned(16)))
 #endif
 
-// constants shared by all paths (C, SSE2).
+// constants shared by all paths (C, SSE2, NEON).
 extern float rdft_w[64];
 // constants used by the C path.
 extern float rdft_wk3ri_first[32];
 extern float rdft_wk3ri_second[32];
-// constants used by SSE2 but initialized in C path.
+// constants used by SSE2 and NEON but initialized in C path.
 extern float rdft_wk1r[32];
 extern float rdft_wk2r[32];
 extern float rdft_wk3r[32];
@@ -50,7 +50,14 @@ extern rft_sub_128_t cftmdl_128;
 
 // entry points
 void aec_rdft_init(void);
+// Sets the code path selection function pointers to the C versions, and then
+// to the fastest versions supported by the CPU if |optimize| is nonzero.
+// Called by aec_rdft_init() with |optimize| set.
+void aec_rdft_init_functions(int optimize);
 void aec_rdft_init_sse2(void);
+#if (defined WEBRTC_DETECT_ARM_NEON || defined WEBRTC_ARCH_ARM_NEON)
+void aec_rdft_init_neon(void);
+#endif
 void aec_rdft_forward_128(float *a);
 void aec_rdft_inverse_128(float *a);
 
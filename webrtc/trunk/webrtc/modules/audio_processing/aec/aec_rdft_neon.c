@@ -0,0 +1,250 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The rdft butterflies, NEON version. Vectors hold two interleaved complex
+ * values, so the twiddle factors are applied as |x| * wr + swap(|x|) * wi,
+ * with the sign of wi alternating to give the complex product.
+ */
+
+#include "aec_rdft.h"
+
+#include <arm_neon.h>
+
+static const ALIGN16_BEG float ALIGN16_END k_swap_sign[4] =
+  {-1.f, 1.f, -1.f, 1.f};
+
+// Returns |a| in reverse order.
+static __inline float32x4_t Reverse(float32x4_t a) {
+  const float32x4_t rev = vrev64q_f32(a);
+  return vcombine_f32(vget_high_f32(rev), vget_low_f32(rev));
+}
+
+// Multiplies the two complex values in |a| by wr + i * wi, with |wi_signed|
+// holding {-wi, wi, -wi, wi}.
+static __inline float32x4_t ComplexMul(float32x4_t a,
+                                       float32x4_t wr,
+                                       float32x4_t wi_signed) {
+  return vmlaq_f32(vmulq_f32(a, wr), vrev64q_f32(a), wi_signed);
+}
+
+static void cft1st_128_neon(float *a) {
+  const float32x4_t vec_swap_sign = vld1q_f32(k_swap_sign);
+  int j, k2;
+
+  for (k2 = 0, j = 0; j < 128; j += 16, k2 += 4) {
+    float32x4_t a00v = vld1q_f32(&a[j + 0]);
+    float32x4_t a04v = vld1q_f32(&a[j + 4]);
+    float32x4_t a08v = vld1q_f32(&a[j + 8]);
+    float32x4_t a12v = vld1q_f32(&a[j + 12]);
+    float32x4_t a01v = vcombine_f32(vget_low_f32(a00v), vget_low_f32(a08v));
+    float32x4_t a23v = vcombine_f32(vget_high_f32(a00v), vget_high_f32(a08v));
+    float32x4_t a45v = vcombine_f32(vget_low_f32(a04v), vget_low_f32(a12v));
+    float32x4_t a67v = vcombine_f32(vget_high_f32(a04v), vget_high_f32(a12v));
+    const float32x4_t wk1rv = vld1q_f32(&rdft_wk1r[k2]);
+    const float32x4_t wk1iv = vld1q_f32(&rdft_wk1i[k2]);
+    const float32x4_t wk2rv = vld1q_f32(&rdft_wk2r[k2]);
+    const float32x4_t wk2iv = vld1q_f32(&rdft_wk2i[k2]);
+    const float32x4_t wk3rv = vld1q_f32(&rdft_wk3r[k2]);
+    const float32x4_t wk3iv = vld1q_f32(&rdft_wk3i[k2]);
+    float32x4_t x0v = vaddq_f32(a01v, a23v);
+    const float32x4_t x1v = vsubq_f32(a01v, a23v);
+    const float32x4_t x2v = vaddq_f32(a45v, a67v);
+    const float32x4_t x3v = vsubq_f32(a45v, a67v);
+    const float32x4_t x3s = vmulq_f32(vrev64q_f32(x3v), vec_swap_sign);
+    a01v = vaddq_f32(x0v, x2v);
+    x0v = vsubq_f32(x0v, x2v);
+    a45v = ComplexMul(x0v, wk2rv, wk2iv);
+    a23v = ComplexMul(vaddq_f32(x1v, x3s), wk1rv, wk1iv);
+    a67v = ComplexMul(vsubq_f32(x1v, x3s), wk3rv, wk3iv);
+
+    a00v = vcombine_f32(vget_low_f32(a01v), vget_low_f32(a23v));
+    a04v = vcombine_f32(vget_low_f32(a45v), vget_low_f32(a67v));
+    a08v = vcombine_f32(vget_high_f32(a01v), vget_high_f32(a23v));
+    a12v = vcombine_f32(vget_high_f32(a45v), vget_high_f32(a67v));
+    vst1q_f32(&a[j + 0], a00v);
+    vst1q_f32(&a[j + 4], a04v);
+    vst1q_f32(&a[j + 8], a08v);
+    vst1q_f32(&a[j + 12], a12v);
+  }
+}
+
+// One group of four radix-4 butterflies of cftmdl_128, starting at |j0| and
+// using the twiddle factors w1, w2 and w3.
+static __inline void cftmdl_group(float *a, int j0,
+                                  float wk1r, float wk1i,
+                                  float wk2r, float wk2i,
+                                  float wk3r, float wk3i) {
+  const float32x4_t vec_swap_sign = vld1q_f32(k_swap_sign);
+  const float32x4_t wk1rv = vdupq_n_f32(wk1r);
+  const float32x4_t wk1iv = vmulq_n_f32(vec_swap_sign, wk1i);
+  const float32x4_t wk2rv = vdupq_n_f32(wk2r);
+  const float32x4_t wk2iv = vmulq_n_f32(vec_swap_sign, wk2i);
+  const float32x4_t wk3rv = vdupq_n_f32(wk3r);
+  const float32x4_t wk3iv = vmulq_n_f32(vec_swap_sign, wk3i);
+  const int end = j0 + 8;
+
+  for (; j0 < end; j0 += 4) {
+    const float32x4_t a0v = vld1q_f32(&a[j0 + 0]);
+    const float32x4_t a1v = vld1q_f32(&a[j0 + 8]);
+    const float32x4_t a2v = vld1q_f32(&a[j0 + 16]);
+    const float32x4_t a3v = vld1q_f32(&a[j0 + 24]);
+    const float32x4_t x0v = vaddq_f32(a0v, a1v);
+    const float32x4_t x1v = vsubq_f32(a0v, a1v);
+    const float32x4_t x2v = vaddq_f32(a2v, a3v);
+    const float32x4_t x3v = vsubq_f32(a2v, a3v);
+    const float32x4_t x3s = vmulq_f32(vrev64q_f32(x3v), vec_swap_sign);
+    vst1q_f32(&a[j0 + 0], vaddq_f32(x0v, x2v));
+    vst1q_f32(&a[j0 + 16], ComplexMul(vsubq_f32(x0v, x2v), wk2rv, wk2iv));
+    vst1q_f32(&a[j0 + 8], ComplexMul(vaddq_f32(x1v, x3s), wk1rv, wk1iv));
+    vst1q_f32(&a[j0 + 24], ComplexMul(vsubq_f32(x1v, x3s), wk3rv, wk3iv));
+  }
+}
+
+static void cftmdl_128_neon(float *a) {
+  // The two special cases of the C version, with trivial twiddle factors,
+  // share the general butterfly here.
+  const float wk1r = rdft_w[2];
+  cftmdl_group(a, 0, 1.f, 0.f, 1.f, 0.f, 1.f, 0.f);
+  cftmdl_group(a, 32, wk1r, wk1r, 0.f, 1.f, -wk1r, wk1r);
+  cftmdl_group(a, 64, rdft_w[4], rdft_w[5], rdft_w[2], rdft_w[3],
+               rdft_wk3ri_first[2], rdft_wk3ri_first[3]);
+  cftmdl_group(a, 96, rdft_w[6], rdft_w[7], -rdft_w[3], rdft_w[2],
+               rdft_wk3ri_second[2], rdft_wk3ri_second[3]);
+}
+
+static void rftfsub_128_neon(float *a) {
+  const float *c = rdft_w + 32;
+  int j1, j2, k1, k2;
+  float wkr, wki, xr, xi, yr, yi;
+  const float32x4_t vec_half = vdupq_n_f32(0.5f);
+
+  // Vectorized code (four at once).
+  //    Note: commented number are indexes for the first iteration of the loop.
+  for (j1 = 1, j2 = 2; j2 + 7 < 64; j1 += 4, j2 += 8) {
+    // Load 'wk'.
+    const float32x4_t c_j1 = vld1q_f32(&c[j1]);         //  1,  2,  3,  4,
+    const float32x4_t c_k1 = vld1q_f32(&c[29 - j1]);    // 28, 29, 30, 31,
+    const float32x4_t wkrt = vsubq_f32(vec_half, c_k1); // 28, 29, 30, 31,
+    const float32x4_t wkr_ = Reverse(wkrt);             // 31, 30, 29, 28,
+    const float32x4_t wki_ = c_j1;                      //  1,  2,  3,  4,
+    // Load and deinterleave 'a'.
+    float32x4x2_t a_j2_p = vld2q_f32(&a[j2]);      //   2,   4,   6,   8,
+                                                   //   3,   5,   7,   9,
+    float32x4x2_t a_k2_p = vld2q_f32(&a[122 - j2]);  // 120, 122, 124, 126,
+                                                     // 121, 123, 125, 127,
+    const float32x4_t a_k2_p0 = Reverse(a_k2_p.val[0]);  // 126, 124, 122, 120,
+    const float32x4_t a_k2_p1 = Reverse(a_k2_p.val[1]);  // 127, 125, 123, 121,
+    // Calculate 'x'.
+    const float32x4_t xr_ = vsubq_f32(a_j2_p.val[0], a_k2_p0);
+    const float32x4_t xi_ = vaddq_f32(a_j2_p.val[1], a_k2_p1);
+    // Calculate product into 'y'.
+    //    yr = wkr * xr - wki * xi;
+    //    yi = wkr * xi + wki * xr;
+    const float32x4_t yr_ = vmlsq_f32(vmulq_f32(wkr_, xr_), wki_, xi_);
+    const float32x4_t yi_ = vmlaq_f32(vmulq_f32(wkr_, xi_), wki_, xr_);
+    // Update 'a'.
+    //    a[j2 + 0] -= yr;
+    //    a[j2 + 1] -= yi;
+    //    a[k2 + 0] += yr;
+    //    a[k2 + 1] -= yi;
+    a_j2_p.val[0] = vsubq_f32(a_j2_p.val[0], yr_);
+    a_j2_p.val[1] = vsubq_f32(a_j2_p.val[1], yi_);
+    a_k2_p.val[0] = Reverse(vaddq_f32(a_k2_p0, yr_));
+    a_k2_p.val[1] = Reverse(vsubq_f32(a_k2_p1, yi_));
+    // Interleave and store.
+    vst2q_f32(&a[j2], a_j2_p);
+    vst2q_f32(&a[122 - j2], a_k2_p);
+  }
+  // Scalar code for the remaining items.
+  for (; j2 < 64; j1 += 1, j2 += 2) {
+    k2 = 128 - j2;
+    k1 =  32 - j1;
+    wkr = 0.5f - c[k1];
+    wki = c[j1];
+    xr = a[j2 + 0] - a[k2 + 0];
+    xi = a[j2 + 1] + a[k2 + 1];
+    yr = wkr * xr - wki * xi;
+    yi = wkr * xi + wki * xr;
+    a[j2 + 0] -= yr;
+    a[j2 + 1] -= yi;
+    a[k2 + 0] += yr;
+    a[k2 + 1] -= yi;
+  }
+}
+
+static void rftbsub_128_neon(float *a) {
+  const float *c = rdft_w + 32;
+  int j1, j2, k1, k2;
+  float wkr, wki, xr, xi, yr, yi;
+  const float32x4_t vec_half = vdupq_n_f32(0.5f);
+
+  a[1] = -a[1];
+  // Vectorized code (four at once).
+  //    Note: commented number are indexes for the first iteration of the loop.
+  for (j1 = 1, j2 = 2; j2 + 7 < 64; j1 += 4, j2 += 8) {
+    // Load 'wk'.
+    const float32x4_t c_j1 = vld1q_f32(&c[j1]);         //  1,  2,  3,  4,
+    const float32x4_t c_k1 = vld1q_f32(&c[29 - j1]);    // 28, 29, 30, 31,
+    const float32x4_t wkrt = vsubq_f32(vec_half, c_k1); // 28, 29, 30, 31,
+    const float32x4_t wkr_ = Reverse(wkrt);             // 31, 30, 29, 28,
+    const float32x4_t wki_ = c_j1;                      //  1,  2,  3,  4,
+    // Load and deinterleave 'a'.
+    float32x4x2_t a_j2_p = vld2q_f32(&a[j2]);      //   2,   4,   6,   8,
+                                                   //   3,   5,   7,   9,
+    float32x4x2_t a_k2_p = vld2q_f32(&a[122 - j2]);  // 120, 122, 124, 126,
+                                                     // 121, 123, 125, 127,
+    const float32x4_t a_k2_p0 = Reverse(a_k2_p.val[0]);  // 126, 124, 122, 120,
+    const float32x4_t a_k2_p1 = Reverse(a_k2_p.val[1]);  // 127, 125, 123, 121,
+    // Calculate 'x'.
+    const float32x4_t xr_ = vsubq_f32(a_j2_p.val[0], a_k2_p0);
+    const float32x4_t xi_ = vaddq_f32(a_j2_p.val[1], a_k2_p1);
+    // Calculate product into 'y'.
+    //    yr = wkr * xr + wki * xi;
+    //    yi = wkr * xi - wki * xr;
+    const float32x4_t yr_ = vmlaq_f32(vmulq_f32(wkr_, xr_), wki_, xi_);
+    const float32x4_t yi_ = vmlsq_f32(vmulq_f32(wkr_, xi_), wki_, xr_);
+    // Update 'a'.
+    //    a[j2 + 0] = a[j2 + 0] - yr;
+    //    a[j2 + 1] = yi - a[j2 + 1];
+    //    a[k2 + 0] = yr + a[k2 + 0];
+    //    a[k2 + 1] = yi - a[k2 + 1];
+    a_j2_p.val[0] = vsubq_f32(a_j2_p.val[0], yr_);
+    a_j2_p.val[1] = vsubq_f32(yi_, a_j2_p.val[1]);
+    a_k2_p.val[0] = Reverse(vaddq_f32(yr_, a_k2_p0));
+    a_k2_p.val[1] = Reverse(vsubq_f32(yi_, a_k2_p1));
+    // Interleave and store.
+    vst2q_f32(&a[j2], a_j2_p);
+    vst2q_f32(&a[122 - j2], a_k2_p);
+  }
+  // Scalar code for the remaining items.
+  for (; j2 < 64; j1 += 1, j2 += 2) {
+    k2 = 128 - j2;
+    k1 =  32 - j1;
+    wkr = 0.5f - c[k1];
+    wki = c[j1];
+    xr = a[j2 + 0] - a[k2 + 0];
+    xi = a[j2 + 1] + a[k2 + 1];
+    yr = wkr * xr + wki * xi;
+    yi = wkr * xi - wki * xr;
+    a[j2 + 0] = a[j2 + 0] - yr;
+    a[j2 + 1] = yi - a[j2 + 1];
+    a[k2 + 0] = yr + a[k2 + 0];
+    a[k2 + 1] = yi - a[k2 + 1];
+  }
+  a[65] = -a[65];
+}
+
+void aec_rdft_init_neon(void) {
+  cft1st_128 = cft1st_128_neon;
+  cftmdl_128 = cftmdl_128_neon;
+  rftfsub_128 = rftfsub_128_neon;
+  rftbsub_128 = rftbsub_128_neon;
+}
@@ -23,10 +23,12 @@
 #include "module_common_types.h"
 #include "noise_suppression_impl.h"
 #include "processing_component.h"
+#include "render_queue.h"
 #include "splitting_filter.h"
 #include "voice_detection_impl.h"
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
+#include "debug_dump_writer.h"
 // Files generated at build-time by the protobuf compiler.
 #ifdef WEBRTC_ANDROID_PLATFORM_BUILD
 #include "external/webrtc/webrtc/modules/audio_processing/debug.pb.h"
@@ -36,6 +38,14 @@
 #endif  // WEBRTC_AUDIOPROC_DEBUG_DUMP
 
 namespace webrtc {
+namespace {
+
+// Far-end frames waiting for the next ProcessStream() call. Must be a power of
+// two. At 10 ms per frame, this covers 320 ms of capture thread stall.
+const int kRenderQueueFrames = 32;
+
+}  // namespace
+
 AudioProcessing* AudioProcessing::Create(int id) {
 
   AudioProcessingImpl* apm = new AudioProcessingImpl(id);
@@ -60,11 +70,15 @@ AudioProcessingImpl::AudioProcessingImpl(int id)
       level_estimator_(NULL),
       noise_suppression_(NULL),
       voice_detection_(NULL),
+      render_crit_(CriticalSectionWrapper::CreateCriticalSection()),
       crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      render_queue_(new RenderQueue(kRenderQueueFrames)),
+      render_error_(kNoError),
+      render_frame_(new AudioFrame()),
       render_audio_(NULL),
       capture_audio_(NULL),
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-      debug_file_(FileWrapper::Create()),
+      debug_writer_(new DebugDumpWriter()),
       event_msg_(new audioproc::Event()),
 #endif
       sample_rate_hz_(kSampleRate16kHz),
@@ -101,6 +115,7 @@ AudioProcessingImpl::AudioProcessingImpl(int id)
 
 AudioProcessingImpl::~AudioProcessingImpl() {
   {
+    CriticalSectionScoped render_crit_scoped(render_crit_);
     CriticalSectionScoped crit_scoped(crit_);
     while (!component_list_.empty()) {
       ProcessingComponent* component = component_list_.front();
@@ -110,9 +125,7 @@ AudioProcessingImpl::~AudioProcessingImpl() {
     }
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-    if (debug_file_->Open()) {
-      debug_file_->CloseFile();
-    }
+    debug_writer_->Stop();
 #endif
 
     if (render_audio_) {
@@ -128,6 +141,8 @@ AudioProcessingImpl::~AudioProcessingImpl() {
 
   delete crit_;
   crit_ = NULL;
+  delete render_crit_;
+  render_crit_ = NULL;
 }
 
 CriticalSectionWrapper* AudioProcessingImpl::crit() const {
@@ -139,10 +154,12 @@ int AudioProcessingImpl::split_sample_rate_hz() const {
 }
 
 int AudioProcessingImpl::Initialize() {
+  CriticalSectionScoped render_crit_scoped(render_crit_);
   CriticalSectionScoped crit_scoped(crit_);
   return InitializeLocked();
 }
 
+// Called with both locks held.
 int AudioProcessingImpl::InitializeLocked() {
   if (render_audio_ != NULL) {
     delete render_audio_;
@@ -158,6 +175,9 @@ int AudioProcessingImpl::InitializeLocked() {
                                   samples_per_channel_);
   capture_audio_ = new AudioBuffer(num_input_channels_,
                                    samples_per_channel_);
+  // Queued frames may have the old format.
+  render_queue_->Clear();
+  render_error_.CompareExchange(kNoError, render_error_.LoadWithBarrier());
 
   was_stream_delay_set_ = false;
 
@@ -171,7 +191,7 @@ int AudioProcessingImpl::InitializeLocked() {
   }
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  if (debug_file_->Open()) {
+  if (debug_writer_->is_running()) {
     int err = WriteInitMessage();
     if (err != kNoError) {
       return err;
@@ -183,6 +203,7 @@ int AudioProcessingImpl::InitializeLocked() {
 }
 
 int AudioProcessingImpl::set_sample_rate_hz(int rate) {
+  CriticalSectionScoped render_crit_scoped(render_crit_);
   CriticalSectionScoped crit_scoped(crit_);
   if (rate == sample_rate_hz_) {
     return kNoError;
@@ -210,6 +231,7 @@ int AudioProcessingImpl::sample_rate_hz() const {
 }
 
 int AudioProcessingImpl::set_num_reverse_channels(int channels) {
+  CriticalSectionScoped render_crit_scoped(render_crit_);
   CriticalSectionScoped crit_scoped(crit_);
   if (channels == num_reverse_channels_) {
     return kNoError;
@@ -231,6 +253,7 @@ int AudioProcessingImpl::num_reverse_channels() const {
 int AudioProcessingImpl::set_num_channels(
     int input_channels,
     int output_channels) {
+  CriticalSectionScoped render_crit_scoped(render_crit_);
   CriticalSectionScoped crit_scoped(crit_);
   if (input_channels == num_input_channels_ &&
       output_channels == num_output_channels_) {
@@ -279,8 +302,11 @@ int AudioProcessingImpl::ProcessStream(AudioFrame* frame) {
     return kBadDataLengthError;
   }
 
+  // Catch up with the far-end audio queued since the last call.
+  ProcessRenderQueue();
+
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  if (debug_file_->Open()) {
+  if (debug_writer_->is_running()) {
     event_msg_->set_type(audioproc::Event::STREAM);
     audioproc::Stream* msg = event_msg_->mutable_stream();
     const size_t data_size = sizeof(int16_t) *
@@ -373,7 +399,7 @@ int AudioProcessingImpl::ProcessStream(AudioFrame* frame) {
   capture_audio_->InterleaveTo(frame, interleave_needed(data_processed));
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  if (debug_file_->Open()) {
+  if (debug_writer_->is_running()) {
     audioproc::Stream* msg = event_msg_->mutable_stream();
     const size_t data_size = sizeof(int16_t) *
                              frame->samples_per_channel_ *
@@ -391,8 +417,7 @@ int AudioProcessingImpl::ProcessStream(AudioFrame* frame) {
 }
 
 int AudioProcessingImpl::AnalyzeReverseStream(AudioFrame* frame) {
-  CriticalSectionScoped crit_scoped(crit_);
-  int err = kNoError;
+  CriticalSectionScoped crit_scoped(render_crit_);
 
   if (frame == NULL) {
     return kNullPointerError;
@@ -410,14 +435,40 @@ int AudioProcessingImpl::AnalyzeReverseStream(AudioFrame* frame) {
     return kBadDataLengthError;
   }
 
+  // The frame is analyzed by the next ProcessStream() call. If the capture
+  // side has stalled long enough to fill the queue, the frame is dropped;
+  // there is no near-end audio for it to cancel echo in anyway.
+  render_queue_->Insert(*frame);
+
+  // Return what went wrong analyzing the earlier frames, if anything.
+  const int err = render_error_.LoadWithBarrier();
+  if (err != kNoError) {
+    render_error_.CompareExchange(kNoError, err);
+  }
+  return err;
+}
+
+void AudioProcessingImpl::ProcessRenderQueue() {
+  while (render_queue_->Remove(render_frame_.get())) {
+    const int err = ProcessRenderFrame();
+    if (err != kNoError) {
+      // Returned by the next AnalyzeReverseStream() call, as that call had
+      // already returned when the frame was analyzed. The first error wins.
+      render_error_.CompareExchange(err, kNoError);
+    }
+  }
+}
+
+int AudioProcessingImpl::ProcessRenderFrame() {
+  int err = kNoError;
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  if (debug_file_->Open()) {
+  if (debug_writer_->is_running()) {
     event_msg_->set_type(audioproc::Event::REVERSE_STREAM);
     audioproc::ReverseStream* msg = event_msg_->mutable_reverse_stream();
     const size_t data_size = sizeof(int16_t) *
-                             frame->samples_per_channel_ *
-                             frame->num_channels_;
-    msg->set_data(frame->data_, data_size);
+                             render_frame_->samples_per_channel_ *
+                             render_frame_->num_channels_;
+    msg->set_data(render_frame_->data_, data_size);
     err = WriteMessageToDebugFile();
     if (err != kNoError) {
       return err;
@@ -425,7 +476,7 @@ int AudioProcessingImpl::AnalyzeReverseStream(AudioFrame* frame) {
   }
 #endif
 
-  render_audio_->DeinterleaveFrom(frame);
+  render_audio_->DeinterleaveFrom(render_frame_.get());
 
   // TODO(ajm): turn the splitting filter into a component?
   if (sample_rate_hz_ == kSampleRate32kHz) {
@@ -455,7 +506,7 @@ int AudioProcessingImpl::AnalyzeReverseStream(AudioFrame* frame) {
     return err;
   }
 
-  return err;  // TODO(ajm): this is for returning warnings; necessary?
+  return kNoError;
 }
 
 int AudioProcessingImpl::set_stream_delay_ms(int delay) {
@@ -505,15 +556,8 @@ int AudioProcessingImpl::StartDebugRecording(
   }
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  // Stop any ongoing recording.
-  if (debug_file_->Open()) {
-    if (debug_file_->CloseFile() == -1) {
-      return kFileError;
-    }
-  }
-
-  if (debug_file_->OpenFile(filename, false) == -1) {
-    debug_file_->CloseFile();
+  // Stops any ongoing recording.
+  if (debug_writer_->Start(filename) != 0) {
     return kFileError;
   }
 
@@ -532,10 +576,8 @@ int AudioProcessingImpl::StopDebugRecording() {
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
   // We just return if recording hasn't started.
-  if (debug_file_->Open()) {
-    if (debug_file_->CloseFile() == -1) {
-      return kFileError;
-    }
+  if (debug_writer_->Stop() != 0) {
+    return kFileError;
   }
   return kNoError;
 #else
@@ -625,30 +667,12 @@ bool AudioProcessingImpl::analysis_needed(bool is_data_processed) const {
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
 int AudioProcessingImpl::WriteMessageToDebugFile() {
-  int32_t size = event_msg_->ByteSize();
-  if (size <= 0) {
-    return kUnspecifiedError;
-  }
-#if defined(WEBRTC_BIG_ENDIAN)
-  // TODO(ajm): Use little-endian "on the wire". For the moment, we can be
-  //            pretty safe in assuming little-endian.
-#endif
-
-  if (!event_msg_->SerializeToString(&event_str_)) {
-    return kUnspecifiedError;
-  }
-
-  // Write message preceded by its size.
-  if (!debug_file_->Write(&size, sizeof(int32_t))) {
+  // Leaves |event_msg_| cleared. Failures to write earlier messages are
+  // reported here too.
+  if (debug_writer_->WriteEvent(event_msg_.get()) != 0) {
     return kFileError;
   }
-  if (!debug_file_->Write(event_str_.data(), event_str_.length())) {
-    return kFileError;
-  }
-
-  event_msg_->Clear();
-
-  return 0;
+  return kNoError;
 }
 
 int AudioProcessingImpl::WriteInitMessage() {
@@ -14,21 +14,22 @@
 #include "audio_processing.h"
 
 #include <list>
-#include <string>
 
+#include "atomic32.h"
 #include "scoped_ptr.h"
 
 namespace webrtc {
 class AudioBuffer;
 class CriticalSectionWrapper;
+class DebugDumpWriter;
 class EchoCancellationImpl;
 class EchoControlMobileImpl;
-class FileWrapper;
 class GainControlImpl;
 class HighPassFilterImpl;
 class LevelEstimatorImpl;
 class NoiseSuppressionImpl;
 class ProcessingComponent;
+class RenderQueue;
 class VoiceDetectionImpl;
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
@@ -50,6 +51,8 @@ class AudioProcessingImpl : public AudioProcessing {
   explicit AudioProcessingImpl(int id);
   virtual ~AudioProcessingImpl();
 
+  // The capture lock. It protects the components, which also process the
+  // render audio on the capture thread.
   CriticalSectionWrapper* crit() const;
 
   int split_sample_rate_hz() const;
@@ -89,6 +92,11 @@ class AudioProcessingImpl : public AudioProcessing {
   bool interleave_needed(bool is_data_processed) const;
   bool synthesis_needed(bool is_data_processed) const;
   bool analysis_needed(bool is_data_processed) const;
+  // Runs the far-end frames queued by AnalyzeReverseStream() through the
+  // render side of the components. Called with the capture lock held.
+  // Errors are left in |render_error_|.
+  void ProcessRenderQueue();
+  int ProcessRenderFrame();
 
   int id_;
 
@@ -101,7 +109,16 @@ class AudioProcessingImpl : public AudioProcessing {
   VoiceDetectionImpl* voice_detection_;
 
   std::list<ProcessingComponent*> component_list_;
+  // AnalyzeReverseStream() only takes |render_crit_|, and ProcessStream() only
+  // |crit_|, so that the two threads never wait on each other. Changing the
+  // format takes both, in that order.
+  CriticalSectionWrapper* render_crit_;
   CriticalSectionWrapper* crit_;
+  scoped_ptr<RenderQueue> render_queue_;
+  // The first error from analyzing a queued frame, or kNoError. Set on the
+  // capture thread and returned by the next AnalyzeReverseStream() call.
+  Atomic32 render_error_;
+  scoped_ptr<AudioFrame> render_frame_;
   AudioBuffer* render_audio_;
   AudioBuffer* capture_audio_;
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
@@ -109,9 +126,10 @@ class AudioProcessingImpl : public AudioProcessing {
   // out into a separate class with an "enabled" and "disabled" implementation.
   int WriteMessageToDebugFile();
   int WriteInitMessage();
-  scoped_ptr<FileWrapper> debug_file_;
+  // Events are written from the capture thread only, including the reverse
+  // stream frames as they are taken from |render_queue_|.
+  scoped_ptr<DebugDumpWriter> debug_writer_;
   scoped_ptr<audioproc::Event> event_msg_; // Protobuf message.
-  std::string event_str_; // Memory for protobuf serialization.
 #endif
 
   int sample_rate_hz_;
@@ -0,0 +1,178 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "debug_dump_writer.h"
+
+#include "critical_section_wrapper.h"
+#include "event_wrapper.h"
+#include "file_wrapper.h"
+#include "thread_wrapper.h"
+
+// Files generated at build-time by the protobuf compiler.
+#ifdef WEBRTC_ANDROID_PLATFORM_BUILD
+#include "external/webrtc/webrtc/modules/audio_processing/debug.pb.h"
+#else
+#include "webrtc/audio_processing/debug.pb.h"
+#endif
+
+namespace webrtc {
+namespace {
+
+// The writer thread wakes up at least this often, and whenever the queue is
+// half full.
+const unsigned long kWriteIntervalMs = 100;
+
+}  // namespace
+
+DebugDumpWriter::DebugDumpWriter()
+    : crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      wake_event_(EventWrapper::Create()),
+      file_(FileWrapper::Create()),
+      thread_(NULL),
+      running_(false),
+      failed_(false) {
+  free_events_.reserve(kPreallocatedEvents);
+  for (int i = 0; i < kPreallocatedEvents; ++i) {
+    free_events_.push_back(new audioproc::Event());
+  }
+}
+
+DebugDumpWriter::~DebugDumpWriter() {
+  Stop();
+  for (size_t i = 0; i < free_events_.size(); ++i) {
+    delete free_events_[i];
+  }
+}
+
+int DebugDumpWriter::Start(const char* filename) {
+  // Stop any ongoing recording.
+  if (Stop() != 0) {
+    return -1;
+  }
+
+  if (file_->OpenFile(filename, false) == -1) {
+    file_->CloseFile();
+    return -1;
+  }
+
+  thread_.reset(ThreadWrapper::CreateThread(Run, this, kNormalPriority,
+                                            "AudioProcDebugDump"));
+  unsigned int thread_id = 0;
+  if (thread_.get() == NULL || !thread_->Start(thread_id)) {
+    thread_.reset();
+    file_->CloseFile();
+    return -1;
+  }
+  running_ = true;
+  return 0;
+}
+
+int DebugDumpWriter::Stop() {
+  if (!running_) {
+    return 0;
+  }
+  running_ = false;
+
+  thread_->SetNotAlive();
+  wake_event_->Set();
+  thread_->Stop();
+  thread_.reset();
+
+  // Write whatever was queued after the thread's last pass.
+  WritePending();
+
+  bool failed = file_->Flush() == -1;
+  failed |= file_->CloseFile() == -1;
+  {
+    CriticalSectionScoped lock(crit_.get());
+    failed |= failed_;
+    failed_ = false;
+  }
+  return failed ? -1 : 0;
+}
+
+bool DebugDumpWriter::is_running() const {
+  return running_;
+}
+
+int DebugDumpWriter::WriteEvent(audioproc::Event* event) {
+  bool wake = false;
+  int result = 0;
+  {
+    CriticalSectionScoped lock(crit_.get());
+    audioproc::Event* queued_event = NULL;
+    if (free_events_.empty()) {
+      // The writer thread has fallen behind. The new message is kept for
+      // reuse once written.
+      queued_event = new audioproc::Event();
+    } else {
+      queued_event = free_events_.back();
+      free_events_.pop_back();
+    }
+    // Swapping hands over the message payloads without copying them.
+    queued_event->Swap(event);
+    queued_events_.push_back(queued_event);
+    wake = queued_events_.size() >= kPreallocatedEvents / 2;
+    if (failed_) {
+      failed_ = false;
+      result = -1;
+    }
+  }
+  if (wake) {
+    wake_event_->Set();
+  }
+  return result;
+}
+
+bool DebugDumpWriter::Run(void* obj) {
+  return static_cast<DebugDumpWriter*>(obj)->Process();
+}
+
+bool DebugDumpWriter::Process() {
+  wake_event_->Wait(kWriteIntervalMs);
+  WritePending();
+  return true;
+}
+
+void DebugDumpWriter::WritePending() {
+  {
+    CriticalSectionScoped lock(crit_.get());
+    pending_.swap(queued_events_);
+  }
+  if (pending_.empty()) {
+    return;
+  }
+
+  bool failed = false;
+  std::deque<audioproc::Event*>::iterator it;
+  for (it = pending_.begin(); it != pending_.end(); ++it) {
+    audioproc::Event* event = *it;
+    int32_t size = event->ByteSize();
+#if defined(WEBRTC_BIG_ENDIAN)
+    // TODO(ajm): Use little-endian "on the wire". For the moment, we can be
+    //            pretty safe in assuming little-endian.
+#endif
+    // Write message preceded by its size.
+    if (size <= 0 || !event->SerializeToString(&event_str_) ||
+        !file_->Write(&size, sizeof(int32_t)) ||
+        !file_->Write(event_str_.data(), event_str_.length())) {
+      failed = true;
+    }
+    // Clearing keeps the allocated payload buffers for reuse.
+    event->Clear();
+  }
+
+  CriticalSectionScoped lock(crit_.get());
+  free_events_.insert(free_events_.end(), pending_.begin(), pending_.end());
+  pending_.clear();
+  failed_ |= failed;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,90 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_PROCESSING_MAIN_SOURCE_DEBUG_DUMP_WRITER_H_
+#define WEBRTC_MODULES_AUDIO_PROCESSING_MAIN_SOURCE_DEBUG_DUMP_WRITER_H_
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "scoped_ptr.h"
+#include "typedefs.h"
+
+namespace webrtc {
+
+class CriticalSectionWrapper;
+class EventWrapper;
+class FileWrapper;
+class ThreadWrapper;
+
+namespace audioproc {
+
+class Event;
+
+}  // namespace audioproc
+
+// Writes debug dump events to a file on a background thread, so that the
+// audio threads never wait on file I/O. Events are handed over through a
+// queue of preallocated messages. If the writer falls behind, more messages
+// are allocated rather than events dropped. Write failures are reported by
+// the next call to WriteEvent() or Stop().
+//
+// Start(), Stop() and WriteEvent() must not be called concurrently.
+class DebugDumpWriter {
+ public:
+  DebugDumpWriter();
+  ~DebugDumpWriter();
+
+  // Opens |filename|, overwriting any existing file, and starts the writer
+  // thread. Returns -1 on failure.
+  int Start(const char* filename);
+
+  // Writes all queued events, then closes the file and stops the thread.
+  // Returns -1 if any event failed to be written. Does nothing if the writer
+  // isn't running.
+  int Stop();
+
+  bool is_running() const;
+
+  // Queues |event| for writing. The contents of |event| are swapped into the
+  // queue, leaving |event| cleared. Returns -1 if an event failed to be
+  // written since the last call.
+  int WriteEvent(audioproc::Event* event);
+
+ private:
+  enum { kPreallocatedEvents = 256 };
+
+  static bool Run(void* obj);
+  bool Process();
+
+  // Serializes and writes the events in |pending_| to the file, and returns
+  // them to |free_events_|.
+  void WritePending();
+
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  scoped_ptr<EventWrapper> wake_event_;
+  scoped_ptr<FileWrapper> file_;
+  scoped_ptr<ThreadWrapper> thread_;
+  bool running_;
+
+  // Protected by |crit_|.
+  std::vector<audioproc::Event*> free_events_;
+  std::deque<audioproc::Event*> queued_events_;
+  bool failed_;
+
+  // Only touched by the thread writing to the file.
+  std::deque<audioproc::Event*> pending_;
+  std::string event_str_;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_PROCESSING_MAIN_SOURCE_DEBUG_DUMP_WRITER_H_
@@ -172,6 +172,10 @@ class AudioProcessing : public Module {
   // The |sample_rate_hz_|, |num_channels_|, and |samples_per_channel_|
   // members of |frame| must be valid.
   //
+  // The frame is only queued here, and analyzed by the next ProcessStream()
+  // call, so the render and capture threads don't wait on each other. An
+  // error from analyzing a frame is returned by the next call instead.
+  //
   // TODO(ajm): add const to input; requires an implementation fix.
   virtual int AnalyzeReverseStream(AudioFrame* frame) = 0;
 
@@ -17,6 +17,7 @@
 #include "windows_private.h"
 #include "fft4g.h"
 #include "signal_processing_library.h"
+#include "cpu_features_wrapper.h"
 
 // Set Feature Extraction Parameters
 void WebRtcNs_set_feature_extraction_parameters(NSinst_t* inst) {
@@ -202,6 +203,8 @@ int WebRtcNs_InitCore(NSinst_t* inst, WebRtc_UWord32 fs) {
 
   memset(inst->outBuf, 0, sizeof(float) * 3 * BLOCKL_MAX);
 
+  WebRtcNs_InitFunctions(1);
+
   inst->initFlag = 1;
   return 0;
 }
@@ -714,6 +717,172 @@ void WebRtcNs_SpeechNoiseProb(NSinst_t* inst, float* probSpeechFinal, float* snr
   }
 }
 
+static void MagnSpectrumC(int magnLen,
+                          const float* fft,
+                          float* real,
+                          float* imag,
+                          float* magn,
+                          float* signalEnergy,
+                          float* sumMagn) {
+  int i;
+  float fTmp;
+  for (i = 1; i < magnLen - 1; i++) {
+    real[i] = fft[2 * i];
+    imag[i] = fft[2 * i + 1];
+    // magnitude spectrum
+    fTmp = real[i] * real[i];
+    fTmp += imag[i] * imag[i];
+    *signalEnergy += fTmp;
+    magn[i] = ((float)sqrt(fTmp)) + 1.0f;
+    *sumMagn += magn[i];
+  }
+}
+
+void WebRtcNs_UpdateNoiseBin(NSinst_t* inst,
+                             const float* magn,
+                             const float* probSpeechFinal,
+                             int i,
+                             float gammaNoiseOld,
+                             float* noise) {
+  const float probSpeech = probSpeechFinal[i];
+  const float probNonSpeech = (float)1.0 - probSpeech;
+  // time-constant based on speech/noise state
+  // increase gamma (i.e., less noise update) for frame likely to be speech
+  const float gammaNoiseTmp =
+      probSpeech > PROB_RANGE ? SPEECH_UPDATE : NOISE_UPDATE;
+  // temporary noise update:
+  // use it for speech frames if update value is less than previous
+  const float noiseUpdateTmp = gammaNoiseOld * inst->noisePrev[i] +
+      ((float)1.0 - gammaNoiseOld) *
+      (probNonSpeech * magn[i] + probSpeech * inst->noisePrev[i]);
+
+  // conservative noise update
+  if (probSpeech < PROB_RANGE) {
+    inst->magnAvgPause[i] += GAMMA_PAUSE * (magn[i] - inst->magnAvgPause[i]);
+  }
+  // noise update
+  if (gammaNoiseTmp == gammaNoiseOld) {
+    noise[i] = noiseUpdateTmp;
+  } else {
+    noise[i] = gammaNoiseTmp * inst->noisePrev[i] + ((float)1.0 - gammaNoiseTmp)
+               * (probNonSpeech * magn[i] + probSpeech * inst->noisePrev[i]);
+    // allow for noise update downwards:
+    //  if noise update decreases the noise, it is safe, so allow it to happen
+    if (noiseUpdateTmp < noise[i]) {
+      noise[i] = noiseUpdateTmp;
+    }
+  }
+}
+
+static void UpdateNoiseC(NSinst_t* inst,
+                         const float* magn,
+                         const float* probSpeechFinal,
+                         float* noise) {
+  int i;
+  // time-avg parameter for noise update
+  float gammaNoiseOld = NOISE_UPDATE;
+
+  for (i = 0; i < inst->magnLen; i++) {
+    WebRtcNs_UpdateNoiseBin(inst, magn, probSpeechFinal, i, gammaNoiseOld,
+                            noise);
+    gammaNoiseOld =
+        probSpeechFinal[i] > PROB_RANGE ? SPEECH_UPDATE : NOISE_UPDATE;
+  } // end of freq loop
+}
+
+static void WienerGainC(NSinst_t* inst,
+                        const float* magn,
+                        const float* noise,
+                        const float* previousEstimateStsa,
+                        float* theFilter) {
+  int i;
+  float snrPrior, currentEstimateStsa, tmpFloat1, tmpFloat2;
+  for (i = 0; i < inst->magnLen; i++) {
+    // post and prior snr
+    currentEstimateStsa = (float)0.0;
+    if (magn[i] > noise[i]) {
+      currentEstimateStsa = magn[i] / (noise[i] + (float)0.0001) - (float)1.0;
+    }
+    // DD estimate is sume of two terms: current estimate and previous estimate
+    // directed decision update of snrPrior
+    snrPrior = DD_PR_SNR * previousEstimateStsa[i] + ((float)1.0 - DD_PR_SNR)
+               * currentEstimateStsa;
+    // gain filter
+    tmpFloat1 = inst->overdrive + snrPrior;
+    tmpFloat2 = (float)snrPrior / tmpFloat1;
+    theFilter[i] = (float)tmpFloat2;
+  } // end of loop over freqs
+}
+
+static void ApplyGainC(NSinst_t* inst,
+                       float* theFilter,
+                       float* theFilterTmp,
+                       float* real,
+                       float* imag) {
+  int i;
+  for (i = 0; i < inst->magnLen; i++) {
+    // flooring bottom
+    if (theFilter[i] < inst->denoiseBound) {
+      theFilter[i] = inst->denoiseBound;
+    }
+    // flooring top
+    if (theFilter[i] > (float)1.0) {
+      theFilter[i] = 1.0;
+    }
+    if (inst->blockInd < END_STARTUP_SHORT) {
+      // flooring bottom
+      if (theFilterTmp[i] < inst->denoiseBound) {
+        theFilterTmp[i] = inst->denoiseBound;
+      }
+      // flooring top
+      if (theFilterTmp[i] > (float)1.0) {
+        theFilterTmp[i] = 1.0;
+      }
+      // Weight the two suppression filters
+      theFilter[i] *= (inst->blockInd);
+      theFilterTmp[i] *= (END_STARTUP_SHORT - inst->blockInd);
+      theFilter[i] += theFilterTmp[i];
+      theFilter[i] /= (END_STARTUP_SHORT);
+    }
+    // smoothing
+#ifdef PROCESS_FLOW_0
+    inst->smooth[i] *= SMOOTH; // value set to 0.7 in define.h file
+    inst->smooth[i] += ((float)1.0 - SMOOTH) * theFilter[i];
+#else
+    inst->smooth[i] = theFilter[i];
+#endif
+    real[i] *= inst->smooth[i];
+    imag[i] *= inst->smooth[i];
+  }
+}
+
+WebRtcNs_MagnSpectrum_t WebRtcNs_MagnSpectrum;
+WebRtcNs_UpdateNoise_t WebRtcNs_UpdateNoise;
+WebRtcNs_WienerGain_t WebRtcNs_WienerGain;
+WebRtcNs_ApplyGain_t WebRtcNs_ApplyGain;
+
+void WebRtcNs_InitFunctions(int optimize) {
+  WebRtcNs_MagnSpectrum = MagnSpectrumC;
+  WebRtcNs_UpdateNoise = UpdateNoiseC;
+  WebRtcNs_WienerGain = WienerGainC;
+  WebRtcNs_ApplyGain = ApplyGainC;
+
+  if (!optimize) {
+    return;
+  }
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    WebRtcNs_InitCore_SSE2();
+  }
+#elif defined(WEBRTC_DETECT_ARM_NEON)
+  if ((WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) != 0) {
+    WebRtcNs_InitCore_neon();
+  }
+#elif defined(WEBRTC_ARCH_ARM_NEON)
+  WebRtcNs_InitCore_neon();
+#endif
+}
+
 int WebRtcNs_ProcessCore(NSinst_t* inst,
                          short* speechFrame,
                          short* speechFrameHB,
@@ -728,10 +897,8 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
 
   float   energy1, energy2, gain, factor, factor1, factor2;
   float   signalEnergy, sumMagn;
-  float   snrPrior, currentEstimateStsa;
-  float   tmpFloat1, tmpFloat2, tmpFloat3, probSpeech, probNonSpeech;
-  float   gammaNoiseTmp, gammaNoiseOld;
-  float   noiseUpdateTmp, fTmp, dTmp;
+  float   tmpFloat1, tmpFloat2, tmpFloat3;
+  float   dTmp;
   float   fin[BLOCKL_MAX], fout[BLOCKL_MAX];
   float   winData[ANAL_BLOCKL_MAX];
   float   magn[HALF_ANAL_BLOCKL], noise[HALF_ANAL_BLOCKL];
@@ -884,16 +1051,10 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
       sum_log_magn = tmpFloat1;
       sum_log_i_log_magn = tmpFloat2 * tmpFloat1;
     }
-    for (i = 1; i < inst->magnLen - 1; i++) {
-      real[i] = winData[2 * i];
-      imag[i] = winData[2 * i + 1];
-      // magnitude spectrum
-      fTmp = real[i] * real[i];
-      fTmp += imag[i] * imag[i];
-      signalEnergy += fTmp;
-      magn[i] = ((float)sqrt(fTmp)) + 1.0f;
-      sumMagn += magn[i];
-      if (inst->blockInd < END_STARTUP_SHORT) {
+    WebRtcNs_MagnSpectrum(inst->magnLen, winData, real, imag, magn,
+                          &signalEnergy, &sumMagn);
+    if (inst->blockInd < END_STARTUP_SHORT) {
+      for (i = 1; i < inst->magnLen - 1; i++) {
         inst->initMagnEst[i] += magn[i];
         if (i >= kStartBand) {
           tmpFloat2 = log((float)i);
@@ -1052,98 +1213,19 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
     }
     // compute speech/noise probability
     WebRtcNs_SpeechNoiseProb(inst, probSpeechFinal, snrLocPrior, snrLocPost);
-    // time-avg parameter for noise update
-    gammaNoiseTmp = NOISE_UPDATE;
-    for (i = 0; i < inst->magnLen; i++) {
-      probSpeech = probSpeechFinal[i];
-      probNonSpeech = (float)1.0 - probSpeech;
-      // temporary noise update:
-      // use it for speech frames if update value is less than previous
-      noiseUpdateTmp = gammaNoiseTmp * inst->noisePrev[i] + ((float)1.0 - gammaNoiseTmp)
-                       * (probNonSpeech * magn[i] + probSpeech * inst->noisePrev[i]);
-      //
-      // time-constant based on speech/noise state
-      gammaNoiseOld = gammaNoiseTmp;
-      gammaNoiseTmp = NOISE_UPDATE;
-      // increase gamma (i.e., less noise update) for frame likely to be speech
-      if (probSpeech > PROB_RANGE) {
-        gammaNoiseTmp = SPEECH_UPDATE;
-      }
-      // conservative noise update
-      if (probSpeech < PROB_RANGE) {
-        inst->magnAvgPause[i] += GAMMA_PAUSE * (magn[i] - inst->magnAvgPause[i]);
-      }
-      // noise update
-      if (gammaNoiseTmp == gammaNoiseOld) {
-        noise[i] = noiseUpdateTmp;
-      } else {
-        noise[i] = gammaNoiseTmp * inst->noisePrev[i] + ((float)1.0 - gammaNoiseTmp)
-                   * (probNonSpeech * magn[i] + probSpeech * inst->noisePrev[i]);
-        // allow for noise update downwards:
-        //  if noise update decreases the noise, it is safe, so allow it to happen
-        if (noiseUpdateTmp < noise[i]) {
-          noise[i] = noiseUpdateTmp;
-        }
-      }
-    } // end of freq loop
+    // update the noise estimate
+    WebRtcNs_UpdateNoise(inst, magn, probSpeechFinal, noise);
     // done with step 2: noise update
 
     //
     // STEP 3: compute dd update of prior snr and post snr based on new noise estimate
     //
-    for (i = 0; i < inst->magnLen; i++) {
-      // post and prior snr
-      currentEstimateStsa = (float)0.0;
-      if (magn[i] > noise[i]) {
-        currentEstimateStsa = magn[i] / (noise[i] + (float)0.0001) - (float)1.0;
-      }
-      // DD estimate is sume of two terms: current estimate and previous estimate
-      // directed decision update of snrPrior
-      snrPrior = DD_PR_SNR * previousEstimateStsa[i] + ((float)1.0 - DD_PR_SNR)
-                 * currentEstimateStsa;
-      // gain filter
-      tmpFloat1 = inst->overdrive + snrPrior;
-      tmpFloat2 = (float)snrPrior / tmpFloat1;
-      theFilter[i] = (float)tmpFloat2;
-    } // end of loop over freqs
+    WebRtcNs_WienerGain(inst, magn, noise, previousEstimateStsa, theFilter);
     // done with step3
 #endif
 #endif
 
-    for (i = 0; i < inst->magnLen; i++) {
-      // flooring bottom
-      if (theFilter[i] < inst->denoiseBound) {
-        theFilter[i] = inst->denoiseBound;
-      }
-      // flooring top
-      if (theFilter[i] > (float)1.0) {
-        theFilter[i] = 1.0;
-      }
-      if (inst->blockInd < END_STARTUP_SHORT) {
-        // flooring bottom
-        if (theFilterTmp[i] < inst->denoiseBound) {
-          theFilterTmp[i] = inst->denoiseBound;
-        }
-        // flooring top
-        if (theFilterTmp[i] > (float)1.0) {
-          theFilterTmp[i] = 1.0;
-        }
-        // Weight the two suppression filters
-        theFilter[i] *= (inst->blockInd);
-        theFilterTmp[i] *= (END_STARTUP_SHORT - inst->blockInd);
-        theFilter[i] += theFilterTmp[i];
-        theFilter[i] /= (END_STARTUP_SHORT);
-      }
-      // smoothing
-#ifdef PROCESS_FLOW_0
-      inst->smooth[i] *= SMOOTH; // value set to 0.7 in define.h file
-      inst->smooth[i] += ((float)1.0 - SMOOTH) * theFilter[i];
-#else
-      inst->smooth[i] = theFilter[i];
-#endif
-      real[i] *= inst->smooth[i];
-      imag[i] *= inst->smooth[i];
-    }
+    WebRtcNs_ApplyGain(inst, theFilter, theFilterTmp, real, imag);
     // keep track of noise and magn spectrum for next frame
     for (i = 0; i < inst->magnLen; i++) {
       inst->noisePrev[i] = noise[i];
@@ -12,6 +12,7 @@
 #define WEBRTC_MODULES_AUDIO_PROCESSING_NS_MAIN_SOURCE_NS_CORE_H_
 
 #include "defines.h"
+#include "webrtc/typedefs.h"
 
 typedef struct NSParaExtract_t_ {
 
@@ -172,6 +173,77 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
                          short* outFrameLow,
                          short* outFrameHigh);
 
+/****************************************************************************
+ * Function pointers for the speed-critical loops of WebRtcNs_ProcessCore(),
+ * with generic C versions in ns_core.c and SSE2 and NEON versions in
+ * ns_core_sse2.c and ns_core_neon.c. The SSE2 versions give bit-exact
+ * results; the NEON versions use reciprocal estimates and may differ in the
+ * last bits.
+ */
+// Copies bins [1, magnLen - 1) of the FFT output |fft| to |real| and |imag|,
+// computes their magnitude spectrum |magn| and adds their energy and
+// magnitude, in bin order, to |signalEnergy| and |sumMagn|.
+typedef void (*WebRtcNs_MagnSpectrum_t)(int magnLen,
+                                        const float* fft,
+                                        float* real,
+                                        float* imag,
+                                        float* magn,
+                                        float* signalEnergy,
+                                        float* sumMagn);
+extern WebRtcNs_MagnSpectrum_t WebRtcNs_MagnSpectrum;
+
+// Updates the noise estimate |noise| from the previous estimate, weighted by
+// the speech probability |probSpeech|, and updates |inst->magnAvgPause| in
+// noise-like bins.
+typedef void (*WebRtcNs_UpdateNoise_t)(NSinst_t* inst,
+                                       const float* magn,
+                                       const float* probSpeech,
+                                       float* noise);
+extern WebRtcNs_UpdateNoise_t WebRtcNs_UpdateNoise;
+
+// Updates bin |i| as WebRtcNs_UpdateNoise() does, given the time constant
+// |gammaNoiseOld| chosen for the previous bin. Used by all versions for the
+// bins they don't vectorize.
+void WebRtcNs_UpdateNoiseBin(NSinst_t* inst,
+                             const float* magn,
+                             const float* probSpeechFinal,
+                             int i,
+                             float gammaNoiseOld,
+                             float* noise);
+
+// Computes the Wiener filter |theFilter| from the decision-directed estimate
+// of the prior SNR.
+typedef void (*WebRtcNs_WienerGain_t)(NSinst_t* inst,
+                                      const float* magn,
+                                      const float* noise,
+                                      const float* previousEstimateStsa,
+                                      float* theFilter);
+extern WebRtcNs_WienerGain_t WebRtcNs_WienerGain;
+
+// Limits |theFilter| to [denoiseBound, 1], blends it with |theFilterTmp|
+// during startup, and applies the resulting gain to the spectrum.
+typedef void (*WebRtcNs_ApplyGain_t)(NSinst_t* inst,
+                                     float* theFilter,
+                                     float* theFilterTmp,
+                                     float* real,
+                                     float* imag);
+extern WebRtcNs_ApplyGain_t WebRtcNs_ApplyGain;
+
+/****************************************************************************
+ * WebRtcNs_InitFunctions(...)
+ *
+ * Sets the function pointers above to the generic C versions, and then to
+ * the fastest versions supported by the CPU if |optimize| is nonzero. Called
+ * by WebRtcNs_InitCore() with |optimize| set.
+ */
+void WebRtcNs_InitFunctions(int optimize);
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void WebRtcNs_InitCore_SSE2(void);
+#endif
+#if (defined WEBRTC_DETECT_ARM_NEON || defined WEBRTC_ARCH_ARM_NEON)
+void WebRtcNs_InitCore_neon(void);
+#endif
 
 #ifdef __cplusplus
 }
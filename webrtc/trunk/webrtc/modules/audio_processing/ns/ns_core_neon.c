@@ -0,0 +1,243 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The floating point noise suppressor, NEON version of speed-critical
+ * functions. NEON has no division or square root, so these use refined
+ * reciprocal estimates, and the results differ from the generic C versions
+ * in the last bits.
+ */
+
+#include "ns_core.h"
+
+#include <arm_neon.h>
+#include <math.h>
+
+// Returns |a| / |b|, from the reciprocal estimate of |b| refined with two
+// Newton-Raphson steps.
+static __inline float32x4_t DivideNeon(float32x4_t a, float32x4_t b) {
+  float32x4_t reciprocal = vrecpeq_f32(b);
+  reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+  reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+  return vmulq_f32(a, reciprocal);
+}
+
+// Returns the square root of |a|, from the reciprocal square root estimate
+// refined with two Newton-Raphson steps.
+static __inline float32x4_t SqrtNeon(float32x4_t a) {
+  float32x4_t rsqrt = vrsqrteq_f32(a);
+  rsqrt = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, rsqrt), rsqrt), rsqrt);
+  rsqrt = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, rsqrt), rsqrt), rsqrt);
+  // The estimate is infinite for zero, where |a| itself is the result.
+  return vbslq_f32(vceqq_f32(a, vdupq_n_f32(0.0f)), a, vmulq_f32(a, rsqrt));
+}
+
+static __inline float HorizontalSum(float32x4_t a) {
+  const float32x2_t sum = vadd_f32(vget_low_f32(a), vget_high_f32(a));
+  return vget_lane_f32(vpadd_f32(sum, sum), 0);
+}
+
+static void MagnSpectrumNeon(int magnLen,
+                             const float* fft,
+                             float* real,
+                             float* imag,
+                             float* magn,
+                             float* signalEnergy,
+                             float* sumMagn) {
+  const float32x4_t kOne = vdupq_n_f32(1.0f);
+  float32x4_t energy = vdupq_n_f32(0.0f);
+  float32x4_t sum = vdupq_n_f32(0.0f);
+  float fTmp;
+  int i = 1;
+
+  for (; i + 4 <= magnLen - 1; i += 4) {
+    const float32x4x2_t bins = vld2q_f32(&fft[2 * i]);
+    const float32x4_t squared = vmlaq_f32(vmulq_f32(bins.val[0], bins.val[0]),
+                                          bins.val[1], bins.val[1]);
+    const float32x4_t mag = vaddq_f32(SqrtNeon(squared), kOne);
+    vst1q_f32(&real[i], bins.val[0]);
+    vst1q_f32(&imag[i], bins.val[1]);
+    vst1q_f32(&magn[i], mag);
+    energy = vaddq_f32(energy, squared);
+    sum = vaddq_f32(sum, mag);
+  }
+  *signalEnergy += HorizontalSum(energy);
+  *sumMagn += HorizontalSum(sum);
+  for (; i < magnLen - 1; i++) {
+    real[i] = fft[2 * i];
+    imag[i] = fft[2 * i + 1];
+    fTmp = real[i] * real[i];
+    fTmp += imag[i] * imag[i];
+    *signalEnergy += fTmp;
+    magn[i] = ((float)sqrt(fTmp)) + 1.0f;
+    *sumMagn += magn[i];
+  }
+}
+
+static void UpdateNoiseNeon(NSinst_t* inst,
+                            const float* magn,
+                            const float* probSpeechFinal,
+                            float* noise) {
+  const float32x4_t kOne = vdupq_n_f32(1.0f);
+  const float32x4_t kNoiseUpdate = vdupq_n_f32(NOISE_UPDATE);
+  const float32x4_t kSpeechUpdate = vdupq_n_f32(SPEECH_UPDATE);
+  const float32x4_t kProbRange = vdupq_n_f32(PROB_RANGE);
+  const float32x4_t kGammaPause = vdupq_n_f32(GAMMA_PAUSE);
+  int i;
+
+  // The time constant carried into a bin is the one chosen for the previous
+  // bin; the first bin starts from NOISE_UPDATE.
+  WebRtcNs_UpdateNoiseBin(inst, magn, probSpeechFinal, 0, NOISE_UPDATE,
+                          noise);
+  for (i = 1; i + 4 <= inst->magnLen; i += 4) {
+    const float32x4_t probSpeech = vld1q_f32(&probSpeechFinal[i]);
+    const float32x4_t probSpeechPrev = vld1q_f32(&probSpeechFinal[i - 1]);
+    const float32x4_t probNonSpeech = vsubq_f32(kOne, probSpeech);
+    const float32x4_t mag = vld1q_f32(&magn[i]);
+    const float32x4_t noisePrev = vld1q_f32(&inst->noisePrev[i]);
+    const float32x4_t pause = vld1q_f32(&inst->magnAvgPause[i]);
+    const float32x4_t gammaOld = vbslq_f32(vcgtq_f32(probSpeechPrev,
+                                                     kProbRange),
+                                           kSpeechUpdate, kNoiseUpdate);
+    const float32x4_t gammaNew = vbslq_f32(vcgtq_f32(probSpeech, kProbRange),
+                                           kSpeechUpdate, kNoiseUpdate);
+    const float32x4_t mixed = vmlaq_f32(vmulq_f32(probNonSpeech, mag),
+                                        probSpeech, noisePrev);
+    const float32x4_t updateOld = vmlaq_f32(
+        vmulq_f32(gammaOld, noisePrev), vsubq_f32(kOne, gammaOld), mixed);
+    const float32x4_t updateNew = vmlaq_f32(
+        vmulq_f32(gammaNew, noisePrev), vsubq_f32(kOne, gammaNew), mixed);
+    const float32x4_t pauseUpdate = vmlaq_f32(pause, kGammaPause,
+                                              vsubq_f32(mag, pause));
+    vst1q_f32(&inst->magnAvgPause[i],
+              vbslq_f32(vcltq_f32(probSpeech, kProbRange), pauseUpdate,
+                        pause));
+    // Where the time constants are equal the two updates are equal too, so
+    // taking the minimum covers both branches of the C version.
+    vst1q_f32(&noise[i], vminq_f32(updateOld, updateNew));
+  }
+  for (; i < inst->magnLen; i++) {
+    WebRtcNs_UpdateNoiseBin(inst, magn, probSpeechFinal, i,
+                            probSpeechFinal[i - 1] > PROB_RANGE ?
+                                SPEECH_UPDATE : NOISE_UPDATE,
+                            noise);
+  }
+}
+
+static void WienerGainNeon(NSinst_t* inst,
+                           const float* magn,
+                           const float* noise,
+                           const float* previousEstimateStsa,
+                           float* theFilter) {
+  const float32x4_t kOne = vdupq_n_f32(1.0f);
+  const float32x4_t kNoiseFloor = vdupq_n_f32(0.0001f);
+  const float32x4_t kDdCurrent = vdupq_n_f32((float)1.0 - DD_PR_SNR);
+  const float32x4_t overdrive = vdupq_n_f32(inst->overdrive);
+  float currentEstimateStsa, snrPrior;
+  int i;
+
+  for (i = 0; i + 4 <= inst->magnLen; i += 4) {
+    const float32x4_t mag = vld1q_f32(&magn[i]);
+    const float32x4_t noi = vld1q_f32(&noise[i]);
+    const float32x4_t ratio = DivideNeon(mag, vaddq_f32(noi, kNoiseFloor));
+    const float32x4_t current = vreinterpretq_f32_u32(vandq_u32(
+        vcgtq_f32(mag, noi),
+        vreinterpretq_u32_f32(vsubq_f32(ratio, kOne))));
+    const float32x4_t snr = vmlaq_f32(
+        vmulq_n_f32(vld1q_f32(&previousEstimateStsa[i]), DD_PR_SNR),
+        kDdCurrent, current);
+    vst1q_f32(&theFilter[i], DivideNeon(snr, vaddq_f32(overdrive, snr)));
+  }
+  for (; i < inst->magnLen; i++) {
+    currentEstimateStsa = (float)0.0;
+    if (magn[i] > noise[i]) {
+      currentEstimateStsa = magn[i] / (noise[i] + (float)0.0001) - (float)1.0;
+    }
+    snrPrior = DD_PR_SNR * previousEstimateStsa[i] + ((float)1.0 - DD_PR_SNR)
+               * currentEstimateStsa;
+    theFilter[i] = snrPrior / (inst->overdrive + snrPrior);
+  }
+}
+
+static void ApplyGainNeon(NSinst_t* inst,
+                          float* theFilter,
+                          float* theFilterTmp,
+                          float* real,
+                          float* imag) {
+  const int startup = inst->blockInd < END_STARTUP_SHORT;
+  const float32x4_t kOne = vdupq_n_f32(1.0f);
+  const float32x4_t bound = vdupq_n_f32(inst->denoiseBound);
+  // The weights of the two filters during startup, including the
+  // normalization.
+  const float weight = (float)inst->blockInd / END_STARTUP_SHORT;
+  const float weightTmp =
+      (float)(END_STARTUP_SHORT - inst->blockInd) / END_STARTUP_SHORT;
+#ifdef PROCESS_FLOW_0
+  const float32x4_t kSmoothNew = vdupq_n_f32((float)1.0 - SMOOTH);
+#endif
+  int i;
+
+  for (i = 0; i + 4 <= inst->magnLen; i += 4) {
+    float32x4_t filter = vld1q_f32(&theFilter[i]);
+    float32x4_t smooth;
+    filter = vminq_f32(vmaxq_f32(filter, bound), kOne);
+    if (startup) {
+      float32x4_t filterTmp = vld1q_f32(&theFilterTmp[i]);
+      filterTmp = vminq_f32(vmaxq_f32(filterTmp, bound), kOne);
+      filterTmp = vmulq_n_f32(filterTmp, weightTmp);
+      filter = vmlaq_n_f32(filterTmp, filter, weight);
+    }
+    vst1q_f32(&theFilter[i], filter);
+#ifdef PROCESS_FLOW_0
+    smooth = vmlaq_f32(vmulq_n_f32(vld1q_f32(&inst->smooth[i]), SMOOTH),
+                       kSmoothNew, filter);
+#else
+    smooth = filter;
+#endif
+    vst1q_f32(&inst->smooth[i], smooth);
+    vst1q_f32(&real[i], vmulq_f32(vld1q_f32(&real[i]), smooth));
+    vst1q_f32(&imag[i], vmulq_f32(vld1q_f32(&imag[i]), smooth));
+  }
+  for (; i < inst->magnLen; i++) {
+    if (theFilter[i] < inst->denoiseBound) {
+      theFilter[i] = inst->denoiseBound;
+    }
+    if (theFilter[i] > (float)1.0) {
+      theFilter[i] = 1.0;
+    }
+    if (startup) {
+      if (theFilterTmp[i] < inst->denoiseBound) {
+        theFilterTmp[i] = inst->denoiseBound;
+      }
+      if (theFilterTmp[i] > (float)1.0) {
+        theFilterTmp[i] = 1.0;
+      }
+      theFilter[i] *= (inst->blockInd);
+      theFilterTmp[i] *= (END_STARTUP_SHORT - inst->blockInd);
+      theFilter[i] += theFilterTmp[i];
+      theFilter[i] /= (END_STARTUP_SHORT);
+    }
+#ifdef PROCESS_FLOW_0
+    inst->smooth[i] *= SMOOTH;
+    inst->smooth[i] += ((float)1.0 - SMOOTH) * theFilter[i];
+#else
+    inst->smooth[i] = theFilter[i];
+#endif
+    real[i] *= inst->smooth[i];
+    imag[i] *= inst->smooth[i];
+  }
+}
+
+void WebRtcNs_InitCore_neon(void) {
+  WebRtcNs_MagnSpectrum = MagnSpectrumNeon;
+  WebRtcNs_UpdateNoise = UpdateNoiseNeon;
+  WebRtcNs_WienerGain = WienerGainNeon;
+  WebRtcNs_ApplyGain = ApplyGainNeon;
+}
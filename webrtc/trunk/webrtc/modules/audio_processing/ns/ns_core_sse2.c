@@ -0,0 +1,243 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The floating point noise suppressor, SSE2 version of speed-critical
+ * functions. Only element-wise operations are used, in the same order as in
+ * the generic C versions, so that the results are bit-exact.
+ */
+
+#include "ns_core.h"
+
+#include <emmintrin.h>
+#include <math.h>
+
+// Returns the elements of |a| where |mask| is set, and of |b| elsewhere.
+static __inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static void MagnSpectrumSSE2(int magnLen,
+                             const float* fft,
+                             float* real,
+                             float* imag,
+                             float* magn,
+                             float* signalEnergy,
+                             float* sumMagn) {
+  const __m128 kOne = _mm_set1_ps(1.0f);
+  float energy = *signalEnergy;
+  float sum = *sumMagn;
+  float power[4];
+  float fTmp;
+  int i = 1;
+
+  for (; i + 4 <= magnLen - 1; i += 4) {
+    const __m128 fft_0 = _mm_loadu_ps(&fft[2 * i]);
+    const __m128 fft_4 = _mm_loadu_ps(&fft[2 * i + 4]);
+    const __m128 re = _mm_shuffle_ps(fft_0, fft_4, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 im = _mm_shuffle_ps(fft_0, fft_4, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m128 squared = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+    // sqrtps is correctly rounded, as is the float conversion of the double
+    // precision square root in the C version.
+    const __m128 mag = _mm_add_ps(_mm_sqrt_ps(squared), kOne);
+    _mm_storeu_ps(&real[i], re);
+    _mm_storeu_ps(&imag[i], im);
+    _mm_storeu_ps(&magn[i], mag);
+    _mm_storeu_ps(power, squared);
+    // Accumulate in bin order, as the C version does.
+    energy += power[0];
+    energy += power[1];
+    energy += power[2];
+    energy += power[3];
+    sum += magn[i];
+    sum += magn[i + 1];
+    sum += magn[i + 2];
+    sum += magn[i + 3];
+  }
+  for (; i < magnLen - 1; i++) {
+    real[i] = fft[2 * i];
+    imag[i] = fft[2 * i + 1];
+    fTmp = real[i] * real[i];
+    fTmp += imag[i] * imag[i];
+    energy += fTmp;
+    magn[i] = ((float)sqrt(fTmp)) + 1.0f;
+    sum += magn[i];
+  }
+  *signalEnergy = energy;
+  *sumMagn = sum;
+}
+
+static void UpdateNoiseSSE2(NSinst_t* inst,
+                            const float* magn,
+                            const float* probSpeechFinal,
+                            float* noise) {
+  const __m128 kOne = _mm_set1_ps(1.0f);
+  const __m128 kNoiseUpdate = _mm_set1_ps(NOISE_UPDATE);
+  const __m128 kSpeechUpdate = _mm_set1_ps(SPEECH_UPDATE);
+  const __m128 kProbRange = _mm_set1_ps(PROB_RANGE);
+  const __m128 kGammaPause = _mm_set1_ps(GAMMA_PAUSE);
+  int i;
+
+  // The time constant carried into a bin is the one chosen for the previous
+  // bin, which only depends on the speech probability there; the first bin
+  // starts from NOISE_UPDATE.
+  WebRtcNs_UpdateNoiseBin(inst, magn, probSpeechFinal, 0, NOISE_UPDATE,
+                          noise);
+  for (i = 1; i + 4 <= inst->magnLen; i += 4) {
+    const __m128 probSpeech = _mm_loadu_ps(&probSpeechFinal[i]);
+    const __m128 probSpeechPrev = _mm_loadu_ps(&probSpeechFinal[i - 1]);
+    const __m128 probNonSpeech = _mm_sub_ps(kOne, probSpeech);
+    const __m128 mag = _mm_loadu_ps(&magn[i]);
+    const __m128 noisePrev = _mm_loadu_ps(&inst->noisePrev[i]);
+    const __m128 pause = _mm_loadu_ps(&inst->magnAvgPause[i]);
+    const __m128 gammaOld = Select(_mm_cmpgt_ps(probSpeechPrev, kProbRange),
+                                   kSpeechUpdate, kNoiseUpdate);
+    const __m128 gammaNew = Select(_mm_cmpgt_ps(probSpeech, kProbRange),
+                                   kSpeechUpdate, kNoiseUpdate);
+    const __m128 mixed = _mm_add_ps(_mm_mul_ps(probNonSpeech, mag),
+                                    _mm_mul_ps(probSpeech, noisePrev));
+    const __m128 updateOld = _mm_add_ps(
+        _mm_mul_ps(gammaOld, noisePrev),
+        _mm_mul_ps(_mm_sub_ps(kOne, gammaOld), mixed));
+    const __m128 updateNew = _mm_add_ps(
+        _mm_mul_ps(gammaNew, noisePrev),
+        _mm_mul_ps(_mm_sub_ps(kOne, gammaNew), mixed));
+    const __m128 pauseUpdate = _mm_add_ps(
+        pause, _mm_mul_ps(kGammaPause, _mm_sub_ps(mag, pause)));
+    _mm_storeu_ps(&inst->magnAvgPause[i],
+                  Select(_mm_cmplt_ps(probSpeech, kProbRange),
+                         pauseUpdate, pause));
+    // Where the time constants are equal the two updates are equal too, so
+    // taking the minimum covers both branches of the C version.
+    _mm_storeu_ps(&noise[i], _mm_min_ps(updateOld, updateNew));
+  }
+  for (; i < inst->magnLen; i++) {
+    WebRtcNs_UpdateNoiseBin(inst, magn, probSpeechFinal, i,
+                            probSpeechFinal[i - 1] > PROB_RANGE ?
+                                SPEECH_UPDATE : NOISE_UPDATE,
+                            noise);
+  }
+}
+
+static void WienerGainSSE2(NSinst_t* inst,
+                           const float* magn,
+                           const float* noise,
+                           const float* previousEstimateStsa,
+                           float* theFilter) {
+  const __m128 kOne = _mm_set1_ps(1.0f);
+  const __m128 kNoiseFloor = _mm_set1_ps(0.0001f);
+  const __m128 kDdPrSnr = _mm_set1_ps(DD_PR_SNR);
+  const __m128 kDdCurrent = _mm_set1_ps((float)1.0 - DD_PR_SNR);
+  const __m128 overdrive = _mm_set1_ps(inst->overdrive);
+  float currentEstimateStsa, snrPrior;
+  int i;
+
+  for (i = 0; i + 4 <= inst->magnLen; i += 4) {
+    const __m128 mag = _mm_loadu_ps(&magn[i]);
+    const __m128 noi = _mm_loadu_ps(&noise[i]);
+    // The division is done in all bins, but only kept where the magnitude is
+    // above the noise.
+    const __m128 current = _mm_and_ps(
+        _mm_cmpgt_ps(mag, noi),
+        _mm_sub_ps(_mm_div_ps(mag, _mm_add_ps(noi, kNoiseFloor)), kOne));
+    const __m128 snr = _mm_add_ps(
+        _mm_mul_ps(kDdPrSnr, _mm_loadu_ps(&previousEstimateStsa[i])),
+        _mm_mul_ps(kDdCurrent, current));
+    _mm_storeu_ps(&theFilter[i],
+                  _mm_div_ps(snr, _mm_add_ps(overdrive, snr)));
+  }
+  for (; i < inst->magnLen; i++) {
+    currentEstimateStsa = (float)0.0;
+    if (magn[i] > noise[i]) {
+      currentEstimateStsa = magn[i] / (noise[i] + (float)0.0001) - (float)1.0;
+    }
+    snrPrior = DD_PR_SNR * previousEstimateStsa[i] + ((float)1.0 - DD_PR_SNR)
+               * currentEstimateStsa;
+    theFilter[i] = snrPrior / (inst->overdrive + snrPrior);
+  }
+}
+
+static void ApplyGainSSE2(NSinst_t* inst,
+                          float* theFilter,
+                          float* theFilterTmp,
+                          float* real,
+                          float* imag) {
+  const int startup = inst->blockInd < END_STARTUP_SHORT;
+  const __m128 kOne = _mm_set1_ps(1.0f);
+  const __m128 bound = _mm_set1_ps(inst->denoiseBound);
+  const __m128 weight = _mm_set1_ps((float)inst->blockInd);
+  const __m128 weightTmp =
+      _mm_set1_ps((float)(END_STARTUP_SHORT - inst->blockInd));
+  const __m128 kStartup = _mm_set1_ps((float)END_STARTUP_SHORT);
+#ifdef PROCESS_FLOW_0
+  const __m128 kSmooth = _mm_set1_ps(SMOOTH);
+  const __m128 kSmoothNew = _mm_set1_ps((float)1.0 - SMOOTH);
+#endif
+  int i;
+
+  for (i = 0; i + 4 <= inst->magnLen; i += 4) {
+    __m128 filter = _mm_loadu_ps(&theFilter[i]);
+    __m128 smooth;
+    filter = _mm_min_ps(_mm_max_ps(filter, bound), kOne);
+    if (startup) {
+      __m128 filterTmp = _mm_loadu_ps(&theFilterTmp[i]);
+      filterTmp = _mm_min_ps(_mm_max_ps(filterTmp, bound), kOne);
+      filterTmp = _mm_mul_ps(filterTmp, weightTmp);
+      filter = _mm_add_ps(_mm_mul_ps(filter, weight), filterTmp);
+      filter = _mm_div_ps(filter, kStartup);
+      _mm_storeu_ps(&theFilterTmp[i], filterTmp);
+    }
+    _mm_storeu_ps(&theFilter[i], filter);
+#ifdef PROCESS_FLOW_0
+    smooth = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&inst->smooth[i]), kSmooth),
+                        _mm_mul_ps(kSmoothNew, filter));
+#else
+    smooth = filter;
+#endif
+    _mm_storeu_ps(&inst->smooth[i], smooth);
+    _mm_storeu_ps(&real[i], _mm_mul_ps(_mm_loadu_ps(&real[i]), smooth));
+    _mm_storeu_ps(&imag[i], _mm_mul_ps(_mm_loadu_ps(&imag[i]), smooth));
+  }
+  for (; i < inst->magnLen; i++) {
+    if (theFilter[i] < inst->denoiseBound) {
+      theFilter[i] = inst->denoiseBound;
+    }
+    if (theFilter[i] > (float)1.0) {
+      theFilter[i] = 1.0;
+    }
+    if (startup) {
+      if (theFilterTmp[i] < inst->denoiseBound) {
+        theFilterTmp[i] = inst->denoiseBound;
+      }
+      if (theFilterTmp[i] > (float)1.0) {
+        theFilterTmp[i] = 1.0;
+      }
+      theFilter[i] *= (inst->blockInd);
+      theFilterTmp[i] *= (END_STARTUP_SHORT - inst->blockInd);
+      theFilter[i] += theFilterTmp[i];
+      theFilter[i] /= (END_STARTUP_SHORT);
+    }
+#ifdef PROCESS_FLOW_0
+    inst->smooth[i] *= SMOOTH;
+    inst->smooth[i] += ((float)1.0 - SMOOTH) * theFilter[i];
+#else
+    inst->smooth[i] = theFilter[i];
+#endif
+    real[i] *= inst->smooth[i];
+    imag[i] *= inst->smooth[i];
+  }
+}
+
+void WebRtcNs_InitCore_SSE2(void) {
+  WebRtcNs_MagnSpectrum = MagnSpectrumSSE2;
+  WebRtcNs_UpdateNoise = UpdateNoiseSSE2;
+  WebRtcNs_WienerGain = WienerGainSSE2;
+  WebRtcNs_ApplyGain = ApplyGainSSE2;
+}
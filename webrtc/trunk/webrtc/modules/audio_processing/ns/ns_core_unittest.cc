@@ -0,0 +1,257 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "modules/audio_processing/ns/ns_core.h"
+#include "modules/audio_processing/test/test_utils.h"
+#include "system_wrappers/interface/tick_util.h"
+#include "typedefs.h"
+
+using webrtc::ExpectNear;
+using webrtc::FillRandom;
+using webrtc::RandomFloat;
+
+namespace {
+
+// Relative to the largest magnitude in the compared data. The SSE2 versions
+// are bit-exact. The NEON versions refine reciprocal estimates with two
+// Newton-Raphson steps, which leaves a few ulps.
+const float kTolerance = 1e-5f;
+// The difference in the output samples after processing a few seconds.
+const int kMaxSampleDiff = 2;
+
+const int kNumFrames = 300;
+
+struct Functions {
+  WebRtcNs_MagnSpectrum_t magn_spectrum;
+  WebRtcNs_UpdateNoise_t update_noise;
+  WebRtcNs_WienerGain_t wiener_gain;
+  WebRtcNs_ApplyGain_t apply_gain;
+};
+
+Functions GetFunctions(int optimize) {
+  WebRtcNs_InitFunctions(optimize);
+  Functions functions = { WebRtcNs_MagnSpectrum, WebRtcNs_UpdateNoise,
+                          WebRtcNs_WienerGain, WebRtcNs_ApplyGain };
+  return functions;
+}
+
+void SetFunctions(const Functions& functions) {
+  WebRtcNs_MagnSpectrum = functions.magn_spectrum;
+  WebRtcNs_UpdateNoise = functions.update_noise;
+  WebRtcNs_WienerGain = functions.wiener_gain;
+  WebRtcNs_ApplyGain = functions.apply_gain;
+}
+
+// Fills |data| with 10 ms frame number |frame| of a speech-like signal.
+void GenerateFrame(int sample_rate_hz, int frame, short* data) {
+  const int length = sample_rate_hz / 100;
+  for (int i = 0; i < length; ++i) {
+    data[i] = webrtc::SpeechLikeSample(frame * length + i, sample_rate_hz);
+  }
+}
+
+class NsCoreTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    srand(42);
+    optimized_ = GetFunctions(1);
+    generic_ = GetFunctions(0);
+    memset(&inst_, 0, sizeof(inst_));
+    ASSERT_EQ(0, WebRtcNs_InitCore(&inst_, 16000));
+    ASSERT_EQ(0, WebRtcNs_set_policy_core(&inst_, 2));
+  }
+
+  virtual void TearDown() {
+    WebRtcNs_InitFunctions(1);
+  }
+
+  // Processes |kNumFrames| frames with the generic and the optimized
+  // functions, and compares the output.
+  void RunAndCompare(int sample_rate_hz);
+
+  Functions generic_;
+  Functions optimized_;
+  NSinst_t inst_;
+};
+
+void NsCoreTest::RunAndCompare(int sample_rate_hz) {
+  NSinst_t generic_inst;
+  NSinst_t optimized_inst;
+  ASSERT_EQ(0, WebRtcNs_InitCore(&generic_inst, sample_rate_hz));
+  ASSERT_EQ(0, WebRtcNs_set_policy_core(&generic_inst, 1));
+  ASSERT_EQ(0, WebRtcNs_InitCore(&optimized_inst, sample_rate_hz));
+  ASSERT_EQ(0, WebRtcNs_set_policy_core(&optimized_inst, 1));
+
+  // Only the lower band is processed, as the splitting filter would give it
+  // at 32 kHz.
+  const int band_rate_hz = sample_rate_hz == 32000 ? 16000 : sample_rate_hz;
+  short in[BLOCKL_MAX];
+  short in_high[BLOCKL_MAX] = { 0 };
+  short generic_out[BLOCKL_MAX];
+  short generic_out_high[BLOCKL_MAX];
+  short optimized_out[BLOCKL_MAX];
+  short optimized_out_high[BLOCKL_MAX];
+  int max_diff = 0;
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    GenerateFrame(band_rate_hz, frame, in);
+    SetFunctions(generic_);
+    ASSERT_EQ(0, WebRtcNs_ProcessCore(&generic_inst, in, in_high,
+                                      generic_out, generic_out_high));
+    SetFunctions(optimized_);
+    ASSERT_EQ(0, WebRtcNs_ProcessCore(&optimized_inst, in, in_high,
+                                      optimized_out, optimized_out_high));
+    for (int i = 0; i < band_rate_hz / 100; ++i) {
+      max_diff = std::max(max_diff, abs(generic_out[i] - optimized_out[i]));
+    }
+  }
+  EXPECT_LE(max_diff, kMaxSampleDiff);
+}
+
+TEST_F(NsCoreTest, MagnSpectrumMatchesGeneric) {
+  float fft[ANAL_BLOCKL_MAX];
+  FillRandom(fft, inst_.anaLen, -30000.0f, 30000.0f);
+
+  float real[2][ANAL_BLOCKL_MAX];
+  float imag[2][HALF_ANAL_BLOCKL];
+  float magn[2][HALF_ANAL_BLOCKL];
+  float energy[2] = { 1.0f, 1.0f };
+  float sum[2] = { 2.0f, 2.0f };
+  generic_.magn_spectrum(inst_.magnLen, fft, real[0], imag[0], magn[0],
+                         &energy[0], &sum[0]);
+  optimized_.magn_spectrum(inst_.magnLen, fft, real[1], imag[1], magn[1],
+                           &energy[1], &sum[1]);
+
+  // Only bins [1, magnLen - 1) are written.
+  const int length = inst_.magnLen - 2;
+  ExpectNear(&real[0][1], &real[1][1], length, kTolerance);
+  ExpectNear(&imag[0][1], &imag[1][1], length, kTolerance);
+  ExpectNear(&magn[0][1], &magn[1][1], length, kTolerance);
+  ExpectNear(energy, &energy[1], 1, kTolerance);
+  ExpectNear(sum, &sum[1], 1, kTolerance);
+}
+
+TEST_F(NsCoreTest, UpdateNoiseMatchesGeneric) {
+  float magn[HALF_ANAL_BLOCKL];
+  float prob_speech[HALF_ANAL_BLOCKL];
+  FillRandom(magn, inst_.magnLen, 1.0f, 1000.0f);
+  FillRandom(inst_.noisePrev, inst_.magnLen, 1.0f, 1000.0f);
+  FillRandom(inst_.magnAvgPause, inst_.magnLen, 1.0f, 1000.0f);
+  // Cover both time constants, and runs of equal ones.
+  for (int i = 0; i < inst_.magnLen; ++i) {
+    prob_speech[i] = (i / 3) % 2 == 0 ? RandomFloat(0.0f, 0.4f) :
+                                        RandomFloat(0.0f, 1.0f);
+  }
+  prob_speech[7] = PROB_RANGE;
+
+  NSinst_t optimized_inst = inst_;
+  float noise[2][HALF_ANAL_BLOCKL];
+  generic_.update_noise(&inst_, magn, prob_speech, noise[0]);
+  optimized_.update_noise(&optimized_inst, magn, prob_speech, noise[1]);
+
+  ExpectNear(noise[0], noise[1], inst_.magnLen, kTolerance);
+  ExpectNear(inst_.magnAvgPause, optimized_inst.magnAvgPause, inst_.magnLen,
+             kTolerance);
+}
+
+TEST_F(NsCoreTest, WienerGainMatchesGeneric) {
+  float magn[HALF_ANAL_BLOCKL];
+  float noise[HALF_ANAL_BLOCKL];
+  float previous_estimate[HALF_ANAL_BLOCKL];
+  FillRandom(magn, inst_.magnLen, 1.0f, 1000.0f);
+  FillRandom(noise, inst_.magnLen, 1.0f, 1000.0f);
+  FillRandom(previous_estimate, inst_.magnLen, 0.0f, 100.0f);
+  noise[3] = magn[3];
+
+  float filter[2][HALF_ANAL_BLOCKL];
+  generic_.wiener_gain(&inst_, magn, noise, previous_estimate, filter[0]);
+  optimized_.wiener_gain(&inst_, magn, noise, previous_estimate, filter[1]);
+
+  ExpectNear(filter[0], filter[1], inst_.magnLen, kTolerance);
+}
+
+TEST_F(NsCoreTest, ApplyGainMatchesGeneric) {
+  float filter[2][HALF_ANAL_BLOCKL];
+  float filter_tmp[2][HALF_ANAL_BLOCKL];
+  float real[2][ANAL_BLOCKL_MAX];
+  float imag[2][HALF_ANAL_BLOCKL];
+  // Once during startup, where the two filters are blended, and once after.
+  const int kBlockInd[] = { 10, END_STARTUP_SHORT };
+  for (size_t n = 0; n < sizeof(kBlockInd) / sizeof(*kBlockInd); ++n) {
+    inst_.blockInd = kBlockInd[n];
+    FillRandom(filter[0], inst_.magnLen, -0.5f, 1.5f);
+    FillRandom(filter_tmp[0], inst_.magnLen, -0.5f, 1.5f);
+    FillRandom(real[0], inst_.magnLen, -30000.0f, 30000.0f);
+    FillRandom(imag[0], inst_.magnLen, -30000.0f, 30000.0f);
+    memcpy(filter[1], filter[0], sizeof(filter[0]));
+    memcpy(filter_tmp[1], filter_tmp[0], sizeof(filter_tmp[0]));
+    memcpy(real[1], real[0], sizeof(real[0]));
+    memcpy(imag[1], imag[0], sizeof(imag[0]));
+
+    NSinst_t optimized_inst = inst_;
+    generic_.apply_gain(&inst_, filter[0], filter_tmp[0], real[0], imag[0]);
+    optimized_.apply_gain(&optimized_inst, filter[1], filter_tmp[1], real[1],
+                          imag[1]);
+
+    ExpectNear(inst_.smooth, optimized_inst.smooth, inst_.magnLen, kTolerance);
+    ExpectNear(real[0], real[1], inst_.magnLen, kTolerance);
+    ExpectNear(imag[0], imag[1], inst_.magnLen, kTolerance);
+  }
+}
+
+TEST_F(NsCoreTest, ProcessMatchesGeneric8kHz) {
+  RunAndCompare(8000);
+}
+
+TEST_F(NsCoreTest, ProcessMatchesGeneric16kHz) {
+  RunAndCompare(16000);
+}
+
+TEST_F(NsCoreTest, ProcessMatchesGeneric32kHz) {
+  RunAndCompare(32000);
+}
+
+// Reports the mean time to process a 16 kHz frame with the generic and the
+// optimized functions.
+TEST_F(NsCoreTest, ProcessTime) {
+  const int kNumTimedFrames = 1000;
+  std::vector<short> in(kNumTimedFrames * BLOCKL_MAX);
+  for (int frame = 0; frame < kNumTimedFrames; ++frame) {
+    GenerateFrame(16000, frame, &in[frame * BLOCKL_MAX]);
+  }
+  short out[BLOCKL_MAX];
+  short out_high[BLOCKL_MAX];
+
+  const Functions* functions[] = { &generic_, &optimized_ };
+  const char* modifiers[] = { "_generic", "_optimized" };
+  for (int n = 0; n < 2; ++n) {
+    NSinst_t inst;
+    ASSERT_EQ(0, WebRtcNs_InitCore(&inst, 16000));
+    SetFunctions(*functions[n]);
+    const int64_t start_us = webrtc::TickTime::MicrosecondTimestamp();
+    for (int frame = 0; frame < kNumTimedFrames; ++frame) {
+      ASSERT_EQ(0, WebRtcNs_ProcessCore(&inst, &in[frame * BLOCKL_MAX], NULL,
+                                        out, out_high));
+    }
+    const int64_t elapsed_us =
+        webrtc::TickTime::MicrosecondTimestamp() - start_us;
+    webrtc::PrintFrameTime("ns_frame_time", modifiers[n], "16kHz", elapsed_us,
+                           kNumTimedFrames);
+  }
+}
+
+}  // namespace
@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "render_queue.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "module_common_types.h"
+
+namespace webrtc {
+
+RenderQueue::RenderQueue(int num_frames)
+    : num_frames_(num_frames),
+      info_(new FrameInfo[num_frames]),
+      samples_(new int16_t[num_frames * kMaxSamplesPerFrame]),
+      write_count_(0),
+      read_count_(0),
+      dropped_frames_(0) {
+  assert(num_frames > 0);
+  assert((num_frames & (num_frames - 1)) == 0);
+}
+
+RenderQueue::~RenderQueue() {}
+
+bool RenderQueue::Insert(const AudioFrame& frame) {
+  const int num_samples = frame.samples_per_channel_ * frame.num_channels_;
+  const uint32_t write_count = write_count_.Value();
+  const uint32_t read_count = read_count_.LoadWithBarrier();
+  if (num_samples > kMaxSamplesPerFrame ||
+      write_count - read_count >= static_cast<uint32_t>(num_frames_)) {
+    ++dropped_frames_;
+    return false;
+  }
+
+  const int slot = write_count & (num_frames_ - 1);
+  info_[slot].sample_rate_hz = frame.sample_rate_hz_;
+  info_[slot].num_channels = frame.num_channels_;
+  info_[slot].samples_per_channel = frame.samples_per_channel_;
+  memcpy(&samples_[slot * kMaxSamplesPerFrame], frame.data_,
+         sizeof(int16_t) * num_samples);
+  // Publishes the slot.
+  ++write_count_;
+  return true;
+}
+
+bool RenderQueue::Remove(AudioFrame* frame) {
+  const uint32_t read_count = read_count_.Value();
+  const uint32_t write_count = write_count_.LoadWithBarrier();
+  if (write_count == read_count) {
+    return false;
+  }
+
+  const int slot = read_count & (num_frames_ - 1);
+  frame->sample_rate_hz_ = info_[slot].sample_rate_hz;
+  frame->num_channels_ = info_[slot].num_channels;
+  frame->samples_per_channel_ = info_[slot].samples_per_channel;
+  memcpy(frame->data_, &samples_[slot * kMaxSamplesPerFrame],
+         sizeof(int16_t) * frame->samples_per_channel_ * frame->num_channels_);
+  // Hands the slot back to the producer.
+  ++read_count_;
+  return true;
+}
+
+void RenderQueue::Clear() {
+  const uint32_t read_count = read_count_.Value();
+  const uint32_t write_count = write_count_.LoadWithBarrier();
+  read_count_ += static_cast<int32_t>(write_count - read_count);
+}
+
+int RenderQueue::dropped_frames() const {
+  return dropped_frames_.Value();
+}
+
+}  // namespace webrtc
@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_PROCESSING_MAIN_SOURCE_RENDER_QUEUE_H_
+#define WEBRTC_MODULES_AUDIO_PROCESSING_MAIN_SOURCE_RENDER_QUEUE_H_
+
+#include "atomic32.h"
+#include "scoped_ptr.h"
+#include "typedefs.h"
+
+namespace webrtc {
+
+class AudioFrame;
+
+// Hands far-end frames from the render thread to the capture thread without
+// locking. There must be at most one thread calling Insert() and one thread
+// calling Remove() and Clear() at any time. Each slot holds up to 10 ms of
+// stereo audio at 32 kHz.
+class RenderQueue {
+ public:
+  enum { kMaxSamplesPerFrame = 2 * 320 };
+
+  // |num_frames| must be a power of two.
+  explicit RenderQueue(int num_frames);
+  ~RenderQueue();
+
+  // Copies the interleaved samples of |frame| to the queue. Returns false and
+  // drops the frame if the queue is full or the frame is too large.
+  bool Insert(const AudioFrame& frame);
+
+  // Moves the oldest frame in the queue to |frame|. Returns false if the queue
+  // is empty.
+  bool Remove(AudioFrame* frame);
+
+  // Discards all frames in the queue. Called from the consuming thread.
+  void Clear();
+
+  // Number of frames dropped by Insert().
+  int dropped_frames() const;
+
+ private:
+  struct FrameInfo {
+    int sample_rate_hz;
+    int num_channels;
+    int samples_per_channel;
+  };
+
+  const int num_frames_;
+  scoped_array<FrameInfo> info_;
+  scoped_array<int16_t> samples_;
+  // Frames inserted and removed since construction. Wrap around is fine as
+  // only the difference is used.
+  Atomic32 write_count_;
+  Atomic32 read_count_;
+  Atomic32 dropped_frames_;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_PROCESSING_MAIN_SOURCE_RENDER_QUEUE_H_
@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "gtest/gtest.h"
+
+#include "modules/audio_processing/render_queue.h"
+#include "modules/interface/module_common_types.h"
+#include "system_wrappers/interface/scoped_ptr.h"
+#include "system_wrappers/interface/sleep.h"
+#include "system_wrappers/interface/thread_wrapper.h"
+
+namespace webrtc {
+namespace {
+
+const int kQueueFrames = 4;
+
+// Fills |frame| with 10 ms of stereo audio at 32 kHz, every sample set to
+// |value|.
+void SetFrame(AudioFrame* frame, int16_t value) {
+  frame->sample_rate_hz_ = 32000;
+  frame->num_channels_ = 2;
+  frame->samples_per_channel_ = 320;
+  for (int i = 0; i < 640; ++i) {
+    frame->data_[i] = value;
+  }
+}
+
+TEST(RenderQueueTest, RemovesFramesInOrder) {
+  RenderQueue queue(kQueueFrames);
+  AudioFrame frame;
+  EXPECT_FALSE(queue.Remove(&frame));
+
+  for (int i = 0; i < 3 * kQueueFrames; ++i) {
+    SetFrame(&frame, i);
+    EXPECT_TRUE(queue.Insert(frame));
+    if (i % 2 == 1) {
+      // Remove two frames for every two inserted, one frame behind.
+      EXPECT_TRUE(queue.Remove(&frame));
+      EXPECT_EQ(i - 1, frame.data_[0]);
+      EXPECT_TRUE(queue.Remove(&frame));
+      EXPECT_EQ(i, frame.data_[639]);
+    }
+  }
+  EXPECT_FALSE(queue.Remove(&frame));
+  EXPECT_EQ(0, queue.dropped_frames());
+}
+
+TEST(RenderQueueTest, CopiesFormat) {
+  RenderQueue queue(kQueueFrames);
+  AudioFrame frame;
+  frame.sample_rate_hz_ = 8000;
+  frame.num_channels_ = 1;
+  frame.samples_per_channel_ = 80;
+  frame.data_[79] = 1234;
+  EXPECT_TRUE(queue.Insert(frame));
+
+  AudioFrame out_frame;
+  EXPECT_TRUE(queue.Remove(&out_frame));
+  EXPECT_EQ(8000, out_frame.sample_rate_hz_);
+  EXPECT_EQ(1, out_frame.num_channels_);
+  EXPECT_EQ(80, out_frame.samples_per_channel_);
+  EXPECT_EQ(1234, out_frame.data_[79]);
+}
+
+TEST(RenderQueueTest, DropsFramesWhenFull) {
+  RenderQueue queue(kQueueFrames);
+  AudioFrame frame;
+  for (int i = 0; i < kQueueFrames; ++i) {
+    SetFrame(&frame, i);
+    EXPECT_TRUE(queue.Insert(frame));
+  }
+  SetFrame(&frame, kQueueFrames);
+  EXPECT_FALSE(queue.Insert(frame));
+  EXPECT_EQ(1, queue.dropped_frames());
+
+  // The queued frames are kept.
+  EXPECT_TRUE(queue.Remove(&frame));
+  EXPECT_EQ(0, frame.data_[0]);
+  SetFrame(&frame, kQueueFrames);
+  EXPECT_TRUE(queue.Insert(frame));
+}
+
+TEST(RenderQueueTest, DropsOversizedFrames) {
+  RenderQueue queue(kQueueFrames);
+  AudioFrame frame;
+  frame.num_channels_ = 2;
+  frame.samples_per_channel_ = RenderQueue::kMaxSamplesPerFrame / 2 + 1;
+  EXPECT_FALSE(queue.Insert(frame));
+  EXPECT_EQ(1, queue.dropped_frames());
+  EXPECT_FALSE(queue.Remove(&frame));
+}
+
+TEST(RenderQueueTest, ClearDiscardsQueuedFrames) {
+  RenderQueue queue(kQueueFrames);
+  AudioFrame frame;
+  SetFrame(&frame, 1);
+  EXPECT_TRUE(queue.Insert(frame));
+  EXPECT_TRUE(queue.Insert(frame));
+  queue.Clear();
+  EXPECT_FALSE(queue.Remove(&frame));
+
+  // The full capacity is available again.
+  for (int i = 0; i < kQueueFrames; ++i) {
+    EXPECT_TRUE(queue.Insert(frame));
+  }
+}
+
+struct ProducerData {
+  explicit ProducerData(RenderQueue* queue_)
+      : queue(queue_),
+        next_value(0) {}
+  RenderQueue* queue;
+  int16_t next_value;
+  AudioFrame frame;
+};
+
+const int16_t kNumProducedFrames = 2000;
+
+bool Produce(void* obj) {
+  ProducerData* data = static_cast<ProducerData*>(obj);
+  if (data->next_value == kNumProducedFrames) {
+    return false;
+  }
+  SetFrame(&data->frame, data->next_value);
+  if (data->queue->Insert(data->frame)) {
+    ++data->next_value;
+  } else {
+    // The thread may run at a higher priority than the consumer; don't starve
+    // it.
+    SleepMs(1);
+  }
+  return true;
+}
+
+// Each frame must arrive whole and in order while the producer keeps
+// overwriting the slots the consumer has released.
+TEST(RenderQueueTest, ConcurrentInsertAndRemove) {
+  RenderQueue queue(kQueueFrames);
+  ProducerData data(&queue);
+  scoped_ptr<ThreadWrapper> thread(ThreadWrapper::CreateThread(
+      Produce, &data, kNormalPriority, "RenderQueueProducer"));
+  unsigned int thread_id = 0;
+  ASSERT_TRUE(thread->Start(thread_id));
+
+  AudioFrame frame;
+  int16_t expected_value = 0;
+  bool intact = true;
+  while (intact && expected_value < kNumProducedFrames) {
+    if (!queue.Remove(&frame)) {
+      continue;
+    }
+    intact = frame.samples_per_channel_ * frame.num_channels_ == 640 &&
+        frame.data_[0] == expected_value &&
+        frame.data_[639] == expected_value;
+    EXPECT_TRUE(intact) << "Frame " << expected_value;
+    ++expected_value;
+  }
+  thread->SetNotAlive();
+  EXPECT_TRUE(thread->Stop());
+  EXPECT_FALSE(queue.Remove(&frame));
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/test/test_utils.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "gtest/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+
+float RandomFloat(float min, float max) {
+  return min + (max - min) * (rand() / (RAND_MAX + 1.0f));
+}
+
+void FillRandom(float* data, int length, float min, float max) {
+  for (int i = 0; i < length; ++i) {
+    data[i] = RandomFloat(min, max);
+  }
+}
+
+void ExpectNear(const float* expected, const float* actual, int length,
+                float tolerance) {
+  float peak = 0.0f;
+  for (int i = 0; i < length; ++i) {
+    peak = std::max(peak, fabsf(expected[i]));
+  }
+  for (int i = 0; i < length; ++i) {
+    EXPECT_NEAR(expected[i], actual[i], tolerance * peak + 1e-30f)
+        << "Index " << i;
+  }
+}
+
+int16_t SpeechLikeSample(int n, int sample_rate_hz) {
+  float sample = RandomFloat(-1000.0f, 1000.0f);
+  if ((n / (sample_rate_hz / 2)) % 2 == 1) {
+    sample += 8000.0f * sinf(2.0f * 3.14159265f * 440.0f * n /
+                             sample_rate_hz);
+  }
+  return static_cast<int16_t>(sample);
+}
+
+void PrintFrameTime(const std::string& measurement,
+                    const std::string& modifier,
+                    const std::string& trace,
+                    int64_t elapsed_us,
+                    int num_frames) {
+  char ms_per_frame[16];
+  snprintf(ms_per_frame, sizeof(ms_per_frame), "%.4f",
+           elapsed_us / 1000.0 / num_frames);
+  test::PrintResult(measurement, modifier, trace, ms_per_frame, "ms", false);
+}
+
+}  // namespace webrtc
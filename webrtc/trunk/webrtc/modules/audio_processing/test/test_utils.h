@@ -0,0 +1,45 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_PROCESSING_TEST_TEST_UTILS_H_
+#define WEBRTC_MODULES_AUDIO_PROCESSING_TEST_TEST_UTILS_H_
+
+#include <string>
+
+#include "typedefs.h"
+
+// Helpers for the tests comparing the optimized versions of the AEC and NS
+// kernels against the generic C versions.
+namespace webrtc {
+
+// Uniformly distributed in [min, max), from rand().
+float RandomFloat(float min, float max);
+
+void FillRandom(float* data, int length, float min, float max);
+
+// Expects |actual| to match |expected| within |tolerance| times the largest
+// magnitude in |expected|.
+void ExpectNear(const float* expected, const float* actual, int length,
+                float tolerance);
+
+// Sample |n| of a speech-like signal: white noise, with a 440 Hz tone
+// switched on and off every 0.5 s.
+int16_t SpeechLikeSample(int n, int sample_rate_hz);
+
+// Prints the mean time to process a frame, in ms.
+void PrintFrameTime(const std::string& measurement,
+                    const std::string& modifier,
+                    const std::string& trace,
+                    int64_t elapsed_us,
+                    int num_frames);
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_PROCESSING_TEST_TEST_UTILS_H_
@@ -13,6 +13,7 @@
 #include <stdio.h>
 
 #include <algorithm>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -21,7 +22,9 @@
 #include "scoped_ptr.h"
 #include "signal_processing_library.h"
 #include "test/testsupport/fileutils.h"
+#include "test/testsupport/perf_test.h"
 #include "thread_wrapper.h"
+#include "tick_util.h"
 #include "trace.h"
 #ifdef WEBRTC_ANDROID_PLATFORM_BUILD
 #include "external/webrtc/webrtc/modules/audio_processing/test/unittest.pb.h"
@@ -41,6 +44,9 @@ using webrtc::NoiseSuppression;
 using webrtc::EchoCancellation;
 using webrtc::EventWrapper;
 using webrtc::scoped_array;
+using webrtc::scoped_ptr;
+using webrtc::ThreadWrapper;
+using webrtc::TickTime;
 using webrtc::Trace;
 using webrtc::LevelEstimator;
 using webrtc::EchoCancellation;
@@ -199,6 +205,33 @@ struct ThreadData {
   AudioProcessing* ap;
 };
 
+// Passes |frame| to AnalyzeReverseStream() each time |event| is set, so that
+// render processing overlaps with the capture processing on the test thread.
+struct RenderThreadData {
+  RenderThreadData(AudioProcessing* ap_, AudioFrame* frame_,
+                   EventWrapper* event_)
+      : ap(ap_),
+        frame(frame_),
+        event(event_),
+        errors(0) {}
+  AudioProcessing* ap;
+  AudioFrame* frame;
+  EventWrapper* event;
+  int errors;
+};
+
+bool RenderThreadProcess(void* obj) {
+  RenderThreadData* data = static_cast<RenderThreadData*>(obj);
+  if (data->event->Wait(100) != webrtc::kEventSignaled) {
+    return true;
+  }
+  if (data->ap->AnalyzeReverseStream(data->frame) !=
+      AudioProcessing::kNoError) {
+    ++data->errors;
+  }
+  return true;
+}
+
 class ApmTest : public ::testing::Test {
  protected:
   ApmTest();
@@ -1225,6 +1258,63 @@ TEST_F(ApmTest, DebugDump) {
 #endif  // WEBRTC_AUDIOPROC_DEBUG_DUMP
 }
 
+// Runs render and capture processing on separate threads and reports the
+// distribution of ProcessStream() times, to catch the capture thread waiting on
+// the render thread.
+TEST_F(ApmTest, CaptureLatencyWithConcurrentRender) {
+  const int kNumFrames = 1000;
+  EnableAllComponents();
+  Init(32000, 2, 2, 2, false);
+  ASSERT_TRUE(ReadFrame(far_file_, revframe_));
+
+  scoped_ptr<EventWrapper> render_event(EventWrapper::Create());
+  RenderThreadData render_data(apm_, revframe_, render_event.get());
+  scoped_ptr<ThreadWrapper> render_thread(ThreadWrapper::CreateThread(
+      RenderThreadProcess, &render_data, webrtc::kRealtimePriority,
+      "ApmTestRender"));
+  unsigned int thread_id = 0;
+  ASSERT_TRUE(render_thread->Start(thread_id));
+
+  std::vector<int64_t> process_times_us;
+  process_times_us.reserve(kNumFrames);
+  for (int i = 0; i < kNumFrames; ++i) {
+    if (!ReadFrame(near_file_, frame_)) {
+      rewind(near_file_);
+      ASSERT_TRUE(ReadFrame(near_file_, frame_));
+    }
+    EXPECT_EQ(apm_->kNoError, apm_->set_stream_delay_ms(0));
+    EXPECT_EQ(apm_->kNoError,
+        apm_->echo_cancellation()->set_stream_drift_samples(0));
+    EXPECT_EQ(apm_->kNoError,
+        apm_->gain_control()->set_stream_analog_level(127));
+
+    render_event->Set();
+    const int64_t start_us = TickTime::MicrosecondTimestamp();
+    EXPECT_EQ(apm_->kNoError, apm_->ProcessStream(frame_));
+    process_times_us.push_back(TickTime::MicrosecondTimestamp() - start_us);
+  }
+
+  render_thread->SetNotAlive();
+  render_event->Set();
+  EXPECT_TRUE(render_thread->Stop());
+  EXPECT_EQ(0, render_data.errors);
+
+  std::sort(process_times_us.begin(), process_times_us.end());
+  int64_t total_us = 0;
+  for (size_t i = 0; i < process_times_us.size(); ++i) {
+    total_us += process_times_us[i];
+  }
+  webrtc::test::PrintResult("apm_capture_time", "", "mean",
+                            total_us / kNumFrames, "us", false);
+  webrtc::test::PrintResult("apm_capture_time", "", "median",
+                            process_times_us[kNumFrames / 2], "us", false);
+  webrtc::test::PrintResult("apm_capture_time", "", "99th_percentile",
+                            process_times_us[kNumFrames * 99 / 100], "us",
+                            false);
+  webrtc::test::PrintResult("apm_capture_time", "", "max",
+                            process_times_us.back(), "us", false);
+}
+
 // TODO(andrew): Add a test to process a few frames with different combinations
 // of enabled components.
 
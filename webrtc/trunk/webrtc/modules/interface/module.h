@@ -17,6 +17,8 @@
 
 namespace webrtc {
 
+class ProcessThread;
+
 class Module {
  public:
   // TODO(henrika): Remove this when chrome is updated.
@@ -30,6 +32,11 @@ class Module {
   // Process any pending tasks such as timeouts.
   virtual int32_t Process() = 0;
 
+  // Called with the ProcessThread the module has been registered with, and
+  // with NULL when it is deregistered. A module whose next process time can
+  // move earlier than it last reported calls |process_thread|->WakeUp(this).
+  virtual void ProcessThreadAttached(ProcessThread* process_thread) {}
+
  protected:
   virtual ~Module() {}
 };
@@ -11,8 +11,6 @@
 #ifndef WEBRTC_MODULES_PACED_SENDER_H_
 #define WEBRTC_MODULES_PACED_SENDER_H_
 
-#include <list>
-
 #include "webrtc/modules/interface/module.h"
 #include "webrtc/system_wrappers/interface/scoped_ptr.h"
 #include "webrtc/system_wrappers/interface/tick_util.h"
@@ -20,6 +18,7 @@
 
 namespace webrtc {
 class CriticalSectionWrapper;
+class PacedPacketQueue;
 
 class PacedSender : public Module {
  public:
@@ -40,6 +39,20 @@ class PacedSender : public Module {
    protected:
     virtual ~Callback() {}
   };
+  struct QueueStatistics {
+    QueueStatistics()
+        : queue_size_packets(0),
+          queue_size_bytes(0),
+          current_queue_time_ms(0),
+          max_queue_time_ms(0) {
+    }
+    int queue_size_packets;
+    int queue_size_bytes;
+    // Time the oldest packet currently in the queue has been waiting.
+    int current_queue_time_ms;
+    // Longest time any packet has been waiting in the queue before being sent.
+    int max_queue_time_ms;
+  };
   PacedSender(Callback* callback, int target_bitrate_kbps);
 
   virtual ~PacedSender();
@@ -55,6 +68,10 @@ class PacedSender : public Module {
   bool SendPacket(Priority priority, uint32_t ssrc, uint16_t sequence_number,
                   int64_t capture_time_ms, int bytes);
 
+  // Returns statistics about the packets waiting in the normal and low
+  // priority queues.
+  void GetQueueStatistics(QueueStatistics* stats) const;
+
   // Returns the number of milliseconds until the module want a worker thread
   // to call Process.
   virtual int32_t TimeUntilNextProcess();
@@ -63,19 +80,6 @@ class PacedSender : public Module {
   virtual int32_t Process();
 
  private:
-  struct Packet {
-    Packet(uint32_t ssrc, uint16_t seq_number, int64_t capture_time_ms,
-           int length_in_bytes)
-        : ssrc_(ssrc),
-          sequence_number_(seq_number),
-          capture_time_ms_(capture_time_ms),
-          bytes_(length_in_bytes) {
-    }
-    uint32_t ssrc_;
-    uint16_t sequence_number_;
-    int64_t capture_time_ms_;
-    int bytes_;
-  };
   // Checks if next packet in line can be transmitted. Returns true on success.
   bool GetNextPacket(uint32_t* ssrc, uint16_t* sequence_number,
                      int64_t* capture_time_ms);
@@ -83,6 +87,11 @@ class PacedSender : public Module {
   // Updates the number of bytes that can be sent for the next time interval.
   void UpdateBytesPerInterval(uint32_t delta_time_in_ms);
 
+  // Removes the next packet from |queue|, accounts for it and writes its
+  // identifiers to the output parameters.
+  void PopPacket(PacedPacketQueue* queue, uint32_t* ssrc,
+                 uint16_t* sequence_number, int64_t* capture_time_ms);
+
   // Updates the buffers with the number of bytes that we sent.
   void UpdateState(int num_bytes);
 
@@ -95,8 +104,10 @@ class PacedSender : public Module {
   TickTime time_last_update_;
   TickTime time_last_send_;
 
-  std::list<Packet> normal_priority_packets_;
-  std::list<Packet> low_priority_packets_;
+  int max_queue_time_ms_;
+
+  scoped_ptr<PacedPacketQueue> normal_priority_packets_;
+  scoped_ptr<PacedPacketQueue> low_priority_packets_;
 };
 }  // namespace webrtc
 #endif  // WEBRTC_MODULES_PACED_SENDER_H_
@@ -0,0 +1,132 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/pacing/paced_packet_queue.h"
+
+#include <assert.h>
+
+namespace {
+// Initial number of packets each per-SSRC ring buffer can hold. A 1 Mbit/s
+// key frame is roughly 100 packets; the buffer doubles if that is exceeded.
+const int kInitialStreamCapacity = 128;
+}  // namespace
+
+namespace webrtc {
+
+PacedPacketQueue::Stream::Stream(uint32_t ssrc)
+    : ssrc_(ssrc),
+      packets_(new Packet[kInitialStreamCapacity]),
+      capacity_(kInitialStreamCapacity),
+      head_(0),
+      size_(0) {
+}
+
+PacedPacketQueue::Stream::~Stream() {
+  delete [] packets_;
+}
+
+void PacedPacketQueue::Stream::Push(const Packet& packet) {
+  if (size_ == capacity_) {
+    Grow();
+  }
+  packets_[(head_ + size_) & (capacity_ - 1)] = packet;
+  ++size_;
+}
+
+void PacedPacketQueue::Stream::Pop(Packet* packet) {
+  assert(size_ > 0);
+  *packet = packets_[head_];
+  head_ = (head_ + 1) & (capacity_ - 1);
+  --size_;
+}
+
+void PacedPacketQueue::Stream::Grow() {
+  Packet* packets = new Packet[2 * capacity_];
+  for (int i = 0; i < size_; ++i) {
+    packets[i] = packets_[(head_ + i) & (capacity_ - 1)];
+  }
+  delete [] packets_;
+  packets_ = packets;
+  capacity_ *= 2;
+  head_ = 0;
+}
+
+PacedPacketQueue::PacedPacketQueue()
+    : next_stream_(0),
+      num_packets_(0),
+      num_bytes_(0) {
+}
+
+PacedPacketQueue::~PacedPacketQueue() {
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    delete streams_[i];
+  }
+}
+
+void PacedPacketQueue::Push(const Packet& packet) {
+  FindOrCreateStream(packet.ssrc_)->Push(packet);
+  ++num_packets_;
+  num_bytes_ += packet.bytes_;
+}
+
+bool PacedPacketQueue::Pop(Packet* packet) {
+  if (num_packets_ == 0) {
+    return false;
+  }
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    size_t index = (next_stream_ + i) % streams_.size();
+    Stream* stream = streams_[index];
+    if (!stream->empty()) {
+      stream->Pop(packet);
+      next_stream_ = index + 1;
+      --num_packets_;
+      num_bytes_ -= packet->bytes_;
+      return true;
+    }
+  }
+  assert(false);
+  return false;
+}
+
+int64_t PacedPacketQueue::OldestEnqueueTimeMs() const {
+  int64_t oldest_ms = -1;
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    if (!streams_[i]->empty()) {
+      int64_t enqueue_time_ms = streams_[i]->front().enqueue_time_ms_;
+      if (oldest_ms == -1 || enqueue_time_ms < oldest_ms) {
+        oldest_ms = enqueue_time_ms;
+      }
+    }
+  }
+  return oldest_ms;
+}
+
+PacedPacketQueue::Stream* PacedPacketQueue::FindOrCreateStream(uint32_t ssrc) {
+  Stream* idle_stream = NULL;
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    if (streams_[i]->ssrc() == ssrc) {
+      return streams_[i];
+    }
+    if (idle_stream == NULL && streams_[i]->empty()) {
+      idle_stream = streams_[i];
+    }
+  }
+  // Reuse the ring buffer of a drained stream before allocating a new one, so
+  // the number of streams is bounded by the number of concurrently queued
+  // SSRCs.
+  if (idle_stream != NULL) {
+    idle_stream->set_ssrc(ssrc);
+    return idle_stream;
+  }
+  streams_.push_back(new Stream(ssrc));
+  return streams_.back();
+}
+
+}  // namespace webrtc
@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_PACING_PACED_PACKET_QUEUE_H_
+#define WEBRTC_MODULES_PACING_PACED_PACKET_QUEUE_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// Queue of packets waiting in the PacedSender for one priority level.
+// Packets are kept in one ring buffer per SSRC. The ring buffers are only
+// reallocated when they grow past their high-water mark, so pushing and
+// popping packets does not allocate in steady state. Packets are popped in
+// round-robin order over the SSRCs that have packets queued, so a burst on
+// one stream does not starve the others.
+class PacedPacketQueue {
+ public:
+  struct Packet {
+    Packet()
+        : ssrc_(0),
+          sequence_number_(0),
+          capture_time_ms_(0),
+          enqueue_time_ms_(0),
+          bytes_(0) {
+    }
+    Packet(uint32_t ssrc, uint16_t seq_number, int64_t capture_time_ms,
+           int64_t enqueue_time_ms, int length_in_bytes)
+        : ssrc_(ssrc),
+          sequence_number_(seq_number),
+          capture_time_ms_(capture_time_ms),
+          enqueue_time_ms_(enqueue_time_ms),
+          bytes_(length_in_bytes) {
+    }
+    uint32_t ssrc_;
+    uint16_t sequence_number_;
+    int64_t capture_time_ms_;
+    int64_t enqueue_time_ms_;
+    int bytes_;
+  };
+
+  PacedPacketQueue();
+  ~PacedPacketQueue();
+
+  void Push(const Packet& packet);
+
+  // Removes the next packet in round-robin order and writes it to |packet|.
+  // Returns false if the queue is empty.
+  bool Pop(Packet* packet);
+
+  bool empty() const { return num_packets_ == 0; }
+  int num_packets() const { return num_packets_; }
+  int num_bytes() const { return num_bytes_; }
+
+  // Returns the enqueue time of the oldest packet in the queue, or -1 if the
+  // queue is empty.
+  int64_t OldestEnqueueTimeMs() const;
+
+ private:
+  // Ring buffer holding the queued packets of one SSRC. The capacity is
+  // always a power of two.
+  class Stream {
+   public:
+    explicit Stream(uint32_t ssrc);
+    ~Stream();
+
+    void Push(const Packet& packet);
+    void Pop(Packet* packet);
+    const Packet& front() const { return packets_[head_]; }
+    bool empty() const { return size_ == 0; }
+    uint32_t ssrc() const { return ssrc_; }
+    void set_ssrc(uint32_t ssrc) { ssrc_ = ssrc; }
+
+   private:
+    void Grow();
+
+    uint32_t ssrc_;
+    Packet* packets_;
+    int capacity_;
+    int head_;
+    int size_;
+  };
+
+  Stream* FindOrCreateStream(uint32_t ssrc);
+
+  std::vector<Stream*> streams_;
+  // Index of the stream to be served first by the next call to Pop().
+  size_t next_stream_;
+  int num_packets_;
+  int num_bytes_;
+};
+}  // namespace webrtc
+#endif  // WEBRTC_MODULES_PACING_PACED_PACKET_QUEUE_H_
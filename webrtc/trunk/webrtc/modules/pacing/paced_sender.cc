@@ -12,6 +12,9 @@
 
 #include <assert.h>
 
+#include <algorithm>
+
+#include "webrtc/modules/pacing/paced_packet_queue.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 
 namespace {
@@ -43,13 +46,14 @@ PacedSender::PacedSender(Callback* callback, int target_bitrate_kbps)
       target_bitrate_kbytes_per_s_(target_bitrate_kbps >> 3),  // Divide by 8.
       bytes_remaining_interval_(0),
       padding_bytes_remaining_interval_(0),
-      time_last_update_(TickTime::Now()) {
+      time_last_update_(TickTime::Now()),
+      max_queue_time_ms_(0),
+      normal_priority_packets_(new PacedPacketQueue()),
+      low_priority_packets_(new PacedPacketQueue()) {
   UpdateBytesPerInterval(kMinPacketLimitMs);
 }
 
 PacedSender::~PacedSender() {
-  normal_priority_packets_.clear();
-  low_priority_packets_.clear();
 }
 
 void PacedSender::SetStatus(bool enable) {
@@ -75,27 +79,48 @@ bool PacedSender::SendPacket(Priority priority, uint32_t ssrc,
       UpdateState(bytes);
       return true;  // We can send now.
     case kNormalPriority:
-      if (normal_priority_packets_.empty() && bytes_remaining_interval_ > 0) {
+      if (normal_priority_packets_->empty() && bytes_remaining_interval_ > 0) {
         UpdateState(bytes);
         return true;  // We can send now.
       }
-      normal_priority_packets_.push_back(
-          Packet(ssrc, sequence_number, capture_time_ms, bytes));
+      normal_priority_packets_->Push(PacedPacketQueue::Packet(
+          ssrc, sequence_number, capture_time_ms,
+          TickTime::MillisecondTimestamp(), bytes));
       return false;
     case kLowPriority:
-      if (normal_priority_packets_.empty() &&
-          low_priority_packets_.empty() &&
+      if (normal_priority_packets_->empty() &&
+          low_priority_packets_->empty() &&
           bytes_remaining_interval_ > 0) {
         UpdateState(bytes);
         return true;  // We can send now.
       }
-      low_priority_packets_.push_back(
-          Packet(ssrc, sequence_number, capture_time_ms, bytes));
+      low_priority_packets_->Push(PacedPacketQueue::Packet(
+          ssrc, sequence_number, capture_time_ms,
+          TickTime::MillisecondTimestamp(), bytes));
       return false;
   }
   return false;
 }
 
+void PacedSender::GetQueueStatistics(QueueStatistics* stats) const {
+  assert(stats);
+  CriticalSectionScoped cs(critsect_.get());
+  stats->queue_size_packets = normal_priority_packets_->num_packets() +
+      low_priority_packets_->num_packets();
+  stats->queue_size_bytes = normal_priority_packets_->num_bytes() +
+      low_priority_packets_->num_bytes();
+  int64_t oldest_ms = normal_priority_packets_->OldestEnqueueTimeMs();
+  int64_t oldest_low_priority_ms =
+      low_priority_packets_->OldestEnqueueTimeMs();
+  if (oldest_ms == -1 ||
+      (oldest_low_priority_ms != -1 && oldest_low_priority_ms < oldest_ms)) {
+    oldest_ms = oldest_low_priority_ms;
+  }
+  stats->current_queue_time_ms = (oldest_ms == -1) ? 0 :
+      static_cast<int>(TickTime::MillisecondTimestamp() - oldest_ms);
+  stats->max_queue_time_ms = max_queue_time_ms_;
+}
+
 int32_t PacedSender::TimeUntilNextProcess() {
   CriticalSectionScoped cs(critsect_.get());
   int64_t elapsed_time_ms =
@@ -125,8 +150,8 @@ int32_t PacedSender::Process() {
       callback_->TimeToSendPacket(ssrc, sequence_number, capture_time_ms);
       critsect_->Enter();
     }
-    if (normal_priority_packets_.empty() &&
-        low_priority_packets_.empty() &&
+    if (normal_priority_packets_->empty() &&
+        low_priority_packets_->empty() &&
         padding_bytes_remaining_interval_ > 0) {
       critsect_->Leave();
       callback_->TimeToSendPadding(padding_bytes_remaining_interval_);
@@ -164,41 +189,44 @@ bool PacedSender::GetNextPacket(uint32_t* ssrc, uint16_t* sequence_number,
   if (bytes_remaining_interval_ <= 0) {
     // All bytes consumed for this interval.
     // Check if we have not sent in a too long time.
-    if (!normal_priority_packets_.empty()) {
+    if (!normal_priority_packets_->empty()) {
       if ((TickTime::Now() - time_last_send_).Milliseconds() >
           kMaxQueueTimeWithoutSendingMs) {
-        Packet packet = normal_priority_packets_.front();
-        UpdateState(packet.bytes_);
-        *sequence_number = packet.sequence_number_;
-        *ssrc = packet.ssrc_;
-        *capture_time_ms = packet.capture_time_ms_;
-        normal_priority_packets_.pop_front();
+        PopPacket(normal_priority_packets_.get(), ssrc, sequence_number,
+                  capture_time_ms);
         return true;
       }
     }
     return false;
   }
-  if (!normal_priority_packets_.empty()) {
-    Packet packet = normal_priority_packets_.front();
-    UpdateState(packet.bytes_);
-    *sequence_number = packet.sequence_number_;
-    *ssrc = packet.ssrc_;
-    *capture_time_ms = packet.capture_time_ms_;
-    normal_priority_packets_.pop_front();
+  if (!normal_priority_packets_->empty()) {
+    PopPacket(normal_priority_packets_.get(), ssrc, sequence_number,
+              capture_time_ms);
     return true;
   }
-  if (!low_priority_packets_.empty()) {
-    Packet packet = low_priority_packets_.front();
-    UpdateState(packet.bytes_);
-    *sequence_number = packet.sequence_number_;
-    *ssrc = packet.ssrc_;
-    *capture_time_ms = packet.capture_time_ms_;
-    low_priority_packets_.pop_front();
+  if (!low_priority_packets_->empty()) {
+    PopPacket(low_priority_packets_.get(), ssrc, sequence_number,
+              capture_time_ms);
     return true;
   }
   return false;
 }
 
+// MUST have critsect_ when calling.
+void PacedSender::PopPacket(PacedPacketQueue* queue, uint32_t* ssrc,
+                            uint16_t* sequence_number,
+                            int64_t* capture_time_ms) {
+  PacedPacketQueue::Packet packet;
+  queue->Pop(&packet);
+  UpdateState(packet.bytes_);
+  int queue_time_ms = static_cast<int>(
+      TickTime::MillisecondTimestamp() - packet.enqueue_time_ms_);
+  max_queue_time_ms_ = std::max(max_queue_time_ms_, queue_time_ms);
+  *sequence_number = packet.sequence_number_;
+  *ssrc = packet.ssrc_;
+  *capture_time_ms = packet.capture_time_ms_;
+}
+
 // MUST have critsect_ when calling.
 void PacedSender::UpdateState(int num_bytes) {
   time_last_send_ = TickTime::Now();
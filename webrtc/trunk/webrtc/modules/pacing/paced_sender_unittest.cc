@@ -11,6 +11,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+
 #include "webrtc/modules/pacing/include/paced_sender.h"
 
 namespace {
@@ -27,6 +29,40 @@ class MockPacedSenderCallback : public PacedSender::Callback {
       void(int bytes));
 };
 
+// Callback that sends nothing but records how long audio packets waited in
+// the pacer, using the capture time as the time the packet was queued.
+class DelayMeasuringCallback : public PacedSender::Callback {
+ public:
+  explicit DelayMeasuringCallback(uint32_t audio_ssrc)
+      : audio_ssrc_(audio_ssrc),
+        audio_packets_(0),
+        video_packets_(0),
+        max_audio_delay_ms_(0) {
+  }
+  virtual void TimeToSendPacket(uint32_t ssrc, uint16_t sequence_number,
+                                int64_t capture_time_ms) {
+    if (ssrc == audio_ssrc_) {
+      ++audio_packets_;
+      int delay_ms = static_cast<int>(
+          TickTime::MillisecondTimestamp() - capture_time_ms);
+      max_audio_delay_ms_ = std::max(max_audio_delay_ms_, delay_ms);
+    } else {
+      ++video_packets_;
+    }
+  }
+  virtual void TimeToSendPadding(int bytes) {}
+
+  int audio_packets() const { return audio_packets_; }
+  int video_packets() const { return video_packets_; }
+  int max_audio_delay_ms() const { return max_audio_delay_ms_; }
+
+ private:
+  uint32_t audio_ssrc_;
+  int audio_packets_;
+  int video_packets_;
+  int max_audio_delay_ms_;
+};
+
 class PacedSenderTest : public ::testing::Test {
  protected:
   PacedSenderTest() {
@@ -181,4 +217,132 @@ TEST_F(PacedSenderTest, Priority) {
   EXPECT_EQ(0, send_bucket_->Process());
 }
 
+TEST_F(PacedSenderTest, RoundRobinBetweenSsrcs) {
+  uint32_t ssrc_1 = 12345;
+  uint32_t ssrc_2 = 12346;
+  uint16_t sequence_number = 1234;
+  int64_t capture_time_ms = 56789;
+
+  // Use up the budget of the first interval.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(send_bucket_->SendPacket(PacedSender::kNormalPriority, ssrc_1,
+        sequence_number++, capture_time_ms, 250));
+  }
+  // Queue a burst on the first SSRC followed by a single packet on the second.
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority, ssrc_1,
+        sequence_number++, capture_time_ms, 250));
+  }
+  EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority, ssrc_2,
+      sequence_number++, capture_time_ms, 250));
+
+  // The second SSRC gets its turn right after the first packet of the burst.
+  EXPECT_CALL(callback_, TimeToSendPadding(testing::_)).Times(0);
+  {
+    testing::InSequence sequence;
+    EXPECT_CALL(callback_,
+        TimeToSendPacket(ssrc_1, testing::_, capture_time_ms)).Times(1);
+    EXPECT_CALL(callback_,
+        TimeToSendPacket(ssrc_2, testing::_, capture_time_ms)).Times(1);
+    EXPECT_CALL(callback_,
+        TimeToSendPacket(ssrc_1, testing::_, capture_time_ms)).Times(1);
+  }
+  TickTime::AdvanceFakeClock(5);
+  EXPECT_EQ(0, send_bucket_->Process());
+}
+
+TEST_F(PacedSenderTest, QueueStatistics) {
+  uint32_t ssrc = 12345;
+  uint16_t sequence_number = 1234;
+  int64_t capture_time_ms = 56789;
+
+  PacedSender::QueueStatistics stats;
+  send_bucket_->GetQueueStatistics(&stats);
+  EXPECT_EQ(0, stats.queue_size_packets);
+  EXPECT_EQ(0, stats.queue_size_bytes);
+  EXPECT_EQ(0, stats.current_queue_time_ms);
+  EXPECT_EQ(0, stats.max_queue_time_ms);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(send_bucket_->SendPacket(PacedSender::kNormalPriority, ssrc,
+        sequence_number++, capture_time_ms, 250));
+  }
+  EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority, ssrc,
+      sequence_number++, capture_time_ms, 250));
+  EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kLowPriority, ssrc,
+      sequence_number++, capture_time_ms, 100));
+  TickTime::AdvanceFakeClock(4);
+  send_bucket_->GetQueueStatistics(&stats);
+  EXPECT_EQ(2, stats.queue_size_packets);
+  EXPECT_EQ(350, stats.queue_size_bytes);
+  EXPECT_EQ(4, stats.current_queue_time_ms);
+  EXPECT_EQ(0, stats.max_queue_time_ms);
+
+  EXPECT_CALL(callback_, TimeToSendPadding(testing::_)).Times(0);
+  EXPECT_CALL(callback_,
+      TimeToSendPacket(ssrc, testing::_, capture_time_ms)).Times(2);
+  TickTime::AdvanceFakeClock(1);
+  EXPECT_EQ(0, send_bucket_->Process());
+  send_bucket_->GetQueueStatistics(&stats);
+  EXPECT_EQ(0, stats.queue_size_packets);
+  EXPECT_EQ(0, stats.queue_size_bytes);
+  EXPECT_EQ(0, stats.current_queue_time_ms);
+  EXPECT_EQ(5, stats.max_queue_time_ms);
+}
+
+TEST(PacedSenderKeyFrameTest, AudioDelayDuringKeyFrameBurst) {
+  const uint32_t kAudioSsrc = 1111;
+  const uint32_t kVideoSsrc = 2222;
+  const int kKeyFramePackets = 100;
+  const int kVideoPacketBytes = 1000;
+  const int kAudioPacketBytes = 100;
+  const int kAudioFrameMs = 20;
+  TickTime::UseFakeClock(123456);
+  DelayMeasuringCallback callback(kAudioSsrc);
+  PacedSender send_bucket(&callback, kTargetBitrate);
+  send_bucket.SetStatus(true);
+
+  // A key frame much larger than what can be sent in one interval arrives
+  // at once, and audio keeps being produced while it drains.
+  uint16_t video_sequence_number = 0;
+  int video_sent_directly = 0;
+  for (int i = 0; i < kKeyFramePackets; ++i) {
+    if (send_bucket.SendPacket(PacedSender::kNormalPriority, kVideoSsrc,
+                               video_sequence_number++,
+                               TickTime::MillisecondTimestamp(),
+                               kVideoPacketBytes)) {
+      ++video_sent_directly;
+    }
+  }
+  PacedSender::QueueStatistics stats;
+  send_bucket.GetQueueStatistics(&stats);
+  EXPECT_EQ(kKeyFramePackets - video_sent_directly, stats.queue_size_packets);
+
+  uint16_t audio_sequence_number = 0;
+  int audio_sent_directly = 0;
+  int elapsed_ms = 0;
+  while (stats.queue_size_packets > 0) {
+    if (elapsed_ms % kAudioFrameMs == 0) {
+      if (send_bucket.SendPacket(PacedSender::kNormalPriority, kAudioSsrc,
+                                 audio_sequence_number++,
+                                 TickTime::MillisecondTimestamp(),
+                                 kAudioPacketBytes)) {
+        ++audio_sent_directly;
+      }
+    }
+    TickTime::AdvanceFakeClock(5);
+    elapsed_ms += 5;
+    EXPECT_EQ(0, send_bucket.Process());
+    send_bucket.GetQueueStatistics(&stats);
+  }
+  EXPECT_EQ(kKeyFramePackets, video_sent_directly + callback.video_packets());
+  EXPECT_EQ(audio_sequence_number,
+            audio_sent_directly + callback.audio_packets());
+  EXPECT_GT(callback.audio_packets(), 0);
+  // Draining the key frame takes far longer than an audio frame, but audio
+  // must only wait for about one video packet.
+  EXPECT_GT(stats.max_queue_time_ms, 10 * kAudioFrameMs);
+  EXPECT_LE(callback.max_audio_delay_ms(), kAudioFrameMs);
+}
+
 }  // namespace webrtc
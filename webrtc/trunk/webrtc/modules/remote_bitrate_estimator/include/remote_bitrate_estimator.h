@@ -44,6 +44,14 @@ class RemoteBitrateEstimator : public StatsObserver, public Module {
     kSingleStreamEstimation
   };
 
+  // An incoming packet, as given to IncomingPacket().
+  struct Packet {
+    unsigned int ssrc;
+    int payload_size;
+    int64_t arrival_time;
+    uint32_t rtp_timestamp;
+  };
+
   virtual ~RemoteBitrateEstimator() {}
 
   static RemoteBitrateEstimator* Create(const OverUseDetectorOptions& options,
@@ -66,6 +74,10 @@ class RemoteBitrateEstimator : public StatsObserver, public Module {
                               int64_t arrival_time,
                               uint32_t rtp_timestamp) = 0;
 
+  // Same as calling IncomingPacket() for each of the |num_packets| packets in
+  // |packets|, in order, but takes the lock of the estimator only once.
+  virtual void IncomingPackets(const Packet* packets, int num_packets) = 0;
+
   // Removes all data for |ssrc|.
   virtual void RemoveStream(unsigned int ssrc) = 0;
 
@@ -24,7 +24,6 @@ extern MatlabEngine eng;  // global variable defined elsewhere
 #endif
 
 enum { kOverUsingTimeThreshold = 100 };
-enum { kMinFramePeriodHistoryLength = 60 };
 
 namespace webrtc {
 OveruseDetector::OveruseDetector(const OverUseDetectorOptions& options)
@@ -39,7 +38,9 @@ OveruseDetector::OveruseDetector(const OverUseDetectorOptions& options)
       avg_noise_(options_.initial_avg_noise),
       var_noise_(options_.initial_var_noise),
       threshold_(options_.initial_threshold),
-      ts_delta_hist_(),
+      ts_delta_window_start_(0),
+      ts_delta_window_size_(0),
+      num_ts_deltas_(0),
       prev_offset_(0.0),
       time_over_using_(-1),
       over_use_counter_(0),
@@ -73,8 +74,6 @@ OveruseDetector::~OveruseDetector() {
     plots_.plot4_ = NULL;
   }
 #endif
-
-  ts_delta_hist_.clear();
 }
 
 void OveruseDetector::Update(uint16_t packet_size,
@@ -314,18 +313,35 @@ void OveruseDetector::UpdateKalman(int64_t t_delta,
 #endif
 }
 
+// Returns the minimum of the last |kMinFramePeriodHistoryLength| frame
+// periods, including |ts_delta|. Each sample is added and removed at most
+// once, rather than searching the whole history for every frame.
 double OveruseDetector::UpdateMinFramePeriod(double ts_delta) {
-  double min_frame_period = ts_delta;
-  if (ts_delta_hist_.size() >= kMinFramePeriodHistoryLength) {
-    std::list<double>::iterator first_item = ts_delta_hist_.begin();
-    ts_delta_hist_.erase(first_item);
+  // Drop the oldest sample if it has left the window.
+  if (ts_delta_window_size_ > 0 &&
+      num_ts_deltas_ - ts_delta_window_[ts_delta_window_start_].index >=
+          kMinFramePeriodHistoryLength) {
+    ts_delta_window_start_ =
+        (ts_delta_window_start_ + 1) % kMinFramePeriodHistoryLength;
+    --ts_delta_window_size_;
   }
-  std::list<double>::iterator it = ts_delta_hist_.begin();
-  for (; it != ts_delta_hist_.end(); it++) {
-    min_frame_period = BWE_MIN(*it, min_frame_period);
+  // Samples larger than |ts_delta| can't be the minimum of any later window.
+  while (ts_delta_window_size_ > 0) {
+    const int last = (ts_delta_window_start_ + ts_delta_window_size_ - 1) %
+        kMinFramePeriodHistoryLength;
+    if (ts_delta_window_[last].ts_delta < ts_delta) {
+      break;
+    }
+    --ts_delta_window_size_;
   }
-  ts_delta_hist_.push_back(ts_delta);
-  return min_frame_period;
+  TsDeltaSample* sample = &ts_delta_window_[
+      (ts_delta_window_start_ + ts_delta_window_size_) %
+      kMinFramePeriodHistoryLength];
+  sample->ts_delta = ts_delta;
+  sample->index = num_ts_deltas_;
+  ++ts_delta_window_size_;
+  ++num_ts_deltas_;
+  return ts_delta_window_[ts_delta_window_start_].ts_delta;
 }
 
 void OveruseDetector::UpdateNoiseEstimate(double residual,
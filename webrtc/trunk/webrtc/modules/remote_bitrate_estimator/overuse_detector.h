@@ -10,8 +10,6 @@
 #ifndef WEBRTC_MODULES_RTP_RTCP_SOURCE_OVERUSE_DETECTOR_H_
 #define WEBRTC_MODULES_RTP_RTCP_SOURCE_OVERUSE_DETECTOR_H_
 
-#include <list>
-
 #include "modules/interface/module_common_types.h"
 #include "modules/remote_bitrate_estimator/include/bwe_defines.h"
 #include "typedefs.h"  // NOLINT(build/include)
@@ -39,6 +37,8 @@ class OveruseDetector {
   int64_t time_of_last_received_packet() const;
 
  private:
+  enum { kMinFramePeriodHistoryLength = 60 };
+
   struct FrameSample {
     FrameSample()
         : size(0),
@@ -52,6 +52,13 @@ class OveruseDetector {
     int64_t timestamp_ms;
   };
 
+  // A frame period in the sliding window of UpdateMinFramePeriod().
+  struct TsDeltaSample {
+    double ts_delta;
+    // The sequence number of the sample, counted from the first delta.
+    uint32_t index;
+  };
+
   struct DebugPlots {
 #ifdef WEBRTC_BWE_MATLAB
     DebugPlots() : plot1(NULL), plot2(NULL), plot3(NULL), plot4(NULL) {}
@@ -98,7 +105,13 @@ class OveruseDetector {
   double avg_noise_;
   double var_noise_;
   double threshold_;
-  std::list<double> ts_delta_hist_;
+  // The samples of the last |kMinFramePeriodHistoryLength| frame periods
+  // which are smaller than all samples after them, oldest first, in a ring
+  // buffer starting at |ts_delta_window_start_|. The first is the minimum.
+  TsDeltaSample ts_delta_window_[kMinFramePeriodHistoryLength];
+  int ts_delta_window_start_;
+  int ts_delta_window_size_;
+  uint32_t num_ts_deltas_;
   double prev_offset_;
   double time_over_using_;
   uint16_t over_use_counter_;
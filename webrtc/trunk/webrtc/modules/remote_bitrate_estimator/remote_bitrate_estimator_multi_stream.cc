@@ -87,8 +87,24 @@ void RemoteBitrateEstimatorMultiStream::IncomingPacket(unsigned int ssrc,
                                                        int payload_size,
                                                        int64_t arrival_time,
                                                        uint32_t rtp_timestamp) {
+  const Packet packet = { ssrc, payload_size, arrival_time, rtp_timestamp };
   CriticalSectionScoped cs(crit_sect_.get());
-  incoming_bitrate_.Update(payload_size, arrival_time);
+  IncomingPacketLocked(packet);
+}
+
+void RemoteBitrateEstimatorMultiStream::IncomingPackets(const Packet* packets,
+                                                        int num_packets) {
+  CriticalSectionScoped cs(crit_sect_.get());
+  for (int i = 0; i < num_packets; ++i) {
+    IncomingPacketLocked(packets[i]);
+  }
+}
+
+void RemoteBitrateEstimatorMultiStream::IncomingPacketLocked(
+    const Packet& packet) {
+  const unsigned int ssrc = packet.ssrc;
+  const int64_t arrival_time = packet.arrival_time;
+  incoming_bitrate_.Update(packet.payload_size, arrival_time);
   // Add this stream to the map of streams if it doesn't already exist.
   std::pair<StreamMap::iterator, bool> stream_insert_result =
       streams_.insert(std::make_pair(ssrc, synchronization::RtcpList()));
@@ -109,10 +125,11 @@ void RemoteBitrateEstimatorMultiStream::IncomingPacket(unsigned int ssrc,
   const BandwidthUsage prior_state = overuse_detector_.State();
   int64_t timestamp_in_ms = -1;
   if (multi_stream_) {
-    synchronization::RtpToNtpMs(rtp_timestamp, *rtcp_list, &timestamp_in_ms);
+    synchronization::RtpToNtpMs(packet.rtp_timestamp, *rtcp_list,
+                                &timestamp_in_ms);
   }
-  overuse_detector_.Update(payload_size, timestamp_in_ms, rtp_timestamp,
-                           arrival_time);
+  overuse_detector_.Update(packet.payload_size, timestamp_in_ms,
+                           packet.rtp_timestamp, arrival_time);
   if (overuse_detector_.State() == kBwOverusing) {
     unsigned int incoming_bitrate = incoming_bitrate_.BitRate(arrival_time);
     if (prior_state != kBwOverusing ||
@@ -54,6 +54,8 @@ class RemoteBitrateEstimatorMultiStream : public RemoteBitrateEstimator {
                       int64_t arrival_time,
                       uint32_t rtp_timestamp);
 
+  void IncomingPackets(const Packet* packets, int num_packets);
+
   // Triggers a new estimate calculation.
   // Implements the Module interface.
   virtual int32_t Process();
@@ -74,6 +76,9 @@ class RemoteBitrateEstimatorMultiStream : public RemoteBitrateEstimator {
  private:
   typedef std::map<unsigned int, synchronization::RtcpList> StreamMap;
 
+  // Must be called with |crit_sect_| held.
+  void IncomingPacketLocked(const Packet& packet);
+
   // Triggers a new estimate calculation.
   void UpdateEstimate(int64_t time_now);
 
@@ -10,6 +10,8 @@
 
 #include "webrtc/modules/remote_bitrate_estimator/remote_bitrate_estimator_single_stream.h"
 
+#include <algorithm>
+
 #include "webrtc/system_wrappers/interface/clock.h"
 
 namespace webrtc {
@@ -31,36 +33,58 @@ void RemoteBitrateEstimatorSingleStream::IncomingPacket(
     int payload_size,
     int64_t arrival_time,
     uint32_t rtp_timestamp) {
+  const Packet packet = { ssrc, payload_size, arrival_time, rtp_timestamp };
   CriticalSectionScoped cs(crit_sect_.get());
-  SsrcOveruseDetectorMap::iterator it = overuse_detectors_.find(ssrc);
-  if (it == overuse_detectors_.end()) {
-    // This is a new SSRC. Adding to map.
-    // TODO(holmer): If the channel changes SSRC the old SSRC will still be
-    // around in this map until the channel is deleted. This is OK since the
-    // callback will no longer be called for the old SSRC. This will be
-    // automatically cleaned up when we have one RemoteBitrateEstimator per REMB
-    // group.
-    std::pair<SsrcOveruseDetectorMap::iterator, bool> insert_result =
-        overuse_detectors_.insert(std::make_pair(ssrc, OveruseDetector(
-            options_)));
-    it = insert_result.first;
+  IncomingPacketLocked(packet);
+}
+
+void RemoteBitrateEstimatorSingleStream::IncomingPackets(const Packet* packets,
+                                                         int num_packets) {
+  CriticalSectionScoped cs(crit_sect_.get());
+  for (int i = 0; i < num_packets; ++i) {
+    IncomingPacketLocked(packets[i]);
   }
-  OveruseDetector* overuse_detector = &it->second;
-  incoming_bitrate_.Update(payload_size, arrival_time);
+}
+
+void RemoteBitrateEstimatorSingleStream::IncomingPacketLocked(
+    const Packet& packet) {
+  OveruseDetector* overuse_detector =
+      &overuse_detectors_[FindOrAddStream(packet.ssrc)];
+  incoming_bitrate_.Update(packet.payload_size, packet.arrival_time);
   const BandwidthUsage prior_state = overuse_detector->State();
-  overuse_detector->Update(payload_size, -1, rtp_timestamp, arrival_time);
+  overuse_detector->Update(packet.payload_size, -1, packet.rtp_timestamp,
+                           packet.arrival_time);
   if (overuse_detector->State() == kBwOverusing) {
-    unsigned int incoming_bitrate = incoming_bitrate_.BitRate(arrival_time);
+    unsigned int incoming_bitrate =
+        incoming_bitrate_.BitRate(packet.arrival_time);
     if (prior_state != kBwOverusing ||
-        remote_rate_.TimeToReduceFurther(arrival_time, incoming_bitrate)) {
+        remote_rate_.TimeToReduceFurther(packet.arrival_time,
+                                         incoming_bitrate)) {
       // The first overuse should immediately trigger a new estimate.
       // We also have to update the estimate immediately if we are overusing
       // and the target bitrate is too high compared to what we are receiving.
-      UpdateEstimate(arrival_time);
+      UpdateEstimate(packet.arrival_time);
     }
   }
 }
 
+size_t RemoteBitrateEstimatorSingleStream::FindOrAddStream(unsigned int ssrc) {
+  std::vector<unsigned int>::iterator it =
+      std::lower_bound(ssrcs_.begin(), ssrcs_.end(), ssrc);
+  const size_t index = it - ssrcs_.begin();
+  if (it == ssrcs_.end() || *it != ssrc) {
+    // This is a new SSRC.
+    // TODO(holmer): If the channel changes SSRC the old SSRC will still be
+    // around until the channel is deleted. This is OK since the callback will
+    // no longer be called for the old SSRC. This will be automatically cleaned
+    // up when we have one RemoteBitrateEstimator per REMB group.
+    ssrcs_.insert(it, ssrc);
+    overuse_detectors_.insert(overuse_detectors_.begin() + index,
+                              OveruseDetector(options_));
+  }
+  return index;
+}
+
 int32_t RemoteBitrateEstimatorSingleStream::Process() {
   if (TimeUntilNextProcess() > 0) {
     return 0;
@@ -81,24 +105,33 @@ void RemoteBitrateEstimatorSingleStream::UpdateEstimate(int64_t time_now) {
   CriticalSectionScoped cs(crit_sect_.get());
   BandwidthUsage bw_state = kBwNormal;
   double sum_noise_var = 0.0;
-  SsrcOveruseDetectorMap::iterator it = overuse_detectors_.begin();
-  while (it != overuse_detectors_.end()) {
+  size_t num_streams = 0;
+  for (size_t i = 0; i < overuse_detectors_.size(); ++i) {
     const int64_t time_of_last_received_packet =
-         it->second.time_of_last_received_packet();
+         overuse_detectors_[i].time_of_last_received_packet();
     if (time_of_last_received_packet >= 0 &&
         time_now - time_of_last_received_packet > kStreamTimeOutMs) {
       // This over-use detector hasn't received packets for |kStreamTimeOutMs|
       // milliseconds and is considered stale.
-      overuse_detectors_.erase(it++);
-    } else {
-      sum_noise_var += it->second.NoiseVar();
-      // Make sure that we trigger an over-use if any of the over-use detectors
-      // is detecting over-use.
-      if (it->second.State() > bw_state) {
-        bw_state = it->second.State();
-      }
-      ++it;
+      continue;
+    }
+    sum_noise_var += overuse_detectors_[i].NoiseVar();
+    // Make sure that we trigger an over-use if any of the over-use detectors
+    // is detecting over-use.
+    if (overuse_detectors_[i].State() > bw_state) {
+      bw_state = overuse_detectors_[i].State();
     }
+    // Move the active streams together, in order.
+    if (num_streams != i) {
+      ssrcs_[num_streams] = ssrcs_[i];
+      overuse_detectors_[num_streams] = overuse_detectors_[i];
+    }
+    ++num_streams;
+  }
+  if (num_streams < ssrcs_.size()) {
+    ssrcs_.erase(ssrcs_.begin() + num_streams, ssrcs_.end());
+    overuse_detectors_.erase(overuse_detectors_.begin() + num_streams,
+                             overuse_detectors_.end());
   }
   // We can't update the estimate if we don't have any active streams.
   if (overuse_detectors_.empty()) {
@@ -117,8 +150,8 @@ void RemoteBitrateEstimatorSingleStream::UpdateEstimate(int64_t time_now) {
     GetSsrcs(&ssrcs);
     observer_->OnReceiveBitrateChanged(&ssrcs, target_bitrate);
   }
-  for (it = overuse_detectors_.begin(); it != overuse_detectors_.end(); ++it) {
-    it->second.SetRateControlRegion(region);
+  for (size_t i = 0; i < overuse_detectors_.size(); ++i) {
+    overuse_detectors_[i].SetRateControlRegion(region);
   }
 }
 
@@ -129,8 +162,13 @@ void RemoteBitrateEstimatorSingleStream::OnRttUpdate(uint32_t rtt) {
 
 void RemoteBitrateEstimatorSingleStream::RemoveStream(unsigned int ssrc) {
   CriticalSectionScoped cs(crit_sect_.get());
-  // Ignoring the return value which is the number of elements erased.
-  overuse_detectors_.erase(ssrc);
+  std::vector<unsigned int>::iterator it =
+      std::lower_bound(ssrcs_.begin(), ssrcs_.end(), ssrc);
+  if (it != ssrcs_.end() && *it == ssrc) {
+    overuse_detectors_.erase(overuse_detectors_.begin() +
+                             (it - ssrcs_.begin()));
+    ssrcs_.erase(it);
+  }
 }
 
 bool RemoteBitrateEstimatorSingleStream::LatestEstimate(
@@ -152,12 +190,7 @@ bool RemoteBitrateEstimatorSingleStream::LatestEstimate(
 void RemoteBitrateEstimatorSingleStream::GetSsrcs(
     std::vector<unsigned int>* ssrcs) const {
   assert(ssrcs);
-  ssrcs->resize(overuse_detectors_.size());
-  int i = 0;
-  for (SsrcOveruseDetectorMap::const_iterator it = overuse_detectors_.begin();
-      it != overuse_detectors_.end(); ++it, ++i) {
-    (*ssrcs)[i] = it->first;
-  }
+  *ssrcs = ssrcs_;
 }
 
 }  // namespace webrtc
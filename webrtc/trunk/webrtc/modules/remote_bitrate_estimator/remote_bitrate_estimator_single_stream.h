@@ -13,7 +13,7 @@
 #ifndef WEBRTC_MODULES_REMOTE_BITRATE_ESTIMATOR_INCLUDE_REMOTE_BITRATE_ESTIMATOR_SINGLE_STREAM_H_
 #define WEBRTC_MODULES_REMOTE_BITRATE_ESTIMATOR_INCLUDE_REMOTE_BITRATE_ESTIMATOR_SINGLE_STREAM_H_
 
-#include <map>
+#include <vector>
 
 #include "webrtc/modules/remote_bitrate_estimator/bitrate_estimator.h"
 #include "webrtc/modules/remote_bitrate_estimator/include/remote_bitrate_estimator.h"
@@ -48,6 +48,8 @@ class RemoteBitrateEstimatorSingleStream : public RemoteBitrateEstimator {
                       int64_t arrival_time,
                       uint32_t rtp_timestamp);
 
+  void IncomingPackets(const Packet* packets, int num_packets);
+
   // Triggers a new estimate calculation.
   // Implements the Module interface.
   virtual int32_t Process();
@@ -66,7 +68,12 @@ class RemoteBitrateEstimatorSingleStream : public RemoteBitrateEstimator {
                       unsigned int* bitrate_bps) const;
 
  private:
-  typedef std::map<unsigned int, OveruseDetector> SsrcOveruseDetectorMap;
+  // Must be called with |crit_sect_| held.
+  void IncomingPacketLocked(const Packet& packet);
+
+  // Returns the index of |ssrc| in |ssrcs_|, adding a new over-use detector
+  // if this is a new SSRC.
+  size_t FindOrAddStream(unsigned int ssrc);
 
   // Triggers a new estimate calculation.
   void UpdateEstimate(int64_t time_now);
@@ -75,7 +82,11 @@ class RemoteBitrateEstimatorSingleStream : public RemoteBitrateEstimator {
 
   const OverUseDetectorOptions& options_;
   Clock* clock_;
-  SsrcOveruseDetectorMap overuse_detectors_;
+  // The SSRCs in ascending order, and the over-use detector of each SSRC at
+  // the same index. Kept in arrays rather than a map since they are looked up
+  // for every packet and walked for every estimate.
+  std::vector<unsigned int> ssrcs_;
+  std::vector<OveruseDetector> overuse_detectors_;
   BitRateStats incoming_bitrate_;
   RemoteRateControl remote_rate_;
   RemoteBitrateObserver* observer_;
@@ -17,8 +17,11 @@
 
 #include "modules/remote_bitrate_estimator/include/remote_bitrate_estimator.h"
 #include "modules/remote_bitrate_estimator/remote_bitrate_estimator_unittest_helper.h"
+#include "system_wrappers/interface/clock.h"
 #include "system_wrappers/interface/constructor_magic.h"
 #include "system_wrappers/interface/scoped_ptr.h"
+#include "system_wrappers/interface/tick_util.h"
+#include "test/testsupport/perf_test.h"
 
 namespace webrtc {
 
@@ -365,4 +368,166 @@ TEST_F(RemoteBitrateEstimatorTestAlign, ThreeStreams) {
   EXPECT_EQ(433, bitrate_drop_time - overuse_start_time);
 }
 
+// Records every estimate given to the observer.
+class EstimateLog : public RemoteBitrateObserver {
+ public:
+  void OnReceiveBitrateChanged(std::vector<unsigned int>* ssrcs,
+                               unsigned int bitrate) {
+    bitrates.push_back(bitrate);
+    num_ssrcs.push_back(ssrcs->size());
+  }
+
+  std::vector<unsigned int> bitrates;
+  std::vector<size_t> num_ssrcs;
+};
+
+// Generates the packets of |num_streams| 30 fps streams of 30 kbps each,
+// sharing a 2 Mbps link which drops to 1 Mbps after 20 of the 30 seconds.
+void GenerateMultiStreamTrace(
+    int num_streams,
+    std::vector<RemoteBitrateEstimator::Packet>* trace) {
+  testing::StreamGenerator stream_generator(2000000, 0);
+  for (int i = 0; i < num_streams; ++i) {
+    stream_generator.AddStream(new testing::RtpStream(
+        30,              // Frames per second.
+        30000,           // Bitrate.
+        0x1000 + 7 * i,  // SSRC.
+        90000,           // RTP frequency.
+        0x10000 * i,     // Timestamp offset.
+        0));             // RTCP receive time.
+  }
+  int64_t time_now_us = 0;
+  while (time_now_us < 30000000) {
+    if (time_now_us >= 20000000) {
+      stream_generator.set_capacity_bps(1000000);
+    }
+    testing::RtpStream::PacketList packets;
+    const int64_t next_time_us = stream_generator.GenerateFrame(&packets,
+                                                                time_now_us);
+    while (!packets.empty()) {
+      testing::RtpStream::RtpPacket* rtp_packet = packets.front();
+      const RemoteBitrateEstimator::Packet packet = {
+        rtp_packet->ssrc,
+        static_cast<int>(rtp_packet->size),
+        (rtp_packet->arrival_time + 500) / 1000,
+        rtp_packet->rtp_timestamp
+      };
+      trace->push_back(packet);
+      delete rtp_packet;
+      packets.pop_front();
+    }
+    time_now_us = next_time_us;
+  }
+}
+
+// Replays |trace| into a new estimator in batches of at most |batch_size|
+// packets, calling Process() when it's due. A batch ends at the packet after
+// which Process() is due, so that the estimates don't depend on the batch
+// size. A batch size of one uses IncomingPacket(). Returns the time spent in
+// the estimator in microseconds.
+int64_t ReplayTrace(RemoteBitrateEstimator::EstimationMode mode,
+                    const std::vector<RemoteBitrateEstimator::Packet>& trace,
+                    size_t batch_size,
+                    EstimateLog* log) {
+  SimulatedClock clock(0);
+  OverUseDetectorOptions options;
+  scoped_ptr<RemoteBitrateEstimator> estimator(
+      RemoteBitrateEstimator::Create(options, mode, log, &clock));
+  int64_t ticks = 0;
+  size_t begin = 0;
+  while (begin < trace.size()) {
+    const int64_t process_time = clock.TimeInMilliseconds() +
+        estimator->TimeUntilNextProcess();
+    size_t end = begin;
+    while (end < trace.size() && end - begin < batch_size) {
+      ++end;
+      if (trace[end - 1].arrival_time >= process_time) {
+        break;
+      }
+    }
+    clock.AdvanceTimeMilliseconds(trace[end - 1].arrival_time -
+                                  clock.TimeInMilliseconds());
+    const int64_t start_ticks = TickTime::Now().Ticks();
+    if (batch_size == 1) {
+      estimator->IncomingPacket(trace[begin].ssrc, trace[begin].payload_size,
+                                trace[begin].arrival_time,
+                                trace[begin].rtp_timestamp);
+    } else {
+      estimator->IncomingPackets(&trace[begin], static_cast<int>(end - begin));
+    }
+    if (estimator->TimeUntilNextProcess() <= 0) {
+      estimator->Process();
+    }
+    ticks += TickTime::Now().Ticks() - start_ticks;
+    begin = end;
+  }
+  return ticks * 1000 / TickTime::MillisecondsToTicks(1);
+}
+
+unsigned int SumOfEstimates(const EstimateLog& log) {
+  unsigned int sum = 0;
+  for (size_t i = 0; i < log.bitrates.size(); ++i) {
+    sum += log.bitrates[i];
+  }
+  return sum;
+}
+
+// The expected values are those of the implementation with an std::map of
+// over-use detectors, each keeping its frame period history in an std::list.
+TEST(RemoteBitrateEstimatorTraceTest, FiftyStreamsSingleStreamEstimation) {
+  std::vector<RemoteBitrateEstimator::Packet> trace;
+  GenerateMultiStreamTrace(50, &trace);
+  ASSERT_EQ(45050u, trace.size());
+  EstimateLog log;
+  ReplayTrace(RemoteBitrateEstimator::kSingleStreamEstimation, trace, 1, &log);
+  ASSERT_EQ(158u, log.bitrates.size());
+  EXPECT_EQ(181917249u, SumOfEstimates(log));
+  EXPECT_EQ(951900u, log.bitrates.back());
+  EXPECT_EQ(50u, log.num_ssrcs.back());
+
+  EstimateLog batched_log;
+  ReplayTrace(RemoteBitrateEstimator::kSingleStreamEstimation, trace, 32,
+              &batched_log);
+  EXPECT_EQ(log.bitrates, batched_log.bitrates);
+  EXPECT_EQ(log.num_ssrcs, batched_log.num_ssrcs);
+}
+
+TEST(RemoteBitrateEstimatorTraceTest, FiftyStreamsMultiStreamEstimation) {
+  std::vector<RemoteBitrateEstimator::Packet> trace;
+  GenerateMultiStreamTrace(50, &trace);
+  EstimateLog log;
+  ReplayTrace(RemoteBitrateEstimator::kMultiStreamEstimation, trace, 1, &log);
+  ASSERT_EQ(95u, log.bitrates.size());
+  EXPECT_EQ(112126317u, SumOfEstimates(log));
+  EXPECT_EQ(951900u, log.bitrates.back());
+
+  EstimateLog batched_log;
+  ReplayTrace(RemoteBitrateEstimator::kMultiStreamEstimation, trace, 32,
+              &batched_log);
+  EXPECT_EQ(log.bitrates, batched_log.bitrates);
+}
+
+// Reports the time per packet of replaying a 50 stream trace, one packet at a
+// time and in batches.
+TEST(RemoteBitrateEstimatorTraceTest, FiftyStreamsReplayTime) {
+  const int kNumRuns = 10;
+  std::vector<RemoteBitrateEstimator::Packet> trace;
+  GenerateMultiStreamTrace(50, &trace);
+  const size_t kBatchSizes[] = { 1, 32 };
+  const char* kBatchNames[] = { "single_packets", "batches_of_32" };
+  for (size_t i = 0; i < sizeof(kBatchSizes) / sizeof(kBatchSizes[0]); ++i) {
+    int64_t time_us = 0;
+    for (int run = 0; run < kNumRuns; ++run) {
+      EstimateLog log;
+      time_us += ReplayTrace(RemoteBitrateEstimator::kSingleStreamEstimation,
+                             trace, kBatchSizes[i], &log);
+    }
+    webrtc::test::PrintResult("rbe_50_streams_packet_time", "",
+                              kBatchNames[i],
+                              static_cast<size_t>(
+                                  time_us * 1000 / kNumRuns / trace.size()),
+                              "ns", false);
+  }
+}
+
 }  // namespace webrtc
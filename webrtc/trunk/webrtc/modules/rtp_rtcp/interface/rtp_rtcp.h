@@ -252,6 +252,21 @@ class RtpRtcp : public Module {
     virtual WebRtc_Word32 IncomingPacket(const WebRtc_UWord8* incomingPacket,
                                          const WebRtc_UWord16 packetLength) = 0;
 
+    /*
+    *   called by the network module when we receive a batch of packets, e.g.
+    *   from one recvmmsg() call; the packets are handled in order as if
+    *   passed to IncomingPacket() one by one
+    *
+    *   incomingPackets - incoming packet buffers
+    *   packetLengths   - length of each incoming buffer
+    *   numPackets      - number of packets in the batch
+    *
+    *   return -1 on failure else the number of packets accepted
+    */
+    virtual int IncomingPackets(const WebRtc_UWord8* const* incomingPackets,
+                                const WebRtc_UWord16* packetLengths,
+                                const int numPackets) = 0;
+
     /**************************************************************************
     *
     *   Sender
@@ -81,6 +81,10 @@ class MockRtpRtcp : public RtpRtcp {
       WebRtc_Word32(bool* enable, WebRtc_UWord32* SSRC));
   MOCK_METHOD2(IncomingPacket,
       WebRtc_Word32(const WebRtc_UWord8* incomingPacket, const WebRtc_UWord16 packetLength));
+  MOCK_METHOD3(IncomingPackets,
+      int(const WebRtc_UWord8* const* incomingPackets,
+          const WebRtc_UWord16* packetLengths,
+          const int numPackets));
   MOCK_METHOD4(IncomingAudioNTP,
       WebRtc_Word32(const WebRtc_UWord32 audioReceivedNTPsecs,
                     const WebRtc_UWord32 audioReceivedNTPfrac,
@@ -0,0 +1,51 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/fec_xor.h"
+
+#include <string.h>
+
+#include "system_wrappers/interface/cpu_features_wrapper.h"
+
+namespace webrtc {
+
+void FecXor_C(uint8_t* dst, const uint8_t* src, size_t length) {
+  size_t i = 0;
+  // memcpy() keeps the word accesses legal for unaligned buffers; compilers
+  // turn it into plain loads and stores.
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t d;
+    uint64_t s;
+    memcpy(&d, dst + i, sizeof(d));
+    memcpy(&s, src + i, sizeof(s));
+    d ^= s;
+    memcpy(dst + i, &d, sizeof(d));
+  }
+  for (; i < length; ++i) {
+    dst[i] ^= src[i];
+  }
+}
+
+FecXorFunction GetFecXorFunction() {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    return FecXor_SSE2;
+  }
+#elif defined(WEBRTC_DETECT_ARM_NEON)
+  if ((WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) != 0) {
+    return FecXor_Neon;
+  }
+#elif defined(WEBRTC_ARCH_ARM_NEON)
+  return FecXor_Neon;
+#endif
+  return FecXor_C;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,41 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_RTP_RTCP_SOURCE_FEC_XOR_H_
+#define WEBRTC_MODULES_RTP_RTCP_SOURCE_FEC_XOR_H_
+
+#include <stddef.h>
+
+#include "typedefs.h"
+
+namespace webrtc {
+
+// XORs |length| bytes of |src| into |dst|. The buffers may have any
+// alignment but must not overlap.
+typedef void (*FecXorFunction)(uint8_t* dst, const uint8_t* src,
+                               size_t length);
+
+// Word-wide generic implementation.
+void FecXor_C(uint8_t* dst, const uint8_t* src, size_t length);
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void FecXor_SSE2(uint8_t* dst, const uint8_t* src, size_t length);
+#endif
+
+#if (defined WEBRTC_DETECT_ARM_NEON || defined WEBRTC_ARCH_ARM_NEON)
+void FecXor_Neon(uint8_t* dst, const uint8_t* src, size_t length);
+#endif
+
+// Returns the fastest implementation supported by the CPU.
+FecXorFunction GetFecXorFunction();
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_RTP_RTCP_SOURCE_FEC_XOR_H_
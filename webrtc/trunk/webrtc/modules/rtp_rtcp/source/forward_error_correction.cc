@@ -59,6 +59,106 @@ class FecPacket : public ForwardErrorCorrection::SortablePacket {
     scoped_refptr<ForwardErrorCorrection::Packet> pkt;
 };
 
+class PooledPacket;
+
+// Free list of packet buffers used for recovered packets. The pool deletes
+// the buffers it holds when the last reference to it is released. Every
+// packet handed out holds a reference, so the pool stays alive until all
+// recovered packets have been released.
+//
+// Not thread-safe; same as ForwardErrorCorrection::Packet.
+class FecPacketPool {
+ public:
+  // Buffers allocated up front. The pool grows beyond this when more packets
+  // are in flight, and never shrinks.
+  static const size_t kInitialSize = 8;
+
+  FecPacketPool();
+
+  int32_t AddRef() { return ++ref_count_; }
+  int32_t Release();
+
+  // Returns a packet with a reference count of zero.
+  ForwardErrorCorrection::Packet* Get();
+  // Called by PooledPacket when its last reference is released.
+  void Put(PooledPacket* packet);
+
+ private:
+  ~FecPacketPool();
+
+  int32_t ref_count_;
+  std::vector<PooledPacket*> free_packets_;
+};
+
+// Packet whose storage goes back to a FecPacketPool instead of being deleted
+// when the last reference is released.
+class PooledPacket : public ForwardErrorCorrection::Packet {
+ public:
+  PooledPacket() : pool_(NULL), pool_ref_count_(0) {}
+  virtual ~PooledPacket() {}
+
+  void set_pool(FecPacketPool* pool) { pool_ = pool; }
+
+  virtual int32_t AddRef() {
+    return ++pool_ref_count_;
+  }
+
+  virtual int32_t Release() {
+    int32_t ref_count = --pool_ref_count_;
+    if (ref_count == 0) {
+      FecPacketPool* pool = pool_;
+      pool_ = NULL;
+      pool->Put(this);
+      // May delete the pool, and with it this packet.
+      pool->Release();
+    }
+    return ref_count;
+  }
+
+ private:
+  FecPacketPool* pool_;
+  int32_t pool_ref_count_;
+};
+
+FecPacketPool::FecPacketPool() : ref_count_(0) {
+  free_packets_.reserve(kInitialSize);
+  for (size_t i = 0; i < kInitialSize; ++i) {
+    free_packets_.push_back(new PooledPacket);
+  }
+}
+
+FecPacketPool::~FecPacketPool() {
+  for (size_t i = 0; i < free_packets_.size(); ++i) {
+    delete free_packets_[i];
+  }
+}
+
+int32_t FecPacketPool::Release() {
+  int32_t ref_count = --ref_count_;
+  if (ref_count == 0)
+    delete this;
+  return ref_count;
+}
+
+ForwardErrorCorrection::Packet* FecPacketPool::Get() {
+  PooledPacket* packet;
+  if (free_packets_.empty()) {
+    packet = new PooledPacket;
+  } else {
+    packet = free_packets_.back();
+    free_packets_.pop_back();
+  }
+  // The pool is released again by PooledPacket::Release().
+  AddRef();
+  packet->set_pool(this);
+  packet->length = 0;
+  return packet;
+}
+
+void FecPacketPool::Put(PooledPacket* packet) {
+  free_packets_.push_back(packet);
+}
+
 bool ForwardErrorCorrection::SortablePacket::LessThan(
     const SortablePacket* first,
     const SortablePacket* second) {
@@ -69,7 +169,9 @@ bool ForwardErrorCorrection::SortablePacket::LessThan(
 ForwardErrorCorrection::ForwardErrorCorrection(int32_t id)
     : _id(id),
       _generatedFecPackets(kMaxMediaPackets),
-      _fecPacketReceived(false) {
+      _fecPacketReceived(false),
+      _xorFunc(GetFecXorFunction()),
+      _recoveredPacketPool(new FecPacketPool) {
 }
 
 ForwardErrorCorrection::~ForwardErrorCorrection() {
@@ -272,11 +374,10 @@ void ForwardErrorCorrection::GenerateFecBitStrings(
           _generatedFecPackets[i].data[9] ^= mediaPayloadLength[1];
 
           // XOR with RTP payload, leaving room for the ULP header.
-          for (int32_t j = kFecHeaderSize + ulpHeaderSize;
-              j < fecPacketLength; j++) {
-            _generatedFecPackets[i].data[j] ^=
-                mediaPacket->data[j - fecRtpOffset];
-          }
+          _xorFunc(&_generatedFecPackets[i].data[kFecHeaderSize +
+                                                 ulpHeaderSize],
+                   &mediaPacket->data[kRtpHeaderSize],
+                   mediaPacket->length - kRtpHeaderSize);
         }
         if (fecPacketLength > _generatedFecPackets[i].length) {
           _generatedFecPackets[i].length = fecPacketLength;
@@ -645,17 +746,24 @@ void ForwardErrorCorrection::InitRecovery(
   // This is the first packet which we try to recover with.
   const uint16_t ulpHeaderSize = fec_packet->pkt->data[0] & 0x40 ?
       kUlpHeaderSizeLBitSet : kUlpHeaderSizeLBitClear;  // L bit set?
-  recovered->pkt = new Packet;
-  memset(recovered->pkt->data, 0, IP_PACKET_SIZE);
+  recovered->pkt = _recoveredPacketPool->Get();
   recovered->returned = false;
   recovered->wasRecovered = true;
   uint8_t protectionLength[2];
   // Copy the protection length from the ULP header.
   memcpy(protectionLength, &fec_packet->pkt->data[10], 2);
+  const uint16_t payloadLength =
+      ModuleRTPUtility::BufferToUWord16(protectionLength);
   // Copy FEC payload, skipping the ULP header.
   memcpy(&recovered->pkt->data[kRtpHeaderSize],
          &fec_packet->pkt->data[kFecHeaderSize + ulpHeaderSize],
-         ModuleRTPUtility::BufferToUWord16(protectionLength));
+         payloadLength);
+  // The pooled storage may hold an older packet. Clear what the payload copy
+  // did not overwrite, as the XOR with the media packets expects zeros there.
+  if (kRtpHeaderSize + payloadLength < IP_PACKET_SIZE) {
+    memset(&recovered->pkt->data[kRtpHeaderSize + payloadLength], 0,
+           IP_PACKET_SIZE - kRtpHeaderSize - payloadLength);
+  }
   // Copy the length recovery field.
   memcpy(recovered->length_recovery, &fec_packet->pkt->data[8], 2);
   // Copy the first 2 bytes of the FEC header.
@@ -700,8 +808,10 @@ void ForwardErrorCorrection::XorPackets(const Packet* src_packet,
 
   // XOR with RTP payload.
   // TODO(marpan/ajm): Are we doing more XORs than required here?
-  for (int32_t i = kRtpHeaderSize; i < src_packet->length; i++) {
-    dst_packet->pkt->data[i] ^= src_packet->data[i];
+  if (src_packet->length > kRtpHeaderSize) {
+    _xorFunc(&dst_packet->pkt->data[kRtpHeaderSize],
+             &src_packet->data[kRtpHeaderSize],
+             src_packet->length - kRtpHeaderSize);
   }
 }
 
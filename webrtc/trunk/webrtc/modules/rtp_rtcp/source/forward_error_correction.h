@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/fec_xor.h"
 #include "system_wrappers/interface/ref_count.h"
 #include "system_wrappers/interface/scoped_refptr.h"
 #include "typedefs.h"
@@ -23,6 +24,7 @@ namespace webrtc {
 
 // Forward declaration.
 class FecPacket;
+class FecPacketPool;
 
 /**
  * Performs codec-independent forward error correction (FEC), based on RFC 5109.
@@ -304,14 +306,15 @@ class ForwardErrorCorrection {
   // Attempt to recover missing packets.
   void AttemptRecover(RecoveredPacketList* recoveredPacketList);
 
-  // Initializes the packet recovery using the FEC packet.
-  static  void InitRecovery(const FecPacket* fec_packet,
-                            RecoveredPacket* recovered);
+  // Initializes the packet recovery using the FEC packet. The packet storage
+  // is taken from |_recoveredPacketPool|.
+  void InitRecovery(const FecPacket* fec_packet,
+                    RecoveredPacket* recovered);
 
   // Performs XOR between |src_packet| and |dst_packet| and stores the result
   // in |dst_packet|.
-  static void XorPackets(const Packet* src_packet,
-                         RecoveredPacket* dst_packet);
+  void XorPackets(const Packet* src_packet,
+                  RecoveredPacket* dst_packet);
 
   // Finish up the recovery of a packet.
   static  void FinishRecovery(RecoveredPacket* recovered);
@@ -337,6 +340,11 @@ class ForwardErrorCorrection {
   std::vector<Packet> _generatedFecPackets;
   FecPacketList _fecPacketList;
   bool _fecPacketReceived;
+  // XOR kernel used by both the encoder and the decoder.
+  FecXorFunction _xorFunc;
+  // Storage for recovered packets. Reference counted since recovered packets
+  // may outlive this object.
+  scoped_refptr<FecPacketPool> _recoveredPacketPool;
 };
 } // namespace webrtc
 #endif // WEBRTC_MODULES_RTP_RTCP_SOURCE_FORWARD_ERROR_CORRECTION_H_
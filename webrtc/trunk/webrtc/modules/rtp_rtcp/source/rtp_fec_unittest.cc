@@ -11,9 +11,16 @@
 #include "modules/rtp_rtcp/source/forward_error_correction.h"
 
 #include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <iterator>
 #include <list>
 
+#include "modules/rtp_rtcp/source/fec_xor.h"
 #include "rtp_utility.h"
+#include "system_wrappers/interface/tick_util.h"
+#include "test/testsupport/perf_test.h"
 
 using webrtc::ForwardErrorCorrection;
 
@@ -714,6 +721,137 @@ TEST_F(RtpFecTest, FecRecoveryNonConsecutivePacketsWrap) {
   EXPECT_FALSE(IsRecoveryComplete());
 }
 
+TEST_F(RtpFecTest, RecoveredPacketsOutliveFec) {
+  const int kNumImportantPackets = 0;
+  const bool kUseUnequalProtection = false;
+  const int kNumMediaPackets = 4;
+  const uint8_t kProtectionFactor = 60;
+
+  fec_seq_num_ = ConstructMediaPackets(kNumMediaPackets);
+
+  EXPECT_EQ(0, fec_->GenerateFEC(media_packet_list_,
+                                 kProtectionFactor,
+                                 kNumImportantPackets,
+                                 kUseUnequalProtection,
+                                 webrtc::kFecMaskBursty,
+                                 &fec_packet_list_));
+
+  memset(media_loss_mask_, 0, sizeof(media_loss_mask_));
+  memset(fec_loss_mask_, 0, sizeof(fec_loss_mask_));
+  media_loss_mask_[2] = 1;
+  NetworkReceivedPackets();
+
+  EXPECT_EQ(0, fec_->DecodeFEC(&received_packet_list_,
+                               &recovered_packet_list_));
+  EXPECT_TRUE(IsRecoveryComplete());
+
+  // The recovered packet storage comes from a pool owned by |fec_|. Holding
+  // a reference must keep it valid after |fec_| is deleted.
+  RecoveredPacketList::iterator it = recovered_packet_list_.begin();
+  std::advance(it, 2);
+  ASSERT_TRUE((*it)->wasRecovered);
+  webrtc::scoped_refptr<ForwardErrorCorrection::Packet> recovered =
+      (*it)->pkt;
+  PacketList::iterator media_it = media_packet_list_.begin();
+  std::advance(media_it, 2);
+  delete fec_;
+  fec_ = new ForwardErrorCorrection(0);
+  FreeRecoveredPacketList();
+  EXPECT_EQ((*media_it)->length, recovered->length);
+  EXPECT_EQ(0, memcmp((*media_it)->data, recovered->data,
+                      recovered->length));
+}
+
+TEST(FecXorTest, ImplementationsMatchBytewiseXor) {
+  const size_t kMaxLength = 300;
+  uint8_t src[kMaxLength + 16];
+  uint8_t dst[kMaxLength + 16];
+  uint8_t expected[kMaxLength + 16];
+  webrtc::FecXorFunction functions[] = {
+    webrtc::FecXor_C,
+    webrtc::GetFecXorFunction()
+  };
+  for (size_t f = 0; f < sizeof(functions) / sizeof(functions[0]); ++f) {
+    for (size_t offset = 0; offset < 4; ++offset) {
+      for (size_t length = 0; length <= kMaxLength; ++length) {
+        for (size_t i = 0; i < sizeof(src); ++i) {
+          src[i] = static_cast<uint8_t>(rand());
+          dst[i] = static_cast<uint8_t>(rand());
+          expected[i] = dst[i];
+        }
+        for (size_t i = 0; i < length; ++i) {
+          expected[offset + i] ^= src[i];
+        }
+        functions[f](dst + offset, src, length);
+        ASSERT_EQ(0, memcmp(expected, dst, sizeof(dst)))
+            << "function " << f << ", offset " << offset << ", length "
+            << length;
+      }
+    }
+  }
+}
+
+// Measures FEC encode and decode throughput over all frame sizes of the
+// bursty and random mask tables, with one media packet lost per frame.
+TEST_F(RtpFecTest, FecThroughputBenchmark) {
+  const int kNumImportantPackets = 0;
+  const bool kUseUnequalProtection = false;
+  const uint8_t kProtectionFactor = 128;
+  const int kIterations = 100;
+  const webrtc::FecMaskType kMaskTypes[] = {
+    webrtc::kFecMaskBursty,
+    webrtc::kFecMaskRandom
+  };
+  const char* kMaskNames[] = { "bursty", "random" };
+
+  for (int m = 0; m < 2; ++m) {
+    int64_t encode_us = 0;
+    int64_t decode_us = 0;
+    int64_t media_bytes = 0;
+    for (int num_media_packets = 1;
+         num_media_packets <= kMaxNumberMediaPackets; ++num_media_packets) {
+      ClearList(&media_packet_list_);
+      fec_seq_num_ = ConstructMediaPackets(num_media_packets);
+      int frame_bytes = 0;
+      for (PacketList::iterator it = media_packet_list_.begin();
+           it != media_packet_list_.end(); ++it) {
+        frame_bytes += (*it)->length;
+      }
+      for (int i = 0; i < kIterations; ++i) {
+        fec_packet_list_.clear();
+        int64_t start_us = webrtc::TickTime::MicrosecondTimestamp();
+        EXPECT_EQ(0, fec_->GenerateFEC(media_packet_list_,
+                                       kProtectionFactor,
+                                       kNumImportantPackets,
+                                       kUseUnequalProtection,
+                                       kMaskTypes[m],
+                                       &fec_packet_list_));
+        encode_us += webrtc::TickTime::MicrosecondTimestamp() - start_us;
+
+        memset(media_loss_mask_, 0, sizeof(media_loss_mask_));
+        memset(fec_loss_mask_, 0, sizeof(fec_loss_mask_));
+        media_loss_mask_[i % num_media_packets] = 1;
+        NetworkReceivedPackets();
+        start_us = webrtc::TickTime::MicrosecondTimestamp();
+        EXPECT_EQ(0, fec_->DecodeFEC(&received_packet_list_,
+                                     &recovered_packet_list_));
+        decode_us += webrtc::TickTime::MicrosecondTimestamp() - start_us;
+        fec_->ResetState(&recovered_packet_list_);
+        media_bytes += frame_bytes;
+      }
+    }
+    // Bits per microsecond equals Mbps.
+    webrtc::test::PrintResult("fec_encode_throughput", "", kMaskNames[m],
+                              static_cast<size_t>(
+                                  media_bytes * 8 / (encode_us + 1)),
+                              "Mbps", true);
+    webrtc::test::PrintResult("fec_decode_throughput", "", kMaskNames[m],
+                              static_cast<size_t>(
+                                  media_bytes * 8 / (decode_us + 1)),
+                              "Mbps", true);
+  }
+}
+
 // TODO(marpan): Add more test cases.
 
 void RtpFecTest::TearDown() {
@@ -0,0 +1,213 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/rtp_format_h264.h"
+
+#include <string.h>  // memcpy
+
+namespace webrtc {
+
+namespace {
+const int kRtpFixedHeaderLength = 12;
+}  // namespace
+
+RtpFormatH264::RtpFormatH264(const WebRtc_UWord8* payload_data,
+                             WebRtc_UWord32 payload_size,
+                             int max_payload_len,
+                             const RTPFragmentationHeader& fragmentation)
+    : payload_data_(payload_data),
+      payload_size_(payload_size),
+      max_payload_len_(max_payload_len),
+      fragmentation_(fragmentation),
+      fragment_(0),
+      nal_(NULL),
+      nal_size_(0),
+      fu_indicator_(0),
+      fu_header_(0),
+      fu_start_(false),
+      fu_end_(false),
+      fu_offset_(0),
+      fu_packets_left_(0),
+      base_layer_(true),
+      prefix_base_layer_(true) {
+}
+
+int RtpFormatH264::NextPacket(WebRtc_UWord8* buffer,
+                              int* bytes_to_send,
+                              bool* last_packet) {
+  if (fragment_ >= fragmentation_.fragmentationVectorSize) {
+    return -1;
+  }
+  if (nal_ == NULL && !LoadFragment()) {
+    return -1;
+  }
+  if (fu_packets_left_ > 0) {
+    *bytes_to_send = NextFuAPacket(buffer);
+  } else {
+    memcpy(buffer, nal_, nal_size_);
+    *bytes_to_send = nal_size_;
+  }
+  if (fu_packets_left_ == 0) {
+    // Done with this fragment.
+    nal_ = NULL;
+    ++fragment_;
+  }
+  *last_packet = (fragment_ == fragmentation_.fragmentationVectorSize);
+  return 0;
+}
+
+bool RtpFormatH264::LoadFragment() {
+  const WebRtc_UWord32 offset = fragmentation_.fragmentationOffset[fragment_];
+  const WebRtc_UWord32 length = fragmentation_.fragmentationLength[fragment_];
+  if (offset > payload_size_ || length > payload_size_ - offset ||
+      length < static_cast<WebRtc_UWord32>(kRtpFixedHeaderLength)) {
+    return false;
+  }
+  const WebRtc_UWord8* packet = payload_data_ + offset;
+  if ((packet[0] & 0xC0) != 0x80) {
+    // Not RTP version 2.
+    return false;
+  }
+  int header_length = kRtpFixedHeaderLength + 4 * (packet[0] & 0x0F);
+  if (packet[0] & 0x10) {
+    // Header extension.
+    if (static_cast<int>(length) < header_length + 4) {
+      return false;
+    }
+    header_length += 4 + 4 * ((packet[header_length + 2] << 8) +
+                              packet[header_length + 3]);
+  }
+  int size = static_cast<int>(length) - header_length;
+  if (packet[0] & 0x20) {
+    // Padding; the last byte holds the padding length.
+    size -= packet[length - 1];
+  }
+  if (size <= 0) {
+    return false;
+  }
+  nal_ = packet + header_length;
+  nal_size_ = size;
+  fu_packets_left_ = 0;
+  base_layer_ = BaseLayerPayload();
+  if (nal_size_ <= max_payload_len_) {
+    return true;
+  }
+
+  const int nal_type = nal_[0] & kNalTypeMask;
+  if (nal_type == kFuA) {
+    // Already a fragment of a NAL unit; split it further and keep its start
+    // and end bits on the outermost packets.
+    if (nal_size_ <= kFuAHeaderSize) {
+      return false;
+    }
+    fu_indicator_ = nal_[0];
+    fu_header_ = nal_[1] & ~(kSBit | kEBit);
+    fu_start_ = (nal_[1] & kSBit) != 0;
+    fu_end_ = (nal_[1] & kEBit) != 0;
+    fu_offset_ = kFuAHeaderSize;
+  } else if (nal_type >= 1 && nal_type < kStapA) {
+    // Single NAL unit packet. The NAL unit header is carried in the FU
+    // indicator and FU header.
+    fu_indicator_ = (nal_[0] & (kForbiddenMask | kNriMask)) | kFuA;
+    fu_header_ = nal_type;
+    fu_start_ = true;
+    fu_end_ = true;
+    fu_offset_ = 1;
+  } else {
+    // Aggregation packets can't be fragmented.
+    return false;
+  }
+  const int max_fragment_size = max_payload_len_ - kFuAHeaderSize;
+  if (max_fragment_size <= 0) {
+    return false;
+  }
+  fu_packets_left_ = (nal_size_ - fu_offset_ + max_fragment_size - 1) /
+      max_fragment_size;
+  return true;
+}
+
+int RtpFormatH264::NextFuAPacket(WebRtc_UWord8* buffer) {
+  // Balance the packet sizes over the remaining packets.
+  const int remaining = nal_size_ - fu_offset_;
+  const int size = (remaining + fu_packets_left_ - 1) / fu_packets_left_;
+  buffer[0] = fu_indicator_;
+  buffer[1] = fu_header_;
+  if (fu_start_) {
+    buffer[1] |= kSBit;
+    fu_start_ = false;
+  }
+  if (fu_packets_left_ == 1 && fu_end_) {
+    buffer[1] |= kEBit;
+  }
+  memcpy(&buffer[kFuAHeaderSize], nal_ + fu_offset_, size);
+  fu_offset_ += size;
+  --fu_packets_left_;
+  return size + kFuAHeaderSize;
+}
+
+bool RtpFormatH264::BaseLayerPayload() {
+  const int nal_type = nal_[0] & kNalTypeMask;
+  if (nal_type == kStapA) {
+    // Each aggregated NAL unit is preceded by its 16 bit size.
+    bool base_layer = true;
+    int offset = 1;
+    while (offset + 2 < nal_size_) {
+      const int size = (nal_[offset] << 8) | nal_[offset + 1];
+      offset += 2;
+      if (size == 0 || size > nal_size_ - offset) {
+        break;
+      }
+      if (!BaseLayerNalUnit(nal_[offset] & kNalTypeMask, nal_ + offset + 1,
+                            size - 1)) {
+        base_layer = false;
+      }
+      offset += size;
+    }
+    return base_layer;
+  }
+  if (nal_type == kFuA) {
+    if (nal_size_ <= kFuAHeaderSize || !(nal_[1] & kSBit)) {
+      // A continued NAL unit is in the layer of its first fragment.
+      return base_layer_;
+    }
+    return BaseLayerNalUnit(nal_[1] & kNalTypeMask, nal_ + kFuAHeaderSize,
+                            nal_size_ - kFuAHeaderSize);
+  }
+  return BaseLayerNalUnit(nal_type, nal_ + 1, nal_size_ - 1);
+}
+
+bool RtpFormatH264::BaseLayerNalUnit(int nal_type,
+                                     const WebRtc_UWord8* data,
+                                     int size) {
+  switch (nal_type) {
+    case kPrefixNal:
+    case kCodedSliceExtension: {
+      if (size < kSvcExtensionSize) {
+        return true;
+      }
+      const int dependency_id = (data[1] >> 4) & 0x07;
+      const int quality_id = data[1] & 0x0F;
+      const int temporal_id = data[2] >> 5;
+      const bool base_layer =
+          dependency_id == 0 && quality_id == 0 && temporal_id == 0;
+      if (nal_type == kPrefixNal) {
+        prefix_base_layer_ = base_layer;
+      }
+      return base_layer;
+    }
+    case kCodedSlice:
+    case kCodedSliceIdr:
+      return prefix_base_layer_;
+    default:
+      return true;
+  }
+}
+
+}  // namespace webrtc
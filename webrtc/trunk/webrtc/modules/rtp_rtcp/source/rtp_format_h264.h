@@ -0,0 +1,118 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the declaration of the H.264 and H.264/SVC packetizer
+ * class. The H.264 encoder delivers each encoded frame as a sequence of RTP
+ * packets, described by one fragment each in the fragmentation header. The
+ * packetizer drops the RTP headers written by the encoder, so that sequence
+ * number, time stamp, marker bit, CSRCs and header extensions are all written
+ * by the RTP module, and keeps the RFC 6184 payloads (single NAL unit, STAP-A
+ * or FU-A). Payloads that do not fit in |max_payload_len| are split into
+ * FU-A packets of roughly equal size.
+ *
+ * After creating the packetizer, the method NextPacket is called
+ * repeatedly to get all packets for the frame.
+ */
+
+#ifndef WEBRTC_MODULES_RTP_RTCP_SOURCE_RTP_FORMAT_H264_H_
+#define WEBRTC_MODULES_RTP_RTCP_SOURCE_RTP_FORMAT_H264_H_
+
+#include "modules/interface/module_common_types.h"
+#include "system_wrappers/interface/constructor_magic.h"
+#include "typedefs.h"  // NOLINT(build/include)
+
+namespace webrtc {
+
+// Packetizer for H.264 and H.264/SVC.
+class RtpFormatH264 {
+ public:
+  // Initialize with the RTP packets from the encoder. Fragment i of
+  // |fragmentation| is one RTP packet, including its RTP header.
+  RtpFormatH264(const WebRtc_UWord8* payload_data,
+                WebRtc_UWord32 payload_size,
+                int max_payload_len,
+                const RTPFragmentationHeader& fragmentation);
+
+  // Get the next payload. |buffer| is a pointer to where the output will be
+  // written and |bytes_to_send| will contain the number of bytes written.
+  // |last_packet| is set to true for the last packet of the frame.
+  // Returns 0 on success and negative on error, e.g. if an encoder packet is
+  // malformed or an aggregation packet is larger than |max_payload_len|.
+  int NextPacket(WebRtc_UWord8* buffer,
+                 int* bytes_to_send,
+                 bool* last_packet);
+
+  // Returns true if the packet returned by the last call to NextPacket()
+  // belongs to the base layer, i.e. SVC dependency, quality and temporal
+  // layer 0. All packets of an H.264 stream without SVC are base layer
+  // packets, as are parameter sets and SEI.
+  bool BaseLayerPacket() const { return base_layer_; }
+
+ private:
+  static const int kNalTypeMask = 0x1F;
+  static const int kCodedSlice = 1;
+  static const int kCodedSliceIdr = 5;
+  static const int kPrefixNal = 14;
+  static const int kCodedSliceExtension = 20;
+  // RFC 6190 NAL unit header extension, following the NAL unit header of
+  // prefix NAL units and coded slice extensions.
+  static const int kSvcExtensionSize = 3;
+  static const int kNriMask = 0x60;
+  static const int kForbiddenMask = 0x80;
+  static const int kStapA = 24;
+  static const int kFuA = 28;
+  static const int kSBit = 0x80;
+  static const int kEBit = 0x40;
+  static const int kFuAHeaderSize = 2;
+
+  // Finds the RFC 6184 payload of fragment |fragment_| and sets up the state
+  // for splitting it. Returns false if the encoder packet is malformed.
+  bool LoadFragment();
+
+  // Writes the next FU-A packet of the current payload to |buffer|. Returns
+  // the number of bytes written.
+  int NextFuAPacket(WebRtc_UWord8* buffer);
+
+  // Returns true if all NAL units in the current payload belong to the base
+  // layer.
+  bool BaseLayerPayload();
+
+  // Returns true if a NAL unit of type |nal_type| belongs to the base layer.
+  // |data| points to the |size| bytes following its NAL unit header.
+  bool BaseLayerNalUnit(int nal_type, const WebRtc_UWord8* data, int size);
+
+  const WebRtc_UWord8* payload_data_;
+  const WebRtc_UWord32 payload_size_;
+  const int max_payload_len_;
+  const RTPFragmentationHeader& fragmentation_;
+  WebRtc_UWord16 fragment_;
+  // RFC 6184 payload of the current fragment.
+  const WebRtc_UWord8* nal_;
+  int nal_size_;
+  // State used when the current payload is split into FU-A packets.
+  WebRtc_UWord8 fu_indicator_;
+  WebRtc_UWord8 fu_header_;
+  bool fu_start_;
+  bool fu_end_;
+  int fu_offset_;
+  int fu_packets_left_;
+  // Layer of the current payload.
+  bool base_layer_;
+  // Layer of the last prefix NAL unit, which gives the layer of the AVC
+  // compatible slices following it.
+  bool prefix_base_layer_;
+
+  DISALLOW_COPY_AND_ASSIGN(RtpFormatH264);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_RTP_RTCP_SOURCE_RTP_FORMAT_H264_H_
@@ -0,0 +1,200 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file includes unit tests for the H.264 packetizer.
+ */
+
+#include <string.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "modules/rtp_rtcp/source/rtp_format_h264.h"
+
+namespace webrtc {
+
+namespace {
+const int kRtpHeaderSize = 12;
+const int kMaxPayloadLen = 100;
+const WebRtc_UWord8 kNalHeader = 0x65;  // NRI 3, IDR slice.
+const WebRtc_UWord8 kFuIndicator = 0x7C;  // NRI 3, FU-A.
+}  // namespace
+
+class RtpFormatH264Test : public ::testing::Test {
+ protected:
+  // Appends an encoder RTP packet with |payload_size| bytes of payload. The
+  // first payload byte is |nal_header| and the rest counts upwards.
+  void AddPacket(WebRtc_UWord8 nal_header, int payload_size) {
+    const int offset = static_cast<int>(data_.size());
+    data_.resize(offset + kRtpHeaderSize + payload_size);
+    WebRtc_UWord8* packet = &data_[offset];
+    memset(packet, 0, kRtpHeaderSize);
+    packet[0] = 0x80;
+    packet[1] = 0x62;
+    packet[kRtpHeaderSize] = nal_header;
+    for (int i = 1; i < payload_size; ++i) {
+      packet[kRtpHeaderSize + i] = static_cast<WebRtc_UWord8>(i);
+    }
+    offsets_.push_back(offset);
+    lengths_.push_back(kRtpHeaderSize + payload_size);
+  }
+
+  // Appends a prefix NAL unit or coded slice extension, with the given layer
+  // in its NAL unit header extension.
+  void AddSvcPacket(WebRtc_UWord8 nal_header, int dependency_id,
+                    int quality_id, int temporal_id, int payload_size) {
+    AddPacket(nal_header, payload_size);
+    WebRtc_UWord8* extension = &data_[offsets_.back() + kRtpHeaderSize + 1];
+    extension[0] = 0x80;
+    extension[1] = static_cast<WebRtc_UWord8>((dependency_id << 4) |
+                                              quality_id);
+    extension[2] = static_cast<WebRtc_UWord8>(temporal_id << 5);
+  }
+
+  void BuildFragmentation() {
+    fragmentation_.VerifyAndAllocateFragmentationHeader(offsets_.size());
+    fragmentation_.fragmentationVectorSize = offsets_.size();
+    for (size_t i = 0; i < offsets_.size(); ++i) {
+      fragmentation_.fragmentationOffset[i] = offsets_[i];
+      fragmentation_.fragmentationLength[i] = lengths_[i];
+    }
+  }
+
+  // Runs the packetizer over the whole frame and stores the packets.
+  void Packetize(int max_payload_len) {
+    BuildFragmentation();
+    RtpFormatH264 packetizer(&data_[0], data_.size(), max_payload_len,
+                             fragmentation_);
+    bool last = false;
+    while (!last) {
+      WebRtc_UWord8 buffer[1500];
+      int bytes = 0;
+      ASSERT_EQ(0, packetizer.NextPacket(buffer, &bytes, &last));
+      ASSERT_LE(bytes, max_payload_len);
+      packets_.push_back(std::vector<WebRtc_UWord8>(buffer, buffer + bytes));
+      base_layer_.push_back(packetizer.BaseLayerPacket());
+    }
+  }
+
+  std::vector<WebRtc_UWord8> data_;
+  std::vector<WebRtc_UWord32> offsets_;
+  std::vector<WebRtc_UWord32> lengths_;
+  RTPFragmentationHeader fragmentation_;
+  std::vector<std::vector<WebRtc_UWord8> > packets_;
+  std::vector<bool> base_layer_;
+};
+
+TEST_F(RtpFormatH264Test, StripsEncoderRtpHeaders) {
+  AddPacket(kNalHeader, 50);
+  AddPacket(0x41, 80);
+  Packetize(kMaxPayloadLen);
+  ASSERT_EQ(2u, packets_.size());
+  ASSERT_EQ(50u, packets_[0].size());
+  EXPECT_EQ(0, memcmp(&packets_[0][0], &data_[kRtpHeaderSize], 50));
+  ASSERT_EQ(80u, packets_[1].size());
+  EXPECT_EQ(0x41, packets_[1][0]);
+}
+
+TEST_F(RtpFormatH264Test, SkipsCsrcsExtensionAndPadding) {
+  AddPacket(kNalHeader, 30);
+  // Add one CSRC, a one word header extension and two bytes of padding.
+  std::vector<WebRtc_UWord8> packet(kRtpHeaderSize + 4 + 8 + 30 + 2, 0);
+  packet[0] = 0x80 | 0x20 | 0x10 | 1;
+  packet[kRtpHeaderSize + 4 + 3] = 1;  // Extension length in words.
+  packet[kRtpHeaderSize + 12] = kNalHeader;
+  packet[packet.size() - 1] = 2;
+  data_ = packet;
+  lengths_[0] = packet.size();
+  Packetize(kMaxPayloadLen);
+  ASSERT_EQ(1u, packets_.size());
+  ASSERT_EQ(30u, packets_[0].size());
+  EXPECT_EQ(kNalHeader, packets_[0][0]);
+}
+
+TEST_F(RtpFormatH264Test, SplitsLargeNalUnitIntoFuA) {
+  const int kNalSize = 250;
+  AddPacket(kNalHeader, kNalSize);
+  Packetize(kMaxPayloadLen);
+  // 249 bytes after the NAL header in packets of at most 98 bytes.
+  ASSERT_EQ(3u, packets_.size());
+  std::vector<WebRtc_UWord8> reassembled(1, kNalHeader);
+  for (size_t i = 0; i < packets_.size(); ++i) {
+    EXPECT_EQ(kFuIndicator, packets_[i][0]);
+    EXPECT_EQ(kNalHeader & 0x1F, packets_[i][1] & 0x1F);
+    EXPECT_EQ(i == 0, (packets_[i][1] & 0x80) != 0);
+    EXPECT_EQ(i == packets_.size() - 1, (packets_[i][1] & 0x40) != 0);
+    // Packets are balanced.
+    EXPECT_NEAR(static_cast<int>(packets_[0].size()),
+                static_cast<int>(packets_[i].size()), 1);
+    reassembled.insert(reassembled.end(), packets_[i].begin() + 2,
+                       packets_[i].end());
+  }
+  ASSERT_EQ(static_cast<size_t>(kNalSize), reassembled.size());
+  EXPECT_EQ(0, memcmp(&reassembled[0], &data_[kRtpHeaderSize], kNalSize));
+}
+
+TEST_F(RtpFormatH264Test, SplitsLargeFuAKeepingStartAndEndBits) {
+  // A middle FU-A fragment from the encoder; neither S nor E is set.
+  AddPacket(kFuIndicator, 150);
+  data_[kRtpHeaderSize + 1] = kNalHeader & 0x1F;
+  // The last FU-A fragment, with the E bit set.
+  AddPacket(kFuIndicator, 150);
+  data_[offsets_[1] + kRtpHeaderSize + 1] = 0x40 | (kNalHeader & 0x1F);
+  Packetize(kMaxPayloadLen);
+  ASSERT_EQ(4u, packets_.size());
+  for (size_t i = 0; i < packets_.size(); ++i) {
+    EXPECT_EQ(kFuIndicator, packets_[i][0]);
+    EXPECT_EQ(0, packets_[i][1] & 0x80);
+    EXPECT_EQ(i == 3, (packets_[i][1] & 0x40) != 0);
+  }
+}
+
+TEST_F(RtpFormatH264Test, FindsBaseLayerPackets) {
+  AddPacket(0x67, 10);  // SPS.
+  AddSvcPacket(0x6E, 0, 0, 0, 10);  // Prefix NAL unit, base layer.
+  AddPacket(kNalHeader, 50);
+  AddSvcPacket(0x6E, 0, 0, 1, 10);  // Prefix NAL unit, temporal layer 1.
+  AddPacket(0x41, 50);
+  AddSvcPacket(0x74, 1, 0, 0, 50);  // Slice extension, dependency layer 1.
+  AddSvcPacket(0x74, 0, 1, 0, 250);  // Quality layer 1, split into FU-A.
+  Packetize(kMaxPayloadLen);
+  const bool kExpected[] = { true, true, true, false, false, false, false,
+                             false, false };
+  ASSERT_EQ(sizeof(kExpected) / sizeof(kExpected[0]), base_layer_.size());
+  for (size_t i = 0; i < base_layer_.size(); ++i) {
+    EXPECT_EQ(kExpected[i], base_layer_[i]) << "packet " << i;
+  }
+}
+
+TEST_F(RtpFormatH264Test, FailsOnLargeAggregationPacket) {
+  AddPacket(0x78, 150);  // STAP-A.
+  BuildFragmentation();
+  RtpFormatH264 packetizer(&data_[0], data_.size(), kMaxPayloadLen,
+                           fragmentation_);
+  WebRtc_UWord8 buffer[1500];
+  int bytes = 0;
+  bool last = false;
+  EXPECT_EQ(-1, packetizer.NextPacket(buffer, &bytes, &last));
+}
+
+TEST_F(RtpFormatH264Test, FailsOnFragmentOutsidePayload) {
+  AddPacket(kNalHeader, 50);
+  BuildFragmentation();
+  fragmentation_.fragmentationLength[0] = data_.size() + 1;
+  RtpFormatH264 packetizer(&data_[0], data_.size(), kMaxPayloadLen,
+                           fragmentation_);
+  WebRtc_UWord8 buffer[1500];
+  int bytes = 0;
+  bool last = false;
+  EXPECT_EQ(-1, packetizer.NextPacket(buffer, &bytes, &last));
+}
+
+}  // namespace webrtc
@@ -11,6 +11,7 @@
 #include "rtp_packet_history.h"
 
 #include <assert.h>
+#include <algorithm>
 #include <cstring>   // memset
 
 #include "critical_section_wrapper.h"
@@ -23,7 +24,7 @@ RTPPacketHistory::RTPPacketHistory(Clock* clock)
   : clock_(clock),
     critsect_(CriticalSectionWrapper::CreateCriticalSection()),
     store_(false),
-    prev_index_(0),
+    index_mask_(0),
     max_packet_length_(0) {
 }
 
@@ -51,12 +52,15 @@ void RTPPacketHistory::Allocate(uint16_t number_to_store) {
   }
 
   store_ = true;
-  stored_packets_.resize(number_to_store);
-  stored_seq_nums_.resize(number_to_store);
-  stored_lengths_.resize(number_to_store);
-  stored_times_.resize(number_to_store);
-  stored_resend_times_.resize(number_to_store);
-  stored_types_.resize(number_to_store);
+  // Round up to a power of two, so that the slot is given by the sequence
+  // number.
+  uint32_t number_of_slots = 1;
+  while (number_of_slots < number_to_store) {
+    number_of_slots <<= 1;
+  }
+  index_mask_ = static_cast<uint16_t>(number_of_slots - 1);
+  const StoredPacket kEmpty = { 0, 0, 0, 0, kDontStore };
+  stored_packets_.assign(number_of_slots, kEmpty);
 }
 
 void RTPPacketHistory::Free() {
@@ -65,20 +69,11 @@ void RTPPacketHistory::Free() {
     return;
   }
 
-  std::vector<std::vector<uint8_t> >::iterator it;
-  for (it = stored_packets_.begin(); it != stored_packets_.end(); ++it) {   
-    it->clear();
-  }
-
-  stored_packets_.clear();
-  stored_seq_nums_.clear();
-  stored_lengths_.clear();
-  stored_times_.clear();
-  stored_resend_times_.clear();
-  stored_types_.clear();
+  std::vector<StoredPacket>().swap(stored_packets_);
+  std::vector<uint8_t>().swap(buffer_);
 
   store_ = false;
-  prev_index_ = 0;
+  index_mask_ = 0;
   max_packet_length_ = 0;
 }
 
@@ -98,10 +93,16 @@ void RTPPacketHistory::VerifyAndAllocatePacketLength(uint16_t packet_length) {
     return;
   }
 
-  std::vector<std::vector<uint8_t> >::iterator it;
-  for (it = stored_packets_.begin(); it != stored_packets_.end(); ++it) {
-    it->resize(packet_length);
+  // Move the stored packets to the new stride.
+  std::vector<uint8_t> buffer(stored_packets_.size() * packet_length);
+  for (size_t i = 0; i < stored_packets_.size(); ++i) {
+    const uint16_t length = stored_packets_[i].length;
+    if (length > 0) {
+      const uint8_t* packet = PacketBuffer(static_cast<int32_t>(i));
+      std::copy(packet, packet + length, &buffer[i * packet_length]);
+    }
   }
+  buffer_.swap(buffer);
   max_packet_length_ = packet_length;
 }
 
@@ -131,23 +132,18 @@ int32_t RTPPacketHistory::PutRTPPacket(const uint8_t* packet,
   }
 
   const uint16_t seq_num = (packet[2] << 8) + packet[3];
+  const int32_t index = seq_num & index_mask_;
 
-  // Store packet
-  std::vector<std::vector<uint8_t> >::iterator it =
-      stored_packets_.begin() + prev_index_;
-  std::copy(packet, packet + packet_length, it->begin());
+  // Store packet, replacing the one sent number of slots packets ago.
+  std::copy(packet, packet + packet_length, PacketBuffer(index));
 
-  stored_seq_nums_[prev_index_] = seq_num;
-  stored_lengths_[prev_index_] = packet_length;
-  stored_times_[prev_index_] =
+  StoredPacket& stored_packet = stored_packets_[index];
+  stored_packet.sequence_number = seq_num;
+  stored_packet.length = packet_length;
+  stored_packet.time_ms =
       (capture_time_ms > 0) ? capture_time_ms : clock_->TimeInMilliseconds();
-  stored_resend_times_[prev_index_] = 0;  // packet not resent
-  stored_types_[prev_index_] = type;
-
-  ++prev_index_;
-  if (prev_index_ >= stored_seq_nums_.size()) {
-    prev_index_ = 0;
-  }
+  stored_packet.resend_time_ms = 0;  // packet not resent
+  stored_packet.type = type;
   return 0;
 }
 
@@ -176,18 +172,16 @@ int32_t RTPPacketHistory::ReplaceRTPHeader(const uint8_t* packet,
     return -1;
   }
 
-  uint16_t length = stored_lengths_.at(index);
+  uint16_t length = stored_packets_[index].length;
   if (length == 0 || length > max_packet_length_) {
     WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1,
         "No match for getting seqNum %u, len %d", sequence_number, length);
     return -1;
   }
-  assert(stored_seq_nums_[index] == sequence_number);
+  assert(stored_packets_[index].sequence_number == sequence_number);
 
   // Update RTP header.
-  std::vector<std::vector<uint8_t> >::iterator it =
-      stored_packets_.begin() + index;
-  std::copy(packet, packet + rtp_header_length, it->begin());
+  std::copy(packet, packet + rtp_header_length, PacketBuffer(index));
   return 0;
 }
 
@@ -203,7 +197,7 @@ bool RTPPacketHistory::HasRTPPacket(uint16_t sequence_number) const {
     return false;
   }
  
-  uint16_t length = stored_lengths_.at(index);
+  uint16_t length = stored_packets_[index].length;
   if (length == 0 || length > max_packet_length_) {
     // Invalid length.
     return false;
@@ -230,7 +224,8 @@ bool RTPPacketHistory::GetRTPPacket(uint16_t sequence_number,
     return false;
   }
 
-  uint16_t length = stored_lengths_.at(index);
+  const StoredPacket& stored_packet = stored_packets_[index];
+  uint16_t length = stored_packet.length;
   if (length == 0 || length > max_packet_length_) {
     WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1,
         "No match for getting seqNum %u, len %d", sequence_number, length);
@@ -246,7 +241,7 @@ bool RTPPacketHistory::GetRTPPacket(uint16_t sequence_number,
   // Verify elapsed time since last retrieve. 
   int64_t now = clock_->TimeInMilliseconds();
   if (min_elapsed_time_ms > 0 &&
-      ((now - stored_resend_times_.at(index)) < min_elapsed_time_ms)) {
+      ((now - stored_packet.resend_time_ms) < min_elapsed_time_ms)) {
     WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1, 
         "Skip getting packet %u, packet recently resent.", sequence_number);
     *packet_length = 0;
@@ -254,12 +249,11 @@ bool RTPPacketHistory::GetRTPPacket(uint16_t sequence_number,
   }
 
   // Get packet.
-  std::vector<std::vector<uint8_t> >::const_iterator it_found_packet =
-      stored_packets_.begin() + index;
-  std::copy(it_found_packet->begin(), it_found_packet->begin() + length, packet);
-  *packet_length = stored_lengths_.at(index);
-  *stored_time_ms = stored_times_.at(index);
-  *type = stored_types_.at(index);
+  const uint8_t* stored_buffer = PacketBuffer(index);
+  std::copy(stored_buffer, stored_buffer + length, packet);
+  *packet_length = length;
+  *stored_time_ms = stored_packet.time_ms;
+  *type = stored_packet.type;
   return true;
 }
 
@@ -276,41 +270,58 @@ void RTPPacketHistory::UpdateResendTime(uint16_t sequence_number) {
         "Failed to update resend time, seq num: %u.", sequence_number);
     return;
   }
-  stored_resend_times_[index] = clock_->TimeInMilliseconds();
+  stored_packets_[index].resend_time_ms = clock_->TimeInMilliseconds();
 }
 
-// private, lock should already be taken
-bool RTPPacketHistory::FindSeqNum(uint16_t sequence_number,
-                                  int32_t* index) const {
-  uint16_t temp_sequence_number = 0;
-  if (prev_index_ > 0) {
-    *index = prev_index_ - 1;
-    temp_sequence_number = stored_seq_nums_[*index];
-  } else {
-    *index = stored_seq_nums_.size() - 1;
-    temp_sequence_number = stored_seq_nums_[*index];  // wrap
-  }
-
-  int32_t idx = (prev_index_ - 1) - (temp_sequence_number - sequence_number);
-  if (idx >= 0 && idx < static_cast<int>(stored_seq_nums_.size())) {
-    *index = idx;
-    temp_sequence_number = stored_seq_nums_[*index];
+uint32_t RTPPacketHistory::ResendPackets(
+    const std::list<uint16_t>& sequence_numbers,
+    uint32_t min_elapsed_time_ms,
+    uint32_t max_bytes,
+    RtpPacketResender* resender) {
+  CriticalSectionScoped cs(critsect_);
+  if (!store_) {
+    return 0;
   }
 
-  if (temp_sequence_number != sequence_number) {
-    // We did not found a match, search all.
-    for (uint16_t m = 0; m < stored_seq_nums_.size(); m++) {
-      if (stored_seq_nums_[m] == sequence_number) {
-        *index = m;
-        temp_sequence_number = stored_seq_nums_[*index];
-        break;
-      }
+  const int64_t now = clock_->TimeInMilliseconds();
+  uint32_t bytes_resent = 0;
+  for (std::list<uint16_t>::const_iterator it = sequence_numbers.begin();
+       it != sequence_numbers.end(); ++it) {
+    int32_t index = 0;
+    if (!FindSeqNum(*it, &index)) {
+      continue;
+    }
+    StoredPacket& stored_packet = stored_packets_[index];
+    if (stored_packet.type == kDontRetransmit ||
+        (min_elapsed_time_ms > 0 &&
+         now - stored_packet.resend_time_ms < min_elapsed_time_ms)) {
+      continue;
+    }
+    const int32_t bytes_sent = resender->ResendStoredPacket(
+        PacketBuffer(index), stored_packet.length);
+    if (bytes_sent < 0) {
+      WEBRTC_TRACE(kTraceWarning, kTraceRtpRtcp, -1,
+          "Failed resending RTP packet %u, discard rest of packets", *it);
+      break;
+    }
+    if (bytes_sent == 0) {
+      continue;
+    }
+    stored_packet.resend_time_ms = now;
+    bytes_resent += bytes_sent;
+    if (max_bytes > 0 && bytes_resent > max_bytes) {
+      break;  // Ignore the rest of the packets in the list.
     }
   }
-  if (temp_sequence_number == sequence_number) {
-    // We found a match.
-    return true;
-  }
-  return false;
+  return bytes_resent;
+}
+
+// private, lock should already be taken
+bool RTPPacketHistory::FindSeqNum(uint16_t sequence_number,
+                                  int32_t* index) const {
+  *index = sequence_number & index_mask_;
+  const StoredPacket& stored_packet = stored_packets_[*index];
+  return stored_packet.length > 0 &&
+         stored_packet.sequence_number == sequence_number;
 }
 }  // namespace webrtc
@@ -13,6 +13,7 @@
 #ifndef WEBRTC_MODULES_RTP_RTCP_RTP_PACKET_HISTORY_H_
 #define WEBRTC_MODULES_RTP_RTCP_RTP_PACKET_HISTORY_H_
 
+#include <list>
 #include <vector>
 
 #include "module_common_types.h"
@@ -24,6 +25,22 @@ namespace webrtc {
 class Clock;
 class CriticalSectionWrapper;
 
+// Resends the packets of a NACK list, see RTPPacketHistory::ResendPackets().
+class RtpPacketResender {
+ public:
+  // Resends a stored packet. |packet| points into the history, which is
+  // locked during the call. Returns the number of bytes sent, 0 if nothing
+  // was sent, or -1 to give up on the rest of the list.
+  virtual int32_t ResendStoredPacket(const uint8_t* packet,
+                                     uint16_t packet_length) = 0;
+
+ protected:
+  virtual ~RtpPacketResender() {}
+};
+
+// Stores the most recently sent packets for retransmission, in a ring
+// indexed by sequence number. The ring holds a power of two packets, at
+// least as many as requested, in one contiguous buffer.
 class RTPPacketHistory {
  public:
   RTPPacketHistory(Clock* clock);
@@ -70,25 +87,51 @@ class RTPPacketHistory {
 
   void UpdateResendTime(uint16_t sequence_number);
 
+  // Resends the stored packets in |sequence_numbers| through |resender|
+  // without copying them, locking the history once for the whole list.
+  // Packets that aren't stored, mustn't be retransmitted or were resent less
+  // than |min_elapsed_time_ms| ago are skipped. Stops when |resender| fails,
+  // or once more than |max_bytes| have been resent if |max_bytes| is
+  // non-zero. Updates the resend time of each resent packet.
+  // Returns the number of bytes resent.
+  uint32_t ResendPackets(const std::list<uint16_t>& sequence_numbers,
+                         uint32_t min_elapsed_time_ms,
+                         uint32_t max_bytes,
+                         RtpPacketResender* resender);
+
  private:
+  struct StoredPacket {
+    uint16_t sequence_number;
+    // Zero if the slot is empty.
+    uint16_t length;
+    int64_t time_ms;
+    int64_t resend_time_ms;
+    StorageType type;
+  };
+
   void Allocate(uint16_t number_to_store);
   void Free();
   void VerifyAndAllocatePacketLength(uint16_t packet_length);
   bool FindSeqNum(uint16_t sequence_number, int32_t* index) const;
+  uint8_t* PacketBuffer(int32_t index) {
+    return &buffer_[index * max_packet_length_];
+  }
+  const uint8_t* PacketBuffer(int32_t index) const {
+    return &buffer_[index * max_packet_length_];
+  }
 
  private:
   Clock* clock_;
   CriticalSectionWrapper* critsect_;
   bool store_;
-  uint32_t prev_index_;
+  // The number of slots minus one. Packets are stored at the slot given by
+  // the lowest bits of their sequence number.
+  uint16_t index_mask_;
   uint16_t max_packet_length_;
 
-  std::vector<std::vector<uint8_t> > stored_packets_;
-  std::vector<uint16_t> stored_seq_nums_;
-  std::vector<uint16_t> stored_lengths_;
-  std::vector<int64_t> stored_times_;
-  std::vector<int64_t> stored_resend_times_;
-  std::vector<StorageType> stored_types_;
+  std::vector<StoredPacket> stored_packets_;
+  // |max_packet_length_| bytes for each slot.
+  std::vector<uint8_t> buffer_;
 };
 }  // namespace webrtc
 #endif  // WEBRTC_MODULES_RTP_RTCP_RTP_PACKET_HISTORY_H_
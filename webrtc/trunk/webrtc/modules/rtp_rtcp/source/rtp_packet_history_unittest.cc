@@ -12,13 +12,37 @@
 
 #include <gtest/gtest.h>
 
+#include <list>
+#include <vector>
+
 #include "clock.h"
 #include "rtp_packet_history.h"
 #include "rtp_rtcp_defines.h"
+#include "test/testsupport/perf_test.h"
+#include "tick_util.h"
 #include "typedefs.h"
 
 namespace webrtc {
 
+// Records the sequence numbers of the resent packets.
+class FakeResender : public RtpPacketResender {
+ public:
+  FakeResender() : fail_sequence_number_(-1) {}
+
+  virtual int32_t ResendStoredPacket(const uint8_t* packet,
+                                     uint16_t packet_length) {
+    const uint16_t sequence_number = (packet[2] << 8) + packet[3];
+    if (sequence_number == fail_sequence_number_) {
+      return -1;
+    }
+    resent_.push_back(sequence_number);
+    return packet_length;
+  }
+
+  int fail_sequence_number_;
+  std::vector<uint16_t> resent_;
+};
+
 class RtpPacketHistoryTest : public ::testing::Test {
  protected:
   RtpPacketHistoryTest()
@@ -260,4 +284,156 @@ TEST_F(RtpPacketHistoryTest, MinResendTime) {
   EXPECT_TRUE(hist_->GetRTPPacket(kSeqNum, 101, packet_, &len, &time, &type));
   EXPECT_EQ(0, len);
 }
+
+TEST_F(RtpPacketHistoryTest, StoresPowerOfTwoPackets) {
+  // Rounded up to 16 packets.
+  hist_->SetStorePacketsStatus(true, 10);
+  for (int i = 0; i < 20; ++i) {
+    uint16_t len = 0;
+    CreateRtpPacket(kSeqNum + i, kSsrc, kPayload, kTimestamp, packet_, &len);
+    EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength, -1,
+                                     kAllowRetransmission));
+  }
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_FALSE(hist_->HasRTPPacket(kSeqNum + i));
+  }
+  for (int i = 4; i < 20; ++i) {
+    EXPECT_TRUE(hist_->HasRTPPacket(kSeqNum + i));
+  }
+}
+
+TEST_F(RtpPacketHistoryTest, SequenceNumberWrap) {
+  hist_->SetStorePacketsStatus(true, 10);
+  for (int i = -5; i < 5; ++i) {
+    uint16_t len = 0;
+    CreateRtpPacket(static_cast<uint16_t>(i), kSsrc, kPayload, kTimestamp,
+                    packet_, &len);
+    EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength, -1,
+                                     kAllowRetransmission));
+  }
+  for (int i = -5; i < 5; ++i) {
+    EXPECT_TRUE(hist_->HasRTPPacket(static_cast<uint16_t>(i)));
+  }
+}
+
+TEST_F(RtpPacketHistoryTest, KeepsPacketsWhenMaxLengthGrows) {
+  hist_->SetStorePacketsStatus(true, 10);
+  uint16_t len = 0;
+  CreateRtpPacket(kSeqNum, kSsrc, kPayload, kTimestamp, packet_, &len);
+  EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, 100, -1,
+                                   kAllowRetransmission));
+  uint16_t len2 = 0;
+  CreateRtpPacket(kSeqNum + 1, kSsrc, kPayload, kTimestamp, packet_out_,
+                  &len2);
+  EXPECT_EQ(0, hist_->PutRTPPacket(packet_out_, len2, kMaxPacketLength, -1,
+                                   kAllowRetransmission));
+
+  uint16_t len_out = kMaxPacketLength;
+  int64_t time;
+  StorageType type;
+  EXPECT_TRUE(hist_->GetRTPPacket(kSeqNum, 0, packet_out_, &len_out, &time,
+                                  &type));
+  EXPECT_EQ(len, len_out);
+  for (int i = 0; i < len; i++)  {
+    EXPECT_EQ(packet_[i], packet_out_[i]);
+  }
+}
+
+TEST_F(RtpPacketHistoryTest, ResendPackets) {
+  hist_->SetStorePacketsStatus(true, 10);
+  std::list<uint16_t> nack_list;
+  for (int i = 0; i < 4; ++i) {
+    uint16_t len = 0;
+    CreateRtpPacket(kSeqNum + i, kSsrc, kPayload, kTimestamp, packet_, &len);
+    EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength, -1,
+                                     i == 1 ? kDontRetransmit :
+                                              kAllowRetransmission));
+    nack_list.push_back(kSeqNum + i);
+  }
+  // Not stored.
+  nack_list.push_back(kSeqNum + 4);
+
+  FakeResender resender;
+  EXPECT_EQ(36u, hist_->ResendPackets(nack_list, 100, 0, &resender));
+  ASSERT_EQ(3u, resender.resent_.size());
+  EXPECT_EQ(kSeqNum, resender.resent_[0]);
+  EXPECT_EQ(kSeqNum + 2, resender.resent_[1]);
+  EXPECT_EQ(kSeqNum + 3, resender.resent_[2]);
+
+  // Resent too recently.
+  resender.resent_.clear();
+  fake_clock_.AdvanceTimeMilliseconds(99);
+  EXPECT_EQ(0u, hist_->ResendPackets(nack_list, 100, 0, &resender));
+  EXPECT_TRUE(resender.resent_.empty());
+
+  // Stops at the first failure.
+  fake_clock_.AdvanceTimeMilliseconds(1);
+  resender.fail_sequence_number_ = kSeqNum + 2;
+  EXPECT_EQ(12u, hist_->ResendPackets(nack_list, 100, 0, &resender));
+  ASSERT_EQ(1u, resender.resent_.size());
+  EXPECT_EQ(kSeqNum, resender.resent_[0]);
+
+  // Stops once more than |max_bytes| are resent.
+  resender.resent_.clear();
+  resender.fail_sequence_number_ = -1;
+  EXPECT_EQ(24u, hist_->ResendPackets(nack_list, 0, 12, &resender));
+  EXPECT_EQ(2u, resender.resent_.size());
+}
+
+// Resends bursts of NACKed packets from a history long enough for a high RTT,
+// copying each packet out as the sender used to, and in one batch.
+TEST_F(RtpPacketHistoryTest, NackStorm) {
+  const int kNumPackets = 8192;
+  const int kPacketLength = 1200;
+  const int kNackListLength = 256;
+  const int kNumNacks = 1000;
+  hist_->SetStorePacketsStatus(true, kNumPackets);
+  for (int i = 0; i < kNumPackets; ++i) {
+    uint16_t len = 0;
+    CreateRtpPacket(i, kSsrc, kPayload, kTimestamp, packet_, &len);
+    EXPECT_EQ(0, hist_->PutRTPPacket(packet_, kPacketLength, kMaxPacketLength,
+                                     -1, kAllowRetransmission));
+  }
+  std::list<uint16_t> nack_lists[kNumNacks];
+  for (int n = 0; n < kNumNacks; ++n) {
+    // Every other packet of a burst, spread over the history.
+    const int first = (n * 7919) % (kNumPackets - 2 * kNackListLength);
+    for (int i = 0; i < kNackListLength; ++i) {
+      nack_lists[n].push_back(static_cast<uint16_t>(first + 2 * i));
+    }
+  }
+
+  int64_t start_us = TickTime::MicrosecondTimestamp();
+  int num_copied = 0;
+  for (int n = 0; n < kNumNacks; ++n) {
+    for (std::list<uint16_t>::const_iterator it = nack_lists[n].begin();
+         it != nack_lists[n].end(); ++it) {
+      uint16_t len = kMaxPacketLength;
+      int64_t time;
+      StorageType type;
+      if (hist_->GetRTPPacket(*it, 0, packet_out_, &len, &time, &type)) {
+        hist_->UpdateResendTime(*it);
+        ++num_copied;
+      }
+    }
+  }
+  const int64_t copy_us = TickTime::MicrosecondTimestamp() - start_us;
+
+  FakeResender resender;
+  start_us = TickTime::MicrosecondTimestamp();
+  for (int n = 0; n < kNumNacks; ++n) {
+    hist_->ResendPackets(nack_lists[n], 0, 0, &resender);
+  }
+  const int64_t batch_us = TickTime::MicrosecondTimestamp() - start_us;
+
+  EXPECT_EQ(kNumNacks * kNackListLength, num_copied);
+  EXPECT_EQ(static_cast<size_t>(kNumNacks * kNackListLength),
+            resender.resent_.size());
+  webrtc::test::PrintResult("nack_storm", "_copy", "8192_packets",
+                            static_cast<size_t>(copy_us / kNumNacks),
+                            "us/nack", false);
+  webrtc::test::PrintResult("nack_storm", "_batch", "8192_packets",
+                            static_cast<size_t>(batch_us / kNumNacks),
+                            "us/nack", false);
+}
 }  // namespace webrtc
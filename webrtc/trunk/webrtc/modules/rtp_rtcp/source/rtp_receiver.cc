@@ -54,6 +54,7 @@ RTPReceiver::RTPReceiver(const WebRtc_Word32 id,
       packet_timeout_ms_(0),
 
       rtp_header_extension_map_(),
+      header_extension_map_version_(0),
       ssrc_(0),
       num_csrcs_(0),
       current_remote_csrc_(),
@@ -253,12 +254,14 @@ WebRtc_Word32 RTPReceiver::RegisterRtpHeaderExtension(
     const RTPExtensionType type,
     const WebRtc_UWord8 id) {
   CriticalSectionScoped cs(critical_section_rtp_receiver_);
+  ++header_extension_map_version_;
   return rtp_header_extension_map_.Register(type, id);
 }
 
 WebRtc_Word32 RTPReceiver::DeregisterRtpHeaderExtension(
     const RTPExtensionType type) {
   CriticalSectionScoped cs(critical_section_rtp_receiver_);
+  ++header_extension_map_version_;
   return rtp_header_extension_map_.Deregister(type);
 }
 
@@ -267,6 +270,18 @@ void RTPReceiver::GetHeaderExtensionMapCopy(RtpHeaderExtensionMap* map) const {
   rtp_header_extension_map_.GetCopy(map);
 }
 
+bool RTPReceiver::UpdateHeaderExtensionMap(int* version,
+                                           RtpHeaderExtensionMap* map) const {
+  CriticalSectionScoped cs(critical_section_rtp_receiver_);
+  if (*version == header_extension_map_version_) {
+    return false;
+  }
+  map->Erase();
+  rtp_header_extension_map_.GetCopy(map);
+  *version = header_extension_map_version_;
+  return true;
+}
+
 NACKMethod RTPReceiver::NACK() const {
   CriticalSectionScoped lock(critical_section_rtp_receiver_);
   return nack_method_;
@@ -408,9 +423,14 @@ WebRtc_Word32 RTPReceiver::IncomingRTPPacket(
   WebRtc_UWord16 payload_data_length =
     ModuleRTPUtility::GetPayloadDataLength(rtp_header, packet_length);
 
-  bool is_first_packet_in_frame =
-      SequenceNumber() + 1 == rtp_header->header.sequenceNumber &&
-      TimeStamp() != rtp_header->header.timestamp;
+  bool is_first_packet_in_frame;
+  {
+    CriticalSectionScoped lock(critical_section_rtp_receiver_);
+    is_first_packet_in_frame =
+        last_received_sequence_number_ + 1 ==
+            rtp_header->header.sequenceNumber &&
+        last_received_timestamp_ != rtp_header->header.timestamp;
+  }
   bool is_first_packet = is_first_packet_in_frame || HaveNotReceivedPackets();
 
   WebRtc_Word32 ret_val = rtp_media_receiver_->ParseRtpPacket(
@@ -142,6 +142,11 @@ class RTPReceiver : public Bitrate {
 
   void GetHeaderExtensionMapCopy(RtpHeaderExtensionMap* map) const;
 
+  // Copies the header extension map to |map| if it has changed since
+  // |*version|, which is then updated. Returns true if |map| was updated.
+  bool UpdateHeaderExtensionMap(int* version,
+                                RtpHeaderExtensionMap* map) const;
+
   // RTX.
   void SetRTXStatus(const bool enable, const WebRtc_UWord32 ssrc);
 
@@ -189,6 +194,8 @@ class RTPReceiver : public Bitrate {
   WebRtc_UWord32          packet_timeout_ms_;
 
   RtpHeaderExtensionMap   rtp_header_extension_map_;
+  // Bumped each time an extension is registered or deregistered.
+  int                     header_extension_map_version_;
 
   // SSRCs.
   WebRtc_UWord32            ssrc_;
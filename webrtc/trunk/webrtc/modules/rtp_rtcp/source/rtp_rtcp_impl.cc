@@ -11,6 +11,7 @@
 #include "webrtc/modules/rtp_rtcp/source/rtp_rtcp_impl.h"
 
 #include <string.h>
+#include <algorithm>
 #include <cassert>
 
 #include "webrtc/common_types.h"
@@ -112,6 +113,9 @@ ModuleRtpRtcpImpl::ModuleRtpRtcpImpl(const Configuration& configuration)
           CriticalSectionWrapper::CreateCriticalSection()),
       critical_section_module_ptrs_feedback_(
           CriticalSectionWrapper::CreateCriticalSection()),
+      critical_section_receive_(
+          CriticalSectionWrapper::CreateCriticalSection()),
+      receive_extension_map_version_(-1),
       default_module_(
           static_cast<ModuleRtpRtcpImpl*>(configuration.default_module)),
       dead_or_alive_active_(false),
@@ -554,6 +558,76 @@ WebRtc_Word32 ModuleRtpRtcpImpl::IncomingPacket(
                id_,
                "IncomingPacket(packet_length:%u)",
                incoming_packet_length);
+  WebRtcRTPHeader rtp_header;
+  bool is_rtcp = false;
+  {
+    CriticalSectionScoped lock(critical_section_receive_.get());
+    rtp_receiver_->UpdateHeaderExtensionMap(&receive_extension_map_version_,
+                                            &receive_extension_map_);
+    if (!ParseIncomingPacket(incoming_packet, incoming_packet_length,
+                             &rtp_header, &is_rtcp)) {
+      return -1;
+    }
+  }
+  return DeliverIncomingPacket(incoming_packet, incoming_packet_length,
+                               is_rtcp, &rtp_header);
+}
+
+int ModuleRtpRtcpImpl::IncomingPackets(
+    const WebRtc_UWord8* const* incoming_packets,
+    const WebRtc_UWord16* packet_lengths,
+    const int num_packets) {
+  WEBRTC_TRACE(kTraceStream,
+               kTraceRtpRtcp,
+               id_,
+               "IncomingPackets(num_packets:%d)",
+               num_packets);
+  if (num_packets < 0 ||
+      (num_packets > 0 &&
+       (incoming_packets == NULL || packet_lengths == NULL))) {
+    WEBRTC_TRACE(kTraceDebug,
+                 kTraceRtpRtcp,
+                 id_,
+                 "IncomingPackets invalid buffers or count");
+    return -1;
+  }
+  // The headers of up to kMaxBatch packets are parsed under one lock, then
+  // the packets are delivered in order.
+  enum { kMaxBatch = 32 };
+  WebRtcRTPHeader rtp_headers[kMaxBatch];
+  bool is_rtcp[kMaxBatch];
+  bool valid[kMaxBatch];
+  int accepted = 0;
+  for (int start = 0; start < num_packets; start += kMaxBatch) {
+    const int count = std::min(num_packets - start,
+                               static_cast<int>(kMaxBatch));
+    {
+      CriticalSectionScoped lock(critical_section_receive_.get());
+      rtp_receiver_->UpdateHeaderExtensionMap(&receive_extension_map_version_,
+                                              &receive_extension_map_);
+      for (int i = 0; i < count; ++i) {
+        valid[i] = ParseIncomingPacket(incoming_packets[start + i],
+                                       packet_lengths[start + i],
+                                       &rtp_headers[i], &is_rtcp[i]);
+      }
+    }
+    for (int i = 0; i < count; ++i) {
+      if (valid[i] &&
+          DeliverIncomingPacket(incoming_packets[start + i],
+                                packet_lengths[start + i], is_rtcp[i],
+                                &rtp_headers[i]) >= 0) {
+        ++accepted;
+      }
+    }
+  }
+  return accepted;
+}
+
+bool ModuleRtpRtcpImpl::ParseIncomingPacket(
+    const WebRtc_UWord8* incoming_packet,
+    const WebRtc_UWord16 incoming_packet_length,
+    WebRtcRTPHeader* rtp_header,
+    bool* is_rtcp) {
   // Minimum RTP is 12 bytes.
   // Minimum RTCP is 8 bytes (RTCP BYE).
   if (incoming_packet_length < 8 || incoming_packet == NULL) {
@@ -561,7 +635,7 @@ WebRtc_Word32 ModuleRtpRtcpImpl::IncomingPacket(
                  kTraceRtpRtcp,
                  id_,
                  "IncomingPacket invalid buffer or length");
-    return -1;
+    return false;
   }
   // Check RTP version.
   const WebRtc_UWord8 version = incoming_packet[0] >> 6;
@@ -570,13 +644,33 @@ WebRtc_Word32 ModuleRtpRtcpImpl::IncomingPacket(
                  kTraceRtpRtcp,
                  id_,
                  "IncomingPacket invalid RTP version");
-    return -1;
+    return false;
   }
 
   ModuleRTPUtility::RTPHeaderParser rtp_parser(incoming_packet,
                                                incoming_packet_length);
+  *is_rtcp = rtp_parser.RTCP();
+  if (*is_rtcp) {
+    // The RTCP parser validates the packet when it's delivered.
+    return true;
+  }
+  memset(rtp_header, 0, sizeof(*rtp_header));
+  if (!rtp_parser.Parse(*rtp_header, &receive_extension_map_)) {
+    WEBRTC_TRACE(kTraceDebug,
+                 kTraceRtpRtcp,
+                 id_,
+                 "IncomingPacket invalid RTP header");
+    return false;
+  }
+  return true;
+}
 
-  if (rtp_parser.RTCP()) {
+WebRtc_Word32 ModuleRtpRtcpImpl::DeliverIncomingPacket(
+    const WebRtc_UWord8* incoming_packet,
+    const WebRtc_UWord16 incoming_packet_length,
+    const bool is_rtcp,
+    WebRtcRTPHeader* rtp_header) {
+  if (is_rtcp) {
     // Allow receive of non-compound RTCP packets.
     RTCPUtility::RTCPParserV2 rtcp_parser(incoming_packet,
                                           incoming_packet_length,
@@ -597,26 +691,10 @@ WebRtc_Word32 ModuleRtpRtcpImpl::IncomingPacket(
       rtcp_receiver_.TriggerCallbacksFromRTCPPacket(rtcp_packet_information);
     }
     return ret_val;
-
-  } else {
-    WebRtcRTPHeader rtp_header;
-    memset(&rtp_header, 0, sizeof(rtp_header));
-
-    RtpHeaderExtensionMap map;
-    rtp_receiver_->GetHeaderExtensionMapCopy(&map);
-
-    const bool valid_rtpheader = rtp_parser.Parse(rtp_header, &map);
-    if (!valid_rtpheader) {
-      WEBRTC_TRACE(kTraceDebug,
-                   kTraceRtpRtcp,
-                   id_,
-                   "IncomingPacket invalid RTP header");
-      return -1;
-    }
-    return rtp_receiver_->IncomingRTPPacket(&rtp_header,
-                                            incoming_packet,
-                                            incoming_packet_length);
   }
+  return rtp_receiver_->IncomingRTPPacket(rtp_header,
+                                          incoming_packet,
+                                          incoming_packet_length);
 }
 
 WebRtc_Word32 ModuleRtpRtcpImpl::RegisterSendPayload(
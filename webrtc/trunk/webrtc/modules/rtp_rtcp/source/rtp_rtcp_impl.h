@@ -110,6 +110,10 @@ class ModuleRtpRtcpImpl : public RtpRtcp {
   virtual WebRtc_Word32 IncomingPacket(const WebRtc_UWord8* incoming_packet,
                                        const WebRtc_UWord16 packet_length);
 
+  virtual int IncomingPackets(const WebRtc_UWord8* const* incoming_packets,
+                              const WebRtc_UWord16* packet_lengths,
+                              const int num_packets);
+
   // Sender part.
 
   virtual WebRtc_Word32 RegisterSendPayload(const CodecInst& voice_codec);
@@ -482,6 +486,21 @@ class ModuleRtpRtcpImpl : public RtpRtcp {
  private:
   int64_t RtcpReportInterval();
 
+  // Checks an incoming packet and parses its RTP header into |rtp_header|,
+  // using |receive_extension_map_|. Must be called with
+  // |critical_section_receive_| held.
+  bool ParseIncomingPacket(const WebRtc_UWord8* incoming_packet,
+                           const WebRtc_UWord16 packet_length,
+                           WebRtcRTPHeader* rtp_header,
+                           bool* is_rtcp);
+
+  // Hands a packet checked by ParseIncomingPacket() to the RTP or RTCP
+  // receiver.
+  WebRtc_Word32 DeliverIncomingPacket(const WebRtc_UWord8* incoming_packet,
+                                      const WebRtc_UWord16 packet_length,
+                                      const bool is_rtcp,
+                                      WebRtcRTPHeader* rtp_header);
+
   RTPReceiverAudio*         rtp_telephone_event_handler_;
 
   WebRtc_Word32             id_;
@@ -495,6 +514,11 @@ class ModuleRtpRtcpImpl : public RtpRtcp {
 
   scoped_ptr<CriticalSectionWrapper> critical_section_module_ptrs_;
   scoped_ptr<CriticalSectionWrapper> critical_section_module_ptrs_feedback_;
+  // Protects the copy of the receive header extension map, which is only
+  // refreshed when the RTP receiver's map changes.
+  scoped_ptr<CriticalSectionWrapper> critical_section_receive_;
+  RtpHeaderExtensionMap     receive_extension_map_;
+  int                       receive_extension_map_version_;
   ModuleRtpRtcpImpl*            default_module_;
   std::list<ModuleRtpRtcpImpl*> child_modules_;
 
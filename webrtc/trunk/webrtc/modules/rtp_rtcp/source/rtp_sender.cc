@@ -422,7 +422,6 @@ WebRtc_Word32 RTPSender::ReSendPacket(WebRtc_UWord16 packet_id,
                                       WebRtc_UWord32 min_resend_time) {
   WebRtc_UWord16 length = IP_PACKET_SIZE;
   WebRtc_UWord8 data_buffer[IP_PACKET_SIZE];
-  WebRtc_UWord8 *buffer_to_send_ptr = data_buffer;
 
   int64_t stored_time_in_ms;
   StorageType type;
@@ -438,20 +437,32 @@ WebRtc_Word32 RTPSender::ReSendPacket(WebRtc_UWord16 packet_id,
     // packet should not be retransmitted.
     return 0;
   }
+  WebRtc_Word32 bytes_sent = ResendStoredPacket(data_buffer, length);
+  if (bytes_sent <= 0) {
+    return -1;
+  }
+  // Store the time when the packet was last resent.
+  packet_history_->UpdateResendTime(packet_id);
+  return bytes_sent;
+}
+
+int32_t RTPSender::ResendStoredPacket(const uint8_t* packet,
+                                      uint16_t packet_length) {
+  const WebRtc_UWord8 *buffer_to_send_ptr = packet;
+  WebRtc_UWord16 length = packet_length;
   WebRtc_UWord8 data_buffer_rtx[IP_PACKET_SIZE];
   if (rtx_) {
     buffer_to_send_ptr = data_buffer_rtx;
 
     CriticalSectionScoped cs(send_critsect_);
     // Add RTX header.
-    ModuleRTPUtility::RTPHeaderParser rtp_parser(
-        reinterpret_cast<const WebRtc_UWord8 *>(data_buffer), length);
+    ModuleRTPUtility::RTPHeaderParser rtp_parser(packet, packet_length);
 
     WebRtcRTPHeader rtp_header;
     rtp_parser.Parse(rtp_header);
 
     // Add original RTP header.
-    memcpy(data_buffer_rtx, data_buffer, rtp_header.header.headerLength);
+    memcpy(data_buffer_rtx, packet, rtp_header.header.headerLength);
 
     // Replace sequence number.
     WebRtc_UWord8 *ptr = data_buffer_rtx + 2;
@@ -468,18 +479,17 @@ WebRtc_Word32 RTPSender::ReSendPacket(WebRtc_UWord16 packet_id,
     ptr += 2;
 
     // Add original payload data.
-    memcpy(ptr, data_buffer + rtp_header.header.headerLength,
+    memcpy(ptr, packet + rtp_header.header.headerLength,
            length - rtp_header.header.headerLength);
     length += 2;
   }
   WebRtc_Word32 bytes_sent = ReSendToNetwork(buffer_to_send_ptr, length);
   if (bytes_sent <= 0) {
     WEBRTC_TRACE(kTraceWarning, kTraceRtpRtcp, id_,
-                 "Transport failed to resend packet_id %u", packet_id);
+                 "Transport failed to resend packet_id %u",
+                 (packet[2] << 8) + packet[3]);
     return -1;
   }
-  // Store the time when the packet was last resent.
-  packet_history_->UpdateResendTime(packet_id);
   return bytes_sent;
 }
 
@@ -527,32 +537,18 @@ void RTPSender::OnReceivedNACK(
     return;
   }
 
-  for (std::list<uint16_t>::const_iterator it = nack_sequence_numbers.begin();
-      it != nack_sequence_numbers.end(); ++it) {
-    const WebRtc_Word32 bytes_sent = ReSendPacket(*it, 5 + avg_rtt);
-    if (bytes_sent > 0) {
-      bytes_re_sent += bytes_sent;
-    } else if (bytes_sent == 0) {
-      // The packet has previously been resent.
-      // Try resending next packet in the list.
-      continue;
-    } else if (bytes_sent < 0) {
-      // Failed to send one Sequence number. Give up the rest in this nack.
-      WEBRTC_TRACE(kTraceWarning, kTraceRtpRtcp, id_,
-                   "Failed resending RTP packet %d, Discard rest of packets",
-                   *it);
-      break;
-    }
-    // Delay bandwidth estimate (RTT * BW).
-    if (target_send_bitrate_ != 0 && avg_rtt) {
-      // kbits/s * ms = bits => bits/8 = bytes
-      WebRtc_UWord32 target_bytes =
-          (static_cast<WebRtc_UWord32>(target_send_bitrate_) * avg_rtt) >> 3;
-      if (bytes_re_sent > target_bytes) {
-        break;  // Ignore the rest of the packets in the list.
-      }
-    }
+  // Delay bandwidth estimate (RTT * BW).
+  WebRtc_UWord32 target_bytes = 0;
+  if (target_send_bitrate_ != 0 && avg_rtt) {
+    // kbits/s * ms = bits => bits/8 = bytes
+    target_bytes =
+        (static_cast<WebRtc_UWord32>(target_send_bitrate_) * avg_rtt) >> 3;
   }
+  // Packets resent less than an RTT ago are skipped, and the rest of the
+  // list is given up if a packet fails to be sent.
+  bytes_re_sent = packet_history_->ResendPackets(nack_sequence_numbers,
+                                                 5 + avg_rtt, target_bytes,
+                                                 this);
   if (bytes_re_sent > 0) {
     // TODO(pwestin) consolidate these two methods.
     UpdateNACKBitRate(bytes_re_sent, now);
@@ -802,61 +798,7 @@ WebRtc_Word32 RTPSender::BuildRTPheader(
   }
   return rtp_header_length;
 }
-#ifndef GXH_TEST_H264
-WebRtc_Word32
-RTPSender::BuildRTPheaderH264( WebRtc_UWord8 *data_buffer, const WebRtc_Word8 payload_type,
-    const bool marker_bit, const WebRtc_UWord32 capture_time_stamp,
-    const bool time_stamp_provided, const bool inc_sequence_number)
-{
-     assert(payload_type >= 0);
-	
-    CriticalSectionScoped cs(send_critsect_);
 
-	//data_buffer[1] = static_cast<WebRtc_UWord8>(payload_type);
-#ifdef GXH_TEST
-    dataBuffer[0] = static_cast<WebRtc_UWord8>(0x80);            // version 2
-    dataBuffer[1] = static_cast<WebRtc_UWord8>(payloadType);
-    if (markerBit)
-    {
-        dataBuffer[1] |= kRtpMarkerBitMask;  // MarkerBit is set
-    }
-#endif
-    if (time_stamp_provided) {
-		time_stamp_ = start_time_stamp_ + capture_time_stamp;
-	} else {
-		// Make a unique time stamp.
-		// We can't inc by the actual time, since then we increase the risk of back
-		// timing.
-		time_stamp_++;
-	}
-	
-	ModuleRTPUtility::AssignUWord16ToBuffer(data_buffer + 2, sequence_number_);
-	ModuleRTPUtility::AssignUWord32ToBuffer(data_buffer + 4, time_stamp_);
-	ModuleRTPUtility::AssignUWord32ToBuffer(data_buffer + 8, ssrc_);
-	WebRtc_Word32 rtp_header_length = 12;
-
-    // Add the CSRCs if any.
-  if (include_csrcs_ && csrcs_ > 0) {
-    if (csrcs_ > kRtpCsrcSize) {
-      // error
-      assert(false);
-      return -1;
-    }
-    WebRtc_UWord8 *ptr = &data_buffer[rtp_header_length];
-    for (WebRtc_UWord32 i = 0; i < csrcs_; ++i) {
-      ModuleRTPUtility::AssignUWord32ToBuffer(ptr, csrc_[i]);
-      ptr += 4;
-    }
-    data_buffer[0] = (data_buffer[0] & 0xf0) | csrcs_;
-
-    // Update length of header.
-    rtp_header_length += sizeof(WebRtc_UWord32) * csrcs_;
-  }
-     sequence_number_++; // prepare for next packet
-
-    return rtp_header_length;
-}
-#endif
 WebRtc_UWord16 RTPSender::BuildRTPHeaderExtension(
     WebRtc_UWord8 *data_buffer) const {
   if (rtp_header_extension_map_.Size() <= 0) {
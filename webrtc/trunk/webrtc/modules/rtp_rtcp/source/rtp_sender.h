@@ -19,6 +19,7 @@
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
 #include "webrtc/modules/rtp_rtcp/source/bitrate.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_header_extension.h"
+#include "webrtc/modules/rtp_rtcp/source/rtp_packet_history.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_rtcp_config.h"
 #include "webrtc/modules/rtp_rtcp/source/ssrc_database.h"
 #include "webrtc/modules/rtp_rtcp/source/video_codec_information.h"
@@ -29,7 +30,6 @@ namespace webrtc {
 
 class CriticalSectionWrapper;
 class PacedSender;
-class RTPPacketHistory;
 class RTPSenderAudio;
 class RTPSenderVideo;
 
@@ -46,14 +46,6 @@ class RTPSenderInterface {
       const bool marker_bit, const WebRtc_UWord32 capture_time_stamp,
       const bool time_stamp_provided = true,
       const bool inc_sequence_number = true) = 0;
-#ifndef GXH_TEST_H264
-	virtual WebRtc_Word32 BuildRTPheaderH264(WebRtc_UWord8* dataBuffer,
-									   const WebRtc_Word8 payloadType,
-									   const bool markerBit,
-									   const WebRtc_UWord32 captureTimeStamp,
-									   const bool timeStampProvided = true,
-									   const bool incSequenceNumber = true) = 0;
-#endif
   virtual WebRtc_UWord16 RTPHeaderLength() const = 0;
   virtual WebRtc_UWord16 IncrementSequenceNumber() = 0;
   virtual WebRtc_UWord16 SequenceNumber() const = 0;
@@ -67,7 +59,8 @@ class RTPSenderInterface {
       int64_t capture_time_ms, StorageType storage) = 0;
 };
 
-class RTPSender : public Bitrate, public RTPSenderInterface {
+class RTPSender : public Bitrate, public RTPSenderInterface,
+                  public RtpPacketResender {
  public:
   RTPSender(const WebRtc_Word32 id, const bool audio, Clock *clock,
             Transport *transport, RtpAudioFeedback *audio_feedback,
@@ -180,6 +173,11 @@ class RTPSender : public Bitrate, public RTPSenderInterface {
   WebRtc_Word32 ReSendToNetwork(const WebRtc_UWord8 *packet,
                                 const WebRtc_UWord32 size);
 
+  // Implements RtpPacketResender. Resends a stored packet, wrapped in an RTX
+  // packet if RTX is enabled.
+  virtual int32_t ResendStoredPacket(const uint8_t* packet,
+                                     uint16_t packet_length);
+
   bool ProcessNACKBitRate(const WebRtc_UWord32 now);
 
   // RTX.
@@ -194,14 +192,6 @@ class RTPSender : public Bitrate, public RTPSenderInterface {
       const bool marker_bit, const WebRtc_UWord32 capture_time_stamp,
       const bool time_stamp_provided = true,
       const bool inc_sequence_number = true);
-#ifndef GXH_TEST_H264
-	virtual WebRtc_Word32 BuildRTPheaderH264(WebRtc_UWord8* dataBuffer,
-                                       const WebRtc_Word8 payloadType,
-                                       const bool markerBit,
-                                       const WebRtc_UWord32 captureTimeStamp,
-                                       const bool timeStampProvided = true,
-                                       const bool incSequenceNumber = true);
-#endif
   virtual WebRtc_UWord16 RTPHeaderLength() const;
   virtual WebRtc_UWord16 IncrementSequenceNumber();
   virtual WebRtc_UWord16 MaxPayloadLength() const;
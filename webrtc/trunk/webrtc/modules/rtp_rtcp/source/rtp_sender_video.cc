@@ -20,6 +20,7 @@
 #include <cstdlib>  // srand
 
 #include "producer_fec.h"
+#include "rtp_format_h264.h"
 #include "rtp_format_vp8.h"
 
 namespace webrtc {
@@ -493,67 +494,55 @@ RTPSenderVideo::SendVP8(const FrameType frameType,
 
 WebRtc_Word32
 RTPSenderVideo::SendH264(const FrameType frameType,
-                        const WebRtc_Word8 payloadType,
-                        const WebRtc_UWord32 captureTimeStamp,
-						int64_t capture_time_ms,
-                        const WebRtc_UWord8* payloadData,
-                        const WebRtc_UWord32 payloadSize,
-                        const RTPFragmentationHeader* fragmentation,
-                        const RTPVideoTypeHeader* rtpTypeHdr)
+                         const WebRtc_Word8 payloadType,
+                         const WebRtc_UWord32 captureTimeStamp,
+                         int64_t capture_time_ms,
+                         const WebRtc_UWord8* payloadData,
+                         const WebRtc_UWord32 payloadSize,
+                         const RTPFragmentationHeader* fragmentation,
+                         const RTPVideoTypeHeader* rtpTypeHdr)
 {
-//    const WebRtc_UWord16 rtpHeaderLength = _rtpSender.RTPHeaderLength();
-
-    //WebRtc_Word32 payloadBytesToSend = payloadSize;
-    //const WebRtc_UWord8* data = payloadData;
+    const WebRtc_UWord16 rtpHeaderLength = _rtpSender.RTPHeaderLength();
 
-    //WebRtc_UWord16 maxPayloadLengthVP8 = _rtpSender.MaxDataPayloadLength();
+    assert(fragmentation);
+    // The encoder delivers one RTP packet per fragment; the packetizer
+    // replaces the encoder-built RTP headers with our own.
+    RtpFormatH264 packetizer(payloadData, payloadSize,
+                             _rtpSender.MaxDataPayloadLength(),
+                             *fragmentation);
 
-    //assert(rtpTypeHdr);
-    //RtpFormatVp8 packetizer(data, payloadBytesToSend, rtpTypeHdr->VP8,
-    //                        *fragmentation, kAggregate);
+    // The base layer retransmission setting applies to all H.264/SVC packets.
+    StorageType storage = kAllowRetransmission;
+    if (!(_retransmissionSettings & kRetransmitBaseLayer)) {
+      storage = kDontRetransmit;
+    }
 
     bool last = false;
-	static int send_num = 0;//gxh_test
     _numberFirstPartition = 0;
-	int i = 0;//gxh
-	bool protect = 0;
-	StorageType storage = //kAllowRetransmission;//
-							  kDontRetransmit;
-
-    while (i < fragmentation[0].fragmentationVectorSize)//(!last)//
+    while (!last)
     {
-        // Write VP8 Payload Descriptor and VP8 payload.
-        //WebRtc_UWord8 dataBuffer[IP_PACKET_SIZE] = {0};
-		WebRtc_UWord8 *dataBuffer = (WebRtc_UWord8 *)&payloadData[fragmentation[0].fragmentationOffset[i]];
+        WebRtc_UWord8 dataBuffer[IP_PACKET_SIZE] = {0};
         int payloadBytesInPacket = 0;
-		last = i >= fragmentation[0].fragmentationVectorSize - 1;//gxh_20121113
-
-		payloadBytesInPacket = fragmentation[0].fragmentationLength[i]; 
-
-		// Write RTP header.
-		// Set marker bit true if this is the last packet in frame.
-		_rtpSender.BuildRTPheaderH264(dataBuffer, payloadType, last,captureTimeStamp);
-
-		if (-1 == SendVideoPacket(dataBuffer, payloadBytesInPacket,
-			0/*rtpHeaderLength*/, capture_time_ms, storage, protect))
-		{
-			WEBRTC_TRACE(kTraceError, kTraceRtpRtcp, _id,
-				"RTPSenderVideo::SendH264 failed to send packet number"
-				" %d", _rtpSender.SequenceNumber());
-		}
+        if (packetizer.NextPacket(&dataBuffer[rtpHeaderLength],
+                                  &payloadBytesInPacket, &last) < 0)
+        {
+            return -1;
+        }
 
-		/*
-        if (-1 == SendVideoPacket(frameType, dataBuffer, payloadBytesInPacket,
-            0))///rtpHeaderLength))
+        // Write RTP header.
+        // Set marker bit true if this is the last packet in frame.
+        _rtpSender.BuildRTPheader(dataBuffer, payloadType, last,
+            captureTimeStamp);
+        // As for VP8, only base layer packets are protected.
+        const bool protect = packetizer.BaseLayerPacket();
+        if (-1 == SendVideoPacket(dataBuffer, payloadBytesInPacket,
+            rtpHeaderLength, capture_time_ms, storage, protect))
         {
           WEBRTC_TRACE(kTraceError, kTraceRtpRtcp, _id,
-                       "RTPSenderVideo::SendVP8 failed to send packet number"
+                       "RTPSenderVideo::SendH264 failed to send packet number"
                        " %d", _rtpSender.SequenceNumber());
         }
-		*/
-		i++;
     }
-	send_num += i > 0;//gxh_test
     return 0;
 }
 #endif
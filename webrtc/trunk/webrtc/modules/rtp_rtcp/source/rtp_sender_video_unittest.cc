@@ -0,0 +1,281 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file includes a loss simulation for the H.264 send path of
+ * RTPSenderVideo: frames are sent over a lossy transport and repaired with
+ * ULPFEC and NACK, and the frames which can't be repaired are counted as key
+ * frame requests.
+ */
+
+#include <set>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
+#include "webrtc/modules/rtp_rtcp/source/mock/mock_rtp_receiver_video.h"
+#include "webrtc/modules/rtp_rtcp/source/receiver_fec.h"
+#include "webrtc/modules/rtp_rtcp/source/rtp_sender.h"
+#include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/test/testsupport/perf_test.h"
+#include "webrtc/typedefs.h"
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+
+namespace webrtc {
+
+namespace {
+const int kPayloadType = 98;
+const int kRedPayloadType = 96;
+const int kFecPayloadType = 97;
+const int kRtpHeaderSize = 12;
+const int kPacketsPerFrame = 6;
+const int kNalUnitSize = 900;
+const int kNumFrames = 300;
+const int kNackRounds = 2;
+const int kLossPercent = 10;
+}  // namespace
+
+// Transport which drops a pseudo random share of the packets. All packets are
+// reported to |receiver|, together with whether they were lost.
+class LossyTransport : public Transport {
+ public:
+  class Receiver {
+   public:
+    virtual void OnPacket(const WebRtc_UWord8* packet, int length,
+                          bool lost) = 0;
+   protected:
+    virtual ~Receiver() {}
+  };
+
+  LossyTransport(Receiver* receiver, int loss_percent)
+      : receiver_(receiver),
+        loss_percent_(loss_percent),
+        random_state_(1234) {
+  }
+  virtual int SendPacket(int channel, const void* data, int len) {
+    // Linear congruential generator, to get the same losses everywhere.
+    random_state_ = random_state_ * 1103515245 + 12345;
+    const bool lost =
+        static_cast<int>((random_state_ >> 16) % 100) < loss_percent_;
+    receiver_->OnPacket(static_cast<const WebRtc_UWord8*>(data), len, lost);
+    return len;
+  }
+  virtual int SendRTCPPacket(int channel, const void* data, int len) {
+    return -1;
+  }
+ private:
+  Receiver* receiver_;
+  const int loss_percent_;
+  uint32_t random_state_;
+};
+
+class RtpSenderVideoH264Test : public ::testing::Test,
+                               public LossyTransport::Receiver {
+ protected:
+  RtpSenderVideoH264Test()
+      : fake_clock_(123456),
+        transport_(this, kLossPercent),
+        rtp_sender_(new RTPSender(0, false, &fake_clock_, &transport_, NULL,
+                                  NULL)),
+        receiver_fec_(0, &rtp_receiver_video_),
+        fec_enabled_(false),
+        media_packets_lost_(0) {
+    ON_CALL(rtp_receiver_video_, ReceiveRecoveredPacketCallback(_, _, _))
+        .WillByDefault(Invoke(this,
+                              &RtpSenderVideoH264Test::OnMediaPacket));
+    receiver_fec_.SetPayloadTypeFEC(kFecPayloadType);
+    EXPECT_EQ(0, rtp_sender_->RegisterPayload("H264", kPayloadType, 90000,
+                                              0, 0));
+    rtp_sender_->SetStorePacketsStatus(true, 1000);
+  }
+
+  void EnableFec() {
+    fec_enabled_ = true;
+    EXPECT_EQ(0, rtp_sender_->SetGenericFECStatus(true, kRedPayloadType,
+                                                  kFecPayloadType));
+    FecProtectionParams params;
+    params.fec_rate = 85;
+    params.use_uep_protection = false;
+    params.max_fec_frames = 1;
+    params.fec_mask_type = kFecMaskRandom;
+    EXPECT_EQ(0, rtp_sender_->SetFecParameters(&params, &params));
+  }
+
+  virtual void OnPacket(const WebRtc_UWord8* packet, int length, bool lost) {
+    WebRtcRTPHeader header;
+    memset(&header, 0, sizeof(header));
+    ModuleRTPUtility::RTPHeaderParser parser(packet, length);
+    ASSERT_TRUE(parser.Parse(header));
+    const uint16_t seq_num = header.header.sequenceNumber;
+    if (!fec_enabled_) {
+      sent_media_.insert(seq_num);
+      if (lost) {
+        ++media_packets_lost_;
+      } else {
+        received_.insert(seq_num);
+      }
+      return;
+    }
+    ASSERT_EQ(kRedPayloadType, header.header.payloadType);
+    // The RED header holds the payload type of the protected packet.
+    if ((packet[header.header.headerLength] & 0x7f) == kPayloadType) {
+      sent_media_.insert(seq_num);
+      if (lost) {
+        ++media_packets_lost_;
+      }
+    }
+    if (lost) {
+      return;
+    }
+    bool is_fec = false;
+    ASSERT_EQ(0, receiver_fec_.AddReceivedFECPacket(
+        &header, packet, length - header.header.headerLength, is_fec));
+    ASSERT_EQ(0, receiver_fec_.ProcessReceivedFEC());
+  }
+
+  // Called by the FEC receiver for received and recovered media packets.
+  WebRtc_Word32 OnMediaPacket(WebRtcRTPHeader* header,
+                              const WebRtc_UWord8* payload,
+                              const WebRtc_UWord16 length) {
+    EXPECT_EQ(kPayloadType, header->header.payloadType);
+    received_.insert(header->header.sequenceNumber);
+    return 0;
+  }
+
+  // Builds a frame the way the H.264 encoder delivers it: one RTP packet per
+  // fragment, each with a dummy RTP header.
+  void BuildEncodedFrame() {
+    frame_.assign(kPacketsPerFrame * (kRtpHeaderSize + kNalUnitSize), 0);
+    fragmentation_.VerifyAndAllocateFragmentationHeader(kPacketsPerFrame);
+    fragmentation_.fragmentationVectorSize = kPacketsPerFrame;
+    for (int i = 0; i < kPacketsPerFrame; ++i) {
+      const int offset = i * (kRtpHeaderSize + kNalUnitSize);
+      frame_[offset] = 0x80;
+      frame_[offset + kRtpHeaderSize] = 0x41;  // Non-IDR slice.
+      fragmentation_.fragmentationOffset[i] = offset;
+      fragmentation_.fragmentationLength[i] = kRtpHeaderSize + kNalUnitSize;
+    }
+  }
+
+  // Sends |kNumFrames| frames. Lost packets which are not recovered by FEC
+  // are NACKed up to |kNackRounds| times; frames which are still incomplete
+  // after that need a key frame.
+  void RunLossSimulation(int* frames_with_loss, int* key_frame_requests) {
+    BuildEncodedFrame();
+    *frames_with_loss = 0;
+    *key_frame_requests = 0;
+    for (int frame = 0; frame < kNumFrames; ++frame) {
+      sent_media_.clear();
+      const int lost_before = media_packets_lost_;
+      ASSERT_EQ(0, rtp_sender_->SendOutgoingData(
+          kVideoFrameDelta, kPayloadType, frame * 3000,
+          fake_clock_.TimeInMilliseconds(), &frame_[0], frame_.size(),
+          &fragmentation_));
+      ASSERT_EQ(static_cast<size_t>(kPacketsPerFrame), sent_media_.size());
+      if (media_packets_lost_ != lost_before) {
+        ++(*frames_with_loss);
+      }
+      std::vector<uint16_t> missing;
+      for (int round = 0; round <= kNackRounds; ++round) {
+        missing.clear();
+        for (std::set<uint16_t>::const_iterator it = sent_media_.begin();
+             it != sent_media_.end(); ++it) {
+          if (received_.find(*it) == received_.end()) {
+            missing.push_back(*it);
+          }
+        }
+        if (missing.empty() || round == kNackRounds) {
+          break;
+        }
+        fake_clock_.AdvanceTimeMilliseconds(10);
+        for (size_t i = 0; i < missing.size(); ++i) {
+          rtp_sender_->ReSendPacket(missing[i]);
+        }
+      }
+      if (!missing.empty()) {
+        ++(*key_frame_requests);
+      }
+      fake_clock_.AdvanceTimeMilliseconds(33);
+    }
+  }
+
+  SimulatedClock fake_clock_;
+  LossyTransport transport_;
+  scoped_ptr<RTPSender> rtp_sender_;
+  NiceMock<MockRTPReceiverVideo> rtp_receiver_video_;
+  ReceiverFEC receiver_fec_;
+  bool fec_enabled_;
+  int media_packets_lost_;
+  // Media packets of the current frame, and all media packets received or
+  // recovered.
+  std::set<uint16_t> sent_media_;
+  std::set<uint16_t> received_;
+  std::vector<WebRtc_UWord8> frame_;
+  RTPFragmentationHeader fragmentation_;
+};
+
+TEST_F(RtpSenderVideoH264Test, UnprotectedLossNeedsKeyFrames) {
+  rtp_sender_->SetSelectiveRetransmissions(kRetransmitOff);
+  int frames_with_loss = 0;
+  int key_frame_requests = 0;
+  RunLossSimulation(&frames_with_loss, &key_frame_requests);
+  EXPECT_GT(frames_with_loss, 0);
+  EXPECT_EQ(frames_with_loss, key_frame_requests);
+  test::PrintResult("h264_loss", "_unprotected", "frames_with_loss",
+                    frames_with_loss, "frames", false);
+  test::PrintResult("h264_loss", "_unprotected", "key_frame_requests",
+                    key_frame_requests, "frames", true);
+}
+
+TEST_F(RtpSenderVideoH264Test, NackRecoversLostPackets) {
+  int frames_with_loss = 0;
+  int key_frame_requests = 0;
+  RunLossSimulation(&frames_with_loss, &key_frame_requests);
+  EXPECT_GT(frames_with_loss, 0);
+  EXPECT_LT(key_frame_requests, frames_with_loss / 10);
+  test::PrintResult("h264_loss", "_nack", "frames_recovered",
+                    frames_with_loss - key_frame_requests, "frames", false);
+  test::PrintResult("h264_loss", "_nack", "key_frame_requests",
+                    key_frame_requests, "frames", true);
+}
+
+TEST_F(RtpSenderVideoH264Test, FecAndNackRecoverLostPackets) {
+  EnableFec();
+  int frames_with_loss = 0;
+  int key_frame_requests = 0;
+  RunLossSimulation(&frames_with_loss, &key_frame_requests);
+  EXPECT_GT(frames_with_loss, 0);
+  EXPECT_LT(key_frame_requests, frames_with_loss / 10);
+  test::PrintResult("h264_loss", "_nack_fec", "frames_recovered",
+                    frames_with_loss - key_frame_requests, "frames", false);
+  test::PrintResult("h264_loss", "_nack_fec", "key_frame_requests",
+                    key_frame_requests, "frames", true);
+}
+
+TEST_F(RtpSenderVideoH264Test, FecRecoversLostPacketsWithoutNack) {
+  EnableFec();
+  rtp_sender_->SetSelectiveRetransmissions(kRetransmitOff);
+  int frames_with_loss = 0;
+  int key_frame_requests = 0;
+  RunLossSimulation(&frames_with_loss, &key_frame_requests);
+  EXPECT_GT(frames_with_loss, 0);
+  EXPECT_LT(key_frame_requests, frames_with_loss);
+  test::PrintResult("h264_loss", "_fec", "frames_recovered",
+                    frames_with_loss - key_frame_requests, "frames", false);
+  test::PrintResult("h264_loss", "_fec", "key_frame_requests",
+                    key_frame_requests, "frames", true);
+}
+
+}  // namespace webrtc
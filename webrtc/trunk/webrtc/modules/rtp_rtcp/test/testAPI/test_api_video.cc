@@ -11,6 +11,7 @@
 #include <stdlib.h>
 
 #include <algorithm>
+#include <sstream>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -19,6 +20,8 @@
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
 #include "webrtc/modules/rtp_rtcp/test/testAPI/test_api.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/test/testsupport/perf_test.h"
 
 namespace webrtc {
 
@@ -110,6 +113,21 @@ class RtpRtcpVideoTest : public ::testing::Test {
     return padding_bytes_in_packet + header_length;
   }
 
+  // Builds |num_packets| generic video packets of |payload_length| bytes,
+  // ten per frame, into |packets|.
+  void BuildVideoPackets(int num_packets, int payload_length,
+                         std::vector<std::vector<uint8_t> >* packets) {
+    packets->resize(num_packets);
+    for (int i = 0; i < num_packets; ++i) {
+      std::vector<uint8_t>& packet = (*packets)[i];
+      packet.resize(12 + payload_length);
+      BuildRTPheader(&packet[0], test_timestamp_ + 3000 * (i / 10),
+                     static_cast<WebRtc_UWord16>(test_sequence_number_ + i));
+      packet[1] = 123;  // The generic (I420) payload type.
+      memcpy(&packet[12], video_frame_, payload_length);
+    }
+  }
+
   virtual void TearDown() {
     delete video_module_;
     delete transport_;
@@ -138,6 +156,81 @@ TEST_F(RtpRtcpVideoTest, BasicVideo) {
                                                payload_data_length_));
 }
 
+TEST_F(RtpRtcpVideoTest, IncomingPacketBatch) {
+  const int kNumPackets = 40;
+  std::vector<std::vector<uint8_t> > packets;
+  BuildVideoPackets(kNumPackets, 100, &packets);
+  // An invalid RTP version in the middle of the batch only drops that packet.
+  packets[20][0] = 0;
+
+  const WebRtc_UWord8* data[kNumPackets];
+  WebRtc_UWord16 lengths[kNumPackets];
+  for (int i = 0; i < kNumPackets; ++i) {
+    data[i] = &packets[i][0];
+    lengths[i] = static_cast<WebRtc_UWord16>(packets[i].size());
+  }
+  EXPECT_EQ(-1, video_module_->IncomingPackets(NULL, lengths, 1));
+  EXPECT_EQ(0, video_module_->IncomingPackets(data, lengths, 0));
+  EXPECT_EQ(kNumPackets - 1,
+            video_module_->IncomingPackets(data, lengths, kNumPackets));
+  // The generic payload is delivered with or without the RTP header.
+  ASSERT_GE(receiver_->payload_size(), 100);
+  EXPECT_EQ(0, memcmp(video_frame_, receiver_->payload_data() +
+                      receiver_->payload_size() - 100, 100));
+  EXPECT_EQ(test_sequence_number_ + kNumPackets - 1,
+            receiver_->rtp_header().header.sequenceNumber);
+  EXPECT_EQ(test_timestamp_ + 3000u * ((kNumPackets - 1) / 10),
+            receiver_->rtp_header().header.timestamp);
+
+  WebRtc_UWord32 bytes_received = 0;
+  WebRtc_UWord32 packets_received = 0;
+  EXPECT_EQ(0, video_module_->DataCountersRTP(NULL, NULL, &bytes_received,
+                                              &packets_received));
+  EXPECT_EQ(static_cast<WebRtc_UWord32>(kNumPackets - 1), packets_received);
+}
+
+// Measures the receive cost per packet for batches of 1, 8 and 32 packets.
+TEST_F(RtpRtcpVideoTest, IncomingPacketBatchCost) {
+  const int kNumPackets = 32 * 100;
+  const int kBatchSizes[] = { 1, 8, 32 };
+  std::vector<std::vector<uint8_t> > packets;
+  BuildVideoPackets(kNumPackets, 1000, &packets);
+  std::vector<const WebRtc_UWord8*> data(kNumPackets);
+  std::vector<WebRtc_UWord16> lengths(kNumPackets);
+
+  for (size_t b = 0; b < sizeof(kBatchSizes) / sizeof(kBatchSizes[0]); ++b) {
+    const int batch_size = kBatchSizes[b];
+    // Continue the sequence numbers and timestamps of the previous run.
+    for (int i = 0; i < kNumPackets; ++i) {
+      const int n = static_cast<int>(b) * kNumPackets + i;
+      BuildRTPheader(&packets[i][0], test_timestamp_ + 3000 * (n / 10),
+                     static_cast<WebRtc_UWord16>(test_sequence_number_ + n));
+      packets[i][1] = 123;
+      data[i] = &packets[i][0];
+      lengths[i] = static_cast<WebRtc_UWord16>(packets[i].size());
+    }
+    int accepted = 0;
+    const int64_t start_us = TickTime::MicrosecondTimestamp();
+    for (int i = 0; i < kNumPackets; i += batch_size) {
+      if (batch_size == 1) {
+        if (video_module_->IncomingPacket(data[i], lengths[i]) == 0)
+          ++accepted;
+      } else {
+        accepted += video_module_->IncomingPackets(&data[i], &lengths[i],
+                                                   batch_size);
+      }
+    }
+    const int64_t elapsed_us = TickTime::MicrosecondTimestamp() - start_us;
+    EXPECT_EQ(kNumPackets, accepted);
+
+    std::ostringstream trace;
+    trace << "batch_" << batch_size;
+    test::PrintResult("rtp_receive_time_per_packet", "", trace.str(),
+                      static_cast<size_t>(elapsed_us * 1000 / kNumPackets),
+                      "ns", true);
+  }
+}
+
 TEST_F(RtpRtcpVideoTest, PaddingOnlyFrames) {
   const int kPadSize = 255;
   uint8_t padding_packet[kPadSize];
@@ -146,9 +146,22 @@ public:
         kPcpError                 = 18
     };
 
+    // Socket manager used to wait for and read incoming packets.
+    enum SocketManagerType
+    {
+        // select() on POSIX, overlapped I/O on Windows.
+        kSocketManagerDefault = 0,
+        // Edge-triggered epoll with recvmmsg() batching. Linux only, falls
+        // back to kSocketManagerDefault on other platforms.
+        kSocketManagerEpoll   = 1
+    };
+
     // Factory method. Constructor disabled.
     static UdpTransport* Create(const WebRtc_Word32 id,
                                 WebRtc_UWord8& numSocketThreads);
+    static UdpTransport* Create(const WebRtc_Word32 id,
+                                WebRtc_UWord8& numSocketThreads,
+                                SocketManagerType socketManagerType);
     static void Destroy(UdpTransport* module);
 
     // Prepares the class for sending RTP packets to ipAddr:rtpPort and RTCP
@@ -309,6 +322,14 @@ public:
                                           WebRtc_UWord32 length,
                                           const SocketAddress& to) = 0;
 
+    // Send count RTP packets, data[i] with size lengths[i], to the address
+    // set by InitializeSendSockets(..) using as few system calls as possible.
+    // Returns the number of packets sent or -1 on error.
+    virtual int SendPackets(int channel,
+                            const void* const* data,
+                            const int* lengths,
+                            int count) = 0;
+
 
     // Send RTCP data with size length to the address specified by to.
     virtual WebRtc_Word32 SendRTCPPacketTo(const WebRtc_Word8* data,
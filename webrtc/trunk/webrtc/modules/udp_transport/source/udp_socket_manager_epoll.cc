@@ -0,0 +1,484 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "udp_socket_manager_epoll.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+
+#include "trace.h"
+#include "udp_socket_posix.h"
+
+namespace webrtc {
+UdpSocketManagerEpoll* UdpSocketManagerEpoll::CreateInstance()
+{
+    return new UdpSocketManagerEpoll();
+}
+
+UdpSocketManagerEpoll::UdpSocketManagerEpoll()
+    : UdpSocketManager(),
+      _id(-1),
+      _critSect(CriticalSectionWrapper::CreateCriticalSection()),
+      _numberOfSocketMgr(0),
+      _incSocketMgrNextTime(0),
+      _nextSocketMgrToAssign(0),
+      _socketMgr()
+{
+}
+
+bool UdpSocketManagerEpoll::Init(WebRtc_Word32 id,
+                                 WebRtc_UWord8& numOfWorkThreads) {
+    CriticalSectionScoped cs(_critSect);
+    if ((_id != -1) || (_numOfWorkThreads != 0)) {
+        assert(_id != -1);
+        assert(_numOfWorkThreads != 0);
+        return false;
+    }
+
+    _id = id;
+    _numberOfSocketMgr = numOfWorkThreads;
+    _numOfWorkThreads = numOfWorkThreads;
+
+    if(MAX_NUMBER_OF_SOCKET_MANAGERS_EPOLL < _numberOfSocketMgr)
+    {
+        _numberOfSocketMgr = MAX_NUMBER_OF_SOCKET_MANAGERS_EPOLL;
+    }
+    for(int i = 0; i < _numberOfSocketMgr; i++)
+    {
+        _socketMgr[i] = new UdpSocketManagerEpollImpl();
+    }
+    return true;
+}
+
+UdpSocketManagerEpoll::~UdpSocketManagerEpoll()
+{
+    Stop();
+    WEBRTC_TRACE(kTraceDebug, kTraceTransport, _id,
+                 "UdpSocketManagerEpoll(%d)::~UdpSocketManagerEpoll()",
+                 _numberOfSocketMgr);
+
+    for(int i = 0; i < _numberOfSocketMgr; i++)
+    {
+        delete _socketMgr[i];
+    }
+    delete _critSect;
+}
+
+WebRtc_Word32 UdpSocketManagerEpoll::ChangeUniqueId(const WebRtc_Word32 id)
+{
+    _id = id;
+    return 0;
+}
+
+bool UdpSocketManagerEpoll::Start()
+{
+    WEBRTC_TRACE(kTraceDebug, kTraceTransport, _id,
+                 "UdpSocketManagerEpoll(%d)::Start()",
+                 _numberOfSocketMgr);
+
+    CriticalSectionScoped cs(_critSect);
+    bool retVal = true;
+    for(int i = 0; i < _numberOfSocketMgr && retVal; i++)
+    {
+        retVal = _socketMgr[i]->Start();
+    }
+    if(!retVal)
+    {
+        WEBRTC_TRACE(
+            kTraceError,
+            kTraceTransport,
+            _id,
+            "UdpSocketManagerEpoll(%d)::Start() error starting socket managers",
+            _numberOfSocketMgr);
+    }
+    return retVal;
+}
+
+bool UdpSocketManagerEpoll::Stop()
+{
+    WEBRTC_TRACE(kTraceDebug, kTraceTransport, _id,
+                 "UdpSocketManagerEpoll(%d)::Stop()", _numberOfSocketMgr);
+
+    CriticalSectionScoped cs(_critSect);
+    bool retVal = true;
+    for(int i = 0; i < _numberOfSocketMgr && retVal; i++)
+    {
+        retVal = _socketMgr[i]->Stop();
+    }
+    if(!retVal)
+    {
+        WEBRTC_TRACE(
+            kTraceError,
+            kTraceTransport,
+            _id,
+            "UdpSocketManagerEpoll(%d)::Stop() there are still active socket "
+            "managers",
+            _numberOfSocketMgr);
+    }
+    return retVal;
+}
+
+bool UdpSocketManagerEpoll::AddSocket(UdpSocketWrapper* s)
+{
+    WEBRTC_TRACE(kTraceDebug, kTraceTransport, _id,
+                 "UdpSocketManagerEpoll(%d)::AddSocket()", _numberOfSocketMgr);
+
+    CriticalSectionScoped cs(_critSect);
+    bool retVal = _socketMgr[_nextSocketMgrToAssign]->AddSocket(s);
+    if(!retVal)
+    {
+        WEBRTC_TRACE(
+            kTraceError,
+            kTraceTransport,
+            _id,
+            "UdpSocketManagerEpoll(%d)::AddSocket() failed to add socket to "
+            "manager",
+            _numberOfSocketMgr);
+    }
+
+    // Keep RTP and RTCP sockets of a transport on the same thread and
+    // distribute the pairs in a round-robin fashion.
+    if(_incSocketMgrNextTime == 0)
+    {
+        _incSocketMgrNextTime++;
+    } else {
+        _incSocketMgrNextTime = 0;
+        _nextSocketMgrToAssign++;
+        if(_nextSocketMgrToAssign >= _numberOfSocketMgr)
+        {
+            _nextSocketMgrToAssign = 0;
+        }
+    }
+    return retVal;
+}
+
+bool UdpSocketManagerEpoll::RemoveSocket(UdpSocketWrapper* s)
+{
+    WEBRTC_TRACE(kTraceDebug, kTraceTransport, _id,
+                 "UdpSocketManagerEpoll(%d)::RemoveSocket()",
+                 _numberOfSocketMgr);
+
+    CriticalSectionScoped cs(_critSect);
+    bool retVal = false;
+    for(int i = 0; i < _numberOfSocketMgr && (retVal == false); i++)
+    {
+        retVal = _socketMgr[i]->RemoveSocket(s);
+    }
+    if(!retVal)
+    {
+        WEBRTC_TRACE(
+            kTraceError,
+            kTraceTransport,
+            _id,
+            "UdpSocketManagerEpoll(%d)::RemoveSocket() failed to remove socket "
+            "from manager",
+            _numberOfSocketMgr);
+    }
+    return retVal;
+}
+
+
+UdpSocketManagerEpollImpl::UdpSocketManagerEpollImpl()
+{
+    _critSectList = CriticalSectionWrapper::CreateCriticalSection();
+    _thread = ThreadWrapper::CreateThread(UdpSocketManagerEpollImpl::Run, this,
+                                          kRealtimePriority,
+                                          "UdpSocketManagerEpollImplThread");
+    _epollFd = epoll_create(kMaxEvents);
+    if(_epollFd == -1)
+    {
+        WEBRTC_TRACE(kTraceError, kTraceTransport, -1,
+                     "UdpSocketManagerEpoll failed to create epoll fd: %d",
+                     errno);
+    } else if(fcntl(_epollFd, F_SETFD, FD_CLOEXEC) == -1)
+    {
+        WEBRTC_TRACE(kTraceWarning, kTraceTransport, -1,
+                     "Failed to set FD_CLOEXEC for epoll fd");
+    }
+
+    // Point every message header of the arena at its own buffer once; only
+    // the lengths need to be reset before each recvmmsg() call.
+    memset(_msgs, 0, sizeof(_msgs));
+    for(int i = 0; i < kMaxBatchSize; i++)
+    {
+        _iovecs[i].iov_base = _buffers[i];
+        _iovecs[i].iov_len = kMaxPacketSize;
+        _msgs[i].msg_hdr.msg_iov = &_iovecs[i];
+        _msgs[i].msg_hdr.msg_iovlen = 1;
+        _msgs[i].msg_hdr.msg_name = &_from[i];
+    }
+    WEBRTC_TRACE(kTraceMemory,  kTraceTransport, -1,
+                 "UdpSocketManagerEpoll created");
+}
+
+UdpSocketManagerEpollImpl::~UdpSocketManagerEpollImpl()
+{
+    if(_thread != NULL)
+    {
+        delete _thread;
+    }
+
+    if (_critSectList != NULL)
+    {
+        UpdateSocketMap();
+
+        _critSectList->Enter();
+
+        MapItem* item = _socketMap.First();
+        while(item)
+        {
+            UdpSocketPosix* s = static_cast<UdpSocketPosix*>(item->GetItem());
+            _socketMap.Erase(item);
+            item = _socketMap.First();
+            delete s;
+        }
+        _critSectList->Leave();
+
+        delete _critSectList;
+    }
+
+    if(_epollFd != -1)
+    {
+        close(_epollFd);
+    }
+
+    WEBRTC_TRACE(kTraceMemory,  kTraceTransport, -1,
+                 "UdpSocketManagerEpoll deleted");
+}
+
+bool UdpSocketManagerEpollImpl::Start()
+{
+    unsigned int id = 0;
+    if (_thread == NULL || _epollFd == -1)
+    {
+        return false;
+    }
+
+    WEBRTC_TRACE(kTraceStateInfo,  kTraceTransport, -1,
+                 "Start UdpSocketManagerEpoll");
+    return _thread->Start(id);
+}
+
+bool UdpSocketManagerEpollImpl::Stop()
+{
+    if (_thread == NULL)
+    {
+        return true;
+    }
+
+    WEBRTC_TRACE(kTraceStateInfo,  kTraceTransport, -1,
+                 "Stop UdpSocketManagerEpoll");
+    return _thread->Stop();
+}
+
+bool UdpSocketManagerEpollImpl::Process()
+{
+    // Sockets are only removed from the epoll set and deleted by this thread,
+    // so the socket pointers returned below stay valid until the next call to
+    // UpdateSocketMap().
+    UpdateSocketMap();
+
+    // Timeout = 10 ms, so that socket map updates and Stop() are picked up.
+    int num = epoll_wait(_epollFd, _events, kMaxEvents, 10);
+    if (num == -1)
+    {
+        if (errno != EINTR)
+        {
+            timespec t;
+            t.tv_sec = 0;
+            t.tv_nsec = 10000*1000;
+            nanosleep(&t, NULL);
+        }
+        return true;
+    }
+
+    for (int i = 0; i < num; i++)
+    {
+        if (_events[i].events & (EPOLLIN | EPOLLERR))
+        {
+            DrainSocket(static_cast<UdpSocketWrapper*>(_events[i].data.ptr));
+        }
+    }
+    return true;
+}
+
+void UdpSocketManagerEpollImpl::DrainSocket(UdpSocketWrapper* s)
+{
+    UdpSocketPosix* sl = static_cast<UdpSocketPosix*>(s);
+    const SOCKET fd = sl->GetFd();
+    int received = kMaxBatchSize;
+    while (received == kMaxBatchSize)
+    {
+        for (int i = 0; i < kMaxBatchSize; i++)
+        {
+            _msgs[i].msg_hdr.msg_namelen = sizeof(SocketAddress);
+            _msgs[i].msg_hdr.msg_flags = 0;
+        }
+        received = recvmmsg(fd, _msgs, kMaxBatchSize, MSG_DONTWAIT, NULL);
+        if (received == SOCKET_ERROR)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                // The queue is drained.
+                return;
+            }
+            if (errno == EBADF || errno == ENOTSOCK || errno == EINVAL ||
+                errno == EFAULT || errno == ENOMEM)
+            {
+                // Not a socket error, the next call would fail the same way.
+                return;
+            }
+            // A pending socket error, e.g. ECONNREFUSED from an ICMP
+            // message, is cleared by the call that reports it. Datagrams
+            // queued behind it won't trigger a new edge, so keep reading.
+            received = kMaxBatchSize;
+            continue;
+        }
+        for (int i = 0; i < received; i++)
+        {
+            if (_msgs[i].msg_len == 0 ||
+                (_msgs[i].msg_hdr.msg_flags & MSG_TRUNC))
+            {
+                continue;
+            }
+            sl->IncomingPacket(_buffers[i], _msgs[i].msg_len, &_from[i]);
+        }
+    }
+}
+
+bool UdpSocketManagerEpollImpl::Run(ThreadObj obj)
+{
+    UdpSocketManagerEpollImpl* mgr =
+        static_cast<UdpSocketManagerEpollImpl*>(obj);
+    return mgr->Process();
+}
+
+bool UdpSocketManagerEpollImpl::AddSocket(UdpSocketWrapper* s)
+{
+    UdpSocketPosix* sl = static_cast<UdpSocketPosix*>(s);
+    if(sl->GetFd() == INVALID_SOCKET)
+    {
+        return false;
+    }
+    // Registered right away so that a failure is returned to the caller.
+    // Process() may drain the socket before it is moved to the map, which is
+    // fine since only the manager thread deletes sockets.
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLET;
+    event.data.ptr = s;
+    if(epoll_ctl(_epollFd, EPOLL_CTL_ADD, sl->GetFd(), &event) == -1)
+    {
+        WEBRTC_TRACE(kTraceError, kTraceTransport, -1,
+                     "UdpSocketManagerEpoll failed to add fd %d: %d",
+                     sl->GetFd(), errno);
+        return false;
+    }
+    _critSectList->Enter();
+    _addList.PushBack(s);
+    _critSectList->Leave();
+    return true;
+}
+
+bool UdpSocketManagerEpollImpl::RemoveSocket(UdpSocketWrapper* s)
+{
+    // Put in remove list if this is the correct UdpSocketManagerEpollImpl.
+    CriticalSectionScoped cs(_critSectList);
+    const unsigned int removeFD = static_cast<UdpSocketPosix*>(s)->GetFd();
+
+    // If the socket is in the add list it's safe to remove and delete it.
+    ListItem* addListItem = _addList.First();
+    while(addListItem)
+    {
+        UdpSocketPosix* addSocket = (UdpSocketPosix*)addListItem->GetItem();
+        unsigned int addFD = addSocket->GetFd();
+        if(removeFD == addFD)
+        {
+            _removeList.PushBack(removeFD);
+            return true;
+        }
+        addListItem = _addList.Next(addListItem);
+    }
+
+    // Checking the socket map is safe since all Erase and Insert calls to this
+    // map are also protected by _critSectList.
+    if(_socketMap.Find(removeFD) != NULL)
+    {
+        _removeList.PushBack(removeFD);
+        return true;
+    }
+    return false;
+}
+
+void UdpSocketManagerEpollImpl::UpdateSocketMap()
+{
+    // Remove items in remove list.
+    CriticalSectionScoped cs(_critSectList);
+    while(!_removeList.Empty())
+    {
+        UdpSocketPosix* deleteSocket = NULL;
+        unsigned int removeFD = _removeList.First()->GetUnsignedItem();
+
+        // If the socket is in the add list it isn't in the map yet. Just
+        // remove the socket from the add list.
+        ListItem* addListItem = _addList.First();
+        while(addListItem)
+        {
+            UdpSocketPosix* addSocket = (UdpSocketPosix*)addListItem->GetItem();
+            unsigned int addFD = addSocket->GetFd();
+            if(removeFD == addFD)
+            {
+                deleteSocket = addSocket;
+                _addList.Erase(addListItem);
+                break;
+            }
+            addListItem = _addList.Next(addListItem);
+        }
+
+        // Find and remove socket from _socketMap and the epoll set.
+        MapItem* it = _socketMap.Find(removeFD);
+        if(it != NULL)
+        {
+            UdpSocketPosix* socket =
+                static_cast<UdpSocketPosix*>(it->GetItem());
+            if(socket)
+            {
+                deleteSocket = socket;
+            }
+            _socketMap.Erase(it);
+        }
+        if(deleteSocket)
+        {
+            // Kernels before 2.6.9 require a non-NULL event for EPOLL_CTL_DEL.
+            epoll_event event;
+            memset(&event, 0, sizeof(event));
+            epoll_ctl(_epollFd, EPOLL_CTL_DEL, removeFD, &event);
+            deleteSocket->ReadyForDeletion();
+            delete deleteSocket;
+        }
+        _removeList.PopFront();
+    }
+
+    // Add sockets from add list.
+    while(!_addList.Empty())
+    {
+        UdpSocketPosix* s =
+            static_cast<UdpSocketPosix*>(_addList.First()->GetItem());
+        if(s)
+        {
+            _socketMap.Insert(s->GetFd(), s);
+        }
+        _addList.PopFront();
+    }
+}
+} // namespace webrtc
@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_UDP_TRANSPORT_SOURCE_UDP_SOCKET_MANAGER_EPOLL_H_
+#define WEBRTC_MODULES_UDP_TRANSPORT_SOURCE_UDP_SOCKET_MANAGER_EPOLL_H_
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "critical_section_wrapper.h"
+#include "list_wrapper.h"
+#include "map_wrapper.h"
+#include "thread_wrapper.h"
+#include "udp_socket_manager_wrapper.h"
+#include "udp_socket_wrapper.h"
+
+// The epoll manager is not limited by FD_SETSIZE, so it allows more worker
+// threads than the select() based UdpSocketManagerPosix.
+#define MAX_NUMBER_OF_SOCKET_MANAGERS_EPOLL 64
+
+namespace webrtc {
+
+class UdpSocketManagerEpollImpl;
+
+// Linux socket manager that waits on an edge-triggered epoll set per worker
+// thread and drains every readable socket with recvmmsg().
+class UdpSocketManagerEpoll : public UdpSocketManager
+{
+public:
+    UdpSocketManagerEpoll();
+    virtual ~UdpSocketManagerEpoll();
+
+    virtual bool Init(WebRtc_Word32 id,
+                      WebRtc_UWord8& numOfWorkThreads);
+
+    virtual WebRtc_Word32 ChangeUniqueId(const WebRtc_Word32 id);
+
+    virtual bool Start();
+    virtual bool Stop();
+
+    virtual bool AddSocket(UdpSocketWrapper* s);
+    virtual bool RemoveSocket(UdpSocketWrapper* s);
+
+private:
+    // Friend function to allow the destructor to be accessed from the
+    // instance template.
+    friend UdpSocketManagerEpoll*
+    GetStaticInstance<UdpSocketManagerEpoll>(CountOperation count_operation);
+
+    // Factory method used by GetStaticInstance.
+    static UdpSocketManagerEpoll* CreateInstance();
+
+    WebRtc_Word32 _id;
+    CriticalSectionWrapper* _critSect;
+    WebRtc_UWord8 _numberOfSocketMgr;
+    WebRtc_UWord8 _incSocketMgrNextTime;
+    WebRtc_UWord8 _nextSocketMgrToAssign;
+    UdpSocketManagerEpollImpl* _socketMgr[MAX_NUMBER_OF_SOCKET_MANAGERS_EPOLL];
+};
+
+class UdpSocketManagerEpollImpl
+{
+public:
+    enum
+    {
+        // Number of datagrams fetched by a single recvmmsg() call.
+        kMaxBatchSize = 32,
+        // Largest datagram accepted, same as UdpSocketPosix::HasIncoming().
+        kMaxPacketSize = 2048,
+        // Number of epoll events handled per wakeup.
+        kMaxEvents = 64
+    };
+
+    UdpSocketManagerEpollImpl();
+    virtual ~UdpSocketManagerEpollImpl();
+
+    virtual bool Start();
+    virtual bool Stop();
+
+    virtual bool AddSocket(UdpSocketWrapper* s);
+    virtual bool RemoveSocket(UdpSocketWrapper* s);
+
+protected:
+    static bool Run(ThreadObj obj);
+    bool Process();
+    void UpdateSocketMap();
+
+    // Reads from s until the kernel queue is empty. Required since the
+    // sockets are registered edge-triggered.
+    void DrainSocket(UdpSocketWrapper* s);
+
+private:
+    ThreadWrapper* _thread;
+    CriticalSectionWrapper* _critSectList;
+
+    int _epollFd;
+    epoll_event _events[kMaxEvents];
+
+    // Packet arena reused by every recvmmsg() call made by this thread.
+    mmsghdr _msgs[kMaxBatchSize];
+    iovec _iovecs[kMaxBatchSize];
+    SocketAddress _from[kMaxBatchSize];
+    WebRtc_Word8 _buffers[kMaxBatchSize][kMaxPacketSize];
+
+    MapWrapper _socketMap;
+    ListWrapper _addList;
+    ListWrapper _removeList;
+};
+} // namespace webrtc
+
+#endif // WEBRTC_MODULES_UDP_TRANSPORT_SOURCE_UDP_SOCKET_MANAGER_EPOLL_H_
@@ -79,4 +79,41 @@ TEST(UdpSocketManager, UnremovedSocketsGetCollectedAtManagerDeletion) {
 #endif
 }
 
+TEST(UdpSocketManager, EpollManagerAddAndRemoveSocketDoesNotLeakMemory) {
+  if (!UdpSocketManager::IsSupported(UdpTransport::kSocketManagerEpoll)) {
+    return;
+  }
+  WebRtc_Word32 id = 42;
+  WebRtc_UWord8 threads = 2;
+  UdpSocketManager* mgr =
+      UdpSocketManager::Create(id, threads, UdpTransport::kSocketManagerEpoll);
+  ASSERT_TRUE(mgr != NULL);
+  EXPECT_FALSE(mgr->Init(id, threads))
+      << "Init should return false since Create is supposed to call it.";
+  UdpSocketWrapper* socket
+       = UdpSocketWrapper::CreateSocket(id,
+                                        mgr,
+                                        NULL,  // CallbackObj
+                                        NULL,  // IncomingSocketCallback
+                                        false,  // ipV6Enable
+                                        false);  // disableGQOS
+  ASSERT_TRUE(socket != NULL);
+  EXPECT_EQ(true, mgr->RemoveSocket(socket));
+  UdpSocketManager::Return(UdpTransport::kSocketManagerEpoll);
+}
+
+TEST(UdpSocketManager, EpollManagerIsSeparateFromDefaultManager) {
+  if (!UdpSocketManager::IsSupported(UdpTransport::kSocketManagerEpoll)) {
+    return;
+  }
+  WebRtc_Word32 id = 42;
+  WebRtc_UWord8 threads = 1;
+  UdpSocketManager* mgr = UdpSocketManager::Create(id, threads);
+  UdpSocketManager* epoll_mgr =
+      UdpSocketManager::Create(id, threads, UdpTransport::kSocketManagerEpoll);
+  EXPECT_NE(mgr, epoll_mgr);
+  UdpSocketManager::Return(UdpTransport::kSocketManagerEpoll);
+  UdpSocketManager::Return();
+}
+
 }  // namespace webrtc
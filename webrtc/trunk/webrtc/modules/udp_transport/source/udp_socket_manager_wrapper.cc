@@ -18,6 +18,9 @@
 #else
 #include "udp_socket_manager_posix.h"
 #endif
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+#include "udp_socket_manager_epoll.h"
+#endif
 
 namespace webrtc {
 UdpSocketManager* UdpSocketManager::CreateInstance()
@@ -58,6 +61,53 @@ void UdpSocketManager::Return()
                                      numOfWorkThreads);
 }
 
+UdpSocketManager* UdpSocketManager::Create(
+    const WebRtc_Word32 id,
+    WebRtc_UWord8& numOfWorkThreads,
+    UdpTransport::SocketManagerType type)
+{
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+    if (type == UdpTransport::kSocketManagerEpoll)
+    {
+        UdpSocketManager* impl =
+            GetStaticInstance<UdpSocketManagerEpoll>(kAddRef);
+        if (impl != NULL && impl->Init(id, numOfWorkThreads)) {
+            impl->Start();
+        }
+        return impl;
+    }
+#endif
+    return UdpSocketManager::Create(id, numOfWorkThreads);
+}
+
+void UdpSocketManager::Return(UdpTransport::SocketManagerType type)
+{
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+    if (type == UdpTransport::kSocketManagerEpoll)
+    {
+        GetStaticInstance<UdpSocketManagerEpoll>(kRelease);
+        return;
+    }
+#endif
+    UdpSocketManager::Return();
+}
+
+bool UdpSocketManager::IsSupported(UdpTransport::SocketManagerType type)
+{
+    switch (type)
+    {
+    case UdpTransport::kSocketManagerDefault:
+        return true;
+    case UdpTransport::kSocketManagerEpoll:
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
 UdpSocketManager::UdpSocketManager() : _numOfWorkThreads(0)
 {
 }
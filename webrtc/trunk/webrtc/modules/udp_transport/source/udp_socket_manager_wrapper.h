@@ -13,6 +13,7 @@
 
 #include "system_wrappers/interface/static_instance.h"
 #include "typedefs.h"
+#include "udp_transport.h"
 
 namespace webrtc {
 
@@ -25,6 +26,18 @@ public:
                                     WebRtc_UWord8& numOfWorkThreads);
     static void Return();
 
+    // Same as above but selects the socket manager implementation. Each
+    // type is backed by its own static instance. Types that are not
+    // available on the current platform fall back to kSocketManagerDefault.
+    static UdpSocketManager* Create(
+        const WebRtc_Word32 id,
+        WebRtc_UWord8& numOfWorkThreads,
+        UdpTransport::SocketManagerType type);
+    static void Return(UdpTransport::SocketManagerType type);
+
+    // Returns true if the socket manager type can be used on this platform.
+    static bool IsSupported(UdpTransport::SocketManagerType type);
+
     // Initializes the socket manager. Returns true if the manager wasn't
     // already initialized.
     virtual bool Init(WebRtc_Word32 id,
@@ -171,6 +171,56 @@ WebRtc_Word32 UdpSocketPosix::SendTo(const WebRtc_Word8* buf, WebRtc_Word32 len,
     return retVal;
 }
 
+WebRtc_Word32 UdpSocketPosix::SendToBatch(const WebRtc_Word8* const* bufs,
+                                          const WebRtc_Word32* lens,
+                                          WebRtc_Word32 count,
+                                          const SocketAddress& to)
+{
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+    enum { kMaxSendBatchSize = 32 };
+    mmsghdr msgs[kMaxSendBatchSize];
+    iovec iovecs[kMaxSendBatchSize];
+    WebRtc_Word32 sent = 0;
+    while(sent < count)
+    {
+        int batch = count - sent;
+        if(batch > kMaxSendBatchSize)
+        {
+            batch = kMaxSendBatchSize;
+        }
+        memset(msgs, 0, sizeof(msgs[0]) * batch);
+        for(int i = 0; i < batch; i++)
+        {
+            iovecs[i].iov_base = const_cast<WebRtc_Word8*>(bufs[sent + i]);
+            iovecs[i].iov_len = lens[sent + i];
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name =
+                const_cast<SocketAddress*>(&to);
+            msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr);
+        }
+        int retVal = sendmmsg(_socket, msgs, batch, 0);
+        if(retVal == SOCKET_ERROR)
+        {
+            _error = errno;
+            WEBRTC_TRACE(kTraceError, kTraceTransport, _id,
+                         "UdpSocketPosix::SendToBatch() error: %d", _error);
+            return sent > 0 ? sent : -1;
+        }
+        sent += retVal;
+        if(retVal < batch)
+        {
+            // The send buffer is full; let the caller decide what to do with
+            // the remaining packets.
+            break;
+        }
+    }
+    return sent;
+#else
+    return UdpSocketWrapper::SendToBatch(bufs, lens, count, to);
+#endif
+}
+
 bool UdpSocketPosix::ValidHandle()
 {
     return _socket != INVALID_SOCKET;
@@ -211,14 +261,21 @@ void UdpSocketPosix::HasIncoming()
     case SOCKET_ERROR:
         break;
     default:
-        if(_wantsIncoming && _incomingCb)
-        {
-          _incomingCb(_obj, buf, retval, &from);
-        }
+        IncomingPacket(buf, retval, &from);
         break;
     }
 }
 
+void UdpSocketPosix::IncomingPacket(const WebRtc_Word8* buf,
+                                    WebRtc_Word32 len,
+                                    const SocketAddress* from)
+{
+    if(_wantsIncoming && _incomingCb)
+    {
+        _incomingCb(_obj, buf, len, from);
+    }
+}
+
 void UdpSocketPosix::CloseBlocking()
 {
     _cs->Enter();
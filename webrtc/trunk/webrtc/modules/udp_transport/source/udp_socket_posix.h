@@ -45,6 +45,11 @@ public:
     virtual WebRtc_Word32 SendTo(const WebRtc_Word8* buf, WebRtc_Word32 len,
                                  const SocketAddress& to);
 
+    virtual WebRtc_Word32 SendToBatch(const WebRtc_Word8* const* bufs,
+                                      const WebRtc_Word32* lens,
+                                      WebRtc_Word32 count,
+                                      const SocketAddress& to);
+
     // Deletes socket in addition to closing it.
     // TODO (hellner): make destructor protected.
     virtual void CloseBlocking();
@@ -65,6 +70,10 @@ public:
 
     bool CleanUp();
     void HasIncoming();
+    // Delivers a datagram read by the socket manager to the registered
+    // callback.
+    void IncomingPacket(const WebRtc_Word8* buf, WebRtc_Word32 len,
+                        const SocketAddress* from);
     bool WantsIncoming() {return _wantsIncoming;}
     void ReadyForDeletion();
 private:
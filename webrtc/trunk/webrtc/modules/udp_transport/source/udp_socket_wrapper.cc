@@ -27,13 +27,6 @@
 namespace webrtc {
 bool UdpSocketWrapper::_initiated = false;
 
-// Temporary Android hack. The value 1024 is taken from
-// <ndk>/build/platforms/android-1.5/arch-arm/usr/include/linux/posix_types.h
-// TODO (tomasl): can we remove this now?
-#ifndef FD_SETSIZE
-#define FD_SETSIZE 1024
-#endif
-
 UdpSocketWrapper::UdpSocketWrapper()
     : _wantsIncoming(false),
       _deleteEvent(NULL)
@@ -102,7 +95,9 @@ UdpSocketWrapper* UdpSocketWrapper::CreateSocket(const WebRtc_Word32 id,
     if (s)
     {
         UdpSocketPosix* sl = static_cast<UdpSocketPosix*>(s);
-        if (sl->GetFd() != INVALID_SOCKET && sl->GetFd() < FD_SETSIZE)
+        // The FD_SETSIZE limit of the select() based manager is enforced by
+        // UdpSocketManagerPosixImpl::AddSocket(..).
+        if (sl->GetFd() != INVALID_SOCKET)
         {
             // ok
         } else
@@ -133,6 +128,22 @@ UdpSocketWrapper* UdpSocketWrapper::CreateSocket(const WebRtc_Word32 id,
     return s;
 }
 
+WebRtc_Word32 UdpSocketWrapper::SendToBatch(const WebRtc_Word8* const* bufs,
+                                            const WebRtc_Word32* lens,
+                                            WebRtc_Word32 count,
+                                            const SocketAddress& to)
+{
+    WebRtc_Word32 sent = 0;
+    for (; sent < count; sent++)
+    {
+        if (SendTo(bufs[sent], lens[sent], to) < 0)
+        {
+            break;
+        }
+    }
+    return (sent == 0 && count > 0) ? -1 : sent;
+}
+
 bool UdpSocketWrapper::StartReceiving()
 {
     _wantsIncoming = true;
@@ -81,6 +81,15 @@ public:
     virtual WebRtc_Word32 SendTo(const WebRtc_Word8* buf, WebRtc_Word32 len,
                                  const SocketAddress& to) = 0;
 
+    // Send count packets, bufs[i] of length lens[i], to the address specified
+    // by to. Returns the number of packets handed to the network stack or -1
+    // if none could be sent. The default implementation calls SendTo(..) for
+    // each packet.
+    virtual WebRtc_Word32 SendToBatch(const WebRtc_Word8* const* bufs,
+                                      const WebRtc_Word32* lens,
+                                      WebRtc_Word32 count,
+                                      const SocketAddress& to);
+
     virtual void SetEventToNull();
 
     // Close socket and don't return until completed.
@@ -84,9 +84,21 @@ class SocketFactory : public UdpTransportImpl::SocketFactoryInterface {
 UdpTransport* UdpTransport::Create(const WebRtc_Word32 id,
                                    WebRtc_UWord8& numSocketThreads)
 {
+  return UdpTransport::Create(id, numSocketThreads, kSocketManagerDefault);
+}
+
+UdpTransport* UdpTransport::Create(const WebRtc_Word32 id,
+                                   WebRtc_UWord8& numSocketThreads,
+                                   SocketManagerType socketManagerType)
+{
+  if (!UdpSocketManager::IsSupported(socketManagerType)) {
+    socketManagerType = kSocketManagerDefault;
+  }
   return new UdpTransportImpl(id,
                               new SocketFactory(),
-                              UdpSocketManager::Create(id, numSocketThreads));
+                              UdpSocketManager::Create(id, numSocketThreads,
+                                                       socketManagerType),
+                              socketManagerType);
 }
 
 // Deletes the UdpTransport and decrements the refcount of the
@@ -96,20 +108,24 @@ void UdpTransport::Destroy(UdpTransport* module)
 {
     if(module)
     {
+        SocketManagerType type =
+            static_cast<UdpTransportImpl*>(module)->SocketManager();
         delete module;
-        UdpSocketManager::Return();
+        UdpSocketManager::Return(type);
     }
 }
 
 UdpTransportImpl::UdpTransportImpl(const WebRtc_Word32 id,
                                    SocketFactoryInterface* maker,
-                                   UdpSocketManager* socket_manager)
+                                   UdpSocketManager* socket_manager,
+                                   SocketManagerType socket_manager_type)
     : _id(id),
       _socket_creator(maker),
       _crit(CriticalSectionWrapper::CreateCriticalSection()),
       _critFilter(CriticalSectionWrapper::CreateCriticalSection()),
       _critPacketCallback(CriticalSectionWrapper::CreateCriticalSection()),
       _mgr(socket_manager),
+      _mgrType(socket_manager_type),
       _lastError(kNoSocketError),
       _destPort(0),
       _destPortRTCP(0),
@@ -2038,6 +2054,41 @@ int UdpTransportImpl::SendPacket(int /*channel*/, const void* data, int length)
     return -1;
 }
 
+int UdpTransportImpl::SendPackets(int channel,
+                                  const void* const* data,
+                                  const int* lengths,
+                                  int count)
+{
+    WEBRTC_TRACE(kTraceStream, kTraceTransport, _id, "%s", __FUNCTION__);
+
+    UdpSocketWrapper* socket = NULL;
+    {
+        CriticalSectionScoped cs(_crit);
+        if(_destIP[0] == 0 || _destPort == 0)
+        {
+            return -1;
+        }
+        socket = _ptrSendRtpSocket ? _ptrSendRtpSocket : _ptrRtpSocket;
+        if(socket)
+        {
+            return socket->SendToBatch(
+                reinterpret_cast<const WebRtc_Word8* const*>(data),
+                reinterpret_cast<const WebRtc_Word32*>(lengths), count,
+                _remoteRTPAddr);
+        }
+    }
+    // Let SendPacket(..) create the RTP socket before it can be batched.
+    int sent = 0;
+    for(; sent < count; sent++)
+    {
+        if(SendPacket(channel, data[sent], lengths[sent]) < 0)
+        {
+            break;
+        }
+    }
+    return (sent == 0 && count > 0) ? -1 : sent;
+}
+
 int UdpTransportImpl::SendRTCPPacket(int /*channel*/, const void* data,
                                      int length)
 {
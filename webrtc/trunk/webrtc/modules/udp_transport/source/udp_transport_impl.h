@@ -37,9 +37,12 @@ public:
     // Constructor, only called by UdpTransport::Create and tests.
     // The constructor takes ownership of the "maker".
     // The constructor does not take ownership of socket_manager.
+    // socket_manager_type tells Destroy which static manager to release.
     UdpTransportImpl(const WebRtc_Word32 id,
                      SocketFactoryInterface* maker,
-                     UdpSocketManager* socket_manager);
+                     UdpSocketManager* socket_manager,
+                     SocketManagerType socket_manager_type =
+                         kSocketManagerDefault);
     virtual ~UdpTransportImpl();
 
     // Module functions
@@ -122,6 +125,10 @@ public:
     virtual WebRtc_Word32 SendRTCPPacketTo(const WebRtc_Word8 *data,
                                            WebRtc_UWord32 length,
                                            WebRtc_UWord16 rtcpPort);
+    virtual int SendPackets(int channel,
+                            const void* const* data,
+                            const int* lengths,
+                            int count);
     // Transport functions
     virtual int SendPacket(int channel, const void* data, int length);
     virtual int SendRTCPPacket(int channel, const void* data, int length);
@@ -139,6 +146,7 @@ public:
                                           WebRtc_UWord16& sourcePort);
 
     WebRtc_Word32 Id() const {return _id;}
+    SocketManagerType SocketManager() const {return _mgrType;}
 protected:
     // IncomingSocketCallback signature functions for receiving callbacks from
     // UdpSocketWrapper.
@@ -197,6 +205,7 @@ private:
     // _packetCallback's critical section.
     CriticalSectionWrapper* _critPacketCallback;
     UdpSocketManager* _mgr;
+    SocketManagerType _mgrType;
     ErrorCode _lastError;
 
     // Remote RTP and RTCP ports.
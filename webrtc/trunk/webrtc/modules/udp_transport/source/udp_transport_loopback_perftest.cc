@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Loopback benchmark comparing the select() and epoll socket managers.
+// A number of transports send RTP packets to themselves over 127.0.0.1 and
+// the test reports received packets per second and process CPU time per
+// received packet for each socket manager type.
+
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "system_wrappers/interface/critical_section_wrapper.h"
+#include "system_wrappers/interface/scoped_ptr.h"
+#include "system_wrappers/interface/sleep.h"
+#include "system_wrappers/interface/tick_util.h"
+#include "test/testsupport/perf_test.h"
+#include "udp_socket_manager_wrapper.h"
+#include "udp_transport.h"
+
+namespace webrtc {
+namespace {
+
+const int kNumTransports = 16;
+const int kPacketsPerTransport = 20000;
+const int kBatchSize = 16;
+const int kPacketSize = 1200;
+const WebRtc_UWord16 kFirstPort = 36000;
+
+class CountingReceiver : public UdpTransportData {
+ public:
+  CountingReceiver()
+      : crit_(CriticalSectionWrapper::CreateCriticalSection()),
+        packets_(0) {}
+
+  virtual void IncomingRTPPacket(const WebRtc_Word8* incomingRtpPacket,
+                                 const WebRtc_Word32 rtpPacketLength,
+                                 const char* fromIP,
+                                 const WebRtc_UWord16 fromPort) {
+    CriticalSectionScoped cs(crit_.get());
+    ++packets_;
+  }
+
+  virtual void IncomingRTCPPacket(const WebRtc_Word8* incomingRtcpPacket,
+                                  const WebRtc_Word32 rtcpPacketLength,
+                                  const char* fromIP,
+                                  const WebRtc_UWord16 fromPort) {}
+
+  int packets() const {
+    CriticalSectionScoped cs(crit_.get());
+    return packets_;
+  }
+
+ private:
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  int packets_;
+};
+
+WebRtc_Word64 ProcessCpuTimeUs() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL +
+      usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+void RunLoopback(UdpTransport::SocketManagerType type,
+                 const std::string& trace) {
+  WebRtc_UWord8 threads = 2;
+  UdpTransport* transports[kNumTransports];
+  CountingReceiver receivers[kNumTransports];
+  for (int i = 0; i < kNumTransports; ++i) {
+    const WebRtc_UWord16 port = kFirstPort + 2 * i;
+    transports[i] = UdpTransport::Create(i, threads, type);
+    ASSERT_EQ(0, transports[i]->InitializeReceiveSockets(&receivers[i], port,
+                                                         "127.0.0.1"));
+    ASSERT_EQ(0, transports[i]->InitializeSendSockets("127.0.0.1", port));
+    ASSERT_EQ(0, transports[i]->StartReceiving(500));
+  }
+
+  char payload[kPacketSize];
+  memset(payload, 0x5a, sizeof(payload));
+  const void* batch[kBatchSize];
+  int lengths[kBatchSize];
+  for (int i = 0; i < kBatchSize; ++i) {
+    batch[i] = payload;
+    lengths[i] = kPacketSize;
+  }
+
+  const WebRtc_Word64 start_cpu_us = ProcessCpuTimeUs();
+  const WebRtc_Word64 start_ms = TickTime::MillisecondTimestamp();
+  for (int sent = 0; sent < kPacketsPerTransport; sent += kBatchSize) {
+    for (int i = 0; i < kNumTransports; ++i) {
+      transports[i]->SendPackets(0, batch, lengths, kBatchSize);
+    }
+  }
+  // Give the socket threads time to drain what is left in the socket queues.
+  SleepMs(100);
+  const WebRtc_Word64 elapsed_ms = TickTime::MillisecondTimestamp() - start_ms;
+  const WebRtc_Word64 cpu_us = ProcessCpuTimeUs() - start_cpu_us;
+
+  size_t received = 0;
+  for (int i = 0; i < kNumTransports; ++i) {
+    received += receivers[i].packets();
+    transports[i]->StopReceiving();
+    UdpTransport::Destroy(transports[i]);
+  }
+  ASSERT_GT(received, 0u);
+
+  webrtc::test::PrintResult("udp_loopback_received", "", trace, received,
+                            "packets", false);
+  webrtc::test::PrintResult("udp_loopback_rate", "", trace,
+                            static_cast<size_t>(received * 1000 /
+                                                (elapsed_ms + 1)),
+                            "packets/s", true);
+  webrtc::test::PrintResult("udp_loopback_cpu_per_packet", "", trace,
+                            static_cast<size_t>(cpu_us * 1000 / received),
+                            "ns", true);
+}
+
+}  // namespace
+
+TEST(UdpTransportLoopbackPerfTest, SelectManager) {
+  RunLoopback(UdpTransport::kSocketManagerDefault, "select");
+}
+
+TEST(UdpTransportLoopbackPerfTest, EpollManager) {
+  if (!UdpSocketManager::IsSupported(UdpTransport::kSocketManagerEpoll)) {
+    return;
+  }
+  RunLoopback(UdpTransport::kSocketManagerEpoll, "epoll");
+}
+
+}  // namespace webrtc
@@ -11,22 +11,60 @@
 #ifndef WEBRTC_MODULES_UTILITY_INTERFACE_PROCESS_THREAD_H_
 #define WEBRTC_MODULES_UTILITY_INTERFACE_PROCESS_THREAD_H_
 
+#include <string.h>
+
 #include "typedefs.h"
 
 namespace webrtc {
 class Module;
 
+// Statistics of the Process() calls a ProcessThread has made on a module.
+// Bucket 0 of a histogram counts values of zero, bucket i > 0 counts values
+// in [2^(i-1), 2^i), and the last bucket also counts all larger values.
+struct ModuleProcessStatistics
+{
+    enum { kNumHistogramBuckets = 16 };
+
+    ModuleProcessStatistics()
+    {
+        memset(this, 0, sizeof(*this));
+    }
+
+    WebRtc_UWord32 processCalls;
+    // Time spent in Process(), in microseconds.
+    WebRtc_UWord32 runTimeUs[kNumHistogramBuckets];
+    // Time from when the module was scheduled to run until it was run, in
+    // milliseconds.
+    WebRtc_UWord32 latenessMs[kNumHistogramBuckets];
+};
+
 class ProcessThread
 {
 public:
-    static ProcessThread* CreateProcessThread();
+    // Modules are run by |numberOfThreads| threads. With more than one
+    // thread, different modules may be processed in parallel, so they must
+    // not share state without locking. A module is never processed by two
+    // threads at once.
+    static ProcessThread* CreateProcessThread(int numberOfThreads = 1);
     static void DestroyProcessThread(ProcessThread* module);
 
     virtual WebRtc_Word32 Start() = 0;
     virtual WebRtc_Word32 Stop() = 0;
 
+    // A registered module is told its thread through
+    // Module::ProcessThreadAttached(), so that it can call WakeUp().
     virtual WebRtc_Word32 RegisterModule(const Module* module) = 0;
     virtual WebRtc_Word32 DeRegisterModule(const Module* module) = 0;
+
+    // Modules are asked for TimeUntilNextProcess() after each Process() call,
+    // and at least every 100 ms while idle. A module whose next process time
+    // moves earlier for another reason calls WakeUp() to be asked right away.
+    virtual WebRtc_Word32 WakeUp(const Module* module);
+
+    // Gets the statistics of |module|. Returns -1 if it isn't registered.
+    virtual WebRtc_Word32 GetModuleStatistics(
+        const Module* module,
+        ModuleProcessStatistics* statistics) const;
 protected:
     virtual ~ProcessThread();
 };
@@ -9,17 +9,43 @@
  */
 
 #include "process_thread_impl.h"
+
+#include <algorithm>
+
 #include "module.h"
+#include "tick_util.h"
 #include "trace.h"
 
 namespace webrtc {
+namespace {
+// Idle modules are asked for their next process time at least this often.
+const WebRtc_Word64 kMaxIdleTimeMs = 100;
+
+// Returns the histogram bucket of |value|, see ModuleProcessStatistics.
+int HistogramBucket(WebRtc_Word64 value)
+{
+    int bucket = 0;
+    while (value > 0 &&
+           bucket < ModuleProcessStatistics::kNumHistogramBuckets - 1)
+    {
+        value >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+} // namespace
+
 ProcessThread::~ProcessThread()
 {
 }
 
-ProcessThread* ProcessThread::CreateProcessThread()
+ProcessThread* ProcessThread::CreateProcessThread(int numberOfThreads)
 {
-    return new ProcessThreadImpl();
+    if(numberOfThreads < 1)
+    {
+        return NULL;
+    }
+    return new ProcessThreadImpl(numberOfThreads);
 }
 
 void ProcessThread::DestroyProcessThread(ProcessThread* module)
@@ -27,110 +53,208 @@ void ProcessThread::DestroyProcessThread(ProcessThread* module)
     delete module;
 }
 
-ProcessThreadImpl::ProcessThreadImpl()
-    : _timeEvent(*EventWrapper::Create()),
+WebRtc_Word32 ProcessThread::WakeUp(const Module* /*module*/)
+{
+    return -1;
+}
+
+WebRtc_Word32 ProcessThread::GetModuleStatistics(
+    const Module* /*module*/,
+    ModuleProcessStatistics* /*statistics*/) const
+{
+    return -1;
+}
+
+ProcessThreadImpl::ProcessThreadImpl(int numberOfThreads)
+    : _numberOfThreads(numberOfThreads),
       _critSectModules(CriticalSectionWrapper::CreateCriticalSection()),
-      _thread(NULL)
+      _queueChanged(ConditionVariableWrapper::CreateConditionVariable())
 {
     WEBRTC_TRACE(kTraceMemory, kTraceUtility, -1, "%s created", __FUNCTION__);
 }
 
 ProcessThreadImpl::~ProcessThreadImpl()
 {
+    Stop();
+    delete _queueChanged;
     delete _critSectModules;
-    delete &_timeEvent;
     WEBRTC_TRACE(kTraceMemory, kTraceUtility, -1, "%s deleted", __FUNCTION__);
 }
 
 WebRtc_Word32 ProcessThreadImpl::Start()
 {
-    CriticalSectionScoped lock(_critSectModules);
-    if(_thread)
-    {
-        return -1;
-    }
-    _thread = ThreadWrapper::CreateThread(Run, this, kNormalPriority,
-                                          "ProcessThread");
-    unsigned int id;
-    WebRtc_Word32 retVal = _thread->Start(id);
-    if(retVal >= 0)
     {
-        return 0;
+        CriticalSectionScoped lock(_critSectModules);
+        if(!_threads.empty())
+        {
+            return -1;
+        }
+        for(int i = 0; i < _numberOfThreads; i++)
+        {
+            ThreadWrapper* thread = ThreadWrapper::CreateThread(
+                Run, this, kNormalPriority, "ProcessThread");
+            unsigned int id;
+            if(!thread->Start(id))
+            {
+                delete thread;
+                break;
+            }
+            _threads.push_back(thread);
+        }
+        if(static_cast<int>(_threads.size()) == _numberOfThreads)
+        {
+            return 0;
+        }
     }
-    delete _thread;
-    _thread = NULL;
+    // Stop the threads that did start.
+    Stop();
     return -1;
 }
 
 WebRtc_Word32 ProcessThreadImpl::Stop()
 {
-    _critSectModules->Enter();
-    if(_thread)
+    std::vector<ThreadWrapper*> threads;
     {
-        _thread->SetNotAlive();
-
-        ThreadWrapper* thread = _thread;
-        _thread = NULL;
+        CriticalSectionScoped lock(_critSectModules);
+        threads.swap(_threads);
+        for(size_t i = 0; i < threads.size(); i++)
+        {
+            threads[i]->SetNotAlive();
+        }
+        _queueChanged->WakeAll();
+    }
+    WebRtc_Word32 result = 0;
+    for(size_t i = 0; i < threads.size(); i++)
+    {
+        if(threads[i]->Stop())
+        {
+            delete threads[i];
+        } else {
+            result = -1;
+        }
+    }
+    return result;
+}
 
-        _timeEvent.Set();
-        _critSectModules->Leave();
+WebRtc_Word32 ProcessThreadImpl::RegisterModule(const Module* module)
+{
+    {
+        CriticalSectionScoped lock(_critSectModules);
 
-        if(thread->Stop())
+        // Only allow module to be registered once.
+        ModuleMap::iterator it = _modules.find(module);
+        if(it != _modules.end())
         {
-            delete thread;
+            if(!it->second.deregistered)
+            {
+                return -1;
+            }
+            // Registered again from its own Process() after deregistering.
+            it->second.deregistered = false;
         } else {
-            return -1;
+            it = _modules.insert(std::make_pair(module, ModuleState())).first;
         }
-    } else {
-        _critSectModules->Leave();
+        WEBRTC_TRACE(kTraceInfo, kTraceUtility, -1,
+                     "number of registered modules has increased to %d",
+                     _modules.size());
+        // The module is asked for its next process time right away.
+        Schedule(module, &it->second, TickTime::MillisecondTimestamp());
     }
+    // Modules are told without the lock held, as they may hold their own
+    // lock when calling WakeUp().
+    const_cast<Module*>(module)->ProcessThreadAttached(this);
     return 0;
 }
 
-WebRtc_Word32 ProcessThreadImpl::RegisterModule(const Module* module)
+WebRtc_Word32 ProcessThreadImpl::DeRegisterModule(const Module* module)
+{
+    if(!RemoveModule(module))
+    {
+        return -1;
+    }
+    const_cast<Module*>(module)->ProcessThreadAttached(NULL);
+    return 0;
+}
+
+bool ProcessThreadImpl::RemoveModule(const Module* module)
 {
     CriticalSectionScoped lock(_critSectModules);
 
-    // Only allow module to be registered once.
-    ListItem* item = _modules.First();
-    for(WebRtc_UWord32 i = 0; i < _modules.GetSize() && item; i++)
+    ModuleMap::iterator it = _modules.find(module);
+    if(it == _modules.end() || it->second.deregistered)
+    {
+        return false;
+    }
+    if(it->second.running)
     {
-        if(module == item->GetItem())
+        // The thread running the module removes it when the run ends, and
+        // doesn't run it again.
+        it->second.deregistered = true;
+        it->second.generation++;
+        if(it->second.runningThreadId == ThreadWrapper::GetThreadId())
         {
-            return -1;
+            // Called from the module itself.
+            return true;
+        }
+        // The caller may delete the module once this returns, so wait for
+        // the run to end.
+        while(it != _modules.end() && it->second.running)
+        {
+            _queueChanged->SleepCS(*_critSectModules);
+            it = _modules.find(module);
         }
-        item = _modules.Next(item);
+        return true;
     }
-
-    _modules.PushFront(module);
+    _modules.erase(it);
     WEBRTC_TRACE(kTraceInfo, kTraceUtility, -1,
-                 "number of registered modules has increased to %d",
-                 _modules.GetSize());
-    // Wake the thread calling ProcessThreadImpl::Process() to update the
-    // waiting time. The waiting time for the just registered module may be
-    // shorter than all other registered modules.
-    _timeEvent.Set();
+                 "number of registered modules has decreased to %d",
+                 _modules.size());
+    return true;
+}
+
+WebRtc_Word32 ProcessThreadImpl::WakeUp(const Module* module)
+{
+    CriticalSectionScoped lock(_critSectModules);
+
+    ModuleMap::iterator it = _modules.find(module);
+    if(it == _modules.end() || it->second.deregistered)
+    {
+        return -1;
+    }
+    if(it->second.running)
+    {
+        it->second.wokenUp = true;
+    } else {
+        Schedule(module, &it->second, TickTime::MillisecondTimestamp());
+    }
     return 0;
 }
 
-WebRtc_Word32 ProcessThreadImpl::DeRegisterModule(const Module* module)
+WebRtc_Word32 ProcessThreadImpl::GetModuleStatistics(
+    const Module* module,
+    ModuleProcessStatistics* statistics) const
 {
     CriticalSectionScoped lock(_critSectModules);
 
-    ListItem* item = _modules.First();
-    for(WebRtc_UWord32 i = 0; i < _modules.GetSize() && item; i++)
+    ModuleMap::const_iterator it = _modules.find(module);
+    if(it == _modules.end() || it->second.deregistered)
     {
-        if(module == item->GetItem())
-        {
-            int res = _modules.Erase(item);
-            WEBRTC_TRACE(kTraceInfo, kTraceUtility, -1,
-                         "number of registered modules has decreased to %d",
-                         _modules.GetSize());
-            return res;
-        }
-        item = _modules.Next(item);
+        return -1;
     }
-    return -1;
+    *statistics = it->second.statistics;
+    return 0;
+}
+
+void ProcessThreadImpl::Schedule(const Module* module, ModuleState* state,
+                                 WebRtc_Word64 timeMs)
+{
+    Turn turn;
+    turn.timeMs = timeMs;
+    turn.module = module;
+    turn.generation = ++state->generation;
+    _runQueue.push_back(turn);
+    std::push_heap(_runQueue.begin(), _runQueue.end(), LaterTurn());
+    _queueChanged->WakeAll();
 }
 
 bool ProcessThreadImpl::Run(void* obj)
@@ -140,49 +264,89 @@ bool ProcessThreadImpl::Run(void* obj)
 
 bool ProcessThreadImpl::Process()
 {
-    // Wait for the module that should be called next, but don't block thread
-    // longer than 100 ms.
-    WebRtc_Word32 minTimeToNext = 100;
+    Turn turn;
+    ModuleMap::iterator it;
     {
         CriticalSectionScoped lock(_critSectModules);
-        ListItem* item = _modules.First();
-        for(WebRtc_UWord32 i = 0; i < _modules.GetSize() && item; i++)
+        if(_threads.empty())
+        {
+            return false;
+        }
+        // Drop the turns of modules that have been rescheduled or removed.
+        while(!_runQueue.empty())
         {
-            WebRtc_Word32 timeToNext =
-                static_cast<Module*>(item->GetItem())->TimeUntilNextProcess();
-            if(minTimeToNext > timeToNext)
+            it = _modules.find(_runQueue.front().module);
+            if(it != _modules.end() &&
+               it->second.generation == _runQueue.front().generation)
             {
-                minTimeToNext = timeToNext;
+                break;
             }
-            item = _modules.Next(item);
+            std::pop_heap(_runQueue.begin(), _runQueue.end(), LaterTurn());
+            _runQueue.pop_back();
         }
-    }
-
-    if(minTimeToNext > 0)
-    {
-        if(kEventError == _timeEvent.Wait(minTimeToNext))
+        if(_runQueue.empty())
         {
+            _queueChanged->SleepCS(*_critSectModules, kMaxIdleTimeMs);
             return true;
         }
-        if(!_thread)
+        const WebRtc_Word64 nowMs = TickTime::MillisecondTimestamp();
+        if(_runQueue.front().timeMs > nowMs)
         {
-            return false;
+            // Wait for the next turn, or for the queue to change.
+            _queueChanged->SleepCS(
+                *_critSectModules,
+                static_cast<unsigned long>(_runQueue.front().timeMs - nowMs));
+            return true;
         }
+        turn = _runQueue.front();
+        std::pop_heap(_runQueue.begin(), _runQueue.end(), LaterTurn());
+        _runQueue.pop_back();
+        it->second.running = true;
+        it->second.runningThreadId = ThreadWrapper::GetThreadId();
     }
+
+    // Modules are called without holding the lock, so that they may
+    // register, deregister and wake up modules, and run in parallel.
+    Module* module = const_cast<Module*>(turn.module);
+    const WebRtc_Word64 startUs = TickTime::MicrosecondTimestamp();
+    WebRtc_Word64 runTimeUs = -1;
+    WebRtc_Word32 timeToNext = module->TimeUntilNextProcess();
+    if(timeToNext < 1)
     {
-        CriticalSectionScoped lock(_critSectModules);
-        ListItem* item = _modules.First();
-        for(WebRtc_UWord32 i = 0; i < _modules.GetSize() && item; i++)
-        {
-            WebRtc_Word32 timeToNext =
-                static_cast<Module*>(item->GetItem())->TimeUntilNextProcess();
-            if(timeToNext < 1)
-            {
-                static_cast<Module*>(item->GetItem())->Process();
-            }
-            item = _modules.Next(item);
-        }
+        module->Process();
+        runTimeUs = TickTime::MicrosecondTimestamp() - startUs;
+        timeToNext = module->TimeUntilNextProcess();
+    }
+
+    CriticalSectionScoped lock(_critSectModules);
+    // |it| is still valid; a running module is only erased by this thread.
+    ModuleState& state = it->second;
+    state.running = false;
+    if(state.deregistered)
+    {
+        _modules.erase(it);
+        WEBRTC_TRACE(kTraceInfo, kTraceUtility, -1,
+                     "number of registered modules has decreased to %d",
+                     _modules.size());
+        _queueChanged->WakeAll();
+        return true;
+    }
+    if(runTimeUs >= 0)
+    {
+        state.statistics.processCalls++;
+        state.statistics.runTimeUs[HistogramBucket(runTimeUs)]++;
+        state.statistics.latenessMs[
+            HistogramBucket(startUs / 1000 - turn.timeMs)]++;
+    }
+    const WebRtc_Word64 nowMs = TickTime::MillisecondTimestamp();
+    if(state.wokenUp)
+    {
+        state.wokenUp = false;
+        timeToNext = 0;
     }
+    Schedule(turn.module, &state,
+             nowMs + std::max<WebRtc_Word64>(
+                 0, std::min<WebRtc_Word64>(timeToNext, kMaxIdleTimeMs)));
     return true;
 }
 } // namespace webrtc
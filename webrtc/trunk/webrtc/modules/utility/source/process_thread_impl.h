@@ -11,18 +11,23 @@
 #ifndef WEBRTC_MODULES_UTILITY_SOURCE_PROCESS_THREAD_IMPL_H_
 #define WEBRTC_MODULES_UTILITY_SOURCE_PROCESS_THREAD_IMPL_H_
 
+#include <map>
+#include <vector>
+
+#include "condition_variable_wrapper.h"
 #include "critical_section_wrapper.h"
-#include "event_wrapper.h"
-#include "list_wrapper.h"
 #include "process_thread.h"
 #include "thread_wrapper.h"
 #include "typedefs.h"
 
 namespace webrtc {
+// Runs the registered modules from a min-heap of their next process times.
+// A module is only asked for TimeUntilNextProcess() when its turn comes or
+// it calls WakeUp(), so idle modules cost nothing while others run.
 class ProcessThreadImpl : public ProcessThread
 {
 public:
-    ProcessThreadImpl();
+    explicit ProcessThreadImpl(int numberOfThreads);
     virtual ~ProcessThreadImpl();
 
     virtual WebRtc_Word32 Start();
@@ -30,6 +35,10 @@ public:
 
     virtual WebRtc_Word32 RegisterModule(const Module* module);
     virtual WebRtc_Word32 DeRegisterModule(const Module* module);
+    virtual WebRtc_Word32 WakeUp(const Module* module);
+    virtual WebRtc_Word32 GetModuleStatistics(
+        const Module* module,
+        ModuleProcessStatistics* statistics) const;
 
 protected:
     static bool Run(void* obj);
@@ -37,10 +46,59 @@ protected:
     bool Process();
 
 private:
-    EventWrapper&           _timeEvent;
+    // A turn of a module in the run queue. Turns aren't removed from the
+    // heap when a module is rescheduled; a turn is stale if its generation
+    // is older than the module's.
+    struct Turn
+    {
+        WebRtc_Word64 timeMs;
+        const Module* module;
+        WebRtc_UWord32 generation;
+    };
+    struct LaterTurn
+    {
+        bool operator()(const Turn& a, const Turn& b) const
+        {
+            return a.timeMs > b.timeMs;
+        }
+    };
+    struct ModuleState
+    {
+        ModuleState()
+            : generation(0),
+              running(false),
+              runningThreadId(0),
+              deregistered(false),
+              wokenUp(false) {}
+
+        WebRtc_UWord32 generation;
+        // Set while a thread calls the module.
+        bool running;
+        WebRtc_UWord32 runningThreadId;
+        // Set if the module was deregistered while running.
+        bool deregistered;
+        // Set if WakeUp() was called while the module was running.
+        bool wokenUp;
+        ModuleProcessStatistics statistics;
+    };
+    typedef std::map<const Module*, ModuleState> ModuleMap;
+
+    // Removes |module|, or marks it deregistered if it is running. Returns
+    // false if it isn't registered.
+    bool RemoveModule(const Module* module);
+
+    // Gives |module| a new turn at |timeMs|, replacing its current one.
+    void Schedule(const Module* module, ModuleState* state,
+                  WebRtc_Word64 timeMs);
+
+    const int               _numberOfThreads;
     CriticalSectionWrapper* _critSectModules;
-    ListWrapper             _modules;
-    ThreadWrapper*          _thread;
+    // Signaled when the run queue changes or a module has been run.
+    ConditionVariableWrapper* _queueChanged;
+    ModuleMap               _modules;
+    // Min-heap of turns, earliest first.
+    std::vector<Turn>       _runQueue;
+    std::vector<ThreadWrapper*> _threads;
 };
 } // namespace webrtc
 
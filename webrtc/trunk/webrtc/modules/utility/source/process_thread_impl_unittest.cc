@@ -0,0 +1,215 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "gtest/gtest.h"
+
+#include "module.h"
+#include "process_thread.h"
+#include "system_wrappers/interface/atomic32.h"
+#include "system_wrappers/interface/event_wrapper.h"
+#include "system_wrappers/interface/scoped_ptr.h"
+#include "system_wrappers/interface/sleep.h"
+#include "system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+namespace {
+
+// Asks to be processed every |interval_ms_| and counts the calls it gets.
+class FakeModule : public Module {
+ public:
+  FakeModule(int interval_ms, int process_time_ms)
+      : interval_ms_(interval_ms),
+        process_time_ms_(process_time_ms),
+        next_process_ms_(0),
+        process_thread_(NULL),
+        processed_(EventWrapper::Create()) {}
+
+  virtual int32_t TimeUntilNextProcess() {
+    ++queries_;
+    return static_cast<int32_t>(next_process_ms_ -
+                                TickTime::MillisecondTimestamp());
+  }
+
+  virtual int32_t Process() {
+    if (++processing_ > 1)
+      ++overlapping_calls_;
+    if (process_time_ms_ > 0)
+      SleepMs(process_time_ms_);
+    next_process_ms_ = TickTime::MillisecondTimestamp() + interval_ms_;
+    --processing_;
+    ++process_calls_;
+    processed_->Set();
+    return 0;
+  }
+
+  virtual void ProcessThreadAttached(ProcessThread* process_thread) {
+    process_thread_ = process_thread;
+  }
+
+  // Makes the module due right away.
+  void MakeDue() { next_process_ms_ = 0; }
+
+  bool WaitForProcess(unsigned long max_time_ms) {
+    return processed_->Wait(max_time_ms) == kEventSignaled;
+  }
+
+  ProcessThread* process_thread() const { return process_thread_; }
+  int queries() const { return queries_.Value(); }
+  int process_calls() const { return process_calls_.Value(); }
+  int overlapping_calls() const { return overlapping_calls_.Value(); }
+
+ private:
+  const int interval_ms_;
+  const int process_time_ms_;
+  volatile int64_t next_process_ms_;
+  ProcessThread* process_thread_;
+  Atomic32 queries_;
+  Atomic32 process_calls_;
+  Atomic32 processing_;
+  Atomic32 overlapping_calls_;
+  scoped_ptr<EventWrapper> processed_;
+};
+
+class ProcessThreadTest : public ::testing::Test {
+ protected:
+  void CreateThread(int number_of_threads) {
+    process_thread_ = ProcessThread::CreateProcessThread(number_of_threads);
+    ASSERT_TRUE(process_thread_ != NULL);
+  }
+
+  virtual void TearDown() {
+    if (process_thread_ != NULL) {
+      process_thread_->Stop();
+      ProcessThread::DestroyProcessThread(process_thread_);
+    }
+  }
+
+  ProcessThreadTest() : process_thread_(NULL) {}
+
+  ProcessThread* process_thread_;
+};
+
+TEST_F(ProcessThreadTest, RegisterModuleOnce) {
+  CreateThread(1);
+  FakeModule module(10, 0);
+  EXPECT_EQ(0, process_thread_->RegisterModule(&module));
+  EXPECT_EQ(-1, process_thread_->RegisterModule(&module));
+  EXPECT_EQ(0, process_thread_->DeRegisterModule(&module));
+  EXPECT_EQ(-1, process_thread_->DeRegisterModule(&module));
+  EXPECT_EQ(-1, process_thread_->WakeUp(&module));
+}
+
+TEST_F(ProcessThreadTest, ModuleIsToldItsThread) {
+  CreateThread(1);
+  FakeModule module(10, 0);
+  EXPECT_EQ(0, process_thread_->RegisterModule(&module));
+  EXPECT_EQ(process_thread_, module.process_thread());
+  EXPECT_EQ(0, process_thread_->DeRegisterModule(&module));
+  EXPECT_TRUE(module.process_thread() == NULL);
+}
+
+TEST_F(ProcessThreadTest, IdleModuleIsRarelyQueried) {
+  CreateThread(1);
+  FakeModule busy(5, 0);
+  FakeModule idle(10000, 0);
+  EXPECT_EQ(0, process_thread_->RegisterModule(&busy));
+  EXPECT_EQ(0, process_thread_->RegisterModule(&idle));
+  EXPECT_EQ(0, process_thread_->Start());
+  SleepMs(500);
+  EXPECT_EQ(0, process_thread_->Stop());
+
+  EXPECT_GT(busy.process_calls(), 20);
+  EXPECT_EQ(1, idle.process_calls());
+  // Asked after registering and processing, then at most every 100 ms.
+  EXPECT_LE(idle.queries(), 2 + 500 / 100 + 1);
+  EXPECT_EQ(0, process_thread_->DeRegisterModule(&busy));
+  EXPECT_EQ(0, process_thread_->DeRegisterModule(&idle));
+}
+
+TEST_F(ProcessThreadTest, WakeUpProcessesModulePromptly) {
+  CreateThread(1);
+  FakeModule module(10000, 0);
+  EXPECT_EQ(0, process_thread_->RegisterModule(&module));
+  EXPECT_EQ(0, process_thread_->Start());
+  ASSERT_TRUE(module.WaitForProcess(1000));
+  // Let the thread go idle on the module.
+  SleepMs(20);
+  EXPECT_EQ(1, module.process_calls());
+
+  const int64_t start_ms = TickTime::MillisecondTimestamp();
+  module.MakeDue();
+  EXPECT_EQ(0, module.process_thread()->WakeUp(&module));
+  ASSERT_TRUE(module.WaitForProcess(1000));
+  EXPECT_LT(TickTime::MillisecondTimestamp() - start_ms, 50);
+  EXPECT_EQ(2, module.process_calls());
+  EXPECT_EQ(0, process_thread_->DeRegisterModule(&module));
+}
+
+TEST_F(ProcessThreadTest, ThreadsProcessModulesInParallel) {
+  CreateThread(2);
+  FakeModule first(0, 20);
+  FakeModule second(0, 20);
+  EXPECT_EQ(0, process_thread_->RegisterModule(&first));
+  EXPECT_EQ(0, process_thread_->RegisterModule(&second));
+  EXPECT_EQ(0, process_thread_->Start());
+  SleepMs(300);
+  EXPECT_EQ(0, process_thread_->Stop());
+
+  // Each module takes 20 ms a call, so one thread couldn't have done this
+  // many calls. A module is never processed by two threads at once.
+  EXPECT_GT(first.process_calls() + second.process_calls(), 300 / 20 + 2);
+  EXPECT_EQ(0, first.overlapping_calls());
+  EXPECT_EQ(0, second.overlapping_calls());
+  EXPECT_EQ(0, process_thread_->DeRegisterModule(&first));
+  EXPECT_EQ(0, process_thread_->DeRegisterModule(&second));
+}
+
+TEST_F(ProcessThreadTest, DeRegisterWaitsForProcess) {
+  CreateThread(1);
+  FakeModule module(0, 50);
+  EXPECT_EQ(0, process_thread_->RegisterModule(&module));
+  EXPECT_EQ(0, process_thread_->Start());
+  SleepMs(10);
+  EXPECT_EQ(0, process_thread_->DeRegisterModule(&module));
+  const int process_calls = module.process_calls();
+  EXPECT_GE(process_calls, 1);
+  SleepMs(100);
+  EXPECT_EQ(process_calls, module.process_calls());
+}
+
+TEST_F(ProcessThreadTest, GetModuleStatistics) {
+  CreateThread(1);
+  FakeModule module(5, 2);
+  ModuleProcessStatistics statistics;
+  EXPECT_EQ(-1, process_thread_->GetModuleStatistics(&module, &statistics));
+  EXPECT_EQ(0, process_thread_->RegisterModule(&module));
+  EXPECT_EQ(0, process_thread_->Start());
+  SleepMs(200);
+  EXPECT_EQ(0, process_thread_->Stop());
+
+  EXPECT_EQ(0, process_thread_->GetModuleStatistics(&module, &statistics));
+  EXPECT_EQ(static_cast<uint32_t>(module.process_calls()),
+            statistics.processCalls);
+  uint32_t run_time_calls = 0;
+  uint32_t lateness_calls = 0;
+  for (int i = 0; i < ModuleProcessStatistics::kNumHistogramBuckets; ++i) {
+    run_time_calls += statistics.runTimeUs[i];
+    lateness_calls += statistics.latenessMs[i];
+  }
+  EXPECT_EQ(statistics.processCalls, run_time_calls);
+  EXPECT_EQ(statistics.processCalls, lateness_calls);
+  // Each call sleeps for 2 ms, so none can be in the buckets below 1 ms.
+  for (int i = 0; i <= 10; ++i)
+    EXPECT_EQ(0u, statistics.runTimeUs[i]);
+  EXPECT_EQ(0, process_thread_->DeRegisterModule(&module));
+}
+
+}  // namespace
+}  // namespace webrtc
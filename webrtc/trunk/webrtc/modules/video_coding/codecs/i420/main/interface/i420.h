@@ -11,8 +11,11 @@
 #ifndef WEBRTC_MODULES_VIDEO_CODING_CODECS_I420_H_
 #define WEBRTC_MODULES_VIDEO_CODING_CODECS_I420_H_
 
+#include <list>
+
 #include "video_codec_interface.h"
 #include "typedefs.h"
+#include "i420_buffer_pool.h"
 #include "h264_enc_api.h"  //add wyh
 #include "h264_dec_api.h"  //add wyh
 #include "svc_enc_api.h"  //add wyh
@@ -21,6 +24,7 @@
 #include "thread_wrapper.h"
 #include "event_wrapper.h"
 #include "critical_section_wrapper.h"
+#include "scoped_refptr.h"
 #include "system_wrappers/interface/tick_util.h"
 #include "../../system_wrappers/interface/trace.h"
 #define MAX_IMG_BUF		16
@@ -122,6 +126,8 @@ namespace webrtc
 
 		// "Encode" an I420 image (as a part of a video stream). The encoded image
 		// will be returned to the user via the encode complete callback.
+		// Images are queued and encoded on the encoder thread; when that thread
+		// falls behind, the oldest queued image is dropped without output.
 		//
 		// Input:
 		//          - inputImage        : Image to be encoded.
@@ -164,6 +170,8 @@ namespace webrtc
 
 		WebRtc_Word32 InitSVCEnc(const webrtc::VideoCodec* inst);
 		WebRtc_Word32 GetEncodedPartitions();
+		// Queues |inputImage| for the encoder thread. Returns
+		// WEBRTC_VIDEO_CODEC_NO_OUTPUT when queued, <0 on error.
 		WebRtc_Word32 ImgCopy(const webrtc::I420VideoFrame& inputImage);
 		WebRtc_Word32 SVCEnc(char *apSrcData[3]);
 		WebRtc_RTPacket *_pRtPacket;
@@ -174,12 +182,13 @@ namespace webrtc
 		static bool SVCThreadProc(void* obj);
 		bool SVCStopThread();
 		bool SVCProcess();
-		EncImg _encImg[MAX_IMG_BUF];
-		unsigned char * _inEncBuf;
-		int _maxImgBufCnt;
-		int _inImgBufIdx;
-		int _outImgBufIdx;
-		int _lastOutImgBufIdx;
+		// Captured frames are packed into buffers from _imgBufPool and queued
+		// for the encoder thread, which encodes straight from them.
+		scoped_refptr<I420BufferPool> _imgBufPool;
+		std::list<scoped_refptr<I420Buffer> > _pendingImgs;
+		// Bytes copied and frames encoded since the last statistics report.
+		WebRtc_Word64 _copiedBytes;
+		int _encodedFrames;
 		int _width;
 		int _height;
 		int _width_used;
@@ -11,6 +11,7 @@
 #include "modules/video_coding/codecs/i420/main/interface/i420.h"
 
 
+#include <assert.h>
 #include "math.h"
 
 
@@ -29,6 +30,11 @@
 #define GOPSIZE_SVC   66
 #define GOPSIZE_SVC_P2P   100
 
+// Frames queued for the encoder thread; older frames are dropped.
+#define MAX_PENDING_IMGS   4
+// Frames between reports of the bytes copied per encoded frame.
+#define COPY_STATS_FRAMES   300
+
 #ifdef _WIN32
 #include < windows.h >
 #ifdef __cplusplus
@@ -60,12 +66,10 @@ _inited(false),
 _encodedImage(),
 _encodedCompleteCallback(NULL)
 {
-	int i;
 	_pRtPacket = NULL;
-	_maxImgBufCnt = 0;
-	_inImgBufIdx = 0;
-	_outImgBufIdx = 0;
-	_lastOutImgBufIdx = -1;
+	_imgBufPool = new I420BufferPool;
+	_copiedBytes = 0;
+	_encodedFrames = 0;
 	GVE_CodecEnc_Handle = 0;
 	memset(&OperatePar,0,sizeof(GVE_H264Enc_OperatePar));
 	memset(&ConfigPar,0,sizeof(GVE_H264Enc_ConfigPar));
@@ -73,15 +77,6 @@ _encodedCompleteCallback(NULL)
 	memset(&SVCOperatePar,0,sizeof(GVE_SVCEnc_OperatePar));
 	memset(&SVCConfigPar,0,sizeof(GVE_SVCEnc_ConfigPar));
 	memset(&SVCOutPutInfo,0,sizeof(GVE_SVCEnc_OutPutInfo));
-	for (i = 0; i < MAX_IMG_BUF; i++)
-	{
-		_encImg[i]._buffer = NULL;
-		_encImg[i]._timeStamp = 0;
-		_encImg[i].capture_time_ms_ = 0;
-		_encImg[i]._encodedHeight = 0;
-		_encImg[i]._encodedWidth = 0;
-	}
-	_inEncBuf = NULL;
 	
 	_isRunning = false;
 }
@@ -105,7 +100,6 @@ I420Encoder::~I420Encoder() {
 int I420Encoder::Release() {
 	// Should allocate an encoded frame and then release it here, for that we
 	// actually need an init flag.
-    int i;
 	SVCStopThread();
 	if (_encodedImage._buffer != NULL) {
 		delete [] _encodedImage._buffer;
@@ -123,25 +117,15 @@ int I420Encoder::Release() {
 		if(GVE_CodecEnc_Handle)
 		GVE_SVC_Encoder_Destroy(GVE_CodecEnc_Handle);
 	}
-	for (i = 0; i < MAX_IMG_BUF; i++)
-	{
-		if(_encImg[i]._buffer)
-		{
-			delete [] _encImg[i]._buffer;
-			_encImg[i]._buffer = NULL;
-		}
-	}
+	// The encoder thread is stopped, so the queued frames can go back to the
+	// pool.
+	_pendingImgs.clear();
 
 	if( _pRtPacket)
 	{
 		delete _pRtPacket;
 		_pRtPacket =NULL;
 	}
-	if(_inEncBuf)
-	{
-		delete [] _inEncBuf;
-		_inEncBuf = NULL;
-	}
 	_inited = false;
 	return WEBRTC_VIDEO_CODEC_OK;
 }
@@ -187,21 +171,9 @@ WebRtc_Word32 I420Encoder::InitSVCEnc(const webrtc::VideoCodec* inst)
 		//ԭʼͼ洢ռ估ʼ߲
 		_width_used = ConfigPar.InPut_Width;
 		_height_used = ConfigPar.InPut_Height;
-		_maxImgBufCnt = 4;
 		_width = ConfigPar.InPut_Width;
 		_height = ConfigPar.InPut_Height;
 
-		int size = (_width * _height * 3) >> 1;
-
-		for (i = 0; i < _maxImgBufCnt; i++)
-		{
-			if(_encImg[i]._buffer == NULL)
-				_encImg[i]._buffer = new uint8_t[size];
-		}
-
-		if(_inEncBuf == NULL)
-			_inEncBuf = new uint8_t[size];
-
 	}
 	else if (_pRtPacket->payLoadType == PAYLOADTYPE_SVC_19)
 	{
@@ -356,21 +328,9 @@ WebRtc_Word32 I420Encoder::InitSVCEnc(const webrtc::VideoCodec* inst)
 		//ԭʼͼ洢ռ估ʼ߲
 		_width_used = SVCConfigPar.Inwidth[0];
 		_height_used = SVCConfigPar.InHeight[0];
-		_maxImgBufCnt = 4;
 		_width = SVCConfigPar.Inwidth[0];
 		_height = SVCConfigPar.InHeight[0];
 
-		int size = (_width * _height * 3) >> 1;
-
-		for (i = 0; i < _maxImgBufCnt; i++)
-		{
-			if(_encImg[i]._buffer == NULL)
-				_encImg[i]._buffer = new uint8_t[size];
-		}
-
-		if(_inEncBuf == NULL)
-			_inEncBuf = new uint8_t[size];
-
 
 #if 0  //delete wyh
 	if (_EncCfg.m_wirteEncfile)
@@ -427,6 +387,9 @@ I420Encoder::GetEncodedPartitions()
 		frag_info.VerifyAndAllocateFragmentationHeader(count);
 
 	}
+	// The encoder writes the packets back to back into _encodedImage._buffer,
+	// which rtPacket->buf points at, so they are described but not copied.
+	assert(rtPacket->buf == reinterpret_cast<char*>(_encodedImage._buffer));
 	//add by zj@2013-06-21
 	if(PAYLOADTYPE_H264 == rtPacket->payLoadType)
 	{
@@ -434,12 +397,6 @@ I420Encoder::GetEncodedPartitions()
 		{
 			if(rtPacket->size[i] > 0)
 			{				  
-				memcpy_neon(&_encodedImage._buffer[_encodedImage._length],
-                       &rtPacket->buf[_encodedImage._length],
-                       rtPacket->size[i]);
-//				memcpy(&_encodedImage._buffer[_encodedImage._length],
-//					&rtPacket->buf[_encodedImage._length],
-//					rtPacket->size[i]);
 				frag_info.fragmentationOffset[part_idx] = _encodedImage._length;
 				frag_info.fragmentationLength[part_idx] =  rtPacket->size[i];
 				frag_info.fragmentationPlType[part_idx] = 0;
@@ -463,13 +420,6 @@ I420Encoder::GetEncodedPartitions()
 		{
 			if(rtPacket->size[i] > 0)
 			{		
-                    memcpy_neon(&_encodedImage._buffer[send_length],
-                           &rtPacket->buf[_encodedImage._length],
-                           rtPacket->size[i]);
-/*					memcpy(&_encodedImage._buffer[send_length],
-						&rtPacket->buf[_encodedImage._length],
-						rtPacket->size[i]);*/
-
 					frag_info.fragmentationOffset[part_idx] = send_length;
 					frag_info.fragmentationLength[part_idx] =  rtPacket->size[i];
 					frag_info.fragmentationPlType[part_idx] = 0;
@@ -504,51 +454,53 @@ bool I420Encoder::SVCThreadProc(void* obj)
 
 bool I420Encoder::SVCProcess()
 {
-	static int svc_thread_cnt = 0;
 	int time_limit = 1000 / 30;
-	int flag = 0;
-	int size = _width_used * _height_used;
+	scoped_refptr<I420Buffer> img;
 
-	_pSvc_event->Wait(time_limit);
+	_pSvc_critsect->Enter();
+	bool pending = !_pendingImgs.empty();
+	_pSvc_critsect->Leave();
+	if (!pending)
+	{
+		_pSvc_event->Wait(time_limit);
+	}
 
 	if (!_pSvc_thread || !_isRunning)
 	{
 		//stop the thread
 		return false;
 	}
-	if(_outImgBufIdx != _lastOutImgBufIdx)
 	{
-		_pSvc_critsect->Enter();
-		flag = abs(_outImgBufIdx - _inImgBufIdx) >= 1;
-		if(flag)
+		CriticalSectionScoped cs(_pSvc_critsect);
+		if (_pendingImgs.empty())
 		{
-            memcpy_neon(_inEncBuf,_encImg[_outImgBufIdx]._buffer,(size * 3) >> 1);
-//			memcpy(_inEncBuf,_encImg[_outImgBufIdx]._buffer,(size * 3) >> 1);
-			_encodedImage._frameType = kKeyFrame; // No coding.
-			_encodedImage._timeStamp = _encImg[_outImgBufIdx]._timeStamp;
-			_encodedImage.capture_time_ms_ = _encImg[_outImgBufIdx].capture_time_ms_;
-			_encodedImage._encodedHeight = _encImg[_outImgBufIdx]._encodedHeight;
-			_encodedImage._encodedWidth = _encImg[_outImgBufIdx]._encodedWidth;
-			_lastOutImgBufIdx = _outImgBufIdx;
-
+			return true;
 		}
-		_pSvc_critsect->Leave();
-		//CriticalSectionScoped cs(_pSvc_critsect);
-		if(flag)
-		{
-			char *outImgBuf[3];
-			outImgBuf[0] = (char *)_inEncBuf;
-			outImgBuf[1] = &outImgBuf[0][size];
-			outImgBuf[2] = &outImgBuf[1][size >> 2];
-
-
-
+		img = _pendingImgs.front();
+		_pendingImgs.pop_front();
+	}
+	_encodedImage._frameType = kKeyFrame; // No coding.
+	_encodedImage._timeStamp = img->timestamp();
+	_encodedImage.capture_time_ms_ = img->render_time_ms();
+	_encodedImage._encodedHeight = img->height();
+	_encodedImage._encodedWidth = img->width();
+
+	// The encoder reads the planes in place; the buffer goes back to the pool
+	// when |img| goes out of scope.
+	char *outImgBuf[3];
+	outImgBuf[0] = (char *)img->buffer(kYPlane);
+	outImgBuf[1] = (char *)img->buffer(kUPlane);
+	outImgBuf[2] = (char *)img->buffer(kVPlane);
+	SVCEnc(outImgBuf);
 
-			SVCEnc(outImgBuf);
-			_outImgBufIdx++;
-			_outImgBufIdx = _outImgBufIdx >= _maxImgBufCnt ? 0 : _outImgBufIdx;
-			svc_thread_cnt++;
-		}
+	CriticalSectionScoped cs(_pSvc_critsect);
+	if (++_encodedFrames == COPY_STATS_FRAMES)
+	{
+		WEBRTC_TRACE(webrtc::kTraceStateInfo, webrtc::kTraceVideoCoding, 0,
+			"I420Encoder: %d bytes copied per encoded frame",
+			static_cast<int>(_copiedBytes / _encodedFrames));
+		_copiedBytes = 0;
+		_encodedFrames = 0;
 	}
 	return true;
 }
@@ -570,30 +522,34 @@ bool I420Encoder::SVCStopThread()
 WebRtc_Word32 
 I420Encoder::ImgCopy(const webrtc::I420VideoFrame& inputImage)
 {
-	int size =  inputImage.width() * inputImage.height();
-	char *inY = (char *)inputImage.buffer(webrtc::kYPlane);
-	char *inU = (char *)inputImage.buffer(webrtc::kUPlane);
-	char *inV = (char *)inputImage.buffer(webrtc::kVPlane);
-	char *outImgBuf[3];
-	outImgBuf[0] = (char *)_encImg[_inImgBufIdx]._buffer;
-	outImgBuf[1] = &outImgBuf[0][size];
-	outImgBuf[2] = &outImgBuf[1][size >> 2];
-
-    memcpy_neon(outImgBuf[0],inY,size);
-    memcpy_neon(outImgBuf[1],inU,size >> 2);
-    memcpy_neon(outImgBuf[2],inV,size >> 2);
-
-//	memcpy(outImgBuf[0],inY,size);
-//	memcpy(outImgBuf[1],inU,size >> 2);
-//	memcpy(outImgBuf[2],inV,size >> 2);
-
-
-	_encImg[_inImgBufIdx]._timeStamp = inputImage.timestamp();
-	_encImg[_inImgBufIdx].capture_time_ms_ = inputImage.render_time_ms();
-	_encImg[_inImgBufIdx]._encodedHeight = inputImage.height();
-	_encImg[_inImgBufIdx]._encodedWidth = inputImage.width();
+	// The encoder takes the planes packed in one buffer, so they are packed
+	// once here, and the encoder thread encodes straight from that buffer.
+	scoped_refptr<I420Buffer> img(
+		_imgBufPool->GetBuffer(inputImage.width(), inputImage.height()));
+	if (img.get() == NULL)
+	{
+		return WEBRTC_VIDEO_CODEC_ERR_SIZE;
+	}
+	int copied = img->CopyFrame(inputImage);
+	if (copied < 0)
+	{
+		return WEBRTC_VIDEO_CODEC_ERR_SIZE;
+	}
 
-	return  WEBRTC_VIDEO_CODEC_NO_OUTPUT;
+	CriticalSectionScoped cs(_pSvc_critsect);
+	_copiedBytes += copied;
+	if (_pendingImgs.size() >= MAX_PENDING_IMGS)
+	{
+		// The encoder thread is behind; drop the oldest frame, as the old
+		// ring did when it wrapped. It never reaches the encoded callback.
+		WEBRTC_TRACE(webrtc::kTraceWarning, webrtc::kTraceVideoCoding, 0,
+			"I420Encoder: encoder behind, dropped frame with timestamp %u",
+			_pendingImgs.front()->timestamp());
+		_pendingImgs.pop_front();
+	}
+	_pendingImgs.push_back(img);
+	// The frame is encoded and delivered later by the encoder thread.
+	return WEBRTC_VIDEO_CODEC_NO_OUTPUT;
 }
 
 WebRtc_Word32
@@ -611,10 +567,7 @@ I420Encoder::SVCEnc(char *apSrcData[3])
 		int len = size * 3 >> 1;
 		OperatePar.InPutLen = len;
 		OutPutInfo.abMark = GVE_H264_Encoder_GetSliceType(GVE_CodecEnc_Handle,&OperatePar,&ConfigPar,&OutPutInfo);
-		if(OperatePar.InBuf == NULL)
-		{
-			OperatePar.InBuf = (unsigned char *)apSrcData[0];//(unsigned char *)_encImg[_inImgBufIdx]._buffer;
-		}
+		OperatePar.InBuf = (unsigned char *)apSrcData[0];
 
 		OperatePar.OutputLen = 0;
 		OperatePar.rtpcount = 0;
@@ -732,14 +685,23 @@ int I420Encoder::Encode(const I420VideoFrame& inputImage,
 
 	if(GVE_CodecEnc_Handle)
 	{
-		CriticalSectionScoped cs(_pSvc_critsect);
-		ImgCopy(inputImage);
-
-
-		_inImgBufIdx++;
-		_inImgBufIdx = _inImgBufIdx >= _maxImgBufCnt ? 0 : _inImgBufIdx;
-
+		if (inputImage.width() != _width_used ||
+			inputImage.height() != _height_used)
+		{
+			WEBRTC_TRACE(webrtc::kTraceWarning, webrtc::kTraceVideoCoding, 0,
+				"I420Encoder::Encode frame size %dx%d, expected %dx%d",
+				inputImage.width(), inputImage.height(), _width_used,
+				_height_used);
+			return WEBRTC_VIDEO_CODEC_ERR_SIZE;
+		}
+		runflag = ImgCopy(inputImage);
+		if (runflag != WEBRTC_VIDEO_CODEC_NO_OUTPUT)
+		{
+			return runflag;
+		}
+		// Queued for the encoder thread. As before, this is reported as OK.
 		_pSvc_event->Set();
+		runflag = WEBRTC_VIDEO_CODEC_OK;
 	}
 	else
 		runflag = WEBRTC_VIDEO_CODEC_NO_OUTPUT;
@@ -9,6 +9,7 @@
  */
 
 #include <math.h>
+#include <stdio.h>
 
 #include "gtest/gtest.h"
 
@@ -23,6 +24,7 @@
 #include "webrtc/test/testsupport/frame_writer.h"
 #include "webrtc/test/testsupport/metrics/video_metrics.h"
 #include "webrtc/test/testsupport/packet_reader.h"
+#include "webrtc/test/testsupport/perf_test.h"
 #include "webrtc/typedefs.h"
 
 namespace webrtc {
@@ -142,9 +144,11 @@ class VideoProcessorIntegrationTest: public testing::Test {
   bool denoising_on_;
   bool frame_dropper_on_;
   bool spatial_resize_on_;
+  // 0 lets the codec pick the number of threads.
+  int num_threads_;
 
 
-  VideoProcessorIntegrationTest() {}
+  VideoProcessorIntegrationTest() : num_threads_(0) {}
   virtual ~VideoProcessorIntegrationTest() {}
 
   void SetUpCodecConfig() {
@@ -185,6 +189,7 @@ class VideoProcessorIntegrationTest: public testing::Test {
         spatial_resize_on_;
     config_.codec_settings->codecSpecific.VP8.keyFrameInterval =
         kBaseKeyFrameInterval;
+    config_.codec_settings->codecSpecific.VP8.numberOfThreads = num_threads_;
 
     frame_reader_ =
         new webrtc::test::FrameReaderImpl(config_.input_filename,
@@ -495,6 +500,49 @@ class VideoProcessorIntegrationTest: public testing::Test {
     EXPECT_GT(ssim_result.average, quality_metrics.minimum_avg_ssim);
     EXPECT_GT(ssim_result.min, quality_metrics.minimum_min_ssim);
   }
+
+  // Encodes and decodes the clip with |num_threads| encoder and decoder
+  // threads, and reports the frame rates of each.
+  void ProcessFramesAndReportSpeed(int num_threads) {
+    start_bitrate_ = 500;
+    packet_loss_ = 0.0f;
+    key_frame_interval_ = -1;
+    num_temporal_layers_ = 1;
+    error_concealment_on_ = false;
+    denoising_on_ = true;
+    frame_dropper_on_ = false;
+    spatial_resize_on_ = false;
+    num_threads_ = num_threads;
+    SetUpCodecConfig();
+    processor_->SetRates(500, 30);
+    int frame_number = 0;
+    while (frame_number < kNbrFramesLong &&
+           processor_->ProcessFrame(frame_number)) {
+      ++frame_number;
+    }
+    EXPECT_EQ(kNbrFramesLong, frame_number);
+
+    int64_t encode_time_us = 0;
+    int64_t decode_time_us = 0;
+    for (int i = 0; i < frame_number; ++i) {
+      const webrtc::test::FrameStatistic& stat = stats_.stats_[i];
+      EXPECT_TRUE(stat.encoding_successful);
+      EXPECT_TRUE(stat.decoding_successful);
+      encode_time_us += stat.encode_time_in_us;
+      decode_time_us += stat.decode_time_in_us;
+    }
+    char trace[16];
+    snprintf(trace, sizeof(trace), "%d_threads", num_threads);
+    char fps[16];
+    snprintf(fps, sizeof(fps), "%.1f",
+             frame_number * 1e6 / (encode_time_us > 0 ? encode_time_us : 1));
+    webrtc::test::PrintResult("vp8_cif", "_encode_fps", trace, fps, "fps",
+                              false);
+    snprintf(fps, sizeof(fps), "%.1f",
+             frame_number * 1e6 / (decode_time_us > 0 ? decode_time_us : 1));
+    webrtc::test::PrintResult("vp8_cif", "_decode_fps", trace, fps, "fps",
+                              false);
+  }
 };
 
 void SetRateProfilePars(RateProfile* rate_profile,
@@ -747,4 +795,18 @@ TEST_F(VideoProcessorIntegrationTest, ProcessNoLossTemporalLayers) {
                          process_settings,
                          rc_metrics);
 }
+
+// Encode and decode speed with one, two and four threads. The encoder writes
+// a token partition per thread, which the decoder threads work on in parallel.
+TEST_F(VideoProcessorIntegrationTest, ProcessSpeedOneThread) {
+  ProcessFramesAndReportSpeed(1);
+}
+
+TEST_F(VideoProcessorIntegrationTest, ProcessSpeedTwoThreads) {
+  ProcessFramesAndReportSpeed(2);
+}
+
+TEST_F(VideoProcessorIntegrationTest, ProcessSpeedFourThreads) {
+  ProcessFramesAndReportSpeed(4);
+}
 }  // namespace webrtc
@@ -31,9 +31,44 @@
 #include "webrtc/system_wrappers/interface/trace_event.h"
 
 enum { kVp8ErrorPropagationTh = 30 };
+// Each thread gets at least this many pixels, so that the threading overhead
+// doesn't eat the gain: 720p runs four threads, VGA and smaller one.
+enum { kVp8MinPixelsPerThread = 640 * 360 };
+// One token partition per thread, and there are at most eight of them.
+enum { kVp8MaxThreads = 8 };
 
 namespace webrtc {
 
+// Returns |configured_threads| if set, and otherwise the number of threads
+// worth running for a |width| x |height| stream on |number_of_cores|.
+static int NumberOfThreads(int configured_threads, int width, int height,
+                           int number_of_cores) {
+  int threads = configured_threads;
+  if (threads <= 0) {
+    threads = width * height / kVp8MinPixelsPerThread;
+    if (threads > number_of_cores) {
+      threads = number_of_cores;
+    }
+  }
+  if (threads > kVp8MaxThreads) {
+    threads = kVp8MaxThreads;
+  }
+  return threads > 1 ? threads : 1;
+}
+
+// The libvpx decoder only runs multiple threads on frames with more than one
+// token partition, one macroblock row per partition at a time. Returns the
+// smallest number of partitions, as a vp8e_token_partitions value, that keeps
+// |threads| decoder threads busy.
+static int TokenPartitions(int threads) {
+  int token_partitions = VP8_ONE_TOKENPARTITION;
+  while ((1 << token_partitions) < threads &&
+         token_partitions < VP8_EIGHT_TOKENPARTITION) {
+    ++token_partitions;
+  }
+  return token_partitions;
+}
+
 VP8Encoder* VP8Encoder::Create() {
   return new VP8EncoderImpl();
 }
@@ -223,13 +258,13 @@ int VP8EncoderImpl::InitEncode(const VideoCodec* inst,
   }
   config_->g_lag_in_frames = 0;  // 0- no frame lagging
 
-  // Determining number of threads based on the image size
-  if (codec_.width_used * codec_.height_used > 704 * 576 && number_of_cores > 1) {
-    // 2 threads when larger than 4CIF
-    config_->g_threads = 2;
-  } else {
-    config_->g_threads = 1;
-  }
+  // Determining number of threads based on the image size and the number of
+  // cores, with a token partition per thread so that the decoder can run as
+  // many threads.
+  config_->g_threads = NumberOfThreads(inst->codecSpecific.VP8.numberOfThreads,
+                                       codec_.width_used, codec_.height_used,
+                                       number_of_cores);
+  token_partitions_ = TokenPartitions(config_->g_threads);
 
   // rate control settings
   config_->rc_dropframe_thresh = inst->codecSpecific.VP8.frameDroppingOn ?
@@ -590,6 +625,7 @@ VP8DecoderImpl::VP8DecoderImpl()
       inited_(false),
       feedback_mode_(false),
       decoder_(NULL),
+      number_of_cores_(1),
       last_keyframe_(),
       image_format_(VPX_IMG_FMT_NONE),
       ref_frame_(NULL),
@@ -608,7 +644,7 @@ int VP8DecoderImpl::Reset() {
   if (!inited_) {
     return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
   }
-  InitDecode(&codec_, 1);
+  InitDecode(&codec_, number_of_cores_);
   propagation_cnt_ = -1;
   latest_keyframe_complete_ = false;
   mfqe_enabled_ = false;
@@ -626,12 +662,16 @@ int VP8DecoderImpl::InitDecode(/*const*/ VideoCodec* inst, int number_of_cores)
   if (decoder_ == NULL) {
     decoder_ = new vpx_dec_ctx_t;
   }
+  int configured_threads = 0;
   if (inst->codecType == kVideoCodecVP8) {
     feedback_mode_ = inst->codecSpecific.VP8.feedbackModeOn;
+    configured_threads = inst->codecSpecific.VP8.numberOfThreads;
   }
   vpx_codec_dec_cfg_t  cfg;
-  // Setting number of threads to a constant value (1)
-  cfg.threads = 1;
+  // Streams with a single token partition are decoded by one thread, whatever
+  // the number set here.
+  cfg.threads = NumberOfThreads(configured_threads, inst->width_used,
+                                inst->height_used, number_of_cores);
   cfg.h = cfg.w = 0;  // set after decode
 
   vpx_codec_flags_t flags = 0;
@@ -659,6 +699,7 @@ int VP8DecoderImpl::InitDecode(/*const*/ VideoCodec* inst, int number_of_cores)
 
   // Save VideoCodec instance for later; mainly for duplicating the decoder.
   codec_ = *inst;
+  number_of_cores_ = number_of_cores;
   propagation_cnt_ = -1;
   latest_keyframe_complete_ = false;
 
@@ -941,7 +982,7 @@ VideoDecoder* VP8DecoderImpl::Copy() {
   VP8DecoderImpl *copy = new VP8DecoderImpl;
 
   // Initialize the new decoder
-  if (copy->InitDecode(&codec_, 1) != WEBRTC_VIDEO_CODEC_OK) {
+  if (copy->InitDecode(&codec_, number_of_cores_) != WEBRTC_VIDEO_CODEC_OK) {
     delete copy;
     return NULL;
   }
@@ -223,6 +223,7 @@ class VP8DecoderImpl : public VP8Decoder {
   bool feedback_mode_;
   vpx_dec_ctx_t* decoder_;
   VideoCodec codec_;
+  int number_of_cores_;
   EncodedImage last_keyframe_;
   int image_format_;
   vpx_ref_frame_t* ref_frame_;
@@ -386,6 +386,20 @@ public:
     virtual WebRtc_Word32 RegisterPacketRequestCallback(
                                         VCMPacketRequestCallback* callback) = 0;
 
+    // Registers a callback which is called when the next frame in the jitter
+    // buffer becomes complete. Lets the user call Decode() with a zero wait
+    // time when there is something to decode, instead of blocking a thread in
+    // Decode(). The callback is called on the thread inserting packets.
+    //
+    // Input:
+    //              - callback      : The callback to be registered in the VCM.
+    //                                De-register with a NULL pointer.
+    //
+    // Return value     : VCM_OK,     on success.
+    //                    <0,              on error.
+    virtual WebRtc_Word32 RegisterFrameReadyCallback(
+                                        VCMFrameReadyCallback* callback) = 0;
+
     // Waits for the next frame in the jitter buffer to become complete
     // (waits no longer than maxWaitTimeMs), then passes it to the decoder for decoding.
     // Should be called as often as possible to get the most out of the decoder.
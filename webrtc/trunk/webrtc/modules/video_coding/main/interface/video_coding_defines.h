@@ -176,6 +176,17 @@ class VCMPacketRequestCallback {
   }
 };
 
+// Callback class used for telling the user that the next frame in the jitter
+// buffer is complete, so that Decode() will not have to wait for it.
+class VCMFrameReadyCallback {
+ public:
+  virtual void FrameReady(int64_t render_time_ms) = 0;
+
+ protected:
+  virtual ~VCMFrameReadyCallback() {
+  }
+};
+
 // Callback used to inform the user of the the desired resolution
 // as subscribed by Media Optimization (Quality Modes)
 class VCMQMSettingsCallback {
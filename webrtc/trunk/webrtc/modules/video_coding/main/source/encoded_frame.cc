@@ -56,6 +56,10 @@ VCMEncodedFrame::VCMEncodedFrame(const VCMEncodedFrame& rhs)
     _codecSpecificInfo(rhs._codecSpecificInfo),
     _codec(rhs._codec),
     _fragmentation() {
+#ifndef GXH_TEST_H264
+  _allocIdx = rhs._allocIdx;
+  _encIdx = rhs._encIdx;
+#endif
   _buffer = NULL;
   _size = 0;
   _length = 0;
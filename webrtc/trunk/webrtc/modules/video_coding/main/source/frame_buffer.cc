@@ -18,6 +18,7 @@ namespace webrtc {
 
 VCMFrameBuffer::VCMFrameBuffer()
   :
+    _refCount(1),
     _state(kStateFree),
     _frameCounted(false),
     _nackCount(0),
@@ -30,6 +31,7 @@ VCMFrameBuffer::~VCMFrameBuffer() {
 VCMFrameBuffer::VCMFrameBuffer(VCMFrameBuffer& rhs)
 :
 VCMEncodedFrame(rhs),
+_refCount(1),
 _state(rhs._state),
 _frameCounted(rhs._frameCounted),
 _sessionInfo(),
@@ -37,7 +39,27 @@ _nackCount(rhs._nackCount),
 _latestPacketTimeMs(rhs._latestPacketTimeMs)
 {
     _sessionInfo = rhs._sessionInfo;
-    _sessionInfo.UpdateDataPointers(rhs._buffer, _buffer);
+}
+
+void
+VCMFrameBuffer::AddRef()
+{
+    ++_refCount;
+}
+
+void
+VCMFrameBuffer::Release()
+{
+    if (--_refCount == 0)
+    {
+        delete this;
+    }
+}
+
+bool
+VCMFrameBuffer::Shared() const
+{
+    return _refCount.Value() > 1;
 }
 
 webrtc::FrameType
@@ -64,6 +86,18 @@ VCMFrameBuffer::GetHighSeqNum() const
     return _sessionInfo.HighSequenceNumber();
 }
 
+WebRtc_Word32
+VCMFrameBuffer::GetEmptyLowSeqNum() const
+{
+    return _sessionInfo.EmptyLowSequenceNumber();
+}
+
+WebRtc_Word32
+VCMFrameBuffer::GetEmptyHighSeqNum() const
+{
+    return _sessionInfo.EmptyHighSequenceNumber();
+}
+
 int VCMFrameBuffer::PictureId() const {
   return _sessionInfo.PictureId();
 }
@@ -150,7 +184,6 @@ VCMFrameBuffer::InsertPacket(const VCMPacket& packet, WebRtc_Word64 timeInMs,
                    (packet.insertStartCode ? kH264StartCodeLengthBytes : 0);
     if (requiredSizeBytes >= _size)
     {
-        const WebRtc_UWord8* prevBuffer = _buffer;
         const WebRtc_UWord32 increments = requiredSizeBytes /
                                           kBufferIncStepSizeBytes +
                                         (requiredSizeBytes %
@@ -161,17 +194,16 @@ VCMFrameBuffer::InsertPacket(const VCMPacket& packet, WebRtc_Word64 timeInMs,
         {
             return kSizeError;
         }
-        if (VerifyAndAllocate(newSize) == -1)
-        {
-            return kSizeError;
-        }
-        _sessionInfo.UpdateDataPointers(prevBuffer, _buffer);
+        // The session keeps the payloads until they are gathered into the
+        // buffer by PrepareForDecode(), so there is nothing to copy.
+        delete [] _buffer;
+        _buffer = new WebRtc_UWord8[newSize];
+        _size = newSize;
     }
 
     CopyCodecSpecific(&packet.codecSpecificHeader);
 
-    int retVal = _sessionInfo.InsertPacket(packet, _buffer,
-                                           enableDecodableState,
+    int retVal = _sessionInfo.InsertPacket(packet, enableDecodableState,
                                            rttMS);
     if (retVal == -1)
     {
@@ -328,8 +360,8 @@ VCMFrameBuffer::SetState(VCMFrameBufferStateEnum state)
         // decoder of a frame loss.
         assert(_state == kStateComplete || _state == kStateIncomplete ||
                _state == kStateDecodable || _state == kStateEmpty);
-        // Transfer frame information to EncodedFrame and create any codec
-        // specific information
+        // Transfer frame information to EncodedFrame. The payloads are
+        // gathered by PrepareForDecode().
         RestructureFrameInformation();
         break;
 
@@ -344,7 +376,6 @@ VCMFrameBuffer::SetState(VCMFrameBufferStateEnum state)
 void
 VCMFrameBuffer::RestructureFrameInformation()
 {
-    PrepareForDecode();
     _frameType = ConvertFrameType(_sessionInfo.FrameType());
     _completeFrame = _sessionInfo.complete();
     _missingFrame = _sessionInfo.PreviousFrameLoss();
@@ -362,12 +393,10 @@ VCMFrameBuffer::ExtractFromStorage(const EncodedVideoData& frameFromStorage)
     _completeFrame = frameFromStorage.completeFrame;
     _renderTimeMs = frameFromStorage.renderTimeMs;
     _codec = frameFromStorage.codec;
-    const WebRtc_UWord8 *prevBuffer = _buffer;
     if (VerifyAndAllocate(frameFromStorage.payloadSize) < 0)
     {
         return VCM_MEMORY;
     }
-    _sessionInfo.UpdateDataPointers(prevBuffer, _buffer);
     memcpy(_buffer, frameFromStorage.payloadData, frameFromStorage.payloadSize);
     _length = frameFromStorage.payloadSize;
     return VCM_OK;
@@ -412,6 +441,9 @@ VCMFrameBuffer::IsRetransmitted() const
 void
 VCMFrameBuffer::PrepareForDecode()
 {
+    // Copy the packets into the frame buffer, in sequence number order. This
+    // is the only time the payloads are moved after being received.
+    _length = _sessionInfo.GatherPackets(_buffer);
 #ifdef INDEPENDENT_PARTITIONS
     if (_codec == kVideoCodecVP8)
     {
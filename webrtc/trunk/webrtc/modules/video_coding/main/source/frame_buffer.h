@@ -15,6 +15,7 @@
 #include "modules/video_coding/main/source/encoded_frame.h"
 #include "modules/video_coding/main/source/jitter_buffer_common.h"
 #include "modules/video_coding/main/source/session_info.h"
+#include "system_wrappers/interface/atomic32.h"
 #include "typedefs.h"
 
 namespace webrtc
@@ -28,6 +29,14 @@ public:
 
     VCMFrameBuffer(VCMFrameBuffer& rhs);
 
+    // The jitter buffers of the primary and the dual receiver share frames
+    // instead of copying them. A frame is created with one reference, and is
+    // deleted when the last reference is released. A shared frame must not
+    // be modified, the jitter buffer modifying it first makes its own copy.
+    void AddRef();
+    void Release();
+    bool Shared() const;
+
     virtual void Reset();
 
     VCMFrameBufferEnum InsertPacket(const VCMPacket& packet,
@@ -53,6 +62,10 @@ public:
     WebRtc_Word32 GetLowSeqNum() const;
     // Get highest packet sequence number in frame
     WebRtc_Word32 GetHighSeqNum() const;
+    // Get lowest and highest sequence number of the empty packets in frame,
+    // -1 if no empty packets have been inserted.
+    WebRtc_Word32 GetEmptyLowSeqNum() const;
+    WebRtc_Word32 GetEmptyHighSeqNum() const;
 
     int PictureId() const;
     int TemporalId() const;
@@ -82,15 +95,21 @@ public:
 
     WebRtc_Word32 ExtractFromStorage(const EncodedVideoData& frameFromStorage);
 
+    // Copies the payloads into the frame buffer, in sequence number order.
+    // Called after the frame has been set to kStateDecoding, when the frame is
+    // owned by the decoding thread, so it doesn't have to be done with the
+    // jitter buffer locked.
+    void PrepareForDecode();
+
     // The number of packets discarded because the decoder can't make use of
     // them.
     int NotDecodablePackets() const;
 
 protected:
     void RestructureFrameInformation();
-    void PrepareForDecode();
 
 private:
+    Atomic32                   _refCount;
     VCMFrameBufferStateEnum    _state;         // Current state of the frame
     bool                       _frameCounted;  // Was this frame counted by JB?
     VCMSessionInfo             _sessionInfo;
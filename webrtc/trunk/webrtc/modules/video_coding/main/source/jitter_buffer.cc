@@ -28,38 +28,102 @@ namespace webrtc {
 // Use this rtt if no value has been reported.
 static uint32_t kDefaultRtt = 200;
 
-// Predicates used when searching for frames in the frame buffer list
-class FrameSmallerTimestamp {
+// Predicate used when searching for frames in the frame buffer list
+class CompleteDecodableKeyFrameCriteria {
  public:
-  explicit FrameSmallerTimestamp(uint32_t timestamp) : timestamp_(timestamp) {}
-  bool operator()(VCMFrameBuffer* frame) {
-    return (LatestTimestamp(timestamp_, frame->TimeStamp(), NULL) ==
-            timestamp_);
+  bool operator()(const FrameList::FrameMap::value_type& entry) {
+    const VCMFrameBuffer* frame = entry.second;
+    return (frame->FrameType() == kVideoFrameKey) &&
+           (frame->GetState() == kStateComplete ||
+            frame->GetState() == kStateDecodable);
   }
-
- private:
-  uint32_t timestamp_;
 };
 
-class FrameEqualTimestamp {
- public:
-  explicit FrameEqualTimestamp(uint32_t timestamp) : timestamp_(timestamp) {}
-  bool operator()(VCMFrameBuffer* frame) {
-    return (timestamp_ == frame->TimeStamp());
+FrameList::FrameList()
+    : frames_(),
+      last_found_(frames_.end()),
+      last_timestamp_(0) {
+}
+
+void FrameList::Insert(VCMFrameBuffer* frame) {
+  const int64_t timestamp = Unwrap(frame->TimeStamp());
+  std::pair<iterator, bool> result =
+      frames_.insert(std::make_pair(timestamp, frame));
+  if (!result.second) {
+    // The frame is already in the list.
+    assert(result.first->second == frame);
+    result.first->second = frame;
+  }
+  last_found_ = result.first;
+  last_timestamp_ = timestamp;
+}
+
+VCMFrameBuffer* FrameList::Find(uint32_t timestamp) {
+  const int64_t unwrapped_timestamp = Unwrap(timestamp);
+  if (last_found_ != frames_.end() &&
+      last_found_->first == unwrapped_timestamp) {
+    return last_found_->second;
+  }
+  iterator it = frames_.find(unwrapped_timestamp);
+  if (it == frames_.end()) {
+    return NULL;
   }
+  last_found_ = it;
+  return it->second;
+}
 
- private:
-  uint32_t timestamp_;
-};
+FrameList::iterator FrameList::Erase(iterator it) {
+  if (it == last_found_) {
+    last_found_ = frames_.end();
+  }
+  iterator next = it;
+  ++next;
+  frames_.erase(it);
+  return next;
+}
 
-class CompleteDecodableKeyFrameCriteria {
- public:
-  bool operator()(VCMFrameBuffer* frame) {
-    return (frame->FrameType() == kVideoFrameKey) &&
-           (frame->GetState() == kStateComplete ||
-            frame->GetState() == kStateDecodable);
+bool FrameList::Remove(VCMFrameBuffer* frame) {
+  iterator it = FindFrame(frame);
+  if (it == frames_.end()) {
+    return false;
   }
-};
+  Erase(it);
+  return true;
+}
+
+void FrameList::Replace(VCMFrameBuffer* old_frame, VCMFrameBuffer* new_frame) {
+  assert(old_frame->TimeStamp() == new_frame->TimeStamp());
+  iterator it = FindFrame(old_frame);
+  if (it != frames_.end()) {
+    it->second = new_frame;
+  }
+}
+
+void FrameList::Clear() {
+  frames_.clear();
+  last_found_ = frames_.end();
+  last_timestamp_ = 0;
+}
+
+int64_t FrameList::Unwrap(uint32_t timestamp) const {
+  return last_timestamp_ + static_cast<int32_t>(
+      timestamp - static_cast<uint32_t>(last_timestamp_));
+}
+
+FrameList::iterator FrameList::FindFrame(VCMFrameBuffer* frame) {
+  iterator it = frames_.find(Unwrap(frame->TimeStamp()));
+  if (it != frames_.end() && it->second == frame) {
+    return it;
+  }
+  // A frame left behind by a jump in the timestamps doesn't unwrap to the
+  // key it was inserted with.
+  for (it = frames_.begin(); it != frames_.end(); ++it) {
+    if (it->second == frame) {
+      return it;
+    }
+  }
+  return frames_.end();
+}
 
 VCMJitterBuffer::VCMJitterBuffer(Clock* clock,
                                  int vcm_id,
@@ -70,8 +134,10 @@ VCMJitterBuffer::VCMJitterBuffer(Clock* clock,
       clock_(clock),
       running_(false),
       crit_sect_(CriticalSectionWrapper::CreateCriticalSection()),
+      stats_crit_sect_(CriticalSectionWrapper::CreateCriticalSection()),
       master_(master),
       frame_event_(),
+      frame_ready_callback_(NULL),
       packet_event_(),
       max_number_of_frames_(kStartNumberOfFrames),
       frame_buffers_(),
@@ -95,6 +161,7 @@ VCMJitterBuffer::VCMJitterBuffer(Clock* clock,
       nack_mode_(kNoNack),
       low_rtt_nack_threshold_ms_(-1),
       high_rtt_nack_threshold_ms_(-1),
+      received_seq_nums_(),
       nack_seq_nums_internal_(),
       nack_seq_nums_(),
       nack_seq_nums_length_(0),
@@ -113,9 +180,10 @@ VCMJitterBuffer::~VCMJitterBuffer() {
   Stop();
   for (int i = 0; i < kMaxNumberOfFrames; i++) {
     if (frame_buffers_[i]) {
-      delete frame_buffers_[i];
+      frame_buffers_[i]->Release();
     }
   }
+  delete stats_crit_sect_;
   delete crit_sect_;
 }
 
@@ -128,15 +196,22 @@ void VCMJitterBuffer::CopyFrom(const VCMJitterBuffer& rhs) {
     running_ = rhs.running_;
     master_ = !rhs.master_;
     max_number_of_frames_ = rhs.max_number_of_frames_;
-    incoming_frame_rate_ = rhs.incoming_frame_rate_;
-    incoming_frame_count_ = rhs.incoming_frame_count_;
-    time_last_incoming_frame_count_ = rhs.time_last_incoming_frame_count_;
-    incoming_bit_count_ = rhs.incoming_bit_count_;
-    incoming_bit_rate_ = rhs.incoming_bit_rate_;
+    {
+      CriticalSectionScoped stats_cs(stats_crit_sect_);
+      CriticalSectionScoped rhs_stats_cs(rhs.stats_crit_sect_);
+      incoming_frame_rate_ = rhs.incoming_frame_rate_;
+      incoming_frame_count_ = rhs.incoming_frame_count_;
+      time_last_incoming_frame_count_ = rhs.time_last_incoming_frame_count_;
+      incoming_bit_count_ = rhs.incoming_bit_count_;
+      incoming_bit_rate_ = rhs.incoming_bit_rate_;
+      num_discarded_packets_ = rhs.num_discarded_packets_;
+      num_not_decodable_packets_ = rhs.num_not_decodable_packets_;
+      memcpy(receive_statistics_, rhs.receive_statistics_,
+             sizeof(receive_statistics_));
+    }
     drop_count_ = rhs.drop_count_;
     num_consecutive_old_frames_ = rhs.num_consecutive_old_frames_;
     num_consecutive_old_packets_ = rhs.num_consecutive_old_packets_;
-    num_discarded_packets_ = rhs.num_discarded_packets_;
     jitter_estimate_ = rhs.jitter_estimate_;
     inter_frame_delay_ = rhs.inter_frame_delay_;
     waiting_for_completion_ = rhs.waiting_for_completion_;
@@ -145,11 +220,8 @@ void VCMJitterBuffer::CopyFrom(const VCMJitterBuffer& rhs) {
     waiting_for_key_frame_ = rhs.waiting_for_key_frame_;
     first_packet_ = rhs.first_packet_;
     last_decoded_state_ =  rhs.last_decoded_state_;
-    num_not_decodable_packets_ = rhs.num_not_decodable_packets_;
     assert(max_nack_list_size_ == rhs.max_nack_list_size_);
     assert(max_packet_age_to_nack_ == rhs.max_packet_age_to_nack_);
-    memcpy(receive_statistics_, rhs.receive_statistics_,
-           sizeof(receive_statistics_));
     nack_seq_nums_internal_.resize(rhs.nack_seq_nums_internal_.size());
     std::copy(rhs.nack_seq_nums_internal_.begin(),
               rhs.nack_seq_nums_internal_.end(),
@@ -157,20 +229,25 @@ void VCMJitterBuffer::CopyFrom(const VCMJitterBuffer& rhs) {
     nack_seq_nums_.resize(rhs.nack_seq_nums_.size());
     std::copy(rhs.nack_seq_nums_.begin(), rhs.nack_seq_nums_.end(),
               nack_seq_nums_.begin());
+    received_seq_nums_ = rhs.received_seq_nums_;
     for (int i = 0; i < kMaxNumberOfFrames; i++) {
       if (frame_buffers_[i] != NULL) {
-        delete frame_buffers_[i];
+        frame_buffers_[i]->Release();
         frame_buffers_[i] = NULL;
       }
     }
-    frame_list_.clear();
+    frame_list_.Clear();
+    // The frames waiting to be decoded are shared with |rhs|, this is done on
+    // the decoding thread and must not block packet insertion for long. Frames
+    // being decoded by |rhs| get a new frame in their place.
     for (int i = 0; i < max_number_of_frames_; i++) {
-      frame_buffers_[i] = new VCMFrameBuffer(*(rhs.frame_buffers_[i]));
-      if (frame_buffers_[i]->Length() > 0) {
-        FrameList::reverse_iterator rit = std::find_if(
-            frame_list_.rbegin(), frame_list_.rend(),
-            FrameSmallerTimestamp(frame_buffers_[i]->TimeStamp()));
-        frame_list_.insert(rit.base(), frame_buffers_[i]);
+      VCMFrameBuffer* frame = rhs.frame_buffers_[i];
+      if (frame->Length() > 0 && frame->GetState() != kStateDecoding) {
+        frame->AddRef();
+        frame_buffers_[i] = frame;
+        frame_list_.Insert(frame);
+      } else {
+        frame_buffers_[i] = new VCMFrameBuffer();
       }
     }
     rhs.crit_sect_->Leave();
@@ -181,16 +258,20 @@ void VCMJitterBuffer::CopyFrom(const VCMJitterBuffer& rhs) {
 void VCMJitterBuffer::Start() {
   CriticalSectionScoped cs(crit_sect_);
   running_ = true;
-  incoming_frame_count_ = 0;
-  incoming_frame_rate_ = 0;
-  incoming_bit_count_ = 0;
-  incoming_bit_rate_ = 0;
-  time_last_incoming_frame_count_ = clock_->TimeInMilliseconds();
-  memset(receive_statistics_, 0, sizeof(receive_statistics_));
+  {
+    CriticalSectionScoped stats_cs(stats_crit_sect_);
+    incoming_frame_count_ = 0;
+    incoming_frame_rate_ = 0;
+    incoming_bit_count_ = 0;
+    incoming_bit_rate_ = 0;
+    time_last_incoming_frame_count_ = clock_->TimeInMilliseconds();
+    memset(receive_statistics_, 0, sizeof(receive_statistics_));
+    num_discarded_packets_ = 0;
+    num_not_decodable_packets_ = 0;
+  }
 
   num_consecutive_old_frames_ = 0;
   num_consecutive_old_packets_ = 0;
-  num_discarded_packets_ = 0;
 
   // Start in a non-signaled state.
   frame_event_.Reset();
@@ -202,7 +283,6 @@ void VCMJitterBuffer::Start() {
   nack_seq_nums_length_ = 0;
   waiting_for_key_frame_ = false;
   rtt_ms_ = kDefaultRtt;
-  num_not_decodable_packets_ = 0;
 
   WEBRTC_TRACE(webrtc::kTraceDebug, webrtc::kTraceVideoCoding,
                VCMId(vcm_id_, receiver_id_), "JB(0x%x): Jitter buffer: start",
@@ -213,10 +293,11 @@ void VCMJitterBuffer::Stop() {
   crit_sect_->Enter();
   running_ = false;
   last_decoded_state_.Reset();
-  frame_list_.clear();
+  frame_list_.Clear();
+  received_seq_nums_.Reset();
   for (int i = 0; i < kMaxNumberOfFrames; i++) {
     if (frame_buffers_[i] != NULL) {
-      static_cast<VCMFrameBuffer*>(frame_buffers_[i])->SetState(kStateFree);
+      FreeFrame(frame_buffers_[i]);
     }
   }
 
@@ -237,12 +318,16 @@ bool VCMJitterBuffer::Running() const {
 void VCMJitterBuffer::Flush() {
   CriticalSectionScoped cs(crit_sect_);
   // Erase all frames from the sorted list and set their state to free.
-  frame_list_.clear();
+  frame_list_.Clear();
   for (int i = 0; i < max_number_of_frames_; i++) {
     ReleaseFrameIfNotDecoding(frame_buffers_[i]);
   }
+  received_seq_nums_.Reset();
   last_decoded_state_.Reset();  // TODO(mikhal): sync reset.
-  num_not_decodable_packets_ = 0;
+  {
+    CriticalSectionScoped stats_cs(stats_crit_sect_);
+    num_not_decodable_packets_ = 0;
+  }
   frame_event_.Reset();
   packet_event_.Reset();
   num_consecutive_old_frames_ = 0;
@@ -265,18 +350,18 @@ void VCMJitterBuffer::FrameStatistics(uint32_t* received_delta_frames,
                                       uint32_t* received_key_frames) const {
   assert(received_delta_frames);
   assert(received_key_frames);
-  CriticalSectionScoped cs(crit_sect_);
+  CriticalSectionScoped cs(stats_crit_sect_);
   *received_delta_frames = receive_statistics_[1] + receive_statistics_[3];
   *received_key_frames = receive_statistics_[0] + receive_statistics_[2];
 }
 
 int VCMJitterBuffer::num_not_decodable_packets() const {
-  CriticalSectionScoped cs(crit_sect_);
+  CriticalSectionScoped cs(stats_crit_sect_);
   return num_not_decodable_packets_;
 }
 
 int VCMJitterBuffer::num_discarded_packets() const {
-  CriticalSectionScoped cs(crit_sect_);
+  CriticalSectionScoped cs(stats_crit_sect_);
   return num_discarded_packets_;
 }
 
@@ -285,7 +370,7 @@ void VCMJitterBuffer::IncomingRateStatistics(unsigned int* framerate,
                                              unsigned int* bitrate) {
   assert(framerate);
   assert(bitrate);
-  CriticalSectionScoped cs(crit_sect_);
+  CriticalSectionScoped cs(stats_crit_sect_);
 	//__android_log_print(ANDROID_LOG_ERROR, "yyf","%x, %d, %d", this, __LINE__, incoming_frame_count_);
   const int64_t now = clock_->TimeInMilliseconds();
   int64_t diff = now - time_last_incoming_frame_count_;
@@ -379,9 +464,9 @@ int64_t VCMJitterBuffer::NextTimestamp(uint32_t max_wait_time_ms,
     return -1;
   }
   // We have a frame.
-  *incoming_frame_type = (*it)->FrameType();
-  *render_time_ms = (*it)->RenderTimeMs();
-  const uint32_t timestamp = (*it)->TimeStamp();
+  *incoming_frame_type = it->second->FrameType();
+  *render_time_ms = it->second->RenderTimeMs();
+  const uint32_t timestamp = it->second->TimeStamp();
   crit_sect_->Leave();
 
   return timestamp;
@@ -487,8 +572,8 @@ VCMEncodedFrame* VCMJitterBuffer::GetCompleteFrameForDecoding(
     return NULL;
   }
 
-  VCMFrameBuffer* oldest_frame = *it;
-  it = frame_list_.erase(it);
+  VCMFrameBuffer* oldest_frame = UnshareFrame(it->second);
+  frame_list_.Erase(it);
 
   // Update jitter estimate.
   const bool retransmitted = (oldest_frame->GetNackCount() > 0);
@@ -512,11 +597,25 @@ VCMEncodedFrame* VCMJitterBuffer::GetCompleteFrameForDecoding(
 
   crit_sect_->Leave();
 
+  // The frame is owned by the decoding thread from here on.
+  oldest_frame->PrepareForDecode();
   return oldest_frame;
 }
 
 VCMEncodedFrame* VCMJitterBuffer::GetFrameForDecoding() {
-  CriticalSectionScoped cs(crit_sect_);
+  VCMFrameBuffer* frame = NULL;
+  {
+    CriticalSectionScoped cs(crit_sect_);
+    frame = ExtractFrameForDecoding();
+  }
+  if (frame != NULL) {
+    // The frame is owned by the decoding thread from here on.
+    frame->PrepareForDecode();
+  }
+  return frame;
+}
+
+VCMFrameBuffer* VCMJitterBuffer::ExtractFrameForDecoding() {
   if (!running_) {
     return NULL;
   }
@@ -536,6 +635,7 @@ VCMEncodedFrame* VCMJitterBuffer::GetFrameForDecoding() {
       oldest_frame->GetState() != kStateComplete) {
     return NULL;
   }
+  oldest_frame = UnshareFrame(oldest_frame);
 
   // Incomplete frame pulled out from jitter buffer,
   // update the jitter estimate with what we currently know.
@@ -556,7 +656,7 @@ VCMEncodedFrame* VCMJitterBuffer::GetFrameForDecoding() {
       oldest_frame->LatestPacketTimeMs();
     waiting_for_completion_.timestamp = oldest_frame->TimeStamp();
   }
-  frame_list_.erase(frame_list_.begin());
+  frame_list_.Erase(frame_list_.begin());
 
   // Look for previous frame loss
   VerifyAndSetPreviousFrameLost(oldest_frame);
@@ -573,7 +673,10 @@ VCMEncodedFrame* VCMJitterBuffer::GetFrameForDecoding() {
     waiting_for_key_frame_ = false;
   }
 
-  num_not_decodable_packets_ += oldest_frame->NotDecodablePackets();
+  {
+    CriticalSectionScoped stats_cs(stats_crit_sect_);
+    num_not_decodable_packets_ += oldest_frame->NotDecodablePackets();
+  }
 
   // We have a frame - update decoded state with frame info.
   last_decoded_state_.SetState(oldest_frame);
@@ -602,7 +705,10 @@ int VCMJitterBuffer::GetFrame(const VCMPacket& packet,
   if (last_decoded_state_.IsOldPacket(&packet)) {
     // Account only for media packets.
     if (packet.sizeBytes > 0) {
-      num_discarded_packets_++;
+      {
+        CriticalSectionScoped stats_cs(stats_crit_sect_);
+        num_discarded_packets_++;
+      }
       num_consecutive_old_packets_++;
     }
     // Update last decoded sequence number if the packet arrived late and
@@ -620,13 +726,9 @@ int VCMJitterBuffer::GetFrame(const VCMPacket& packet,
   }
   num_consecutive_old_packets_ = 0;
 
-  FrameList::iterator it = std::find_if(
-                             frame_list_.begin(),
-                             frame_list_.end(),
-                             FrameEqualTimestamp(packet.timestamp));
-
-  if (it != frame_list_.end()) {
-    frame = *it;
+  VCMFrameBuffer* existing_frame = frame_list_.Find(packet.timestamp);
+  if (existing_frame != NULL) {
+    frame = UnshareFrame(existing_frame);
     crit_sect_->Leave();
     return VCM_OK;
   }
@@ -669,12 +771,38 @@ int64_t VCMJitterBuffer::LastPacketTime(VCMEncodedFrame* frame,
 
 VCMFrameBufferEnum VCMJitterBuffer::InsertPacket(VCMEncodedFrame* encoded_frame,
                                                  const VCMPacket& packet) {
+  return InsertPacket(encoded_frame, packet, 0, 0, -1);
+}
+
+VCMFrameBufferEnum VCMJitterBuffer::InsertPacket(VCMEncodedFrame* encoded_frame,
+                                                 const VCMPacket& packet,
+                                                 uint16_t frame_width,
+                                                 uint16_t frame_height,
+                                                 int64_t render_time_ms) {
   assert(encoded_frame);
   CriticalSectionScoped cs(crit_sect_);
   int64_t now_ms = clock_->TimeInMilliseconds();
   VCMFrameBufferEnum buffer_return = kSizeError;
   VCMFrameBufferEnum ret = kSizeError;
-  VCMFrameBuffer* frame = static_cast<VCMFrameBuffer*>(encoded_frame);
+
+  // The jitter buffer isn't locked between GetFrame() and InsertPacket(), so
+  // the frame may have been flushed, taken for decoding or replaced by a copy
+  // in between. A frame which has received packets is looked up again, a new
+  // frame must still be empty.
+  VCMFrameBuffer* frame = frame_list_.Find(packet.timestamp);
+  if (frame == NULL) {
+    frame = static_cast<VCMFrameBuffer*>(encoded_frame);
+    if (!OwnsFrame(frame) || frame->GetState() != kStateEmpty) {
+      return kNoError;
+    }
+  }
+  frame = UnshareFrame(frame);
+  if (frame_width && frame_height) {
+    frame->SetEncodedSize(frame_width, frame_height);
+  }
+  if (render_time_ms >= 0 && frame->Length() == 0) {
+    frame->SetRenderTime(render_time_ms);
+  }
 
   // We are keeping track of the first seq num, the latest seq num and
   // the number of wraps to be able to calculate how many packets we expect.
@@ -719,22 +847,31 @@ VCMFrameBufferEnum VCMJitterBuffer::InsertPacket(VCMEncodedFrame* encoded_frame,
                                       rtt_ms_);
   ret = buffer_return;
   if (buffer_return > 0) {
-    incoming_bit_count_ += packet.sizeBytes << 3;
+    {
+      CriticalSectionScoped stats_cs(stats_crit_sect_);
+      incoming_bit_count_ += packet.sizeBytes << 3;
+    }
 
     // Has this packet been nacked or is it about to be nacked?
     if (IsPacketRetransmitted(packet)) {
       frame->IncrementNackCount();
     }
 
+    if (packet.frameType == kFrameEmpty) {
+      // The frame assumes that all packets between its lowest and highest
+      // empty packets are empty packets which have been received.
+      received_seq_nums_.SetRange(
+          static_cast<uint16_t>(frame->GetEmptyLowSeqNum()),
+          static_cast<uint16_t>(frame->GetEmptyHighSeqNum()));
+    } else {
+      received_seq_nums_.Set(packet.seqNum);
+    }
+
     // Insert each frame once on the arrival of the first packet
     // belonging to that frame (media or empty).
     if (state == kStateEmpty && first) {
       ret = kFirstPacket;
-      FrameList::reverse_iterator rit = std::find_if(
-          frame_list_.rbegin(),
-          frame_list_.rend(),
-          FrameSmallerTimestamp(frame->TimeStamp()));
-      frame_list_.insert(rit.base(), frame);
+      frame_list_.Insert(frame);
     }
   }
   switch (buffer_return) {
@@ -742,9 +879,11 @@ VCMFrameBufferEnum VCMJitterBuffer::InsertPacket(VCMEncodedFrame* encoded_frame,
     case kTimeStampError:
     case kSizeError: {
       if (frame != NULL) {
-        // Will be released when it gets old.
-        frame->Reset();
-        frame->SetState(kStateEmpty);
+        // The packets already in the frame are discarded and will have to be
+        // NACKed again.
+        ClearReceivedPackets(*frame);
+        frame_list_.Remove(frame);
+        FreeFrame(frame);
       }
       break;
     }
@@ -946,50 +1085,52 @@ uint16_t* VCMJitterBuffer::CreateNackList(uint16_t* nack_list_size,
     return NULL;
   }
 
-  uint16_t seq_number_iterator = static_cast<uint16_t>(low_seq_num + 1);
-  for (i = 0; i < number_of_seq_num; i++) {
-    nack_seq_nums_internal_[i] = seq_number_iterator;
-    seq_number_iterator++;
-  }
-  if (number_of_seq_num > 0) {
+  int empty_index = -1;
+  if (nack_mode_ != kNackHybrid) {
+    // The missing packets are read directly from the bitmap of received
+    // sequence numbers, which gives a list that is already compressed.
+    empty_index = 0;
+    if (number_of_seq_num > 0) {
+      empty_index = received_seq_nums_.FindMissing(
+          static_cast<uint16_t>(low_seq_num), number_of_seq_num,
+          &nack_seq_nums_internal_[0]);
+    }
+  } else if (number_of_seq_num > 0) {
+    uint16_t seq_number_iterator = static_cast<uint16_t>(low_seq_num + 1);
+    for (i = 0; i < number_of_seq_num; i++) {
+      nack_seq_nums_internal_[i] = seq_number_iterator;
+      seq_number_iterator++;
+    }
     // Now we have a list of all sequence numbers that could have been sent.
-    // Zero out the ones we have received.
+    // Zero out the ones we have received. In hybrid mode, we use the soft
+    // NACKing feature.
     int nack_seq_nums_index = 0;
     for (FrameList::iterator it = frame_list_.begin(); it != frame_list_.end();
         ++it) {
-      // Reaching thus far means we are going to update the NACK list
-      // When in hybrid mode, we use the soft NACKing feature.
-      if (nack_mode_ == kNackHybrid) {
-        nack_seq_nums_index = (*it)->BuildSoftNackList(
-            &nack_seq_nums_internal_[0], number_of_seq_num,
-            nack_seq_nums_index, rtt_ms_);
-      } else {
-        // Used when the frame is being processed by the decoding thread
-        // don't need to use that info in this loop.
-        nack_seq_nums_index = (*it)->BuildHardNackList(
-            &nack_seq_nums_internal_[0], number_of_seq_num,
-            nack_seq_nums_index);
-      }
+      // Building the soft NACK list marks the frame as NACKed.
+      nack_seq_nums_index = UnshareFrame(it->second)->BuildSoftNackList(
+          &nack_seq_nums_internal_[0], number_of_seq_num,
+          nack_seq_nums_index, rtt_ms_);
     }
-  }
 
-  // Compress the list.
-  int empty_index = -1;
-  for (i = 0; i < number_of_seq_num; i++) {
-    if (nack_seq_nums_internal_[i] == -1 || nack_seq_nums_internal_[i] == -2) {
-      // This is empty.
-      if (empty_index == -1) {
-        // No empty index before, remember this position.
-        empty_index = i;
-      }
-    } else {
-      // This is not empty.
-      if (empty_index == -1) {
-        // No empty index, continue.
+    // Compress the list.
+    for (i = 0; i < number_of_seq_num; i++) {
+      if (nack_seq_nums_internal_[i] == -1 ||
+          nack_seq_nums_internal_[i] == -2) {
+        // This is empty.
+        if (empty_index == -1) {
+          // No empty index before, remember this position.
+          empty_index = i;
+        }
       } else {
-        nack_seq_nums_internal_[empty_index] = nack_seq_nums_internal_[i];
-        nack_seq_nums_internal_[i] = -1;
-        empty_index++;
+        // This is not empty.
+        if (empty_index == -1) {
+          // No empty index, continue.
+        } else {
+          nack_seq_nums_internal_[empty_index] = nack_seq_nums_internal_[i];
+          nack_seq_nums_internal_[i] = -1;
+          empty_index++;
+        }
       }
     }
   }
@@ -1056,7 +1197,7 @@ int64_t VCMJitterBuffer::LastDecodedTimestamp() const {
   return last_decoded_state_.time_stamp();
 }
 
-VCMEncodedFrame* VCMJitterBuffer::GetFrameForDecodingNACK() {
+VCMFrameBuffer* VCMJitterBuffer::GetFrameForDecodingNACK() {
   CleanUpOldFrames();
   // First look for a complete continuous__ frame.
   // When waiting for nack, wait for a key frame, if a continuous frame cannot
@@ -1075,7 +1216,7 @@ VCMEncodedFrame* VCMJitterBuffer::GetFrameForDecodingNACK() {
       return NULL;
     }
   }
-  VCMFrameBuffer* oldest_frame = *it;
+  VCMFrameBuffer* oldest_frame = UnshareFrame(it->second);
   // Update jitter estimate
   const bool retransmitted = (oldest_frame->GetNackCount() > 0);
   if (retransmitted) {
@@ -1084,7 +1225,7 @@ VCMEncodedFrame* VCMJitterBuffer::GetFrameForDecodingNACK() {
     // Ignore retransmitted and empty frames.
     UpdateJitterEstimate(*oldest_frame, false);
   }
-  it = frame_list_.erase(it);
+  frame_list_.Erase(it);
 
   // Look for previous frame loss.
   VerifyAndSetPreviousFrameLost(oldest_frame);
@@ -1111,10 +1252,52 @@ VCMEncodedFrame* VCMJitterBuffer::GetFrameForDecodingNACK() {
 // frame list. Must be called from inside the critical section crit_sect_.
 void VCMJitterBuffer::ReleaseFrameIfNotDecoding(VCMFrameBuffer* frame) {
   if (frame != NULL && frame->GetState() != kStateDecoding) {
+    FreeFrame(frame);
+  }
+}
+
+// Must be called from inside the critical section crit_sect_.
+void VCMJitterBuffer::FreeFrame(VCMFrameBuffer* frame) {
+  if (frame->Shared()) {
+    ReplaceFrameBuffer(frame, new VCMFrameBuffer());
+  } else {
     frame->SetState(kStateFree);
   }
 }
 
+VCMFrameBuffer* VCMJitterBuffer::UnshareFrame(VCMFrameBuffer* frame) {
+  if (!frame->Shared()) {
+    return frame;
+  }
+  VCMFrameBuffer* copy = new VCMFrameBuffer(*frame);
+  frame_list_.Replace(frame, copy);
+  ReplaceFrameBuffer(frame, copy);
+  return copy;
+}
+
+// Must be called from inside the critical section crit_sect_.
+void VCMJitterBuffer::ReplaceFrameBuffer(VCMFrameBuffer* old_frame,
+                                         VCMFrameBuffer* new_frame) {
+  for (int i = 0; i < max_number_of_frames_; ++i) {
+    if (frame_buffers_[i] == old_frame) {
+      frame_buffers_[i] = new_frame;
+      old_frame->Release();
+      return;
+    }
+  }
+  assert(false);
+}
+
+// Must be called from inside the critical section crit_sect_.
+bool VCMJitterBuffer::OwnsFrame(const VCMFrameBuffer* frame) const {
+  for (int i = 0; i < max_number_of_frames_; ++i) {
+    if (frame_buffers_[i] == frame) {
+      return true;
+    }
+  }
+  return false;
+}
+
 VCMFrameBuffer* VCMJitterBuffer::GetEmptyFrame() {
   if (!running_) {
     return NULL;
@@ -1162,12 +1345,13 @@ bool VCMJitterBuffer::RecycleFramesUntilKeyFrame() {
     WEBRTC_TRACE(webrtc::kTraceWarning, webrtc::kTraceVideoCoding,
                  VCMId(vcm_id_, receiver_id_),
                  "Jitter buffer drop count:%d, low_seq %d", drop_count_,
-                 (*it)->GetLowSeqNum());
-    ReleaseFrameIfNotDecoding(*it);
-    it = frame_list_.erase(it);
-    if (it != frame_list_.end() && (*it)->FrameType() == kVideoFrameKey) {
+                 it->second->GetLowSeqNum());
+    ReleaseFrameIfNotDecoding(it->second);
+    it = frame_list_.Erase(it);
+    if (it != frame_list_.end() &&
+        it->second->FrameType() == kVideoFrameKey) {
       // Fake the last_decoded_state to match this key frame.
-      last_decoded_state_.SetStateOneBack(*it);
+      last_decoded_state_.SetStateOneBack(it->second);
       return true;
     }
   }
@@ -1199,20 +1383,20 @@ VCMFrameBufferEnum VCMJitterBuffer::UpdateFrameState(VCMFrameBuffer* frame) {
   if (length != 0 && !frame->GetCountedFrame()) {
     // Ignore ACK frames.
 	//__android_log_print(ANDROID_LOG_ERROR, "yyf","%x, %d, %d", this, __LINE__, incoming_frame_count_);
+    CriticalSectionScoped stats_cs(stats_crit_sect_);
     incoming_frame_count_++;
     frame->SetCountedFrame(true);
   }
 
   // Check if we should drop the frame. A complete frame can arrive too late.
   if (last_decoded_state_.IsOldFrame(frame)) {
-    // Frame is older than the latest decoded frame, drop it. Will be
-    // released by CleanUpOldFrames later.
-    frame->Reset();
-    frame->SetState(kStateEmpty);
+    // Frame is older than the latest decoded frame, drop it.
     WEBRTC_TRACE(webrtc::kTraceDebug, webrtc::kTraceVideoCoding,
                  VCMId(vcm_id_, receiver_id_),
                  "JB(0x%x) FB(0x%x): Dropping old frame in Jitter buffer",
                  this, frame);
+    frame_list_.Remove(frame);
+    FreeFrame(frame);
     drop_count_++;
     WEBRTC_TRACE(webrtc::kTraceWarning, webrtc::kTraceVideoCoding,
                  VCMId(vcm_id_, receiver_id_),
@@ -1232,6 +1416,7 @@ VCMFrameBufferEnum VCMJitterBuffer::UpdateFrameState(VCMFrameBuffer* frame) {
   // Update receive statistics. We count all layers, thus when you use layers
   // adding all key and delta frames might differ from frame count.
   if (frame->IsSessionComplete()) {
+    CriticalSectionScoped stats_cs(stats_crit_sect_);
     switch (frame->FrameType()) {
       case kVideoFrameKey: {
         receive_statistics_[0]++;
@@ -1256,17 +1441,26 @@ VCMFrameBufferEnum VCMJitterBuffer::UpdateFrameState(VCMFrameBuffer* frame) {
   const FrameList::iterator it = FindOldestCompleteContinuousFrame(false);
   VCMFrameBuffer* old_frame = NULL;
   if (it != frame_list_.end()) {
-    old_frame = *it;
+    old_frame = it->second;
   }
 
   // Only signal if this is the oldest frame.
   // Not necessarily the case due to packet reordering or NACK.
   if (!WaitForRetransmissions() || (old_frame != NULL && old_frame == frame)) {
     frame_event_.Set();
+    if (frame_ready_callback_) {
+      frame_ready_callback_->FrameReady(frame->RenderTimeMs());
+    }
   }
   return kNoError;
 }
 
+void VCMJitterBuffer::RegisterFrameReadyCallback(
+    VCMFrameReadyCallback* callback) {
+  CriticalSectionScoped cs(crit_sect_);
+  frame_ready_callback_ = callback;
+}
+
 // Find oldest complete frame used for getting next frame to decode
 // Must be called under critical section
 FrameList::iterator VCMJitterBuffer::FindOldestCompleteContinuousFrame(
@@ -1280,7 +1474,7 @@ FrameList::iterator VCMJitterBuffer::FindOldestCompleteContinuousFrame(
   // 1. Continuous base or sync layer.
   // 2. The end of the list was reached.
   for (; it != frame_list_.end(); ++it)  {
-    oldest_frame = *it;
+    oldest_frame = it->second;
     VCMFrameBufferStateEnum state = oldest_frame->GetState();
     // Is this frame complete or decodable and continuous?
     if ((state == kStateComplete ||
@@ -1320,7 +1514,7 @@ void VCMJitterBuffer::CleanUpOldFrames() {
     }
     if (last_decoded_state_.IsOldFrame(oldest_frame)) {
       ReleaseFrameIfNotDecoding(frame_list_.front());
-      frame_list_.erase(frame_list_.begin());
+      frame_list_.Erase(frame_list_.begin());
     } else {
       break;
     }
@@ -1466,6 +1660,15 @@ void VCMJitterBuffer::GetLowHighSequenceNumbers(
   }
 }
 
+// Must be called under the critical section |crit_sect_|.
+void VCMJitterBuffer::ClearReceivedPackets(const VCMFrameBuffer& frame) {
+  if (frame.GetLowSeqNum() != -1 && frame.GetHighSeqNum() != -1) {
+    received_seq_nums_.ClearRange(
+        static_cast<uint16_t>(frame.GetLowSeqNum()),
+        static_cast<uint16_t>(frame.GetHighSeqNum()));
+  }
+}
+
 bool VCMJitterBuffer::WaitForRetransmissions() {
   if (nack_mode_ == kNoNack) {
     // NACK disabled -> don't wait for retransmissions.
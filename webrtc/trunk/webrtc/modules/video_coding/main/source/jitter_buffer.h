@@ -11,7 +11,7 @@
 #ifndef WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_JITTER_BUFFER_H_
 #define WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_JITTER_BUFFER_H_
 
-#include <list>
+#include <map>
 #include <vector>
 
 #include "webrtc/modules/interface/module_common_types.h"
@@ -21,6 +21,7 @@
 #include "webrtc/modules/video_coding/main/source/inter_frame_delay.h"
 #include "webrtc/modules/video_coding/main/source/jitter_buffer_common.h"
 #include "webrtc/modules/video_coding/main/source/jitter_estimator.h"
+#include "webrtc/modules/video_coding/main/source/sequence_number_bitmap.h"
 #include "webrtc/system_wrappers/interface/constructor_magic.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/typedefs.h"
@@ -33,14 +34,64 @@ enum VCMNackMode {
   kNoNack
 };
 
-typedef std::list<VCMFrameBuffer*> FrameList;
-
 // forward declarations
 class Clock;
 class VCMFrameBuffer;
 class VCMPacket;
 class VCMEncodedFrame;
 
+// The frames which have received packets, ordered by timestamp. Looking up
+// the frame of a packet doesn't scan the frames, and is O(1) in the common
+// case of consecutive packets belonging to the same frame.
+// The frames are keyed by their timestamp unwrapped to 64 bits, relative to
+// the frame inserted last, so the order stays well defined when the buffered
+// timestamps wrap or are more than half the timestamp range apart.
+class FrameList {
+ public:
+  typedef std::map<int64_t, VCMFrameBuffer*> FrameMap;
+  typedef FrameMap::iterator iterator;
+
+  FrameList();
+
+  iterator begin() { return frames_.begin(); }
+  iterator end() { return frames_.end(); }
+  bool empty() const { return frames_.empty(); }
+  size_t size() const { return frames_.size(); }
+  // Returns the oldest frame. Must not be called on an empty list.
+  VCMFrameBuffer* front() const { return frames_.begin()->second; }
+
+  // Inserts |frame| at the position given by its timestamp.
+  void Insert(VCMFrameBuffer* frame);
+
+  // Returns the frame with timestamp |timestamp|, or NULL if not found.
+  VCMFrameBuffer* Find(uint32_t timestamp);
+
+  // Removes the frame at |it| and returns an iterator to the next frame.
+  iterator Erase(iterator it);
+
+  // Removes |frame| from the list. Returns false if it isn't in the list.
+  // Must be called before the timestamp of |frame| is reset.
+  bool Remove(VCMFrameBuffer* frame);
+
+  // Replaces |old_frame| by |new_frame|, which has the same timestamp, if
+  // |old_frame| is in the list.
+  void Replace(VCMFrameBuffer* old_frame, VCMFrameBuffer* new_frame);
+
+  void Clear();
+
+ private:
+  int64_t Unwrap(uint32_t timestamp) const;
+  iterator FindFrame(VCMFrameBuffer* frame);
+
+  FrameMap frames_;
+  // The frame most recently inserted or found, or end().
+  iterator last_found_;
+  // Unwrapped timestamp of the frame inserted last.
+  int64_t last_timestamp_;
+
+  DISALLOW_COPY_AND_ASSIGN(FrameList);
+};
+
 struct VCMJitterSample {
   VCMJitterSample() : timestamp(0), frame_size(0), latest_packet_time(-1) {}
   uint32_t timestamp;
@@ -56,7 +107,8 @@ class VCMJitterBuffer {
                   bool master);
   virtual ~VCMJitterBuffer();
 
-  // Makes |this| a deep copy of |rhs|.
+  // Makes |this| a copy of |rhs|. The frames are shared with |rhs| and are
+  // only copied when either jitter buffer modifies them.
   void CopyFrom(const VCMJitterBuffer& rhs);
 
   // Initializes and starts jitter buffer.
@@ -127,6 +179,20 @@ class VCMJitterBuffer {
   VCMFrameBufferEnum InsertPacket(VCMEncodedFrame* frame,
                                   const VCMPacket& packet);
 
+  // As above, and also sets the encoded size of the frame to |frame_width|
+  // by |frame_height| if both are nonzero, and its render time to
+  // |render_time_ms| if this is its first packet. The frame is only written
+  // under the jitter buffer lock, as it may be shared or recycled meanwhile.
+  VCMFrameBufferEnum InsertPacket(VCMEncodedFrame* frame,
+                                  const VCMPacket& packet,
+                                  uint16_t frame_width,
+                                  uint16_t frame_height,
+                                  int64_t render_time_ms);
+
+  // Registers a callback which is called, with the jitter buffer locked,
+  // whenever a thread waiting for a complete frame would be woken up.
+  void RegisterFrameReadyCallback(VCMFrameReadyCallback* callback);
+
   // Enable a max filter on the jitter estimate, and setting of the initial
   // delay (only when in max mode). When disabled (default), the last jitter
   // estimate will be used.
@@ -159,13 +225,34 @@ class VCMJitterBuffer {
   int64_t LastDecodedTimestamp() const;
 
  private:
+  // Takes the next frame for decoding out of the jitter buffer, see
+  // GetFrameForDecoding(). Must be called under |crit_sect_|.
+  VCMFrameBuffer* ExtractFrameForDecoding();
+
   // In NACK-only mode this function doesn't return or release non-complete
   // frames unless we have a complete key frame. In hybrid mode, we may release
   // "decodable", incomplete frames.
-  VCMEncodedFrame* GetFrameForDecodingNACK();
+  VCMFrameBuffer* GetFrameForDecodingNACK();
 
   void ReleaseFrameIfNotDecoding(VCMFrameBuffer* frame);
 
+  // Sets |frame| to free. A frame shared with another jitter buffer is
+  // released and replaced by a new frame instead.
+  void FreeFrame(VCMFrameBuffer* frame);
+
+  // Returns |frame|, or a copy of it replacing it in the jitter buffer if it's
+  // shared with another jitter buffer. Must be called under |crit_sect_|
+  // before modifying a frame.
+  VCMFrameBuffer* UnshareFrame(VCMFrameBuffer* frame);
+
+  // Replaces |old_frame| by |new_frame| in |frame_buffers_| and releases
+  // |old_frame|.
+  void ReplaceFrameBuffer(VCMFrameBuffer* old_frame,
+                          VCMFrameBuffer* new_frame);
+
+  // Returns true if |frame| is one of the frames in |frame_buffers_|.
+  bool OwnsFrame(const VCMFrameBuffer* frame) const;
+
   // Gets an empty frame, creating a new frame if necessary (i.e. increases
   // jitter buffer size).
   VCMFrameBuffer* GetEmptyFrame();
@@ -215,15 +302,27 @@ class VCMJitterBuffer {
   // Returns true if we should wait for retransmissions, false otherwise.
   bool WaitForRetransmissions();
 
+  // Marks the sequence numbers of the packets inserted into |frame| as not
+  // received, used when the packets of a frame are discarded.
+  void ClearReceivedPackets(const VCMFrameBuffer& frame);
+
   int vcm_id_;
   int receiver_id_;
   Clock* clock_;
   // If we are running (have started) or not.
   bool running_;
+  // Protects the frames and the decoding state. Packet insertion and frame
+  // extraction only hold it while updating them, the payloads of an extracted
+  // frame are gathered after it's released.
   CriticalSectionWrapper* crit_sect_;
+  // Protects the statistics below, so that they can be read without waiting
+  // for |crit_sect_|. Taken after |crit_sect_| when both are needed.
+  CriticalSectionWrapper* stats_crit_sect_;
   bool master_;
   // Event to signal when we have a frame ready for decoder.
   VCMEvent frame_event_;
+  // Called together with signaling |frame_event_|.
+  VCMFrameReadyCallback* frame_ready_callback_;
   // Event to signal when we have received a packet.
   VCMEvent packet_event_;
   // Number of allocated frames.
@@ -234,7 +333,8 @@ class VCMJitterBuffer {
   VCMDecodingState last_decoded_state_;
   bool first_packet_;
 
-  // Statistics.
+  // Statistics. The members up to |incoming_bit_rate_|, and
+  // |num_discarded_packets_|, are protected by |stats_crit_sect_|.
   int num_not_decodable_packets_;
   // Frame counter for each type (key, delta, golden, key-delta).
   unsigned int receive_statistics_[4];
@@ -264,6 +364,9 @@ class VCMJitterBuffer {
   VCMNackMode nack_mode_;
   int low_rtt_nack_threshold_ms_;
   int high_rtt_nack_threshold_ms_;
+  // The sequence numbers of the packets inserted into the frames. Used to
+  // find the missing packets in NACK mode.
+  VCMSequenceNumberBitmap received_seq_nums_;
   // Holds the internal NACK list (the missing sequence numbers).
   std::vector<int> nack_seq_nums_internal_;
   std::vector<uint16_t> nack_seq_nums_;
@@ -8,15 +8,25 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
 #include <list>
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "modules/video_coding/main/source/encoded_frame.h"
 #include "modules/video_coding/main/source/jitter_buffer.h"
 #include "modules/video_coding/main/source/media_opt_util.h"
 #include "modules/video_coding/main/source/packet.h"
+#include "webrtc/system_wrappers/interface/atomic32.h"
 #include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/test/testsupport/perf_test.h"
 
 namespace webrtc {
 
@@ -138,6 +148,25 @@ class StreamGenerator {
   DISALLOW_COPY_AND_ASSIGN(StreamGenerator);
 };
 
+// Prints the 50th, 95th and 99th percentile of |ticks| in nanoseconds.
+static void PrintLatencyPercentiles(const char* measurement,
+                                    std::vector<int64_t>* ticks) {
+  if (ticks->empty())
+    return;
+  std::sort(ticks->begin(), ticks->end());
+  const int64_t ticks_per_ms = TickTime::MillisecondsToTicks(1);
+  const int kPercentiles[] = { 50, 95, 99 };
+  const char* kPercentileNames[] = { "p50", "p95", "p99" };
+  for (size_t i = 0; i < sizeof(kPercentiles) / sizeof(kPercentiles[0]);
+       ++i) {
+    const size_t index = (ticks->size() - 1) * kPercentiles[i] / 100;
+    webrtc::test::PrintResult(measurement, "", kPercentileNames[i],
+                              static_cast<size_t>(
+                                  (*ticks)[index] * 1000000 / ticks_per_ms),
+                              "ns", true);
+  }
+}
+
 class TestRunningJitterBuffer : public ::testing::Test {
  protected:
   enum { kDataBufferSize = 10 };
@@ -224,6 +253,13 @@ class TestRunningJitterBuffer : public ::testing::Test {
     return ret;
   }
 
+  static VCMFrameBufferEnum InsertPacketInto(VCMJitterBuffer* jitter_buffer,
+                                             const VCMPacket& packet) {
+    VCMEncodedFrame* frame;
+    EXPECT_EQ(VCM_OK, jitter_buffer->GetFrame(packet, frame));
+    return jitter_buffer->InsertPacket(frame, packet);
+  }
+
   VCMJitterBuffer* jitter_buffer_;
   StreamGenerator* stream_generator;
   scoped_ptr<SimulatedClock> clock_;
@@ -271,6 +307,23 @@ TEST_F(TestRunningJitterBuffer, TestEmptyPackets) {
   EXPECT_EQ(kCompleteSession, InsertPacketAndPop(0));
 }
 
+TEST_F(TestRunningJitterBuffer, TimestampJump) {
+  // An incomplete frame is left behind when the timestamps jump more than
+  // half the timestamp range.
+  stream_generator->GenerateFrame(kVideoFrameKey, 2, 0,
+                                  clock_->TimeInMilliseconds());
+  EXPECT_EQ(kFirstPacket, InsertPacketAndPop(0));
+  clock_->AdvanceTimeMilliseconds(kDefaultFramePeriodMs);
+
+  stream_generator->Init(100, 0x90000000, clock_->TimeInMilliseconds());
+  InsertFrame(kVideoFrameKey);
+  EXPECT_TRUE(DecodeCompleteFrame());
+  for (int i = 0; i < 10; ++i) {
+    InsertFrame(kVideoFrameDelta);
+    EXPECT_TRUE(DecodeCompleteFrame());
+  }
+}
+
 TEST_F(TestRunningJitterBuffer, JitterEstimateMode) {
   // Default value (should be in kLastEstimate mode).
   InsertFrame(kVideoFrameKey);
@@ -446,4 +499,321 @@ TEST_F(TestJitterBufferNack, TestNormalOperationWrap) {
     EXPECT_EQ(i * 10, list[i]);
 }
 
+TEST_F(TestJitterBufferNack, StopClearsReceivedPackets) {
+  InsertFrame(kVideoFrameKey);
+  EXPECT_TRUE(DecodeCompleteFrame());
+  stream_generator->GenerateFrame(kVideoFrameDelta, 10, 0,
+                                  clock_->TimeInMilliseconds());
+  while (stream_generator->PacketsRemaining() > 0)
+    InsertPacketAndPop(0);
+  jitter_buffer_->Stop();
+  jitter_buffer_->Start();
+
+  // The new stream reuses the sequence numbers, packet 5 is lost.
+  stream_generator->Init(0, 0, clock_->TimeInMilliseconds());
+  InsertFrame(kVideoFrameKey);
+  EXPECT_TRUE(DecodeCompleteFrame());
+  stream_generator->GenerateFrame(kVideoFrameDelta, 10, 0,
+                                  clock_->TimeInMilliseconds());
+  while (stream_generator->PacketsRemaining() > 0) {
+    if (stream_generator->NextSequenceNumber() == 5)
+      stream_generator->NextPacket(NULL);
+    else
+      InsertPacketAndPop(0);
+  }
+  uint16_t nack_list_size = 0;
+  bool extended = false;
+  uint16_t* list = jitter_buffer_->CreateNackList(&nack_list_size, &extended);
+  ASSERT_EQ(1, nack_list_size);
+  EXPECT_EQ(5, list[0]);
+}
+
+TEST_F(TestJitterBufferNack, CopyFromSharesFrames) {
+  // The dual receiver's jitter buffer shares the frames of the primary.
+  // Packets inserted into one of them must not show up in the other.
+  VCMJitterBuffer dual_jitter_buffer(clock_.get(), -1, -1, false);
+  dual_jitter_buffer.Start();
+  dual_jitter_buffer.SetNackSettings(max_nack_list_size_,
+                                     oldest_packet_to_nack_);
+  dual_jitter_buffer.SetNackMode(kNackInfinite, -1, -1);
+
+  InsertFrame(kVideoFrameKey);
+  EXPECT_TRUE(DecodeCompleteFrame());
+  stream_generator->GenerateFrame(kVideoFrameDelta, 3, 0,
+                                  clock_->TimeInMilliseconds());
+  VCMPacket packets[3];
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(stream_generator->NextPacket(&packets[i]));
+    packets[i].dataPtr = data_buffer_;
+    packets[i].sizeBytes = kDataBufferSize;
+  }
+  EXPECT_EQ(kFirstPacket, InsertPacketInto(jitter_buffer_, packets[0]));
+  EXPECT_EQ(kIncomplete, InsertPacketInto(jitter_buffer_, packets[1]));
+  dual_jitter_buffer.CopyFrom(*jitter_buffer_);
+
+  EXPECT_EQ(kCompleteSession,
+            InsertPacketInto(&dual_jitter_buffer, packets[2]));
+  VCMEncodedFrame* frame = dual_jitter_buffer.GetCompleteFrameForDecoding(0);
+  ASSERT_TRUE(frame != NULL);
+  EXPECT_EQ(3u * kDataBufferSize, frame->Length());
+  dual_jitter_buffer.ReleaseFrame(frame);
+  EXPECT_FALSE(DecodeCompleteFrame());
+
+  EXPECT_EQ(kCompleteSession, InsertPacketInto(jitter_buffer_, packets[2]));
+  frame = jitter_buffer_->GetCompleteFrameForDecoding(0);
+  ASSERT_TRUE(frame != NULL);
+  EXPECT_EQ(3u * kDataBufferSize, frame->Length());
+  jitter_buffer_->ReleaseFrame(frame);
+  dual_jitter_buffer.Stop();
+}
+
+TEST_F(TestJitterBufferNack, InsertLatencyBenchmark) {
+  // Replays a 30 fps stream with 5% random packet loss. Lost packets are
+  // retransmitted |kRttFrames| frames later, so the jitter buffer holds a
+  // window of incomplete frames while waiting for them. The time spent in
+  // GetFrame() and InsertPacket() is measured for every packet.
+  const int kNumFrames = 3000;
+  const int kKeyFrameInterval = 300;
+  const int kKeyFramePackets = 40;
+  const int kDeltaFramePackets = 8;
+  const int kLossPercent = 5;
+  const int kRttFrames = 6;
+  const int kFramePeriodMs = 33;
+  srand(1234);
+  jitter_buffer_->SetNackSettings(500, 1000);
+
+  struct Retransmission {
+    int due_frame;
+    VCMPacket packet;
+  };
+  std::list<Retransmission> retransmissions;
+  std::vector<int64_t> insert_ticks;
+  insert_ticks.reserve(kNumFrames * kDeltaFramePackets * 2);
+  int decoded_frames = 0;
+
+  for (int i = 0; i < kNumFrames; ++i) {
+    const bool key_frame = (i % kKeyFrameInterval) == 0;
+    stream_generator->GenerateFrame(
+        key_frame ? kVideoFrameKey : kVideoFrameDelta,
+        key_frame ? kKeyFramePackets : kDeltaFramePackets, 0,
+        clock_->TimeInMilliseconds());
+    std::vector<VCMPacket> packets;
+    VCMPacket packet;
+    while (stream_generator->NextPacket(&packet)) {
+      if (rand() % 100 < kLossPercent) {
+        Retransmission retransmission;
+        retransmission.due_frame = i + kRttFrames;
+        retransmission.packet = packet;
+        retransmissions.push_back(retransmission);
+      } else {
+        packets.push_back(packet);
+      }
+    }
+    std::list<Retransmission>::iterator it = retransmissions.begin();
+    while (it != retransmissions.end()) {
+      if (it->due_frame <= i) {
+        packets.push_back(it->packet);
+        it = retransmissions.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    for (size_t j = 0; j < packets.size(); ++j) {
+      packets[j].dataPtr = data_buffer_;
+      const int64_t start_ticks = TickTime::Now().Ticks();
+      VCMEncodedFrame* frame;
+      if (jitter_buffer_->GetFrame(packets[j], frame) == VCM_OK) {
+        jitter_buffer_->InsertPacket(frame, packets[j]);
+      }
+      insert_ticks.push_back(TickTime::Now().Ticks() - start_ticks);
+    }
+    uint16_t nack_list_size = 0;
+    bool extended = false;
+    jitter_buffer_->CreateNackList(&nack_list_size, &extended);
+    while (DecodeCompleteFrame()) {
+      ++decoded_frames;
+    }
+    clock_->AdvanceTimeMilliseconds(kFramePeriodMs);
+  }
+  EXPECT_GT(decoded_frames, kNumFrames / 2);
+  PrintLatencyPercentiles("jitter_buffer_insert_latency", &insert_ticks);
+}
+
+// Inserts packets on one thread while another thread extracts the complete
+// frames, the way the receive and decode threads share the jitter buffer.
+class JitterBufferContentionTest : public ::testing::Test {
+ protected:
+  enum { kNumFrames = 2000 };
+  enum { kPacketsPerFrame = 8 };
+  enum { kPacketSize = 1200 };
+  enum { kWidth = 640 };
+  enum { kHeight = 480 };
+  // How many frames the packet thread may get ahead of the decode thread.
+  enum { kMaxFramesInFlight = 4 };
+  // The threads are real-time, so they wait for each other instead of
+  // spinning.
+  enum { kMaxWaitMs = 10 };
+
+  JitterBufferContentionTest()
+      : jitter_buffer_(Clock::GetRealTimeClock(), -1, -1, true),
+        frame_inserted_event_(EventWrapper::Create()),
+        frame_decoded_event_(EventWrapper::Create()),
+        frame_inserted_for_snapshot_event_(EventWrapper::Create()),
+        done_event_(EventWrapper::Create()),
+        inserted_frames_(0),
+        decoded_frames_(0),
+        snapshots_(0) {
+    memset(data_buffer_, 0, kPacketSize);
+  }
+
+  static bool InsertThreadRun(void* obj) {
+    return static_cast<JitterBufferContentionTest*>(obj)->InsertFrame();
+  }
+
+  static bool DecodeThreadRun(void* obj) {
+    return static_cast<JitterBufferContentionTest*>(obj)->DecodeFrame();
+  }
+
+  static bool SnapshotThreadRun(void* obj) {
+    return static_cast<JitterBufferContentionTest*>(obj)->Snapshot();
+  }
+
+  bool InsertFrame() {
+    if (inserted_frames_ == kNumFrames)
+      return false;
+    if (inserted_frames_ - decoded_frames_.Value() >= kMaxFramesInFlight) {
+      frame_decoded_event_->Wait(kMaxWaitMs);
+      return true;
+    }
+    for (int i = 0; i < kPacketsPerFrame; ++i) {
+      VCMPacket packet = StreamGenerator::GeneratePacket(
+          static_cast<uint16_t>(inserted_frames_ * kPacketsPerFrame + i),
+          static_cast<uint32_t>(inserted_frames_ * 3000),
+          i == 0, i == kPacketsPerFrame - 1,
+          inserted_frames_ == 0 ? kVideoFrameKey : kVideoFrameDelta);
+      packet.dataPtr = data_buffer_;
+      packet.sizeBytes = kPacketSize;
+      const int64_t start_ticks = TickTime::Now().Ticks();
+      VCMEncodedFrame* frame;
+      if (jitter_buffer_.GetFrame(packet, frame) == VCM_OK) {
+        jitter_buffer_.InsertPacket(frame, packet, kWidth, kHeight,
+                                    packet.timestamp / 90);
+      }
+      insert_ticks_.push_back(TickTime::Now().Ticks() - start_ticks);
+    }
+    ++inserted_frames_;
+    frame_inserted_event_->Set();
+    frame_inserted_for_snapshot_event_->Set();
+    return true;
+  }
+
+  bool DecodeFrame() {
+    const int64_t start_ticks = TickTime::Now().Ticks();
+    VCMEncodedFrame* frame = jitter_buffer_.GetCompleteFrameForDecoding(0);
+    if (frame == NULL) {
+      frame_inserted_event_->Wait(kMaxWaitMs);
+      return true;
+    }
+    decode_ticks_.push_back(TickTime::Now().Ticks() - start_ticks);
+    EXPECT_EQ(static_cast<uint32_t>(kWidth),
+              frame->EncodedImage()._encodedWidth);
+    EXPECT_EQ(static_cast<uint32_t>(kHeight),
+              frame->EncodedImage()._encodedHeight);
+    EXPECT_EQ(static_cast<int64_t>(frame->TimeStamp() / 90),
+              frame->RenderTimeMs());
+    jitter_buffer_.ReleaseFrame(frame);
+    if (++decoded_frames_ == kNumFrames) {
+      done_event_->Set();
+      return false;
+    }
+    frame_decoded_event_->Set();
+    return true;
+  }
+
+  // Copies the jitter buffer and asks it for a NACK list every time a frame
+  // has been inserted, the way a dual receiver and the process thread do.
+  bool Snapshot() {
+    if (decoded_frames_.Value() == kNumFrames)
+      return false;
+    if (frame_inserted_for_snapshot_event_->Wait(kMaxWaitMs) !=
+        kEventSignaled) {
+      return true;
+    }
+    VCMJitterBuffer copy(Clock::GetRealTimeClock(), -1, -1, false);
+    copy.CopyFrom(jitter_buffer_);
+    uint16_t nack_list_size = 0;
+    bool extended = false;
+    jitter_buffer_.CreateNackList(&nack_list_size, &extended);
+    ++snapshots_;
+    return true;
+  }
+
+  VCMJitterBuffer jitter_buffer_;
+  scoped_ptr<EventWrapper> frame_inserted_event_;
+  scoped_ptr<EventWrapper> frame_decoded_event_;
+  scoped_ptr<EventWrapper> frame_inserted_for_snapshot_event_;
+  scoped_ptr<EventWrapper> done_event_;
+  // Only touched by the packet thread.
+  int inserted_frames_;
+  Atomic32 decoded_frames_;
+  Atomic32 snapshots_;
+  std::vector<int64_t> insert_ticks_;
+  std::vector<int64_t> decode_ticks_;
+  uint8_t data_buffer_[kPacketSize];
+};
+
+TEST_F(JitterBufferContentionTest, InsertAndDecodeThreadsBenchmark) {
+  jitter_buffer_.Start();
+  insert_ticks_.reserve(kNumFrames * kPacketsPerFrame);
+  decode_ticks_.reserve(kNumFrames);
+  scoped_ptr<ThreadWrapper> insert_thread(ThreadWrapper::CreateThread(
+      InsertThreadRun, this, kNormalPriority, "JitterBufferInsert"));
+  scoped_ptr<ThreadWrapper> decode_thread(ThreadWrapper::CreateThread(
+      DecodeThreadRun, this, kNormalPriority, "JitterBufferDecode"));
+  unsigned int thread_id;
+  ASSERT_TRUE(decode_thread->Start(thread_id));
+  ASSERT_TRUE(insert_thread->Start(thread_id));
+
+  EXPECT_EQ(kEventSignaled, done_event_->Wait(30000));
+  insert_thread->SetNotAlive();
+  decode_thread->SetNotAlive();
+  EXPECT_TRUE(insert_thread->Stop());
+  EXPECT_TRUE(decode_thread->Stop());
+  jitter_buffer_.Stop();
+  EXPECT_EQ(kNumFrames, decoded_frames_.Value());
+
+  PrintLatencyPercentiles("jitter_buffer_contention_insert_latency",
+                          &insert_ticks_);
+  PrintLatencyPercentiles("jitter_buffer_contention_decode_latency",
+                          &decode_ticks_);
+}
+
+TEST_F(JitterBufferContentionTest, CopyAndNackWhileInserting) {
+  jitter_buffer_.Start();
+  jitter_buffer_.SetNackMode(kNackInfinite, -1, -1);
+  insert_ticks_.reserve(kNumFrames * kPacketsPerFrame);
+  decode_ticks_.reserve(kNumFrames);
+  scoped_ptr<ThreadWrapper> insert_thread(ThreadWrapper::CreateThread(
+      InsertThreadRun, this, kNormalPriority, "JitterBufferInsert"));
+  scoped_ptr<ThreadWrapper> decode_thread(ThreadWrapper::CreateThread(
+      DecodeThreadRun, this, kNormalPriority, "JitterBufferDecode"));
+  scoped_ptr<ThreadWrapper> snapshot_thread(ThreadWrapper::CreateThread(
+      SnapshotThreadRun, this, kNormalPriority, "JitterBufferSnapshot"));
+  unsigned int thread_id;
+  ASSERT_TRUE(snapshot_thread->Start(thread_id));
+  ASSERT_TRUE(decode_thread->Start(thread_id));
+  ASSERT_TRUE(insert_thread->Start(thread_id));
+
+  EXPECT_EQ(kEventSignaled, done_event_->Wait(30000));
+  insert_thread->SetNotAlive();
+  decode_thread->SetNotAlive();
+  snapshot_thread->SetNotAlive();
+  EXPECT_TRUE(insert_thread->Stop());
+  EXPECT_TRUE(decode_thread->Stop());
+  EXPECT_TRUE(snapshot_thread->Stop());
+  jitter_buffer_.Stop();
+  EXPECT_EQ(kNumFrames, decoded_frames_.Value());
+  EXPECT_GT(snapshots_.Value(), 0);
+}
+
 }  // namespace webrtc
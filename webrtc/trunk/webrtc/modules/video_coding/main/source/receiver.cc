@@ -84,85 +84,73 @@ int32_t VCMReceiver::InsertPacket(const VCMPacket& packet, uint16_t frame_width,
     return error;
   }
   assert(buffer);
-  {
-    CriticalSectionScoped cs(crit_sect_);
+  // The receiver isn't locked here, the jitter buffer and the timing are
+  // thread-safe. Holding |crit_sect_| would make the decoding thread wait
+  // for the insertion of every packet. For the same reason |buffer| may be
+  // shared or recycled by the jitter buffer at any time, so it is only
+  // written by VCMJitterBuffer::InsertPacket().
 
-    if (frame_width && frame_height) {
-      buffer->SetEncodedSize(static_cast<uint32_t>(frame_width),
-                             static_cast<uint32_t>(frame_height));
-    }
+  if (master_) {
+    // Only trace the primary receiver to make it possible to parse and plot
+    // the trace file.
+    WEBRTC_TRACE(webrtc::kTraceDebug, webrtc::kTraceVideoCoding,
+                 VCMId(vcm_id_, receiver_id_),
+                 "Packet seq_no %u of frame %u at %u",
+                 packet.seqNum, packet.timestamp,
+                 MaskWord64ToUWord32(clock_->TimeInMilliseconds()));
+  }
 
-    if (master_) {
-      // Only trace the primary receiver to make it possible to parse and plot
-      // the trace file.
-      WEBRTC_TRACE(webrtc::kTraceDebug, webrtc::kTraceVideoCoding,
-                   VCMId(vcm_id_, receiver_id_),
-                   "Packet seq_no %u of frame %u at %u",
-                   packet.seqNum, packet.timestamp,
-                   MaskWord64ToUWord32(clock_->TimeInMilliseconds()));
-    }
+  const int64_t now_ms = clock_->TimeInMilliseconds();
 
-    const int64_t now_ms = clock_->TimeInMilliseconds();
-
-    int64_t render_time_ms = timing_->RenderTimeMs(packet.timestamp, now_ms);
-
-    if (render_time_ms < 0) {
-      // Render time error. Assume that this is due to some change in the
-      // incoming video stream and reset the JB and the timing.
-      jitter_buffer_.Flush();
-      timing_->Reset(clock_->TimeInMilliseconds());
-      return VCM_FLUSH_INDICATOR;
-    } else if (render_time_ms < now_ms - kMaxVideoDelayMs) {
-      WEBRTC_TRACE(webrtc::kTraceWarning, webrtc::kTraceVideoCoding,
-                   VCMId(vcm_id_, receiver_id_),
-                   "This frame should have been rendered more than %u ms ago."
-                   "Flushing jitter buffer and resetting timing.",
-                   kMaxVideoDelayMs);
-      jitter_buffer_.Flush();
-      timing_->Reset(clock_->TimeInMilliseconds());
-      return VCM_FLUSH_INDICATOR;
-    } else if (timing_->TargetVideoDelay() > kMaxVideoDelayMs) {
-      WEBRTC_TRACE(webrtc::kTraceWarning, webrtc::kTraceVideoCoding,
-                   VCMId(vcm_id_, receiver_id_),
-                   "More than %u ms target delay. Flushing jitter buffer and"
-                   "resetting timing.", kMaxVideoDelayMs);
-      jitter_buffer_.Flush();
-      timing_->Reset(clock_->TimeInMilliseconds());
-      return VCM_FLUSH_INDICATOR;
-    }
+  int64_t render_time_ms = timing_->RenderTimeMs(packet.timestamp, now_ms);
 
-    // First packet received belonging to this frame.
-    if (buffer->Length() == 0) {
-      const int64_t now_ms = clock_->TimeInMilliseconds();
-      if (master_) {
-        // Only trace the primary receiver to make it possible to parse and plot
-        // the trace file.
-        WEBRTC_TRACE(webrtc::kTraceDebug, webrtc::kTraceVideoCoding,
-                     VCMId(vcm_id_, receiver_id_),
-                     "First packet of frame %u at %u", packet.timestamp,
-                     MaskWord64ToUWord32(now_ms));
-      }
-      render_time_ms = timing_->RenderTimeMs(packet.timestamp, now_ms);
-      if (render_time_ms >= 0) {
-        buffer->SetRenderTime(render_time_ms);
-      } else {
-        buffer->SetRenderTime(now_ms);
-      }
-    }
+  if (render_time_ms < 0) {
+    // Render time error. Assume that this is due to some change in the
+    // incoming video stream and reset the JB and the timing.
+    jitter_buffer_.Flush();
+    timing_->Reset(clock_->TimeInMilliseconds());
+    return VCM_FLUSH_INDICATOR;
+  } else if (render_time_ms < now_ms - kMaxVideoDelayMs) {
+    WEBRTC_TRACE(webrtc::kTraceWarning, webrtc::kTraceVideoCoding,
+                 VCMId(vcm_id_, receiver_id_),
+                 "This frame should have been rendered more than %u ms ago."
+                 "Flushing jitter buffer and resetting timing.",
+                 kMaxVideoDelayMs);
+    jitter_buffer_.Flush();
+    timing_->Reset(clock_->TimeInMilliseconds());
+    return VCM_FLUSH_INDICATOR;
+  } else if (timing_->TargetVideoDelay() > kMaxVideoDelayMs) {
+    WEBRTC_TRACE(webrtc::kTraceWarning, webrtc::kTraceVideoCoding,
+                 VCMId(vcm_id_, receiver_id_),
+                 "More than %u ms target delay. Flushing jitter buffer and"
+                 "resetting timing.", kMaxVideoDelayMs);
+    jitter_buffer_.Flush();
+    timing_->Reset(clock_->TimeInMilliseconds());
+    return VCM_FLUSH_INDICATOR;
+  }
 
-    // Insert packet into the jitter buffer both media and empty packets.
+  // Insert packet into the jitter buffer both media and empty packets. The
+  // render time is only used if this is the first packet of the frame.
 	//__android_log_print(ANDROID_LOG_ERROR, "yyf","receiver insert %d, %d, %d, %x", __LINE__, vcm_id_, receiver_id_, &jitter_buffer_);
-    const VCMFrameBufferEnum
-    ret = jitter_buffer_.InsertPacket(buffer, packet);
-    if (ret == kFlushIndicator) {
-      return VCM_FLUSH_INDICATOR;
-    } else if (ret < 0) {
-      WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding,
-                   VCMId(vcm_id_, receiver_id_),
-                   "Error inserting packet seq_no=%u, time_stamp=%u",
-                   packet.seqNum, packet.timestamp);
-      return VCM_JITTER_BUFFER_ERROR;
-    }
+  const VCMFrameBufferEnum
+  ret = jitter_buffer_.InsertPacket(buffer, packet, frame_width, frame_height,
+                                    render_time_ms);
+  if (ret == kFirstPacket && master_) {
+    // Only trace the primary receiver to make it possible to parse and plot
+    // the trace file.
+    WEBRTC_TRACE(webrtc::kTraceDebug, webrtc::kTraceVideoCoding,
+                 VCMId(vcm_id_, receiver_id_),
+                 "First packet of frame %u at %u", packet.timestamp,
+                 MaskWord64ToUWord32(now_ms));
+  }
+  if (ret == kFlushIndicator) {
+    return VCM_FLUSH_INDICATOR;
+  } else if (ret < 0) {
+    WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding,
+                 VCMId(vcm_id_, receiver_id_),
+                 "Error inserting packet seq_no=%u, time_stamp=%u",
+                 packet.seqNum, packet.timestamp);
+    return VCM_JITTER_BUFFER_ERROR;
   }
   return VCM_OK;
 }
@@ -323,6 +311,11 @@ void VCMReceiver::ReleaseFrame(VCMEncodedFrame* frame) {
   jitter_buffer_.ReleaseFrame(frame);
 }
 
+void VCMReceiver::RegisterFrameReadyCallback(
+    VCMFrameReadyCallback* callback) {
+  jitter_buffer_.RegisterFrameReadyCallback(callback);
+}
+
 void VCMReceiver::ReceiveStatistics(uint32_t* bitrate,
                                     uint32_t* framerate) {
   assert(bitrate);
@@ -358,7 +351,6 @@ void VCMReceiver::SetNackSettings(size_t max_nack_list_size,
 }
 
 VCMNackMode VCMReceiver::NackMode() const {
-  CriticalSectionScoped cs(crit_sect_);
   return jitter_buffer_.nack_mode();
 }
 
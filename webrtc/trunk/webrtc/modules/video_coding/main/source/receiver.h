@@ -53,6 +53,7 @@ class VCMReceiver {
                                     bool render_timing = true,
                                     VCMReceiver* dual_receiver = NULL);
   void ReleaseFrame(VCMEncodedFrame* frame);
+  void RegisterFrameReadyCallback(VCMFrameReadyCallback* callback);
   void ReceiveStatistics(uint32_t* bitrate, uint32_t* framerate);
   void ReceivedFrameCount(VCMFrameCount* frame_count) const;
   uint32_t DiscardedPackets() const;
@@ -81,6 +82,8 @@ class VCMReceiver {
   void UpdateState(const VCMEncodedFrame& frame);
   static int32_t GenerateReceiverId();
 
+  // Protects |state_|. Packet insertion and decoding don't take it, they only
+  // use the jitter buffer and the timing, which have their own locks.
   CriticalSectionWrapper* crit_sect_;
   int32_t vcm_id_;
   Clock* clock_;
@@ -0,0 +1,115 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/video_coding/main/source/sequence_number_bitmap.h"
+
+#include <string.h>
+
+namespace webrtc {
+
+namespace {
+// Returns the mask of the |num_bits| bits starting at bit |first_bit|.
+uint32_t BitMask(int first_bit, int num_bits) {
+  if (num_bits == 32) {
+    return 0xffffffff;
+  }
+  return ((1u << num_bits) - 1) << first_bit;
+}
+}  // namespace
+
+VCMSequenceNumberBitmap::VCMSequenceNumberBitmap() {
+  Reset();
+}
+
+void VCMSequenceNumberBitmap::Reset() {
+  memset(bits_, 0, sizeof(bits_));
+  has_highest_ = false;
+  highest_seq_num_ = 0;
+}
+
+void VCMSequenceNumberBitmap::Set(uint16_t seq_num) {
+  UpdateHighest(seq_num);
+  bits_[seq_num >> 5] |= 1u << (seq_num & 31);
+}
+
+void VCMSequenceNumberBitmap::SetRange(uint16_t first, uint16_t last) {
+  UpdateHighest(last);
+  AssignRange(first, last, true);
+}
+
+void VCMSequenceNumberBitmap::ClearRange(uint16_t first, uint16_t last) {
+  AssignRange(first, last, false);
+}
+
+bool VCMSequenceNumberBitmap::Get(uint16_t seq_num) const {
+  return (bits_[seq_num >> 5] & (1u << (seq_num & 31))) != 0;
+}
+
+int VCMSequenceNumberBitmap::FindMissing(uint16_t seq_num_before,
+                                         int count,
+                                         int* missing) const {
+  int num_missing = 0;
+  int seq_num = static_cast<uint16_t>(seq_num_before + 1);
+  while (count > 0) {
+    const int first_bit = seq_num & 31;
+    const int num_bits = (32 - first_bit < count) ? 32 - first_bit : count;
+    // Words where all packets have been received are skipped at once.
+    const uint32_t missing_bits =
+        ~bits_[seq_num >> 5] & BitMask(first_bit, num_bits);
+    if (missing_bits != 0) {
+      for (int i = first_bit; i < first_bit + num_bits; ++i) {
+        if (missing_bits & (1u << i)) {
+          missing[num_missing++] = (seq_num & ~31) + i;
+        }
+      }
+    }
+    seq_num = (seq_num + num_bits) & 0xffff;
+    count -= num_bits;
+  }
+  return num_missing;
+}
+
+void VCMSequenceNumberBitmap::UpdateHighest(uint16_t seq_num) {
+  if (!has_highest_) {
+    has_highest_ = true;
+    highest_seq_num_ = seq_num;
+    return;
+  }
+  const uint16_t diff = seq_num - highest_seq_num_;
+  if (diff == 0 || diff >= 0x8000) {
+    // Not newer than the highest sequence number.
+    return;
+  }
+  // The bits in (highest, highest + 0x8000] are clear. Extend that window to
+  // (seq_num, seq_num + 0x8000].
+  AssignRange(static_cast<uint16_t>(highest_seq_num_ + 0x8001),
+              static_cast<uint16_t>(seq_num + 0x8000), false);
+  highest_seq_num_ = seq_num;
+}
+
+void VCMSequenceNumberBitmap::AssignRange(uint16_t first, uint16_t last,
+                                          bool value) {
+  int count = static_cast<uint16_t>(last - first) + 1;
+  int seq_num = first;
+  while (count > 0) {
+    const int first_bit = seq_num & 31;
+    const int num_bits = (32 - first_bit < count) ? 32 - first_bit : count;
+    const uint32_t mask = BitMask(first_bit, num_bits);
+    if (value) {
+      bits_[seq_num >> 5] |= mask;
+    } else {
+      bits_[seq_num >> 5] &= ~mask;
+    }
+    seq_num = (seq_num + num_bits) & 0xffff;
+    count -= num_bits;
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,57 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_SEQUENCE_NUMBER_BITMAP_H_
+#define WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_SEQUENCE_NUMBER_BITMAP_H_
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// One bit per RTP sequence number, used by the jitter buffer to remember
+// which packets have been received. The bits in the half of the sequence
+// number space ahead of the highest sequence number set are kept cleared, so
+// that bits set before a wrap around never show up as received packets.
+class VCMSequenceNumberBitmap {
+ public:
+  VCMSequenceNumberBitmap();
+
+  // Clears all bits.
+  void Reset();
+
+  void Set(uint16_t seq_num);
+
+  // Sets or clears all bits from |first| to |last|, both included.
+  void SetRange(uint16_t first, uint16_t last);
+  void ClearRange(uint16_t first, uint16_t last);
+
+  bool Get(uint16_t seq_num) const;
+
+  // Writes the sequence numbers of the |count| packets following
+  // |seq_num_before| that have not been set to |missing|, in sequence number
+  // order. Returns the number of sequence numbers written.
+  int FindMissing(uint16_t seq_num_before, int count, int* missing) const;
+
+ private:
+  enum { kNumWords = (1 << 16) / 32 };
+
+  // Marks |seq_num| as set and clears the bits which are now more than half
+  // the sequence number space behind it.
+  void UpdateHighest(uint16_t seq_num);
+  void AssignRange(uint16_t first, uint16_t last, bool value);
+
+  uint32_t bits_[kNumWords];
+  bool has_highest_;
+  uint16_t highest_seq_num_;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_SEQUENCE_NUMBER_BITMAP_H_
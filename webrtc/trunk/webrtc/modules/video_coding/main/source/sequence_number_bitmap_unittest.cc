@@ -0,0 +1,86 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "gtest/gtest.h"
+#include "webrtc/modules/video_coding/main/source/sequence_number_bitmap.h"
+
+namespace webrtc {
+
+TEST(TestSequenceNumberBitmap, SetAndGet) {
+  VCMSequenceNumberBitmap bitmap;
+  EXPECT_FALSE(bitmap.Get(10));
+  bitmap.Set(10);
+  EXPECT_TRUE(bitmap.Get(10));
+  EXPECT_FALSE(bitmap.Get(9));
+  EXPECT_FALSE(bitmap.Get(11));
+  bitmap.Reset();
+  EXPECT_FALSE(bitmap.Get(10));
+}
+
+TEST(TestSequenceNumberBitmap, Ranges) {
+  VCMSequenceNumberBitmap bitmap;
+  bitmap.SetRange(30, 100);
+  for (int i = 20; i < 110; ++i) {
+    EXPECT_EQ(i >= 30 && i <= 100, bitmap.Get(i)) << i;
+  }
+  bitmap.ClearRange(31, 99);
+  for (int i = 20; i < 110; ++i) {
+    EXPECT_EQ(i == 30 || i == 100, bitmap.Get(i)) << i;
+  }
+}
+
+TEST(TestSequenceNumberBitmap, FindMissing) {
+  VCMSequenceNumberBitmap bitmap;
+  for (int i = 1; i <= 100; ++i) {
+    if (i % 10 != 0) {
+      bitmap.Set(i);
+    }
+  }
+  int missing[100];
+  ASSERT_EQ(10, bitmap.FindMissing(0, 100, missing));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ((i + 1) * 10, missing[i]);
+  }
+  // Only the requested range is searched.
+  ASSERT_EQ(1, bitmap.FindMissing(20, 15, missing));
+  EXPECT_EQ(30, missing[0]);
+}
+
+TEST(TestSequenceNumberBitmap, FindMissingWrap) {
+  VCMSequenceNumberBitmap bitmap;
+  for (int i = 65500; i < 65536 + 40; ++i) {
+    if (i % 10 != 0) {
+      bitmap.Set(static_cast<uint16_t>(i));
+    }
+  }
+  int missing[100];
+  ASSERT_EQ(7, bitmap.FindMissing(65500, 75, missing));
+  EXPECT_EQ(65510, missing[0]);
+  EXPECT_EQ(65530, missing[2]);
+  EXPECT_EQ(4, missing[3]);  // 65540 wrapped.
+  EXPECT_EQ(34, missing[6]);
+}
+
+TEST(TestSequenceNumberBitmap, OldBitsClearedAfterWrap) {
+  VCMSequenceNumberBitmap bitmap;
+  bitmap.SetRange(0, 1000);
+  // Moving the highest sequence number forward by more than half the
+  // sequence number space clears the bits from the previous lap.
+  for (int i = 1000; i <= 65535; i += 100) {
+    bitmap.Set(static_cast<uint16_t>(i));
+  }
+  EXPECT_FALSE(bitmap.Get(1));
+  EXPECT_FALSE(bitmap.Get(500));
+  bitmap.Set(0);
+  EXPECT_TRUE(bitmap.Get(0));
+  EXPECT_FALSE(bitmap.Get(999));
+}
+
+}  // namespace webrtc
@@ -26,6 +26,38 @@ VCMSessionInfo::VCMSessionInfo()
       packets_not_decodable_(0) {
 }
 
+VCMSessionInfo::VCMSessionInfo(const VCMSessionInfo& rhs)
+    : session_nack_(false),
+      complete_(false),
+      decodable_(false),
+      frame_type_(kVideoFrameDelta),
+      previous_frame_loss_(false),
+      packets_(),
+      empty_seq_num_low_(-1),
+      empty_seq_num_high_(-1),
+      packets_not_decodable_(0) {
+  *this = rhs;
+}
+
+VCMSessionInfo& VCMSessionInfo::operator=(const VCMSessionInfo& rhs) {
+  if (this == &rhs)
+    return *this;
+  session_nack_ = rhs.session_nack_;
+  complete_ = rhs.complete_;
+  decodable_ = rhs.decodable_;
+  frame_type_ = rhs.frame_type_;
+  previous_frame_loss_ = rhs.previous_frame_loss_;
+  packets_ = rhs.packets_;
+  empty_seq_num_low_ = rhs.empty_seq_num_low_;
+  empty_seq_num_high_ = rhs.empty_seq_num_high_;
+  packets_not_decodable_ = rhs.packets_not_decodable_;
+  payload_buffer_ = rhs.payload_buffer_;
+  // The copied packets still point to the payloads of |rhs|.
+  if (!payload_buffer_.empty())
+    UpdateDataPointers(&rhs.payload_buffer_[0], &payload_buffer_[0]);
+  return *this;
+}
+
 void VCMSessionInfo::UpdateDataPointers(const uint8_t* old_base_ptr,
                                         const uint8_t* new_base_ptr) {
   for (PacketIterator it = packets_.begin(); it != packets_.end(); ++it)
@@ -90,6 +122,7 @@ void VCMSessionInfo::Reset() {
   frame_type_ = kVideoFrameDelta;
   previous_frame_loss_ = false;
   packets_.clear();
+  payload_buffer_.clear();
   empty_seq_num_low_ = -1;
   empty_seq_num_high_ = -1;
   packets_not_decodable_ = 0;
@@ -102,54 +135,44 @@ int VCMSessionInfo::SessionLength() const {
   return length;
 }
 
-int VCMSessionInfo::InsertBuffer(uint8_t* frame_buffer,
-                                 PacketIterator packet_it) {
-  VCMPacket& packet = *packet_it;
-  PacketIterator it;
-
-  int packet_size = packet.sizeBytes;
-  packet_size += (packet.insertStartCode ? kH264StartCodeLengthBytes : 0);
-
-  // Calculate the offset into the frame buffer for this packet.
-  int offset = 0;
-  for (it = packets_.begin(); it != packet_it; ++it)
-    offset += (*it).sizeBytes;
-
-  // Set the data pointer to pointing to the start of this packet in the
-  // frame buffer.
-  const uint8_t* data = packet.dataPtr;
-  packet.dataPtr = frame_buffer + offset;
-  packet.sizeBytes = packet_size;
-
-  ShiftSubsequentPackets(packet_it, packet_size);
+const uint8_t* VCMSessionInfo::StorePayload(const VCMPacket& packet,
+                                            int packet_size) {
+  if (packet_size == 0)
+    return NULL;
+  const uint8_t* old_base_ptr =
+      payload_buffer_.empty() ? NULL : &payload_buffer_[0];
+  const int offset = static_cast<int>(payload_buffer_.size());
+  payload_buffer_.resize(offset + packet_size);
+  // Growing the buffer may move the payloads stored so far.
+  if (old_base_ptr != NULL && old_base_ptr != &payload_buffer_[0])
+    UpdateDataPointers(old_base_ptr, &payload_buffer_[0]);
 
-  const unsigned char startCode[] = {0, 0, 0, 1};
+  uint8_t* payload = &payload_buffer_[offset];
   if (packet.insertStartCode) {
-    memcpy(const_cast<uint8_t*>(packet.dataPtr), startCode,
-           kH264StartCodeLengthBytes);
+    const unsigned char startCode[] = {0, 0, 0, 1};
+    memcpy(payload, startCode, kH264StartCodeLengthBytes);
+    payload += kH264StartCodeLengthBytes;
   }
-  memcpy(const_cast<uint8_t*>(packet.dataPtr
-      + (packet.insertStartCode ? kH264StartCodeLengthBytes : 0)),
-      data,
-      packet.sizeBytes);
-
-  return packet_size;
+  memcpy(payload, packet.dataPtr, packet.sizeBytes);
+  return &payload_buffer_[offset];
 }
 
-void VCMSessionInfo::ShiftSubsequentPackets(PacketIterator it,
-                                            int steps_to_shift) {
-  ++it;
-  if (it == packets_.end())
-    return;
-  uint8_t* first_packet_ptr = const_cast<WebRtc_UWord8*>((*it).dataPtr);
-  int shift_length = 0;
-  // Calculate the total move length and move the data pointers in advance.
-  for (; it != packets_.end(); ++it) {
-    shift_length += (*it).sizeBytes;
-    if ((*it).dataPtr != NULL)
-      (*it).dataPtr += steps_to_shift;
+int VCMSessionInfo::GatherPackets(uint8_t* frame_buffer) const {
+  int length = 0;
+  for (PacketIteratorConst it = packets_.begin(); it != packets_.end(); ++it) {
+    if ((*it).sizeBytes > 0) {
+      memcpy(frame_buffer + length, (*it).dataPtr, (*it).sizeBytes);
+      length += (*it).sizeBytes;
+    }
   }
-  memmove(first_packet_ptr + steps_to_shift, first_packet_ptr, shift_length);
+  return length;
+}
+
+int VCMSessionInfo::GatheredOffset(PacketIterator packet_it) {
+  int offset = 0;
+  for (PacketIterator it = packets_.begin(); it != packet_it; ++it)
+    offset += (*it).sizeBytes;
+  return offset;
 }
 
 void VCMSessionInfo::UpdateCompleteSession() {
@@ -258,8 +281,6 @@ int VCMSessionInfo::DeletePacketData(PacketIterator start,
     (*it).dataPtr = NULL;
     ++packets_not_decodable_;
   }
-  if (bytes_to_delete > 0)
-    ShiftSubsequentPackets(end, -bytes_to_delete);
   return bytes_to_delete;
 }
 
@@ -281,12 +302,13 @@ int VCMSessionInfo::BuildVP8FragmentationHeader(
     const int partition_id =
         (*it).codecSpecificHeader.codecHeader.VP8.partitionId;
     PacketIterator partition_end = FindPartitionEnd(it);
-    fragmentation->fragmentationOffset[partition_id] =
-        (*it).dataPtr - frame_buffer;
+    const int partition_offset = GatheredOffset(it);
+    fragmentation->fragmentationOffset[partition_id] = partition_offset;
     assert(fragmentation->fragmentationOffset[partition_id] <
            static_cast<WebRtc_UWord32>(frame_buffer_length));
     fragmentation->fragmentationLength[partition_id] =
-        (*partition_end).dataPtr + (*partition_end).sizeBytes - (*it).dataPtr;
+        GatheredOffset(partition_end) + (*partition_end).sizeBytes -
+        partition_offset;
     assert(fragmentation->fragmentationLength[partition_id] <=
            static_cast<WebRtc_UWord32>(frame_buffer_length));
     new_length += fragmentation->fragmentationLength[partition_id];
@@ -587,7 +609,6 @@ VCMSessionInfo::session_nack() const {
 }
 
 int VCMSessionInfo::InsertPacket(const VCMPacket& packet,
-                                 uint8_t* frame_buffer,
                                  bool enable_decodable_state,
                                  int rtt_ms) {
   // Check if this is first packet (only valid for some codecs)
@@ -621,14 +642,19 @@ int VCMSessionInfo::InsertPacket(const VCMPacket& packet,
       (*rit).seqNum == packet.seqNum && (*rit).sizeBytes > 0)
     return -2;
 
+  const int packet_size = packet.sizeBytes +
+      (packet.insertStartCode ? kH264StartCodeLengthBytes : 0);
+  const uint8_t* payload = StorePayload(packet, packet_size);
+
   // The insert operation invalidates the iterator |rit|.
   PacketIterator packet_list_it = packets_.insert(rit.base(), packet);
+  (*packet_list_it).dataPtr = payload;
+  (*packet_list_it).sizeBytes = packet_size;
 
-  int returnLength = InsertBuffer(frame_buffer, packet_list_it);
   UpdateCompleteSession();
   if (enable_decodable_state)
     UpdateDecodableSession(rtt_ms);
-  return returnLength;
+  return packet_size;
 }
 
 void VCMSessionInfo::InformOfEmptyPacket(uint16_t seq_num) {
@@ -12,6 +12,7 @@
 #define WEBRTC_MODULES_VIDEO_CODING_SESSION_INFO_H_
 
 #include <list>
+#include <vector>
 
 #include "modules/interface/module_common_types.h"
 #include "modules/video_coding/main/source/packet.h"
@@ -22,9 +23,9 @@ namespace webrtc {
 class VCMSessionInfo {
  public:
   VCMSessionInfo();
+  VCMSessionInfo(const VCMSessionInfo& rhs);
+  VCMSessionInfo& operator=(const VCMSessionInfo& rhs);
 
-  void UpdateDataPointers(const uint8_t* old_base_ptr,
-                          const uint8_t* new_base_ptr);
   // NACK - Building the NACK lists.
   // Build hard NACK list: Zero out all entries in list up to and including
   // _lowSeqNum.
@@ -39,23 +40,29 @@ class VCMSessionInfo {
                         int nack_seq_nums_index,
                         int rtt_ms);
   void Reset();
+  // Copies the payload of |packet| into the session. Payloads are stored in
+  // arrival order and aren't moved when a packet is inserted before them.
+  // Returns the number of payload bytes stored.
   int InsertPacket(const VCMPacket& packet,
-                   uint8_t* frame_buffer,
                    bool enable_decodable_state,
                    int rtt_ms);
+  // Copies the payloads, in sequence number order, into |frame_buffer|,
+  // which must hold at least SessionLength() bytes. Returns the number of
+  // bytes written.
+  int GatherPackets(uint8_t* frame_buffer) const;
   bool complete() const;
   bool decodable() const;
 
   // Builds fragmentation headers for VP8, each fragment being a decodable
   // VP8 partition. Returns the total number of bytes which are decodable. Is
-  // used instead of MakeDecodable for VP8.
+  // used instead of MakeDecodable for VP8. The offsets refer to the layout
+  // written by GatherPackets().
   int BuildVP8FragmentationHeader(uint8_t* frame_buffer,
                                   int frame_buffer_length,
                                   RTPFragmentationHeader* fragmentation);
 
   // Makes the frame decodable. I.e., only contain decodable NALUs. All
-  // non-decodable NALUs will be deleted and packets will be moved to in
-  // memory to remove any empty space.
+  // non-decodable NALUs will be deleted, and left out by GatherPackets().
   // Returns the number of bytes deleted from the session.
   int MakeDecodable();
   int SessionLength() const;
@@ -66,6 +73,10 @@ class VCMSessionInfo {
 
   // Returns highest sequence number, media or empty.
   int HighSequenceNumber() const;
+  // Returns the lowest and highest sequence numbers of the empty packets, or
+  // -1 if no empty packet has been inserted.
+  int EmptyLowSequenceNumber() const { return empty_seq_num_low_; }
+  int EmptyHighSequenceNumber() const { return empty_seq_num_high_; }
   int PictureId() const;
   int TemporalId() const;
   bool LayerSync() const;
@@ -87,6 +98,11 @@ class VCMSessionInfo {
   typedef PacketList::reverse_iterator ReversePacketIterator;
 
   void InformOfEmptyPacket(uint16_t seq_num);
+  void UpdateDataPointers(const uint8_t* old_base_ptr,
+                          const uint8_t* new_base_ptr);
+  // Returns the offset of the packet pointed to by |it| in the buffer written
+  // by GatherPackets().
+  int GatheredOffset(PacketIterator it);
 
   // Finds the packet of the beginning of the next VP8 partition. If
   // none is found the returned iterator points to |packets_.end()|.
@@ -103,9 +119,9 @@ class VCMSessionInfo {
                          const PacketIterator& prev_it);
   static int PacketsMissing(const PacketIterator& packet_it,
                             const PacketIterator& prev_packet_it);
-  int InsertBuffer(uint8_t* frame_buffer,
-                   PacketIterator packetIterator);
-  void ShiftSubsequentPackets(PacketIterator it, int steps_to_shift);
+  // Appends the payload of |packet| to |payload_buffer_|. Returns a pointer
+  // to the stored payload, or NULL if it's empty.
+  const uint8_t* StorePayload(const VCMPacket& packet, int packet_size);
   PacketIterator FindNaluEnd(PacketIterator packet_iter) const;
   // Deletes the data of all packets between |start| and |end|, inclusively.
   // Note that this function doesn't delete the actual packets.
@@ -135,8 +151,12 @@ class VCMSessionInfo {
   bool decodable_;
   webrtc::FrameType frame_type_;
   bool previous_frame_loss_;
-  // Packets in this frame.
+  // Packets in this frame, in sequence number order. Their data pointers
+  // point into |payload_buffer_|.
   PacketList packets_;
+  // The payloads of |packets_|, in arrival order. Keeps its capacity when the
+  // session is reset, so it's reused with the frame buffer.
+  std::vector<uint8_t> payload_buffer_;
   int empty_seq_num_low_;
   int empty_seq_num_high_;
   // Number of packets discarded because the decoder can't use them.
@@ -10,10 +10,14 @@
 
 #include <string.h>
 
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "modules/interface/module_common_types.h"
 #include "modules/video_coding/main/source/packet.h"
 #include "modules/video_coding/main/source/session_info.h"
+#include "system_wrappers/interface/tick_util.h"
+#include "test/testsupport/perf_test.h"
 
 namespace webrtc {
 
@@ -69,6 +73,7 @@ class TestVP8Partitions : public TestSessionInfo {
                        int start_value) {
     EXPECT_EQ(static_cast<uint32_t>(packets_expected * kPacketBufferSize),
               fragmentation_.fragmentationLength[partition_id]);
+    session_.GatherPackets(frame_buffer_);
     for (int i = 0; i < packets_expected; ++i) {
       int packet_index = fragmentation_.fragmentationOffset[partition_id] +
           i * kPacketBufferSize;
@@ -94,6 +99,7 @@ class TestNalUnits : public TestSessionInfo {
   bool VerifyNalu(int offset, int packets_expected, int start_value) {
     EXPECT_GE(session_.SessionLength(),
               packets_expected * kPacketBufferSize);
+    EXPECT_EQ(session_.SessionLength(), session_.GatherPackets(frame_buffer_));
     for (int i = 0; i < packets_expected; ++i) {
       int packet_index = offset * kPacketBufferSize + i * kPacketBufferSize;
       VerifyPacket(frame_buffer_ + packet_index, start_value + i);
@@ -144,7 +150,7 @@ TEST_F(TestSessionInfo, TestSimpleAPIs) {
   packet_.frameType = kVideoFrameKey;
   FillPacket(0);
   ASSERT_EQ(kPacketBufferSize,
-            session_.InsertPacket(packet_, frame_buffer_, false, 0));
+            session_.InsertPacket(packet_, false, 0));
   EXPECT_FALSE(session_.HaveLastPacket());
   EXPECT_EQ(kVideoFrameKey, session_.FrameType());
 
@@ -152,7 +158,7 @@ TEST_F(TestSessionInfo, TestSimpleAPIs) {
   packet_.markerBit = true;
   packet_.seqNum += 1;
   ASSERT_EQ(kPacketBufferSize,
-            session_.InsertPacket(packet_, frame_buffer_, false, 0));
+            session_.InsertPacket(packet_, false, 0));
   EXPECT_TRUE(session_.HaveLastPacket());
   EXPECT_EQ(packet_.seqNum, session_.HighSequenceNumber());
   EXPECT_EQ(0xFFFE, session_.LowSequenceNumber());
@@ -165,7 +171,7 @@ TEST_F(TestSessionInfo, TestSimpleAPIs) {
   packet_.sizeBytes = 0;
   packet_.frameType = kFrameEmpty;
   ASSERT_EQ(0,
-            session_.InsertPacket(packet_, frame_buffer_, false, 0));
+            session_.InsertPacket(packet_, false, 0));
   EXPECT_EQ(packet_.seqNum, session_.HighSequenceNumber());
 }
 
@@ -174,25 +180,26 @@ TEST_F(TestSessionInfo, NormalOperation) {
   packet_.isFirstPacket = true;
   packet_.markerBit = false;
   FillPacket(0);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   packet_.isFirstPacket = false;
   for (int i = 1; i < 9; ++i) {
     packet_.seqNum += 1;
     FillPacket(i);
-    ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+    ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
               kPacketBufferSize);
   }
 
   packet_.seqNum += 1;
   packet_.markerBit = true;
   FillPacket(9);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   EXPECT_EQ(0, session_.packets_not_decodable());
   EXPECT_EQ(10 * kPacketBufferSize, session_.SessionLength());
+  EXPECT_EQ(10 * kPacketBufferSize, session_.GatherPackets(frame_buffer_));
   for (int i = 0; i < 10; ++i) {
     SCOPED_TRACE("Calling VerifyPacket");
     VerifyPacket(frame_buffer_ + i * kPacketBufferSize, i);
@@ -210,7 +217,7 @@ TEST_F(TestVP8Partitions, TwoPartitionsOneLoss) {
   FillPacket(0);
   VCMPacket* packet = new VCMPacket(packet_buffer_, kPacketBufferSize,
                                     packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -221,7 +228,7 @@ TEST_F(TestVP8Partitions, TwoPartitionsOneLoss) {
   packet_header_.header.sequenceNumber += 2;
   FillPacket(2);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -232,7 +239,7 @@ TEST_F(TestVP8Partitions, TwoPartitionsOneLoss) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(3);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -258,7 +265,7 @@ TEST_F(TestVP8Partitions, TwoPartitionsOneLoss2) {
   FillPacket(1);
   VCMPacket* packet = new VCMPacket(packet_buffer_, kPacketBufferSize,
                                     packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0)
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0)
             , kPacketBufferSize);
   delete packet;
 
@@ -269,7 +276,7 @@ TEST_F(TestVP8Partitions, TwoPartitionsOneLoss2) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(2);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -280,7 +287,7 @@ TEST_F(TestVP8Partitions, TwoPartitionsOneLoss2) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(3);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -291,7 +298,7 @@ TEST_F(TestVP8Partitions, TwoPartitionsOneLoss2) {
   packet_header_.header.sequenceNumber += 2;
   FillPacket(5);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -318,7 +325,7 @@ TEST_F(TestVP8Partitions, TwoPartitionsNoLossWrap) {
   FillPacket(0);
   VCMPacket* packet = new VCMPacket(packet_buffer_, kPacketBufferSize,
                                     packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -329,7 +336,7 @@ TEST_F(TestVP8Partitions, TwoPartitionsNoLossWrap) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(1);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -340,7 +347,7 @@ TEST_F(TestVP8Partitions, TwoPartitionsNoLossWrap) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(2);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -351,7 +358,7 @@ TEST_F(TestVP8Partitions, TwoPartitionsNoLossWrap) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(3);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -378,7 +385,7 @@ TEST_F(TestVP8Partitions, TwoPartitionsLossWrap) {
   FillPacket(0);
   VCMPacket* packet = new VCMPacket(packet_buffer_, kPacketBufferSize,
                                     packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -389,7 +396,7 @@ TEST_F(TestVP8Partitions, TwoPartitionsLossWrap) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(1);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -400,7 +407,7 @@ TEST_F(TestVP8Partitions, TwoPartitionsLossWrap) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(2);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -411,7 +418,7 @@ TEST_F(TestVP8Partitions, TwoPartitionsLossWrap) {
   packet_header_.header.sequenceNumber += 2;
   FillPacket(3);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -439,7 +446,7 @@ TEST_F(TestVP8Partitions, ThreePartitionsOneMissing) {
   FillPacket(1);
   VCMPacket* packet = new VCMPacket(packet_buffer_, kPacketBufferSize,
                                     packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -450,7 +457,7 @@ TEST_F(TestVP8Partitions, ThreePartitionsOneMissing) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(2);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -461,7 +468,7 @@ TEST_F(TestVP8Partitions, ThreePartitionsOneMissing) {
   packet_header_.header.sequenceNumber += 3;
   FillPacket(5);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -472,7 +479,7 @@ TEST_F(TestVP8Partitions, ThreePartitionsOneMissing) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(6);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -499,7 +506,7 @@ TEST_F(TestVP8Partitions, ThreePartitionsLossInSecond) {
   FillPacket(1);
   VCMPacket* packet = new VCMPacket(packet_buffer_, kPacketBufferSize,
                                     packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -510,7 +517,7 @@ TEST_F(TestVP8Partitions, ThreePartitionsLossInSecond) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(2);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -521,7 +528,7 @@ TEST_F(TestVP8Partitions, ThreePartitionsLossInSecond) {
   packet_header_.header.sequenceNumber += 2;
   FillPacket(4);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -532,7 +539,7 @@ TEST_F(TestVP8Partitions, ThreePartitionsLossInSecond) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(5);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -543,7 +550,7 @@ TEST_F(TestVP8Partitions, ThreePartitionsLossInSecond) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(6);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -554,7 +561,7 @@ TEST_F(TestVP8Partitions, ThreePartitionsLossInSecond) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(7);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -581,7 +588,7 @@ TEST_F(TestVP8Partitions, AggregationOverTwoPackets) {
   FillPacket(0);
   VCMPacket* packet = new VCMPacket(packet_buffer_, kPacketBufferSize,
                                     packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -592,7 +599,7 @@ TEST_F(TestVP8Partitions, AggregationOverTwoPackets) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(1);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -603,7 +610,7 @@ TEST_F(TestVP8Partitions, AggregationOverTwoPackets) {
   packet_header_.header.sequenceNumber += 1;
   FillPacket(2);
   packet = new VCMPacket(packet_buffer_, kPacketBufferSize, packet_header_);
-  ASSERT_EQ(session_.InsertPacket(*packet, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(*packet, false, 0),
             kPacketBufferSize);
   delete packet;
 
@@ -629,7 +636,7 @@ TEST_F(TestNalUnits, OnlyReceivedEmptyPacket) {
   packet_.sizeBytes = 0;
   packet_.seqNum = 0;
   packet_.markerBit = false;
-  ASSERT_EQ(0, session_.InsertPacket(packet_, frame_buffer_, false, 0));
+  ASSERT_EQ(0, session_.InsertPacket(packet_, false, 0));
 
   EXPECT_EQ(0, session_.MakeDecodable());
   EXPECT_EQ(0, session_.SessionLength());
@@ -642,7 +649,7 @@ TEST_F(TestNalUnits, OneIsolatedNaluLoss) {
   packet_.seqNum = 0;
   packet_.markerBit = false;
   FillPacket(0);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   packet_.isFirstPacket = false;
@@ -650,7 +657,7 @@ TEST_F(TestNalUnits, OneIsolatedNaluLoss) {
   packet_.seqNum += 2;
   packet_.markerBit = true;
   FillPacket(2);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   EXPECT_EQ(0, session_.MakeDecodable());
@@ -668,7 +675,7 @@ TEST_F(TestNalUnits, LossInMiddleOfNalu) {
   packet_.seqNum = 0;
   packet_.markerBit = false;
   FillPacket(0);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   packet_.isFirstPacket = false;
@@ -676,7 +683,7 @@ TEST_F(TestNalUnits, LossInMiddleOfNalu) {
   packet_.seqNum += 2;
   packet_.markerBit = true;
   FillPacket(2);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   EXPECT_EQ(kPacketBufferSize, session_.MakeDecodable());
@@ -692,7 +699,7 @@ TEST_F(TestNalUnits, StartAndEndOfLastNalUnitLost) {
   packet_.seqNum = 0;
   packet_.markerBit = false;
   FillPacket(0);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   packet_.isFirstPacket = false;
@@ -700,7 +707,7 @@ TEST_F(TestNalUnits, StartAndEndOfLastNalUnitLost) {
   packet_.seqNum += 2;
   packet_.markerBit = false;
   FillPacket(1);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   EXPECT_EQ(kPacketBufferSize, session_.MakeDecodable());
@@ -717,7 +724,7 @@ TEST_F(TestNalUnits, ReorderWrapNoLoss) {
   packet_.seqNum += 1;
   packet_.markerBit = false;
   FillPacket(1);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   packet_.isFirstPacket = true;
@@ -725,7 +732,7 @@ TEST_F(TestNalUnits, ReorderWrapNoLoss) {
   packet_.seqNum -= 1;
   packet_.markerBit = false;
   FillPacket(0);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   packet_.isFirstPacket = false;
@@ -733,7 +740,7 @@ TEST_F(TestNalUnits, ReorderWrapNoLoss) {
   packet_.seqNum += 2;
   packet_.markerBit = true;
   FillPacket(2);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   EXPECT_EQ(0, session_.MakeDecodable());
@@ -749,7 +756,7 @@ TEST_F(TestNalUnits, WrapLosses) {
   packet_.completeNALU = kNaluIncomplete;
   packet_.markerBit = false;
   FillPacket(1);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   packet_.isFirstPacket = false;
@@ -757,7 +764,7 @@ TEST_F(TestNalUnits, WrapLosses) {
   packet_.seqNum += 2;
   packet_.markerBit = true;
   FillPacket(2);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   EXPECT_EQ(2 * kPacketBufferSize, session_.MakeDecodable());
@@ -773,7 +780,7 @@ TEST_F(TestNalUnits, ReorderWrapLosses) {
   packet_.seqNum += 2;
   packet_.markerBit = true;
   FillPacket(2);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   packet_.seqNum -= 2;
@@ -781,7 +788,7 @@ TEST_F(TestNalUnits, ReorderWrapLosses) {
   packet_.completeNALU = kNaluIncomplete;
   packet_.markerBit = false;
   FillPacket(1);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   EXPECT_EQ(2 * kPacketBufferSize, session_.MakeDecodable());
@@ -796,7 +803,7 @@ TEST_F(TestNackList, NoLosses) {
   packet_.isFirstPacket = true;
   packet_.markerBit = false;
   FillPacket(0);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   for (int i = 1; i < 9; ++i) {
@@ -804,7 +811,7 @@ TEST_F(TestNackList, NoLosses) {
     packet_.isFirstPacket = false;
     packet_.markerBit = false;
     FillPacket(i + 1);
-    ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+    ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
               kPacketBufferSize);
   }
 
@@ -812,7 +819,7 @@ TEST_F(TestNackList, NoLosses) {
   packet_.isFirstPacket = false;
   packet_.markerBit = true;
   FillPacket(10);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   EXPECT_EQ(10 * kPacketBufferSize, session_.SessionLength());
@@ -837,7 +844,7 @@ TEST_F(TestNackList, FiveLossesSpreadOut) {
   packet_.isFirstPacket = false;
   packet_.markerBit = true;
   FillPacket(0);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   for (int i = 1; i < 9; ++i) {
@@ -846,7 +853,7 @@ TEST_F(TestNackList, FiveLossesSpreadOut) {
     packet_.markerBit = false;
     FillPacket(i);
     if ((i + 1) % 2)
-      ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+      ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
                 kPacketBufferSize);
   }
 
@@ -884,7 +891,7 @@ TEST_F(TestNackList, FirstAndLastLost) {
   packet_.isFirstPacket = false;
   packet_.markerBit = false;
   FillPacket(0);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0),
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0),
             kPacketBufferSize);
 
   EXPECT_EQ(kPacketBufferSize, session_.SessionLength());
@@ -914,7 +921,7 @@ TEST_F(TestNackList, LostAllButEmptyPackets) {
   packet_.frameType = kFrameEmpty;
   packet_.sizeBytes = 0;
   FillPacket(0);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0), 0);
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0), 0);
 
   packet_.seqNum = low + 3;
   packet_.isFirstPacket = false;
@@ -922,7 +929,7 @@ TEST_F(TestNackList, LostAllButEmptyPackets) {
   packet_.frameType = kFrameEmpty;
   packet_.sizeBytes = 0;
   FillPacket(0);
-  ASSERT_EQ(session_.InsertPacket(packet_, frame_buffer_, false, 0), 0);
+  ASSERT_EQ(session_.InsertPacket(packet_, false, 0), 0);
 
   // Test soft NACKing.
   EXPECT_EQ(0, session_.SessionLength());
@@ -949,4 +956,53 @@ TEST_F(TestNackList, LostAllButEmptyPackets) {
   EXPECT_EQ(-2, seq_num_list_[3]);
   EXPECT_EQ(4, seq_num_list_[4]);
 }
+
+// Inserts key frames with the odd packets arriving before the even ones, as
+// when every other packet is retransmitted, and reports the bytes copied by
+// the session and the time to insert and gather a frame.
+TEST_F(TestSessionInfo, ReorderedKeyFrames) {
+  const int kNumFrames = 100;
+  const int kNumPackets = 200;
+  const int kPayloadSize = 1200;
+  std::vector<uint8_t> payload(kPayloadSize);
+  std::vector<uint8_t> frame(kNumPackets * kPayloadSize);
+  packet_.frameType = kVideoFrameKey;
+  packet_.sizeBytes = kPayloadSize;
+  packet_.dataPtr = &payload[0];
+
+  int64_t bytes_moved = 0;
+  int64_t ticks = 0;
+  for (int n = 0; n < kNumFrames; ++n) {
+    session_.Reset();
+    const int64_t start_ticks = TickTime::Now().Ticks();
+    for (int i = 0; i < kNumPackets; ++i) {
+      const int index = i < kNumPackets / 2 ? 2 * i + 1 :
+                                              2 * (i - kNumPackets / 2);
+      packet_.seqNum = static_cast<uint16_t>(n * kNumPackets + index);
+      packet_.isFirstPacket = index == 0;
+      packet_.markerBit = index == kNumPackets - 1;
+      payload[0] = static_cast<uint8_t>(index);
+      bytes_moved += session_.InsertPacket(packet_, false, 0);
+    }
+    ASSERT_TRUE(session_.complete());
+    bytes_moved += session_.GatherPackets(&frame[0]);
+    ticks += TickTime::Now().Ticks() - start_ticks;
+    for (int i = 0; i < kNumPackets; ++i)
+      ASSERT_EQ(static_cast<uint8_t>(i), frame[i * kPayloadSize]);
+  }
+
+  webrtc::test::PrintResult("session_info_reordered_key_frame", "",
+                            "bytes_moved",
+                            static_cast<size_t>(bytes_moved / kNumFrames),
+                            "bytes", false);
+  webrtc::test::PrintResult("session_info_reordered_key_frame", "",
+                            "frame_size",
+                            static_cast<size_t>(frame.size()), "bytes", false);
+  webrtc::test::PrintResult("session_info_reordered_key_frame", "", "time",
+                            static_cast<size_t>(
+                                ticks * 1000 /
+                                TickTime::MillisecondsToTicks(1) /
+                                kNumFrames),
+                            "us", false);
+}
 }  // namespace webrtc
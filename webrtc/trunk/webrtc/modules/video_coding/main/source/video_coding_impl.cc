@@ -49,6 +49,8 @@ VideoCodingModuleImpl::VideoCodingModuleImpl(const WebRtc_Word32 id,
 _id(id),
 clock_(clock),
 _receiveCritSect(CriticalSectionWrapper::CreateCriticalSection()),
+_processCritSect(CriticalSectionWrapper::CreateCriticalSection()),
+_processThread(NULL),
 _receiverInited(false),
 _timing(clock_, id, 1),
 _dualTiming(clock_, id, 2, &_timing),
@@ -101,6 +103,7 @@ VideoCodingModuleImpl::~VideoCodingModuleImpl()
         _codecDataBase.ReleaseDecoder(_dualDecoder);
     }
     delete _receiveCritSect;
+    delete _processCritSect;
     delete _sendCritSect;
 #ifdef DEBUG_DECODER_BIT_STREAM
     fclose(_bitStreamBeforeDecoder);
@@ -194,13 +197,15 @@ VideoCodingModuleImpl::Process()
     if (_retransmissionTimer.TimeUntilProcess() == 0)
     {
         _retransmissionTimer.Processed();
-        if (_packetRequestCallback != NULL)
+        bool callbackRegistered = false;
+        WebRtc_UWord16 length;
+        {
+            CriticalSectionScoped cs(_processCritSect);
+            callbackRegistered = _packetRequestCallback != NULL;
+            length = max_nack_list_size_;
+        }
+        if (callbackRegistered)
         {
-            WebRtc_UWord16 length;
-            {
-                CriticalSectionScoped cs(_receiveCritSect);
-                length = max_nack_list_size_;
-            }
             std::vector<uint16_t> nackList(length);
             const WebRtc_Word32 ret = NackList(&nackList[0], length);
             if (ret != VCM_OK && returnValue == VCM_OK)
@@ -209,7 +214,12 @@ VideoCodingModuleImpl::Process()
             }
             if (length > 0)
             {
-                _packetRequestCallback->ResendPackets(&nackList[0], length);
+                CriticalSectionScoped cs(_processCritSect);
+                if (_packetRequestCallback != NULL)
+                {
+                    _packetRequestCallback->ResendPackets(&nackList[0],
+                                                          length);
+                }
             }
         }
     }
@@ -218,7 +228,12 @@ VideoCodingModuleImpl::Process()
     if (_keyRequestTimer.TimeUntilProcess() == 0)
     {
         _keyRequestTimer.Processed();
-        if (_scheduleKeyRequest && _frameTypeCallback != NULL)
+        bool requestKeyFrame = false;
+        {
+            CriticalSectionScoped cs(_processCritSect);
+            requestKeyFrame = _scheduleKeyRequest && _frameTypeCallback != NULL;
+        }
+        if (requestKeyFrame)
         {
             const WebRtc_Word32 ret = RequestKeyFrame();
             if (ret != VCM_OK && returnValue == VCM_OK)
@@ -275,6 +290,26 @@ VideoCodingModuleImpl::TimeUntilNextProcess()
     return timeUntilNextProcess;
 }
 
+void
+VideoCodingModuleImpl::ProcessThreadAttached(ProcessThread* processThread)
+{
+    CriticalSectionScoped cs(_processCritSect);
+    _processThread = processThread;
+}
+
+void
+VideoCodingModuleImpl::WakeUpProcessThread()
+{
+    // The lock is held across WakeUp(), so that the thread can't be detached
+    // and destroyed meanwhile. The process thread calls modules without its
+    // own lock held, so this can't deadlock.
+    CriticalSectionScoped cs(_processCritSect);
+    if (_processThread != NULL)
+    {
+        _processThread->WakeUp(this);
+    }
+}
+
 // Get number of supported codecs
 WebRtc_UWord8
 VideoCodingModule::NumberOfCodecs()
@@ -575,6 +610,7 @@ VideoCodingModuleImpl::SetVideoProtection(VCMVideoProtection videoProtection,
             if (enable)
             {
                 _receiver.SetNackMode(kNackInfinite);
+                WakeUpProcessThread();
             }
             else
             {
@@ -590,6 +626,7 @@ VideoCodingModuleImpl::SetVideoProtection(VCMVideoProtection videoProtection,
             {
                 _receiver.SetNackMode(kNoNack);
                 _dualReceiver.SetNackMode(kNackInfinite);
+                WakeUpProcessThread();
             }
             else
             {
@@ -642,6 +679,7 @@ VideoCodingModuleImpl::SetVideoProtection(VCMVideoProtection videoProtection,
                 if (enable)
                 {
                     _receiver.SetNackMode(kNackHybrid);
+                    WakeUpProcessThread();
                 }
                 else
                 {
@@ -788,12 +826,15 @@ VideoCodingModuleImpl::InitializeReceiver()
     _decoder = NULL;
     _decodedFrameCallback.SetUserReceiveCallback(NULL);
     _receiverInited = true;
-    _frameTypeCallback = NULL;
     _frameStorageCallback = NULL;
-    _receiveStatsCallback = NULL;
-    _packetRequestCallback = NULL;
     _keyRequestMode = kKeyOnError;
-    _scheduleKeyRequest = false;
+    {
+        CriticalSectionScoped processCs(_processCritSect);
+        _frameTypeCallback = NULL;
+        _receiveStatsCallback = NULL;
+        _packetRequestCallback = NULL;
+        _scheduleKeyRequest = false;
+    }
 
     return VCM_OK;
 }
@@ -813,7 +854,7 @@ WebRtc_Word32
 VideoCodingModuleImpl::RegisterReceiveStatisticsCallback(
                                      VCMReceiveStatisticsCallback* receiveStats)
 {
-    CriticalSectionScoped cs(_receiveCritSect);
+    CriticalSectionScoped cs(_processCritSect);
     _receiveStatsCallback = receiveStats;
     return VCM_OK;
 }
@@ -841,7 +882,7 @@ WebRtc_Word32
 VideoCodingModuleImpl::RegisterFrameTypeCallback(
     VCMFrameTypeCallback* frameTypeCallback)
 {
-    CriticalSectionScoped cs(_receiveCritSect);
+    CriticalSectionScoped cs(_processCritSect);
     _frameTypeCallback = frameTypeCallback;
     return VCM_OK;
 }
@@ -859,11 +900,20 @@ WebRtc_Word32
 VideoCodingModuleImpl::RegisterPacketRequestCallback(
     VCMPacketRequestCallback* callback)
 {
-    CriticalSectionScoped cs(_receiveCritSect);
+    CriticalSectionScoped cs(_processCritSect);
     _packetRequestCallback = callback;
     return VCM_OK;
 }
 
+WebRtc_Word32
+VideoCodingModuleImpl::RegisterFrameReadyCallback(
+    VCMFrameReadyCallback* callback)
+{
+    CriticalSectionScoped cs(_receiveCritSect);
+    _receiver.RegisterFrameReadyCallback(callback);
+    return VCM_OK;
+}
+
 // Decode next frame, blocking.
 // Should be called as often as possible to get the most out of the decoder.
 WebRtc_Word32
@@ -914,6 +964,8 @@ VideoCodingModuleImpl::Decode(WebRtc_UWord16 maxWaitTimeMs)
         {
             _dualReceiver.Reset();
         }
+        // The dual receiver requests retransmissions from now on.
+        WakeUpProcessThread();
     }
 
     if (frame == NULL)
@@ -960,10 +1012,17 @@ WebRtc_Word32
 VideoCodingModuleImpl::RequestSliceLossIndication(
     const WebRtc_UWord64 pictureID) const
 {
-    if (_frameTypeCallback != NULL)
+    // The callback sends RTCP, so it is called without |_processCritSect|
+    // held.
+    VCMFrameTypeCallback* frameTypeCallback;
+    {
+        CriticalSectionScoped cs(_processCritSect);
+        frameTypeCallback = _frameTypeCallback;
+    }
+    if (frameTypeCallback != NULL)
     {
         const WebRtc_Word32 ret =
-            _frameTypeCallback->SliceLossIndicationRequest(pictureID);
+            frameTypeCallback->SliceLossIndicationRequest(pictureID);
         if (ret < 0)
         {
             WEBRTC_TRACE(webrtc::kTraceError,
@@ -986,9 +1045,14 @@ VideoCodingModuleImpl::RequestSliceLossIndication(
 WebRtc_Word32
 VideoCodingModuleImpl::RequestKeyFrame()
 {
-    if (_frameTypeCallback != NULL)
+    VCMFrameTypeCallback* frameTypeCallback;
+    {
+        CriticalSectionScoped cs(_processCritSect);
+        frameTypeCallback = _frameTypeCallback;
+    }
+    if (frameTypeCallback != NULL)
     {
-        const WebRtc_Word32 ret = _frameTypeCallback->RequestKeyFrame();
+        const WebRtc_Word32 ret = frameTypeCallback->RequestKeyFrame();
         if (ret < 0)
         {
             WEBRTC_TRACE(webrtc::kTraceError,
@@ -997,6 +1061,7 @@ VideoCodingModuleImpl::RequestKeyFrame()
                          "Failed to request key frame");
             return ret;
         }
+        CriticalSectionScoped cs(_processCritSect);
         _scheduleKeyRequest = false;
     }
     else
@@ -1129,6 +1194,7 @@ VideoCodingModuleImpl::Decode(const VCMEncodedFrame& frame)
             {
                 if (frame.FrameType() == kVideoFrameKey)
                 {
+                    CriticalSectionScoped cs(_processCritSect);
                     _scheduleKeyRequest = true;
                     return VCM_OK;
                 }
@@ -1136,6 +1202,7 @@ VideoCodingModuleImpl::Decode(const VCMEncodedFrame& frame)
             }
             case kKeyOnLoss:
             {
+                CriticalSectionScoped cs(_processCritSect);
                 _scheduleKeyRequest = true;
                 return VCM_OK;
             }
@@ -1168,7 +1235,10 @@ VideoCodingModuleImpl::ResetDecoder()
     {
         _receiver.Initialize();
         _timing.Reset();
-        _scheduleKeyRequest = false;
+        {
+            CriticalSectionScoped processCs(_processCritSect);
+            _scheduleKeyRequest = false;
+        }
         _decoder->Reset();
     }
     if (_dualReceiver.State() != kPassive)
@@ -1321,7 +1391,6 @@ VideoCodingModuleImpl::NackList(WebRtc_UWord16* nackList, WebRtc_UWord16& size)
         }
     case kNackKeyFrameRequest:
         {
-            CriticalSectionScoped cs(_receiveCritSect);
             WEBRTC_TRACE(webrtc::kTraceWarning,
                          webrtc::kTraceVideoCoding,
                          VCMId(_id),
@@ -1397,6 +1466,7 @@ int VideoCodingModuleImpl::SetReceiverRobustnessMode(
       _receiver.SetNackMode(kNackInfinite);
       _dualReceiver.SetNackMode(kNoNack);
       _keyRequestMode = kKeyOnError;  // TODO(hlundin): On long NACK list?
+      WakeUpProcessThread();
       break;
     case kSoftNack:
       assert(false); // TODO(hlundin): Not completed.
@@ -1412,6 +1482,7 @@ int VideoCodingModuleImpl::SetReceiverRobustnessMode(
       _receiver.SetNackMode(kNoNack);
       _dualReceiver.SetNackMode(kNackInfinite);
       _keyRequestMode = kKeyOnError;
+      WakeUpProcessThread();
       break;
     case kReferenceSelection:
       assert(false); // TODO(hlundin): Not completed.
@@ -1429,7 +1500,7 @@ int VideoCodingModuleImpl::SetReceiverRobustnessMode(
 void VideoCodingModuleImpl::SetNackSettings(
     size_t max_nack_list_size, int max_packet_age_to_nack) {
   if (max_nack_list_size != 0) {
-    CriticalSectionScoped cs(_receiveCritSect);
+    CriticalSectionScoped cs(_processCritSect);
     max_nack_list_size_ = max_nack_list_size;
   }
   _receiver.SetNackSettings(max_nack_list_size, max_packet_age_to_nack);
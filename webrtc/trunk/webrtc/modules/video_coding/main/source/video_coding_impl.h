@@ -15,6 +15,7 @@
 
 #include <vector>
 
+#include "webrtc/modules/utility/interface/process_thread.h"
 #include "webrtc/modules/video_coding/main/source/codec_database.h"
 #include "webrtc/modules/video_coding/main/source/frame_buffer.h"
 #include "webrtc/modules/video_coding/main/source/generic_decoder.h"
@@ -75,6 +76,8 @@ public:
 
     virtual WebRtc_Word32 Process();
 
+    virtual void ProcessThreadAttached(ProcessThread* processThread);
+
     /*
     *   Sender
     */
@@ -197,6 +200,10 @@ public:
     virtual WebRtc_Word32 RegisterPacketRequestCallback(
         VCMPacketRequestCallback* callback);
 
+    // Frame ready callback
+    virtual WebRtc_Word32 RegisterFrameReadyCallback(
+        VCMFrameReadyCallback* callback);
+
     // Decode next frame, blocks for a maximum of maxWaitTimeMs milliseconds.
     // Should be called as often as possible to get the most out of the decoder.
     virtual WebRtc_Word32 Decode(WebRtc_UWord16 maxWaitTimeMs = 200);
@@ -277,10 +284,20 @@ protected:
         const WebRtc_UWord64 pictureID) const;
     WebRtc_Word32 NackList(WebRtc_UWord16* nackList, WebRtc_UWord16& size);
 
+    // Has the process thread ask for TimeUntilNextProcess() right away, as
+    // retransmission requests may have been enabled.
+    void WakeUpProcessThread();
+
 private:
     WebRtc_Word32                       _id;
     Clock*                              clock_;
     CriticalSectionWrapper*             _receiveCritSect;
+    // Protects the state used by Process(): the frame type, packet request
+    // and receive statistics callbacks, _scheduleKeyRequest,
+    // max_nack_list_size_ and _processThread. Taken after _receiveCritSect
+    // when both are needed, so that Process() never waits for decoding.
+    CriticalSectionWrapper*             _processCritSect;
+    ProcessThread*                      _processThread;
     bool                                _receiverInited;
     VCMTiming                           _timing;
     VCMTiming                           _dualTiming;
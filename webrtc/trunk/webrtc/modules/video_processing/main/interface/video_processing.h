@@ -185,7 +185,10 @@ public:
     
     /**
        Denoises a video frame. Every frame from the stream should be passed in.
-       Has a fixed-point implementation.
+       Has a fixed-point implementation. When content analysis is enabled,
+       the denoised frame is analysed in the same pass and ContentMetrics()
+       returns its metrics; PreprocessFrame() then doesn't analyse the frame
+       again unless it is resampled.
       
        \param[in,out] frame
            Pointer to the video frame.
@@ -298,6 +301,14 @@ public:
     */
     virtual void EnableContentAnalysis(bool enable) = 0;
 
+    /**
+    Analyse every |skipNum|th row only. 0, the default, picks the
+    sub-sampling from the resolution.
+
+    \return VPM_OK on success, a negative value on error (see error codes)
+    */
+    virtual WebRtc_Word32 SetContentAnalysisSubsampling(int skipNum) = 0;
+
 };
 
 } //namespace
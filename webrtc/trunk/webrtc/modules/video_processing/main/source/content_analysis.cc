@@ -13,16 +13,27 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 namespace webrtc {
 
 VPMContentAnalysis::VPMContentAnalysis(bool runtime_cpu_detection):
-_origFrame(NULL),
 _prevFrame(NULL),
 _width(0),
 _height(0),
+_subsampling(0),
 _skipNum(1),
 _border(8),
+_widthEnd(0),
+_nextRow(0),
+_tempDiffSum(0),
+_pixelSum(0),
+_pixelSqSum(0),
+_numPixels(0),
+_spatialErrSum(0),
+_spatialErrVSum(0),
+_spatialErrHSum(0),
+_pixelMSA(0),
 _motionMagnitude(0.0f),
 _spatialPredErr(0.0f),
 _spatialPredErrH(0.0f),
@@ -43,6 +54,16 @@ _cMetrics(NULL)
                           &VPMContentAnalysis::ComputeSpatialMetrics_SSE2;
             TemporalDiffMetric = &VPMContentAnalysis::TemporalDiffMetric_SSE2;
         }
+#elif defined(WEBRTC_DETECT_ARM_NEON)
+        if ((WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) != 0)
+        {
+            ComputeSpatialMetrics =
+                          &VPMContentAnalysis::ComputeSpatialMetrics_NEON;
+            TemporalDiffMetric = &VPMContentAnalysis::TemporalDiffMetric_NEON;
+        }
+#elif defined(WEBRTC_ARCH_ARM_NEON)
+        ComputeSpatialMetrics = &VPMContentAnalysis::ComputeSpatialMetrics_NEON;
+        TemporalDiffMetric = &VPMContentAnalysis::TemporalDiffMetric_NEON;
 #endif
     }
 
@@ -63,26 +84,121 @@ VPMContentAnalysis::ComputeContentMetrics(const I420VideoFrame& inputFrame)
         return NULL;
     }
 
+    if (StartFrame(inputFrame.width(), inputFrame.height()) != VPM_OK)
+    {
+        return NULL;
+    }
+    // Only interested in the Y plane.
+    AnalyzeRows(inputFrame.buffer(kYPlane), inputFrame.stride(kYPlane),
+                _height);
+    return FinishFrame();
+}
+
+WebRtc_Word32
+VPMContentAnalysis::StartFrame(int width, int height)
+{
     // Init if needed (native dimension change)
-    if (_width != inputFrame.width() || _height != inputFrame.height())
+    if (_width != width || _height != height)
     {
-        if (VPM_OK != Initialize(inputFrame.width(), inputFrame.height()))
+        if (VPM_OK != Initialize(width, height))
         {
-            return NULL;
+            return VPM_GENERAL_ERROR;
         }
     }
-    // Only interested in the Y plane.
-    _origFrame = inputFrame.buffer(kYPlane);
+    if (_cMetrics == NULL)
+    {
+        return VPM_UNINITIALIZED;
+    }
+
+    // skip parameter: # of skipped rows: for complexity reduction
+    int skipNum = _subsampling;
+    if (skipNum == 0)
+    {
+        skipNum = 1;
+        // use skipNum = 2 for 4CIF, WHD
+        if ( (_height >=  576) && (_width >= 704) )
+        {
+            skipNum = 2;
+        }
+        // use skipNum = 4 for FULLL_HD images
+        if ( (_height >=  1080) && (_width >= 1920) )
+        {
+            skipNum = 4;
+        }
+    }
+    if (skipNum != _skipNum)
+    {
+        // The previous frame was kept for other rows.
+        _skipNum = skipNum;
+        _firstFrame = true;
+    }
+
+    _nextRow = _border;
+    _tempDiffSum = 0;
+    _pixelSum = 0;
+    _pixelSqSum = 0;
+    _numPixels = 0;
+    _spatialErrSum = 0;
+    _spatialErrVSum = 0;
+    _spatialErrHSum = 0;
+    _pixelMSA = 0;
+    return VPM_OK;
+}
+
+void
+VPMContentAnalysis::AnalyzeRows(const WebRtc_UWord8* frame, int stride,
+                                int numRows)
+{
+    // The spatial metrics need the row below each analysed row.
+    int endRow = numRows - 1;
+    if (endRow > _height - _border)
+    {
+        endRow = _height - _border;
+    }
+    if (_nextRow >= endRow)
+    {
+        return;
+    }
+    const int rows = (endRow - _nextRow + _skipNum - 1) / _skipNum;
 
     // compute spatial metrics: 3 spatial prediction errors
-    (this->*ComputeSpatialMetrics)();
+    (this->*ComputeSpatialMetrics)(frame, stride, _nextRow, rows);
 
     // compute motion metrics
     if (_firstFrame == false)
-        ComputeMotionMetrics();
+    {
+        (this->*TemporalDiffMetric)(frame, stride, _nextRow, rows);
+        _numPixels += rows * (_widthEnd - _border);
+    }
+
+    // saving current rows as previous ones: Y only
+    for (int i = 0; i < rows; i++)
+    {
+        const int row = _nextRow + i * _skipNum;
+        memcpy(_prevFrame + row * _width + _border,
+               frame + row * stride + _border, _widthEnd - _border);
+    }
+    _nextRow += rows * _skipNum;
+}
+
+VideoContentMetrics*
+VPMContentAnalysis::FinishFrame()
+{
+    if (_cMetrics == NULL)
+    {
+        return NULL;
+    }
+    NormalizeSpatialMetrics();
 
-    // saving current frame as previous one: Y only
-    memcpy(_prevFrame, _origFrame, _width * _height);
+    if (_firstFrame == false)
+    {
+        ComputeMotionMetrics();
+    }
+    else
+    {
+        // Nothing to compare with.
+        _motionMagnitude = 0.0f;
+    }
 
     _firstFrame =  false;
     _CAInit = true;
@@ -90,6 +206,17 @@ VPMContentAnalysis::ComputeContentMetrics(const I420VideoFrame& inputFrame)
     return ContentMetrics();
 }
 
+WebRtc_Word32
+VPMContentAnalysis::SetSubsampling(int skipNum)
+{
+    if (skipNum < 0)
+    {
+        return VPM_PARAMETER_ERROR;
+    }
+    _subsampling = skipNum;
+    return VPM_OK;
+}
+
 WebRtc_Word32
 VPMContentAnalysis::Release()
 {
@@ -119,29 +246,16 @@ VPMContentAnalysis::Initialize(int width, int height)
    _height = height;
    _firstFrame = true;
 
-    // skip parameter: # of skipped rows: for complexity reduction
-    //  temporal also currently uses it for column reduction.
-    _skipNum = 1;
-
-    // use skipNum = 2 for 4CIF, WHD
-    if ( (_height >=  576) && (_width >= 704) )
-    {
-        _skipNum = 2;
-    }
-    // use skipNum = 4 for FULLL_HD images
-    if ( (_height >=  1080) && (_width >= 1920) )
-    {
-        _skipNum = 4;
-    }
-
     if (_cMetrics != NULL)
     {
         delete _cMetrics;
+        _cMetrics = NULL;
     }
 
     if (_prevFrame != NULL)
     {
         delete [] _prevFrame;
+        _prevFrame = NULL;
     }
 
     // Spatial Metrics don't work on a border of 8.  Minimum processing
@@ -152,6 +266,9 @@ VPMContentAnalysis::Initialize(int width, int height)
         return VPM_PARAMETER_ERROR;
     }
 
+    // make sure work section is a multiple of 16
+    _widthEnd = ((_width - 2*_border) & -16) + _border;
+
     _cMetrics = new VideoContentMetrics();
     if (_cMetrics == NULL)
     {
@@ -170,45 +287,56 @@ VPMContentAnalysis::Initialize(int width, int height)
 
 // Compute motion metrics: magnitude over non-zero motion vectors,
 //  and size of zero cluster
+// Normalized temporal difference (MAD): used as a motion level metric
+// Normalize MAD by spatial contrast: images with more contrast
+//  (pixel variance) likely have larger temporal difference
 WebRtc_Word32
 VPMContentAnalysis::ComputeMotionMetrics()
 {
+    // default
+    _motionMagnitude = 0.0f;
+
+    if (_tempDiffSum == 0)
+    {
+        return VPM_OK;
+    }
+
+    // normalize over all pixels
+    float const tempDiffAvg = (float)_tempDiffSum / (float)(_numPixels);
+    float const pixelSumAvg = (float)_pixelSum / (float)(_numPixels);
+    float const pixelSqSumAvg = (float)_pixelSqSum / (float)(_numPixels);
+    float contrast = pixelSqSumAvg - (pixelSumAvg * pixelSumAvg);
 
-    // Motion metrics: only one is derived from normalized
-    //  (MAD) temporal difference
-    (this->*TemporalDiffMetric)();
+    if (contrast > 0.0)
+    {
+        contrast = sqrt(contrast);
+       _motionMagnitude = tempDiffAvg/contrast;
+    }
 
     return VPM_OK;
+
 }
 
-// Normalized temporal difference (MAD): used as a motion level metric
-// Normalize MAD by spatial contrast: images with more contrast
-//  (pixel variance) likely have larger temporal difference
 // To reduce complexity, we compute the metric for a reduced set of points.
-WebRtc_Word32
-VPMContentAnalysis::TemporalDiffMetric_C()
+void
+VPMContentAnalysis::TemporalDiffMetric_C(const WebRtc_UWord8* frame,
+                                         int stride,
+                                         int firstRow,
+                                         int numRows)
 {
-    // size of original frame
-    int sizei = _height;
-    int sizej = _width;
-
     WebRtc_UWord32 tempDiffSum = 0;
     WebRtc_UWord32 pixelSum = 0;
     WebRtc_UWord64 pixelSqSum = 0;
 
-    WebRtc_UWord32 numPixels = 0; // counter for # of pixels
-
-    const int width_end = ((_width - 2*_border) & -16) + _border;
-
-    for(int i = _border; i < sizei - _border; i += _skipNum)
+    for (int k = 0; k < numRows; k++)
     {
-        for(int j = _border; j < width_end; j++)
+        const int i = firstRow + k * _skipNum;
+        const WebRtc_UWord8* currRow = frame + i * stride;
+        const WebRtc_UWord8* prevRow = _prevFrame + i * _width;
+        for(int j = _border; j < _widthEnd; j++)
         {
-            numPixels += 1;
-            int ssn =  i * sizej + j;
-
-            WebRtc_UWord8 currPixel  = _origFrame[ssn];
-            WebRtc_UWord8 prevPixel  = _prevFrame[ssn];
+            WebRtc_UWord8 currPixel  = currRow[j];
+            WebRtc_UWord8 prevPixel  = prevRow[j];
 
             tempDiffSum += (WebRtc_UWord32)
                             abs((WebRtc_Word16)(currPixel - prevPixel));
@@ -217,28 +345,9 @@ VPMContentAnalysis::TemporalDiffMetric_C()
         }
     }
 
-    // default
-    _motionMagnitude = 0.0f;
-
-    if (tempDiffSum == 0)
-    {
-        return VPM_OK;
-    }
-
-    // normalize over all pixels
-    float const tempDiffAvg = (float)tempDiffSum / (float)(numPixels);
-    float const pixelSumAvg = (float)pixelSum / (float)(numPixels);
-    float const pixelSqSumAvg = (float)pixelSqSum / (float)(numPixels);
-    float contrast = pixelSqSumAvg - (pixelSumAvg * pixelSumAvg);
-
-    if (contrast > 0.0)
-    {
-        contrast = sqrt(contrast);
-       _motionMagnitude = tempDiffAvg/contrast;
-    }
-
-    return VPM_OK;
-
+    _tempDiffSum += tempDiffSum;
+    _pixelSum += pixelSum;
+    _pixelSqSum += pixelSqSum;
 }
 
 // Compute spatial metrics:
@@ -248,13 +357,12 @@ VPMContentAnalysis::TemporalDiffMetric_C()
 // The metrics are a simple estimate of the up-sampling prediction error,
 // estimated assuming sub-sampling for decimation (no filtering),
 // and up-sampling back up with simple bilinear interpolation.
-WebRtc_Word32
-VPMContentAnalysis::ComputeSpatialMetrics_C()
+void
+VPMContentAnalysis::ComputeSpatialMetrics_C(const WebRtc_UWord8* frame,
+                                            int stride,
+                                            int firstRow,
+                                            int numRows)
 {
-    //size of original frame
-    const int sizei = _height;
-    const int sizej = _width;
-
     // pixel mean square average: used to normalize the spatial metrics
     WebRtc_UWord32 pixelMSA = 0;
 
@@ -262,27 +370,19 @@ VPMContentAnalysis::ComputeSpatialMetrics_C()
     WebRtc_UWord32 spatialErrVSum = 0;
     WebRtc_UWord32 spatialErrHSum = 0;
 
-    // make sure work section is a multiple of 16
-    const int width_end = ((sizej - 2*_border) & -16) + _border;
-
-    for(int i = _border; i < sizei - _border; i += _skipNum)
+    for (int k = 0; k < numRows; k++)
     {
-        for(int j = _border; j < width_end; j++)
+        const int i = firstRow + k * _skipNum;
+        const WebRtc_UWord8* row = frame + i * stride;
+        for(int j = _border; j < _widthEnd; j++)
         {
+            WebRtc_UWord16 refPixel1  = row[j] << 1;
+            WebRtc_UWord16 refPixel2  = row[j] << 2;
 
-            int ssn1=  i * sizej + j;
-            int ssn2 = (i + 1) * sizej + j; // bottom
-            int ssn3 = (i - 1) * sizej + j; // top
-            int ssn4 = i * sizej + j + 1;   // right
-            int ssn5 = i * sizej + j - 1;   // left
-
-            WebRtc_UWord16 refPixel1  = _origFrame[ssn1] << 1;
-            WebRtc_UWord16 refPixel2  = _origFrame[ssn1] << 2;
-
-            WebRtc_UWord8 bottPixel = _origFrame[ssn2];
-            WebRtc_UWord8 topPixel = _origFrame[ssn3];
-            WebRtc_UWord8 rightPixel = _origFrame[ssn4];
-            WebRtc_UWord8 leftPixel = _origFrame[ssn5];
+            WebRtc_UWord8 bottPixel = row[j + stride];
+            WebRtc_UWord8 topPixel = row[j - stride];
+            WebRtc_UWord8 rightPixel = row[j + 1];
+            WebRtc_UWord8 leftPixel = row[j - 1];
 
             spatialErrSum  += (WebRtc_UWord32) abs((WebRtc_Word16)(refPixel2
                             - (WebRtc_UWord16)(bottPixel + topPixel
@@ -292,15 +392,24 @@ VPMContentAnalysis::ComputeSpatialMetrics_C()
             spatialErrHSum += (WebRtc_UWord32) abs((WebRtc_Word16)(refPixel1
                             - (WebRtc_UWord16)(leftPixel + rightPixel)));
 
-            pixelMSA += _origFrame[ssn1];
+            pixelMSA += row[j];
         }
     }
 
+    _spatialErrSum += spatialErrSum;
+    _spatialErrVSum += spatialErrVSum;
+    _spatialErrHSum += spatialErrHSum;
+    _pixelMSA += pixelMSA;
+}
+
+void
+VPMContentAnalysis::NormalizeSpatialMetrics()
+{
     // normalize over all pixels
-    const float spatialErr  = (float)(spatialErrSum >> 2);
-    const float spatialErrH = (float)(spatialErrHSum >> 1);
-    const float spatialErrV = (float)(spatialErrVSum >> 1);
-    const float norm = (float)pixelMSA;
+    const float spatialErr  = (float)(_spatialErrSum >> 2);
+    const float spatialErrH = (float)(_spatialErrHSum >> 1);
+    const float spatialErrV = (float)(_spatialErrVSum >> 1);
+    const float norm = (float)_pixelMSA;
 
     // 2X2:
     _spatialPredErr = spatialErr / norm;
@@ -310,8 +419,6 @@ VPMContentAnalysis::ComputeSpatialMetrics_C()
 
     // 2X1:
     _spatialPredErrV = spatialErrV / norm;
-
-    return VPM_OK;
 }
 
 VideoContentMetrics*
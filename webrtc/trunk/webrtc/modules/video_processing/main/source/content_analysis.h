@@ -32,6 +32,12 @@ public:
     // Return value:   0 if OK, negative value upon error
     WebRtc_Word32 Initialize(int width, int height);
 
+    // Analyse every |skipNum|th row only. 0, the default, picks the
+    // sub-sampling from the resolution: every 2nd row from 4CIF and every 4th
+    // from 1080p. Takes effect from the next frame.
+    // Return value:   0 if OK, negative value upon error
+    WebRtc_Word32 SetSubsampling(int skipNum);
+
     // Extract content Feature - main function of ContentAnalysis
     // Input:           new frame
     // Return value:    pointer to structure containing content Analysis
@@ -39,6 +45,15 @@ public:
     VideoContentMetrics* ComputeContentMetrics(const I420VideoFrame&
                                                inputFrame);
 
+    // Incremental analysis, for callers that write the frame a band of rows
+    // at a time and want it analysed while the rows are still in the cache:
+    // StartFrame(), AnalyzeRows() each time more rows are final, and
+    // FinishFrame(). The metrics are the same as from ComputeContentMetrics().
+    WebRtc_Word32 StartFrame(int width, int height);
+    // Rows [0, numRows) of the Y plane |frame| are final.
+    void AnalyzeRows(const WebRtc_UWord8* frame, int stride, int numRows);
+    VideoContentMetrics* FinishFrame();
+
     // Release all allocated memory
     // Output: 0 if OK, negative value upon error
     WebRtc_Word32 Release();
@@ -48,31 +63,65 @@ private:
     // return motion metrics
     VideoContentMetrics* ContentMetrics();
 
+    // The kernels add the sums of |numRows| rows, |_skipNum| rows apart and
+    // starting at |firstRow|, to the sums of the current frame.
+
     // Normalized temporal difference metric: for motion magnitude
-    typedef WebRtc_Word32 (VPMContentAnalysis::*TemporalDiffMetricFunc)();
+    typedef void (VPMContentAnalysis::*TemporalDiffMetricFunc)(
+        const WebRtc_UWord8* frame, int stride, int firstRow, int numRows);
     TemporalDiffMetricFunc TemporalDiffMetric;
-    WebRtc_Word32 TemporalDiffMetric_C();
+    void TemporalDiffMetric_C(const WebRtc_UWord8* frame, int stride,
+                              int firstRow, int numRows);
 
     // Motion metric method: call 2 metrics (magnitude and size)
     WebRtc_Word32 ComputeMotionMetrics();
 
     // Spatial metric method: computes the 3 frame-average spatial
     //  prediction errors (1x2,2x1,2x2)
-    typedef WebRtc_Word32 (VPMContentAnalysis::*ComputeSpatialMetricsFunc)();
+    typedef void (VPMContentAnalysis::*ComputeSpatialMetricsFunc)(
+        const WebRtc_UWord8* frame, int stride, int firstRow, int numRows);
     ComputeSpatialMetricsFunc ComputeSpatialMetrics;
-    WebRtc_Word32 ComputeSpatialMetrics_C();
+    void ComputeSpatialMetrics_C(const WebRtc_UWord8* frame, int stride,
+                                 int firstRow, int numRows);
+
+    // Turns the spatial sums into the prediction errors.
+    void NormalizeSpatialMetrics();
 
 #if defined(WEBRTC_ARCH_X86_FAMILY)
-    WebRtc_Word32 ComputeSpatialMetrics_SSE2();
-    WebRtc_Word32 TemporalDiffMetric_SSE2();
+    void ComputeSpatialMetrics_SSE2(const WebRtc_UWord8* frame, int stride,
+                                    int firstRow, int numRows);
+    void TemporalDiffMetric_SSE2(const WebRtc_UWord8* frame, int stride,
+                                 int firstRow, int numRows);
+#endif
+#if defined(WEBRTC_ARCH_ARM_NEON) || defined(WEBRTC_DETECT_ARM_NEON)
+    void ComputeSpatialMetrics_NEON(const WebRtc_UWord8* frame, int stride,
+                                    int firstRow, int numRows);
+    void TemporalDiffMetric_NEON(const WebRtc_UWord8* frame, int stride,
+                                 int firstRow, int numRows);
 #endif
 
-    const WebRtc_UWord8*       _origFrame;
+    // Only the analysed part of the rows that are analysed is kept, with
+    // |_width| bytes between rows.
     WebRtc_UWord8*             _prevFrame;
     int                        _width;
     int                        _height;
+    int                        _subsampling;
     int                        _skipNum;
     int                        _border;
+    // End of the analysed columns; the width analysed is a multiple of 16.
+    int                        _widthEnd;
+    // Next row to analyse in the current frame.
+    int                        _nextRow;
+
+    // Sums over the rows analysed so far in the current frame.
+    WebRtc_UWord32         _tempDiffSum;
+    WebRtc_UWord32         _pixelSum;
+    WebRtc_UWord64         _pixelSqSum;
+    WebRtc_UWord32         _numPixels;
+    WebRtc_UWord32         _spatialErrSum;
+    WebRtc_UWord32         _spatialErrVSum;
+    WebRtc_UWord32         _spatialErrHSum;
+    WebRtc_UWord32         _pixelMSA;
 
     // Content Metrics:
     // stores the local average of the metrics
@@ -0,0 +1,178 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "content_analysis.h"
+
+#include <arm_neon.h>
+
+namespace webrtc {
+
+namespace {
+
+// Blocks of 16 pixels that can be added to a 16 bit lane accumulator of
+// pairwise sums of 8 bit values, 2*255 per block, without rolling over.
+enum { kMaxBlocksPer16BitSum = 128 };
+
+inline WebRtc_UWord64 HorizontalSum(uint64x2_t sum)
+{
+    return vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1);
+}
+
+inline WebRtc_UWord64 HorizontalSum(uint32x4_t sum)
+{
+    return HorizontalSum(vpaddlq_u32(sum));
+}
+
+}  // namespace
+
+void
+VPMContentAnalysis::TemporalDiffMetric_NEON(const WebRtc_UWord8* frame,
+                                            int stride,
+                                            int firstRow,
+                                            int numRows)
+{
+    const WebRtc_UWord8* imgBufO = frame + firstRow*stride + _border;
+    const WebRtc_UWord8* imgBufP = _prevFrame + firstRow*_width + _border;
+    const int blocks = (_widthEnd - _border) / 16;
+
+    uint32x4_t sad_32 = vdupq_n_u32(0);
+    uint32x4_t sum_32 = vdupq_n_u32(0);
+    uint64x2_t sqsum_64 = vdupq_n_u64(0);
+
+    for (int i = 0; i < numRows; i++)
+    {
+        const WebRtc_UWord8* lineO = imgBufO;
+        const WebRtc_UWord8* lineP = imgBufP;
+
+        // o*o is at most 65025, so a 32 bit lane holds the pairwise sums of
+        // a row of up to 16384 blocks.
+        uint32x4_t sqsum_32 = vdupq_n_u32(0);
+
+        for (int j = 0; j < blocks; j += kMaxBlocksPer16BitSum)
+        {
+            const int end = (blocks - j < kMaxBlocksPer16BitSum) ?
+                blocks - j : kMaxBlocksPer16BitSum;
+            uint16x8_t sad_16 = vdupq_n_u16(0);
+            uint16x8_t sum_16 = vdupq_n_u16(0);
+
+            for (int k = 0; k < end; k++)
+            {
+                const uint8x16_t o = vld1q_u8(lineO);
+                const uint8x16_t p = vld1q_u8(lineP);
+                lineO += 16;
+                lineP += 16;
+
+                // abs pixel difference between frames
+                sad_16 = vpadalq_u8(sad_16, vabdq_u8(o, p));
+
+                // sum of all pixels in frame
+                sum_16 = vpadalq_u8(sum_16, o);
+
+                // squared sum of all pixels in frame
+                const uint8x8_t olo = vget_low_u8(o);
+                const uint8x8_t ohi = vget_high_u8(o);
+                sqsum_32 = vpadalq_u16(sqsum_32, vmull_u8(olo, olo));
+                sqsum_32 = vpadalq_u16(sqsum_32, vmull_u8(ohi, ohi));
+            }
+
+            sad_32 = vpadalq_u16(sad_32, sad_16);
+            sum_32 = vpadalq_u16(sum_32, sum_16);
+        }
+
+        // Add to 64 bit running sum as to not roll over.
+        sqsum_64 = vpadalq_u32(sqsum_64, sqsum_32);
+
+        imgBufO += stride * _skipNum;
+        imgBufP += _width * _skipNum;
+    }
+
+    _tempDiffSum += HorizontalSum(sad_32);
+    _pixelSum += HorizontalSum(sum_32);
+    _pixelSqSum += HorizontalSum(sqsum_64);
+}
+
+void
+VPMContentAnalysis::ComputeSpatialMetrics_NEON(const WebRtc_UWord8* frame,
+                                               int stride,
+                                               int firstRow,
+                                               int numRows)
+{
+    const WebRtc_UWord8* imgBuf = frame + firstRow*stride;
+    const int blocks = (_widthEnd - _border) / 16;
+
+    // Unlike the SSE2 version, the differences are added to 32 bit lanes
+    // right away, so the result is the same as the C version for any content.
+    uint32x4_t se_32 = vdupq_n_u32(0);
+    uint32x4_t sev_32 = vdupq_n_u32(0);
+    uint32x4_t seh_32 = vdupq_n_u32(0);
+    uint32x4_t msa_32 = vdupq_n_u32(0);
+
+    for (int i = 0; i < numRows; i++)
+    {
+        const WebRtc_UWord8* lineTop = imgBuf - stride + _border;
+        const WebRtc_UWord8* lineCen = imgBuf + _border;
+        const WebRtc_UWord8* lineBot = imgBuf + stride + _border;
+        uint16x8_t msa_16 = vdupq_n_u16(0);
+
+        // A 16 bit lane of pixel sums holds up to 128 blocks.
+        for (int j = 0; j < blocks; j++)
+        {
+            const uint8x16_t t = vld1q_u8(lineTop);
+            const uint8x16_t l = vld1q_u8(lineCen - 1);
+            const uint8x16_t c = vld1q_u8(lineCen);
+            const uint8x16_t r = vld1q_u8(lineCen + 1);
+            const uint8x16_t b = vld1q_u8(lineBot);
+
+            lineTop += 16;
+            lineCen += 16;
+            lineBot += 16;
+
+            // running sum of all pixels
+            msa_16 = vpadalq_u8(msa_16, c);
+            if ((j & (kMaxBlocksPer16BitSum - 1)) ==
+                kMaxBlocksPer16BitSum - 1)
+            {
+                msa_32 = vpadalq_u16(msa_32, msa_16);
+                msa_16 = vdupq_n_u16(0);
+            }
+
+            // top & bottom and left & right pixels added together
+            const uint16x8_t tblo = vaddl_u8(vget_low_u8(t), vget_low_u8(b));
+            const uint16x8_t tbhi = vaddl_u8(vget_high_u8(t),
+                                             vget_high_u8(b));
+            const uint16x8_t lrlo = vaddl_u8(vget_low_u8(l), vget_low_u8(r));
+            const uint16x8_t lrhi = vaddl_u8(vget_high_u8(l),
+                                             vget_high_u8(r));
+
+            const uint16x8_t c1lo = vshll_n_u8(vget_low_u8(c), 1);
+            const uint16x8_t c1hi = vshll_n_u8(vget_high_u8(c), 1);
+            const uint16x8_t c2lo = vshll_n_u8(vget_low_u8(c), 2);
+            const uint16x8_t c2hi = vshll_n_u8(vget_high_u8(c), 2);
+
+            // Add to 32 bit running sum
+            se_32 = vpadalq_u16(se_32, vabdq_u16(c2lo, vaddq_u16(tblo, lrlo)));
+            se_32 = vpadalq_u16(se_32, vabdq_u16(c2hi, vaddq_u16(tbhi, lrhi)));
+            sev_32 = vpadalq_u16(sev_32, vabdq_u16(c1lo, tblo));
+            sev_32 = vpadalq_u16(sev_32, vabdq_u16(c1hi, tbhi));
+            seh_32 = vpadalq_u16(seh_32, vabdq_u16(c1lo, lrlo));
+            seh_32 = vpadalq_u16(seh_32, vabdq_u16(c1hi, lrhi));
+        }
+
+        msa_32 = vpadalq_u16(msa_32, msa_16);
+        imgBuf += stride * _skipNum;
+    }
+
+    _spatialErrSum += HorizontalSum(se_32);
+    _spatialErrVSum += HorizontalSum(sev_32);
+    _spatialErrHSum += HorizontalSum(seh_32);
+    _pixelMSA += HorizontalSum(msa_32);
+}
+
+}  // namespace webrtc
@@ -11,26 +11,26 @@
 #include "content_analysis.h"
 
 #include <emmintrin.h>
-#include <math.h>
 
 namespace webrtc {
 
-WebRtc_Word32
-VPMContentAnalysis::TemporalDiffMetric_SSE2()
+void
+VPMContentAnalysis::TemporalDiffMetric_SSE2(const WebRtc_UWord8* frame,
+                                            int stride,
+                                            int firstRow,
+                                            int numRows)
 {
-    WebRtc_UWord32 numPixels = 0;       // counter for # of pixels
+    const WebRtc_UWord8* imgBufO = frame + firstRow*stride + _border;
+    const WebRtc_UWord8* imgBufP = _prevFrame + firstRow*_width + _border;
 
-    const WebRtc_UWord8* imgBufO = _origFrame + _border*_width + _border;
-    const WebRtc_UWord8* imgBufP = _prevFrame + _border*_width + _border;
-
-    const WebRtc_Word32 width_end = ((_width - 2*_border) & -16) + _border;
+    const WebRtc_Word32 width_end = _widthEnd;
 
     __m128i sad_64   = _mm_setzero_si128();
     __m128i sum_64   = _mm_setzero_si128();
     __m128i sqsum_64 = _mm_setzero_si128();
     const __m128i z  = _mm_setzero_si128();
 
-    for(WebRtc_UWord16 i = 0; i < (_height - 2*_border); i += _skipNum)
+    for(WebRtc_Word32 i = 0; i < numRows; i++)
     {
         __m128i sqsum_32  = _mm_setzero_si128();
 
@@ -75,9 +75,8 @@ VPMContentAnalysis::TemporalDiffMetric_SSE2()
                                 _mm_add_epi64(_mm_unpackhi_epi32(sqsum_32,z),
                                               _mm_unpacklo_epi32(sqsum_32,z)));
 
-        imgBufO += _width * _skipNum;
+        imgBufO += stride * _skipNum;
         imgBufP += _width * _skipNum;
-        numPixels += (width_end - _border);
     }
 
     __m128i sad_final_128;
@@ -97,38 +96,19 @@ VPMContentAnalysis::TemporalDiffMetric_SSE2()
     WebRtc_UWord64 *sqsum_final_64 =
                    reinterpret_cast<WebRtc_UWord64*>(&sqsum_final_128);
 
-    const WebRtc_UWord32 pixelSum = sum_final_64[0] + sum_final_64[1];
-    const WebRtc_UWord64 pixelSqSum = sqsum_final_64[0] + sqsum_final_64[1];
-    const WebRtc_UWord32 tempDiffSum = sad_final_64[0] + sad_final_64[1];
-
-    // default
-    _motionMagnitude = 0.0f;
-
-    if (tempDiffSum == 0)
-    {
-        return VPM_OK;
-    }
-
-    // normalize over all pixels
-    const float tempDiffAvg = (float)tempDiffSum / (float)(numPixels);
-    const float pixelSumAvg = (float)pixelSum / (float)(numPixels);
-    const float pixelSqSumAvg = (float)pixelSqSum / (float)(numPixels);
-    float contrast = pixelSqSumAvg - (pixelSumAvg * pixelSumAvg);
-
-    if (contrast > 0.0)
-    {
-        contrast = sqrt(contrast);
-       _motionMagnitude = tempDiffAvg/contrast;
-    }
-
-    return VPM_OK;
+    _pixelSum += sum_final_64[0] + sum_final_64[1];
+    _pixelSqSum += sqsum_final_64[0] + sqsum_final_64[1];
+    _tempDiffSum += sad_final_64[0] + sad_final_64[1];
 }
 
-WebRtc_Word32
-VPMContentAnalysis::ComputeSpatialMetrics_SSE2()
+void
+VPMContentAnalysis::ComputeSpatialMetrics_SSE2(const WebRtc_UWord8* frame,
+                                               int stride,
+                                               int firstRow,
+                                               int numRows)
 {
-    const WebRtc_UWord8* imgBuf = _origFrame + _border*_width;
-    const WebRtc_Word32 width_end = ((_width - 2*_border) & -16) + _border;
+    const WebRtc_UWord8* imgBuf = frame + firstRow*stride;
+    const WebRtc_Word32 width_end = _widthEnd;
 
     __m128i se_32  = _mm_setzero_si128();
     __m128i sev_32 = _mm_setzero_si128();
@@ -141,7 +121,7 @@ VPMContentAnalysis::ComputeSpatialMetrics_SSE2()
     // value is maxed out at 65529 for every row, 65529*1080 = 70777800, which
     // will not roll over a 32 bit accumulator.
     // _skipNum is also used to reduce the number of rows
-    for(WebRtc_Word32 i = 0; i < (_height - 2*_border); i += _skipNum)
+    for(WebRtc_Word32 i = 0; i < numRows; i++)
     {
         __m128i se_16  = _mm_setzero_si128();
         __m128i sev_16 = _mm_setzero_si128();
@@ -158,9 +138,9 @@ VPMContentAnalysis::ComputeSpatialMetrics_SSE2()
         // _border could also be adjusted to concentrate on just the center of
         // the images for an HD capture in order to reduce the possiblity of
         // rollover.
-        const WebRtc_UWord8 *lineTop = imgBuf - _width + _border;
+        const WebRtc_UWord8 *lineTop = imgBuf - stride + _border;
         const WebRtc_UWord8 *lineCen = imgBuf + _border;
-        const WebRtc_UWord8 *lineBot = imgBuf + _width + _border;
+        const WebRtc_UWord8 *lineBot = imgBuf + stride + _border;
 
         for(WebRtc_Word32 j = 0; j < width_end - _border; j += 16)
         {
@@ -242,7 +222,7 @@ VPMContentAnalysis::ComputeSpatialMetrics_SSE2()
                                _mm_add_epi32(_mm_unpackhi_epi16(msa_16,z),
                                              _mm_unpacklo_epi16(msa_16,z)));
 
-        imgBuf += _width * _skipNum;
+        imgBuf += stride * _skipNum;
     }
 
     __m128i se_128;
@@ -274,27 +254,10 @@ VPMContentAnalysis::ComputeSpatialMetrics_SSE2()
     WebRtc_UWord64 *msa_64 =
                    reinterpret_cast<WebRtc_UWord64*>(&msa_128);
 
-    const WebRtc_UWord32 spatialErrSum  = se_64[0] + se_64[1];
-    const WebRtc_UWord32 spatialErrVSum = sev_64[0] + sev_64[1];
-    const WebRtc_UWord32 spatialErrHSum = seh_64[0] + seh_64[1];
-    const WebRtc_UWord32 pixelMSA = msa_64[0] + msa_64[1];
-
-    // normalize over all pixels
-    const float spatialErr  = (float)(spatialErrSum >> 2);
-    const float spatialErrH = (float)(spatialErrHSum >> 1);
-    const float spatialErrV = (float)(spatialErrVSum >> 1);
-    const float norm = (float)pixelMSA;
-
-    // 2X2:
-    _spatialPredErr = spatialErr / norm;
-
-    // 1X2:
-    _spatialPredErrH = spatialErrH / norm;
-
-    // 2X1:
-    _spatialPredErrV = spatialErrV / norm;
-
-    return VPM_OK;
+    _spatialErrSum  += se_64[0] + se_64[1];
+    _spatialErrVSum += sev_64[0] + sev_64[1];
+    _spatialErrHSum += seh_64[0] + seh_64[1];
+    _pixelMSA += msa_64[0] + msa_64[1];
 }
 
 }  // namespace webrtc
@@ -12,6 +12,7 @@
 #ifndef GXH_TEST_H264
 #include "math.h"//gxh
 #endif
+#include "cpu_features_wrapper.h"
 #include "trace.h"
 
 #include <cstring>
@@ -24,20 +25,46 @@ enum { kSubsamplingHeight = 0 };     // Sub-sampling in height (unit: power of 2
 enum { kDenoiseFiltParam = 179 };    // (Q8) De-noising filter parameter
 enum { kDenoiseFiltParamRec = 77 };  // (Q8) 1 - filter parameter
 enum { kDenoiseThreshold = 19200 };  // (Q8) De-noising threshold level
+enum { kAnalysisBandRows = 16 };     // Rows per content analysis band
 
-VPMDenoising::VPMDenoising() :
+VPMDenoising::VPMDenoising(bool runtime_cpu_detection) :
     _id(0),
     _moment1(NULL),
-    _moment2(NULL)
+    _moment2(NULL),
+    _frameSize(0)
 {
-	memset(weightEven, 0.0, sizeof(weightEven));//kmm add @2013.7.19
-	memset(weightMulti, 0.0, sizeof(weightMulti));//kmm add @2013.7.19
-	inited = false;
+#ifndef GXH_TEST_H264
+    memset(_weights, 0, sizeof(_weights));
+    _numWeights = 0;
+    _filtered = NULL;
+    inited = false;
+
+    BilateralFilterRows = &VPMDenoising::BilateralFilterRows_C;
+    if (runtime_cpu_detection)
+    {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+        if (WebRtc_GetCPUInfo(kSSE2))
+        {
+            BilateralFilterRows = &VPMDenoising::BilateralFilterRows_SSE2;
+        }
+#elif defined(WEBRTC_DETECT_ARM_NEON)
+        if ((WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) != 0)
+        {
+            BilateralFilterRows = &VPMDenoising::BilateralFilterRows_NEON;
+        }
+#elif defined(WEBRTC_ARCH_ARM_NEON)
+        BilateralFilterRows = &VPMDenoising::BilateralFilterRows_NEON;
+#endif
+    }
+#endif
     Reset();
 }
 
 VPMDenoising::~VPMDenoising()
 {
+#ifndef GXH_TEST_H264
+    delete [] _filtered;
+#endif
 	/*kmm del
     if (_moment1)
     {
@@ -82,214 +109,198 @@ VPMDenoising::Reset()
 }
 
 #ifndef GXH_TEST_H264
-inline  int  Round( double value )
-{
-	int t = 0;
-#ifdef _WIN32
-	__asm
-	{
-		fld value;
-		fistp t;
-	}
-#endif
-	return t;
-}
-
-WebRtc_Word32 VPMDenoising::InitDenoise(double sigma_color, double sigma_space)
-{
-	if (sigma_color <=0 || sigma_space <=0)
-	{
-		return VPM_PARAMETER_ERROR;
-	}
-	double gauss_color_coeff = -0.5/(sigma_color*sigma_color);
-	double gauss_space_coeff = -0.5/(sigma_space*sigma_space);
-
-	for( int i = 0; i < 256; i++ )
-	{
-		//color_weight[i] = (double)exp(i*i*gauss_color_coeff);
+namespace {
+// Weight of the centre pixel; the neighbour weights are in the same Q8 format.
+const WebRtc_UWord32 kCenterWeight = 1 << 8;
+}  // namespace
 
-		weightEven[i] = (double)exp(gauss_space_coeff+i*i*gauss_color_coeff);
+WebRtc_Word32 VPMDenoising::InitDenoise(double sigma_color, double sigma_space)
+{
+    if (sigma_color <= 0 || sigma_space <= 0)
+    {
+        return VPM_PARAMETER_ERROR;
+    }
+    const double gauss_color_coeff = -0.5 / (sigma_color * sigma_color);
+    const double gauss_space_coeff = -0.5 / (sigma_space * sigma_space);
 
-		for (int j=0; j<256; j++)
-		{
-			weightMulti[i][j] = (double)(weightEven[i]*j);
-		}
-	}
-	
-	return VPM_OK;
+    // All four neighbours are at distance 1, so the space weight is a
+    // constant factor of the colour weight.
+    _numWeights = 0;
+    for (int i = 0; i < 256; i++)
+    {
+        const double weight = 256.0 * exp(gauss_space_coeff +
+                                          i * i * gauss_color_coeff);
+        _weights[i] = static_cast<WebRtc_UWord8>(
+            weight > 255.0 ? 255 : static_cast<int>(weight + 0.5));
+        if (_weights[i] != 0)
+        {
+            _numWeights = i + 1;
+        }
+    }
+    inited = true;
+    return VPM_OK;
 }
-
-//kmm add:˫˲
-WebRtc_Word32 VPMDenoising::BilateralFilter(const WebRtc_UWord8* src, WebRtc_UWord8* dst,	WebRtc_Word32 width, WebRtc_Word32 height)
-//֧in place
-{
-	if (src == NULL || dst == NULL || width <=0 || height <=0)
-	{
-		return VPM_PARAMETER_ERROR;
-	}
-	double mean1;
-	double mean0;
-	double w;
 
-	WebRtc_Word32 i, j; //Shelley modified WebRtc_UWord32 to WebRtc_Word32 20130425
-	//if(deltas[0] == 0)
-	//{
-	//	deltas[0] =  1; deltas[1] = -width + 1;
-	//	deltas[2] = -width; deltas[3] = -width - 1;
-	//	deltas[4] = -1; deltas[5] =  width - 1;
-	//	deltas[6] =  width; deltas[7] =  width + 1;
-	//}
-
-#define INIT_C1\
-	color = src[0]; mean0 = 1; mean1 = color
-
-#define UPDATE_OUTPUT_C1\
-		*dst = (WebRtc_UWord8)Round(mean1/mean0)
-
-#define KERNEL_ELEMENT_EVEN(k)\
-	temp_color = src[deltas[k]];\
-	diff = abs(color - temp_color);\
-	w = weightEven[diff];\
-	mean0 += w;\
-	mean1 += weightMulti[diff][temp_color]
-
-
-	WebRtc_UWord8 color, temp_color;
-	WebRtc_UWord32 diff;
-
-	for (i=0; i<height; i++)
-	{
-		for (j=0; j<width; j++)
-		{
-			if (i ==0 || j==0 || i==height-1 || j==width-1)
-			{
-				*dst = *src;
-			}
-			else
-			{
- 				//color = *src;
- 				//mean0 = 1; 
- 				//mean1 = color;
+WebRtc_Word32 VPMDenoising::BilateralFilter(const WebRtc_UWord8* src,
+                                            WebRtc_UWord8* dst,
+                                            WebRtc_Word32 width,
+                                            WebRtc_Word32 height)
+{
+    return BilateralFilter(src, dst, width, height, width);
+}
 
-				INIT_C1;
-				KERNEL_ELEMENT_EVEN(0);
-				KERNEL_ELEMENT_EVEN(2);
-				KERNEL_ELEMENT_EVEN(4);
-				KERNEL_ELEMENT_EVEN(6);
+// Not in place: |src| and |dst| must not overlap.
+WebRtc_Word32 VPMDenoising::BilateralFilter(const WebRtc_UWord8* src,
+                                            WebRtc_UWord8* dst,
+                                            int width,
+                                            int height,
+                                            int stride)
+{
+    if (src == NULL || dst == NULL || width <= 0 || height <= 0 ||
+        stride < width)
+    {
+        return VPM_PARAMETER_ERROR;
+    }
+    if (!inited)
+    {
+        return VPM_UNINITIALIZED;
+    }
 
+    BilateralFilterBand(src, dst, width, height, stride, 0, height);
+    return VPM_OK;
+}
 
-   			//	for (int k=0; k<8; k+=2)
-   			//	{
- 					//temp_color = src[deltas[k]];
- 					//WebRtc_UWord32 diff=abs(color - temp_color);
- 					//w = weightEven[diff];
- 					//mean0 += w;
- 					//mean1 += weightMulti[diff][temp_color];
-   			//	}
-				//*dst = (WebRtc_UWord8)Round(mean1/mean0);
-				
-				UPDATE_OUTPUT_C1;
-			}
-			src++;
-			dst++;
-		}
-	}
-	return VPM_OK;
+void VPMDenoising::BilateralFilterBand(const WebRtc_UWord8* src,
+                                       WebRtc_UWord8* dst,
+                                       int width,
+                                       int height,
+                                       int stride,
+                                       int first_row,
+                                       int end_row) const
+{
+    // The border pixels are copied.
+    for (int i = first_row; i < end_row; i++)
+    {
+        if (i == 0 || i == height - 1)
+        {
+            memcpy(dst + i * stride, src + i * stride, width);
+        }
+        else
+        {
+            dst[i * stride] = src[i * stride];
+            dst[i * stride + width - 1] = src[i * stride + width - 1];
+        }
+    }
+    const int first = first_row > 1 ? first_row : 1;
+    const int end = end_row < height - 1 ? end_row : height - 1;
+    if (end > first && width > 2)
+    {
+        (this->*BilateralFilterRows)(src + first * stride, dst + first * stride,
+                                     width, stride, end - first);
+    }
+}
 
-#undef INIT_C1
-#undef UPDATE_OUTPUT_C1
-#undef KERNEL_ELEMENT_EVEN
+// Each interior pixel is replaced by the weighted mean of itself and its four
+// nearest neighbours:
+//   dst = (sum(w * Y) + sum(w) / 2) / sum(w)
+// where the centre pixel has weight kCenterWeight and each neighbour has
+// weight _weights[|Y - Y_neighbour|]. The SIMD versions must give exactly the
+// same result.
+void VPMDenoising::BilateralFilterRows_C(const WebRtc_UWord8* src,
+                                         WebRtc_UWord8* dst,
+                                         int width,
+                                         int stride,
+                                         int num_rows) const
+{
+    for (int i = 0; i < num_rows; i++)
+    {
+        const WebRtc_UWord8* row = src + i * stride;
+        WebRtc_UWord8* dstRow = dst + i * stride;
+        for (int j = 1; j < width - 1; j++)
+        {
+            const WebRtc_UWord32 color = row[j];
+            WebRtc_UWord32 sum = kCenterWeight * color;
+            WebRtc_UWord32 weightSum = kCenterWeight;
+            const WebRtc_UWord8 neighbours[4] =
+                {row[j - 1], row[j + 1], row[j - stride], row[j + stride]};
+            for (int k = 0; k < 4; k++)
+            {
+                const int diff = static_cast<int>(color) - neighbours[k];
+                const WebRtc_UWord32 w = _weights[diff < 0 ? -diff : diff];
+                sum += w * neighbours[k];
+                weightSum += w;
+            }
+            dstRow[j] = static_cast<WebRtc_UWord8>(
+                (2 * sum + weightSum) / (2 * weightSum));
+        }
+    }
 }
-//kmm end add
 
 WebRtc_Word32
-VPMDenoising::ProcessFrame(I420VideoFrame* frame0)
+VPMDenoising::ProcessFrame(I420VideoFrame* frame)
 {
-	if (frame0->IsZeroSize())
-	{
-		WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoPreocessing, _id,
-			"zero size frame");
-		return VPM_PARAMETER_ERROR;
-	}
-
-	const WebRtc_UWord32 width = frame0->width();
-	const WebRtc_UWord32 height = frame0->height();
-
-	if (width<= 0 || height <= 0) {
-		WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoPreocessing, _id,
-			"Invalid frame size");
-		return VPM_PARAMETER_ERROR;
-	}
-
-	if (!inited)
-	{
-		WebRtc_Word32 result = InitDenoise(20, 3);
-		if (result != VPM_OK)
-		{
-			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoPreocessing, _id,
-				"Denoise uninitialized");
-			return VPM_UNINITIALIZED;
-		}
-		inited = true;
-	}
-
-//	if(deltas[0] == 0)
-	{//Shelley add ǿתWebRtc_Word32 20130425
-		deltas[0] =  1; deltas[1] = -(WebRtc_Word32)width + 1;
-		deltas[2] = -(WebRtc_Word32)width; deltas[3] = -(WebRtc_Word32)width - 1;
-		deltas[4] = -1; deltas[5] =  (WebRtc_Word32)width - 1;
-		deltas[6] =  (WebRtc_Word32)width; deltas[7] =  (WebRtc_Word32)width + 1;
-	}
+    return ProcessFrame(frame, NULL);
+}
 
-	WebRtc_UWord8* frame = (WebRtc_UWord8*)frame0->buffer(kYPlane);//frame0->buffer;
+WebRtc_Word32
+VPMDenoising::ProcessFrame(I420VideoFrame* frame, VPMContentAnalysis* ca)
+{
+    if (frame->IsZeroSize())
+    {
+        WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoPreocessing, _id,
+                     "zero size frame");
+        return VPM_PARAMETER_ERROR;
+    }
 
-    const WebRtc_UWord32 ysize  = height * width;
+    const int width = frame->width();
+    const int height = frame->height();
+    const int stride = frame->stride(kYPlane);
+    if (width <= 0 || height <= 0)
+    {
+        WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoPreocessing, _id,
+                     "Invalid frame size");
+        return VPM_PARAMETER_ERROR;
+    }
 
-    /* Initialization */
-    /*if (ysize != _frameSize)
+    if (!inited && InitDenoise(20, 3) != VPM_OK)
     {
-        delete [] _moment1;
-        _moment1 = NULL;
+        WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoPreocessing, _id,
+                     "Denoise uninitialized");
+        return VPM_UNINITIALIZED;
+    }
 
-        delete [] _moment2;
-        _moment2 = NULL;
-    }*/
-    _frameSize = ysize;
+    // The intermediate frame is kept between calls.
+    const WebRtc_UWord32 ysize = height * stride;
+    if (ysize != _frameSize)
+    {
+        delete [] _filtered;
+        _filtered = new WebRtc_UWord8[ysize];
+        _frameSize = ysize;
+    }
 
-    /*if (!_moment1)
+    // Two iterations of the filter.
+    WebRtc_UWord8* buffer = frame->buffer(kYPlane);
+    if (BilateralFilter(buffer, _filtered, width, height, stride) != VPM_OK)
     {
-        _moment1 = new WebRtc_UWord32[ysize];
-        memset(_moment1, 0, sizeof(WebRtc_UWord32)*ysize);
+        return VPM_GENERAL_ERROR;
     }
-    
-    if (!_moment2)
+    if (ca == NULL || ca->StartFrame(width, height) != VPM_OK)
     {
-        _moment2 = new WebRtc_UWord32[ysize];
-        memset(_moment2, 0, sizeof(WebRtc_UWord32)*ysize);
-    }*/
-	//================added 
-	WebRtc_UWord8 *temp = new WebRtc_UWord8[ysize];
-
-
-	//memcpy(temp, src, ysize);
-	WebRtc_Word32 result;
-   	result = BilateralFilter(frame, temp, width, height);
-	if (result != VPM_OK)
-	{
-		delete temp;
-		return VPM_GENERAL_ERROR;
-	}
-	result = BilateralFilter(temp,  frame,width, height);
-	if (result != VPM_OK)
-	{
-		delete temp;
-		return VPM_GENERAL_ERROR;
-	}
-	else
-	{
-		delete temp;
-		return VPM_OK;
-	}
+        BilateralFilterBand(_filtered, buffer, width, height, stride, 0,
+                            height);
+        return VPM_OK;
+    }
+    // Rather than reading the frame back from memory afterwards, the content
+    // analysis follows the second iteration band by band.
+    for (int row = 0; row < height; row += kAnalysisBandRows)
+    {
+        const int end_row = row + kAnalysisBandRows < height ?
+            row + kAnalysisBandRows : height;
+        BilateralFilterBand(_filtered, buffer, width, height, stride, row,
+                            end_row);
+        ca->AnalyzeRows(buffer, stride, end_row);
+    }
+    return VPM_OK;
 }
 #endif
 
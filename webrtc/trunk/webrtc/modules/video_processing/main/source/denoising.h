@@ -20,6 +20,7 @@
 
 #include "typedefs.h"
 #include "video_processing.h"
+#include "content_analysis.h"
 
 namespace webrtc {
 
@@ -30,7 +31,7 @@ class VPMDenoising
 {
 
 public:
-    VPMDenoising();
+    explicit VPMDenoising(bool runtime_cpu_detection = true);
     ~VPMDenoising();
 
     WebRtc_Word32 ChangeUniqueId(WebRtc_Word32 id);
@@ -78,6 +79,10 @@ public:
   */
 	WebRtc_Word32 BilateralFilter(const WebRtc_UWord8* src,	WebRtc_UWord8* dst,	int width, int height);//kmm add
 
+    // Same as above for a plane with |stride| bytes between rows.
+    WebRtc_Word32 BilateralFilter(const WebRtc_UWord8* src, WebRtc_UWord8* dst,
+                                  int width, int height, int stride);
+
 
   /**
   * @brief ͼȥ
@@ -99,6 +104,11 @@ public:
 #endif
     WebRtc_Word32 ProcessFrame(I420VideoFrame* frame);
 
+    // Same as above, and the denoised Y plane is also fed to |ca| a band of
+    // rows at a time, while the rows are still in the cache. The caller gets
+    // the metrics from ca->FinishFrame().
+    WebRtc_Word32 ProcessFrame(I420VideoFrame* frame, VPMContentAnalysis* ca);
+
 private:
     WebRtc_Word32 _id;
 
@@ -107,12 +117,32 @@ private:
     WebRtc_UWord32    _frameSize;         // Size (# of pixels) of frame
     int               _denoiseFrameCnt;   // Counter for subsampling in time
 #ifndef GXH_TEST_H264
-// 	double color_weight[766];
-// 	double space_weight[2];
-	double weightEven[256];//kmm add
-	double weightMulti[256][256];//kmm add
-	WebRtc_Word32 deltas[8];
-	bool inited;
+    // Filters the interior columns of |num_rows| rows starting at |src|. The
+    // rows above and below must be readable.
+    typedef void (VPMDenoising::*BilateralFilterRowsFunc)(
+        const WebRtc_UWord8* src, WebRtc_UWord8* dst, int width, int stride,
+        int num_rows) const;
+    BilateralFilterRowsFunc BilateralFilterRows;
+    // Filters rows [first_row, end_row) of a |height| row plane, copying the
+    // border pixels.
+    void BilateralFilterBand(const WebRtc_UWord8* src, WebRtc_UWord8* dst,
+                             int width, int height, int stride, int first_row,
+                             int end_row) const;
+    void BilateralFilterRows_C(const WebRtc_UWord8* src, WebRtc_UWord8* dst,
+                               int width, int stride, int num_rows) const;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    void BilateralFilterRows_SSE2(const WebRtc_UWord8* src, WebRtc_UWord8* dst,
+                                  int width, int stride, int num_rows) const;
+#endif
+#if defined(WEBRTC_ARCH_ARM_NEON) || defined(WEBRTC_DETECT_ARM_NEON)
+    void BilateralFilterRows_NEON(const WebRtc_UWord8* src, WebRtc_UWord8* dst,
+                                  int width, int stride, int num_rows) const;
+#endif
+
+    WebRtc_UWord8     _weights[256];      // (Q8) Neighbour weight per |diff|
+    int               _numWeights;        // Non-zero entries in _weights
+    WebRtc_UWord8*    _filtered;          // Output of the first filter pass
+    bool inited;
 #endif
 };
 
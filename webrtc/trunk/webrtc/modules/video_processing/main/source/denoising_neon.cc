@@ -0,0 +1,175 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "denoising.h"
+
+#include <arm_neon.h>
+
+namespace webrtc {
+
+namespace {
+
+// Up to 8 tables of 32 weights, enough for the whole weight table.
+enum { kMaxWeightTables = 8 };
+
+// Looks up the weights of 8 differences. Differences past the non-zero part
+// of the weight table are out of range for every table and get weight 0.
+inline uint8x8_t LookUpWeights(uint8x8_t diff, const uint8x8x4_t* tables,
+                               int numTables)
+{
+    uint8x8_t weight = vtbl4_u8(tables[0], diff);
+    const uint8x8_t tableSize = vdup_n_u8(32);
+    for (int k = 1; k < numTables; k++)
+    {
+        // Differences below the table wrap around to indices >= 32 and keep
+        // the weight found so far.
+        diff = vsub_u8(diff, tableSize);
+        weight = vtbx4_u8(weight, tables[k], diff);
+    }
+    return weight;
+}
+
+// Returns (sum + weightSum / 2) / weightSum for four 32-bit lanes. NEON has
+// no division; the quotient from the reciprocal estimate is within one of
+// the exact result and is corrected with the remainder.
+inline uint32x4_t RoundedDivide(uint32x4_t sum, uint32x4_t weightSum)
+{
+    const uint32x4_t num = vaddq_u32(vaddq_u32(sum, sum), weightSum);
+    const uint32x4_t den = vaddq_u32(weightSum, weightSum);
+    const float32x4_t denF = vcvtq_f32_u32(den);
+    float32x4_t recip = vrecpeq_f32(denF);
+    recip = vmulq_f32(vrecpsq_f32(denF, recip), recip);
+    recip = vmulq_f32(vrecpsq_f32(denF, recip), recip);
+    uint32x4_t q = vcvtq_u32_f32(vmulq_f32(vcvtq_f32_u32(num), recip));
+
+    const int32x4_t rem = vreinterpretq_s32_u32(vmlsq_u32(num, q, den));
+    // Subtract one if the remainder is negative, add one if it's too large.
+    q = vaddq_u32(q, vcltq_s32(rem, vdupq_n_s32(0)));
+    q = vsubq_u32(q, vcgeq_s32(rem, vreinterpretq_s32_u32(den)));
+    return q;
+}
+
+// Filters 8 pixels.
+inline uint8x8_t FilterPixels8(uint8x8_t c, uint8x8_t l, uint8x8_t r,
+                               uint8x8_t u, uint8x8_t d,
+                               const uint8x8x4_t* tables, int numTables)
+{
+    const uint8x8_t wl = LookUpWeights(vabd_u8(c, l), tables, numTables);
+    const uint8x8_t wr = LookUpWeights(vabd_u8(c, r), tables, numTables);
+    const uint8x8_t wu = LookUpWeights(vabd_u8(c, u), tables, numTables);
+    const uint8x8_t wd = LookUpWeights(vabd_u8(c, d), tables, numTables);
+
+    const uint16x8_t weightSum = vaddq_u16(
+        vaddq_u16(vaddl_u8(wl, wr), vaddl_u8(wu, wd)), vdupq_n_u16(256));
+
+    // A weight times a pixel fits in 16 bits; the sums need 32.
+    const uint16x8_t center = vshll_n_u8(c, 8);
+    const uint16x8_t pl = vmull_u8(wl, l);
+    const uint16x8_t pr = vmull_u8(wr, r);
+    const uint16x8_t pu = vmull_u8(wu, u);
+    const uint16x8_t pd = vmull_u8(wd, d);
+    uint32x4_t sumLo = vaddl_u16(vget_low_u16(center), vget_low_u16(pl));
+    uint32x4_t sumHi = vaddl_u16(vget_high_u16(center), vget_high_u16(pl));
+    sumLo = vaddw_u16(sumLo, vget_low_u16(pr));
+    sumHi = vaddw_u16(sumHi, vget_high_u16(pr));
+    sumLo = vaddw_u16(sumLo, vget_low_u16(pu));
+    sumHi = vaddw_u16(sumHi, vget_high_u16(pu));
+    sumLo = vaddw_u16(sumLo, vget_low_u16(pd));
+    sumHi = vaddw_u16(sumHi, vget_high_u16(pd));
+
+    const uint32x4_t outLo =
+        RoundedDivide(sumLo, vmovl_u16(vget_low_u16(weightSum)));
+    const uint32x4_t outHi =
+        RoundedDivide(sumHi, vmovl_u16(vget_high_u16(weightSum)));
+    return vmovn_u16(vcombine_u16(vmovn_u32(outLo), vmovn_u32(outHi)));
+}
+
+// Filters 16 pixels.
+inline uint8x16_t FilterPixels16(uint8x16_t c, uint8x16_t l, uint8x16_t r,
+                                 uint8x16_t u, uint8x16_t d,
+                                 const uint8x8x4_t* tables, int numTables)
+{
+    return vcombine_u8(
+        FilterPixels8(vget_low_u8(c), vget_low_u8(l), vget_low_u8(r),
+                      vget_low_u8(u), vget_low_u8(d), tables, numTables),
+        FilterPixels8(vget_high_u8(c), vget_high_u8(l), vget_high_u8(r),
+                      vget_high_u8(u), vget_high_u8(d), tables, numTables));
+}
+
+}  // namespace
+
+void VPMDenoising::BilateralFilterRows_NEON(const WebRtc_UWord8* src,
+                                            WebRtc_UWord8* dst,
+                                            int width,
+                                            int stride,
+                                            int num_rows) const
+{
+    // Only the non-zero part of the weight table is searched.
+    const int numTables = _numWeights > 0 ? (_numWeights + 31) / 32 : 1;
+    uint8x8x4_t tables[kMaxWeightTables];
+    for (int k = 0; k < numTables; k++)
+    {
+        for (int m = 0; m < 4; m++)
+        {
+            tables[k].val[m] = vld1_u8(_weights + 32 * k + 8 * m);
+        }
+    }
+
+    // Columns [1, end) are filtered 16 at a time, the rest by the C version.
+    const int end = 1 + ((width - 2) & ~15);
+
+    int i = 0;
+    // Two rows at a time; each row is a neighbour of the other, so their
+    // loads are shared.
+    for (; i + 2 <= num_rows; i += 2)
+    {
+        const WebRtc_UWord8* row0 = src + i * stride;
+        const WebRtc_UWord8* row1 = row0 + stride;
+        WebRtc_UWord8* dstRow0 = dst + i * stride;
+        WebRtc_UWord8* dstRow1 = dstRow0 + stride;
+        for (int j = 1; j < end; j += 16)
+        {
+            const uint8x16_t above = vld1q_u8(row0 - stride + j);
+            const uint8x16_t c0 = vld1q_u8(row0 + j);
+            const uint8x16_t c1 = vld1q_u8(row1 + j);
+            const uint8x16_t below = vld1q_u8(row1 + stride + j);
+            vst1q_u8(dstRow0 + j,
+                     FilterPixels16(c0, vld1q_u8(row0 + j - 1),
+                                    vld1q_u8(row0 + j + 1), above, c1,
+                                    tables, numTables));
+            vst1q_u8(dstRow1 + j,
+                     FilterPixels16(c1, vld1q_u8(row1 + j - 1),
+                                    vld1q_u8(row1 + j + 1), c0, below,
+                                    tables, numTables));
+        }
+    }
+    for (; i < num_rows; i++)
+    {
+        const WebRtc_UWord8* row = src + i * stride;
+        WebRtc_UWord8* dstRow = dst + i * stride;
+        for (int j = 1; j < end; j += 16)
+        {
+            vst1q_u8(dstRow + j,
+                     FilterPixels16(vld1q_u8(row + j), vld1q_u8(row + j - 1),
+                                    vld1q_u8(row + j + 1),
+                                    vld1q_u8(row - stride + j),
+                                    vld1q_u8(row + stride + j),
+                                    tables, numTables));
+        }
+    }
+
+    if (end < width - 1)
+    {
+        BilateralFilterRows_C(src + end - 1, dst + end - 1, width - end + 1,
+                              stride, num_rows);
+    }
+}
+
+}  // namespace webrtc
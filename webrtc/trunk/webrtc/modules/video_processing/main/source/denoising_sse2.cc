@@ -0,0 +1,167 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "denoising.h"
+
+#include <emmintrin.h>
+
+namespace webrtc {
+
+namespace {
+
+inline __m128i AbsDiffU8(__m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+}
+
+// SSE2 has no byte shuffle, so the weights are looked up one at a time.
+inline __m128i LookUpWeights(__m128i diff, const WebRtc_UWord8* weights)
+{
+    WebRtc_UWord8 index[16];
+    WebRtc_UWord8 weight[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(index), diff);
+    for (int i = 0; i < 16; i++)
+    {
+        weight[i] = weights[index[i]];
+    }
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(weight));
+}
+
+// Returns (sum + weightSum / 2) / weightSum for four 32-bit lanes. Both
+// 2 * sum + weightSum and 2 * weightSum are exact in float, and the quotient
+// is never close enough to the next integer for the correctly rounded float
+// division to reach it, so truncation gives the integer division result.
+inline __m128i RoundedDivide(__m128i sum, __m128i weightSum)
+{
+    const __m128i num = _mm_add_epi32(_mm_add_epi32(sum, sum), weightSum);
+    const __m128i den = _mm_add_epi32(weightSum, weightSum);
+    return _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(num),
+                                       _mm_cvtepi32_ps(den)));
+}
+
+// Filters 8 pixels held in 16-bit lanes, given the weights of the left,
+// right, up and down neighbours.
+inline __m128i FilterPixels8(__m128i c, __m128i l, __m128i r, __m128i u,
+                             __m128i d, __m128i wl, __m128i wr, __m128i wu,
+                             __m128i wd)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weightSum = _mm_add_epi16(
+        _mm_add_epi16(_mm_add_epi16(wl, wr), _mm_add_epi16(wu, wd)),
+        _mm_set1_epi16(256));
+
+    // Pairs of weighted neighbours are summed by _mm_madd_epi16.
+    __m128i sumLo = _mm_slli_epi32(_mm_unpacklo_epi16(c, zero), 8);
+    __m128i sumHi = _mm_slli_epi32(_mm_unpackhi_epi16(c, zero), 8);
+    sumLo = _mm_add_epi32(sumLo, _mm_madd_epi16(_mm_unpacklo_epi16(wl, wr),
+                                                 _mm_unpacklo_epi16(l, r)));
+    sumHi = _mm_add_epi32(sumHi, _mm_madd_epi16(_mm_unpackhi_epi16(wl, wr),
+                                                 _mm_unpackhi_epi16(l, r)));
+    sumLo = _mm_add_epi32(sumLo, _mm_madd_epi16(_mm_unpacklo_epi16(wu, wd),
+                                                 _mm_unpacklo_epi16(u, d)));
+    sumHi = _mm_add_epi32(sumHi, _mm_madd_epi16(_mm_unpackhi_epi16(wu, wd),
+                                                 _mm_unpackhi_epi16(u, d)));
+
+    return _mm_packs_epi32(
+        RoundedDivide(sumLo, _mm_unpacklo_epi16(weightSum, zero)),
+        RoundedDivide(sumHi, _mm_unpackhi_epi16(weightSum, zero)));
+}
+
+// Filters 16 pixels.
+inline __m128i FilterPixels16(__m128i c, __m128i l, __m128i r, __m128i u,
+                              __m128i d, const WebRtc_UWord8* weights)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wl = LookUpWeights(AbsDiffU8(c, l), weights);
+    const __m128i wr = LookUpWeights(AbsDiffU8(c, r), weights);
+    const __m128i wu = LookUpWeights(AbsDiffU8(c, u), weights);
+    const __m128i wd = LookUpWeights(AbsDiffU8(c, d), weights);
+
+    const __m128i lo = FilterPixels8(
+        _mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(l, zero),
+        _mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(u, zero),
+        _mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(wl, zero),
+        _mm_unpacklo_epi8(wr, zero), _mm_unpacklo_epi8(wu, zero),
+        _mm_unpacklo_epi8(wd, zero));
+    const __m128i hi = FilterPixels8(
+        _mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(l, zero),
+        _mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(u, zero),
+        _mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(wl, zero),
+        _mm_unpackhi_epi8(wr, zero), _mm_unpackhi_epi8(wu, zero),
+        _mm_unpackhi_epi8(wd, zero));
+    return _mm_packus_epi16(lo, hi);
+}
+
+inline __m128i Load(const WebRtc_UWord8* p)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+inline void Store(WebRtc_UWord8* p, __m128i v)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+}
+
+}  // namespace
+
+void VPMDenoising::BilateralFilterRows_SSE2(const WebRtc_UWord8* src,
+                                            WebRtc_UWord8* dst,
+                                            int width,
+                                            int stride,
+                                            int num_rows) const
+{
+    // Columns [1, end) are filtered 16 at a time, the rest by the C version.
+    const int end = 1 + ((width - 2) & ~15);
+
+    int i = 0;
+    // Two rows at a time; each row is a neighbour of the other, so their
+    // loads are shared.
+    for (; i + 2 <= num_rows; i += 2)
+    {
+        const WebRtc_UWord8* row0 = src + i * stride;
+        const WebRtc_UWord8* row1 = row0 + stride;
+        WebRtc_UWord8* dstRow0 = dst + i * stride;
+        WebRtc_UWord8* dstRow1 = dstRow0 + stride;
+        for (int j = 1; j < end; j += 16)
+        {
+            const __m128i above = Load(row0 - stride + j);
+            const __m128i c0 = Load(row0 + j);
+            const __m128i c1 = Load(row1 + j);
+            const __m128i below = Load(row1 + stride + j);
+            Store(dstRow0 + j, FilterPixels16(c0, Load(row0 + j - 1),
+                                              Load(row0 + j + 1), above, c1,
+                                              _weights));
+            Store(dstRow1 + j, FilterPixels16(c1, Load(row1 + j - 1),
+                                              Load(row1 + j + 1), c0, below,
+                                              _weights));
+        }
+    }
+    for (; i < num_rows; i++)
+    {
+        const WebRtc_UWord8* row = src + i * stride;
+        WebRtc_UWord8* dstRow = dst + i * stride;
+        for (int j = 1; j < end; j += 16)
+        {
+            Store(dstRow + j, FilterPixels16(Load(row + j), Load(row + j - 1),
+                                             Load(row + j + 1),
+                                             Load(row - stride + j),
+                                             Load(row + stride + j),
+                                             _weights));
+        }
+    }
+
+    if (end < width - 1)
+    {
+        BilateralFilterRows_C(src + end - 1, dst + end - 1, width - end + 1,
+                              stride, num_rows);
+    }
+}
+
+}  // namespace webrtc
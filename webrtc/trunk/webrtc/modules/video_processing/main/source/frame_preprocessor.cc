@@ -19,7 +19,10 @@ _contentMetrics(NULL),
 _maxFrameRate(0),
 _resampledFrame(),
 _enableCA(false),
-_frameCnt(0)
+_frameCnt(0),
+_caFrameCounted(false),
+_caFrameDue(false),
+_caFrameDone(false)
 {
     _spatialResampler = new VPMSimpleSpatialResampler();
     _ca = new VPMContentAnalysis(true);
@@ -50,6 +53,9 @@ VPMFramePreprocessor::Reset()
     _spatialResampler->Reset();
     _enableCA = false;
     _frameCnt = 0;
+    _caFrameCounted = false;
+    _caFrameDue = false;
+    _caFrameDone = false;
 }
 	
     
@@ -64,6 +70,34 @@ VPMFramePreprocessor::EnableContentAnalysis(bool enable)
     _enableCA = enable;
 }
 
+WebRtc_Word32
+VPMFramePreprocessor::SetContentAnalysisSubsampling(int skipNum)
+{
+    return _ca->SetSubsampling(skipNum);
+}
+
+VPMContentAnalysis*
+VPMFramePreprocessor::BeginContentAnalysis()
+{
+    _caFrameCounted = false;
+    _caFrameDone = false;
+    if (!_enableCA)
+    {
+        return NULL;
+    }
+    _caFrameCounted = true;
+    _caFrameDue = (_frameCnt % kSkipFrameCA == 0);
+    ++_frameCnt;
+    return _caFrameDue ? _ca : NULL;
+}
+
+void
+VPMFramePreprocessor::EndContentAnalysis()
+{
+    _contentMetrics = _ca->FinishFrame();
+    _caFrameDone = true;
+}
+
 void 
 VPMFramePreprocessor::SetInputFrameResampleMode(VideoFrameResampling resamplingMode)
 {
@@ -143,6 +177,11 @@ VPMFramePreprocessor::PreprocessFrame(const I420VideoFrame& frame,
         return VPM_PARAMETER_ERROR;
     }
 
+    const bool caFrameCounted = _caFrameCounted;
+    const bool caFrameDone = _caFrameDone;
+    _caFrameCounted = false;
+    _caFrameDone = false;
+
     _vd->UpdateIncomingFrameRate();
 
     if (_vd->DropFrame())
@@ -179,14 +218,21 @@ VPMFramePreprocessor::PreprocessFrame(const I420VideoFrame& frame,
     {
         // Compute new metrics every |kSkipFramesCA| frames, starting with
         // the first frame.
-        if (_frameCnt % kSkipFrameCA == 0) {
+        bool due = _caFrameDue;
+        if (!caFrameCounted) {
+          due = (_frameCnt % kSkipFrameCA == 0);
+          ++_frameCnt;
+        }
+        if (due) {
           if (*processedFrame == NULL)  {
-            _contentMetrics = _ca->ComputeContentMetrics(frame);
+            // Already analysed when denoised.
+            if (!caFrameDone) {
+              _contentMetrics = _ca->ComputeContentMetrics(frame);
+            }
           } else {
             _contentMetrics = _ca->ComputeContentMetrics(_resampledFrame);
           }
         }
-        ++_frameCnt;
     }
     return VPM_OK;
 }
@@ -42,6 +42,16 @@ public:
     //Enable content analysis
     void EnableContentAnalysis(bool enable);
 
+    WebRtc_Word32 SetContentAnalysisSubsampling(int skipNum);
+
+    // Content analysis of a frame by another pass over it, the denoiser:
+    // returns the analyser to feed the frame to, or NULL if this frame isn't
+    // to be analysed. If not NULL, EndContentAnalysis() is to be called once
+    // the frame has been fed. The next call to PreprocessFrame() takes the
+    // frame as analysed and counted.
+    VPMContentAnalysis* BeginContentAnalysis();
+    void EndContentAnalysis();
+
     //Set max frame rate
     WebRtc_Word32 SetMaxFrameRate(WebRtc_UWord32 maxFrameRate);
 
@@ -80,6 +90,10 @@ private:
     VPMVideoDecimator*       _vd;
     bool                     _enableCA;
     int                      _frameCnt;
+    // State of a frame passed through BeginContentAnalysis().
+    bool                     _caFrameCounted;
+    bool                     _caFrameDue;
+    bool                     _caFrameDone;
     
 }; // end of VPMFramePreprocessor class definition
 
@@ -199,7 +199,13 @@ WebRtc_Word32
 VideoProcessingModuleImpl::Denoising(I420VideoFrame* frame)
 {
     CriticalSectionScoped mutex(&_mutex);
-    return _denoising.ProcessFrame(frame);
+    VPMContentAnalysis* ca = _framePreProcessor.BeginContentAnalysis();
+    const WebRtc_Word32 ret = _denoising.ProcessFrame(frame, ca);
+    if (ca != NULL)
+    {
+        _framePreProcessor.EndContentAnalysis();
+    }
+    return ret;
 }
 
 WebRtc_Word32
@@ -290,4 +296,11 @@ VideoProcessingModuleImpl::EnableContentAnalysis(bool enable)
     _framePreProcessor.EnableContentAnalysis(enable);
 }
 
+WebRtc_Word32
+VideoProcessingModuleImpl::SetContentAnalysisSubsampling(int skipNum)
+{
+    CriticalSectionScoped mutex(&_mutex);
+    return _framePreProcessor.SetContentAnalysisSubsampling(skipNum);
+}
+
 } //namespace
@@ -54,6 +54,8 @@ public:
     //Enable content analysis
     virtual void EnableContentAnalysis(bool enable);
 
+    virtual WebRtc_Word32 SetContentAnalysisSubsampling(int skipNum);
+
     //Set max frame rate
     virtual WebRtc_Word32 SetMaxFrameRate(WebRtc_UWord32 maxFrameRate);
 
@@ -8,10 +8,17 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
 #include "webrtc/common_video/libyuv/include/webrtc_libyuv.h"
 #include "modules/video_processing/main/interface/video_processing.h"
 #include "modules/video_processing/main/source/content_analysis.h"
+#include "modules/video_processing/main/source/denoising.h"
 #include "modules/video_processing/main/test/unit_test/unit_test.h"
+#include "system_wrappers/interface/tick_util.h"
+#include "testsupport/perf_test.h"
 
 namespace webrtc {
 
@@ -43,4 +50,222 @@ TEST_F(VideoProcessingModuleTest, ContentAnalysis)
     ASSERT_NE(0, feof(_sourceFile)) << "Error reading source file";
 }
 
+// Fills the Y plane of |frame| with a smooth gradient moved by |shift| pixels
+// and some noise. The differences stay small enough for the 16 bit row sums
+// of the SSE2 version.
+static void FillFrame(I420VideoFrame* frame, int shift)
+{
+    const int width = frame->width();
+    const int height = frame->height();
+    const int stride = frame->stride(kYPlane);
+    WebRtc_UWord8* plane = frame->buffer(kYPlane);
+    memset(plane, 0, stride * height);
+    for (int i = 0; i < height; i++)
+    {
+        for (int j = 0; j < width; j++)
+        {
+            const int value = ((i + j + shift) * 3 / 4) % 200 + 20 +
+                rand() % 16 - 8;
+            plane[i * stride + j] = static_cast<WebRtc_UWord8>(value);
+        }
+    }
+}
+
+static void CreateFrame(I420VideoFrame* frame, int width, int height,
+                        int padding)
+{
+    const int halfWidth = (width + 1) / 2;
+    ASSERT_EQ(0, frame->CreateEmptyFrame(width, height, width + padding,
+                                         halfWidth, halfWidth));
+}
+
+static void ExpectSameMetrics(const VideoContentMetrics* expected,
+                              const VideoContentMetrics* actual)
+{
+    ASSERT_TRUE(expected != NULL);
+    ASSERT_TRUE(actual != NULL);
+    EXPECT_EQ(expected->spatial_pred_err, actual->spatial_pred_err);
+    EXPECT_EQ(expected->spatial_pred_err_v, actual->spatial_pred_err_v);
+    EXPECT_EQ(expected->spatial_pred_err_h, actual->spatial_pred_err_h);
+    EXPECT_EQ(expected->motion_magnitude, actual->motion_magnitude);
+}
+
+TEST(VPMContentAnalysisTest, OptimizedMatchesC)
+{
+    const int kSizes[][2] = {{33, 33}, {176, 144}, {181, 97}, {352, 288},
+                             {720, 576}};
+    for (size_t k = 0; k < sizeof(kSizes) / sizeof(kSizes[0]); k++)
+    {
+        VPMContentAnalysis reference(false);
+        VPMContentAnalysis optimized(true);
+        I420VideoFrame frame;
+        CreateFrame(&frame, kSizes[k][0], kSizes[k][1], 7);
+        for (int n = 0; n < 3; n++)
+        {
+            FillFrame(&frame, n * 2);
+            SCOPED_TRACE(frame.width());
+            ExpectSameMetrics(reference.ComputeContentMetrics(frame),
+                              optimized.ComputeContentMetrics(frame));
+        }
+    }
+}
+
+TEST(VPMContentAnalysisTest, IncrementalMatchesWholeFrame)
+{
+    const int kBandRows[] = {1, 7, 16, 300};
+    const int kWidth = 352;
+    const int kHeight = 288;
+    for (size_t k = 0; k < sizeof(kBandRows) / sizeof(kBandRows[0]); k++)
+    {
+        VPMContentAnalysis whole(true);
+        VPMContentAnalysis bands(true);
+        I420VideoFrame frame;
+        CreateFrame(&frame, kWidth, kHeight, 16);
+        for (int n = 0; n < 3; n++)
+        {
+            FillFrame(&frame, n * 3);
+            const VideoContentMetrics* expected =
+                whole.ComputeContentMetrics(frame);
+
+            ASSERT_EQ(VPM_OK, bands.StartFrame(kWidth, kHeight));
+            for (int rows = kBandRows[k]; ; rows += kBandRows[k])
+            {
+                if (rows > kHeight)
+                {
+                    rows = kHeight;
+                }
+                bands.AnalyzeRows(frame.buffer(kYPlane),
+                                  frame.stride(kYPlane), rows);
+                if (rows == kHeight)
+                {
+                    break;
+                }
+            }
+            SCOPED_TRACE(kBandRows[k]);
+            ExpectSameMetrics(expected, bands.FinishFrame());
+        }
+    }
+}
+
+TEST(VPMContentAnalysisTest, Subsampling)
+{
+    VPMContentAnalysis automatic(true);
+    VPMContentAnalysis configured(true);
+    EXPECT_EQ(VPM_PARAMETER_ERROR, configured.SetSubsampling(-1));
+    // Every 2nd row is the automatic choice for 4CIF.
+    EXPECT_EQ(VPM_OK, configured.SetSubsampling(2));
+    I420VideoFrame frame;
+    CreateFrame(&frame, 704, 576, 0);
+    for (int n = 0; n < 2; n++)
+    {
+        FillFrame(&frame, n * 4);
+        ExpectSameMetrics(automatic.ComputeContentMetrics(frame),
+                          configured.ComputeContentMetrics(frame));
+    }
+
+    // The previous frame was kept for other rows; the motion starts over.
+    EXPECT_EQ(VPM_OK, configured.SetSubsampling(3));
+    FillFrame(&frame, 8);
+    const VideoContentMetrics* metrics =
+        configured.ComputeContentMetrics(frame);
+    ASSERT_TRUE(metrics != NULL);
+    EXPECT_EQ(0.0f, metrics->motion_magnitude);
+    FillFrame(&frame, 12);
+    metrics = configured.ComputeContentMetrics(frame);
+    ASSERT_TRUE(metrics != NULL);
+    EXPECT_GT(metrics->motion_magnitude, 0.0f);
+}
+
+TEST(VPMContentAnalysisTest, DenoisingWithAnalysisMatchesSeparatePasses)
+{
+    const int kWidth = 181;
+    const int kHeight = 97;
+    VPMDenoising denoising;
+    VPMDenoising fusedDenoising;
+    VPMContentAnalysis ca(true);
+    VPMContentAnalysis fusedCa(true);
+    I420VideoFrame frame;
+    I420VideoFrame fusedFrame;
+    CreateFrame(&frame, kWidth, kHeight, 3);
+    for (int n = 0; n < 3; n++)
+    {
+        FillFrame(&frame, n * 2);
+        fusedFrame.CopyFrame(frame);
+
+        ASSERT_EQ(VPM_OK, denoising.ProcessFrame(&frame));
+        const VideoContentMetrics* expected = ca.ComputeContentMetrics(frame);
+        ASSERT_EQ(VPM_OK, fusedDenoising.ProcessFrame(&fusedFrame, &fusedCa));
+        ExpectSameMetrics(expected, fusedCa.FinishFrame());
+        EXPECT_EQ(0, memcmp(frame.buffer(kYPlane), fusedFrame.buffer(kYPlane),
+                            frame.allocated_size(kYPlane)));
+    }
+}
+
+TEST(VPMContentAnalysisTest, Benchmark)
+{
+    const int kSizes[][2] = {{640, 480}, {1280, 720}};
+    const int kNumFrames = 30;
+    for (size_t k = 0; k < sizeof(kSizes) / sizeof(kSizes[0]); k++)
+    {
+        const int width = kSizes[k][0];
+        const int height = kSizes[k][1];
+        const std::string trace = width == 640 ? "640x480" : "1280x720";
+        I420VideoFrame frames[2];
+        I420VideoFrame frame;
+        for (int n = 0; n < 2; n++)
+        {
+            CreateFrame(&frames[n], width, height, 0);
+            FillFrame(&frames[n], n * 2);
+        }
+
+        const char* kModes[] = {"_c", "_simd"};
+        for (int mode = 0; mode < 2; mode++)
+        {
+            VPMContentAnalysis ca(mode == 1);
+            WebRtc_Word64 totalUs = 0;
+            for (int i = 0; i < kNumFrames; i++)
+            {
+                const WebRtc_Word64 startUs = TickTime::MicrosecondTimestamp();
+                ASSERT_TRUE(ca.ComputeContentMetrics(frames[i % 2]) != NULL);
+                totalUs += TickTime::MicrosecondTimestamp() - startUs;
+            }
+            webrtc::test::PrintResult("content_analysis", kModes[mode], trace,
+                                      static_cast<size_t>(totalUs /
+                                                          kNumFrames),
+                                      "us/frame", mode == 1);
+        }
+
+        // Denoising followed by content analysis, as two passes over the
+        // frame and as one.
+        const char* kPasses[] = {"_separate", "_fused"};
+        for (int fused = 0; fused < 2; fused++)
+        {
+            VPMDenoising denoising;
+            VPMContentAnalysis ca(true);
+            WebRtc_Word64 totalUs = 0;
+            for (int i = 0; i < kNumFrames; i++)
+            {
+                frame.CopyFrame(frames[i % 2]);
+                const WebRtc_Word64 startUs = TickTime::MicrosecondTimestamp();
+                if (fused)
+                {
+                    ASSERT_EQ(VPM_OK, denoising.ProcessFrame(&frame, &ca));
+                    ASSERT_TRUE(ca.FinishFrame() != NULL);
+                }
+                else
+                {
+                    ASSERT_EQ(VPM_OK, denoising.ProcessFrame(&frame));
+                    ASSERT_TRUE(ca.ComputeContentMetrics(frame) != NULL);
+                }
+                totalUs += TickTime::MicrosecondTimestamp() - startUs;
+            }
+            webrtc::test::PrintResult("denoising_content_analysis",
+                                      kPasses[fused], trace,
+                                      static_cast<size_t>(totalUs /
+                                                          kNumFrames),
+                                      "us/frame", fused == 1);
+        }
+    }
+}
+
 }  // namespace webrtc
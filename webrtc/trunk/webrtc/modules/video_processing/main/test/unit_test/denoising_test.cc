@@ -13,9 +13,11 @@
 
 #include "common_video/libyuv/include/webrtc_libyuv.h"
 #include "modules/video_processing/main/interface/video_processing.h"
+#include "modules/video_processing/main/source/denoising.h"
 #include "modules/video_processing/main/test/unit_test/unit_test.h"
 #include "system_wrappers/interface/tick_util.h"
 #include "testsupport/fileutils.h"
+#include "testsupport/perf_test.h"
 
 namespace webrtc {
 
@@ -132,4 +134,110 @@ TEST_F(VideoProcessingModuleTest, Denoising)
         static_cast<int>(minRuntime / frameNum));
 }
 
+// Fills a plane with noisy content: smooth gradients with noise, and a few
+// hard edges so that every part of the weight table is used.
+static void FillNoisyPlane(WebRtc_UWord8* plane, int width, int height,
+                           int stride)
+{
+    for (int i = 0; i < height; i++)
+    {
+        for (int j = 0; j < width; j++)
+        {
+            int value = (i * 3 + j * 2) % 256 + rand() % 32 - 16;
+            if ((i / 8 + j / 8) % 5 == 0)
+            {
+                value = 255 - value;
+            }
+            plane[i * stride + j] = static_cast<WebRtc_UWord8>(
+                value < 0 ? 0 : (value > 255 ? 255 : value));
+        }
+    }
+}
+
+TEST(VPMDenoisingTest, BilateralFilterMatchesReference)
+{
+    const int kSizes[][2] = {{3, 3}, {17, 5}, {18, 4}, {33, 7}, {64, 64},
+                             {176, 144}, {181, 97}};
+    const double kSigmaColor[] = {5.0, 20.0, 60.0};
+    for (size_t s = 0; s < sizeof(kSigmaColor) / sizeof(kSigmaColor[0]); s++)
+    {
+        VPMDenoising reference(false);
+        VPMDenoising optimized(true);
+        ASSERT_EQ(VPM_OK, reference.InitDenoise(kSigmaColor[s], 3.0));
+        ASSERT_EQ(VPM_OK, optimized.InitDenoise(kSigmaColor[s], 3.0));
+        for (size_t k = 0; k < sizeof(kSizes) / sizeof(kSizes[0]); k++)
+        {
+            const int width = kSizes[k][0];
+            const int height = kSizes[k][1];
+            const int stride = width + 5;
+            scoped_array<WebRtc_UWord8> src(
+                new WebRtc_UWord8[stride * height]);
+            scoped_array<WebRtc_UWord8> dstRef(
+                new WebRtc_UWord8[stride * height]);
+            scoped_array<WebRtc_UWord8> dstOpt(
+                new WebRtc_UWord8[stride * height]);
+            memset(src.get(), 0, stride * height);
+            memset(dstRef.get(), 0, stride * height);
+            memset(dstOpt.get(), 0, stride * height);
+            FillNoisyPlane(src.get(), width, height, stride);
+
+            ASSERT_EQ(VPM_OK, reference.BilateralFilter(
+                src.get(), dstRef.get(), width, height, stride));
+            ASSERT_EQ(VPM_OK, optimized.BilateralFilter(
+                src.get(), dstOpt.get(), width, height, stride));
+            ASSERT_EQ(0, memcmp(dstRef.get(), dstOpt.get(), stride * height))
+                << width << "x" << height << " sigma " << kSigmaColor[s];
+        }
+    }
+}
+
+TEST(VPMDenoisingTest, FlatPlaneIsUnchanged)
+{
+    VPMDenoising denoising;
+    ASSERT_EQ(VPM_OK, denoising.InitDenoise(20.0, 3.0));
+    const int kWidth = 40;
+    const int kHeight = 10;
+    WebRtc_UWord8 src[kWidth * kHeight];
+    WebRtc_UWord8 dst[kWidth * kHeight];
+    memset(src, 117, sizeof(src));
+    ASSERT_EQ(VPM_OK, denoising.BilateralFilter(src, dst, kWidth, kHeight));
+    EXPECT_EQ(0, memcmp(src, dst, sizeof(src)));
+}
+
+TEST(VPMDenoisingTest, ProcessFrameBenchmark)
+{
+    const int kSizes[][2] = {{640, 480}, {1280, 720}};
+    const int kNumFrames = 30;
+    for (size_t k = 0; k < sizeof(kSizes) / sizeof(kSizes[0]); k++)
+    {
+        const int width = kSizes[k][0];
+        const int height = kSizes[k][1];
+        const int halfWidth = (width + 1) / 2;
+        I420VideoFrame frame;
+        ASSERT_EQ(0, frame.CreateEmptyFrame(width, height, width, halfWidth,
+                                            halfWidth));
+        scoped_array<WebRtc_UWord8> noisy(new WebRtc_UWord8[width * height]);
+        FillNoisyPlane(noisy.get(), width, height, width);
+
+        const char* kModes[] = {"_c", "_simd"};
+        for (int mode = 0; mode < 2; mode++)
+        {
+            VPMDenoising denoising(mode == 1);
+            WebRtc_Word64 totalUs = 0;
+            for (int i = 0; i < kNumFrames; i++)
+            {
+                memcpy(frame.buffer(kYPlane), noisy.get(), width * height);
+                const WebRtc_Word64 startUs = TickTime::MicrosecondTimestamp();
+                ASSERT_EQ(VPM_OK, denoising.ProcessFrame(&frame));
+                totalUs += TickTime::MicrosecondTimestamp() - startUs;
+            }
+            std::string trace = width == 640 ? "640x480" : "1280x720";
+            webrtc::test::PrintResult("denoising", kModes[mode], trace,
+                                      static_cast<size_t>(totalUs /
+                                                          kNumFrames),
+                                      "us/frame", mode == 1);
+        }
+    }
+}
+
 }  // namespace webrtc
@@ -23,10 +23,9 @@
 #include <android/log.h>
 #include "common_video/libyuv/include/webrtc_libyuv.h"
 #include "webrtc/modules/video_render//video_render_frames.h"
+#include "webrtc/modules/video_render/video_render_scheduler.h"
 #include "system_wrappers/interface/critical_section_wrapper.h"
-#include "system_wrappers/interface/event_wrapper.h"
 #include "system_wrappers/interface/map_wrapper.h"
-#include "system_wrappers/interface/thread_wrapper.h"
 #include "system_wrappers/interface/tick_util.h"
 #include "system_wrappers/interface/trace.h"
 //#define ANDROID_LOG 1
@@ -49,8 +48,7 @@ IncomingVideoStream::IncomingVideoStream(const WebRtc_Word32 module_id,
       stream_critsect_(*CriticalSectionWrapper::CreateCriticalSection()),
       thread_critsect_(*CriticalSectionWrapper::CreateCriticalSection()),
       buffer_critsect_(*CriticalSectionWrapper::CreateCriticalSection()),
-      incoming_render_thread_(),
-      deliver_buffer_event_(*EventWrapper::Create()),
+      scheduler_(NULL),
       running_(false),
       external_callback_(NULL),
       render_callback_(NULL),
@@ -79,12 +77,10 @@ IncomingVideoStream::~IncomingVideoStream() {
 
   Stop();
 
-  // incoming_render_thread_ - Delete in stop
   delete &render_buffers_;
   delete &stream_critsect_;
   delete &buffer_critsect_;
   delete &thread_critsect_;
-  delete &deliver_buffer_event_;
 }
 
 WebRtc_Word32 IncomingVideoStream::ChangeModuleId(const WebRtc_Word32 id) {
@@ -143,8 +139,11 @@ WebRtc_Word32 IncomingVideoStream::RenderFrame(const WebRtc_UWord32 stream_id,
   // Insert frame.
   CriticalSectionScoped csB(&buffer_critsect_);
   //WEBRTC_TRACE(webrtc::kTraceStateInfo, webrtc::kTraceVideo, 0, "RenderFrame stream_id:%d", stream_id);
-  if (render_buffers_.AddFrame(&video_frame) == 1)
-    deliver_buffer_event_.Set();
+  if (render_buffers_.AddFrame(&video_frame) > 0) {
+    // Frames can arrive out of render time order, so the new frame may be due
+    // before the one the scheduler is waiting for.
+    scheduler_->Wake(this, render_buffers_.TimeToNextFrameRelease());
+  }
 
   return 0;
 }
@@ -219,64 +218,44 @@ WebRtc_Word32 IncomingVideoStream::Start() {
     return 0;
   }
 
-  CriticalSectionScoped csT(&thread_critsect_);
-  assert(incoming_render_thread_ == NULL);
-
-  incoming_render_thread_ = ThreadWrapper::CreateThread(
-      IncomingVideoStreamThreadFun, this, kRealtimePriority,
-      "IncomingVideoStreamThread");
-  if (!incoming_render_thread_) {
-    WEBRTC_TRACE(kTraceError, kTraceVideoRenderer, module_id_,
-                 "%s: No thread", __FUNCTION__);
-    return -1;
-  }
-
-  unsigned int t_id = 0;
-  if (incoming_render_thread_->Start(t_id)) {
-    WEBRTC_TRACE(kTraceInfo, kTraceVideoRenderer, module_id_,
-                 "%s: thread started: %u", __FUNCTION__, t_id);
-  } else {
-    WEBRTC_TRACE(kTraceError, kTraceVideoRenderer, module_id_,
-                 "%s: Could not start send thread", __FUNCTION__);
+  if (scheduler_ != NULL) {
+    WEBRTC_TRACE(kTraceWarning, kTraceVideoRenderer, module_id_,
+                 "%s: Still stopping", __FUNCTION__);
     return -1;
   }
-  deliver_buffer_event_.StartTimer(false, KEventStartupTimeMS);
+  // All streams are rendered from the thread of one shared scheduler.
+  scheduler_ = VideoRenderScheduler::GetScheduler();
+  scheduler_->AddStream(this, KEventStartupTimeMS);
 
   running_ = true;
   return 0;
 }
 
 WebRtc_Word32 IncomingVideoStream::Stop() {
-  CriticalSectionScoped cs_stream(&stream_critsect_);
-  WEBRTC_TRACE(kTraceInfo, kTraceVideoRenderer, module_id_,
-               "%s for stream %d", __FUNCTION__, stream_id_);
-
-  if (!running_) {
-    WEBRTC_TRACE(kTraceWarning, kTraceVideoRenderer, module_id_,
-                 "%s: Not running", __FUNCTION__);
-    return 0;
-  }
+  VideoRenderScheduler* scheduler = NULL;
+  {
+    CriticalSectionScoped cs_stream(&stream_critsect_);
+    WEBRTC_TRACE(kTraceInfo, kTraceVideoRenderer, module_id_,
+                 "%s for stream %d", __FUNCTION__, stream_id_);
 
-  thread_critsect_.Enter();
-  if (incoming_render_thread_) {
-    ThreadWrapper* thread = incoming_render_thread_;
-    incoming_render_thread_ = NULL;
-    thread->SetNotAlive();
-#ifndef WIN32_
-    deliver_buffer_event_.StopTimer();
-#endif
-    thread_critsect_.Leave();
-    if (thread->Stop()) {
-      delete thread;
-    } else {
-      assert(false);
+    if (!running_) {
       WEBRTC_TRACE(kTraceWarning, kTraceVideoRenderer, module_id_,
-                   "%s: Not able to stop thread, leaking", __FUNCTION__);
+                   "%s: Not running", __FUNCTION__);
+      return 0;
     }
-  } else {
-    thread_critsect_.Leave();
+    // New frames are refused from here on. |scheduler_| is kept until the
+    // stream is removed, so that Start() can't add it again before that.
+    running_ = false;
+    scheduler = scheduler_;
   }
-  running_ = false;
+
+  // Returns once the scheduler is done rendering this stream. Not holding
+  // |stream_critsect_|, which the rendering may need.
+  scheduler->RemoveStream(this);
+  VideoRenderScheduler::ReturnScheduler();
+
+  CriticalSectionScoped cs_stream(&stream_critsect_);
+  scheduler_ = NULL;
   Reset();
   last_rendered_frame_.ResetSize();
   last_rendered_frame_.set_render_time_ms(0);
@@ -304,82 +283,70 @@ WebRtc_UWord32 IncomingVideoStream::IncomingRate() const {
   return incoming_rate_;
 }
 
-bool IncomingVideoStream::IncomingVideoStreamThreadFun(void* obj) {
-  return static_cast<IncomingVideoStream*>(obj)->IncomingVideoStreamProcess();
-}
-
-bool IncomingVideoStream::IncomingVideoStreamProcess() {
-  if (kEventError != deliver_buffer_event_.Wait(KEventMaxWaitTimeMs)) {
-    if (incoming_render_thread_ == NULL) {
-      // Terminating
-      return false;
-    }
+WebRtc_UWord32 IncomingVideoStream::RenderProcess() {
+  thread_critsect_.Enter();
+  I420VideoFrame* frame_to_render = NULL;
 
-    thread_critsect_.Enter();
-    I420VideoFrame* frame_to_render = NULL;
+  // Get a new frame to render and the time for the frame after this one.
+  buffer_critsect_.Enter();
+  frame_to_render = render_buffers_.FrameToRender();
+  WebRtc_UWord32 wait_time = render_buffers_.TimeToNextFrameRelease();
+  buffer_critsect_.Leave();
 
-    // Get a new frame to render and the time for the frame after this one.
-    buffer_critsect_.Enter();
-    frame_to_render = render_buffers_.FrameToRender();
-    WebRtc_UWord32 wait_time = render_buffers_.TimeToNextFrameRelease();
-    buffer_critsect_.Leave();
+  // Time until the next frame to render.
+  if (wait_time > KEventMaxWaitTimeMs) {
+    wait_time = KEventMaxWaitTimeMs;
+  }
 
-    // Set timer for next frame to render.
-    if (wait_time > KEventMaxWaitTimeMs) {
-      wait_time = KEventMaxWaitTimeMs;
-    }
-    deliver_buffer_event_.StartTimer(false, wait_time);
-
-    if (!frame_to_render) {
-      if (render_callback_) {
-        if (last_rendered_frame_.render_time_ms() == 0 &&
-            !start_image_.IsZeroSize()) {
-          // We have not rendered anything and have a start image.
-          temp_frame_.CopyFrame(start_image_);
-          render_callback_->RenderFrame(stream_id_, temp_frame_);
-        } else if (!timeout_image_.IsZeroSize() &&
-                   last_rendered_frame_.render_time_ms() + timeout_time_ <
-                       TickTime::MillisecondTimestamp()) {
-          // Render a timeout image.
-          temp_frame_.CopyFrame(timeout_image_);
-          render_callback_->RenderFrame(stream_id_, temp_frame_);
-        }
+  if (!frame_to_render) {
+    if (render_callback_) {
+      if (last_rendered_frame_.render_time_ms() == 0 &&
+          !start_image_.IsZeroSize()) {
+        // We have not rendered anything and have a start image.
+        temp_frame_.CopyFrame(start_image_);
+        render_callback_->RenderFrame(stream_id_, temp_frame_);
+      } else if (!timeout_image_.IsZeroSize() &&
+                 last_rendered_frame_.render_time_ms() + timeout_time_ <
+                     TickTime::MillisecondTimestamp()) {
+        // Render a timeout image.
+        temp_frame_.CopyFrame(timeout_image_);
+        render_callback_->RenderFrame(stream_id_, temp_frame_);
       }
-
-      // No frame.
-      thread_critsect_.Leave();
-      return true;
     }
 
-    // Send frame for rendering.
-    if (external_callback_) {
+    // No frame.
+    thread_critsect_.Leave();
+    return wait_time;
+  }
+
+  // Send frame for rendering.
+  if (external_callback_) {
+    WEBRTC_TRACE(kTraceStream, kTraceVideoRenderer, module_id_,
+                 "%s: executing external renderer callback to deliver frame",
+                 __FUNCTION__, frame_to_render->render_time_ms());
+    external_callback_->RenderFrame(stream_id_, *frame_to_render);
+  } else {
+    if (render_callback_) {
       WEBRTC_TRACE(kTraceStream, kTraceVideoRenderer, module_id_,
-                   "%s: executing external renderer callback to deliver frame",
-                   __FUNCTION__, frame_to_render->render_time_ms());
-      external_callback_->RenderFrame(stream_id_, *frame_to_render);
-    } else {
-      if (render_callback_) {
-        WEBRTC_TRACE(kTraceStream, kTraceVideoRenderer, module_id_,
-                     "%s: Render frame, time: %llu", __FUNCTION__,
-                     frame_to_render->render_time_ms());
-        render_callback_->RenderFrame(stream_id_, *frame_to_render);
-      }
+                   "%s: Render frame, time: %llu", __FUNCTION__,
+                   frame_to_render->render_time_ms());
+      render_callback_->RenderFrame(stream_id_, *frame_to_render);
     }
+  }
 
-    // Release critsect before calling the module user.
-    thread_critsect_.Leave();
+  // Release critsect before calling the module user.
+  thread_critsect_.Leave();
 
-    // We're done with this frame, delete it.
-    if (frame_to_render) {
-      CriticalSectionScoped cs(&buffer_critsect_);
-      last_rendered_frame_.SwapFrame(frame_to_render);
-        WEBRTC_TRACE(kTraceStream, kTraceVideoRenderer, module_id_,
-                     "%s: Render frame, time: %llu", __FUNCTION__,
-                     last_rendered_frame_.render_time_ms());
-      render_buffers_.ReturnFrame(frame_to_render);
-    }
+  // We're done with this frame, delete it.
+  if (frame_to_render) {
+    CriticalSectionScoped cs(&buffer_critsect_);
+    last_rendered_frame_.SwapFrame(frame_to_render);
+      WEBRTC_TRACE(kTraceStream, kTraceVideoRenderer, module_id_,
+                   "%s: Render frame, time: %llu", __FUNCTION__,
+                   last_rendered_frame_.render_time_ms());
+    render_buffers_.ReturnFrame(frame_to_render);
   }
-  return true;
+  return wait_time;
 }
 
 WebRtc_Word32 IncomingVideoStream::GetLastRenderedFrame(
@@ -16,10 +16,9 @@
 
 namespace webrtc {
 class CriticalSectionWrapper;
-class EventWrapper;
-class ThreadWrapper;
 class VideoRenderCallback;
 class VideoRenderFrames;
+class VideoRenderScheduler;
 
 struct VideoMirroring {
   VideoMirroring() : mirror_x_axis(false), mirror_y_axis(false) {}
@@ -72,9 +71,11 @@ class IncomingVideoStream : public VideoRenderCallback {
   void ConfigureRenderMode(const int scaledmode){render_callback_->ConfigureRenderMode( scaledmode);}
 
  protected:
-  static bool IncomingVideoStreamThreadFun(void* obj);
-  bool IncomingVideoStreamProcess();
-  
+  friend class VideoRenderScheduler;
+
+  // Called by the render scheduler to render the next due frame, if any.
+  // Returns the time in ms until the next frame is due.
+  WebRtc_UWord32 RenderProcess();
 
  private:
   enum { KEventStartupTimeMS = 10 };
@@ -87,8 +88,7 @@ class IncomingVideoStream : public VideoRenderCallback {
   CriticalSectionWrapper& stream_critsect_;
   CriticalSectionWrapper& thread_critsect_;
   CriticalSectionWrapper& buffer_critsect_;
-  ThreadWrapper* incoming_render_thread_;
-  EventWrapper& deliver_buffer_event_;
+  VideoRenderScheduler* scheduler_;
   bool running_;
 
   VideoRenderCallback* external_callback_;
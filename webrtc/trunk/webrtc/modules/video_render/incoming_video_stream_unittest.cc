@@ -0,0 +1,212 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/video_render/incoming_video_stream.h"
+
+#include "gtest/gtest.h"
+#include "webrtc/modules/video_render/video_render_scheduler.h"
+#include "system_wrappers/interface/critical_section_wrapper.h"
+#include "system_wrappers/interface/event_wrapper.h"
+#include "system_wrappers/interface/scoped_ptr.h"
+#include "system_wrappers/interface/sleep.h"
+#include "system_wrappers/interface/thread_wrapper.h"
+#include "system_wrappers/interface/tick_util.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+const int kNumStreams = 16;
+const int kFrameIntervalMs = 33;
+const int kNumFrames = 60;
+const int kRenderDelayMs = 20;
+
+class CountingRenderer : public VideoRenderCallback {
+ public:
+  CountingRenderer()
+      : crit_(CriticalSectionWrapper::CreateCriticalSection()),
+        num_frames_(0) {}
+
+  virtual WebRtc_Word32 RenderFrame(const WebRtc_UWord32 stream_id,
+                                    I420VideoFrame& video_frame) {
+    CriticalSectionScoped cs(crit_.get());
+    ++num_frames_;
+    return 0;
+  }
+
+  virtual void ConfigureRenderMode(const int scaledmode) {}
+
+  int num_frames() const {
+    CriticalSectionScoped cs(crit_.get());
+    return num_frames_;
+  }
+
+ private:
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  int num_frames_;
+};
+
+// Holds the render thread in RenderFrame() until released.
+class BlockingRenderer : public VideoRenderCallback {
+ public:
+  BlockingRenderer()
+      : rendering_(EventWrapper::Create()),
+        release_(EventWrapper::Create()) {}
+
+  virtual WebRtc_Word32 RenderFrame(const WebRtc_UWord32 stream_id,
+                                    I420VideoFrame& video_frame) {
+    rendering_->Set();
+    release_->Wait(10000);
+    return 0;
+  }
+
+  virtual void ConfigureRenderMode(const int scaledmode) {}
+
+  bool WaitForRendering() { return rendering_->Wait(1000) == kEventSignaled; }
+  void Release() { release_->Set(); }
+
+ private:
+  scoped_ptr<EventWrapper> rendering_;
+  scoped_ptr<EventWrapper> release_;
+};
+
+// Stops |stream| on a thread of its own.
+class StopThread {
+ public:
+  explicit StopThread(IncomingVideoStream* stream)
+      : stream_(stream),
+        stopped_(EventWrapper::Create()),
+        thread_(ThreadWrapper::CreateThread(Run, this, kNormalPriority,
+                                            "StopThread")) {
+    unsigned int thread_id = 0;
+    EXPECT_TRUE(thread_->Start(thread_id));
+  }
+
+  ~StopThread() { thread_->Stop(); }
+
+  bool WaitForStop(unsigned long max_time_ms) {
+    return stopped_->Wait(max_time_ms) == kEventSignaled;
+  }
+
+ private:
+  static bool Run(void* obj) {
+    StopThread* self = static_cast<StopThread*>(obj);
+    EXPECT_EQ(0, self->stream_->Stop());
+    self->stopped_->Set();
+    return false;
+  }
+
+  IncomingVideoStream* stream_;
+  scoped_ptr<EventWrapper> stopped_;
+  scoped_ptr<ThreadWrapper> thread_;
+};
+
+class IncomingVideoStreamTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    // Keeps the same scheduler alive for the whole test.
+    scheduler_ = VideoRenderScheduler::GetScheduler();
+    for (int i = 0; i < kNumStreams; ++i) {
+      streams_[i].reset(new IncomingVideoStream(0, i));
+      EXPECT_EQ(0, streams_[i]->SetRenderCallback(&renderers_[i]));
+    }
+  }
+
+  virtual void TearDown() {
+    for (int i = 0; i < kNumStreams; ++i) {
+      streams_[i].reset();
+    }
+    VideoRenderScheduler::ReturnScheduler();
+  }
+
+  VideoRenderScheduler* scheduler_;
+  CountingRenderer renderers_[kNumStreams];
+  scoped_ptr<IncomingVideoStream> streams_[kNumStreams];
+};
+
+TEST_F(IncomingVideoStreamTest, DropsFramesWhenStopped) {
+  I420VideoFrame frame;
+  frame.CreateEmptyFrame(16, 16, 16, 8, 8);
+  frame.set_render_time_ms(TickTime::MillisecondTimestamp());
+  EXPECT_EQ(-1, streams_[0]->RenderFrame(0, frame));
+
+  EXPECT_EQ(0, streams_[0]->Start());
+  EXPECT_EQ(0, streams_[0]->RenderFrame(0, frame));
+  EXPECT_EQ(0, streams_[0]->Stop());
+  EXPECT_EQ(-1, streams_[0]->RenderFrame(0, frame));
+}
+
+TEST_F(IncomingVideoStreamTest, StopOnlyWaitsForItsOwnStream) {
+  BlockingRenderer renderer;
+  EXPECT_EQ(0, streams_[0]->SetRenderCallback(&renderer));
+  EXPECT_EQ(0, streams_[0]->Start());
+  EXPECT_EQ(0, streams_[1]->Start());
+  I420VideoFrame frame;
+  frame.CreateEmptyFrame(16, 16, 16, 8, 8);
+  frame.set_render_time_ms(TickTime::MillisecondTimestamp());
+  EXPECT_EQ(0, streams_[0]->RenderFrame(0, frame));
+  ASSERT_TRUE(renderer.WaitForRendering());
+
+  // Stream 0 is being rendered, so stream 1 is stopped right away.
+  const WebRtc_Word64 start_ms = TickTime::MillisecondTimestamp();
+  EXPECT_EQ(0, streams_[1]->Stop());
+  EXPECT_LT(TickTime::MillisecondTimestamp() - start_ms, 100);
+
+  // Stopping stream 0 waits for the rendering, without blocking the stream.
+  StopThread stop_thread(streams_[0].get());
+  EXPECT_FALSE(stop_thread.WaitForStop(50));
+  EXPECT_EQ(-1, streams_[0]->RenderFrame(0, frame));
+  EXPECT_EQ(-1, streams_[0]->Start());
+  renderer.Release();
+  EXPECT_TRUE(stop_thread.WaitForStop(1000));
+}
+
+// Feeds 30 fps to all streams at once and reports how often the shared
+// render thread woke up and how many frames it rendered late.
+TEST_F(IncomingVideoStreamTest, RendersConcurrentStreams) {
+  for (int i = 0; i < kNumStreams; ++i) {
+    EXPECT_EQ(0, streams_[i]->Start());
+  }
+  const WebRtc_UWord32 start_wakeups = scheduler_->wakeups();
+  const WebRtc_UWord32 start_misses = scheduler_->deadline_misses();
+
+  I420VideoFrame frame;
+  for (int n = 0; n < kNumFrames; ++n) {
+    for (int i = 0; i < kNumStreams; ++i) {
+      frame.CreateEmptyFrame(176, 144, 176, 88, 88);
+      frame.set_render_time_ms(TickTime::MillisecondTimestamp() +
+                               kRenderDelayMs);
+      EXPECT_EQ(0, streams_[i]->RenderFrame(i, frame));
+    }
+    SleepMs(kFrameIntervalMs);
+  }
+  SleepMs(2 * kRenderDelayMs);
+
+  const WebRtc_UWord32 wakeups = scheduler_->wakeups() - start_wakeups;
+  const WebRtc_UWord32 misses = scheduler_->deadline_misses() - start_misses;
+  int num_rendered = 0;
+  for (int i = 0; i < kNumStreams; ++i) {
+    EXPECT_EQ(0, streams_[i]->Stop());
+    // A frame is only skipped if a newer one is due when it is rendered.
+    EXPECT_GE(renderers_[i].num_frames(), kNumFrames * 9 / 10);
+    num_rendered += renderers_[i].num_frames();
+  }
+
+  webrtc::test::PrintResult("render_wakeups", "", "16_streams",
+                            static_cast<size_t>(wakeups), "wakeups", false);
+  webrtc::test::PrintResult("render_deadline_misses", "", "16_streams",
+                            static_cast<size_t>(misses), "frames", false);
+  webrtc::test::PrintResult("rendered_frames", "", "16_streams",
+                            static_cast<size_t>(num_rendered), "frames",
+                            false);
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -23,8 +23,14 @@ const WebRtc_UWord32 kMinRenderDelayMs = 10;
 const WebRtc_UWord32 kMaxRenderDelayMs= 500;
 
 VideoRenderFrames::VideoRenderFrames()
-    : incoming_frames_(),
+    : frames_(new I420VideoFrame[KMaxNumberOfFrames]),
+      incoming_head_(0),
+      num_incoming_frames_(0),
+      num_empty_frames_(KMaxNumberOfFrames),
       render_delay_ms_(10) {
+  for (int i = 0; i < KMaxNumberOfFrames; ++i) {
+    empty_frames_[i] = &frames_[i];
+  }
 }
 
 VideoRenderFrames::~VideoRenderFrames() {
@@ -48,37 +54,13 @@ WebRtc_Word32 VideoRenderFrames::AddFrame(I420VideoFrame* new_frame) {
   }
 */
   // Get an empty frame
-  I420VideoFrame* frame_to_add = NULL;
-  if (!empty_frames_.Empty()) {
-    ListItem* item = empty_frames_.First();
-    if (item) {
-      frame_to_add = static_cast<I420VideoFrame*>(item->GetItem());
-      empty_frames_.Erase(item);
-    }
-  }
-  if (!frame_to_add) {
-    if (empty_frames_.GetSize() + incoming_frames_.GetSize() >
-        KMaxNumberOfFrames) {
-      // Already allocated too many frames.
-      WEBRTC_TRACE(kTraceWarning, kTraceVideoRenderer,
-                   -1, "%s: too many frames, limit: %d", __FUNCTION__,
-                   KMaxNumberOfFrames);
-   WEBRTC_TRACE(webrtc::kTraceStateInfo, webrtc::kTraceVideo, 0, "AddFrame too many frames");
-      return -1;
-    }
-
-    // Allocate new memory.
-    WEBRTC_TRACE(kTraceMemory, kTraceVideoRenderer, -1,
-                 "%s: allocating buffer %d", __FUNCTION__,
-                 empty_frames_.GetSize() + incoming_frames_.GetSize());
-
-    frame_to_add = new I420VideoFrame();
-    if (!frame_to_add) {
-      WEBRTC_TRACE(kTraceError, kTraceVideoRenderer, -1,
-                   "%s: could not create new frame for", __FUNCTION__);
-      return -1;
-    }
+  if (num_empty_frames_ == 0) {
+    WEBRTC_TRACE(kTraceWarning, kTraceVideoRenderer,
+                 -1, "%s: too many frames, limit: %d", __FUNCTION__,
+                 KMaxNumberOfFrames);
+    return -1;
   }
+  I420VideoFrame* frame_to_add = empty_frames_[--num_empty_frames_];
 
   frame_to_add->CreateEmptyFrame(new_frame->width(), new_frame->height(),
                                  new_frame->stride(kYPlane),
@@ -87,78 +69,64 @@ WebRtc_Word32 VideoRenderFrames::AddFrame(I420VideoFrame* new_frame) {
   // TODO(mflodman) Change this!
   // Remove const ness. Copying will be costly.
   frame_to_add->SwapFrame(new_frame);
-  incoming_frames_.PushBack(frame_to_add);
 
-  return incoming_frames_.GetSize();
+  // Keep the queue sorted by render time. Frames nearly always arrive in
+  // order, so this rarely moves any.
+  int index = num_incoming_frames_;
+  while (index > 0 && IncomingFrame(index - 1)->render_time_ms() >
+                          frame_to_add->render_time_ms()) {
+    IncomingFrame(index) = IncomingFrame(index - 1);
+    --index;
+  }
+  IncomingFrame(index) = frame_to_add;
+  ++num_incoming_frames_;
+
+  return num_incoming_frames_;
 }
 
 I420VideoFrame* VideoRenderFrames::FrameToRender() {
   I420VideoFrame* render_frame = NULL;
-  while (!incoming_frames_.Empty()) {
-    ListItem* item = incoming_frames_.First();
-    if (item) {
-      I420VideoFrame* oldest_frame_in_list =
-          static_cast<I420VideoFrame*>(item->GetItem());
-      if (oldest_frame_in_list->render_time_ms() <=
-          TickTime::MillisecondTimestamp() + render_delay_ms_) {
-        // This is the oldest one so far and it's OK to render.
-        if (render_frame) {
-          // This one is older than the newly found frame, remove this one.
-          render_frame->ResetSize();
-          render_frame->set_timestamp(0);
-          render_frame->set_render_time_ms(0);
-          empty_frames_.PushFront(render_frame);
-        }
-        render_frame = oldest_frame_in_list;
-        incoming_frames_.Erase(item);
-      } else {
-        // We can't release this one yet, we're done here.
-        break;
-      }
-    } else {
-      assert(false);
+  const WebRtc_Word64 release_time_ms =
+      TickTime::MillisecondTimestamp() + render_delay_ms_;
+  while (num_incoming_frames_ > 0 &&
+         IncomingFrame(0)->render_time_ms() <= release_time_ms) {
+    // This is the oldest one so far and it's OK to render.
+    if (render_frame) {
+      // This one is older than the newly found frame, remove this one.
+      ReturnFrame(render_frame);
     }
+    render_frame = IncomingFrame(0);
+    incoming_head_ = (incoming_head_ + 1) & (KMaxNumberOfFrames - 1);
+    --num_incoming_frames_;
   }
   return render_frame;
 }
 
 WebRtc_Word32 VideoRenderFrames::ReturnFrame(I420VideoFrame* old_frame) {
+  assert(old_frame >= &frames_[0] &&
+         old_frame < &frames_[KMaxNumberOfFrames]);
+  assert(num_empty_frames_ < KMaxNumberOfFrames);
   old_frame->ResetSize();
   old_frame->set_timestamp(0);
   old_frame->set_render_time_ms(0);
-  empty_frames_.PushBack(old_frame);
+  empty_frames_[num_empty_frames_++] = old_frame;
   return 0;
 }
 
 WebRtc_Word32 VideoRenderFrames::ReleaseAllFrames() {
-  while (!incoming_frames_.Empty()) {
-    ListItem* item = incoming_frames_.First();
-    if (item) {
-      I420VideoFrame* frame = static_cast<I420VideoFrame*>(item->GetItem());
-      assert(frame != NULL);
-      delete frame;
-    }
-    incoming_frames_.Erase(item);
-  }
-  while (!empty_frames_.Empty()) {
-    ListItem* item = empty_frames_.First();
-    if (item) {
-      I420VideoFrame* frame = static_cast<I420VideoFrame*>(item->GetItem());
-      assert(frame != NULL);
-      delete frame;
-    }
-    empty_frames_.Erase(item);
+  while (num_incoming_frames_ > 0) {
+    ReturnFrame(IncomingFrame(0));
+    incoming_head_ = (incoming_head_ + 1) & (KMaxNumberOfFrames - 1);
+    --num_incoming_frames_;
   }
+  incoming_head_ = 0;
   return 0;
 }
 
 WebRtc_UWord32 VideoRenderFrames::TimeToNextFrameRelease() {
   WebRtc_Word64 time_to_release = 0;
-  ListItem* item = incoming_frames_.First();
-  if (item) {
-    I420VideoFrame* oldest_frame =
-        static_cast<I420VideoFrame*>(item->GetItem());
-    time_to_release = oldest_frame->render_time_ms() - render_delay_ms_
+  if (num_incoming_frames_ > 0) {
+    time_to_release = IncomingFrame(0)->render_time_ms() - render_delay_ms_
                       - TickTime::MillisecondTimestamp();
     if (time_to_release < 0) {
       time_to_release = 0;
@@ -183,4 +151,8 @@ WebRtc_Word32 VideoRenderFrames::SetRenderDelay(
   return 0;
 }
 
+I420VideoFrame*& VideoRenderFrames::IncomingFrame(int index) {
+  return incoming_frames_[(incoming_head_ + index) & (KMaxNumberOfFrames - 1)];
+}
+
 }  // namespace webrtc
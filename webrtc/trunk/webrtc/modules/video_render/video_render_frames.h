@@ -12,11 +12,13 @@
 #define WEBRTC_MODULES_VIDEO_RENDER_MAIN_SOURCE_VIDEO_RENDER_FRAMES_H_  // NOLINT
 
 #include "webrtc/modules/video_render/include/video_render.h"
-#include "system_wrappers/interface/list_wrapper.h"
+#include "system_wrappers/interface/scoped_ptr.h"
 
 namespace webrtc {
 
-// Class definitions
+// Queues frames for rendering in a fixed-capacity ring, ordered by render
+// time. The frames are preallocated and recycled, so their buffers are reused
+// once the queue has reached its working size.
 class VideoRenderFrames {
  public:
   VideoRenderFrames();
@@ -28,10 +30,10 @@ class VideoRenderFrames {
   // Get a frame for rendering, if it's time to render.
   I420VideoFrame* FrameToRender();
 
-  // Return an old frame
+  // Return an old frame, which must have been given by FrameToRender().
   WebRtc_Word32 ReturnFrame(I420VideoFrame* old_frame);
 
-  // Releases all frames
+  // Returns all queued frames to the pool.
   WebRtc_Word32 ReleaseAllFrames();
 
   // Returns the number of ms to next frame to render
@@ -41,17 +43,25 @@ class VideoRenderFrames {
   WebRtc_Word32 SetRenderDelay(const WebRtc_UWord32 render_delay);
 
  private:
-  // 10 seconds for 30 fps.
-  enum { KMaxNumberOfFrames = 300 };
+  // About 8 seconds for 30 fps. Must be a power of two.
+  enum { KMaxNumberOfFrames = 256 };
   // Don't render frames with timestamp older than 500ms from now.
   enum { KOldRenderTimestampMS = 500 };
   // Don't render frames with timestamp more than 10s into the future.
   enum { KFutureRenderTimestampMS = 10000 };
 
-  // Sorted list with framed to be rendered, oldest first.
-  ListWrapper incoming_frames_;
-  // Empty frames.
-  ListWrapper empty_frames_;
+  // Returns the |index|th oldest frame in the render queue.
+  I420VideoFrame*& IncomingFrame(int index);
+
+  // All frames, owned by this object.
+  scoped_array<I420VideoFrame> frames_;
+  // Ring of frames to be rendered, sorted by render time, oldest first.
+  I420VideoFrame* incoming_frames_[KMaxNumberOfFrames];
+  int incoming_head_;
+  int num_incoming_frames_;
+  // Stack of empty frames.
+  I420VideoFrame* empty_frames_[KMaxNumberOfFrames];
+  int num_empty_frames_;
 
   // Estimated delay from a frame is released until it's rendered.
   WebRtc_UWord32 render_delay_ms_;
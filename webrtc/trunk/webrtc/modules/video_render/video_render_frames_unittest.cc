@@ -0,0 +1,86 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/video_render/video_render_frames.h"
+
+#include "gtest/gtest.h"
+#include "system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+namespace {
+
+// Matches the capacity of VideoRenderFrames.
+const int kMaxNumberOfFrames = 256;
+
+class VideoRenderFramesTest : public ::testing::Test {
+ protected:
+  // Queues a frame to be rendered at |offset_ms| from now.
+  WebRtc_Word32 AddFrame(WebRtc_Word64 offset_ms) {
+    frame_.CreateEmptyFrame(16, 16, 16, 8, 8);
+    frame_.set_render_time_ms(TickTime::MillisecondTimestamp() + offset_ms);
+    return frames_.AddFrame(&frame_);
+  }
+
+  VideoRenderFrames frames_;
+  I420VideoFrame frame_;
+};
+
+TEST_F(VideoRenderFramesTest, RendersLatestDueFrame) {
+  EXPECT_EQ(1, AddFrame(-10));
+  EXPECT_EQ(2, AddFrame(1000));
+  // Out of order, queued before the first frame.
+  EXPECT_EQ(3, AddFrame(-30));
+
+  I420VideoFrame* frame = frames_.FrameToRender();
+  ASSERT_TRUE(frame != NULL);
+  const WebRtc_Word64 now_ms = TickTime::MillisecondTimestamp();
+  EXPECT_LE(frame->render_time_ms(), now_ms - 10);
+  EXPECT_GT(frame->render_time_ms(), now_ms - 30);
+  EXPECT_EQ(0, frames_.ReturnFrame(frame));
+
+  // Only the future frame is left.
+  EXPECT_TRUE(frames_.FrameToRender() == NULL);
+  EXPECT_GT(frames_.TimeToNextFrameRelease(), 900u);
+  EXPECT_LE(frames_.TimeToNextFrameRelease(), 1000u);
+}
+
+TEST_F(VideoRenderFramesTest, LimitsNumberOfFrames) {
+  for (int i = 0; i < kMaxNumberOfFrames; ++i) {
+    EXPECT_EQ(i + 1, AddFrame(-1000 + i));
+  }
+  EXPECT_EQ(-1, AddFrame(0));
+
+  // Rendering releases all but the returned frame.
+  I420VideoFrame* frame = frames_.FrameToRender();
+  ASSERT_TRUE(frame != NULL);
+  EXPECT_EQ(1, AddFrame(0));
+  EXPECT_EQ(0, frames_.ReturnFrame(frame));
+  EXPECT_EQ(0, frames_.ReleaseAllFrames());
+  for (int i = 0; i < kMaxNumberOfFrames; ++i) {
+    EXPECT_EQ(i + 1, AddFrame(1000));
+  }
+}
+
+TEST_F(VideoRenderFramesTest, RecyclesFrames) {
+  EXPECT_EQ(1, AddFrame(-10));
+  I420VideoFrame* first = frames_.FrameToRender();
+  ASSERT_TRUE(first != NULL);
+  EXPECT_EQ(0, frames_.ReturnFrame(first));
+  EXPECT_TRUE(first->IsZeroSize());
+
+  // The most recently returned frame is used first.
+  EXPECT_EQ(1, AddFrame(-10));
+  EXPECT_EQ(first, frames_.FrameToRender());
+  EXPECT_EQ(16, first->width());
+  EXPECT_EQ(0, frames_.ReturnFrame(first));
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,211 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/video_render/video_render_scheduler.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "webrtc/modules/video_render/incoming_video_stream.h"
+#include "system_wrappers/interface/condition_variable_wrapper.h"
+#include "system_wrappers/interface/critical_section_wrapper.h"
+#include "system_wrappers/interface/event_wrapper.h"
+#include "system_wrappers/interface/thread_wrapper.h"
+#include "system_wrappers/interface/tick_util.h"
+#include "system_wrappers/interface/trace.h"
+
+namespace webrtc {
+namespace {
+
+struct Later {
+  template <typename T>
+  bool operator()(const T& a, const T& b) const {
+    return a.due_ms > b.due_ms;
+  }
+};
+
+}  // namespace
+
+VideoRenderScheduler* VideoRenderScheduler::StaticInstance(
+    CountOperation count_operation) {
+  return GetStaticInstance<VideoRenderScheduler>(count_operation);
+}
+
+VideoRenderScheduler* VideoRenderScheduler::GetScheduler() {
+  return StaticInstance(kAddRef);
+}
+
+void VideoRenderScheduler::ReturnScheduler() {
+  StaticInstance(kRelease);
+}
+
+VideoRenderScheduler::VideoRenderScheduler()
+    : timer_critsect_(CriticalSectionWrapper::CreateCriticalSection()),
+      render_done_(ConditionVariableWrapper::CreateConditionVariable()),
+      rendering_stream_(NULL),
+      rendering_thread_id_(0),
+      wake_event_(EventWrapper::Create()),
+      thread_(ThreadWrapper::CreateThread(SchedulerThreadFun, this,
+                                          kRealtimePriority,
+                                          "VideoRenderScheduler")),
+      timers_(),
+      wakeups_(0),
+      deadline_misses_(0) {
+  unsigned int thread_id = 0;
+  if (!thread_ || !thread_->Start(thread_id)) {
+    WEBRTC_TRACE(kTraceError, kTraceVideoRenderer, -1,
+                 "%s: Could not start render thread", __FUNCTION__);
+  }
+}
+
+VideoRenderScheduler::~VideoRenderScheduler() {
+  assert(timers_.empty());
+  if (thread_) {
+    thread_->SetNotAlive();
+    wake_event_->Set();
+    if (thread_->Stop()) {
+      delete thread_;
+    } else {
+      WEBRTC_TRACE(kTraceWarning, kTraceVideoRenderer, -1,
+                   "%s: Not able to stop thread, leaking", __FUNCTION__);
+    }
+  }
+  delete wake_event_;
+  delete render_done_;
+  delete timer_critsect_;
+}
+
+void VideoRenderScheduler::AddStream(IncomingVideoStream* stream,
+                                     WebRtc_UWord32 delay_ms) {
+  CriticalSectionScoped cs(timer_critsect_);
+  if (ScheduleLocked(stream, delay_ms)) {
+    wake_event_->Set();
+  }
+}
+
+void VideoRenderScheduler::RemoveStream(IncomingVideoStream* stream) {
+  CriticalSectionScoped cs(timer_critsect_);
+  std::vector<Timer>::iterator it = FindLocked(stream);
+  if (it != timers_.end()) {
+    timers_.erase(it);
+    std::make_heap(timers_.begin(), timers_.end(), Later());
+  }
+  // Without its timer, the stream isn't picked again, so this only waits for
+  // the current rendering.
+  if (rendering_thread_id_ == ThreadWrapper::GetThreadId()) {
+    return;
+  }
+  while (rendering_stream_ == stream) {
+    render_done_->SleepCS(*timer_critsect_);
+  }
+}
+
+void VideoRenderScheduler::Wake(IncomingVideoStream* stream,
+                                WebRtc_UWord32 delay_ms) {
+  CriticalSectionScoped cs(timer_critsect_);
+  if (ScheduleLocked(stream, delay_ms)) {
+    wake_event_->Set();
+  }
+}
+
+WebRtc_UWord32 VideoRenderScheduler::wakeups() const {
+  CriticalSectionScoped cs(timer_critsect_);
+  return wakeups_;
+}
+
+WebRtc_UWord32 VideoRenderScheduler::deadline_misses() const {
+  CriticalSectionScoped cs(timer_critsect_);
+  return deadline_misses_;
+}
+
+std::vector<VideoRenderScheduler::Timer>::iterator
+VideoRenderScheduler::FindLocked(IncomingVideoStream* stream) {
+  std::vector<Timer>::iterator it = timers_.begin();
+  while (it != timers_.end() && it->stream != stream) {
+    ++it;
+  }
+  return it;
+}
+
+bool VideoRenderScheduler::ScheduleLocked(IncomingVideoStream* stream,
+                                          WebRtc_UWord32 delay_ms) {
+  const WebRtc_Word64 due_ms = TickTime::MillisecondTimestamp() + delay_ms;
+  std::vector<Timer>::iterator it = FindLocked(stream);
+  if (it == timers_.end()) {
+    Timer timer = { due_ms, stream };
+    timers_.push_back(timer);
+    std::push_heap(timers_.begin(), timers_.end(), Later());
+  } else if (due_ms < it->due_ms) {
+    it->due_ms = due_ms;
+    std::make_heap(timers_.begin(), timers_.end(), Later());
+  } else {
+    return false;
+  }
+  return timers_.front().stream == stream;
+}
+
+bool VideoRenderScheduler::SchedulerThreadFun(void* obj) {
+  return static_cast<VideoRenderScheduler*>(obj)->SchedulerProcess();
+}
+
+bool VideoRenderScheduler::SchedulerProcess() {
+  WebRtc_Word64 wait_ms = kMaxWaitTimeMs;
+  {
+    CriticalSectionScoped cs(timer_critsect_);
+    if (!timers_.empty()) {
+      wait_ms = std::min<WebRtc_Word64>(
+          timers_.front().due_ms - TickTime::MillisecondTimestamp(),
+          kMaxWaitTimeMs);
+    }
+  }
+  if (wait_ms > 0) {
+    wake_event_->Wait(static_cast<unsigned long>(wait_ms));
+  }
+
+  const WebRtc_UWord32 thread_id = ThreadWrapper::GetThreadId();
+  bool woken = false;
+  while (true) {
+    IncomingVideoStream* stream = NULL;
+    {
+      CriticalSectionScoped cs(timer_critsect_);
+      const WebRtc_Word64 now_ms = TickTime::MillisecondTimestamp();
+      if (timers_.empty() || timers_.front().due_ms > now_ms) {
+        break;
+      }
+      if (!woken) {
+        woken = true;
+        ++wakeups_;
+      }
+      if (now_ms - timers_.front().due_ms > kMaxLateMs) {
+        ++deadline_misses_;
+      }
+      // Keep the timer while rendering, so that frames queued meanwhile can
+      // move it earlier.
+      std::pop_heap(timers_.begin(), timers_.end(), Later());
+      stream = timers_.back().stream;
+      timers_.back().due_ms = now_ms + kMaxWaitTimeMs;
+      std::push_heap(timers_.begin(), timers_.end(), Later());
+      rendering_stream_ = stream;
+      rendering_thread_id_ = thread_id;
+    }
+    const WebRtc_UWord32 next_ms = stream->RenderProcess();
+    CriticalSectionScoped cs(timer_critsect_);
+    rendering_stream_ = NULL;
+    rendering_thread_id_ = 0;
+    // The stream may have been removed while it was rendered.
+    if (FindLocked(stream) != timers_.end()) {
+      ScheduleLocked(stream, next_ms);
+    }
+    render_done_->WakeAll();
+  }
+  return true;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_VIDEO_RENDER_MAIN_SOURCE_VIDEO_RENDER_SCHEDULER_H_  // NOLINT
+#define WEBRTC_MODULES_VIDEO_RENDER_MAIN_SOURCE_VIDEO_RENDER_SCHEDULER_H_  // NOLINT
+
+#include <vector>
+
+#include "system_wrappers/interface/static_instance.h"
+#include "typedefs.h"
+
+namespace webrtc {
+class ConditionVariableWrapper;
+class CriticalSectionWrapper;
+class EventWrapper;
+class IncomingVideoStream;
+class ThreadWrapper;
+
+// Renders the frames of all started IncomingVideoStreams from one shared
+// thread. The streams are kept in a timer heap ordered by when their next
+// frame is due, so the thread only wakes up when a stream has something to
+// render.
+class VideoRenderScheduler {
+ public:
+  // Returns the shared scheduler, creating it and its thread on first use.
+  // Each call must be matched by a call to ReturnScheduler().
+  static VideoRenderScheduler* GetScheduler();
+  static void ReturnScheduler();
+
+  // Starts servicing |stream|, the first time in |delay_ms|.
+  void AddStream(IncomingVideoStream* stream, WebRtc_UWord32 delay_ms);
+
+  // Stops servicing |stream|. If the thread is rendering |stream|, waits for
+  // it to finish, unless called from the rendering itself.
+  void RemoveStream(IncomingVideoStream* stream);
+
+  // Services |stream| in |delay_ms| at the latest. Called when a frame due
+  // earlier than the stream's next service is queued.
+  void Wake(IncomingVideoStream* stream, WebRtc_UWord32 delay_ms);
+
+  // Number of times the thread has woken up to service streams.
+  WebRtc_UWord32 wakeups() const;
+  // Number of times a stream was serviced more than kMaxLateMs after it was
+  // due.
+  WebRtc_UWord32 deadline_misses() const;
+
+  enum { kMaxLateMs = 10 };
+
+ protected:
+  VideoRenderScheduler();
+  virtual ~VideoRenderScheduler();
+
+  static VideoRenderScheduler* CreateInstance() {
+    return new VideoRenderScheduler();
+  }
+
+ private:
+  // Friend function to allow the destructor to be accessed from the template
+  // function.
+  friend VideoRenderScheduler* GetStaticInstance<VideoRenderScheduler>(
+      CountOperation count_operation);
+  static VideoRenderScheduler* StaticInstance(CountOperation count_operation);
+
+  struct Timer {
+    WebRtc_Word64 due_ms;
+    IncomingVideoStream* stream;
+  };
+
+  static bool SchedulerThreadFun(void* obj);
+  bool SchedulerProcess();
+
+  // Makes the timer of |stream| due in |delay_ms|, unless it is due earlier.
+  // Returns true if it is now the first timer. Must hold |timer_critsect_|.
+  bool ScheduleLocked(IncomingVideoStream* stream, WebRtc_UWord32 delay_ms);
+
+  // Returns the timer of |stream|, or timers_.end(). Must hold
+  // |timer_critsect_|.
+  std::vector<Timer>::iterator FindLocked(IncomingVideoStream* stream);
+
+  enum { kMaxWaitTimeMs = 100 };
+
+  // Not held while rendering, so that only the removal of the stream being
+  // rendered has to wait.
+  CriticalSectionWrapper* timer_critsect_;
+  // Signaled with |timer_critsect_| when the thread is done rendering a
+  // stream.
+  ConditionVariableWrapper* render_done_;
+  // The stream being rendered, if any, and the thread rendering it.
+  IncomingVideoStream* rendering_stream_;
+  WebRtc_UWord32 rendering_thread_id_;
+  EventWrapper* wake_event_;
+  ThreadWrapper* thread_;
+  // Min-heap on |due_ms|, one timer per stream. There are few streams, so
+  // updating a timer in place and re-heapifying is cheap.
+  std::vector<Timer> timers_;
+  WebRtc_UWord32 wakeups_;
+  WebRtc_UWord32 deadline_misses_;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_VIDEO_RENDER_MAIN_SOURCE_VIDEO_RENDER_SCHEDULER_H_  // NOLINT
@@ -44,6 +44,10 @@ class Atomic32 {
   bool CompareExchange(WebRtc_Word32 new_value, WebRtc_Word32 compare_value);
   WebRtc_Word32 Value() const;
 
+  // Value() is a plain read. This reads the value with a full memory barrier,
+  // so that accesses to the memory it guards aren't reordered with the read.
+  WebRtc_Word32 LoadWithBarrier() { return *this += 0; }
+
  private:
   // Disable the + and - operator since it's unclear what these operations
   // should do.
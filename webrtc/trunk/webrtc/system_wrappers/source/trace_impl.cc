@@ -12,6 +12,7 @@
 
 #include <cassert>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -29,10 +30,308 @@
 #pragma warning(disable:4355)
 #endif  // _WIN32
 
+#if defined(_MSC_VER) && !defined(va_copy)
+#define va_copy(dst, src) ((dst) = (src))
+#endif
+
 namespace webrtc {
 
 static WebRtc_UWord32 level_filter = kTraceDefault;
 
+namespace {
+
+// Argument types of the printf conversions supported by CaptureArguments().
+enum ArgumentType {
+  kNoArgument,  // "%%".
+  kIntArgument,
+  kLongArgument,
+  kLongLongArgument,
+  kSizeArgument,
+  kPtrDiffArgument,
+  kDoubleArgument,
+  kPointerArgument,
+  kStringArgument
+};
+
+const int kMaxConversionLength = 16;
+
+// Parses the conversion specification starting with the '%' at |format|.
+// Returns its length, or 0 if it isn't supported.
+int ParseConversion(const char* format, ArgumentType* type) {
+  const char* p = format + 1;
+  while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') {
+    ++p;
+  }
+  while (*p >= '0' && *p <= '9') {
+    ++p;
+  }
+  if (*p == '.') {
+    ++p;
+    while (*p >= '0' && *p <= '9') {
+      ++p;
+    }
+  }
+  const char* length_modifier = p;
+  ArgumentType integer_type = kIntArgument;
+  if (p[0] == 'h') {
+    p += (p[1] == 'h') ? 2 : 1;
+  } else if (p[0] == 'l' && p[1] == 'l') {
+    integer_type = kLongLongArgument;
+    p += 2;
+  } else if (p[0] == 'l') {
+    integer_type = kLongArgument;
+    ++p;
+  } else if (p[0] == 'q') {
+    integer_type = kLongLongArgument;
+    ++p;
+  } else if (p[0] == 'I' && p[1] == '6' && p[2] == '4') {
+    integer_type = kLongLongArgument;
+    p += 3;
+  } else if (p[0] == 'z') {
+    integer_type = kSizeArgument;
+    ++p;
+  } else if (p[0] == 'j') {
+    // intmax_t is 64 bits on all supported platforms.
+    integer_type = kLongLongArgument;
+    ++p;
+  } else if (p[0] == 't') {
+    integer_type = kPtrDiffArgument;
+    ++p;
+  }
+  const bool has_length_modifier = p != length_modifier;
+  switch (*p) {
+    case 'd':
+    case 'i':
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+      *type = integer_type;
+      break;
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      // "%lf" is a double too, but long doubles aren't supported.
+      if (has_length_modifier && integer_type != kLongArgument) {
+        return 0;
+      }
+      *type = kDoubleArgument;
+      break;
+    case 'c':
+      if (has_length_modifier) {
+        return 0;
+      }
+      *type = kIntArgument;
+      break;
+    case 's':
+      if (has_length_modifier) {
+        return 0;
+      }
+      *type = kStringArgument;
+      break;
+    case 'p':
+      if (has_length_modifier) {
+        return 0;
+      }
+      *type = kPointerArgument;
+      break;
+    case '%':
+      if (p != format + 1) {
+        return 0;
+      }
+      *type = kNoArgument;
+      break;
+    default:
+      // Including '*' widths and "%n".
+      return 0;
+  }
+  const int length = static_cast<int>(p + 1 - format);
+  return length < kMaxConversionLength ? length : 0;
+}
+
+template <typename T>
+bool StoreArgument(const T value, char* payload, const int size, int* used) {
+  if (*used + static_cast<int>(sizeof(value)) > size) {
+    return false;
+  }
+  memcpy(payload + *used, &value, sizeof(value));
+  *used += sizeof(value);
+  return true;
+}
+
+template <typename T>
+T LoadArgument(const char* payload, int* used) {
+  T value;
+  memcpy(&value, payload + *used, sizeof(value));
+  *used += sizeof(value);
+  return value;
+}
+
+// Stores a copy of |format| followed by the arguments it refers to in
+// |payload|, so that the message can be formatted later by
+// FormatArguments(). Strings are copied. Returns false if the format isn't
+// supported or doesn't fit in |size| bytes.
+bool CaptureArguments(const char* format, va_list args, char* payload,
+                      const int size) {
+  // The format is copied since it isn't always a string literal.
+  int used = 0;
+  while (format[used] != '\0') {
+    if (used == size - 1) {
+      return false;
+    }
+    payload[used] = format[used];
+    ++used;
+  }
+  payload[used++] = '\0';
+
+  for (const char* p = format; *p != '\0'; ++p) {
+    if (*p != '%') {
+      continue;
+    }
+    ArgumentType type;
+    const int length = ParseConversion(p, &type);
+    if (length == 0) {
+      return false;
+    }
+    p += length - 1;
+    bool stored = true;
+    switch (type) {
+      case kNoArgument:
+        break;
+      case kIntArgument:
+        stored = StoreArgument(va_arg(args, int), payload, size, &used);
+        break;
+      case kLongArgument:
+        stored = StoreArgument(va_arg(args, long), payload, size, &used);
+        break;
+      case kLongLongArgument:
+        stored = StoreArgument(va_arg(args, long long), payload, size, &used);
+        break;
+      case kSizeArgument:
+        stored = StoreArgument(va_arg(args, size_t), payload, size, &used);
+        break;
+      case kPtrDiffArgument:
+        stored = StoreArgument(va_arg(args, ptrdiff_t), payload, size, &used);
+        break;
+      case kDoubleArgument:
+        stored = StoreArgument(va_arg(args, double), payload, size, &used);
+        break;
+      case kPointerArgument:
+        stored = StoreArgument(va_arg(args, void*), payload, size, &used);
+        break;
+      case kStringArgument: {
+        const char* str = va_arg(args, const char*);
+        if (str == NULL) {
+          str = "(null)";
+        }
+        if (used == size) {
+          return false;
+        }
+        // Long strings are truncated, as the message would be.
+        while (*str != '\0' && used < size - 1) {
+          payload[used++] = *str++;
+        }
+        payload[used++] = '\0';
+        break;
+      }
+    }
+    if (!stored) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Formats one value with the printf |conversion| at the start of |message|.
+// Returns the number of characters written, truncated to fit in |size|
+// bytes with NULL termination.
+int FormatValue(char* message, const int size, const char* conversion, ...) {
+  va_list args;
+  va_start(args, conversion);
+#ifdef _WIN32
+  int length = _vsnprintf(message, size, conversion, args);
+#else
+  int length = vsnprintf(message, size, conversion, args);
+#endif
+  va_end(args);
+  if (length < 0 || length > size - 1) {
+    length = size - 1;
+  }
+  message[length] = '\0';
+  return length;
+}
+
+// Formats the message stored by CaptureArguments() into |message|. Returns
+// its length, truncated to fit in |size| bytes with NULL termination.
+int FormatArguments(const char* payload, char* message, const int size) {
+  const char* format = payload;
+  int used = static_cast<int>(strlen(format)) + 1;
+  int length = 0;
+  for (const char* p = format; *p != '\0' && length < size - 1; ++p) {
+    if (*p != '%') {
+      message[length++] = *p;
+      continue;
+    }
+    ArgumentType type;
+    const int conversion_length = ParseConversion(p, &type);
+    char conversion[kMaxConversionLength];
+    memcpy(conversion, p, conversion_length);
+    conversion[conversion_length] = '\0';
+    p += conversion_length - 1;
+
+    char* out = message + length;
+    const int out_size = size - length;
+    switch (type) {
+      case kNoArgument:
+        message[length++] = '%';
+        break;
+      case kIntArgument:
+        length += FormatValue(out, out_size, conversion,
+                              LoadArgument<int>(payload, &used));
+        break;
+      case kLongArgument:
+        length += FormatValue(out, out_size, conversion,
+                              LoadArgument<long>(payload, &used));
+        break;
+      case kLongLongArgument:
+        length += FormatValue(out, out_size, conversion,
+                              LoadArgument<long long>(payload, &used));
+        break;
+      case kSizeArgument:
+        length += FormatValue(out, out_size, conversion,
+                              LoadArgument<size_t>(payload, &used));
+        break;
+      case kPtrDiffArgument:
+        length += FormatValue(out, out_size, conversion,
+                              LoadArgument<ptrdiff_t>(payload, &used));
+        break;
+      case kDoubleArgument:
+        length += FormatValue(out, out_size, conversion,
+                              LoadArgument<double>(payload, &used));
+        break;
+      case kPointerArgument:
+        length += FormatValue(out, out_size, conversion,
+                              LoadArgument<void*>(payload, &used));
+        break;
+      case kStringArgument: {
+        const char* str = payload + used;
+        used += static_cast<int>(strlen(str)) + 1;
+        length += FormatValue(out, out_size, conversion, str);
+        break;
+      }
+    }
+  }
+  message[length] = '\0';
+  return length;
+}
+
+}  // namespace
+
 // Construct On First Use idiom. Avoids "static initialization order fiasco".
 TraceImpl* TraceImpl::StaticInstance(CountOperation count_operation,
                                      const TraceLevel level) {
@@ -70,24 +369,21 @@ TraceImpl::TraceImpl()
       thread_(*ThreadWrapper::CreateThread(TraceImpl::Run, this,
                                            kHighestPriority, "Trace")),
       event_(*EventWrapper::Create()),
-      critsect_array_(CriticalSectionWrapper::CreateCriticalSection()),
-      next_free_idx_(),
-      level_(),
-      length_(),
-      message_queue_(),
-      active_queue_(0) {
-  next_free_idx_[0] = 0;
-  next_free_idx_[1] = 0;
-
+      critsect_buffers_(CriticalSectionWrapper::CreateCriticalSection()),
+      thread_buffers_(),
+      write_buffers_() {
   unsigned int tid = 0;
   thread_.Start(tid);
+}
 
-  for (int m = 0; m < WEBRTC_TRACE_NUM_ARRAY; ++m) {
-    for (int n = 0; n < WEBRTC_TRACE_MAX_QUEUE; ++n) {
-      message_queue_[m][n] = new
-      char[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
-    }
-  }
+TraceImpl::ThreadBuffer::ThreadBuffer()
+    : write_count(0),
+      read_count(0),
+      dropped_count(0),
+      reported_dropped_count(0),
+      write_limit(0),
+      in_use(1),
+      thread_id(0) {
 }
 
 bool TraceImpl::StopThread() {
@@ -118,17 +414,15 @@ TraceImpl::~TraceImpl() {
   delete &trace_file_;
   delete &thread_;
   delete critsect_interface_;
-  delete critsect_array_;
+  delete critsect_buffers_;
 
-  for (int m = 0; m < WEBRTC_TRACE_NUM_ARRAY; ++m) {
-    for (int n = 0; n < WEBRTC_TRACE_MAX_QUEUE; ++n) {
-      delete [] message_queue_[m][n];
-    }
+  for (size_t i = 0; i < thread_buffers_.size(); ++i) {
+    delete thread_buffers_[i];
   }
 }
 
-WebRtc_Word32 TraceImpl::AddThreadId(char* trace_message) const {
-  WebRtc_UWord32 thread_id = ThreadWrapper::GetThreadId();
+WebRtc_Word32 TraceImpl::AddThreadId(char* trace_message,
+                                     const WebRtc_UWord32 thread_id) const {
   // Messages is 12 characters.
   return sprintf(trace_message, "%10u; ", thread_id);
 }
@@ -407,60 +701,81 @@ WebRtc_Word32 TraceImpl::AddMessage(
   return length + 1;
 }
 
-void TraceImpl::AddMessageToList(
-  const char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE],
-  const WebRtc_UWord16 length,
-  const TraceLevel level) {
-#ifdef WEBRTC_DIRECT_TRACE
-  if (callback_) {
-    callback_->Print(level, trace_message, length);
+WebRtc_Word32 TraceImpl::FormatRecord(char* trace_message,
+                                      const Record& record) const {
+  char* message_ptr = trace_message;
+
+  WebRtc_Word32 len = 0;
+  WebRtc_Word32 ack_len = 0;
+
+  len = AddLevel(message_ptr, record.level);
+  if (len == -1) {
+    return -1;
   }
-  return;
-#endif
+  message_ptr += len;
+  ack_len += len;
 
-  CriticalSectionScoped lock(critsect_array_);
-
-  if (next_free_idx_[active_queue_] >= WEBRTC_TRACE_MAX_QUEUE) {
-    if (!trace_file_.Open() && !callback_) {
-      // Keep at least the last 1/4 of old messages when not logging.
-      // TODO(hellner): isn't this redundant. The user will make it known
-      //                when to start logging. Why keep messages before
-      //                that?
-      for (int n = 0; n < WEBRTC_TRACE_MAX_QUEUE / 4; ++n) {
-        const int last_quarter_offset = (3 * WEBRTC_TRACE_MAX_QUEUE / 4);
-        memcpy(message_queue_[active_queue_][n],
-               message_queue_[active_queue_][n + last_quarter_offset],
-               WEBRTC_TRACE_MAX_MESSAGE_SIZE);
-      }
-      next_free_idx_[active_queue_] = WEBRTC_TRACE_MAX_QUEUE / 4;
-    } else {
-      // More messages are being written than there is room for in the
-      // buffer. Drop any new messages.
-      // TODO(hellner): its probably better to drop old messages instead
-      //                of new ones. One step further: if this happens
-      //                it's due to writing faster than what can be
-      //                processed. Maybe modify the filter at this point.
-      //                E.g. turn of STREAM.
-      return;
-    }
+  len = AddTime(message_ptr, record.level, record.time_ms);
+  if (len == -1) {
+    return -1;
   }
+  message_ptr += len;
+  ack_len += len;
 
-  WebRtc_UWord16 idx = next_free_idx_[active_queue_];
-  next_free_idx_[active_queue_]++;
+  len = AddModuleAndId(message_ptr, record.module, record.id);
+  if (len == -1) {
+    return -1;
+  }
+  message_ptr += len;
+  ack_len += len;
 
-  level_[active_queue_][idx] = level;
-  length_[active_queue_][idx] = length;
-  memcpy(message_queue_[active_queue_][idx], trace_message, length);
+  len = AddThreadId(message_ptr, record.thread_id);
+  if (len < 0) {
+    return -1;
+  }
+  message_ptr += len;
+  ack_len += len;
+
+  if (record.formatted) {
+    len = AddMessage(message_ptr, record.payload, (WebRtc_UWord16)ack_len);
+  } else {
+    // - 2 to leave room for newline and NULL termination, as in
+    // AddMessage().
+    len = FormatArguments(record.payload, message_ptr,
+                          WEBRTC_TRACE_MAX_MESSAGE_SIZE - ack_len - 2) + 1;
+  }
+  if (len == -1) {
+    return -1;
+  }
+  return ack_len + len;
+}
 
-  if (next_free_idx_[active_queue_] == WEBRTC_TRACE_MAX_QUEUE - 1) {
-    // Logging more messages than can be worked off. Log a warning.
-    const char warning_msg[] = "WARNING MISSING TRACE MESSAGES\n";
-    level_[active_queue_][next_free_idx_[active_queue_]] = kTraceWarning;
-    length_[active_queue_][next_free_idx_[active_queue_]] = strlen(warning_msg);
-    memcpy(message_queue_[active_queue_][next_free_idx_[active_queue_]],
-           warning_msg, strlen(warning_msg));
-    next_free_idx_[active_queue_]++;
+TraceImpl::ThreadBuffer* TraceImpl::GetThreadBuffer() {
+  ThreadBuffer* buffer = CurrentThreadBuffer();
+  if (buffer) {
+    return buffer;
+  }
+  {
+    CriticalSectionScoped lock(critsect_buffers_);
+    // Take over the buffer of a thread that has exited, if any.
+    for (size_t i = 0; i < thread_buffers_.size(); ++i) {
+      if (thread_buffers_[i]->in_use.CompareExchange(1, 0)) {
+        buffer = thread_buffers_[i];
+        break;
+      }
+    }
+    if (!buffer) {
+      buffer = new ThreadBuffer();
+      thread_buffers_.push_back(buffer);
+    }
   }
+  buffer->thread_id = ThreadWrapper::GetThreadId();
+  SetCurrentThreadBuffer(buffer);
+  return buffer;
+}
+
+void TraceImpl::ReleaseThreadBuffer(ThreadBuffer* buffer) {
+  --buffer->in_use;
 }
 
 bool TraceImpl::Run(void* obj) {
@@ -468,150 +783,218 @@ bool TraceImpl::Run(void* obj) {
 }
 
 bool TraceImpl::Process() {
-  if (event_.Wait(1000) == kEventSignaled) {
-    if (trace_file_.Open() || callback_) {
-      // File mode (not callback mode).
-      WriteToFile();
-    }
-  } else {
-    trace_file_.Flush();
+  // Threads only signal when their buffer is half full, so the buffers are
+  // polled too.
+  event_.Wait(WEBRTC_TRACE_WRITE_INTERVAL_MS);
+  if (WriteToFile()) {
+    return true;
   }
+  trace_file_.Flush();
   return true;
 }
 
-void TraceImpl::WriteToFile() {
-  WebRtc_UWord8 local_queue_active = 0;
-  WebRtc_UWord16 local_next_free_idx = 0;
-
-  // There are two buffers. One for reading (for writing to file) and one for
-  // writing (for storing new messages). Let new messages be posted to the
-  // unused buffer so that the current buffer can be flushed safely.
+bool TraceImpl::WriteToFile() {
   {
-    CriticalSectionScoped lock(critsect_array_);
-    local_next_free_idx = next_free_idx_[active_queue_];
-    next_free_idx_[active_queue_] = 0;
-    local_queue_active = active_queue_;
-    if (active_queue_ == 0) {
-      active_queue_ = 1;
-    } else {
-      active_queue_ = 0;
-    }
+    CriticalSectionScoped lock(critsect_buffers_);
+    write_buffers_ = thread_buffers_;
   }
-  if (local_next_free_idx == 0) {
-    return;
+  // Records added from now on are left for the next call.
+  bool pending = false;
+  for (size_t i = 0; i < write_buffers_.size(); ++i) {
+    ThreadBuffer* buffer = write_buffers_[i];
+    buffer->write_limit = buffer->write_count.LoadWithBarrier();
+    pending |= buffer->write_limit != buffer->read_count.Value();
   }
 
   CriticalSectionScoped lock(critsect_interface_);
 
-  for (WebRtc_UWord16 idx = 0; idx < local_next_free_idx; ++idx) {
-    TraceLevel local_level = level_[local_queue_active][idx];
-    if (callback_) {
-      callback_->Print(local_level, message_queue_[local_queue_active][idx],
-                       length_[local_queue_active][idx]);
+  if (!trace_file_.Open() && !callback_) {
+    // Nowhere to write them. Discard the records so that the threads don't
+    // run out of room, and stale records aren't written once a trace file
+    // or callback is set.
+    for (size_t i = 0; i < write_buffers_.size(); ++i) {
+      ThreadBuffer* buffer = write_buffers_[i];
+      buffer->read_count += buffer->write_limit - buffer->read_count.Value();
+      buffer->reported_dropped_count = buffer->dropped_count.Value();
     }
-    if (trace_file_.Open()) {
-      if (row_count_text_ > WEBRTC_TRACE_MAX_FILE_SIZE) {
-        // wrap file
-        row_count_text_ = 0;
-        trace_file_.Flush();
-
-        if (file_count_text_ == 0) {
-          trace_file_.Rewind();
-        } else {
-          char old_file_name[FileWrapper::kMaxFileNameSize];
-          char new_file_name[FileWrapper::kMaxFileNameSize];
-
-          // get current name
-          trace_file_.FileName(old_file_name,
-                               FileWrapper::kMaxFileNameSize);
-          trace_file_.CloseFile();
-
-          file_count_text_++;
-
-          UpdateFileName(old_file_name, new_file_name, file_count_text_);
-
-          if (trace_file_.OpenFile(new_file_name, false, false,
-                                   true) == -1) {
-            return;
-          }
-        }
+    return false;
+  }
+
+  char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE + 1];
+  for (size_t i = 0; i < write_buffers_.size(); ++i) {
+    ThreadBuffer* buffer = write_buffers_[i];
+    const WebRtc_Word32 dropped_count = buffer->dropped_count.Value();
+    if (dropped_count != buffer->reported_dropped_count) {
+      // Logging more messages than can be worked off. Log a warning.
+      buffer->reported_dropped_count = dropped_count;
+      const char warning_msg[] = "WARNING MISSING TRACE MESSAGES\n";
+      memcpy(trace_message, warning_msg, sizeof(warning_msg));
+      WriteMessage(kTraceWarning, trace_message, strlen(warning_msg));
+    }
+  }
+
+  // Each buffer is in time order; merge them.
+  while (true) {
+    ThreadBuffer* next = NULL;
+    const Record* next_record = NULL;
+    for (size_t i = 0; i < write_buffers_.size(); ++i) {
+      ThreadBuffer* buffer = write_buffers_[i];
+      const WebRtc_Word32 read_count = buffer->read_count.Value();
+      if (read_count == buffer->write_limit) {
+        continue;
       }
-      if (row_count_text_ ==  0) {
-        char message[WEBRTC_TRACE_MAX_MESSAGE_SIZE + 1];
-        WebRtc_Word32 length = AddDateTimeInfo(message);
-        if (length != -1) {
-          message[length] = 0;
-          message[length - 1] = '\n';
-          trace_file_.Write(message, length);
-          row_count_text_++;
-        }
-        length = AddBuildInfo(message);
-        if (length != -1) {
-          message[length + 1] = 0;
-          message[length] = '\n';
-          message[length - 1] = '\n';
-          trace_file_.Write(message, length + 1);
-          row_count_text_++;
-          row_count_text_++;
-        }
+      const Record* record = &buffer->records[
+          static_cast<WebRtc_UWord32>(read_count) % WEBRTC_TRACE_THREAD_QUEUE];
+      if (!next_record || record->time_ms < next_record->time_ms) {
+        next = buffer;
+        next_record = record;
       }
-      WebRtc_UWord16 length = length_[local_queue_active][idx];
-      message_queue_[local_queue_active][idx][length] = 0;
-      message_queue_[local_queue_active][idx][length - 1] = '\n';
-      trace_file_.Write(message_queue_[local_queue_active][idx], length);
-      row_count_text_++;
+    }
+    if (!next) {
+      break;
+    }
+    const WebRtc_Word32 length = FormatRecord(trace_message, *next_record);
+    const TraceLevel level = next_record->level;
+    // Hands the record back to its thread.
+    ++next->read_count;
+    if (length > 0) {
+      WriteMessage(level, trace_message, (WebRtc_UWord16)length);
     }
   }
+  return pending;
 }
 
-void TraceImpl::AddImpl(const TraceLevel level, const TraceModule module,
-                        const WebRtc_Word32 id,
-                        const char msg[WEBRTC_TRACE_MAX_MESSAGE_SIZE]) {
-  if (TraceCheck(level)) {
-    char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
-    char* message_ptr = trace_message;
-
-    WebRtc_Word32 len = 0;
-    WebRtc_Word32 ack_len = 0;
-
-    len = AddLevel(message_ptr, level);
-    if (len == -1) {
-      return;
+void TraceImpl::WriteMessage(const TraceLevel level, char* trace_message,
+                             const WebRtc_UWord16 length) {
+  if (callback_) {
+    callback_->Print(level, trace_message, length);
+  }
+  if (trace_file_.Open()) {
+    if (row_count_text_ > WEBRTC_TRACE_MAX_FILE_SIZE) {
+      // wrap file
+      row_count_text_ = 0;
+      trace_file_.Flush();
+
+      if (file_count_text_ == 0) {
+        trace_file_.Rewind();
+      } else {
+        char old_file_name[FileWrapper::kMaxFileNameSize];
+        char new_file_name[FileWrapper::kMaxFileNameSize];
+
+        // get current name
+        trace_file_.FileName(old_file_name,
+                             FileWrapper::kMaxFileNameSize);
+        trace_file_.CloseFile();
+
+        file_count_text_++;
+
+        UpdateFileName(old_file_name, new_file_name, file_count_text_);
+
+        if (trace_file_.OpenFile(new_file_name, false, false,
+                                 true) == -1) {
+          return;
+        }
+      }
     }
-    message_ptr += len;
-    ack_len += len;
-
-    len = AddTime(message_ptr, level);
-    if (len == -1) {
-      return;
+    if (row_count_text_ ==  0) {
+      char message[WEBRTC_TRACE_MAX_MESSAGE_SIZE + 1];
+      WebRtc_Word32 length = AddDateTimeInfo(message);
+      if (length != -1) {
+        message[length] = 0;
+        message[length - 1] = '\n';
+        trace_file_.Write(message, length);
+        row_count_text_++;
+      }
+      length = AddBuildInfo(message);
+      if (length != -1) {
+        message[length + 1] = 0;
+        message[length] = '\n';
+        message[length - 1] = '\n';
+        trace_file_.Write(message, length + 1);
+        row_count_text_++;
+        row_count_text_++;
+      }
     }
-    message_ptr += len;
-    ack_len += len;
+    trace_message[length] = 0;
+    trace_message[length - 1] = '\n';
+    trace_file_.Write(trace_message, length);
+    row_count_text_++;
+  }
+}
 
-    len = AddModuleAndId(message_ptr, module, id);
-    if (len == -1) {
-      return;
-    }
-    message_ptr += len;
-    ack_len += len;
+void TraceImpl::AddImpl(const TraceLevel level, const TraceModule module,
+                        const WebRtc_Word32 id, const char* format,
+                        va_list args) {
+  if (!TraceCheck(level)) {
+    return;
+  }
+#ifdef WEBRTC_DIRECT_TRACE
+  Record direct_record;
+  Record& record = direct_record;
+  record.thread_id = ThreadWrapper::GetThreadId();
+#else
+  ThreadBuffer* buffer = GetThreadBuffer();
+  if (!buffer) {
+    return;
+  }
+  const WebRtc_Word32 write_count = buffer->write_count.Value();
+  if (static_cast<WebRtc_UWord32>(write_count) -
+      static_cast<WebRtc_UWord32>(buffer->read_count.LoadWithBarrier()) >=
+      WEBRTC_TRACE_THREAD_QUEUE) {
+    // More messages are being written than there is room for in the
+    // buffer. Drop any new messages.
+    ++buffer->dropped_count;
+    return;
+  }
+  Record& record = buffer->records[
+      static_cast<WebRtc_UWord32>(write_count) % WEBRTC_TRACE_THREAD_QUEUE];
+  // Looking up the thread id is a system call on Linux.
+  record.thread_id = buffer->thread_id;
+#endif
 
-    len = AddThreadId(message_ptr);
-    if (len < 0) {
-      return;
+  record.level = level;
+  record.module = module;
+  record.id = id;
+  record.time_ms = TimeMs();
+  record.formatted = false;
+  if (!format) {
+    record.formatted = true;
+    record.payload[0] = '\0';
+  } else {
+    va_list args_copy;
+    va_copy(args_copy, args);
+    if (!CaptureArguments(format, args_copy, record.payload,
+                          sizeof(record.payload))) {
+      // Too long or unusual; format it right away instead.
+      record.formatted = true;
+#ifdef _WIN32
+      _vsnprintf(record.payload, sizeof(record.payload) - 1, format, args);
+#else
+      vsnprintf(record.payload, sizeof(record.payload) - 1, format, args);
+#endif
+      record.payload[sizeof(record.payload) - 1] = '\0';
     }
-    message_ptr += len;
-    ack_len += len;
+    va_end(args_copy);
+  }
 
-    len = AddMessage(message_ptr, msg, (WebRtc_UWord16)ack_len);
-    if (len == -1) {
-      return;
+#ifdef WEBRTC_DIRECT_TRACE
+  if (callback_) {
+    char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE + 1];
+    const WebRtc_Word32 length = FormatRecord(trace_message, record);
+    if (length > 0) {
+      callback_->Print(level, trace_message, length);
     }
-    ack_len += len;
-    AddMessageToList(trace_message, (WebRtc_UWord16)ack_len, level);
-
-    // Make sure that messages are written as soon as possible.
+  }
+#else
+  // Hands the record to the writer thread, and wakes it up if the buffer is
+  // filling up.
+  const WebRtc_UWord32 pending = static_cast<WebRtc_UWord32>(
+      ++buffer->write_count) - static_cast<WebRtc_UWord32>(
+      buffer->read_count.Value());
+  if (pending == WEBRTC_TRACE_THREAD_QUEUE / 2) {
     event_.Set();
   }
+#endif
 }
 
 bool TraceImpl::TraceCheck(const TraceLevel level) const {
@@ -745,20 +1128,10 @@ void Trace::Add(const TraceLevel level, const TraceModule module,
 
   if (trace) {
     if (trace->TraceCheck(level)) {
-      char temp_buff[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
-      char* buff = 0;
-      if (msg) {
-        va_list args;
-        va_start(args, msg);
-#ifdef _WIN32
-        _vsnprintf(temp_buff, WEBRTC_TRACE_MAX_MESSAGE_SIZE - 1, msg, args);
-#else
-        vsnprintf(temp_buff, WEBRTC_TRACE_MAX_MESSAGE_SIZE - 1, msg, args);
-#endif
-        va_end(args);
-        buff = temp_buff;
-      }
-      trace->AddImpl(level, module, id, buff);
+      va_list args;
+      va_start(args, msg);
+      trace->AddImpl(level, module, id, msg, args);
+      va_end(args);
     }
     ReturnTrace();
   }
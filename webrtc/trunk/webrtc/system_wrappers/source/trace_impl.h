@@ -11,6 +11,11 @@
 #ifndef WEBRTC_SYSTEM_WRAPPERS_SOURCE_TRACE_IMPL_H_
 #define WEBRTC_SYSTEM_WRAPPERS_SOURCE_TRACE_IMPL_H_
 
+#include <stdarg.h>
+
+#include <vector>
+
+#include "webrtc/system_wrappers/interface/atomic32.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/event_wrapper.h"
 #include "webrtc/system_wrappers/interface/file_wrapper.h"
@@ -20,21 +25,18 @@
 
 namespace webrtc {
 
-// TODO(pwestin) WEBRTC_TRACE_MAX_QUEUE needs to be tweaked
-// TODO(hellner) the buffer should be close to how much the system can write to
-//               file. Increasing the buffer will not solve anything. Sooner or
-//               later the buffer is going to fill up anyways.
+// Number of trace records buffered per thread. The writer thread drains the
+// buffers every WEBRTC_TRACE_WRITE_INTERVAL_MS, or earlier when a buffer is
+// half full; records are dropped if a thread fills its buffer before that.
 #if defined(WEBRTC_IOS)
-#define WEBRTC_TRACE_MAX_QUEUE  2000
+#define WEBRTC_TRACE_THREAD_QUEUE 64
 #else
-#define WEBRTC_TRACE_MAX_QUEUE  8000
+#define WEBRTC_TRACE_THREAD_QUEUE 256
 #endif
-#define WEBRTC_TRACE_NUM_ARRAY 2
+#define WEBRTC_TRACE_WRITE_INTERVAL_MS 50
 #define WEBRTC_TRACE_MAX_MESSAGE_SIZE 256
-// Total buffer size is WEBRTC_TRACE_NUM_ARRAY (number of buffer partitions) *
-// WEBRTC_TRACE_MAX_QUEUE (number of lines per buffer partition) *
-// WEBRTC_TRACE_MAX_MESSAGE_SIZE (number of 1 byte charachters per line) =
-// 1 or 4 Mbyte.
+// Each record takes WEBRTC_TRACE_MAX_MESSAGE_SIZE bytes, so the buffers take
+// 16 or 64 kbyte per tracing thread.
 
 #define WEBRTC_TRACE_MAX_FILE_SIZE 100*1000
 // Number of rows that may be written to file. On average 110 bytes per row (max
@@ -55,28 +57,78 @@ class TraceImpl : public Trace {
 
   WebRtc_Word32 SetTraceCallbackImpl(TraceCallback* callback);
 
+  // Stores a record of the message in the calling thread's buffer. The
+  // message is formatted from |format| and |args| by the writer thread.
   void AddImpl(const TraceLevel level, const TraceModule module,
-               const WebRtc_Word32 id, const char* msg);
+               const WebRtc_Word32 id, const char* format, va_list args);
 
   bool StopThread();
 
   bool TraceCheck(const TraceLevel level) const;
 
  protected:
+  // A message as stored by AddImpl(). The payload holds a copy of the format
+  // string followed by the arguments, see CaptureArguments() in
+  // trace_impl.cc. If |formatted| is set it holds the formatted message.
+  struct Record {
+    TraceLevel level;
+    TraceModule module;
+    WebRtc_Word32 id;
+    WebRtc_UWord32 thread_id;
+    WebRtc_Word64 time_ms;
+    bool formatted;
+    char payload[WEBRTC_TRACE_MAX_MESSAGE_SIZE - 32];
+  };
+
+  // Ring buffer of the records of one thread. The thread writes records and
+  // the writer thread reads them, without locking.
+  struct ThreadBuffer {
+    ThreadBuffer();
+
+    Record records[WEBRTC_TRACE_THREAD_QUEUE];
+    // Number of records written and read. Only the writing thread increments
+    // |write_count|, and only the writer thread |read_count|.
+    Atomic32 write_count;
+    Atomic32 read_count;
+    // Number of records dropped because the buffer was full.
+    Atomic32 dropped_count;
+    // Used by the writer thread only.
+    WebRtc_Word32 reported_dropped_count;
+    WebRtc_Word32 write_limit;
+    // Cleared when the thread owning the buffer exits, so that the buffer
+    // can be taken over by a new thread.
+    Atomic32 in_use;
+    // Id of the thread owning the buffer.
+    WebRtc_UWord32 thread_id;
+  };
+
   TraceImpl();
 
   static TraceImpl* StaticInstance(CountOperation count_operation,
                                    const TraceLevel level = kTraceAll);
 
-  WebRtc_Word32 AddThreadId(char* trace_message) const;
+  WebRtc_Word32 AddThreadId(char* trace_message,
+                            const WebRtc_UWord32 thread_id) const;
 
   // OS specific implementations.
+  // Formats |time_ms|, as returned by TimeMs(), in the message header.
   virtual WebRtc_Word32 AddTime(char* trace_message,
-                                const TraceLevel level) const = 0;
+                                const TraceLevel level,
+                                const WebRtc_Word64 time_ms) const = 0;
 
   virtual WebRtc_Word32 AddBuildInfo(char* trace_message) const = 0;
   virtual WebRtc_Word32 AddDateTimeInfo(char* trace_message) const = 0;
 
+  // Wall clock time in milliseconds, from an OS specific epoch.
+  virtual WebRtc_Word64 TimeMs() const = 0;
+
+  // Thread local storage of the calling thread's buffer.
+  virtual ThreadBuffer* CurrentThreadBuffer() const = 0;
+  virtual void SetCurrentThreadBuffer(ThreadBuffer* buffer) = 0;
+
+  // Called by OS specific implementations when a thread exits.
+  static void ReleaseThreadBuffer(ThreadBuffer* buffer);
+
   static bool Run(void* obj);
   bool Process();
 
@@ -92,10 +144,16 @@ class TraceImpl : public Trace {
                            const char msg[WEBRTC_TRACE_MAX_MESSAGE_SIZE],
                            const WebRtc_UWord16 written_so_far) const;
 
-  void AddMessageToList(
-    const char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE],
-    const WebRtc_UWord16 length,
-    const TraceLevel level);
+  // Formats |record| into |trace_message|. Returns the length of the
+  // message including NULL termination, or -1 on error.
+  WebRtc_Word32 FormatRecord(char* trace_message, const Record& record) const;
+
+  // Returns the calling thread's buffer, creating it if needed. Returns NULL
+  // if out of memory.
+  ThreadBuffer* GetThreadBuffer();
+
+  void WriteMessage(const TraceLevel level, char* trace_message,
+                    const WebRtc_UWord16 length);
 
   bool UpdateFileName(
     const char file_name_utf8[FileWrapper::kMaxFileNameSize],
@@ -107,7 +165,9 @@ class TraceImpl : public Trace {
     char file_name_with_counter_utf8[FileWrapper::kMaxFileNameSize],
     const WebRtc_UWord32 new_count) const;
 
-  void WriteToFile();
+  // Writes the buffered records in time order, or discards them if there is
+  // no trace file or callback. Returns false if none were written.
+  bool WriteToFile();
 
   CriticalSectionWrapper* critsect_interface_;
   TraceCallback* callback_;
@@ -118,13 +178,11 @@ class TraceImpl : public Trace {
   ThreadWrapper& thread_;
   EventWrapper& event_;
 
-  // critsect_array_ protects active_queue_.
-  CriticalSectionWrapper* critsect_array_;
-  WebRtc_UWord16 next_free_idx_[WEBRTC_TRACE_NUM_ARRAY];
-  TraceLevel level_[WEBRTC_TRACE_NUM_ARRAY][WEBRTC_TRACE_MAX_QUEUE];
-  WebRtc_UWord16 length_[WEBRTC_TRACE_NUM_ARRAY][WEBRTC_TRACE_MAX_QUEUE];
-  char* message_queue_[WEBRTC_TRACE_NUM_ARRAY][WEBRTC_TRACE_MAX_QUEUE];
-  WebRtc_UWord8 active_queue_;
+  // critsect_buffers_ protects thread_buffers_.
+  CriticalSectionWrapper* critsect_buffers_;
+  std::vector<ThreadBuffer*> thread_buffers_;
+  // Copy of thread_buffers_ used by the writer thread.
+  std::vector<ThreadBuffer*> write_buffers_;
 };
 
 }  // namespace webrtc
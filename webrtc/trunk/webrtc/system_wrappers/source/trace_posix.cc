@@ -16,9 +16,7 @@
 #include <string.h>
 #include <sys/time.h>
 #include <time.h>
-#ifdef WEBRTC_ANDROID
-#include <pthread.h>
-#else
+#ifndef WEBRTC_ANDROID
 #include <iostream>
 #endif
 
@@ -39,40 +37,39 @@
 namespace webrtc {
 
 TracePosix::TracePosix() {
-  struct timeval system_time_high_res;
-  gettimeofday(&system_time_high_res, 0);
-  prev_api_tick_count_ = prev_tick_count_ = system_time_high_res.tv_sec;
+  prev_api_tick_count_ = prev_tick_count_ = 0;
+  // Buffers of exiting threads are handed back by OnThreadExit().
+  pthread_key_create(&thread_buffer_key_, &TracePosix::OnThreadExit);
 }
 
 TracePosix::~TracePosix() {
   StopThread();
+  pthread_key_delete(thread_buffer_key_);
 }
 
 WebRtc_Word32 TracePosix::AddTime(char* trace_message,
-                                  const TraceLevel level) const {
-  struct timeval system_time_high_res;
-  if (gettimeofday(&system_time_high_res, 0) == -1) {
-    return -1;
-  }
+                                  const TraceLevel level,
+                                  const WebRtc_Word64 time_ms) const {
+  const time_t seconds = static_cast<time_t>(time_ms / 1000);
   struct tm buffer;
-  const struct tm* system_time =
-    localtime_r(&system_time_high_res.tv_sec, &buffer);
+  const struct tm* system_time = localtime_r(&seconds, &buffer);
 
-  const WebRtc_UWord32 ms_time = system_time_high_res.tv_usec / 1000;
+  const WebRtc_UWord32 ms_time = static_cast<WebRtc_UWord32>(time_ms % 1000);
+  const WebRtc_UWord32 tick_count = static_cast<WebRtc_UWord32>(time_ms);
   WebRtc_UWord32 prev_tickCount = 0;
   if (level == kTraceApiCall) {
     prev_tickCount = prev_tick_count_;
-    prev_tick_count_ = ms_time;
+    prev_tick_count_ = tick_count;
   } else {
     prev_tickCount = prev_api_tick_count_;
-    prev_api_tick_count_ = ms_time;
+    prev_api_tick_count_ = tick_count;
   }
-  WebRtc_UWord32 dw_delta_time = ms_time - prev_tickCount;
+  WebRtc_UWord32 dw_delta_time = tick_count - prev_tickCount;
   if (prev_tickCount == 0) {
     dw_delta_time = 0;
   }
   if (dw_delta_time > 0x0fffffff) {
-    // Either wraparound or data race.
+    // Wraparound, or records merged slightly out of order.
     dw_delta_time = 0;
   }
   if (dw_delta_time > 99999) {
@@ -108,4 +105,23 @@ WebRtc_Word32 TracePosix::AddDateTimeInfo(char* trace_message) const {
   return len + 1;
 }
 
+WebRtc_Word64 TracePosix::TimeMs() const {
+  struct timeval system_time_high_res;
+  gettimeofday(&system_time_high_res, 0);
+  return static_cast<WebRtc_Word64>(system_time_high_res.tv_sec) * 1000 +
+      system_time_high_res.tv_usec / 1000;
+}
+
+TraceImpl::ThreadBuffer* TracePosix::CurrentThreadBuffer() const {
+  return static_cast<ThreadBuffer*>(pthread_getspecific(thread_buffer_key_));
+}
+
+void TracePosix::SetCurrentThreadBuffer(ThreadBuffer* buffer) {
+  pthread_setspecific(thread_buffer_key_, buffer);
+}
+
+void TracePosix::OnThreadExit(void* buffer) {
+  ReleaseThreadBuffer(static_cast<ThreadBuffer*>(buffer));
+}
+
 }  // namespace webrtc
@@ -11,6 +11,8 @@
 #ifndef WEBRTC_SYSTEM_WRAPPERS_SOURCE_TRACE_POSIX_H_
 #define WEBRTC_SYSTEM_WRAPPERS_SOURCE_TRACE_POSIX_H_
 
+#include <pthread.h>
+
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/source/trace_impl.h"
 
@@ -22,14 +24,24 @@ class TracePosix : public TraceImpl {
   virtual ~TracePosix();
 
   virtual WebRtc_Word32 AddTime(char* trace_message,
-                                const TraceLevel level) const;
+                                const TraceLevel level,
+                                const WebRtc_Word64 time_ms) const;
 
   virtual WebRtc_Word32 AddBuildInfo(char* trace_message) const;
   virtual WebRtc_Word32 AddDateTimeInfo(char* trace_message) const;
 
+  virtual WebRtc_Word64 TimeMs() const;
+
+  virtual ThreadBuffer* CurrentThreadBuffer() const;
+  virtual void SetCurrentThreadBuffer(ThreadBuffer* buffer);
+
  private:
-  volatile mutable WebRtc_UWord32  prev_api_tick_count_;
-  volatile mutable WebRtc_UWord32  prev_tick_count_;
+  static void OnThreadExit(void* buffer);
+
+  // Only used by the writer thread.
+  mutable WebRtc_UWord32  prev_api_tick_count_;
+  mutable WebRtc_UWord32  prev_tick_count_;
+  pthread_key_t thread_buffer_key_;
 };
 
 }  // namespace webrtc
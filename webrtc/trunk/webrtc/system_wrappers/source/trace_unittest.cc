@@ -8,16 +8,272 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
 #include "gtest/gtest.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/system_wrappers/interface/trace.h"
 #include "webrtc/system_wrappers/source/cpu_measurement_harness.h"
 #include "webrtc/test/testsupport/fileutils.h"
+#include "webrtc/test/testsupport/perf_test.h"
 
 using webrtc::CpuMeasurementHarness;
+using webrtc::CriticalSectionScoped;
+using webrtc::CriticalSectionWrapper;
+using webrtc::ThreadWrapper;
+using webrtc::TickTime;
 using webrtc::Trace;
 using webrtc::kTraceWarning;
 using webrtc::kTraceUtility;
 
+// Length of the level, time, module and thread id that start each message.
+static const size_t kHeaderLength = 71;
+// Position of the module and id in the message.
+static const size_t kModuleOffset = 34;
+static const size_t kModuleLength = 25;
+// Id of the messages traced by the tests.
+static const int kTestId = 4711;
+// Longest message body, see TraceImpl::AddMessage().
+static const size_t kMaxBodyLength = 256 - kHeaderLength - 3;
+
+// Collects the warnings written by the trace thread.
+class MessageCollector : public webrtc::TraceCallback {
+ public:
+  MessageCollector()
+      : crit_sect_(CriticalSectionWrapper::CreateCriticalSection()) {
+    Trace::CreateTrace();
+    Trace::LevelFilter(old_filter_);
+    Trace::SetLevelFilter(kTraceWarning);
+    Trace::SetTraceCallback(this);
+  }
+  virtual ~MessageCollector() {
+    Trace::SetTraceCallback(NULL);
+    Trace::SetLevelFilter(old_filter_);
+    Trace::ReturnTrace();
+  }
+
+  virtual void Print(webrtc::TraceLevel level, const char* message,
+                     int length) {
+    CriticalSectionScoped lock(crit_sect_.get());
+    // Bodies of the messages traced by the test, without the header.
+    char module[kModuleLength + 1];
+    sprintf(module, "     UTILITY:%5d %5d;", 0, kTestId);
+    if (strlen(message) >= kHeaderLength &&
+        strncmp(message + kModuleOffset, module, kModuleLength) == 0) {
+      bodies_.push_back(message + kHeaderLength);
+    }
+  }
+
+  // Waits for |count| messages. Returns the bodies collected so far.
+  std::vector<std::string> WaitForMessages(size_t count) {
+    for (int i = 0; i < 100; ++i) {
+      {
+        CriticalSectionScoped lock(crit_sect_.get());
+        if (bodies_.size() >= count) {
+          break;
+        }
+      }
+      webrtc::SleepMs(10);
+    }
+    CriticalSectionScoped lock(crit_sect_.get());
+    std::vector<std::string> bodies;
+    bodies.swap(bodies_);
+    return bodies;
+  }
+
+ private:
+  webrtc::scoped_ptr<CriticalSectionWrapper> crit_sect_;
+  WebRtc_UWord32 old_filter_;
+  std::vector<std::string> bodies_;
+};
+
+// Formats a message body as the trace should.
+static std::string ExpectedBody(const char* format, ...) {
+  char body[kMaxBodyLength + 1];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(body, sizeof(body), format, args);
+  va_end(args);
+  return body;
+}
+
+TEST(TraceTest, FormatsMessages) {
+  MessageCollector collector;
+  const std::string long_string(300, 'x');
+  std::vector<std::string> expected;
+
+  WEBRTC_TRACE(kTraceWarning, kTraceUtility, kTestId,
+               "int %d, unsigned %u %08x", -5, 7u, 0xbeef);
+  expected.push_back(ExpectedBody("int %d, unsigned %u %08x", -5, 7u,
+                                  0xbeef));
+  WEBRTC_TRACE(kTraceWarning, kTraceUtility, kTestId,
+               "long %ld, long long %lld", -123456L, 1LL << 40);
+  expected.push_back(ExpectedBody("long %ld, long long %lld", -123456L,
+                                  1LL << 40));
+  WEBRTC_TRACE(kTraceWarning, kTraceUtility, kTestId, "double %.2f %5.1e",
+               3.14159, -2.5e10);
+  expected.push_back(ExpectedBody("double %.2f %5.1e", 3.14159, -2.5e10));
+  WEBRTC_TRACE(kTraceWarning, kTraceUtility, kTestId, "string %s|%-6s|%.3s",
+               "abc", "de", "fghij");
+  expected.push_back(ExpectedBody("string %s|%-6s|%.3s", "abc", "de",
+                                  "fghij"));
+  WEBRTC_TRACE(kTraceWarning, kTraceUtility, kTestId,
+               "pointer %p, char %c, 100%%", &collector, 'z');
+  expected.push_back(ExpectedBody("pointer %p, char %c, 100%%", &collector,
+                                  'z'));
+  // Formatted right away, since '*' widths aren't stored.
+  WEBRTC_TRACE(kTraceWarning, kTraceUtility, kTestId, "width %*d", 4, 2);
+  expected.push_back(ExpectedBody("width %*d", 4, 2));
+  WEBRTC_TRACE(kTraceWarning, kTraceUtility, kTestId, "long %s",
+               long_string.c_str());
+  expected.push_back(ExpectedBody("long %s", long_string.c_str()));
+
+  std::vector<std::string> bodies = collector.WaitForMessages(expected.size());
+  ASSERT_EQ(expected.size(), bodies.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i], bodies[i]);
+  }
+}
+
+// Messages traced while there is no trace file or callback are discarded,
+// instead of filling the buffer and being written once a callback is set.
+TEST(TraceTest, DiscardsMessagesWithoutSink) {
+  MessageCollector collector;
+  Trace::SetTraceCallback(NULL);
+  const int kNumBursts = 4;
+  const int kMessagesPerBurst = 50;
+  for (int i = 0; i < kNumBursts; ++i) {
+    for (int j = 0; j < kMessagesPerBurst; ++j) {
+      WEBRTC_TRACE(kTraceWarning, kTraceUtility, kTestId, "stale %d", j);
+    }
+    // Let the trace thread catch up.
+    webrtc::SleepMs(120);
+  }
+
+  Trace::SetTraceCallback(&collector);
+  WEBRTC_TRACE(kTraceWarning, kTraceUtility, kTestId, "fresh");
+  std::vector<std::string> bodies = collector.WaitForMessages(1);
+  ASSERT_EQ(1u, bodies.size());
+  EXPECT_EQ("fresh", bodies[0]);
+}
+
+// Traces |num_messages| messages, a few at a time so that the buffer never
+// fills up, and measures the time spent in WEBRTC_TRACE.
+class TracingThread {
+ public:
+  TracingThread(int index, int num_messages, int messages_per_burst)
+      : index_(index),
+        num_messages_(num_messages),
+        messages_per_burst_(messages_per_burst),
+        trace_time_us_(0),
+        thread_(ThreadWrapper::CreateThread(Run, this)) {
+  }
+
+  void Start() {
+    unsigned int id;
+    ASSERT_TRUE(thread_->Start(id));
+  }
+
+  void Stop() {
+    ASSERT_TRUE(thread_->Stop());
+  }
+
+  WebRtc_Word64 trace_time_us() const { return trace_time_us_; }
+
+ private:
+  static bool Run(void* obj) {
+    static_cast<TracingThread*>(obj)->TraceMessages();
+    return false;
+  }
+
+  void TraceMessages() {
+    for (int i = 0; i < num_messages_; ++i) {
+      if (i > 0 && i % messages_per_burst_ == 0) {
+        // Let the trace thread catch up.
+        webrtc::SleepMs(60);
+      }
+      const WebRtc_Word64 start_us = TickTime::MicrosecondTimestamp();
+      WEBRTC_TRACE(kTraceWarning, kTraceUtility, kTestId,
+                   "thread %d message %d", index_, i);
+      trace_time_us_ += TickTime::MicrosecondTimestamp() - start_us;
+    }
+  }
+
+  const int index_;
+  const int num_messages_;
+  const int messages_per_burst_;
+  WebRtc_Word64 trace_time_us_;
+  webrtc::scoped_ptr<ThreadWrapper> thread_;
+};
+
+TEST(TraceTest, KeepsMessageOrderOfEachThread) {
+  MessageCollector collector;
+  const int kNumThreads = 4;
+  const int kNumMessages = 100;
+  std::vector<TracingThread*> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(new TracingThread(i, kNumMessages, kNumMessages));
+    threads.back()->Start();
+  }
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads[i]->Stop();
+    delete threads[i];
+  }
+
+  std::vector<std::string> bodies =
+      collector.WaitForMessages(kNumThreads * kNumMessages);
+  ASSERT_EQ(static_cast<size_t>(kNumThreads * kNumMessages), bodies.size());
+  int next_message[kNumThreads] = {0};
+  for (size_t i = 0; i < bodies.size(); ++i) {
+    int thread = -1;
+    int message = -1;
+    ASSERT_EQ(2, sscanf(bodies[i].c_str(), "thread %d message %d", &thread,
+                        &message));
+    ASSERT_GE(thread, 0);
+    ASSERT_LT(thread, kNumThreads);
+    EXPECT_EQ(next_message[thread]++, message);
+  }
+}
+
+// Cost of WEBRTC_TRACE with a number of threads tracing at once.
+TEST(TraceTest, AddCostWithConcurrentThreads) {
+  MessageCollector collector;
+  const int kNumMessages = 500;
+  const int kMessagesPerBurst = 100;
+  for (int num_threads = 1; num_threads <= 8; num_threads *= 2) {
+    std::vector<TracingThread*> threads;
+    for (int i = 0; i < num_threads; ++i) {
+      threads.push_back(new TracingThread(i, kNumMessages,
+                                          kMessagesPerBurst));
+    }
+    for (int i = 0; i < num_threads; ++i) {
+      threads[i]->Start();
+    }
+    WebRtc_Word64 trace_time_us = 0;
+    for (int i = 0; i < num_threads; ++i) {
+      threads[i]->Stop();
+      trace_time_us += threads[i]->trace_time_us();
+      delete threads[i];
+    }
+    collector.WaitForMessages(num_threads * kNumMessages);
+
+    char modifier[32];
+    sprintf(modifier, "_%d_threads", num_threads);
+    webrtc::test::PrintResult(
+        "trace_add", modifier, "", 1000.0 * trace_time_us /
+        (num_threads * kNumMessages), "ns", false);
+  }
+}
+
 class Logger : public webrtc::CpuTarget {
  public:
   Logger() {
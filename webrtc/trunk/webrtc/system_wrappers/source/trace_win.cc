@@ -32,56 +32,55 @@
 namespace webrtc {
 TraceWindows::TraceWindows()
     : prev_api_tick_count_(0),
-      prev_tick_count_(0) {
+      prev_tick_count_(0),
+      // Buffers of exiting threads are handed back by OnThreadExit().
+      thread_buffer_index_(FlsAlloc(&TraceWindows::OnThreadExit)) {
 }
 
 TraceWindows::~TraceWindows() {
   StopThread();
+  // Calls OnThreadExit() for the threads still running; the buffers
+  // themselves are deleted by ~TraceImpl().
+  FlsFree(thread_buffer_index_);
 }
 
 WebRtc_Word32 TraceWindows::AddTime(char* trace_message,
-                                    const TraceLevel level) const {
-  WebRtc_UWord32 dw_current_time = timeGetTime();
+                                    const TraceLevel level,
+                                    const WebRtc_Word64 time_ms) const {
+  // |time_ms| is in FILETIME units of 100 ns divided by 10000.
+  ULARGE_INTEGER time;
+  time.QuadPart = static_cast<ULONGLONG>(time_ms) * 10000;
+  FILETIME file_time;
+  file_time.dwLowDateTime = time.LowPart;
+  file_time.dwHighDateTime = time.HighPart;
+  FILETIME local_file_time;
+  FileTimeToLocalFileTime(&file_time, &local_file_time);
   SYSTEMTIME system_time;
-  //GetSystemTime(&system_time);
-  GetLocalTime(&system_time);
+  FileTimeToSystemTime(&local_file_time, &system_time);
 
+  const WebRtc_UWord32 dw_current_time = static_cast<WebRtc_UWord32>(time_ms);
+  WebRtc_UWord32 prev_tick_count = 0;
   if (level == kTraceApiCall) {
-    WebRtc_UWord32 dw_delta_time = dw_current_time - prev_tick_count_;
+    prev_tick_count = prev_tick_count_;
     prev_tick_count_ = dw_current_time;
-
-    if (prev_tick_count_ == 0) {
-      dw_delta_time = 0;
-    }
-    if (dw_delta_time > 0x0fffffff) {
-      // Either wrap-around or data race.
-      dw_delta_time = 0;
-    }
-    if (dw_delta_time > 99999) {
-      dw_delta_time = 99999;
-    }
-
-    sprintf(trace_message, "(%2u:%2u:%2u:%3u |%5lu) ", system_time.wHour,
-            system_time.wMinute, system_time.wSecond,
-            system_time.wMilliseconds, dw_delta_time);
   } else {
-    WebRtc_UWord32 dw_delta_time = dw_current_time - prev_api_tick_count_;
+    prev_tick_count = prev_api_tick_count_;
     prev_api_tick_count_ = dw_current_time;
-
-    if (prev_api_tick_count_ == 0) {
-      dw_delta_time = 0;
-    }
-    if (dw_delta_time > 0x0fffffff) {
-      // Either wraparound or data race.
-      dw_delta_time = 0;
-    }
-    if (dw_delta_time > 99999) {
-      dw_delta_time = 99999;
-    }
-    sprintf(trace_message, "(%2u:%2u:%2u:%3u |%5lu) ", system_time.wHour,
-            system_time.wMinute, system_time.wSecond,
-            system_time.wMilliseconds, dw_delta_time);
   }
+  WebRtc_UWord32 dw_delta_time = dw_current_time - prev_tick_count;
+  if (prev_tick_count == 0) {
+    dw_delta_time = 0;
+  }
+  if (dw_delta_time > 0x0fffffff) {
+    // Wraparound, or records merged slightly out of order.
+    dw_delta_time = 0;
+  }
+  if (dw_delta_time > 99999) {
+    dw_delta_time = 99999;
+  }
+  sprintf(trace_message, "(%2u:%2u:%2u:%3u |%5lu) ", system_time.wHour,
+          system_time.wMinute, system_time.wSecond,
+          system_time.wMilliseconds, dw_delta_time);
   return 22;
 }
 
@@ -93,8 +92,8 @@ WebRtc_Word32 TraceWindows::AddBuildInfo(char* trace_message) const {
 }
 
 WebRtc_Word32 TraceWindows::AddDateTimeInfo(char* trace_message) const {
-  prev_api_tick_count_ = timeGetTime();
-  prev_tick_count_ = prev_api_tick_count_;
+  prev_api_tick_count_ = 0;
+  prev_tick_count_ = 0;
 
   SYSTEMTIME sys_time;
   GetLocalTime(&sys_time);
@@ -117,4 +116,23 @@ WebRtc_Word32 TraceWindows::AddDateTimeInfo(char* trace_message) const {
   return static_cast<WebRtc_Word32>(strlen(trace_message) + 1);
 }
 
-}  // namespace webrtc
+WebRtc_Word64 TraceWindows::TimeMs() const {
+  FILETIME file_time;
+  GetSystemTimeAsFileTime(&file_time);
+  ULARGE_INTEGER time;
+  time.LowPart = file_time.dwLowDateTime;
+  time.HighPart = file_time.dwHighDateTime;
+  return static_cast<WebRtc_Word64>(time.QuadPart / 10000);
+}
+
+TraceImpl::ThreadBuffer* TraceWindows::CurrentThreadBuffer() const {
+  return static_cast<ThreadBuffer*>(FlsGetValue(thread_buffer_index_));
+}
+
+void TraceWindows::SetCurrentThreadBuffer(ThreadBuffer* buffer) {
+  FlsSetValue(thread_buffer_index_, buffer);
+}
+
+void WINAPI TraceWindows::OnThreadExit(void* buffer) {
+  ReleaseThreadBuffer(static_cast<ThreadBuffer*>(buffer));
+}
@@ -24,13 +24,25 @@ class TraceWindows : public TraceImpl {
   virtual ~TraceWindows();
 
   virtual WebRtc_Word32 AddTime(char* trace_message,
-                                const TraceLevel level) const;
+                                const TraceLevel level,
+                                const WebRtc_Word64 time_ms) const;
 
   virtual WebRtc_Word32 AddBuildInfo(char* trace_message) const;
   virtual WebRtc_Word32 AddDateTimeInfo(char* trace_message) const;
+
+  virtual WebRtc_Word64 TimeMs() const;
+
+  virtual ThreadBuffer* CurrentThreadBuffer() const;
+  virtual void SetCurrentThreadBuffer(ThreadBuffer* buffer);
  private:
-  volatile mutable WebRtc_UWord32 prev_api_tick_count_;
-  volatile mutable WebRtc_UWord32 prev_tick_count_;
+  static void WINAPI OnThreadExit(void* buffer);
+
+  // Only used by the writer thread.
+  mutable WebRtc_UWord32 prev_api_tick_count_;
+  mutable WebRtc_UWord32 prev_tick_count_;
+  // Fiber local storage rather than TLS, as only FLS tells of exiting
+  // threads.
+  DWORD thread_buffer_index_;
 };
 
 }  // namespace webrtc
@@ -108,6 +108,15 @@ class  ViENetwork {
                                 const void* data,
                                 const int length) = 0;
 
+  // Passes a batch of received RTP packets, e.g. read with one recvmmsg()
+  // call, to VideoEngine. The packets are handled in order, with less
+  // locking per packet than ReceivedRTPPacket(). Returns the number of
+  // packets accepted, or -1 on error.
+  virtual int ReceivedRTPPackets(const int video_channel,
+                                 const void* const* data,
+                                 const int* lengths,
+                                 const int num_packets) = 0;
+
   // When using external transport for a channel, received RTCP packets should
   // be passed to VideoEngine using this function.
   virtual int ReceivedRTCPPacket(const int video_channel,
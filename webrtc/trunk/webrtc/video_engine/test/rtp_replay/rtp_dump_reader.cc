@@ -0,0 +1,194 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/video_engine/test/rtp_replay/rtp_dump_reader.h"
+
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace webrtc {
+
+// "#!rtpplay1.0 address/port\n", followed by the binary RD_hdr_t.
+const char kFirstLinePrefix[] = "#!rtpplay";
+const size_t kMaxFirstLineLength = 80;
+const size_t kFileHeaderSize = 16;
+// RD_packet_t: length including this header, RTP length or 0 for RTCP, and
+// offset in ms. All in network byte order.
+const size_t kPacketHeaderSize = 8;
+
+static uint16_t ReadBigEndian16(const uint8_t* data) {
+  return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+static uint32_t ReadBigEndian32(const uint8_t* data) {
+  return (static_cast<uint32_t>(data[0]) << 24) |
+         (static_cast<uint32_t>(data[1]) << 16) |
+         (static_cast<uint32_t>(data[2]) << 8) |
+         static_cast<uint32_t>(data[3]);
+}
+
+RtpDumpReader::RtpDumpReader()
+    : data_(NULL),
+      size_(0),
+      first_packet_(0),
+      position_(0) {
+#if defined(_WIN32)
+  file_ = INVALID_HANDLE_VALUE;
+  mapping_ = NULL;
+#endif
+}
+
+RtpDumpReader::~RtpDumpReader() {
+  Close();
+}
+
+bool RtpDumpReader::Open(const char* filename) {
+  Close();
+  if (!Map(filename)) {
+    return false;
+  }
+  const size_t prefix_length = sizeof(kFirstLinePrefix) - 1;
+  if (size_ < prefix_length ||
+      memcmp(data_, kFirstLinePrefix, prefix_length) != 0) {
+    Close();
+    return false;
+  }
+  const uint8_t* end_of_line = static_cast<const uint8_t*>(
+      memchr(data_, '\n', size_ < kMaxFirstLineLength ? size_ :
+                                                        kMaxFirstLineLength));
+  if (!end_of_line) {
+    Close();
+    return false;
+  }
+  first_packet_ = (end_of_line - data_) + 1 + kFileHeaderSize;
+  if (first_packet_ > size_) {
+    Close();
+    return false;
+  }
+  position_ = first_packet_;
+  return true;
+}
+
+void RtpDumpReader::Close() {
+  Unmap();
+  first_packet_ = 0;
+  position_ = 0;
+}
+
+bool RtpDumpReader::NextPacket(Packet* packet) {
+  if (size_ - position_ < kPacketHeaderSize) {
+    return false;
+  }
+  const uint8_t* header = data_ + position_;
+  const uint16_t length = ReadBigEndian16(header);
+  const uint16_t rtp_length = ReadBigEndian16(header + 2);
+  if (length < kPacketHeaderSize || size_ - position_ < length) {
+    return false;
+  }
+  packet->data = header + kPacketHeaderSize;
+  packet->length = length - static_cast<int>(kPacketHeaderSize);
+  packet->rtcp = rtp_length == 0;
+  packet->offset_ms = ReadBigEndian32(header + 4);
+  position_ += length;
+  return true;
+}
+
+void RtpDumpReader::Rewind() {
+  position_ = first_packet_;
+}
+
+#if defined(_WIN32)
+
+bool RtpDumpReader::Map(const char* filename) {
+  file_ = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                      OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (file_ == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) {
+    Unmap();
+    return false;
+  }
+  mapping_ = CreateFileMapping(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!mapping_) {
+    Unmap();
+    return false;
+  }
+  data_ = static_cast<const uint8_t*>(
+      MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+  if (!data_) {
+    Unmap();
+    return false;
+  }
+  size_ = static_cast<size_t>(size.QuadPart);
+  return true;
+}
+
+void RtpDumpReader::Unmap() {
+  if (data_) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_) {
+    CloseHandle(mapping_);
+  }
+  if (file_ != INVALID_HANDLE_VALUE) {
+    CloseHandle(file_);
+  }
+  data_ = NULL;
+  size_ = 0;
+  mapping_ = NULL;
+  file_ = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool RtpDumpReader::Map(const char* filename) {
+  const int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+    close(fd);
+    return false;
+  }
+  void* data = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps the file open.
+  close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  // The packets are read once, front to back.
+  madvise(data, file_stat.st_size, MADV_SEQUENTIAL);
+  data_ = static_cast<const uint8_t*>(data);
+  size_ = static_cast<size_t>(file_stat.st_size);
+  return true;
+}
+
+void RtpDumpReader::Unmap() {
+  if (data_) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+  }
+  data_ = NULL;
+  size_ = 0;
+}
+
+#endif  // defined(_WIN32)
+
+}  // namespace webrtc
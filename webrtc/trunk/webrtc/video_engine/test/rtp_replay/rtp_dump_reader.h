@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_VIDEO_ENGINE_TEST_RTP_REPLAY_RTP_DUMP_READER_H_
+#define WEBRTC_VIDEO_ENGINE_TEST_RTP_REPLAY_RTP_DUMP_READER_H_
+
+#include <stddef.h>
+
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// Reads the packets of an rtpdump file, as written by RtpDump. The file is
+// memory mapped and packets are returned without copying, so that reading
+// doesn't show up in the measurements of a replay.
+class RtpDumpReader {
+ public:
+  struct Packet {
+    // Points into the mapped file, valid until the reader is closed.
+    const uint8_t* data;
+    int length;
+    bool rtcp;
+    // Time since the start of the recording.
+    uint32_t offset_ms;
+  };
+
+  RtpDumpReader();
+  ~RtpDumpReader();
+
+  // Maps |filename| and reads its file header. Returns false if the file
+  // can't be read or isn't an rtpdump file.
+  bool Open(const char* filename);
+  void Close();
+
+  // Reads the next packet into |packet|. Returns false at the end of the file
+  // or if the next packet is truncated.
+  bool NextPacket(Packet* packet);
+
+  // Starts over from the first packet.
+  void Rewind();
+
+ private:
+  bool Map(const char* filename);
+  void Unmap();
+
+  const uint8_t* data_;
+  size_t size_;
+  // Offset of the first packet.
+  size_t first_packet_;
+  size_t position_;
+#if defined(_WIN32)
+  void* file_;
+  void* mapping_;
+#endif
+
+  DISALLOW_COPY_AND_ASSIGN(RtpDumpReader);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_VIDEO_ENGINE_TEST_RTP_REPLAY_RTP_DUMP_READER_H_
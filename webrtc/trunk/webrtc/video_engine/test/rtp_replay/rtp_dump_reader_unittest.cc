@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/video_engine/test/rtp_replay/rtp_dump_reader.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "webrtc/modules/utility/interface/rtp_dump.h"
+#include "webrtc/test/testsupport/fileutils.h"
+
+namespace webrtc {
+namespace {
+
+const uint8_t kRtpPacket[] = {
+  0x80, 0x64, 0x00, 0x01, 0x00, 0x00, 0x0b, 0xb8,
+  0x12, 0x34, 0x56, 0x78, 0xaa, 0xbb, 0xcc };
+// Receiver report without report blocks.
+const uint8_t kRtcpPacket[] = {
+  0x80, 0xc9, 0x00, 0x01, 0x12, 0x34, 0x56, 0x78 };
+
+class RtpDumpReaderTest : public ::testing::Test {
+ protected:
+  RtpDumpReaderTest()
+      : filename_(test::OutputPath() + "rtp_dump_reader_unittest.rtp") {}
+
+  virtual void TearDown() {
+    remove(filename_.c_str());
+  }
+
+  const std::string filename_;
+  RtpDumpReader reader_;
+};
+
+TEST_F(RtpDumpReaderTest, ReadsPacketsWrittenByRtpDump) {
+  RtpDump* dump = RtpDump::CreateRtpDump();
+  ASSERT_EQ(0, dump->Start(filename_.c_str()));
+  EXPECT_EQ(0, dump->DumpPacket(kRtpPacket, sizeof(kRtpPacket)));
+  EXPECT_EQ(0, dump->DumpPacket(kRtcpPacket, sizeof(kRtcpPacket)));
+  EXPECT_EQ(0, dump->Stop());
+  RtpDump::DestroyRtpDump(dump);
+
+  ASSERT_TRUE(reader_.Open(filename_.c_str()));
+  for (int pass = 0; pass < 2; ++pass) {
+    RtpDumpReader::Packet packet;
+    ASSERT_TRUE(reader_.NextPacket(&packet));
+    EXPECT_FALSE(packet.rtcp);
+    ASSERT_EQ(static_cast<int>(sizeof(kRtpPacket)), packet.length);
+    EXPECT_EQ(0, memcmp(kRtpPacket, packet.data, sizeof(kRtpPacket)));
+    const uint32_t first_offset_ms = packet.offset_ms;
+
+    ASSERT_TRUE(reader_.NextPacket(&packet));
+    EXPECT_TRUE(packet.rtcp);
+    ASSERT_EQ(static_cast<int>(sizeof(kRtcpPacket)), packet.length);
+    EXPECT_EQ(0, memcmp(kRtcpPacket, packet.data, sizeof(kRtcpPacket)));
+    EXPECT_GE(packet.offset_ms, first_offset_ms);
+
+    EXPECT_FALSE(reader_.NextPacket(&packet));
+    reader_.Rewind();
+  }
+}
+
+TEST_F(RtpDumpReaderTest, StopsAtTruncatedPacket) {
+  FILE* file = fopen(filename_.c_str(), "wb");
+  ASSERT_TRUE(file != NULL);
+  const char kFirstLine[] = "#!rtpplay1.0 127.0.0.1/5004\n";
+  const uint8_t kFileHeader[16] = { 0 };
+  // Claims 8 more bytes than are in the file.
+  const uint8_t kPacketHeader[] = {
+    0x00, sizeof(kRtpPacket) + 16, 0x00, sizeof(kRtpPacket),
+    0x00, 0x00, 0x00, 0x0a };
+  fwrite(kFirstLine, 1, strlen(kFirstLine), file);
+  fwrite(kFileHeader, 1, sizeof(kFileHeader), file);
+  fwrite(kPacketHeader, 1, sizeof(kPacketHeader), file);
+  fwrite(kRtpPacket, 1, sizeof(kRtpPacket), file);
+  fclose(file);
+
+  ASSERT_TRUE(reader_.Open(filename_.c_str()));
+  RtpDumpReader::Packet packet;
+  EXPECT_FALSE(reader_.NextPacket(&packet));
+}
+
+TEST_F(RtpDumpReaderTest, RejectsOtherFiles) {
+  EXPECT_FALSE(reader_.Open(filename_.c_str()));
+
+  FILE* file = fopen(filename_.c_str(), "wb");
+  ASSERT_TRUE(file != NULL);
+  fwrite(kRtpPacket, 1, sizeof(kRtpPacket), file);
+  fclose(file);
+  EXPECT_FALSE(reader_.Open(filename_.c_str()));
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,431 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Replays an rtpdump through the receive side of a video channel,
+// ViEReceiver -> RtpRtcp -> VCM -> decoder, driven by a simulated clock, and
+// reports where the time goes. Used as a benchmark for the receive path.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+#include "google/gflags.h"
+#include "webrtc/common_types.h"
+#include "webrtc/modules/remote_bitrate_estimator/include/remote_bitrate_estimator.h"
+#include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp.h"
+#include "webrtc/modules/video_coding/main/interface/video_coding.h"
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/test/testsupport/perf_test.h"
+#include "webrtc/video_engine/test/rtp_replay/rtp_dump_reader.h"
+#include "webrtc/video_engine/vie_receiver.h"
+
+DEFINE_string(codec, "VP8", "Name of the video codec in the dump.");
+DEFINE_int32(payload_type, -1,
+             "RTP payload type of the video codec. -1 uses the default of "
+             "the codec.");
+DEFINE_int32(red_payload_type, -1, "RTP payload type for RED, -1 if unused.");
+DEFINE_int32(fec_payload_type, -1,
+             "RTP payload type for ULPFEC, -1 if unused.");
+DEFINE_double(speed, 0,
+              "Replay speed relative to the recording, e.g. 4 for four times "
+              "real time. 0 replays as fast as possible.");
+DEFINE_int32(render_delay_ms, 10, "Render delay of the receiver.");
+DEFINE_int32(loops, 1,
+             "Number of times to replay the dump, each time as a new "
+             "stream.");
+
+namespace webrtc {
+namespace {
+
+// Time to keep decoding after the last packet, for the last frames to become
+// due.
+const int kDrainTimeMs = 1000;
+
+int64_t ProcessCpuTimeUs() {
+#if defined(_WIN32)
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time,
+                       &kernel_time, &user_time)) {
+    return 0;
+  }
+  // In units of 100 ns.
+  ULARGE_INTEGER kernel, user;
+  kernel.LowPart = kernel_time.dwLowDateTime;
+  kernel.HighPart = kernel_time.dwHighDateTime;
+  user.LowPart = user_time.dwLowDateTime;
+  user.HighPart = user_time.dwHighDateTime;
+  return static_cast<int64_t>((kernel.QuadPart + user.QuadPart) / 10);
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL +
+         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#endif
+}
+
+// Accumulates the wall clock time spent in one stage of the receive path.
+class StageTimer {
+ public:
+  StageTimer() : calls_(0), total_us_(0), max_us_(0), start_us_(0) {}
+
+  void Start() { start_us_ = TickTime::MicrosecondTimestamp(); }
+  void Stop() {
+    const int64_t elapsed_us = TickTime::MicrosecondTimestamp() - start_us_;
+    ++calls_;
+    total_us_ += elapsed_us;
+    max_us_ = std::max(max_us_, elapsed_us);
+  }
+
+  int calls() const { return calls_; }
+  int64_t total_us() const { return total_us_; }
+  double mean_us() const {
+    return calls_ > 0 ? static_cast<double>(total_us_) / calls_ : 0;
+  }
+  int64_t max_us() const { return max_us_; }
+
+ private:
+  int calls_;
+  int64_t total_us_;
+  int64_t max_us_;
+  int64_t start_us_;
+};
+
+// Counts the decoded frames, and the simulated time from the first packet of
+// a frame arriving until the frame is decoded.
+class FrameCounter : public VCMReceiveCallback {
+ public:
+  explicit FrameCounter(Clock* clock)
+      : clock_(clock),
+        num_frames_(0),
+        total_latency_ms_(0),
+        max_latency_ms_(0) {}
+
+  // Forgets the packets of the previous stream, whose timestamps a new
+  // stream may reuse.
+  void StartStream() { arrival_times_ms_.clear(); }
+
+  void PacketArrived(uint32_t timestamp) {
+    // Only the first packet of a frame is stored.
+    arrival_times_ms_.insert(std::make_pair(timestamp,
+                                            clock_->TimeInMilliseconds()));
+  }
+
+  virtual WebRtc_Word32 FrameToRender(I420VideoFrame& video_frame) {
+    ++num_frames_;
+    std::map<uint32_t, int64_t>::iterator it =
+        arrival_times_ms_.find(video_frame.timestamp());
+    if (it != arrival_times_ms_.end()) {
+      const int64_t latency_ms = clock_->TimeInMilliseconds() - it->second;
+      total_latency_ms_ += latency_ms;
+      max_latency_ms_ = std::max(max_latency_ms_, latency_ms);
+      // Older frames were either decoded or dropped.
+      arrival_times_ms_.erase(arrival_times_ms_.begin(), ++it);
+    }
+    return 0;
+  }
+
+  int num_frames() const { return num_frames_; }
+  double mean_latency_ms() const {
+    return num_frames_ > 0 ?
+        static_cast<double>(total_latency_ms_) / num_frames_ : 0;
+  }
+  int64_t max_latency_ms() const { return max_latency_ms_; }
+
+ private:
+  Clock* clock_;
+  std::map<uint32_t, int64_t> arrival_times_ms_;
+  int num_frames_;
+  int64_t total_latency_ms_;
+  int64_t max_latency_ms_;
+};
+
+// RTCP reports are generated as in a real call, but not sent anywhere.
+class NullTransport : public Transport {
+ public:
+  virtual int SendPacket(int channel, const void* data, int len) {
+    return len;
+  }
+  virtual int SendRTCPPacket(int channel, const void* data, int len) {
+    return len;
+  }
+};
+
+class NullBitrateObserver : public RemoteBitrateObserver {
+ public:
+  virtual void OnReceiveBitrateChanged(std::vector<unsigned int>* ssrcs,
+                                       unsigned int bitrate) {}
+};
+
+bool FindCodec(const std::string& name, VideoCodec* codec) {
+  for (int i = 0; i < VideoCodingModule::NumberOfCodecs(); ++i) {
+    if (VideoCodingModule::Codec(static_cast<WebRtc_UWord8>(i), codec) == 0 &&
+        name == codec->plName) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RegisterPayload(RtpRtcp* rtp_rtcp, const char* name, int payload_type) {
+  VideoCodec codec;
+  memset(&codec, 0, sizeof(codec));
+  strncpy(codec.plName, name, sizeof(codec.plName) - 1);
+  codec.plType = static_cast<unsigned char>(payload_type);
+  return rtp_rtcp->RegisterReceivePayload(codec) == 0;
+}
+
+// The receive side of a video channel.
+class ReceiveChain {
+ public:
+  explicit ReceiveChain(Clock* clock)
+      : remote_bitrate_estimator_(RemoteBitrateEstimator::Create(
+            OverUseDetectorOptions(),
+            RemoteBitrateEstimator::kSingleStreamEstimation,
+            &bitrate_observer_, clock)),
+        vcm_(VideoCodingModule::Create(0, clock)),
+        receiver_(0, vcm_.get(), remote_bitrate_estimator_.get()) {
+    RtpRtcp::Configuration configuration;
+    configuration.id = 0;
+    configuration.audio = false;
+    configuration.clock = clock;
+    configuration.incoming_data = &receiver_;
+    configuration.outgoing_transport = &transport_;
+    configuration.remote_bitrate_estimator = remote_bitrate_estimator_.get();
+    rtp_rtcp_.reset(RtpRtcp::CreateRtpRtcp(configuration));
+    receiver_.SetRtpRtcpModule(rtp_rtcp_.get());
+  }
+
+  bool Init(const VideoCodec& codec, VCMReceiveCallback* callback) {
+    if (rtp_rtcp_->SetRTCPStatus(kRtcpCompound) != 0 ||
+        rtp_rtcp_->RegisterReceivePayload(codec) != 0 ||
+        (FLAGS_red_payload_type >= 0 &&
+         !RegisterPayload(rtp_rtcp_.get(), "RED", FLAGS_red_payload_type)) ||
+        (FLAGS_fec_payload_type >= 0 &&
+         !RegisterPayload(rtp_rtcp_.get(), "ULPFEC",
+                          FLAGS_fec_payload_type)) ||
+        vcm_->InitializeReceiver() != 0 ||
+        vcm_->RegisterReceiveCodec(&codec, 1) != 0 ||
+        vcm_->RegisterReceiveCallback(callback) != 0 ||
+        vcm_->SetRenderDelay(FLAGS_render_delay_ms) != 0) {
+      return false;
+    }
+    receiver_.StartReceive();
+    return true;
+  }
+
+  ~ReceiveChain() { receiver_.StopReceive(); }
+
+  RemoteBitrateEstimator* remote_bitrate_estimator() {
+    return remote_bitrate_estimator_.get();
+  }
+  VideoCodingModule* vcm() { return vcm_.get(); }
+  ViEReceiver* receiver() { return &receiver_; }
+  RtpRtcp* rtp_rtcp() { return rtp_rtcp_.get(); }
+
+ private:
+  NullBitrateObserver bitrate_observer_;
+  scoped_ptr<RemoteBitrateEstimator> remote_bitrate_estimator_;
+  scoped_ptr<VideoCodingModule> vcm_;
+  ViEReceiver receiver_;
+  NullTransport transport_;
+  scoped_ptr<RtpRtcp> rtp_rtcp_;
+};
+
+void PrintResult(const char* measurement, const char* modifier,
+                 double value, const char* units) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.3f", value);
+  webrtc::test::PrintResult(measurement, modifier, "rtp_replay", buffer, units,
+                            false);
+}
+
+int Replay(const char* filename) {
+  RtpDumpReader reader;
+  if (!reader.Open(filename)) {
+    fprintf(stderr, "Can't read rtpdump %s\n", filename);
+    return -1;
+  }
+  VideoCodec codec;
+  if (!FindCodec(FLAGS_codec, &codec)) {
+    fprintf(stderr, "Unsupported codec %s\n", FLAGS_codec.c_str());
+    return -1;
+  }
+  if (FLAGS_payload_type >= 0) {
+    codec.plType = static_cast<unsigned char>(FLAGS_payload_type);
+  }
+
+  SimulatedClock clock(0);
+  FrameCounter frame_counter(&clock);
+  StageTimer receive_timer;
+  StageTimer rtcp_timer;
+  StageTimer decode_timer;
+  StageTimer process_timer;
+  int num_video_packets = 0;
+  // Audio, and anything else not registered, isn't decoded by this chain.
+  int num_other_packets = 0;
+  int64_t media_time_ms = 0;
+
+  const int64_t start_cpu_us = ProcessCpuTimeUs();
+  const int64_t start_us = TickTime::MicrosecondTimestamp();
+  for (int loop = 0; loop < FLAGS_loops; ++loop) {
+    // Every loop replays the same SSRC, sequence numbers and timestamps, which
+    // a receiver that has seen them treats as old packets. So each loop gets
+    // a new receive chain, set up outside of the measured stages.
+    ReceiveChain chain(&clock);
+    if (!chain.Init(codec, &frame_counter)) {
+      fprintf(stderr, "Failed to set up the receiver\n");
+      return -1;
+    }
+    ViEReceiver* receiver = chain.receiver();
+    VideoCodingModule* vcm = chain.vcm();
+    RtpRtcp* rtp_rtcp = chain.rtp_rtcp();
+    RemoteBitrateEstimator* remote_bitrate_estimator =
+        chain.remote_bitrate_estimator();
+    frame_counter.StartStream();
+
+    reader.Rewind();
+    RtpDumpReader::Packet packet;
+    bool have_packet = reader.NextPacket(&packet);
+    const uint32_t first_offset_ms = have_packet ? packet.offset_ms : 0;
+    const int64_t loop_start_ms = clock.TimeInMilliseconds();
+    int64_t drain_end_ms = -1;
+    while (drain_end_ms < 0 || clock.TimeInMilliseconds() < drain_end_ms) {
+      const int64_t now_ms = clock.TimeInMilliseconds() - loop_start_ms;
+      while (have_packet && packet.offset_ms - first_offset_ms <= now_ms) {
+        if (FLAGS_speed > 0) {
+          const int64_t due_us = start_us + static_cast<int64_t>(
+              (media_time_ms + now_ms) * 1000 / FLAGS_speed);
+          const int64_t wait_us = due_us - TickTime::MicrosecondTimestamp();
+          if (wait_us >= 1000) {
+            SleepMs(static_cast<int>(wait_us / 1000));
+          }
+        }
+        if (packet.rtcp) {
+          rtcp_timer.Start();
+          receiver->ReceivedRTCPPacket(packet.data, packet.length);
+          rtcp_timer.Stop();
+        } else if (packet.length >= 12) {
+          const int payload_type = packet.data[1] & 0x7f;
+          if (payload_type == codec.plType ||
+              payload_type == FLAGS_red_payload_type ||
+              payload_type == FLAGS_fec_payload_type) {
+            ++num_video_packets;
+            frame_counter.PacketArrived(
+                (packet.data[4] << 24) | (packet.data[5] << 16) |
+                (packet.data[6] << 8) | packet.data[7]);
+            receive_timer.Start();
+            receiver->ReceivedRTPPacket(packet.data, packet.length);
+            receive_timer.Stop();
+          } else {
+            ++num_other_packets;
+          }
+        }
+        have_packet = reader.NextPacket(&packet);
+        if (!have_packet) {
+          drain_end_ms = clock.TimeInMilliseconds() + kDrainTimeMs;
+        }
+      }
+      if (!have_packet && drain_end_ms < 0) {
+        // Empty dump.
+        break;
+      }
+
+      // Decode all frames that are due.
+      while (true) {
+        decode_timer.Start();
+        const WebRtc_Word32 ret = vcm->Decode(0);
+        if (ret == VCM_FRAME_NOT_READY) {
+          break;
+        }
+        decode_timer.Stop();
+        if (ret != VCM_OK) {
+          break;
+        }
+      }
+
+      process_timer.Start();
+      bool processed = false;
+      if (vcm->TimeUntilNextProcess() <= 0) {
+        vcm->Process();
+        processed = true;
+      }
+      if (rtp_rtcp->TimeUntilNextProcess() <= 0) {
+        rtp_rtcp->Process();
+        processed = true;
+      }
+      if (remote_bitrate_estimator->TimeUntilNextProcess() <= 0) {
+        remote_bitrate_estimator->Process();
+        processed = true;
+      }
+      if (processed) {
+        process_timer.Stop();
+      }
+      clock.AdvanceTimeMilliseconds(1);
+    }
+    media_time_ms += clock.TimeInMilliseconds() - loop_start_ms;
+  }
+  const int64_t elapsed_us = TickTime::MicrosecondTimestamp() - start_us;
+  const int64_t cpu_us = ProcessCpuTimeUs() - start_cpu_us;
+
+  printf("Replayed %d video packets, %d RTCP packets and ignored %d other "
+         "packets, %d frames decoded in %.1f s of media.\n",
+         num_video_packets, rtcp_timer.calls(), num_other_packets,
+         frame_counter.num_frames(), media_time_ms / 1000.0);
+  PrintResult("receive_time", "_mean", receive_timer.mean_us(), "us");
+  PrintResult("receive_time", "_max", receive_timer.max_us(), "us");
+  PrintResult("rtcp_time", "_mean", rtcp_timer.mean_us(), "us");
+  PrintResult("decode_time", "_mean", decode_timer.mean_us(), "us");
+  PrintResult("decode_time", "_max", decode_timer.max_us(), "us");
+  PrintResult("process_time", "_mean", process_timer.mean_us(), "us");
+  PrintResult("frame_latency", "_mean", frame_counter.mean_latency_ms(),
+              "ms");
+  PrintResult("frame_latency", "_max", frame_counter.max_latency_ms(), "ms");
+  PrintResult("cpu_time", "", cpu_us / 1000.0, "ms");
+  PrintResult("wall_time", "", elapsed_us / 1000.0, "ms");
+  PrintResult("decoded_fps", "",
+              elapsed_us > 0 ? frame_counter.num_frames() * 1e6 / elapsed_us :
+                               0, "fps");
+  PrintResult("speedup", "",
+              elapsed_us > 0 ? media_time_ms * 1000.0 / elapsed_us : 0, "x");
+  return 0;
+}
+
+}  // namespace
+}  // namespace webrtc
+
+int main(int argc, char* argv[]) {
+  std::string program_name = argv[0];
+  std::string usage = "Replays the video of an rtpdump through the receive "
+      "side of a video channel and reports the time spent in each stage.\n"
+      "Run " + program_name + " --helpshort for usage.\n"
+      "Example usage:\n" + program_name + " --speed=0 input.rtp\n";
+  google::SetUsageMessage(usage);
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  if (argc != 2) {
+    printf("%s", google::ProgramUsage());
+    return 0;
+  }
+  return webrtc::Replay(argv[1]) == 0 ? 0 : 1;
+}
@@ -493,12 +493,15 @@ WebRtc_Word32 ViECapturer::EnableDenoising(bool enable)
     if (IncImageProcRefCount() != 0) {
       return -1;
     }
+    // The content metrics for the encoders are computed in the same pass.
+    image_proc_module_->EnableContentAnalysis(true);
   } else {
     if (denoising_enabled_ == false) {
       // Already disabled, nothing need to be done.
       return 0;
     }
     denoising_enabled_ = false;
+    image_proc_module_->EnableContentAnalysis(false);
     DecImageProcRefCount();
   }
 
@@ -626,6 +629,10 @@ void ViECapturer::DeliverI420Frame(I420VideoFrame* video_frame) {
  
   if (denoising_enabled_) {
     image_proc_module_->Denoising(video_frame);
+    const VideoContentMetrics* metrics = image_proc_module_->ContentMetrics();
+    if (metrics) {
+      DeliverContentMetrics(*metrics);
+    }
   }
   if (brightness_frame_stats_) {
     if (image_proc_module_->GetFrameStats(brightness_frame_stats_,
@@ -29,6 +29,7 @@
 #include "video_engine/include/vie_errors.h"
 #include "video_engine/include/vie_image_process.h"
 #include "video_engine/include/vie_rtp_rtcp.h"
+#include "video_engine/vie_decode_scheduler.h"
 #include "video_engine/vie_defines.h"
 
 namespace webrtc {
@@ -54,6 +55,38 @@ class ChannelStatsObserver : public StatsObserver {
  private:
   ViEChannel* owner_;
 };
+
+// Helper class decoding a channel on the shared decode threads, when the
+// jitter buffer signals a complete frame.
+class ChannelDecoder : public ViEDecodeScheduler::Decoder,
+                       public VCMFrameReadyCallback {
+ public:
+  explicit ChannelDecoder(VideoCodingModule* vcm)
+      : vcm_(vcm),
+        scheduler_(ViEDecodeScheduler::GetScheduler()) {
+    scheduler_->AddDecoder(this, kMaxDecodeWaitTimeMs);
+    vcm_->RegisterFrameReadyCallback(this);
+  }
+  virtual ~ChannelDecoder() {
+    vcm_->RegisterFrameReadyCallback(NULL);
+    scheduler_->RemoveDecoder(this);
+    ViEDecodeScheduler::ReturnScheduler();
+  }
+
+  // Implements ViEDecodeScheduler::Decoder.
+  virtual bool DecodeNext() {
+    return vcm_->Decode(0) == VCM_OK;
+  }
+
+  // Implements VCMFrameReadyCallback.
+  virtual void FrameReady(int64_t render_time_ms) {
+    scheduler_->FrameReady(this, render_time_ms);
+  }
+
+ private:
+  VideoCodingModule* vcm_;
+  ViEDecodeScheduler* scheduler_;
+};
 int ViEChannel::RegisterDecodedDataCallback(DecodedDataCallback callback)
 {
 	if(callback!=0)
@@ -116,6 +149,7 @@ ViEChannel::ViEChannel(WebRtc_Word32 channel_id,
       decoder_reset_(true),
       wait_for_key_frame_(false),
       decode_thread_(NULL),
+      decoder_(),
       external_encryption_(NULL),
       effect_filter_(NULL),
       color_enhancement_(false),
@@ -242,7 +276,7 @@ ViEChannel::~ViEChannel() {
     delete rtp_rtcp;
     simulcast_rtp_rtcp_.erase(it);
   }
-  if (decode_thread_) {
+  if (decode_thread_ || decoder_.get()) {
     StopDecodeThread();
   }
   // Release modules.
@@ -1768,6 +1802,19 @@ WebRtc_Word32 ViEChannel::ReceivedRTPPacket(
   return vie_receiver_.ReceivedRTPPacket(rtp_packet, rtp_packet_length);
 }
 
+WebRtc_Word32 ViEChannel::ReceivedRTPPackets(const void* const* rtp_packets,
+                                             const int* rtp_packet_lengths,
+                                             const int num_packets) {
+  {
+    CriticalSectionScoped cs(callback_cs_.get());
+    if (!external_transport_) {
+      return -1;
+    }
+  }
+  return vie_receiver_.ReceivedRTPPackets(rtp_packets, rtp_packet_lengths,
+                                          num_packets);
+}
+
 WebRtc_Word32 ViEChannel::ReceivedRTCPPacket(
   const void* rtcp_packet, const WebRtc_Word32 rtcp_packet_length) {
   {
@@ -2284,6 +2331,14 @@ void ViEChannel::OnRttUpdate(uint32_t rtt) {
 }
 
 WebRtc_Word32 ViEChannel::StartDecodeThread() {
+#ifdef WEBRTC_VIE_SHARED_DECODE_POOL
+  if (!decoder_.get()) {
+    decoder_.reset(new ChannelDecoder(&vcm_));
+    WEBRTC_TRACE(kTraceInfo, kTraceVideo, ViEId(engine_id_, channel_id_),
+                 "%s: decoding on the shared decode threads", __FUNCTION__);
+  }
+  return 0;
+#endif
   // Start the decode thread
   if (decode_thread_) {
     // Already started.
@@ -2313,6 +2368,11 @@ WebRtc_Word32 ViEChannel::StartDecodeThread() {
 }
 
 WebRtc_Word32 ViEChannel::StopDecodeThread() {
+  if (decoder_.get()) {
+    // Returns once the channel is no longer being decoded.
+    decoder_.reset();
+    return 0;
+  }
   if (!decode_thread_) {
     WEBRTC_TRACE(kTraceWarning, kTraceVideo, ViEId(engine_id_, channel_id_),
                  "%s: decode thread not running", __FUNCTION__);
@@ -31,6 +31,7 @@
 
 namespace webrtc {
 
+class ChannelDecoder;
 class ChannelStatsObserver;
 class CriticalSectionWrapper;
 class Encryption;
@@ -258,6 +259,12 @@ class ViEChannel
   WebRtc_Word32 ReceivedRTPPacket(const void* rtp_packet,
                                   const WebRtc_Word32 rtp_packet_length);
 
+  // Incoming batch of packets from external transport. Returns the number of
+  // packets accepted, or -1 on error.
+  WebRtc_Word32 ReceivedRTPPackets(const void* const* rtp_packets,
+                                   const int* rtp_packet_lengths,
+                                   const int num_packets);
+
   // Incoming packet from external transport.
   WebRtc_Word32 ReceivedRTCPPacket(const void* rtcp_packet,
                                    const WebRtc_Word32 rtcp_packet_length);
@@ -427,6 +434,9 @@ class ViEChannel
   bool decoder_reset_;
   bool wait_for_key_frame_;
   ThreadWrapper* decode_thread_;
+  // Decodes on the shared decode threads instead of |decode_thread_|, when
+  // built with WEBRTC_VIE_SHARED_DECODE_POOL.
+  scoped_ptr<ChannelDecoder> decoder_;
 
   Encryption* external_encryption_;
 
@@ -0,0 +1,218 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/video_engine/vie_decode_scheduler.h"
+
+#include <cassert>
+
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/condition_variable_wrapper.h"
+#include "webrtc/system_wrappers/interface/cpu_info.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/trace.h"
+
+namespace webrtc {
+
+// Longest time a worker sleeps when no channel is to be polled.
+const int kMaxWorkerWaitTimeMs = 100;
+
+ViEDecodeScheduler* ViEDecodeScheduler::StaticInstance(
+    CountOperation count_operation) {
+  return GetStaticInstance<ViEDecodeScheduler>(count_operation);
+}
+
+ViEDecodeScheduler* ViEDecodeScheduler::GetScheduler() {
+  return StaticInstance(kAddRef);
+}
+
+void ViEDecodeScheduler::ReturnScheduler() {
+  StaticInstance(kRelease);
+}
+
+ViEDecodeScheduler* ViEDecodeScheduler::CreateInstance() {
+  return new ViEDecodeScheduler(
+      static_cast<int>(CpuInfo::DetectNumberOfCores()),
+      Clock::GetRealTimeClock());
+}
+
+ViEDecodeScheduler::ViEDecodeScheduler(int num_threads, Clock* clock)
+    : clock_(clock),
+      crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      work_cond_(ConditionVariableWrapper::CreateConditionVariable()),
+      idle_cond_(ConditionVariableWrapper::CreateConditionVariable()),
+      threads_(),
+      channels_(),
+      stopped_(false) {
+  assert(num_threads > 0);
+  for (int i = 0; i < num_threads; ++i) {
+    ThreadWrapper* thread = ThreadWrapper::CreateThread(
+        WorkerThreadFun, this, kHighestPriority, "DecodingThread");
+    unsigned int thread_id = 0;
+    if (!thread || !thread->Start(thread_id)) {
+      WEBRTC_TRACE(kTraceError, kTraceVideo, -1,
+                   "%s: could not start decode thread", __FUNCTION__);
+      delete thread;
+      continue;
+    }
+    threads_.push_back(thread);
+  }
+}
+
+ViEDecodeScheduler::~ViEDecodeScheduler() {
+  assert(channels_.empty());
+  {
+    CriticalSectionScoped cs(crit_.get());
+    stopped_ = true;
+  }
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i]->SetNotAlive();
+  }
+  work_cond_->WakeAll();
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    if (threads_[i]->Stop()) {
+      delete threads_[i];
+    } else {
+      // Couldn't stop the thread, leak instead of crash.
+      WEBRTC_TRACE(kTraceWarning, kTraceVideo, -1,
+                   "%s: could not stop decode thread", __FUNCTION__);
+    }
+  }
+}
+
+void ViEDecodeScheduler::AddDecoder(Decoder* decoder, int poll_interval_ms) {
+  CriticalSectionScoped cs(crit_.get());
+  assert(FindLocked(decoder) == channels_.end());
+  Channel channel = { decoder, poll_interval_ms,
+                      clock_->TimeInMilliseconds() + poll_interval_ms, -1,
+                      false };
+  channels_.push_back(channel);
+  // A sleeping worker has to take the new poll time into account.
+  work_cond_->Wake();
+}
+
+void ViEDecodeScheduler::RemoveDecoder(Decoder* decoder) {
+  CriticalSectionScoped cs(crit_.get());
+  std::vector<Channel>::iterator it = FindLocked(decoder);
+  while (it != channels_.end() && it->decoding) {
+    idle_cond_->SleepCS(*crit_);
+    it = FindLocked(decoder);
+  }
+  if (it != channels_.end()) {
+    channels_.erase(it);
+  }
+}
+
+void ViEDecodeScheduler::FrameReady(Decoder* decoder,
+                                    int64_t render_time_ms) {
+  CriticalSectionScoped cs(crit_.get());
+  std::vector<Channel>::iterator it = FindLocked(decoder);
+  if (it == channels_.end()) {
+    return;
+  }
+  if (it->ready_render_time_ms < 0 ||
+      render_time_ms < it->ready_render_time_ms) {
+    it->ready_render_time_ms = render_time_ms;
+  }
+  if (!it->decoding) {
+    work_cond_->Wake();
+  }
+}
+
+int ViEDecodeScheduler::num_threads() const {
+  return static_cast<int>(threads_.size());
+}
+
+bool ViEDecodeScheduler::WorkerThreadFun(void* obj) {
+  return static_cast<ViEDecodeScheduler*>(obj)->WorkerProcess();
+}
+
+bool ViEDecodeScheduler::WorkerProcess() {
+  crit_->Enter();
+  if (stopped_) {
+    crit_->Leave();
+    return false;
+  }
+  int64_t now_ms = clock_->TimeInMilliseconds();
+  int64_t wait_ms = kMaxWorkerWaitTimeMs;
+  Channel* channel = NextChannelLocked(now_ms, &wait_ms);
+  if (!channel) {
+    work_cond_->SleepCS(*crit_, static_cast<unsigned long>(wait_ms));
+    crit_->Leave();
+    return true;
+  }
+  channel->decoding = true;
+  channel->ready_render_time_ms = -1;
+  channel->next_poll_ms = now_ms + channel->poll_interval_ms;
+  Decoder* decoder = channel->decoder;
+  crit_->Leave();
+
+  const bool decoded = decoder->DecodeNext();
+
+  crit_->Enter();
+  // |channels_| may have been reallocated while decoding, but the channel
+  // can't have been removed.
+  std::vector<Channel>::iterator it = FindLocked(decoder);
+  assert(it != channels_.end());
+  it->decoding = false;
+  if (decoded && it->ready_render_time_ms < 0) {
+    // Only the oldest complete frame is signaled, so there may be more.
+    it->ready_render_time_ms = clock_->TimeInMilliseconds();
+  }
+  if (it->ready_render_time_ms >= 0) {
+    work_cond_->Wake();
+  }
+  idle_cond_->WakeAll();
+  crit_->Leave();
+  return true;
+}
+
+ViEDecodeScheduler::Channel* ViEDecodeScheduler::NextChannelLocked(
+    int64_t now_ms, int64_t* wait_ms) {
+  Channel* next_ready = NULL;
+  Channel* next_poll = NULL;
+  for (std::vector<Channel>::iterator it = channels_.begin();
+       it != channels_.end(); ++it) {
+    if (it->decoding) {
+      continue;
+    }
+    if (it->ready_render_time_ms >= 0) {
+      if (!next_ready ||
+          it->ready_render_time_ms < next_ready->ready_render_time_ms) {
+        next_ready = &*it;
+      }
+    } else if (!next_poll || it->next_poll_ms < next_poll->next_poll_ms) {
+      next_poll = &*it;
+    }
+  }
+  if (next_ready) {
+    return next_ready;
+  }
+  if (next_poll) {
+    if (next_poll->next_poll_ms <= now_ms) {
+      return next_poll;
+    }
+    if (next_poll->next_poll_ms - now_ms < *wait_ms) {
+      *wait_ms = next_poll->next_poll_ms - now_ms;
+    }
+  }
+  return NULL;
+}
+
+std::vector<ViEDecodeScheduler::Channel>::iterator
+ViEDecodeScheduler::FindLocked(Decoder* decoder) {
+  std::vector<Channel>::iterator it = channels_.begin();
+  while (it != channels_.end() && it->decoder != decoder) {
+    ++it;
+  }
+  return it;
+}
+
+}  // namespace webrtc
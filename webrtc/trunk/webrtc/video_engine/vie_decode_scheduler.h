@@ -0,0 +1,113 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_VIDEO_ENGINE_VIE_DECODE_SCHEDULER_H_
+#define WEBRTC_VIDEO_ENGINE_VIE_DECODE_SCHEDULER_H_
+
+#include <vector>
+
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/static_instance.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class Clock;
+class ConditionVariableWrapper;
+class CriticalSectionWrapper;
+class ThreadWrapper;
+
+// Decodes the receive channels on a fixed pool of worker threads, one per
+// core, instead of one blocking decode thread per channel. A channel is
+// queued when its next frame is complete, and the queued channels are decoded
+// in order of render time. Channels are also polled regularly, to decode
+// incomplete frames once there is no more time to wait for them.
+class ViEDecodeScheduler {
+ public:
+  // A channel decoded by the scheduler. A decoder is never called from more
+  // than one thread at a time.
+  class Decoder {
+   public:
+    // Decodes the next frame, if it is time to, without blocking. Returns
+    // true if a frame was decoded.
+    virtual bool DecodeNext() = 0;
+
+   protected:
+    virtual ~Decoder() {}
+  };
+
+  // Returns the shared scheduler, creating it and its threads on first use.
+  // Each call must be matched by a call to ReturnScheduler().
+  static ViEDecodeScheduler* GetScheduler();
+  static void ReturnScheduler();
+
+  // Starts decoding |decoder|, polling it at least every |poll_interval_ms|.
+  void AddDecoder(Decoder* decoder, int poll_interval_ms);
+
+  // Stops decoding |decoder|. Waits for a worker to finish decoding it, if one
+  // is.
+  void RemoveDecoder(Decoder* decoder);
+
+  // Queues |decoder| to be decoded as soon as a worker is free. Called when
+  // the next frame of |decoder|, due to be rendered at |render_time_ms|, is
+  // complete.
+  void FrameReady(Decoder* decoder, int64_t render_time_ms);
+
+  int num_threads() const;
+
+ protected:
+  ViEDecodeScheduler(int num_threads, Clock* clock);
+  virtual ~ViEDecodeScheduler();
+
+  static ViEDecodeScheduler* CreateInstance();
+
+ private:
+  // Friend function to allow the destructor to be accessed from the template
+  // function.
+  friend ViEDecodeScheduler* GetStaticInstance<ViEDecodeScheduler>(
+      CountOperation count_operation);
+  static ViEDecodeScheduler* StaticInstance(CountOperation count_operation);
+
+  struct Channel {
+    Decoder* decoder;
+    int poll_interval_ms;
+    int64_t next_poll_ms;
+    // Render time of the frame the channel is queued for, or -1 if it isn't
+    // queued.
+    int64_t ready_render_time_ms;
+    bool decoding;
+  };
+
+  static bool WorkerThreadFun(void* obj);
+  bool WorkerProcess();
+
+  // Returns the next channel to decode, or NULL if no channel is due. Sets
+  // |wait_ms| to the time until the next poll if none is. Must hold |crit_|.
+  Channel* NextChannelLocked(int64_t now_ms, int64_t* wait_ms);
+  std::vector<Channel>::iterator FindLocked(Decoder* decoder);
+
+  Clock* clock_;
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  // Wakes a worker when a channel is queued.
+  scoped_ptr<ConditionVariableWrapper> work_cond_;
+  // Wakes RemoveDecoder() when a channel is done decoding.
+  scoped_ptr<ConditionVariableWrapper> idle_cond_;
+  std::vector<ThreadWrapper*> threads_;
+  // There are few channels, so they are searched linearly.
+  std::vector<Channel> channels_;
+  bool stopped_;
+
+  DISALLOW_COPY_AND_ASSIGN(ViEDecodeScheduler);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_VIDEO_ENGINE_VIE_DECODE_SCHEDULER_H_
@@ -0,0 +1,265 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/test/testsupport/perf_test.h"
+#include "webrtc/video_engine/vie_decode_scheduler.h"
+
+namespace webrtc {
+
+const int kPollIntervalMs = 50;
+const int kEventTimeoutMs = 1000;
+
+// Other tests in this binary fake the TickTime clock, which the real time
+// clock is based on. The NTP time is read from the OS.
+int64_t RealTimeUs() {
+  uint32_t seconds = 0;
+  uint32_t fractions = 0;
+  Clock::GetRealTimeClock()->CurrentNtp(seconds, fractions);
+  return seconds * 1000000LL + ((fractions * 1000000LL) >> 32);
+}
+
+class TestScheduler : public ViEDecodeScheduler {
+ public:
+  TestScheduler(int num_threads, Clock* clock)
+      : ViEDecodeScheduler(num_threads, clock) {}
+  virtual ~TestScheduler() {}
+};
+
+// Decodes the frames queued with AddFrame(), logging its id to |log| for
+// each frame.
+class FakeDecoder : public ViEDecodeScheduler::Decoder {
+ public:
+  FakeDecoder(int id, std::vector<int>* log, CriticalSectionWrapper* log_crit)
+      : id_(id),
+        log_(log),
+        log_crit_(log_crit),
+        crit_(CriticalSectionWrapper::CreateCriticalSection()),
+        decode_event_(EventWrapper::Create()),
+        decode_time_us_(0),
+        num_decoded_(0),
+        total_latency_us_(0),
+        max_latency_us_(0) {}
+
+  void AddFrame() {
+    CriticalSectionScoped cs(crit_.get());
+    queued_times_us_.push_back(RealTimeUs());
+  }
+
+  // Time spent in each DecodeNext() call with a frame.
+  void set_decode_time_us(int64_t decode_time_us) {
+    decode_time_us_ = decode_time_us;
+  }
+
+  virtual bool DecodeNext() {
+    int64_t queued_time_us = 0;
+    {
+      CriticalSectionScoped cs(crit_.get());
+      if (!queued_times_us_.empty()) {
+        queued_time_us = queued_times_us_.front();
+        queued_times_us_.pop_front();
+      }
+    }
+    decode_event_->Set();
+    if (queued_time_us == 0) {
+      return false;
+    }
+    const int64_t start_us = RealTimeUs();
+    while (RealTimeUs() - start_us < decode_time_us_) {
+      // Busy wait, like a decoder would.
+    }
+    if (log_) {
+      CriticalSectionScoped cs(log_crit_);
+      log_->push_back(id_);
+    }
+    CriticalSectionScoped cs(crit_.get());
+    const int64_t latency_us = start_us - queued_time_us;
+    ++num_decoded_;
+    total_latency_us_ += latency_us;
+    max_latency_us_ = std::max(max_latency_us_, latency_us);
+    return true;
+  }
+
+  // Waits for the next call to DecodeNext().
+  bool WaitForDecode() {
+    return decode_event_->Wait(kEventTimeoutMs) == kEventSignaled;
+  }
+
+  int num_decoded() const {
+    CriticalSectionScoped cs(crit_.get());
+    return num_decoded_;
+  }
+  int64_t total_latency_us() const {
+    CriticalSectionScoped cs(crit_.get());
+    return total_latency_us_;
+  }
+  int64_t max_latency_us() const {
+    CriticalSectionScoped cs(crit_.get());
+    return max_latency_us_;
+  }
+
+ private:
+  const int id_;
+  std::vector<int>* log_;
+  CriticalSectionWrapper* log_crit_;
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  scoped_ptr<EventWrapper> decode_event_;
+  int64_t decode_time_us_;
+  std::deque<int64_t> queued_times_us_;
+  int num_decoded_;
+  int64_t total_latency_us_;
+  int64_t max_latency_us_;
+};
+
+// Holds the only worker in DecodeNext() until Release() is called.
+class BlockingDecoder : public FakeDecoder {
+ public:
+  BlockingDecoder(int id, std::vector<int>* log,
+                  CriticalSectionWrapper* log_crit)
+      : FakeDecoder(id, log, log_crit),
+        release_event_(EventWrapper::Create()) {}
+
+  void Release() { release_event_->Set(); }
+
+  virtual bool DecodeNext() {
+    const bool decoded = FakeDecoder::DecodeNext();
+    release_event_->Wait(kEventTimeoutMs);
+    return decoded;
+  }
+
+ private:
+  scoped_ptr<EventWrapper> release_event_;
+};
+
+class ViEDecodeSchedulerTest : public ::testing::Test {
+ protected:
+  ViEDecodeSchedulerTest()
+      : clock_(1000000),
+        log_crit_(CriticalSectionWrapper::CreateCriticalSection()) {}
+
+  std::vector<int> Log() {
+    CriticalSectionScoped cs(log_crit_.get());
+    return log_;
+  }
+
+  SimulatedClock clock_;
+  scoped_ptr<CriticalSectionWrapper> log_crit_;
+  std::vector<int> log_;
+};
+
+TEST_F(ViEDecodeSchedulerTest, DecodesInRenderTimeOrder) {
+  TestScheduler scheduler(1, &clock_);
+  BlockingDecoder blocking(0, &log_, log_crit_.get());
+  FakeDecoder decoder1(1, &log_, log_crit_.get());
+  FakeDecoder decoder2(2, &log_, log_crit_.get());
+  FakeDecoder decoder3(3, &log_, log_crit_.get());
+  FakeDecoder* decoders[] = { &decoder1, &decoder2, &decoder3 };
+  scheduler.AddDecoder(&blocking, kPollIntervalMs);
+  for (int i = 0; i < 3; ++i) {
+    scheduler.AddDecoder(decoders[i], kPollIntervalMs);
+  }
+
+  // Keep the worker busy while the other frames get ready.
+  blocking.AddFrame();
+  scheduler.FrameReady(&blocking, 0);
+  ASSERT_TRUE(blocking.WaitForDecode());
+  const int64_t render_times_ms[] = { 300, 100, 200 };
+  for (int i = 0; i < 3; ++i) {
+    decoders[i]->AddFrame();
+    scheduler.FrameReady(decoders[i], render_times_ms[i]);
+  }
+  blocking.Release();
+  // Rendered last.
+  ASSERT_TRUE(decoder1.WaitForDecode());
+
+  for (int i = 0; i < 3; ++i) {
+    scheduler.RemoveDecoder(decoders[i]);
+  }
+  blocking.Release();
+  scheduler.RemoveDecoder(&blocking);
+
+  const int kExpectedOrder[] = { 0, 2, 3, 1 };
+  EXPECT_EQ(std::vector<int>(kExpectedOrder, kExpectedOrder + 4), Log());
+}
+
+TEST_F(ViEDecodeSchedulerTest, PollsDecoders) {
+  TestScheduler scheduler(1, &clock_);
+  FakeDecoder decoder(0, NULL, NULL);
+  scheduler.AddDecoder(&decoder, kPollIntervalMs);
+
+  // Incomplete frames are decoded when the channel is polled.
+  decoder.AddFrame();
+  clock_.AdvanceTimeMilliseconds(kPollIntervalMs);
+  ASSERT_TRUE(decoder.WaitForDecode());
+  scheduler.RemoveDecoder(&decoder);
+  EXPECT_EQ(1, decoder.num_decoded());
+}
+
+// Feeds 30 fps to 32 channels, and reports the time from a frame being ready
+// until it is decoded.
+TEST_F(ViEDecodeSchedulerTest, DecodeLatency) {
+  const int kNumChannels = 32;
+  const int kNumFrames = 60;
+  const int kFrameIntervalMs = 33;
+  const int kDecodeTimeUs = 500;
+
+  ViEDecodeScheduler* scheduler = ViEDecodeScheduler::GetScheduler();
+  std::vector<FakeDecoder*> decoders;
+  for (int i = 0; i < kNumChannels; ++i) {
+    decoders.push_back(new FakeDecoder(i, NULL, NULL));
+    decoders[i]->set_decode_time_us(kDecodeTimeUs);
+    scheduler->AddDecoder(decoders[i], kPollIntervalMs);
+  }
+  for (int n = 0; n < kNumFrames; ++n) {
+    for (int i = 0; i < kNumChannels; ++i) {
+      decoders[i]->AddFrame();
+      scheduler->FrameReady(decoders[i], 0);
+    }
+    SleepMs(kFrameIntervalMs);
+  }
+  SleepMs(kFrameIntervalMs);
+
+  int64_t total_latency_us = 0;
+  int64_t max_latency_us = 0;
+  for (int i = 0; i < kNumChannels; ++i) {
+    scheduler->RemoveDecoder(decoders[i]);
+    EXPECT_EQ(kNumFrames, decoders[i]->num_decoded());
+    total_latency_us += decoders[i]->total_latency_us();
+    max_latency_us = std::max(max_latency_us, decoders[i]->max_latency_us());
+    delete decoders[i];
+  }
+
+  char latency[16];
+  snprintf(latency, sizeof(latency), "%.3f",
+           total_latency_us / 1000.0 / (kNumChannels * kNumFrames));
+  webrtc::test::PrintResult("decode_latency", "_mean", "32_channels", latency,
+                            "ms", false);
+  snprintf(latency, sizeof(latency), "%.3f", max_latency_us / 1000.0);
+  webrtc::test::PrintResult("decode_latency", "_max", "32_channels", latency,
+                            "ms", false);
+  webrtc::test::PrintResult("decode_threads", "", "32_channels",
+                            static_cast<size_t>(scheduler->num_threads()),
+                            "threads", false);
+  ViEDecodeScheduler::ReturnScheduler();
+}
+
+}  // namespace webrtc
@@ -107,6 +107,7 @@ ViEEncoder::ViEEncoder(WebRtc_Word32 engine_id,
     picture_id_sli_(0),
     has_received_rpsi_(false),
     picture_id_rpsi_(0),
+    has_content_metrics_(false),
     file_recorder_(channel_id),
     qm_callback_(NULL) {
   WEBRTC_TRACE(webrtc::kTraceMemory, webrtc::kTraceVideo,
@@ -582,7 +583,18 @@ void ViEEncoder::DeliverFrame(int id,
     return;
   }*/
 #endif
-  if (vcm_.AddVideoFrame(*decimated_frame) != VCM_OK) {
+  // The capturer's metrics are for the frame before resampling.
+  const VideoContentMetrics* content_metrics = NULL;
+  VideoContentMetrics metrics;
+  {
+    CriticalSectionScoped cs(data_cs_.get());
+    if (has_content_metrics_ && decimated_frame == video_frame) {
+      metrics = content_metrics_;
+      content_metrics = &metrics;
+    }
+    has_content_metrics_ = false;
+  }
+  if (vcm_.AddVideoFrame(*decimated_frame, content_metrics) != VCM_OK) {
     WEBRTC_TRACE(webrtc::kTraceError,
                  webrtc::kTraceVideo,
                  ViEId(engine_id_, channel_id_),
@@ -591,6 +603,13 @@ void ViEEncoder::DeliverFrame(int id,
   }
 }
 
+void ViEEncoder::DeliverContentMetrics(int id,
+                                       const VideoContentMetrics& metrics) {
+  CriticalSectionScoped cs(data_cs_.get());
+  content_metrics_ = metrics;
+  has_content_metrics_ = true;
+}
+
 void ViEEncoder::DelayChanged(int id, int frame_delay) {
   WEBRTC_TRACE(webrtc::kTraceStream, webrtc::kTraceVideo,
                ViEId(engine_id_, channel_id_), "%s: %u", __FUNCTION__,
@@ -94,6 +94,8 @@ class ViEEncoder
                             I420VideoFrame* video_frame,
                             int num_csrcs = 0,
                             const WebRtc_UWord32 CSRC[kRtpCsrcSize] = NULL);
+  virtual void DeliverContentMetrics(int id,
+                                     const VideoContentMetrics& metrics);
   virtual void DelayChanged(int id, int frame_delay);
   virtual int GetPreferedFrameSettings(int* width,
                                        int* height,
@@ -204,6 +206,9 @@ class ViEEncoder
   bool has_received_rpsi_;
   WebRtc_UWord64 picture_id_rpsi_;
   std::map<unsigned int, int> ssrc_streams_;
+  // Metrics of the next frame, from the capturer.
+  VideoContentMetrics content_metrics_;
+  bool has_content_metrics_;
 
   ViEFileRecorder file_recorder_;
 
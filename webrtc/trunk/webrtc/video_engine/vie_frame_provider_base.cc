@@ -151,6 +151,15 @@ void ViEFrameProviderBase::DeliverFrame(
 #endif
 }
 
+void ViEFrameProviderBase::DeliverContentMetrics(
+    const VideoContentMetrics& metrics) {
+  CriticalSectionScoped cs(provider_cs_.get());
+  for (FrameCallbacks::iterator it = frame_callbacks_.begin();
+       it != frame_callbacks_.end(); ++it) {
+    (*it)->DeliverContentMetrics(id_, metrics);
+  }
+}
+
 void ViEFrameProviderBase::SetFrameDelay(int frame_delay) {
   CriticalSectionScoped cs(provider_cs_.get());
   frame_delay_ = frame_delay;
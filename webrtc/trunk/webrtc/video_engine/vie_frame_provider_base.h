@@ -22,6 +22,7 @@ namespace webrtc {
 class CriticalSectionWrapper;
 class VideoEncoder;
 class I420VideoFrame;
+struct VideoContentMetrics;
 
 // ViEFrameCallback shall be implemented by all classes receiving frames from a
 // frame provider.
@@ -32,6 +33,11 @@ class ViEFrameCallback {
                             int num_csrcs = 0,
                             const WebRtc_UWord32 CSRC[kRtpCsrcSize] = NULL) = 0;
 
+  // Content metrics of the next frame delivered, computed by the provider
+  // while it processed the frame. Only some providers compute them.
+  virtual void DeliverContentMetrics(int id,
+                                     const VideoContentMetrics& metrics) {}
+
   // The capture delay has changed from the provider. |frame_delay| is given in
   // ms.
   virtual void DelayChanged(int id, int frame_delay) = 0;
@@ -95,6 +101,7 @@ class ViEFrameProviderBase {
 	 void DeliverFrame(I420VideoFrame* video_frame,
 		 int num_csrcs = 0,
 		 const WebRtc_UWord32 CSRC[kRtpCsrcSize] = NULL);
+  void DeliverContentMetrics(const VideoContentMetrics& metrics);
   void SetFrameDelay(int frame_delay);
   int FrameDelay();
   int GetBestFormat(int* best_width,
@@ -293,6 +293,34 @@ int ViENetworkImpl::ReceivedRTPPacket(const int video_channel, const void* data,
   return vie_channel->ReceivedRTPPacket(data, length);
 }
 
+int ViENetworkImpl::ReceivedRTPPackets(const int video_channel,
+                                       const void* const* data,
+                                       const int* lengths,
+                                       const int num_packets) {
+  WEBRTC_TRACE(kTraceApiCall, kTraceVideo,
+               ViEId(shared_data_->instance_id(), video_channel),
+               "%s(channel: %d, data: -, num_packets: %d)", __FUNCTION__,
+               video_channel, num_packets);
+  if (!shared_data_->Initialized()) {
+    shared_data_->SetLastError(kViENotInitialized);
+    WEBRTC_TRACE(kTraceError, kTraceVideo, ViEId(shared_data_->instance_id()),
+                 "%s - ViE instance %d not initialized", __FUNCTION__,
+                 shared_data_->instance_id());
+    return -1;
+  }
+  ViEChannelManagerScoped cs(*(shared_data_->channel_manager()));
+  ViEChannel* vie_channel = cs.Channel(video_channel);
+  if (!vie_channel) {
+    // The channel doesn't exists
+    WEBRTC_TRACE(kTraceError, kTraceVideo,
+                 ViEId(shared_data_->instance_id(), video_channel),
+                 "Channel doesn't exist");
+    shared_data_->SetLastError(kViENetworkInvalidChannelId);
+    return -1;
+  }
+  return vie_channel->ReceivedRTPPackets(data, lengths, num_packets);
+}
+
 int ViENetworkImpl::ReceivedRTCPPacket(const int video_channel,
                                        const void* data, const int length) {
   WEBRTC_TRACE(kTraceApiCall, kTraceVideo,
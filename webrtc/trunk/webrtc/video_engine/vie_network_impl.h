@@ -51,6 +51,10 @@ class ViENetworkImpl
   virtual int ReceivedRTPPacket(const int video_channel,
                                 const void* data,
                                 const int length);
+  virtual int ReceivedRTPPackets(const int video_channel,
+                                 const void* const* data,
+                                 const int* lengths,
+                                 const int num_packets);
   virtual int ReceivedRTCPPacket(const int video_channel,
                                  const void* data,
                                  const int length);
@@ -10,6 +10,7 @@
 
 #include "video_engine/vie_receiver.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "modules/remote_bitrate_estimator/include/remote_bitrate_estimator.h"
@@ -22,6 +23,9 @@
 
 namespace webrtc {
 
+// Maximum number of packets handed to the RTP module at once.
+enum { kViEMaxReceiveBatch = 32 };
+
 ViEReceiver::ViEReceiver(const int32_t channel_id,
                          VideoCodingModule* module_vcm,
                          RemoteBitrateEstimator* remote_bitrate_estimator)
@@ -109,6 +113,15 @@ int ViEReceiver::ReceivedRTPPacket(const void* rtp_packet,
   return InsertRTPPacket((const WebRtc_Word8*) rtp_packet, rtp_packet_length);
 }
 
+int ViEReceiver::ReceivedRTPPackets(const void* const* rtp_packets,
+                                    const int* rtp_packet_lengths,
+                                    int num_packets) {
+  if (!receiving_) {
+    return -1;
+  }
+  return InsertRTPPackets(rtp_packets, rtp_packet_lengths, num_packets);
+}
+
 int ViEReceiver::ReceivedRTCPPacket(const void* rtcp_packet,
                                     int rtcp_packet_length) {
   if (!receiving_) {
@@ -151,41 +164,110 @@ void ViEReceiver::OnSendReportReceived(const WebRtc_Word32 id,
 
 int ViEReceiver::InsertRTPPacket(const WebRtc_Word8* rtp_packet,
                                  int rtp_packet_length) {
-  // TODO(mflodman) Change decrypt to get rid of this cast.
-  WebRtc_Word8* tmp_ptr = const_cast<WebRtc_Word8*>(rtp_packet);
-  unsigned char* received_packet = reinterpret_cast<unsigned char*>(tmp_ptr);
-  int received_packet_length = rtp_packet_length;
-
+  const WebRtc_UWord8* received_packet = NULL;
+  int received_packet_length = 0;
   {
     CriticalSectionScoped cs(receive_cs_.get());
+    if (!PrepareRTPPacket(reinterpret_cast<const WebRtc_UWord8*>(rtp_packet),
+                          rtp_packet_length, decryption_buffer_,
+                          &received_packet, &received_packet_length)) {
+      return -1;
+    }
+  }
+  assert(rtp_rtcp_);  // Should be set by owner at construction time.
+  return rtp_rtcp_->IncomingPacket(received_packet, received_packet_length);
+}
 
-    if (external_decryption_) {
-      int decrypted_length = kViEMaxMtu;
-      external_decryption_->decrypt(channel_id_, received_packet,
-                                    decryption_buffer_, received_packet_length,
-                                    &decrypted_length);
-      if (decrypted_length <= 0) {
-        WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideo, channel_id_,
-                     "RTP decryption failed");
-        return -1;
-      } else if (decrypted_length > kViEMaxMtu) {
-        WEBRTC_TRACE(webrtc::kTraceCritical, webrtc::kTraceVideo, channel_id_,
-                     "InsertRTPPacket: %d bytes is allocated as RTP decrytption"
-                     " output, external decryption used %d bytes. => memory is "
-                     " now corrupted", kViEMaxMtu, decrypted_length);
-        return -1;
+int ViEReceiver::InsertRTPPackets(const void* const* rtp_packets,
+                                  const int* rtp_packet_lengths,
+                                  int num_packets) {
+  if (num_packets < 0 || (num_packets > 0 && (rtp_packets == NULL ||
+                                               rtp_packet_lengths == NULL))) {
+    return -1;
+  }
+  assert(rtp_rtcp_);  // Should be set by owner at construction time.
+  const WebRtc_UWord8* packets[kViEMaxReceiveBatch];
+  WebRtc_UWord16 packet_lengths[kViEMaxReceiveBatch];
+  // The packets are handed on after |receive_cs_| is released, so they are
+  // decrypted into storage of this call rather than |decryption_buffer_|.
+  scoped_array<WebRtc_UWord8> decrypted_packets;
+  int accepted = 0;
+  for (int start = 0; start < num_packets; start += kViEMaxReceiveBatch) {
+    const int end = std::min(num_packets,
+                             start + static_cast<int>(kViEMaxReceiveBatch));
+    int count = 0;
+    {
+      // One lock for the decryption and dump of the whole batch.
+      CriticalSectionScoped cs(receive_cs_.get());
+      if (external_decryption_ && !decrypted_packets.get()) {
+        decrypted_packets.reset(
+            new WebRtc_UWord8[kViEMaxMtu * kViEMaxReceiveBatch]);
+      }
+      for (int i = start; i < end; ++i) {
+        if (rtp_packet_lengths[i] < 0 || rtp_packet_lengths[i] > kViEMaxMtu) {
+          WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideo, channel_id_,
+                       "InsertRTPPackets: invalid packet length %d",
+                       rtp_packet_lengths[i]);
+          continue;
+        }
+        const WebRtc_UWord8* received_packet = NULL;
+        int received_packet_length = 0;
+        if (PrepareRTPPacket(
+                static_cast<const WebRtc_UWord8*>(rtp_packets[i]),
+                rtp_packet_lengths[i],
+                decrypted_packets.get() ?
+                    decrypted_packets.get() + count * kViEMaxMtu : NULL,
+                &received_packet, &received_packet_length)) {
+          packets[count] = received_packet;
+          packet_lengths[count] =
+              static_cast<WebRtc_UWord16>(received_packet_length);
+          ++count;
+        }
       }
-      received_packet = decryption_buffer_;
-      received_packet_length = decrypted_length;
     }
+    const int ret = rtp_rtcp_->IncomingPackets(packets, packet_lengths, count);
+    if (ret > 0) {
+      accepted += ret;
+    }
+  }
+  return accepted;
+}
 
-    if (rtp_dump_) {
-      rtp_dump_->DumpPacket(received_packet,
-                           static_cast<WebRtc_UWord16>(received_packet_length));
+bool ViEReceiver::PrepareRTPPacket(const WebRtc_UWord8* rtp_packet,
+                                   int rtp_packet_length,
+                                   WebRtc_UWord8* decryption_buffer,
+                                   const WebRtc_UWord8** received_packet,
+                                   int* received_packet_length) {
+  *received_packet = rtp_packet;
+  *received_packet_length = rtp_packet_length;
+
+  if (external_decryption_) {
+    // TODO(mflodman) Change decrypt to get rid of this cast.
+    unsigned char* encrypted_packet = const_cast<unsigned char*>(rtp_packet);
+    int decrypted_length = kViEMaxMtu;
+    external_decryption_->decrypt(channel_id_, encrypted_packet,
+                                  decryption_buffer, rtp_packet_length,
+                                  &decrypted_length);
+    if (decrypted_length <= 0) {
+      WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideo, channel_id_,
+                   "RTP decryption failed");
+      return false;
+    } else if (decrypted_length > kViEMaxMtu) {
+      WEBRTC_TRACE(webrtc::kTraceCritical, webrtc::kTraceVideo, channel_id_,
+                   "InsertRTPPacket: %d bytes is allocated as RTP decrytption"
+                   " output, external decryption used %d bytes. => memory is "
+                   " now corrupted", kViEMaxMtu, decrypted_length);
+      return false;
     }
+    *received_packet = decryption_buffer;
+    *received_packet_length = decrypted_length;
   }
-  assert(rtp_rtcp_);  // Should be set by owner at construction time.
-  return rtp_rtcp_->IncomingPacket(received_packet, received_packet_length);
+
+  if (rtp_dump_) {
+    rtp_dump_->DumpPacket(*received_packet,
+                          static_cast<WebRtc_UWord16>(*received_packet_length));
+  }
+  return true;
 }
 
 int ViEReceiver::InsertRTCPPacket(const WebRtc_Word8* rtcp_packet,
@@ -60,6 +60,12 @@ class ViEReceiver : public UdpTransportData, public RtpData {
 
   // Receives packets from external transport.
   int ReceivedRTPPacket(const void* rtp_packet, int rtp_packet_length);
+  // Receives a batch of packets from external transport, e.g. read with one
+  // recvmmsg() call. Returns the number of packets accepted, or -1 if not
+  // receiving.
+  int ReceivedRTPPackets(const void* const* rtp_packets,
+                         const int* rtp_packet_lengths,
+                         int num_packets);
   int ReceivedRTCPPacket(const void* rtcp_packet, int rtcp_packet_length);
 
   // Implements RtpData.
@@ -78,6 +84,16 @@ class ViEReceiver : public UdpTransportData, public RtpData {
 
  private:
   int InsertRTPPacket(const WebRtc_Word8* rtp_packet, int rtp_packet_length);
+  int InsertRTPPackets(const void* const* rtp_packets,
+                       const int* rtp_packet_lengths,
+                       int num_packets);
+  // Decrypts and dumps a received RTP packet. |decryption_buffer| must hold
+  // kViEMaxMtu bytes. Must be called with |receive_cs_| held.
+  bool PrepareRTPPacket(const WebRtc_UWord8* rtp_packet,
+                        int rtp_packet_length,
+                        WebRtc_UWord8* decryption_buffer,
+                        const WebRtc_UWord8** received_packet,
+                        int* received_packet_length);
   int InsertRTCPPacket(const WebRtc_Word8* rtcp_packet, int rtcp_packet_length);
 
   scoped_ptr<CriticalSectionWrapper> receive_cs_;
@@ -203,6 +203,11 @@ public:
     // Gets the NetEQ background noise mode for a specified |channel| number.
     virtual int GetNetEQBGNMode(int channel, NetEqBgnModes& mode) = 0;
 
+    // Sets the number of threads used to encode the sending channels, the
+    // capture thread included. With more than one thread, the transports of
+    // different channels can be called concurrently. The default is 1.
+    virtual int SetNumOfEncodeThreads(int numThreads) = 0;
+
 protected:
     VoEBase() {}
     virtual ~VoEBase() {}
@@ -20,6 +20,7 @@
 #include "utility.h"
 #include "voe_base_impl.h"
 #include "voe_external_media.h"
+#include "worker_pool.h"
 
 #define WEBRTC_ABS(a) (((a) < 0) ? -(a) : (a))
 
@@ -27,6 +28,67 @@ namespace webrtc {
 
 namespace voe {
 
+namespace {
+
+// Demultiplexes the mixed microphone signal to each sending channel and lets
+// the channel process it.
+class DemuxTask : public WorkerPool::Task
+{
+public:
+    DemuxTask(const std::vector<Channel*>& channels,
+              const AudioFrame& audioFrame,
+              int mixingFrequency) :
+        _channels(channels),
+        _audioFrame(audioFrame),
+        _mixingFrequency(mixingFrequency)
+    {
+    }
+
+    virtual void Run(int index)
+    {
+        _channels[index]->Demultiplex(_audioFrame);
+        _channels[index]->PrepareEncodeAndSend(_mixingFrequency);
+    }
+
+private:
+    const std::vector<Channel*>& _channels;
+    const AudioFrame& _audioFrame;
+    const int _mixingFrequency;
+};
+
+class EncodeTask : public WorkerPool::Task
+{
+public:
+    explicit EncodeTask(const std::vector<Channel*>& channels) :
+        _channels(channels)
+    {
+    }
+
+    virtual void Run(int index)
+    {
+        _channels[index]->EncodeAndSend();
+    }
+
+private:
+    const std::vector<Channel*>& _channels;
+};
+
+// Runs |task| for each of |count| channels, on |pool| if there is one.
+void RunForChannels(WorkerPool* pool, WorkerPool::Task* task, int count)
+{
+    if (pool != NULL && count > 1)
+    {
+        pool->Run(task, count);
+        return;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        task->Run(i);
+    }
+}
+
+}  // namespace
+
 // Used for downmixing before resampling.
 // TODO(andrew): audio_device should advertise the maximum sample rate it can
 //               provide.
@@ -186,6 +248,8 @@ TransmitMixer::TransmitMixer(const WebRtc_UWord32 instanceId) :
     _audioLevel(),
     _critSect(*CriticalSectionWrapper::CreateCriticalSection()),
     _callbackCritSect(*CriticalSectionWrapper::CreateCriticalSection()),
+    _encodeCritSect(*CriticalSectionWrapper::CreateCriticalSection()),
+    _encodePool(NULL),
 #ifdef WEBRTC_VOICE_ENGINE_TYPING_DETECTION
     _timeActive(0),
     _timeSinceLastTyping(0),
@@ -249,8 +313,10 @@ TransmitMixer::~TransmitMixer()
             _filePlayerPtr = NULL;
         }
     }
+    delete _encodePool;
     delete &_critSect;
     delete &_callbackCritSect;
+    delete &_encodeCritSect;
 }
 
 WebRtc_Word32
@@ -433,7 +499,9 @@ TransmitMixer::DemuxAndMix()
     WEBRTC_TRACE(kTraceStream, kTraceVoice, VoEId(_instanceId, -1),
                  "TransmitMixer::DemuxAndMix()");
 
+    CriticalSectionScoped cs(&_encodeCritSect);
     ScopedChannel sc(*_channelManagerPtr);
+    _sendingChannels.clear();
     void* iterator(NULL);
     Channel* channelPtr = sc.GetFirstChannel(iterator);
     while (channelPtr != NULL)
@@ -443,15 +511,14 @@ TransmitMixer::DemuxAndMix()
             channelPtr->UpdateLocalTimeStamp();
         } else if (channelPtr->Sending())
         {
-            // load temporary audioframe with current (mixed) microphone signal
-            AudioFrame tmpAudioFrame;
-            tmpAudioFrame.CopyFrom(_audioFrame);
-
-            channelPtr->Demultiplex(tmpAudioFrame);
-            channelPtr->PrepareEncodeAndSend(_mixingFrequency);
+            _sendingChannels.push_back(channelPtr);
         }
         channelPtr = sc.GetNextChannel(iterator);
     }
+    // Each channel copies the (mixed) microphone signal, which is left intact.
+    DemuxTask task(_sendingChannels, _audioFrame, _mixingFrequency);
+    RunForChannels(_encodePool, &task,
+                   static_cast<int>(_sendingChannels.size()));
     return 0;
 }
 
@@ -461,17 +528,50 @@ TransmitMixer::EncodeAndSend()
     WEBRTC_TRACE(kTraceStream, kTraceVoice, VoEId(_instanceId, -1),
                  "TransmitMixer::EncodeAndSend()");
 
+    CriticalSectionScoped cs(&_encodeCritSect);
     ScopedChannel sc(*_channelManagerPtr);
+    _sendingChannels.clear();
     void* iterator(NULL);
     Channel* channelPtr = sc.GetFirstChannel(iterator);
     while (channelPtr != NULL)
     {
         if (channelPtr->Sending() && !channelPtr->InputIsOnHold())
         {
-            channelPtr->EncodeAndSend();
+            _sendingChannels.push_back(channelPtr);
         }
         channelPtr = sc.GetNextChannel(iterator);
     }
+    EncodeTask task(_sendingChannels);
+    RunForChannels(_encodePool, &task,
+                   static_cast<int>(_sendingChannels.size()));
+    return 0;
+}
+
+int TransmitMixer::SetNumOfEncodeThreads(int numThreads)
+{
+    WEBRTC_TRACE(kTraceInfo, kTraceVoice, VoEId(_instanceId, -1),
+                 "TransmitMixer::SetNumOfEncodeThreads(numThreads=%d)",
+                 numThreads);
+    WorkerPool* pool = NULL;
+    if (numThreads > 1)
+    {
+        pool = WorkerPool::Create(numThreads);
+        if (pool == NULL)
+        {
+            WEBRTC_TRACE(kTraceError, kTraceVoice, VoEId(_instanceId, -1),
+                         "SetNumOfEncodeThreads() failed to create the pool");
+            return -1;
+        }
+    }
+    WorkerPool* oldPool = NULL;
+    {
+        CriticalSectionScoped cs(&_encodeCritSect);
+        oldPool = _encodePool;
+        _encodePool = pool;
+    }
+    // The old threads are stopped outside the lock to not stall the capture
+    // thread.
+    delete oldPool;
     return 0;
 }
 
@@ -11,6 +11,8 @@
 #ifndef WEBRTC_VOICE_ENGINE_TRANSMIT_MIXER_H
 #define WEBRTC_VOICE_ENGINE_TRANSMIT_MIXER_H
 
+#include <vector>
+
 #include "common_types.h"
 #include "voe_base.h"
 #include "file_player.h"
@@ -31,9 +33,11 @@ class VoEMediaProcess;
 
 namespace voe {
 
+class Channel;
 class ChannelManager;
 class MixedAudio;
 class Statistics;
+class WorkerPool;
 
 class TransmitMixer : public MonitorObserver,
                       public FileCallback
@@ -65,6 +69,10 @@ public:
 
     WebRtc_Word32 EncodeAndSend();
 
+    // Sets the number of threads DemuxAndMix() and EncodeAndSend() spread the
+    // sending channels over, the calling thread included.
+    int SetNumOfEncodeThreads(int numThreads);
+
     WebRtc_UWord32 CaptureLevel() const;
 
     WebRtc_Word32 StopSend();
@@ -207,6 +215,10 @@ private:
     // protect file instances and their variables in MixedParticipants()
     CriticalSectionWrapper& _critSect;
     CriticalSectionWrapper& _callbackCritSect;
+    // protects the encode pool and |_sendingChannels|
+    CriticalSectionWrapper& _encodeCritSect;
+    WorkerPool* _encodePool; // NULL when encoding on the calling thread only
+    std::vector<Channel*> _sendingChannels;
 
 #ifdef WEBRTC_VOICE_ENGINE_TYPING_DETECTION
     WebRtc_Word32 _timeActive;
@@ -1380,6 +1380,30 @@ int VoEBaseImpl::GetNetEQBGNMode(int channel, NetEqBgnModes& mode)
     return channelPtr->GetNetEQBGNMode(mode);
 }
 
+int VoEBaseImpl::SetNumOfEncodeThreads(int numThreads)
+{
+    WEBRTC_TRACE(kTraceApiCall, kTraceVoice, VoEId(_shared->instance_id(), -1),
+                 "SetNumOfEncodeThreads(numThreads=%d)", numThreads);
+    if (!_shared->statistics().Initialized())
+    {
+        _shared->SetLastError(VE_NOT_INITED, kTraceError);
+        return -1;
+    }
+    if (numThreads < 1)
+    {
+        _shared->SetLastError(VE_INVALID_ARGUMENT, kTraceError,
+            "SetNumOfEncodeThreads() invalid number of threads");
+        return -1;
+    }
+    if (_shared->transmit_mixer()->SetNumOfEncodeThreads(numThreads) != 0)
+    {
+        _shared->SetLastError(VE_THREAD_ERROR, kTraceError,
+            "SetNumOfEncodeThreads() failed to create the encode threads");
+        return -1;
+    }
+    return 0;
+}
+
 int VoEBaseImpl::SetOnHoldStatus(int channel, bool enable, OnHoldModes mode)
 {
     WEBRTC_TRACE(kTraceApiCall, kTraceVoice, VoEId(_shared->instance_id(), -1),
@@ -79,6 +79,8 @@ public:
 
     virtual int GetNetEQBGNMode(int channel, NetEqBgnModes& mode);
 
+    virtual int SetNumOfEncodeThreads(int numThreads);
+
 
     virtual int SetOnHoldStatus(int channel,
                                 bool enable,
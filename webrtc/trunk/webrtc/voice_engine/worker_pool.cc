@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "worker_pool.h"
+
+#include <stddef.h>
+
+#include "condition_variable_wrapper.h"
+#include "critical_section_wrapper.h"
+#include "thread_wrapper.h"
+
+namespace webrtc {
+
+namespace voe {
+
+WorkerPool* WorkerPool::Create(int numberOfThreads)
+{
+    if (numberOfThreads < 1)
+    {
+        return NULL;
+    }
+    WorkerPool* pool = new WorkerPool();
+    for (int i = 1; i < numberOfThreads; i++)
+    {
+        ThreadWrapper* thread = ThreadWrapper::CreateThread(
+            WorkerThread, pool, kRealtimePriority, "VoiceEncodeThread");
+        unsigned int id;
+        if (thread == NULL || !thread->Start(id))
+        {
+            delete thread;
+            delete pool;
+            return NULL;
+        }
+        pool->_threads.push_back(thread);
+    }
+    return pool;
+}
+
+WorkerPool::WorkerPool() :
+    _critSect(CriticalSectionWrapper::CreateCriticalSection()),
+    _workAvailable(ConditionVariableWrapper::CreateConditionVariable()),
+    _workDone(ConditionVariableWrapper::CreateConditionVariable()),
+    _stopping(false),
+    _task(NULL),
+    _count(0),
+    _nextIndex(0),
+    _completed(0)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        CriticalSectionScoped cs(_critSect);
+        _stopping = true;
+        for (size_t i = 0; i < _threads.size(); i++)
+        {
+            _threads[i]->SetNotAlive();
+        }
+        _workAvailable->WakeAll();
+    }
+    for (size_t i = 0; i < _threads.size(); i++)
+    {
+        _threads[i]->Stop();
+        delete _threads[i];
+    }
+    delete _workDone;
+    delete _workAvailable;
+    delete _critSect;
+}
+
+int WorkerPool::NumberOfThreads() const
+{
+    return static_cast<int>(_threads.size()) + 1;
+}
+
+void WorkerPool::Run(Task* task, int count)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+    CriticalSectionScoped cs(_critSect);
+    _task = task;
+    _count = count;
+    _nextIndex = 0;
+    _completed = 0;
+    if (count > 1)
+    {
+        _workAvailable->WakeAll();
+    }
+    RunItems();
+    // Wait for the items started by the workers.
+    while (_completed < _count)
+    {
+        _workDone->SleepCS(*_critSect);
+    }
+    _task = NULL;
+}
+
+bool WorkerPool::WorkerThread(void* obj)
+{
+    return static_cast<WorkerPool*>(obj)->WorkerProcess();
+}
+
+bool WorkerPool::WorkerProcess()
+{
+    CriticalSectionScoped cs(_critSect);
+    while (!_stopping && (_task == NULL || _nextIndex == _count))
+    {
+        _workAvailable->SleepCS(*_critSect);
+    }
+    if (_stopping)
+    {
+        return false;
+    }
+    RunItems();
+    return true;
+}
+
+void WorkerPool::RunItems()
+{
+    while (_nextIndex < _count)
+    {
+        const int index = _nextIndex++;
+        Task* task = _task;
+        _critSect->Leave();
+        task->Run(index);
+        _critSect->Enter();
+        if (++_completed == _count)
+        {
+            _workDone->WakeAll();
+        }
+    }
+}
+
+}  // namespace voe
+
+}  // namespace webrtc
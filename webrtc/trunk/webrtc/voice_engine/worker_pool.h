@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_VOICE_ENGINE_WORKER_POOL_H
+#define WEBRTC_VOICE_ENGINE_WORKER_POOL_H
+
+#include <vector>
+
+#include "typedefs.h"
+
+namespace webrtc {
+
+class ConditionVariableWrapper;
+class CriticalSectionWrapper;
+class ThreadWrapper;
+
+namespace voe {
+
+// Runs a task for a number of items on a pool of worker threads and the
+// calling thread, and waits for all of them to complete. Used to encode the
+// sending channels in parallel.
+class WorkerPool
+{
+public:
+    class Task
+    {
+    public:
+        // Called once for each index in [0, count) of a Run() call, from any
+        // of the threads.
+        virtual void Run(int index) = 0;
+
+    protected:
+        virtual ~Task() {}
+    };
+
+    // Creates a pool of |numberOfThreads| - 1 worker threads, the calling
+    // thread of Run() being the last one. Returns NULL on failure.
+    static WorkerPool* Create(int numberOfThreads);
+
+    ~WorkerPool();
+
+    int NumberOfThreads() const;
+
+    // Runs |task| for |count| items and returns when all have completed.
+    // Must not be called from two threads at once.
+    void Run(Task* task, int count);
+
+private:
+    WorkerPool();
+
+    static bool WorkerThread(void* obj);
+    bool WorkerProcess();
+
+    // Runs items of the current task until there are no more to start.
+    // Called with |_critSect| held, which is released while running.
+    void RunItems();
+
+    CriticalSectionWrapper* _critSect;
+    ConditionVariableWrapper* _workAvailable;
+    ConditionVariableWrapper* _workDone;
+    std::vector<ThreadWrapper*> _threads;
+    bool _stopping;
+
+    // The task being run, and the progress of its items.
+    Task* _task;
+    int _count;
+    int _nextIndex;
+    int _completed;
+};
+
+}  // namespace voe
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_VOICE_ENGINE_WORKER_POOL_H
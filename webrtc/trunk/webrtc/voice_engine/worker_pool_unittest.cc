@@ -0,0 +1,291 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/voice_engine/worker_pool.h"
+
+#include <sstream>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "webrtc/modules/audio_device/include/fake_audio_device.h"
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/test/testsupport/perf_test.h"
+#include "webrtc/voice_engine/include/voe_base.h"
+#include "webrtc/voice_engine/include/voe_codec.h"
+#include "webrtc/voice_engine/include/voe_network.h"
+#include "webrtc/voice_engine/voice_engine_defines.h"
+
+namespace webrtc {
+namespace voe {
+namespace {
+
+class CountingTask : public WorkerPool::Task
+{
+public:
+    explicit CountingTask(int count) : _runs(count, 0)
+    {
+    }
+
+    virtual void Run(int index)
+    {
+        ++_runs[index];
+        ++_totalRuns;
+    }
+
+    const std::vector<int>& runs() const { return _runs; }
+    int totalRuns() { return _totalRuns.Value(); }
+
+private:
+    // Each index is only written by the thread running it.
+    std::vector<int> _runs;
+    Atomic32 _totalRuns;
+};
+
+TEST(WorkerPoolTest, CreateFailsWithoutThreads)
+{
+    EXPECT_TRUE(WorkerPool::Create(0) == NULL);
+    EXPECT_TRUE(WorkerPool::Create(-1) == NULL);
+}
+
+TEST(WorkerPoolTest, RunsEachIndexOnce)
+{
+    for (int threads = 1; threads <= 4; threads++)
+    {
+        scoped_ptr<WorkerPool> pool(WorkerPool::Create(threads));
+        ASSERT_TRUE(pool.get() != NULL);
+        EXPECT_EQ(threads, pool->NumberOfThreads());
+        for (int count = 0; count <= 9; count++)
+        {
+            CountingTask task(count);
+            pool->Run(&task, count);
+            EXPECT_EQ(count, task.totalRuns());
+            for (int i = 0; i < count; i++)
+            {
+                EXPECT_EQ(1, task.runs()[i])
+                    << "threads " << threads << " index " << i;
+            }
+        }
+    }
+}
+
+TEST(WorkerPoolTest, RunsRepeatedly)
+{
+    scoped_ptr<WorkerPool> pool(WorkerPool::Create(3));
+    ASSERT_TRUE(pool.get() != NULL);
+    CountingTask task(5);
+    for (int i = 0; i < 1000; i++)
+    {
+        pool->Run(&task, 5);
+    }
+    EXPECT_EQ(5000, task.totalRuns());
+    for (int i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(1000, task.runs()[i]);
+    }
+}
+
+// An audio device which lets the test deliver the captured audio, so that
+// each 10 ms tick runs through VoEBaseImpl::RecordedDataIsAvailable() and
+// TransmitMixer::DemuxAndMix() and EncodeAndSend().
+class CaptureDevice : public FakeAudioDeviceModule
+{
+public:
+    CaptureDevice() : _audioCallback(NULL), _recording(false)
+    {
+    }
+
+    virtual int32_t RegisterAudioCallback(AudioTransport* audioCallback)
+    {
+        _audioCallback = audioCallback;
+        return 0;
+    }
+    // Keeps the process thread from polling the device all the time.
+    virtual int32_t TimeUntilNextProcess() { return 1000; }
+    virtual int32_t InitRecording() { return 0; }
+    virtual bool RecordingIsInitialized() const { return true; }
+    virtual int32_t StartRecording()
+    {
+        _recording = true;
+        return 0;
+    }
+    virtual int32_t StopRecording()
+    {
+        _recording = false;
+        return 0;
+    }
+    virtual bool Recording() const { return _recording; }
+
+    void Capture(const int16_t* audio, int samplesPerChannel, int sampleRateHz)
+    {
+        uint32_t newMicLevel = 0;
+        _audioCallback->RecordedDataIsAvailable(audio, samplesPerChannel, 2, 1,
+                                                sampleRateHz, 0, 0, 0,
+                                                newMicLevel);
+    }
+
+private:
+    AudioTransport* _audioCallback;
+    bool _recording;
+};
+
+class NullTransport : public Transport
+{
+public:
+    virtual int SendPacket(int channel, const void* data, int len)
+    {
+        return len;
+    }
+    virtual int SendRTCPPacket(int channel, const void* data, int len)
+    {
+        return len;
+    }
+};
+
+class EncodeTickTest : public ::testing::Test
+{
+protected:
+    EncodeTickTest() :
+        _voe(VoiceEngine::Create()),
+        _base(VoEBase::GetInterface(_voe)),
+        _codec(VoECodec::GetInterface(_voe)),
+        _network(VoENetwork::GetInterface(_voe))
+    {
+    }
+
+    virtual void SetUp()
+    {
+        ASSERT_TRUE(_voe != NULL);
+        ASSERT_TRUE(_base != NULL);
+        ASSERT_TRUE(_codec != NULL);
+        ASSERT_TRUE(_network != NULL);
+        ASSERT_EQ(0, _base->Init(&_device));
+    }
+
+    virtual void TearDown()
+    {
+        RemoveChannels();
+        _base->Terminate();
+        _base->Release();
+        _codec->Release();
+        _network->Release();
+        VoiceEngine::Delete(_voe);
+    }
+
+    // Adds the codecs of the mix which this build has to |_sendCodecs|.
+    void FindSendCodecs()
+    {
+        const char* names[] = { "opus", "ISAC", "G722" };
+        const int frequencies[] = { 48000, 16000, 16000 };
+        const int numCodecs = _codec->NumOfCodecs();
+        for (int i = 0; i < static_cast<int>(sizeof(names) / sizeof(names[0]));
+             i++)
+        {
+            for (int n = 0; n < numCodecs; n++)
+            {
+                CodecInst codec;
+                ASSERT_EQ(0, _codec->GetCodec(n, codec));
+                if (!STR_CASE_CMP(codec.plname, names[i]) &&
+                    codec.plfreq == frequencies[i])
+                {
+                    _sendCodecs.push_back(codec);
+                    break;
+                }
+            }
+        }
+    }
+
+    // Adds sending channels until there are |numChannels|, taking turns with
+    // the codecs of the mix.
+    void AddChannels(int numChannels)
+    {
+        while (static_cast<int>(_channels.size()) < numChannels)
+        {
+            const CodecInst& codec =
+                _sendCodecs[_channels.size() % _sendCodecs.size()];
+            const int channel = _base->CreateChannel();
+            ASSERT_NE(-1, channel);
+            _channels.push_back(channel);
+            ASSERT_EQ(0, _network->RegisterExternalTransport(channel,
+                                                             _transport));
+            ASSERT_EQ(0, _codec->SetSendCodec(channel, codec));
+            ASSERT_EQ(0, _base->StartSend(channel));
+        }
+    }
+
+    void RemoveChannels()
+    {
+        for (size_t i = 0; i < _channels.size(); i++)
+        {
+            _base->StopSend(_channels[i]);
+            _network->DeRegisterExternalTransport(_channels[i]);
+            _base->DeleteChannel(_channels[i]);
+        }
+        _channels.clear();
+    }
+
+    VoiceEngine* _voe;
+    VoEBase* _base;
+    VoECodec* _codec;
+    VoENetwork* _network;
+    CaptureDevice _device;
+    NullTransport _transport;
+    std::vector<CodecInst> _sendCodecs;
+    std::vector<int> _channels;
+};
+
+// Measures the time of a 10 ms capture tick against the number of sending
+// channels and of encode threads.
+TEST_F(EncodeTickTest, EncodeTickTime)
+{
+    const int kTicks = 100;
+    const int kSampleRateHz = 16000;
+    const int kSamplesPerChannel = kSampleRateHz / 100;
+    const int kMaxThreads = 4;
+
+    ASSERT_NO_FATAL_FAILURE(FindSendCodecs());
+    ASSERT_FALSE(_sendCodecs.empty());
+
+    int16_t audio[kSamplesPerChannel];
+    for (int i = 0; i < kSamplesPerChannel; i++)
+    {
+        // A loud, non-periodic signal keeps the encoders busy.
+        audio[i] = static_cast<int16_t>((i * 7919) % 16384 - 8192);
+    }
+
+    for (int channels = 3; channels <= 12; channels *= 2)
+    {
+        ASSERT_NO_FATAL_FAILURE(AddChannels(channels));
+        for (int threads = 1; threads <= kMaxThreads; threads++)
+        {
+            ASSERT_EQ(0, _base->SetNumOfEncodeThreads(threads));
+            const int64_t startUs = TickTime::MicrosecondTimestamp();
+            for (int tick = 0; tick < kTicks; tick++)
+            {
+                _device.Capture(audio, kSamplesPerChannel, kSampleRateHz);
+            }
+            const int64_t elapsedUs = TickTime::MicrosecondTimestamp() -
+                startUs;
+
+            std::ostringstream modifier;
+            modifier << "_" << threads << "_threads";
+            std::ostringstream trace;
+            trace << channels << "_channels";
+            test::PrintResult("encode_tick_time", modifier.str(), trace.str(),
+                              static_cast<size_t>(elapsedUs / kTicks), "us",
+                              threads == kMaxThreads);
+        }
+    }
+}
+
+}  // namespace
+}  // namespace voe
+}  // namespace webrtc
@@ -181,6 +181,12 @@ LOCAL_SRC_FILES := \
     $(MY_LIBS_PATH)/webrtc/modules/libaudio_processing.a
 include $(PREBUILT_STATIC_LIBRARY)
 
+include $(CLEAR_VARS)
+LOCAL_MODULE := libaudio_processing_float_neon
+LOCAL_SRC_FILES := \
+    $(MY_LIBS_PATH)/webrtc/modules/libaudio_processing_float_neon.a
+include $(PREBUILT_STATIC_LIBRARY)
+
 include $(CLEAR_VARS)
 LOCAL_MODULE := libaudio_processing_neon
 LOCAL_SRC_FILES := \
@@ -324,6 +330,18 @@ LOCAL_SRC_FILES := \
     $(MY_LIBS_PATH)/webrtc/modules/librtp_rtcp.a
 include $(PREBUILT_STATIC_LIBRARY)
 
+include $(CLEAR_VARS)
+LOCAL_MODULE := librtp_rtcp_neon
+LOCAL_SRC_FILES := \
+    $(MY_LIBS_PATH)/webrtc/modules/librtp_rtcp_neon.a
+include $(PREBUILT_STATIC_LIBRARY)
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := libvideo_processing_neon
+LOCAL_SRC_FILES := \
+    $(MY_LIBS_PATH)/webrtc/modules/libvideo_processing_neon.a
+include $(PREBUILT_STATIC_LIBRARY)
+
 include $(CLEAR_VARS)
 LOCAL_MODULE := libmedia_file
 LOCAL_SRC_FILES := \
@@ -348,6 +366,12 @@ LOCAL_SRC_FILES := \
     $(MY_LIBS_PATH)/webrtc/modules/libaudio_conference_mixer.a
 include $(PREBUILT_STATIC_LIBRARY)
 
+include $(CLEAR_VARS)
+LOCAL_MODULE := libaudio_conference_mixer_neon
+LOCAL_SRC_FILES := \
+    $(MY_LIBS_PATH)/webrtc/modules/libaudio_conference_mixer_neon.a
+include $(PREBUILT_STATIC_LIBRARY)
+
 include $(CLEAR_VARS)
 LOCAL_MODULE := libyuv
 LOCAL_SRC_FILES := \
@@ -454,6 +478,7 @@ LOCAL_STATIC_LIBRARIES := \
     libvideo_capture_module \
     libaudio_coding_module \
     libaudio_processing \
+    libaudio_processing_float_neon \
     libaudio_processing_neon \
     libspeex \
     libamr \
@@ -478,10 +503,13 @@ LOCAL_STATIC_LIBRARIES := \
     libaudio_device \
     libremote_bitrate_estimator \
     librtp_rtcp \
+    librtp_rtcp_neon \
+    libvideo_processing_neon \
     libmedia_file \
     libudp_transport \
     libwebrtc_utility \
     libaudio_conference_mixer \
+    libaudio_conference_mixer_neon \
     libyuv \
     libwebrtc_vp8 \
     libsystem_wrappers \